@@ -172,9 +172,14 @@ local function GfxSampleFramework_Config(_root, _config)
 	_config["FRM_MODULE_CORE"] = true -- always include the core
 
 	SRC_PATH_ROOT = _root .. "/" .. SRC_PATH_ROOT
-	filter { "platforms:Win*" }
+
+ -- platform sources, select via the target OS (filters don't apply to Lua assignments)
+	local targetOS = os.target and os.target() or os.get()
+	if targetOS == "linux" then
+		SRC_PATH_PLATFORM = "linux/frm"
+	else
 		SRC_PATH_PLATFORM = "win/frm"
-	filter {}
+	end
 
  -- modules
 	print("modules:")
@@ -258,6 +263,9 @@ local function GfxSampleFramework_Globals()
 		filter { "platforms:Win*" }
 			includedirs(MakePath { SRC_PATH_ROOT, "win" })
 		filter {}
+		filter { "platforms:Linux*" }
+			includedirs(MakePath { SRC_PATH_ROOT, "linux" })
+		filter {}
 
 	 -- include extern sources as e.g. <imgui/imgui.h>
 		for i, moduleName in ipairs(MODULES) do
@@ -354,4 +362,10 @@ function GfxSampleFramework_Link()
 	filter { "platforms:Win*" }
 		links { "hid", "opengl32" }
 	filter {}
+	filter { "platforms:Linux*" }
+		links { "pthread" }
+		if os.findlib("uring") then
+			links { "uring" } -- File::ReadBatch() uses io_uring if liburing is available
+		end
+	filter {}
 end
@@ -18,4 +18,30 @@ vec3 Normals_DecodeLambertAzimuthal(in vec2 _normal)
 	return ret;
 }
 
+// Decode a unit vector from an octahedral encoding in [-1,1] (see Mesh::Quantization_Octahedral16).
+vec3 Normals_DecodeOctahedral(in vec2 _normal)
+{
+	vec3 ret = vec3(_normal.xy, 1.0 - abs(_normal.x) - abs(_normal.y));
+	float t = max(-ret.z, 0.0);
+	ret.xy += mix(vec2(t), vec2(-t), greaterThanEqual(ret.xy, vec2(0.0)));
+	return normalize(ret);
+}
+
+// Decode a tangent frame from a quaternion (see Mesh::Quantization_QTangent16). The bitangent sign is returned in the w component of _tangent_.
+void Normals_DecodeQTangent(in vec4 _q, out vec3 normal_, out vec4 tangent_)
+{
+	vec4 q = normalize(_q);
+	normal_ = vec3(
+		2.0 * (q.x * q.z + q.y * q.w),
+		2.0 * (q.y * q.z - q.x * q.w),
+		1.0 - 2.0 * (q.x * q.x + q.y * q.y)
+		);
+	tangent_ = vec4(
+		1.0 - 2.0 * (q.y * q.y + q.z * q.z),
+		2.0 * (q.x * q.y + q.z * q.w),
+		2.0 * (q.x * q.z - q.y * q.w),
+		_q.w < 0.0 ? -1.0 : 1.0
+		);
+}
+
 #endif // Normals_glsl
@@ -30,7 +30,7 @@ static inline uint SecondsToFrameIndex(double _seconds, int _frameRateHz)
 
 AudioData* AudioData::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	AudioData* ret = Find(id);
 	if (!ret) {
 		ret = FRM_NEW(AudioData(id, _path));
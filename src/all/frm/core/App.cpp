@@ -5,6 +5,7 @@
 #include <frm/core/platform.h>
 #include <frm/core/ArgList.h>
 #include <frm/core/Input.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/Profiler.h>
 #ifdef FRM_PLATFORM_WIN
 	#include <frm/core/win.h> // SetCurrentDirectory
@@ -21,6 +22,8 @@ using namespace frm;
 
 bool App::init(const frm::ArgList& _args)
 {
+	JobSystem::Init();
+
 	#if FRM_MODULE_AUDIO
 		Audio::Init();
 	#endif
@@ -37,6 +40,8 @@ void App::shutdown()
 	#if FRM_MODULE_AUDIO
 		Audio::Shutdown();
 	#endif
+
+	JobSystem::Shutdown();
 }
 
 bool App::update()
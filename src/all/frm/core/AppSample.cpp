@@ -206,6 +206,7 @@ void AppSample::shutdown()
 {	
 	FileSystem::EndNotifications(FileSystem::GetRoot(m_rootCommon));
 	FileSystem::EndNotifications(FileSystem::GetRoot(m_rootApp));
+	FileSystem::SaveHashManifest();
 
 	ImGui_Shutdown(this);
 	
@@ -252,6 +253,10 @@ bool AppSample::update()
 		FileSystem::DispatchNotifications();
 	}
 
+	{	PROFILER_MARKER_CPU("#Update Resources");
+		UpdateResources();
+	}
+
  // skip the default UI in hidden mode
 	if (m_hiddenMode) 
 	{
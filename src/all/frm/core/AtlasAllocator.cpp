@@ -0,0 +1,667 @@
+#include "AtlasAllocator.h"
+
+#include <frm/core/math.h>
+#include <frm/core/memory.h>
+#include <frm/core/Pool.h>
+
+#include <EASTL/sort.h>
+
+using namespace frm;
+
+namespace {
+
+uint64 GetArea(const AtlasAllocator::Rect& _rect)
+{
+	return (uint64)_rect.w * (uint64)_rect.h;
+}
+
+/*******************************************************************************
+
+                              AtlasAllocator_Quadtree
+
+*******************************************************************************/
+
+class AtlasAllocator_Quadtree: public AtlasAllocator
+{
+public:
+
+	AtlasAllocator_Quadtree(uint16 _width, uint16 _height)
+		: AtlasAllocator(Type_Quadtree, _width, _height)
+		, m_nodePool(128)
+	{
+		m_root = m_nodePool.alloc(Node(nullptr));
+		m_root->m_sizeX = _width;
+		m_root->m_sizeY = _height;
+	}
+
+	~AtlasAllocator_Quadtree()
+	{
+		resetImpl();
+		m_nodePool.free(m_root);
+	}
+
+protected:
+
+	struct Node
+	{
+		Node*  m_parent;
+		Node*  m_children[4] = {};
+		bool   m_isEmpty     = true;
+		uint16 m_sizeX       = 0, m_sizeY  = 0;
+		uint16 m_startX      = 0, m_startY = 0;
+
+		Node(Node* _parent)
+			: m_parent(_parent)
+		{
+		}
+
+		bool isLeaf() const  { return m_children[0] == nullptr; }
+		bool isEmpty() const { return m_isEmpty; }
+	};
+
+	Node*      m_root;
+	Pool<Node> m_nodePool;
+
+	bool allocImpl(uint16 _width, uint16 _height, Rect& rect_) override
+	{
+		Node* node = insert(m_root, _width, _height);
+		if (!node)
+		{
+			return false;
+		}
+		rect_.x = node->m_startX;
+		rect_.y = node->m_startY;
+		return true;
+	}
+
+	void freeImpl(const Rect& _rect) override
+	{
+		Node* node = find(_rect.x, _rect.y);
+		FRM_ASSERT(node && !node->isEmpty());
+		remove(node);
+	}
+
+	void resetImpl() override
+	{
+		destroyChildren(m_root);
+		m_root->m_isEmpty = true;
+	}
+
+	void getFreeArea(uint64& total_, uint64& largest_) const override
+	{
+		getFreeArea(m_root, total_, largest_);
+	}
+
+	Node* insert(Node* _root, uint16 _sizeX, uint16 _sizeY)
+	{
+		if (!_root->isEmpty())
+		{
+			return nullptr;
+		}
+
+		if (_root->isLeaf())
+		{
+		 // node is too small
+			if (_root->m_sizeX < _sizeX || _root->m_sizeY < _sizeY)
+			{
+				return nullptr;
+			}
+		 // node is best fit
+			uint16 nextSizeX = _root->m_sizeX / 2;
+			uint16 nextSizeY = _root->m_sizeY / 2;
+			if (nextSizeX < _sizeX || nextSizeY < _sizeY)
+			{
+				_root->m_isEmpty = false;
+				return _root;
+			}
+
+		 // subdivide the node
+		 // +---+---+
+		 // | 0 | 1 |
+		 // +---+---+
+		 // | 3 | 2 |
+		 // +---+---+
+			for (int i = 0; i < 4; ++i)
+			{
+				_root->m_children[i] = m_nodePool.alloc(Node(_root));
+				_root->m_children[i]->m_sizeX = nextSizeX;
+				_root->m_children[i]->m_sizeY = nextSizeY;
+			}
+			_root->m_children[0]->m_startX = _root->m_startX;
+			_root->m_children[0]->m_startY = _root->m_startY;
+			_root->m_children[1]->m_startX = _root->m_startX + nextSizeX;
+			_root->m_children[1]->m_startY = _root->m_startY;
+			_root->m_children[2]->m_startX = _root->m_startX + nextSizeX;
+			_root->m_children[2]->m_startY = _root->m_startY + nextSizeY;
+			_root->m_children[3]->m_startX = _root->m_startX;
+			_root->m_children[3]->m_startY = _root->m_startY + nextSizeY;
+
+			return insert(_root->m_children[0], _sizeX, _sizeY);
+		}
+
+		for (int i = 0; i < 4; ++i)
+		{
+			Node* ret = insert(_root->m_children[i], _sizeX, _sizeY);
+			if (ret)
+			{
+				return ret;
+			}
+		}
+		return nullptr;
+	}
+
+	void remove(Node* _node)
+	{
+		FRM_ASSERT(_node->isLeaf());
+		_node->m_isEmpty = true;
+		Node* parent = _node->m_parent;
+		if (!parent)
+		{
+			return;
+		}
+
+	 // remove parent if all children are empty leaves
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!parent->m_children[i]->isEmpty() || !parent->m_children[i]->isLeaf())
+			{
+				return;
+			}
+		}
+		destroyChildren(parent);
+		remove(parent);
+	}
+
+	// Find the allocated leaf with origin _x, _y.
+	Node* find(uint16 _x, uint16 _y)
+	{
+		Node* node = m_root;
+		while (!node->isLeaf())
+		{
+			bool right  = _x >= node->m_startX + node->m_sizeX / 2;
+			bool bottom = _y >= node->m_startY + node->m_sizeY / 2;
+			node = node->m_children[bottom ? (right ? 2 : 3) : (right ? 1 : 0)];
+		}
+		return (node->m_startX == _x && node->m_startY == _y) ? node : nullptr;
+	}
+
+	void destroyChildren(Node* _node)
+	{
+		if (_node->isLeaf())
+		{
+			return;
+		}
+		for (int i = 0; i < 4; ++i)
+		{
+			destroyChildren(_node->m_children[i]);
+			m_nodePool.free(_node->m_children[i]);
+			_node->m_children[i] = nullptr;
+		}
+	}
+
+	void getFreeArea(const Node* _node, uint64& total_, uint64& largest_) const
+	{
+		if (!_node->isLeaf())
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				getFreeArea(_node->m_children[i], total_, largest_);
+			}
+		}
+		else if (_node->isEmpty())
+		{
+			uint64 area = (uint64)_node->m_sizeX * (uint64)_node->m_sizeY;
+			total_ += area;
+			largest_ = FRM_MAX(largest_, area);
+		}
+	}
+};
+
+/*******************************************************************************
+
+                              AtlasAllocator_Skyline
+
+*******************************************************************************/
+
+class AtlasAllocator_Skyline: public AtlasAllocator
+{
+public:
+
+	AtlasAllocator_Skyline(uint16 _width, uint16 _height)
+		: AtlasAllocator(Type_Skyline, _width, _height)
+	{
+		resetImpl();
+	}
+
+protected:
+
+	struct Segment
+	{
+		uint16 x, y, w;
+	};
+
+	eastl::vector<Segment> m_skyline; // Sorted by x, covers [0,m_width).
+
+	bool allocImpl(uint16 _width, uint16 _height, Rect& rect_) override
+	{
+	 // bottom-left: minimize the top edge, then x
+		int bestIndex = -1;
+		uint32 bestTop = ~0u;
+		uint16 bestY = 0;
+		for (int i = 0; i < (int)m_skyline.size(); ++i)
+		{
+			uint16 y;
+			if (fit(i, _width, _height, y) && (uint32)y + _height < bestTop)
+			{
+				bestIndex = i;
+				bestTop = (uint32)y + _height;
+				bestY = y;
+			}
+		}
+		if (bestIndex < 0)
+		{
+			return false;
+		}
+
+		rect_.x = m_skyline[bestIndex].x;
+		rect_.y = bestY;
+		raise(rect_.x, _width, (uint16)bestTop);
+		return true;
+	}
+
+	void freeImpl(const Rect& _rect) override
+	{
+	 // space can only be reclaimed if the rect's top edge is the skyline, else it's lost until compaction
+		uint32 top = (uint32)_rect.y + _rect.h;
+		uint32 x1 = (uint32)_rect.x + _rect.w;
+		for (const Segment& segment : m_skyline)
+		{
+			if ((uint32)segment.x + segment.w > _rect.x && segment.x < x1 && segment.y != top)
+			{
+				return;
+			}
+		}
+		splitAt(_rect.x);
+		splitAt((uint16)FRM_MIN(x1, (uint32)m_width));
+		for (Segment& segment : m_skyline)
+		{
+			if (segment.x >= _rect.x && segment.x < x1)
+			{
+				segment.y = _rect.y;
+			}
+		}
+		mergeSegments();
+	}
+
+	void resetImpl() override
+	{
+		m_skyline.clear();
+		m_skyline.push_back({ 0, 0, m_width });
+	}
+
+	void getFreeArea(uint64& total_, uint64& largest_) const override
+	{
+	 // area above the skyline, largest free rect is the largest rectangle in the 'histogram' of free heights
+		for (int i = 0; i < (int)m_skyline.size(); ++i)
+		{
+			total_ += (uint64)m_skyline[i].w * (m_height - m_skyline[i].y);
+			uint64 minHeight = ~0ull;
+			uint64 width = 0;
+			for (int j = i; j < (int)m_skyline.size(); ++j)
+			{
+				minHeight = FRM_MIN(minHeight, (uint64)(m_height - m_skyline[j].y));
+				width += m_skyline[j].w;
+				largest_ = FRM_MAX(largest_, minHeight * width);
+			}
+		}
+	}
+
+	// Find the lowest y at which a _width * _height rect fits starting at segment _index.
+	bool fit(int _index, uint16 _width, uint16 _height, uint16& y_) const
+	{
+		if ((uint32)m_skyline[_index].x + _width > m_width)
+		{
+			return false;
+		}
+		uint32 y = 0;
+		int widthLeft = _width;
+		for (int i = _index; widthLeft > 0; ++i)
+		{
+			FRM_ASSERT(i < (int)m_skyline.size());
+			y = FRM_MAX(y, (uint32)m_skyline[i].y);
+			if (y + _height > m_height)
+			{
+				return false;
+			}
+			widthLeft -= m_skyline[i].w;
+		}
+		y_ = (uint16)y;
+		return true;
+	}
+
+	// Set the skyline in [_x,_x+_width) to _y.
+	void raise(uint16 _x, uint16 _width, uint16 _y)
+	{
+		splitAt(_x);
+		splitAt((uint16)(_x + _width));
+		int first = -1, last = -1;
+		for (int i = 0; i < (int)m_skyline.size(); ++i)
+		{
+			if (m_skyline[i].x == _x)
+			{
+				first = i;
+			}
+			if (m_skyline[i].x < _x + _width)
+			{
+				last = i;
+			}
+		}
+		FRM_ASSERT(first >= 0 && last >= first);
+		m_skyline.erase(m_skyline.begin() + first + 1, m_skyline.begin() + last + 1);
+		m_skyline[first].y = _y;
+		m_skyline[first].w = _width;
+		mergeSegments();
+	}
+
+	// Split the segment containing _x such that a segment starts at _x.
+	void splitAt(uint16 _x)
+	{
+		for (int i = 0; i < (int)m_skyline.size(); ++i)
+		{
+			Segment& segment = m_skyline[i];
+			if (segment.x < _x && _x < segment.x + segment.w)
+			{
+				Segment next = { _x, segment.y, (uint16)(segment.x + segment.w - _x) };
+				segment.w = _x - segment.x;
+				m_skyline.insert(m_skyline.begin() + i + 1, next);
+				return;
+			}
+		}
+	}
+
+	void mergeSegments()
+	{
+		for (int i = 0; i + 1 < (int)m_skyline.size();)
+		{
+			if (m_skyline[i].y == m_skyline[i + 1].y)
+			{
+				m_skyline[i].w += m_skyline[i + 1].w;
+				m_skyline.erase(m_skyline.begin() + i + 1);
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+};
+
+/*******************************************************************************
+
+                             AtlasAllocator_Guillotine
+
+*******************************************************************************/
+
+class AtlasAllocator_Guillotine: public AtlasAllocator
+{
+public:
+
+	AtlasAllocator_Guillotine(uint16 _width, uint16 _height)
+		: AtlasAllocator(Type_Guillotine, _width, _height)
+	{
+		resetImpl();
+	}
+
+protected:
+
+	eastl::vector<Rect> m_freeRects;
+
+	bool allocImpl(uint16 _width, uint16 _height, Rect& rect_) override
+	{
+	 // best area fit, tie break on the shorter leftover side
+		int bestIndex = -1;
+		uint64 bestArea = ~0ull;
+		int bestShortSide = INT_MAX;
+		for (int i = 0; i < (int)m_freeRects.size(); ++i)
+		{
+			const Rect& freeRect = m_freeRects[i];
+			if (freeRect.w < _width || freeRect.h < _height)
+			{
+				continue;
+			}
+			uint64 area = GetArea(freeRect) - (uint64)_width * _height;
+			int shortSide = FRM_MIN(freeRect.w - _width, freeRect.h - _height);
+			if (area < bestArea || (area == bestArea && shortSide < bestShortSide))
+			{
+				bestIndex = i;
+				bestArea = area;
+				bestShortSide = shortSide;
+			}
+		}
+		if (bestIndex < 0)
+		{
+			return false;
+		}
+
+		Rect freeRect = m_freeRects[bestIndex];
+		m_freeRects.erase_unsorted(m_freeRects.begin() + bestIndex);
+		rect_.x = freeRect.x;
+		rect_.y = freeRect.y;
+
+	 // split along the shorter leftover axis, the larger leftover rect gets the full extent of the free rect
+		uint16 leftoverW = freeRect.w - _width;
+		uint16 leftoverH = freeRect.h - _height;
+		Rect right, bottom;
+		right.x  = freeRect.x + _width;
+		right.y  = freeRect.y;
+		right.w  = leftoverW;
+		bottom.x = freeRect.x;
+		bottom.y = freeRect.y + _height;
+		bottom.h = leftoverH;
+		if (leftoverW <= leftoverH)
+		{
+			right.h  = _height;
+			bottom.w = freeRect.w;
+		}
+		else
+		{
+			right.h  = freeRect.h;
+			bottom.w = _width;
+		}
+		if (GetArea(right) > 0)
+		{
+			m_freeRects.push_back(right);
+		}
+		if (GetArea(bottom) > 0)
+		{
+			m_freeRects.push_back(bottom);
+		}
+		return true;
+	}
+
+	void freeImpl(const Rect& _rect) override
+	{
+	 // merge with free neighbors which share a whole edge, repeat until no more merges are possible
+		Rect rect = _rect;
+		for (bool merged = true; merged;)
+		{
+			merged = false;
+			for (int i = 0; i < (int)m_freeRects.size(); ++i)
+			{
+				const Rect& other = m_freeRects[i];
+				if (other.y == rect.y && other.h == rect.h && (other.x + other.w == rect.x || rect.x + rect.w == other.x))
+				{
+					rect.x = FRM_MIN(rect.x, other.x);
+					rect.w += other.w;
+					merged = true;
+				}
+				else if (other.x == rect.x && other.w == rect.w && (other.y + other.h == rect.y || rect.y + rect.h == other.y))
+				{
+					rect.y = FRM_MIN(rect.y, other.y);
+					rect.h += other.h;
+					merged = true;
+				}
+				if (merged)
+				{
+					m_freeRects.erase_unsorted(m_freeRects.begin() + i);
+					break;
+				}
+			}
+		}
+		m_freeRects.push_back(rect);
+	}
+
+	void resetImpl() override
+	{
+		m_freeRects.clear();
+		Rect rect;
+		rect.w = m_width;
+		rect.h = m_height;
+		m_freeRects.push_back(rect);
+	}
+
+	void getFreeArea(uint64& total_, uint64& largest_) const override
+	{
+		for (const Rect& rect : m_freeRects)
+		{
+			total_ += GetArea(rect);
+			largest_ = FRM_MAX(largest_, GetArea(rect));
+		}
+	}
+};
+
+} // namespace
+
+/*******************************************************************************
+
+                                 AtlasAllocator
+
+*******************************************************************************/
+
+// PUBLIC
+
+AtlasAllocator* AtlasAllocator::Create(Type _type, uint16 _width, uint16 _height)
+{
+	FRM_ASSERT(_width > 0 && _height > 0);
+	switch (_type)
+	{
+		case Type_Quadtree:   return FRM_NEW(AtlasAllocator_Quadtree(_width, _height));
+		case Type_Skyline:    return FRM_NEW(AtlasAllocator_Skyline(_width, _height));
+		case Type_Guillotine: return FRM_NEW(AtlasAllocator_Guillotine(_width, _height));
+		default:              FRM_ASSERT(false); return nullptr;
+	};
+}
+
+void AtlasAllocator::Destroy(AtlasAllocator*& _inst_)
+{
+	FRM_DELETE(_inst_);
+	_inst_ = nullptr;
+}
+
+const char* AtlasAllocator::GetTypeName(Type _type)
+{
+	switch (_type)
+	{
+		case Type_Quadtree:   return "Quadtree";
+		case Type_Skyline:    return "Skyline";
+		case Type_Guillotine: return "Guillotine";
+		default:              return "Unknown";
+	};
+}
+
+bool AtlasAllocator::alloc(uint16 _width, uint16 _height, Rect& rect_)
+{
+	FRM_ASSERT(_width > 0 && _height > 0);
+	if (_width > m_width || _height > m_height || !allocImpl(_width, _height, rect_))
+	{
+		return false;
+	}
+	rect_.w = _width;
+	rect_.h = _height;
+	FRM_ASSERT(m_allocations.find(GetKey(rect_.x, rect_.y)) == m_allocations.end()); // allocator returned an allocated origin
+	m_allocations[GetKey(rect_.x, rect_.y)] = rect_;
+	m_usedArea += GetArea(rect_);
+	return true;
+}
+
+void AtlasAllocator::free(const Rect& _rect)
+{
+	auto it = m_allocations.find(GetKey(_rect.x, _rect.y));
+	FRM_ASSERT(it != m_allocations.end()); // not allocated
+	if (it == m_allocations.end())
+	{
+		return;
+	}
+	m_usedArea -= GetArea(it->second);
+	if (m_allocations.size() == 1)
+	{
+	 // last allocation, reset rather than relying on the allocator to fully merge its free space
+		m_allocations.clear();
+		resetImpl();
+		return;
+	}
+	freeImpl(it->second);
+	m_allocations.erase(it);
+}
+
+void AtlasAllocator::reset()
+{
+	m_allocations.clear();
+	m_usedArea = 0;
+	resetImpl();
+}
+
+AtlasAllocator* AtlasAllocator::compact(eastl::vector<Copy>& copies_) const
+{
+	eastl::vector<Rect> rects;
+	rects.reserve(m_allocations.size());
+	for (auto& it : m_allocations)
+	{
+		rects.push_back(it.second);
+	}
+	eastl::sort(rects.begin(), rects.end(),
+		[](const Rect& _a, const Rect& _b)
+		{
+			uint16 a = FRM_MAX(_a.w, _a.h);
+			uint16 b = FRM_MAX(_b.w, _b.h);
+			return a != b ? a > b : GetArea(_a) > GetArea(_b);
+		});
+
+	AtlasAllocator* ret = Create(m_type, m_width, m_height);
+	copies_.clear();
+	for (const Rect& src : rects)
+	{
+		Rect dst;
+		if (!ret->alloc(src.w, src.h, dst))
+		{
+			Destroy(ret);
+			copies_.clear();
+			return nullptr;
+		}
+		if (dst.x != src.x || dst.y != src.y)
+		{
+			copies_.push_back({ src, dst });
+		}
+	}
+	return ret;
+}
+
+AtlasAllocator::Stats AtlasAllocator::getStats() const
+{
+	Stats ret;
+	ret.allocationCount = (uint32)m_allocations.size();
+	ret.usedArea = m_usedArea;
+	getFreeArea(ret.freeArea, ret.largestFreeArea);
+	ret.occupancy = (float)((double)m_usedArea / ((double)m_width * (double)m_height));
+	ret.fragmentation = ret.freeArea > 0 ? (float)(1.0 - (double)ret.largestFreeArea / (double)ret.freeArea) : 0.0f;
+	return ret;
+}
+
+// PROTECTED
+
+AtlasAllocator::AtlasAllocator(Type _type, uint16 _width, uint16 _height)
+	: m_type(_type)
+	, m_width(_width)
+	, m_height(_height)
+{
+}
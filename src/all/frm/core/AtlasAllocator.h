@@ -0,0 +1,116 @@
+#pragma once
+
+#include <frm/core/frm.h>
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// AtlasAllocator
+// 2d rectangle allocator for texture atlases (see TextureAtlas). Doesn't depend
+// on GL.
+//
+// Type_Quadtree   Recursive subdivision into power of 2 nodes. Fast alloc/free
+//                 but wastes up to 3/4 of each node for non-power of 2 sizes.
+// Type_Skyline    Bottom-left skyline. Tightest packing for streams of similar
+//                 sizes (glyphs, decals), freed space is reclaimed only if the
+//                 freed rect lies on the skyline (see compact()).
+// Type_Guillotine Free rect list with best area fit/shorter axis split
+//                 (i.e. a BSP). Adjacent free rects are merged on free().
+//
+// Allocations are identified by their origin, free() is O(1) to find the
+// allocation, plus whatever the allocator needs to update its state.
+////////////////////////////////////////////////////////////////////////////////
+class AtlasAllocator
+{
+public:
+
+	enum Type_
+	{
+		Type_Quadtree,
+		Type_Skyline,
+		Type_Guillotine,
+
+		Type_Count
+	};
+	typedef int Type;
+
+	struct Rect
+	{
+		uint16 x = 0, y = 0;
+		uint16 w = 0, h = 0;
+	};
+
+	struct Copy
+	{
+		Rect src;
+		Rect dst;
+	};
+
+	struct Stats
+	{
+		uint32 allocationCount = 0;
+		uint64 usedArea        = 0;    // Sum of the requested sizes.
+		uint64 freeArea        = 0;    // Area available for allocation.
+		uint64 largestFreeArea = 0;    // Largest free rect.
+		float  occupancy       = 0.0f; // usedArea / total area.
+		float  fragmentation   = 0.0f; // 1 - largestFreeArea / freeArea, 0 if all free space is a single rect.
+	};
+
+	static AtlasAllocator* Create(Type _type, uint16 _width, uint16 _height);
+	static void            Destroy(AtlasAllocator*& _inst_);
+	static const char*     GetTypeName(Type _type);
+
+	// Allocate a _width * _height rect, return false if there was no space.
+	bool            alloc(uint16 _width, uint16 _height, Rect& rect_);
+	// Free a rect previously returned by alloc(). Freeing the last allocation resets the allocator.
+	void            free(const Rect& _rect);
+	// Free all rects.
+	void            reset();
+
+	// Repack all allocations into a new allocator of the same type and size, largest first. Return nullptr if the allocations don't
+	// fit, else the new allocator. copies_ receives the allocations whose origin changed.
+	AtlasAllocator* compact(eastl::vector<Copy>& copies_) const;
+
+	Stats           getStats() const;
+	Type            getType() const      { return m_type; }
+	uint16          getWidth() const     { return m_width; }
+	uint16          getHeight() const    { return m_height; }
+
+	// Allocations are keyed by origin.
+	static uint32   GetKey(uint16 _x, uint16 _y) { return (uint32)_x | ((uint32)_y << 16); }
+
+	// Visit each allocated rect.
+	template <typename OnVisit>
+	void            visit(OnVisit&& _onVisit) const
+	{
+		for (auto& it : m_allocations)
+		{
+			_onVisit(it.second);
+		}
+	}
+
+protected:
+
+	AtlasAllocator(Type _type, uint16 _width, uint16 _height);
+	virtual ~AtlasAllocator() {}
+
+	virtual bool    allocImpl(uint16 _width, uint16 _height, Rect& rect_) = 0;
+	virtual void    freeImpl(const Rect& _rect) = 0;
+	virtual void    resetImpl() = 0;
+	virtual void    getFreeArea(uint64& total_, uint64& largest_) const = 0;
+
+	Type   m_type;
+	uint16 m_width;
+	uint16 m_height;
+
+private:
+
+	eastl::unordered_map<uint32, Rect> m_allocations; // Keyed by origin.
+	uint64                             m_usedArea = 0;
+
+}; // class AtlasAllocator
+
+} // namespace frm
@@ -0,0 +1,200 @@
+#include "BVH.h"
+
+#include <frm/core/Profiler.h>
+
+#include <cfloat>
+
+namespace frm {
+
+namespace {
+
+constexpr uint32 kBinCount = 16;
+
+inline float SurfaceArea(const vec3& _min, const vec3& _max)
+{
+	const vec3 d = Max(_max - _min, vec3(0.0f));
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+} // namespace
+
+// PUBLIC
+
+void BVH::build(const AlignedBox* _primitiveBounds, uint32 _primitiveCount, uint32 _maxLeafSize)
+{
+	PROFILER_MARKER_CPU("BVH::build");
+
+	clear();
+	if (_primitiveCount == 0)
+	{
+		return;
+	}
+	_maxLeafSize = Max(_maxLeafSize, 1u);
+
+	eastl::vector<vec3> centroids(_primitiveCount);
+	m_primitiveIndices.resize(_primitiveCount);
+	for (uint32 i = 0; i < _primitiveCount; ++i)
+	{
+		centroids[i] = (_primitiveBounds[i].m_min + _primitiveBounds[i].m_max) * 0.5f;
+		m_primitiveIndices[i] = i;
+	}
+
+	// Nodes are split in creation order, children are appended to m_nodes. A binary tree with N leaves has 2N - 1 nodes.
+	m_nodes.reserve(_primitiveCount * 2 - 1);
+	eastl::vector<uint32> nodeDepths;
+	nodeDepths.reserve(_primitiveCount * 2 - 1);
+
+	Node& root   = m_nodes.push_back();
+	root.m_first = 0;
+	root.m_count = _primitiveCount;
+	nodeDepths.push_back(1);
+
+	for (uint32 nodeIndex = 0; nodeIndex < (uint32)m_nodes.size(); ++nodeIndex)
+	{
+		const uint32 first = m_nodes[nodeIndex].m_first;
+		const uint32 count = m_nodes[nodeIndex].m_count;
+		const uint32 depth = nodeDepths[nodeIndex];
+		m_depth = Max(m_depth, depth);
+
+		// Node bounds, centroid bounds.
+		vec3 boundsMin = vec3( FLT_MAX), boundsMax = vec3(-FLT_MAX);
+		vec3 centroidMin = vec3( FLT_MAX), centroidMax = vec3(-FLT_MAX);
+		for (uint32 i = first; i < first + count; ++i)
+		{
+			const uint32 primitiveIndex = m_primitiveIndices[i];
+			boundsMin   = Min(boundsMin, _primitiveBounds[primitiveIndex].m_min);
+			boundsMax   = Max(boundsMax, _primitiveBounds[primitiveIndex].m_max);
+			centroidMin = Min(centroidMin, centroids[primitiveIndex]);
+			centroidMax = Max(centroidMax, centroids[primitiveIndex]);
+		}
+		m_nodes[nodeIndex].m_boundsMin = boundsMin;
+		m_nodes[nodeIndex].m_boundsMax = boundsMax;
+
+		// Traversal stack size is bounded by the depth (see traverse()).
+		if (count <= _maxLeafSize || depth >= kMaxDepth - 1)
+		{
+			continue;
+		}
+
+		// Find the lowest cost split among the bin boundaries on all 3 axes.
+		int   bestAxis  = -1;
+		int   bestSplit = 0;
+		float bestCost  = FLT_MAX;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centroidMax[axis] - centroidMin[axis];
+			if (extent <= 0.0f)
+			{
+				continue;
+			}
+			const float binScale = (float)kBinCount / extent;
+
+			struct Bin { vec3 boundsMin; vec3 boundsMax; uint32 count; };
+			Bin bins[kBinCount];
+			for (Bin& bin : bins)
+			{
+				bin.boundsMin = vec3( FLT_MAX);
+				bin.boundsMax = vec3(-FLT_MAX);
+				bin.count     = 0;
+			}
+			for (uint32 i = first; i < first + count; ++i)
+			{
+				const uint32 primitiveIndex = m_primitiveIndices[i];
+				const uint32 binIndex = Min((uint32)((centroids[primitiveIndex][axis] - centroidMin[axis]) * binScale), kBinCount - 1);
+				Bin& bin = bins[binIndex];
+				bin.boundsMin = Min(bin.boundsMin, _primitiveBounds[primitiveIndex].m_min);
+				bin.boundsMax = Max(bin.boundsMax, _primitiveBounds[primitiveIndex].m_max);
+				++bin.count;
+			}
+
+			// Sweep from the right to accumulate the right side areas/counts, then from the left to evaluate the cost.
+			float  rightArea[kBinCount];
+			uint32 rightCount[kBinCount];
+			vec3   accumMin = vec3( FLT_MAX), accumMax = vec3(-FLT_MAX);
+			uint32 accumCount = 0;
+			for (uint32 i = kBinCount - 1; i > 0; --i)
+			{
+				accumMin      = Min(accumMin, bins[i].boundsMin);
+				accumMax      = Max(accumMax, bins[i].boundsMax);
+				accumCount   += bins[i].count;
+				rightArea[i]  = SurfaceArea(accumMin, accumMax);
+				rightCount[i] = accumCount;
+			}
+			accumMin = vec3( FLT_MAX);
+			accumMax = vec3(-FLT_MAX);
+			accumCount = 0;
+			for (uint32 i = 0; i < kBinCount - 1; ++i)
+			{
+				accumMin    = Min(accumMin, bins[i].boundsMin);
+				accumMax    = Max(accumMax, bins[i].boundsMax);
+				accumCount += bins[i].count;
+				if (accumCount == 0 || rightCount[i + 1] == 0)
+				{
+					continue;
+				}
+				const float cost = (float)accumCount * SurfaceArea(accumMin, accumMax) + (float)rightCount[i + 1] * rightArea[i + 1];
+				if (cost < bestCost)
+				{
+					bestCost  = cost;
+					bestAxis  = axis;
+					bestSplit = (int)i + 1;
+				}
+			}
+		}
+
+		if (bestAxis == -1)
+		{
+			continue; // All centroids coincide, can't split.
+		}
+
+		// Partition primitives in place.
+		const float binScale = (float)kBinCount / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+		uint32 i = first;
+		uint32 j = first + count;
+		while (i < j)
+		{
+			const uint32 binIndex = Min((uint32)((centroids[m_primitiveIndices[i]][bestAxis] - centroidMin[bestAxis]) * binScale), kBinCount - 1);
+			if ((int)binIndex < bestSplit)
+			{
+				++i;
+			}
+			else
+			{
+				eastl::swap(m_primitiveIndices[i], m_primitiveIndices[--j]);
+			}
+		}
+		const uint32 leftCount = i - first;
+		FRM_ASSERT(leftCount > 0 && leftCount < count);
+
+		const uint32 childIndex = (uint32)m_nodes.size();
+		Node& left   = m_nodes.push_back();
+		left.m_first = first;
+		left.m_count = leftCount;
+		Node& right   = m_nodes.push_back();
+		right.m_first = first + leftCount;
+		right.m_count = count - leftCount;
+		nodeDepths.push_back(depth + 1);
+		nodeDepths.push_back(depth + 1);
+
+		m_nodes[nodeIndex].m_first = childIndex;
+		m_nodes[nodeIndex].m_count = 0;
+	}
+}
+
+void BVH::clear()
+{
+	m_nodes.clear();
+	m_primitiveIndices.clear();
+	m_depth = 0;
+}
+
+AlignedBox BVH::getBounds() const
+{
+	if (m_nodes.empty())
+	{
+		return AlignedBox(vec3(0.0f), vec3(0.0f));
+	}
+	return AlignedBox(m_nodes[0].m_boundsMin, m_nodes[0].m_boundsMax);
+}
+
+} // namespace frm
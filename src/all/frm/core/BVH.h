@@ -0,0 +1,225 @@
+#pragma once
+
+#include <frm/core/frm.h>
+#include <frm/core/geom.h>
+#include <frm/core/math.h>
+
+#include <EASTL/vector.h>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// BVH
+// Binary bounding volume hierarchy over an arbitrary set of primitives. Only
+// the primitive bounds are required to build the hierarchy, primitive tests
+// are supplied as a callback during traversal. This allows the same structure
+// to be used for both levels of a 2-level hierarchy (e.g. triangles within a
+// mesh, mesh instances within a scene).
+//
+// Built top-down using binned SAH. Node children are stored adjacently, the
+// root is node 0.
+//
+// Traversal callbacks:
+//  - traverse():       bool(uint32 _primitiveIndex, float& tMax_)
+//                      Return true to terminate traversal (any hit). Write
+//                      tMax_ to shorten the ray (closest hit).
+//  - traversePacket(): uint32(uint32 _primitiveIndex, uint32 _rayMask)
+//                      Test rays in _rayMask, write tMax_[i] to shorten rays.
+//                      Return a mask of rays which should be terminated (any
+//                      hit) or 0.
+//
+// \todo
+// - Refit for dynamic primitives.
+// - Wide (4/8) nodes + SIMD node tests.
+////////////////////////////////////////////////////////////////////////////////
+class BVH
+{
+public:
+
+	struct Node
+	{
+		vec3   m_boundsMin;
+		uint32 m_first;     // Leaf: index of the first primitive in getPrimitiveIndices(). Interior: index of the first child (second child is m_first + 1).
+		vec3   m_boundsMax;
+		uint32 m_count;     // Primitive count, 0 for interior nodes.
+
+		bool isLeaf() const { return m_count != 0; }
+	};
+	static_assert(sizeof(Node) == 32, "BVH::Node size changed");
+
+	static constexpr uint32 kMaxPacketSize = 32;
+	static constexpr uint32 kMaxDepth      = 64;
+
+	// Build the hierarchy given _primitiveCount primitive bounds. Leaves contain at most _maxLeafSize primitives (unless the
+	// primitive centroids can't be separated).
+	void          build(const AlignedBox* _primitiveBounds, uint32 _primitiveCount, uint32 _maxLeafSize = 4);
+	void          clear();
+
+	bool          isEmpty() const                 { return m_nodes.empty(); }
+	AlignedBox    getBounds() const;
+	const Node*   getNodes() const                { return m_nodes.data(); }
+	uint32        getNodeCount() const            { return (uint32)m_nodes.size(); }
+	const uint32* getPrimitiveIndices() const     { return m_primitiveIndices.data(); }
+	uint32        getPrimitiveCount() const       { return (uint32)m_primitiveIndices.size(); }
+	uint32        getDepth() const                { return m_depth; }
+
+	// Traverse nodes intersected by the ray in [0, tMax_] in approximate front-to-back order. _direction needn't be unit length,
+	// distances are in units of _direction. Return true if traversal was terminated by _intersect.
+	template <typename tIntersect>
+	bool traverse(const vec3& _origin, const vec3& _direction, float& tMax_, tIntersect&& _intersect) const;
+
+	// Traverse a packet of kPacketSize rays (active rays are set in _rayMask). Nodes are visited if any active ray in the packet
+	// intersects them, hence this is most efficient for coherent rays.
+	template <uint32 kPacketSize, typename tIntersect>
+	void traversePacket(const vec3* _origins, const vec3* _directions, float* tMax_, uint32 _rayMask, tIntersect&& _intersect) const;
+
+private:
+
+	eastl::vector<Node>   m_nodes;
+	eastl::vector<uint32> m_primitiveIndices;
+	uint32                m_depth = 0;
+
+	// Slab test, return entry distance or FLT_MAX if no intersection.
+	static float IntersectNode(const Node& _node, const vec3& _origin, const vec3& _invDirection, float _tMax)
+	{
+		const vec3 t0 = (_node.m_boundsMin - _origin) * _invDirection;
+		const vec3 t1 = (_node.m_boundsMax - _origin) * _invDirection;
+		const vec3 tmin = Min(t0, t1);
+		const vec3 tmax = Max(t0, t1);
+		const float tnear = Max(Max(tmin.x, tmin.y), Max(tmin.z, 0.0f));
+		const float tfar  = Min(Min(tmax.x, tmax.y), Min(tmax.z, _tMax));
+		return tnear <= tfar ? tnear : FLT_MAX;
+	}
+};
+
+template <typename tIntersect>
+inline bool BVH::traverse(const vec3& _origin, const vec3& _direction, float& tMax_, tIntersect&& _intersect) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	const vec3 invDirection = 1.0f / _direction;
+
+	struct StackEntry { uint32 node; float tnear; };
+	StackEntry stack[kMaxDepth];
+	uint32 stackSize = 0;
+
+	if (IntersectNode(m_nodes[0], _origin, invDirection, tMax_) == FLT_MAX)
+	{
+		return false;
+	}
+	stack[stackSize++] = { 0, 0.0f };
+
+	while (stackSize > 0)
+	{
+		const StackEntry entry = stack[--stackSize];
+		if (entry.tnear > tMax_)
+		{
+			continue; // A closer hit was found since the node was pushed.
+		}
+
+		const Node& node = m_nodes[entry.node];
+		if (node.isLeaf())
+		{
+			for (uint32 i = node.m_first; i < node.m_first + node.m_count; ++i)
+			{
+				if (_intersect(m_primitiveIndices[i], tMax_))
+				{
+					return true;
+				}
+			}
+			continue;
+		}
+
+		uint32 nearChild = node.m_first;
+		uint32 farChild  = node.m_first + 1;
+		float  tnear     = IntersectNode(m_nodes[nearChild], _origin, invDirection, tMax_);
+		float  tfar      = IntersectNode(m_nodes[farChild],  _origin, invDirection, tMax_);
+		if (tfar < tnear)
+		{
+			eastl::swap(nearChild, farChild);
+			eastl::swap(tnear, tfar);
+		}
+		// Push the far child first so that the near child is visited first.
+		if (tfar != FLT_MAX)
+		{
+			stack[stackSize++] = { farChild, tfar };
+		}
+		if (tnear != FLT_MAX)
+		{
+			stack[stackSize++] = { nearChild, tnear };
+		}
+		FRM_STRICT_ASSERT(stackSize <= kMaxDepth);
+	}
+
+	return false;
+}
+
+template <uint32 kPacketSize, typename tIntersect>
+inline void BVH::traversePacket(const vec3* _origins, const vec3* _directions, float* tMax_, uint32 _rayMask, tIntersect&& _intersect) const
+{
+	static_assert(kPacketSize <= kMaxPacketSize, "BVH::traversePacket: kPacketSize > kMaxPacketSize");
+
+	if (m_nodes.empty() || _rayMask == 0)
+	{
+		return;
+	}
+
+	vec3 invDirections[kPacketSize];
+	uint32 firstRay = kPacketSize;
+	for (uint32 i = 0; i < kPacketSize; ++i)
+	{
+		invDirections[i] = 1.0f / _directions[i];
+		if (firstRay == kPacketSize && (_rayMask & (1u << i)))
+		{
+			firstRay = i;
+		}
+	}
+	const vec3 firstDirection = _directions[firstRay];
+
+	uint32 stack[kMaxDepth];
+	uint32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0 && _rayMask != 0)
+	{
+		const Node& node = m_nodes[stack[--stackSize]];
+
+		uint32 nodeMask = 0;
+		for (uint32 i = 0; i < kPacketSize; ++i)
+		{
+			if ((_rayMask & (1u << i)) && IntersectNode(node, _origins[i], invDirections[i], tMax_[i]) != FLT_MAX)
+			{
+				nodeMask |= 1u << i;
+			}
+		}
+		if (nodeMask == 0)
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			for (uint32 i = node.m_first; i < node.m_first + node.m_count && nodeMask != 0; ++i)
+			{
+				const uint32 terminated = _intersect(m_primitiveIndices[i], nodeMask);
+				nodeMask &= ~terminated;
+				_rayMask &= ~terminated;
+			}
+			continue;
+		}
+
+		// Order children by the direction of the first active ray relative to the child centroids.
+		const Node& child0 = m_nodes[node.m_first];
+		const Node& child1 = m_nodes[node.m_first + 1];
+		const vec3 centroidDelta = (child1.m_boundsMin + child1.m_boundsMax) - (child0.m_boundsMin + child0.m_boundsMax);
+		const bool child1First = Dot(centroidDelta, firstDirection) < 0.0f;
+		stack[stackSize++] = child1First ? node.m_first : node.m_first + 1;
+		stack[stackSize++] = child1First ? node.m_first + 1 : node.m_first;
+		FRM_STRICT_ASSERT(stackSize <= kMaxDepth);
+	}
+}
+
+} // namespace frm
@@ -88,7 +88,7 @@ BasicMaterial* BasicMaterial::Create()
 
 BasicMaterial* BasicMaterial::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	BasicMaterial* ret = Find(id);
 	if (!ret) 
 	{
@@ -17,7 +17,7 @@ static const char* kFlagStr[] =
 
 namespace frm {
 
-FRM_COMPONENT_DEFINE(BasicRenderableComponent, 1);
+FRM_COMPONENT_DEFINE_PARALLEL(BasicRenderableComponent, 1, 256);
 
 // PUBLIC
 
@@ -13,6 +13,7 @@
 #include <frm/core/Camera.h>
 #include <frm/core/Framebuffer.h>
 #include <frm/core/GlContext.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/DrawMesh.h>
 #include <frm/core/Profiler.h>
 #include <frm/core/Properties.h>
@@ -74,7 +75,7 @@ void BasicRenderer::nextFrame(float _dt, Camera* _drawCamera, Camera* _cullCamer
 		for (size_t i = 0; i < shadowCameras.size(); ++i)
 		{
 			const Camera& shadowCamera = shadowCameras[i];
-			const ShadowAtlas::ShadowMap* shadowMap = (ShadowAtlas::ShadowMap*)shadowMapAllocations[i];
+			const ShadowAtlas::ShadowMap* shadowMap = shadowMapAllocations[i];
 			const DrawCallMap& drawCalls = shadowDrawCalls[i];
 
 			ctx->setFramebuffer(shadowAtlas->getFramebuffer(shadowMap->arrayIndex));
@@ -875,7 +876,7 @@ BasicRenderer::~BasicRenderer()
 
 	for (size_t i = 0; i < shadowMapAllocations.size(); ++i)
 	{
-		shadowAtlas->free((ShadowAtlas::ShadowMap*&)shadowMapAllocations[i]);
+		shadowAtlas->free(shadowMapAllocations[i]);
 	}
 	ShadowAtlas::Destroy(shadowAtlas);
 
@@ -1160,70 +1161,40 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 	{	PROFILER_MARKER_CPU("Phase 1");
 
 		const auto& activeRenderables = BasicRenderableComponent::GetActiveComponents();
+		const uint32 renderableCount = (uint32)activeRenderables.size();
+		const uint32 chunkCount = (renderableCount + kCullChunkSize - 1) / kCullChunkSize;
+		if (cullChunks.size() < chunkCount)
+		{
+			cullChunks.resize(chunkCount);
+		}
+		for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+		{
+			CullChunk& chunk = cullChunks[chunkIndex];
+			chunk.sceneRenderables.clear();
+			chunk.shadowRenderables.clear();
+			chunk.sceneBounds.m_min = chunk.shadowSceneBounds.m_min = vec3( FLT_MAX);
+			chunk.sceneBounds.m_max = chunk.shadowSceneBounds.m_max = vec3(-FLT_MAX);
+		}
+
+		BasicRenderableComponent* const* renderables = activeRenderables.data();
+		JobSystem::ParallelFor(renderableCount, kCullChunkSize, [this, renderables, _cullCamera](uint32 _begin, uint32 _end)
+			{
+				cullRenderables(renderables, _begin, _end, _cullCamera, cullChunks[_begin / kCullChunkSize]);
+			});
+
 		culledSceneRenderables.clear();
 		culledSceneRenderables.reserve(activeRenderables.size());
 		shadowRenderables.clear();
 		shadowRenderables.reserve(activeRenderables.size());
-		for (BasicRenderableComponent* renderable : activeRenderables)
+		for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
 		{
-			if (!renderable->m_mesh || renderable->m_materials.empty() || renderable->m_colorAlpha.w <= 0.0f)
-			{
-				continue;
-			}
-
-			if (isStaticOnly && !renderable->getParentNode()->isStatic())
-			{
-				continue;
-			}
-
-			const mat4 world = renderable->m_world;
-			Sphere bs = renderable->m_mesh->getBoundingSphere();
-			bs.transform(world);
-			AlignedBox bb = renderable->m_mesh->getBoundingBox();
-			bb.transform(world);
-			sceneBounds.m_min = Min(sceneBounds.m_min, bb.m_min);
-			sceneBounds.m_max = Max(sceneBounds.m_max, bb.m_max);
-
-			if (renderable->getFlag(BasicRenderableComponent::Flag::CastShadows))
-			{
-				shadowSceneBounds.m_min = Min(shadowSceneBounds.m_min, bb.m_min);
-				shadowSceneBounds.m_max = Max(shadowSceneBounds.m_max, bb.m_max);
-				shadowRenderables.push_back(renderable);
-			}
-
-			if (settings.enableCulling && (!_cullCamera->m_worldFrustum.insideIgnoreNear(bs) || !_cullCamera->m_worldFrustum.insideIgnoreNear(bb)))
-			{
-				continue;
-			}
-
-			// \todo
-			// - Eccentricity/velocity LOD coefs probably not useful in the general case.
-			// - Size coef should be computed/tweaked per mesh.
-			// - Need a system whereby projected size (see MeshViewer) maps to a LOD index via the scale. Look at Unreal?
-
-			LODCoefficients lodCoefficients;
-			const vec3  toCamera         = GetTranslation(renderable->m_world) - _cullCamera->getPosition();
-			const float distance         = Length(GetTranslation(renderable->m_world) - _cullCamera->getPosition());
-			lodCoefficients.size         = distance / _cullCamera->m_proj[1][1];
-			lodCoefficients.eccentricity = 1.0f - Max(0.0f, Dot(toCamera / distance, _cullCamera->getViewVector()));
-			lodCoefficients.velocity     = Length(GetTranslation(renderable->m_world) - GetTranslation(renderable->m_prevWorld)); // \todo Account for rotation cheaply? Use Length2? Include camera motion?
-
-			LODCoefficients renderableLODCoefficients;
-			renderableLODCoefficients.size          = 0.2f;
-			renderableLODCoefficients.eccentricity  = 0.0f; // \todo Experiment with cranking this up for VR? 
-			renderableLODCoefficients.velocity      = 5.0f; 
-
-			float flod = 0.0f;
-			flod = Max(flod, lodCoefficients.size         * renderableLODCoefficients.size);
-			flod = Max(flod, lodCoefficients.eccentricity * renderableLODCoefficients.eccentricity);
-			flod = Max(flod, lodCoefficients.velocity     * renderableLODCoefficients.velocity);
-
-			int selectedLOD = (int)flod;
-			selectedLOD = (renderable->m_lodOverride >= 0) ? renderable->m_lodOverride : selectedLOD;
-			selectedLOD = Clamp(selectedLOD + settings.lodBias, 0, renderable->m_mesh->getLODCount() - 1);
-			renderable->m_selectedLOD = selectedLOD;
-//Im3d::Text(GetTranslation(renderable->m_world), 1.0f, Im3d::Color_Magenta, Im3d::TextFlags_Default, "LOD%d", selectedLOD);
-			culledSceneRenderables.push_back(renderable);
+			const CullChunk& chunk = cullChunks[chunkIndex];
+			culledSceneRenderables.insert(culledSceneRenderables.end(), chunk.sceneRenderables.begin(), chunk.sceneRenderables.end());
+			shadowRenderables.insert(shadowRenderables.end(), chunk.shadowRenderables.begin(), chunk.shadowRenderables.end());
+			sceneBounds.m_min       = Min(sceneBounds.m_min, chunk.sceneBounds.m_min);
+			sceneBounds.m_max       = Max(sceneBounds.m_max, chunk.sceneBounds.m_max);
+			shadowSceneBounds.m_min = Min(shadowSceneBounds.m_min, chunk.shadowSceneBounds.m_min);
+			shadowSceneBounds.m_max = Max(shadowSceneBounds.m_max, chunk.shadowSceneBounds.m_max);
 		}
 	}
 
@@ -1231,50 +1202,7 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 	{	PROFILER_MARKER_CPU("Phase 2");
 
 		clearDrawCalls(sceneDrawCalls);
-		for (BasicRenderableComponent* renderable : culledSceneRenderables)
-		{
-			const mat4 world = renderable->m_world;
-
-			int submeshIndexMin = 0;
-			int submeshIndexMax = 0;
-			if (renderable->m_subMeshOverride >= 0)
-			{
-				submeshIndexMin = submeshIndexMax = renderable->m_subMeshOverride;
-			}
-			else
-			{
-				submeshIndexMax = Min((int)renderable->m_materials.size(), renderable->m_mesh->getSubmeshCount() - 1);
-			}
-
-			for (int submeshIndex = submeshIndexMin; submeshIndex <= submeshIndexMax; ++submeshIndex)
-			{
-				if (!renderable->m_materials[submeshIndex]) // skip submesh if no material set
-				{
-					continue;
-				}
-
-				if (submeshIndex > 0 && settings.enableCulling && settings.cullBySubmesh)
-				{
-					Sphere bs = renderable->m_mesh->getBoundingSphere(submeshIndex);
-					bs.transform(world);
-					AlignedBox bb = renderable->m_mesh->getBoundingBox(submeshIndex);
-					bb.transform(world);
-
-					if (!_cullCamera->m_worldFrustum.insideIgnoreNear(bs) || !_cullCamera->m_worldFrustum.insideIgnoreNear(bb))
-					{
-						continue;
-					}
-				}
-				
-				addDrawCall(renderable, renderable->m_selectedLOD, submeshIndex, sceneDrawCalls);
-
-				// If we added submesh index 0, assume we don't need to look at the other submeshes since 0 represents the whole mesh.
-				if (submeshIndex == 0)
-				{
-					break;
-				}
-			}
-		}
+		addDrawCalls(culledSceneRenderables, _cullCamera->m_worldFrustum, settings.enableCulling && settings.cullBySubmesh, sceneDrawCalls);
 	}
 
 // Phase 3: Cull lights, generate shadow light cameras.
@@ -1286,7 +1214,7 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 		// \todo map allocations -> lights, avoid realloc every frame
 		while (!shadowMapAllocations.empty())
 		{
-			ShadowAtlas::ShadowMap* shadowMap = (ShadowAtlas::ShadowMap*)shadowMapAllocations.back();
+			ShadowAtlas::ShadowMap* shadowMap = shadowMapAllocations.back();
 			shadowAtlas->free(shadowMap);
 			shadowMapAllocations.pop_back();
 		}
@@ -1295,10 +1223,8 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 		culledLights.reserve(activeLights.size());
 		culledShadowLights.clear();
 		culledShadowLights.reserve(activeLights.size());
-		shadowMapAllocations.reserve(activeLights.size());
 		for (BasicLightComponent* light : activeLights)
 		{
-			const SceneNode* sceneNode = light->getParentNode();
 			if (light->m_colorBrightness.w <= 0.0f)
 			{
 				continue;
@@ -1313,100 +1239,115 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 
 			if (light->m_castShadows)
 			{
-				ShadowAtlas::ShadowMap* shadowMap = shadowAtlas->alloc(1.0f);
-				if (!shadowMap)
-				{
-					// alloc failed, draw as a non-shadow light
-					culledLights.push_back(light);
-					continue;
-				}
-				shadowMapAllocations.push_back(shadowMap);
+				culledShadowLights.push_back(light);
+			}
+			else
+			{
+				culledLights.push_back(light);
+			}
+		}
 
-				const vec3 lightPosition = sceneNode->getPosition();
-				const vec3 lightDirection = sceneNode->getForward();
+		// Allocate all shadow maps in a single batch (largest first, see ShadowAtlas::alloc()). All lights use the max size (lod 1).
+		shadowMapLods.assign(culledShadowLights.size(), 1.0f);
+		shadowMapAllocations.resize(culledShadowLights.size());
+		shadowAtlas->alloc(shadowMapLods.data(), (int)culledShadowLights.size(), shadowMapAllocations.data());
 
-				// \todo generate shadow camera + matrix
-				Camera& shadowCamera = shadowCameras.push_back();
+		size_t shadowLightCount = 0;
+		for (size_t i = 0; i < culledShadowLights.size(); ++i)
+		{
+			BasicLightComponent* light = culledShadowLights[i];
+			ShadowAtlas::ShadowMap* shadowMap = shadowMapAllocations[i];
+			if (!shadowMap)
+			{
+				// alloc failed, draw as a non-shadow light
+				culledLights.push_back(light);
+				continue;
+			}
+			culledShadowLights[shadowLightCount] = light;
+			shadowMapAllocations[shadowLightCount] = shadowMap;
+			++shadowLightCount;
+
+			const SceneNode* sceneNode = light->getParentNode();
+			const vec3 lightPosition = sceneNode->getPosition();
+			const vec3 lightDirection = sceneNode->getForward();
 
-				switch (light->m_type)
+			// \todo generate shadow camera + matrix
+			Camera& shadowCamera = shadowCameras.push_back();
+
+			switch (light->m_type)
+			{
+				default: 
+					break;
+				case BasicLightComponent::Type_Direct:
 				{
-					default: 
-						break;
-					case BasicLightComponent::Type_Direct:
+					const vec3 shadowSceneOrigin = shadowSceneBounds.getOrigin();
+
+					shadowCamera.setOrtho(1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f);
+					shadowCamera.m_world = LookAt(shadowSceneOrigin - lightDirection, shadowSceneOrigin);
+					shadowCamera.update();
+
+				 // \todo center on the scene camera frustum
+					vec3 shadowSceneBoundsMin(FLT_MAX);
+					vec3 shadowSceneBoundsMax(-FLT_MAX);
+					vec3 verts[8];
+					shadowSceneBounds.getVertices(verts);
+					for (int i = 0; i < 8; ++i)
 					{
-						const vec3 shadowSceneOrigin = shadowSceneBounds.getOrigin();
-
-						shadowCamera.setOrtho(1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f);
-						shadowCamera.m_world = LookAt(shadowSceneOrigin - lightDirection, shadowSceneOrigin);
-						shadowCamera.update();
-
-					 // \todo center on the scene camera frustum
-						vec3 shadowSceneBoundsMin(FLT_MAX);
-						vec3 shadowSceneBoundsMax(-FLT_MAX);
-						vec3 verts[8];
-						shadowSceneBounds.getVertices(verts);
-						for (int i = 0; i < 8; ++i)
-						{
-							vec4 v = shadowCamera.m_viewProj * vec4(verts[i], 1.0f);
-							shadowSceneBoundsMin.x = Min(shadowSceneBoundsMin.x, v.x);
-							shadowSceneBoundsMin.y = Min(shadowSceneBoundsMin.y, v.y);
-							shadowSceneBoundsMin.z = Min(shadowSceneBoundsMin.z, v.z);
-							shadowSceneBoundsMax.x = Max(shadowSceneBoundsMax.x, v.x);
-							shadowSceneBoundsMax.y = Max(shadowSceneBoundsMax.y, v.y);
-							shadowSceneBoundsMax.z = Max(shadowSceneBoundsMax.z, v.z);
-						}
-						vec3 scale = vec3(2.0f) /  (shadowSceneBoundsMax - shadowSceneBoundsMin);
-						vec3 bias  = vec3(-0.5f) * (shadowSceneBoundsMax + shadowSceneBoundsMin) * scale;
-						#ifdef FRM_NDC_Z_ZERO_TO_ONE
-							scale.z = 1.0f / (shadowSceneBoundsMax.z - shadowSceneBoundsMin.z);
-							bias.z = -shadowSceneBoundsMin.z * scale.z;
-						#endif
-						//bias = ceil(bias * shadowMapSize * 0.5f) / shadowMapSize * 0.5f;
-
-						// Create a 1 texel empty border to prevent bleeding with clamp-to-edge lookup.
-						const float kBorder = 2.0f / (float)shadowMap->size;
-						scale.x = scale.x * (1.0f - kBorder);
-						scale.y = scale.y * (1.0f - kBorder);
-						bias.x  = bias.x + kBorder * 0.5f;
-						bias.y  = bias.y + kBorder * 0.5f;
-
-						mat4 cropMatrix(
-							scale.x,  0.0f,    0.0f,    bias.x,
-							0.0f,     scale.y, 0.0f,    bias.y,
-							0.0f,     0.0f,    scale.z, bias.z,
-							0.0f,     0.0f,    0.0f,    1.0f
-							);
-
-						shadowCamera.setProj(cropMatrix * shadowCamera.m_proj, shadowCamera.m_projFlags);
-						shadowCamera.updateView();
-
-						//AppSample3d::DrawFrustum(shadowCamera.m_worldFrustum);
-
-						break;
+						vec4 v = shadowCamera.m_viewProj * vec4(verts[i], 1.0f);
+						shadowSceneBoundsMin.x = Min(shadowSceneBoundsMin.x, v.x);
+						shadowSceneBoundsMin.y = Min(shadowSceneBoundsMin.y, v.y);
+						shadowSceneBoundsMin.z = Min(shadowSceneBoundsMin.z, v.z);
+						shadowSceneBoundsMax.x = Max(shadowSceneBoundsMax.x, v.x);
+						shadowSceneBoundsMax.y = Max(shadowSceneBoundsMax.y, v.y);
+						shadowSceneBoundsMax.z = Max(shadowSceneBoundsMax.z, v.z);
 					}
-					case BasicLightComponent::Type_Spot:
-					{
-						shadowCamera.setPerspective(Radians(light->m_coneOuterAngle) * 2.0f, 1.0f, 0.02f, light->m_radius);
-						shadowCamera.m_world = LookAt(lightPosition, lightPosition + lightDirection);
-						shadowCamera.update();
+					vec3 scale = vec3(2.0f) /  (shadowSceneBoundsMax - shadowSceneBoundsMin);
+					vec3 bias  = vec3(-0.5f) * (shadowSceneBoundsMax + shadowSceneBoundsMin) * scale;
+					#ifdef FRM_NDC_Z_ZERO_TO_ONE
+						scale.z = 1.0f / (shadowSceneBoundsMax.z - shadowSceneBoundsMin.z);
+						bias.z = -shadowSceneBoundsMin.z * scale.z;
+					#endif
+					//bias = ceil(bias * shadowMapSize * 0.5f) / shadowMapSize * 0.5f;
+
+					// Create a 1 texel empty border to prevent bleeding with clamp-to-edge lookup.
+					const float kBorder = 2.0f / (float)shadowMap->size;
+					scale.x = scale.x * (1.0f - kBorder);
+					scale.y = scale.y * (1.0f - kBorder);
+					bias.x  = bias.x + kBorder * 0.5f;
+					bias.y  = bias.y + kBorder * 0.5f;
+
+					mat4 cropMatrix(
+						scale.x,  0.0f,    0.0f,    bias.x,
+						0.0f,     scale.y, 0.0f,    bias.y,
+						0.0f,     0.0f,    scale.z, bias.z,
+						0.0f,     0.0f,    0.0f,    1.0f
+						);
+
+					shadowCamera.setProj(cropMatrix * shadowCamera.m_proj, shadowCamera.m_projFlags);
+					shadowCamera.updateView();
+
+					//AppSample3d::DrawFrustum(shadowCamera.m_worldFrustum);
 
-						//AppSample3d::DrawFrustum(shadowCamera.m_worldFrustum);
+					break;
+				}
+				case BasicLightComponent::Type_Spot:
+				{
+					shadowCamera.setPerspective(Radians(light->m_coneOuterAngle) * 2.0f, 1.0f, 0.02f, light->m_radius);
+					shadowCamera.m_world = LookAt(lightPosition, lightPosition + lightDirection);
+					shadowCamera.update();
 
-						break;
-					}
+					//AppSample3d::DrawFrustum(shadowCamera.m_worldFrustum);
 
-				};
+					break;
+				}
 
-				// \todo apply uv scale/bias to proj matrix
-				shadowCamera.updateGpuBuffer();
+			};
 
-				culledShadowLights.push_back(light);
-			}
-			else
-			{
-				culledLights.push_back(light);
-			}
+			// \todo apply uv scale/bias to proj matrix
+			shadowCamera.updateGpuBuffer();
 		}
+		culledShadowLights.resize(shadowLightCount);
+		shadowMapAllocations.resize(shadowLightCount);
 	}
 
 // Phase 4: Update light instances.
@@ -1438,7 +1379,7 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 		for (size_t i = 0; i < culledShadowLights.size(); ++i)
 		{
 			const BasicLightComponent* light = culledShadowLights[i];
-			const ShadowAtlas::ShadowMap* shadowMap = (ShadowAtlas::ShadowMap*)shadowMapAllocations[i];
+			const ShadowAtlas::ShadowMap* shadowMap = shadowMapAllocations[i];
 			FRM_ASSERT(shadowMap != nullptr);
 			const mat4 world = light->getParentNode()->getWorld();
 
@@ -1477,51 +1418,7 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 		{
 			const Camera& shadowCamera = shadowCameras[i];
 			DrawCallMap& drawCallMap = shadowDrawCalls.push_back();
-
-			for (BasicRenderableComponent* renderable : shadowRenderables)
-			{
-				const mat4 world = renderable->m_world;
-
-				int submeshIndexMin = 0;
-				int submeshIndexMax = 0;
-				if (renderable->m_subMeshOverride >= 0)
-				{
-					submeshIndexMin = submeshIndexMax = renderable->m_subMeshOverride;
-				}
-				else
-				{
-					submeshIndexMax = Min((int)renderable->m_materials.size(), renderable->m_mesh->getSubmeshCount() - 1);
-				}
-
-				for (int submeshIndex = submeshIndexMin; submeshIndex <= submeshIndexMax; ++submeshIndex)
-				{
-					if (!renderable->m_materials[submeshIndex]) // skip submesh if no material set
-					{
-						continue;
-					}
-
-					if (submeshIndex > 0 && settings.cullBySubmesh)
-					{
-						Sphere bs = renderable->m_mesh->getBoundingSphere(submeshIndex);
-						bs.transform(world);
-						AlignedBox bb = renderable->m_mesh->getBoundingBox(submeshIndex);
-						bb.transform(world);
-
-						if (!shadowCamera.m_worldFrustum.insideIgnoreNear(bs) || !shadowCamera.m_worldFrustum.insideIgnoreNear(bb))
-						{
-							continue;
-						}
-					}
-
-					addDrawCall(renderable, renderable->m_selectedLOD, submeshIndex, drawCallMap);
-
-					// If we added submesh index 0, assume we don't need to look at the other submeshes since 0 represents the whole mesh.
-					if (submeshIndex == 0)
-					{
-						break;
-					}
-				}
-			}
+			addDrawCalls(shadowRenderables, shadowCamera.m_worldFrustum, settings.cullBySubmesh, drawCallMap);
 		}
 	}
 
@@ -1554,6 +1451,207 @@ void BasicRenderer::updateDrawCalls(Camera* _cullCamera)
 
 }
 
+void BasicRenderer::CullBounds(const Frustum& _frustum, const SphereSoA& _spheres, const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_)
+{
+	FRM_ASSERT(_count <= kCullChunkSize);
+
+	// Visible if both the bounding sphere and bounding box are inside the frustum.
+	uint32 visibleBox[(kCullChunkSize + 31) / 32];
+	_frustum.insideIgnoreNear(_spheres, _count, visible_);
+	_frustum.insideIgnoreNear(_boxes, _count, visibleBox);
+	for (uint32 i = 0; i < (_count + 31) / 32; ++i)
+	{
+		visible_[i] &= visibleBox[i];
+	}
+}
+
+void BasicRenderer::cullRenderables(BasicRenderableComponent* const* _renderables, uint32 _begin, uint32 _end, const Camera* _cullCamera, CullChunk& chunk_) const
+{
+	FRM_ASSERT(_end - _begin <= kCullChunkSize);
+
+	const bool isStaticOnly = getFlag(Flag::StaticOnly);
+
+	// Gather candidates and their world space bounds (SoA) for the batch frustum test.
+	BasicRenderableComponent* candidates[kCullChunkSize];
+	float bsX[kCullChunkSize], bsY[kCullChunkSize], bsZ[kCullChunkSize], bsRadius[kCullChunkSize];
+	float bbMinX[kCullChunkSize], bbMinY[kCullChunkSize], bbMinZ[kCullChunkSize];
+	float bbMaxX[kCullChunkSize], bbMaxY[kCullChunkSize], bbMaxZ[kCullChunkSize];
+	uint32 candidateCount = 0;
+
+	for (uint32 i = _begin; i < _end; ++i)
+	{
+		BasicRenderableComponent* renderable = _renderables[i];
+
+		if (!renderable->m_mesh || renderable->m_materials.empty() || renderable->m_colorAlpha.w <= 0.0f)
+		{
+			continue;
+		}
+
+		if (isStaticOnly && !renderable->getParentNode()->isStatic())
+		{
+			continue;
+		}
+
+		const mat4 world = renderable->m_world;
+		Sphere bs = renderable->m_mesh->getBoundingSphere();
+		bs.transform(world);
+		AlignedBox bb = renderable->m_mesh->getBoundingBox();
+		bb.transform(world);
+		chunk_.sceneBounds.m_min = Min(chunk_.sceneBounds.m_min, bb.m_min);
+		chunk_.sceneBounds.m_max = Max(chunk_.sceneBounds.m_max, bb.m_max);
+
+		if (renderable->getFlag(BasicRenderableComponent::Flag::CastShadows))
+		{
+			chunk_.shadowSceneBounds.m_min = Min(chunk_.shadowSceneBounds.m_min, bb.m_min);
+			chunk_.shadowSceneBounds.m_max = Max(chunk_.shadowSceneBounds.m_max, bb.m_max);
+			chunk_.shadowRenderables.push_back(renderable);
+		}
+
+		candidates[candidateCount] = renderable;
+		bsX[candidateCount]        = bs.m_origin.x;
+		bsY[candidateCount]        = bs.m_origin.y;
+		bsZ[candidateCount]        = bs.m_origin.z;
+		bsRadius[candidateCount]   = bs.m_radius;
+		bbMinX[candidateCount]     = bb.m_min.x;
+		bbMinY[candidateCount]     = bb.m_min.y;
+		bbMinZ[candidateCount]     = bb.m_min.z;
+		bbMaxX[candidateCount]     = bb.m_max.x;
+		bbMaxY[candidateCount]     = bb.m_max.y;
+		bbMaxZ[candidateCount]     = bb.m_max.z;
+		++candidateCount;
+	}
+
+	uint32 visible[(kCullChunkSize + 31) / 32];
+	if (settings.enableCulling)
+	{
+		const SphereSoA spheres = { bsX, bsY, bsZ, bsRadius };
+		const AlignedBoxSoA boxes = { bbMinX, bbMinY, bbMinZ, bbMaxX, bbMaxY, bbMaxZ };
+		CullBounds(_cullCamera->m_worldFrustum, spheres, boxes, candidateCount, visible);
+	}
+	else
+	{
+		memset(visible, 0xff, sizeof(visible));
+	}
+
+	for (uint32 i = 0; i < candidateCount; ++i)
+	{
+		if ((visible[i / 32] & (1u << (i % 32))) == 0)
+		{
+			continue;
+		}
+
+		BasicRenderableComponent* renderable = candidates[i];
+
+		// \todo
+		// - Eccentricity/velocity LOD coefs probably not useful in the general case.
+		// - Size coef should be computed/tweaked per mesh.
+		// - Need a system whereby projected size (see MeshViewer) maps to a LOD index via the scale. Look at Unreal?
+
+		LODCoefficients lodCoefficients;
+		const vec3  toCamera         = GetTranslation(renderable->m_world) - _cullCamera->getPosition();
+		const float distance         = Length(GetTranslation(renderable->m_world) - _cullCamera->getPosition());
+		lodCoefficients.size         = distance / _cullCamera->m_proj[1][1];
+		lodCoefficients.eccentricity = 1.0f - Max(0.0f, Dot(toCamera / distance, _cullCamera->getViewVector()));
+		lodCoefficients.velocity     = Length(GetTranslation(renderable->m_world) - GetTranslation(renderable->m_prevWorld)); // \todo Account for rotation cheaply? Use Length2? Include camera motion?
+
+		LODCoefficients renderableLODCoefficients;
+		renderableLODCoefficients.size          = 0.2f;
+		renderableLODCoefficients.eccentricity  = 0.0f; // \todo Experiment with cranking this up for VR?
+		renderableLODCoefficients.velocity      = 5.0f;
+
+		float flod = 0.0f;
+		flod = Max(flod, lodCoefficients.size         * renderableLODCoefficients.size);
+		flod = Max(flod, lodCoefficients.eccentricity * renderableLODCoefficients.eccentricity);
+		flod = Max(flod, lodCoefficients.velocity     * renderableLODCoefficients.velocity);
+
+		int selectedLOD = (int)flod;
+		selectedLOD = (renderable->m_lodOverride >= 0) ? renderable->m_lodOverride : selectedLOD;
+		selectedLOD = Clamp(selectedLOD + settings.lodBias, 0, renderable->m_mesh->getLODCount() - 1);
+		renderable->m_selectedLOD = selectedLOD;
+		chunk_.sceneRenderables.push_back(renderable);
+	}
+}
+
+void BasicRenderer::gatherDrawItems(BasicRenderableComponent* const* _renderables, uint32 _begin, uint32 _end, const Frustum& _frustum, bool _cullBySubmesh, DrawItemList& list_) const
+{
+	for (uint32 i = _begin; i < _end; ++i)
+	{
+		const BasicRenderableComponent* renderable = _renderables[i];
+		const mat4 world = renderable->m_world;
+
+		int submeshIndexMin = 0;
+		int submeshIndexMax = 0;
+		if (renderable->m_subMeshOverride >= 0)
+		{
+			submeshIndexMin = submeshIndexMax = renderable->m_subMeshOverride;
+		}
+		else
+		{
+			submeshIndexMax = Min((int)renderable->m_materials.size(), renderable->m_mesh->getSubmeshCount() - 1);
+		}
+
+		for (int submeshIndex = submeshIndexMin; submeshIndex <= submeshIndexMax; ++submeshIndex)
+		{
+			if (!renderable->m_materials[submeshIndex]) // skip submesh if no material set
+			{
+				continue;
+			}
+
+			if (submeshIndex > 0 && _cullBySubmesh)
+			{
+				Sphere bs = renderable->m_mesh->getBoundingSphere(submeshIndex);
+				bs.transform(world);
+				AlignedBox bb = renderable->m_mesh->getBoundingBox(submeshIndex);
+				bb.transform(world);
+
+				if (!_frustum.insideIgnoreNear(bs) || !_frustum.insideIgnoreNear(bb))
+				{
+					continue;
+				}
+			}
+
+			DrawItem& drawItem    = list_.push_back();
+			drawItem.renderable   = renderable;
+			drawItem.submeshIndex = submeshIndex;
+
+			// If we added submesh index 0, assume we don't need to look at the other submeshes since 0 represents the whole mesh.
+			if (submeshIndex == 0)
+			{
+				break;
+			}
+		}
+	}
+}
+
+void BasicRenderer::addDrawCalls(const eastl::vector<BasicRenderableComponent*>& _renderables, const Frustum& _frustum, bool _cullBySubmesh, DrawCallMap& map_)
+{
+	const uint32 renderableCount = (uint32)_renderables.size();
+	const uint32 chunkCount = (renderableCount + kCullChunkSize - 1) / kCullChunkSize;
+	if (drawItemLists.size() < chunkCount)
+	{
+		drawItemLists.resize(chunkCount);
+	}
+	for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+	{
+		drawItemLists[chunkIndex].clear();
+	}
+
+	BasicRenderableComponent* const* renderables = _renderables.data();
+	JobSystem::ParallelFor(renderableCount, kCullChunkSize, [this, renderables, &_frustum, _cullBySubmesh](uint32 _begin, uint32 _end)
+		{
+			gatherDrawItems(renderables, _begin, _end, _frustum, _cullBySubmesh, drawItemLists[_begin / kCullChunkSize]);
+		});
+
+	// Merge in chunk order on the calling thread, addDrawCall() isn't thread safe (findShader() may create shaders).
+	for (uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+	{
+		for (const DrawItem& drawItem : drawItemLists[chunkIndex])
+		{
+			addDrawCall(drawItem.renderable, drawItem.renderable->m_selectedLOD, drawItem.submeshIndex, map_);
+		}
+	}
+}
+
 void BasicRenderer::addDrawCall(const BasicRenderableComponent* _renderable, int _lodIndex, int _submeshIndex, DrawCallMap& map_)
 {
 	const BasicMaterial* material = _renderable->m_materials[_submeshIndex];
@@ -7,6 +7,7 @@
 #include <frm/core/BitFlags.h>
 #include <frm/core/Camera.h>
 #include <frm/core/RenderTarget.h>
+#include <frm/core/ShadowAtlas.h>
 
 #include <EASTL/vector.h>
 #include <EASTL/unordered_map.h>
@@ -110,6 +111,14 @@ public:
 	void setFlag(Flag _flag, bool _value);
 	bool getFlag(Flag _flag) const         { return flags.get(_flag); }
 
+	// Culling is split into chunks of kCullChunkSize renderables which are processed concurrently (see JobSystem). Each chunk writes to
+	// its own output which is then merged in chunk order, hence the results are deterministic and identical to a serial loop.
+	static constexpr uint32 kCullChunkSize = 256;
+
+	// Renderable cull test. Bit i of visible_ is set if both _spheres[i] and _boxes[i] are inside _frustum, ignoring the near plane (as
+	// per Frustum::insideIgnoreNear()). _count must be at most kCullChunkSize.
+	static void CullBounds(const Frustum& _frustum, const SphereSoA& _spheres, const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_);
+
 	enum Target_
 	{
 		Target_GBuffer0,                 // Normal, velocity.
@@ -275,17 +284,44 @@ private:
 		eastl::vector<mat4>         skinningData;
 	};
 	using DrawCallMap = eastl::unordered_map<uint64, DrawCall>;
-	DrawCallMap                sceneDrawCalls;
-	eastl::vector<DrawCallMap> shadowDrawCalls;
-	eastl::vector<void*>       shadowMapAllocations; // \todo encapsule draw call map, camera and shadow allocation
+	DrawCallMap                            sceneDrawCalls;
+	eastl::vector<DrawCallMap>             shadowDrawCalls;
+	eastl::vector<ShadowAtlas::ShadowMap*> shadowMapAllocations; // \todo encapsule draw call map, camera and shadow allocation
+	eastl::vector<float>                   shadowMapLods;
 
 	eastl::vector<BasicRenderableComponent*> culledSceneRenderables;
 	eastl::vector<BasicRenderableComponent*> shadowRenderables;
 	eastl::vector<BasicLightComponent*>      culledLights;
 	eastl::vector<BasicLightComponent*>      culledShadowLights;
 
+	struct CullChunk
+	{
+		eastl::vector<BasicRenderableComponent*> sceneRenderables;
+		eastl::vector<BasicRenderableComponent*> shadowRenderables;
+		AlignedBox                               sceneBounds;
+		AlignedBox                               shadowSceneBounds;
+	};
+	eastl::vector<CullChunk> cullChunks;
+
+	struct DrawItem
+	{
+		const BasicRenderableComponent* renderable   = nullptr;
+		int                             submeshIndex = 0;
+	};
+	using DrawItemList = eastl::vector<DrawItem>;
+	eastl::vector<DrawItemList> drawItemLists;
+
 	void updateDrawCalls(Camera* _cullCamera);
 
+	// Cull _renderables[_begin, _end) against _cullCamera, select LODs, write the results to chunk_.
+	void cullRenderables(BasicRenderableComponent* const* _renderables, uint32 _begin, uint32 _end, const Camera* _cullCamera, CullChunk& chunk_) const;
+
+	// Append a draw item per visible submesh of _renderables[_begin, _end) to list_. If _cullBySubmesh, cull submeshes against _frustum.
+	void gatherDrawItems(BasicRenderableComponent* const* _renderables, uint32 _begin, uint32 _end, const Frustum& _frustum, bool _cullBySubmesh, DrawItemList& list_) const;
+
+	// Gather draw items for _renderables in parallel chunks, merge into map_ via addDrawCall().
+	void addDrawCalls(const eastl::vector<BasicRenderableComponent*>& _renderables, const Frustum& _frustum, bool _cullBySubmesh, DrawCallMap& map_);
+
 	void addDrawCall(const BasicRenderableComponent* _renderable, int _lodIndex, int _submeshIndex, DrawCallMap& map_);
 	void clearDrawCalls(DrawCallMap& map_);
 	void bindAndDraw(const DrawCall& _drawCall);
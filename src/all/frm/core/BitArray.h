@@ -0,0 +1,133 @@
+#pragma once
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+
+#include <EASTL/vector.h>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// BitArray
+// Dynamically sized array of bits packed into 64 bit words. find() and count()
+// operate on whole words via FindFirstSet()/CountBits().
+////////////////////////////////////////////////////////////////////////////////
+class BitArray
+{
+public:
+	typedef uint64 Word;
+	static constexpr uint32 kWordBits = 64;
+
+	// Proxy returned by the non-const operator[].
+	class Reference
+	{
+	public:
+		operator bool() const                     { return (*m_word & m_mask) != 0; }
+		Reference& operator=(bool _value)         { *m_word = _value ? (*m_word | m_mask) : (*m_word & ~m_mask); return *this; }
+		Reference& operator=(const Reference& _v) { return *this = (bool)_v; }
+
+	private:
+		friend class BitArray;
+		Reference(Word* _word, Word _mask): m_word(_word), m_mask(_mask) {}
+
+		Word* m_word;
+		Word  m_mask;
+	};
+
+	BitArray() = default;
+	BitArray(uint32 _size, bool _value = false)   { resize(_size, _value); }
+
+	// Resize to _size bits, new bits are set to _value.
+	void        resize(uint32 _size, bool _value = false);
+	void        clear()                           { m_words.clear(); m_size = 0; }
+	uint32      size() const                      { return m_size; }
+	bool        empty() const                     { return m_size == 0; }
+
+	bool        get(uint32 _index) const          { FRM_STRICT_ASSERT(_index < m_size); return (m_words[_index / kWordBits] >> (_index % kWordBits)) & 1; }
+	void        set(uint32 _index, bool _value)   { (*this)[_index] = _value; }
+	bool        operator[](uint32 _index) const   { return get(_index); }
+	Reference   operator[](uint32 _index)         { FRM_STRICT_ASSERT(_index < m_size); return Reference(&m_words[_index / kWordBits], Word(1) << (_index % kWordBits)); }
+
+	// Set bits in [_begin, _end) to _value.
+	void        setRange(uint32 _begin, uint32 _end, bool _value);
+
+	// Return the index of the first bit in [_begin, _end) which is equal to _value, or _end if there is no such bit.
+	uint32      find(uint32 _begin, uint32 _end, bool _value) const;
+
+	// Return the number of bits in [_begin, _end) which are equal to _value.
+	uint32      count(uint32 _begin, uint32 _end, bool _value) const;
+
+	const Word* data() const                      { return m_words.data(); }
+	Word*       data()                            { return m_words.data(); }
+	uint32      getWordCount() const              { return (uint32)m_words.size(); }
+
+private:
+
+	eastl::vector<Word> m_words;
+	uint32              m_size = 0;
+
+	// Mask for bits in [_begin, _end) of the word containing _begin, _end - _begin <= kWordBits.
+	static Word RangeMask(uint32 _begin, uint32 _end)
+	{
+		const uint32 first = _begin % kWordBits;
+		const uint32 count = _end - _begin;
+		const Word   mask  = count >= kWordBits ? ~Word(0) : (Word(1) << count) - 1;
+		return mask << first;
+	}
+};
+
+inline void BitArray::resize(uint32 _size, bool _value)
+{
+	const uint32 oldSize = m_size;
+	m_words.resize((_size + kWordBits - 1) / kWordBits, 0);
+	m_size = _size;
+	if (_size > oldSize)
+	{
+		setRange(oldSize, _size, _value);
+	}
+}
+
+inline void BitArray::setRange(uint32 _begin, uint32 _end, bool _value)
+{
+	FRM_STRICT_ASSERT(_begin <= _end && _end <= m_size);
+	while (_begin < _end)
+	{
+		const uint32 wordEnd = Min((_begin / kWordBits + 1) * kWordBits, _end);
+		const Word   mask    = RangeMask(_begin, wordEnd);
+		Word&        word    = m_words[_begin / kWordBits];
+		word = _value ? (word | mask) : (word & ~mask);
+		_begin = wordEnd;
+	}
+}
+
+inline uint32 BitArray::find(uint32 _begin, uint32 _end, bool _value) const
+{
+	FRM_STRICT_ASSERT(_begin <= _end && _end <= m_size);
+	const Word invert = _value ? Word(0) : ~Word(0);
+	for (uint32 i = _begin; i < _end; )
+	{
+		const uint32 wordEnd = Min((i / kWordBits + 1) * kWordBits, _end);
+		const Word   word    = (m_words[i / kWordBits] ^ invert) & RangeMask(i, wordEnd);
+		if (word != 0)
+		{
+			return (i / kWordBits) * kWordBits + FindFirstSet(word);
+		}
+		i = wordEnd;
+	}
+	return _end;
+}
+
+inline uint32 BitArray::count(uint32 _begin, uint32 _end, bool _value) const
+{
+	FRM_STRICT_ASSERT(_begin <= _end && _end <= m_size);
+	uint32 ret = 0;
+	for (uint32 i = _begin; i < _end; )
+	{
+		const uint32 wordEnd = Min((i / kWordBits + 1) * kWordBits, _end);
+		ret += CountBits(m_words[i / kWordBits] & RangeMask(i, wordEnd));
+		i = wordEnd;
+	}
+	return _value ? ret : (_end - _begin) - ret;
+}
+
+} // namespace frm
@@ -0,0 +1,499 @@
+#include "CookedMesh.h"
+
+#include <frm/core/Log.h>
+#include <frm/core/memory.h>
+#include <frm/core/File.h>
+
+#include <frm/core/extern/meshoptimizer/meshoptimizer.h>
+
+#include <cstring>
+
+namespace frm {
+
+namespace {
+
+constexpr uint32 kMagic = 0x434D5246; // 'FRMC'
+
+enum Codec_: uint8
+{
+	Codec_None,
+	Codec_VertexBuffer,  // meshopt_encodeVertexBuffer()
+	Codec_IndexBuffer,   // meshopt_encodeIndexBuffer(), triangle lists only.
+	Codec_IndexSequence  // meshopt_encodeIndexSequence()
+};
+typedef uint8 Codec;
+
+struct FileHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 flags;
+	uint32 vertexCount;
+	uint8  primitive;
+	uint8  indexDataType;
+	uint8  vertexStreamCount;
+	uint8  lodCount;
+	uint32 tableSizeBytes;    // Table immediately follows the header.
+	uint32 dataOffset;        // Section offsets are relative to this.
+	uint32 dataSizeBytes;
+	uint32 userDataOffset;
+	uint32 userDataSizeBytes;
+	uint32 reserved[2];
+};
+static_assert(sizeof(FileHeader) % CookedMesh::kAlignment == 0, "");
+
+struct StreamEntry            // Followed by attributeCount AttributeEntry.
+{
+	uint8  vertexSizeBytes;
+	uint8  alignmentBytes;
+	uint8  attributeCount;
+	Codec  codec;
+	uint32 dataOffset;
+	uint32 dataSizeBytes;     // Encoded size.
+};
+
+struct AttributeEntry
+{
+	sint8  semantic;
+	uint8  dataType;
+	uint8  dataCount;
+	uint8  offsetBytes;
+	uint8  quantization;
+	uint8  pad[3];
+	float  quantizationScale[4];
+	float  quantizationBias[4];
+};
+
+struct LODEntry               // Followed by submeshCount SubmeshEntry.
+{
+	uint32 submeshCount;
+	Codec  codec;
+	uint8  pad[3];
+	uint32 dataOffset;
+	uint32 dataSizeBytes;     // Encoded size.
+};
+
+struct SubmeshEntry
+{
+	uint32 indexOffset;
+	uint32 indexCount;
+	float  boundingBoxMin[3];
+	float  boundingBoxMax[3];
+	float  boundingSphereOrigin[3];
+	float  boundingSphereRadius;
+};
+
+uint32 AlignUp(uint32 _offset)
+{
+	return (_offset + CookedMesh::kAlignment - 1) & ~(CookedMesh::kAlignment - 1);
+}
+
+template <typename tType>
+void Append(eastl::vector<char>& buffer_, const tType& _value)
+{
+	const char* src = (const char*)&_value;
+	buffer_.insert(buffer_.end(), src, src + sizeof(tType));
+}
+
+// Append _sizeBytes from _data to the data section, return the section offset.
+uint32 AppendSection(eastl::vector<char>& buffer_, const void* _data, uint32 _sizeBytes)
+{
+	const uint32 ret = AlignUp((uint32)buffer_.size());
+	buffer_.resize(ret, 0);
+	buffer_.insert(buffer_.end(), (const char*)_data, (const char*)_data + _sizeBytes);
+	return ret;
+}
+
+// Bounds-checked sequential read of the table.
+struct TableReader
+{
+	const char* cursor;
+	const char* end;
+
+	template <typename tType>
+	bool read(tType& value_)
+	{
+		if (cursor + sizeof(tType) > end)
+		{
+			return false;
+		}
+		memcpy(&value_, cursor, sizeof(tType));
+		cursor += sizeof(tType);
+		return true;
+	}
+};
+
+} // namespace
+
+// PUBLIC
+
+void CookedMesh::Cook(CookedMesh& cooked_, const Mesh& _mesh)
+{
+	cooked_.reset();
+	cooked_.primitive     = _mesh.m_primitive;
+	cooked_.indexDataType = _mesh.m_indexDataType;
+	cooked_.vertexCount   = _mesh.m_vertexCount;
+
+	for (const Mesh::VertexData& srcVertexData : _mesh.m_vertexData)
+	{
+		if (!srcVertexData.data)
+		{
+			continue;
+		}
+
+		VertexStream& stream = cooked_.vertexStreams.push_back();
+		VertexAttribute& attribute = stream.attributes.push_back(); // Mesh data is separate, each stream is a single attribute.
+		attribute.semantic = srcVertexData.semantic;
+		attribute.dataType = srcVertexData.dataType;
+		attribute.dataCount = (uint8)srcVertexData.dataCount;
+		attribute.quantization = srcVertexData.quantization;
+		attribute.quantizationScale = srcVertexData.quantizationScale;
+		attribute.quantizationBias = srcVertexData.quantizationBias;
+		stream.vertexSizeBytes = (uint8)srcVertexData.getDataSizeBytes();
+		stream.data = (const char*)srcVertexData.data;
+	}
+
+	for (const Mesh::LOD& srcLod : _mesh.m_lods)
+	{
+		LOD& lod = cooked_.lods.push_back();
+		lod.submeshes = srcLod.submeshes;
+		lod.indexData = (const char*)srcLod.indexData;
+	}
+}
+
+bool CookedMesh::IsCooked(const File& _file)
+{
+	if (_file.getDataSize() < sizeof(FileHeader))
+	{
+		return false;
+	}
+	FileHeader header;
+	memcpy(&header, _file.getData(), sizeof(FileHeader));
+	return header.magic == kMagic && header.version == kVersion;
+}
+
+bool CookedMesh::Read(CookedMesh& cooked_, const File& _file)
+{
+	#define CookedMesh_VERIFY(_cond) \
+		if (!(_cond)) { \
+			FRM_LOG_ERR("CookedMesh: '%s' is invalid (%s)", _file.getPath(), #_cond); \
+			cooked_.reset(); \
+			return false; \
+		}
+
+	cooked_.reset();
+	CookedMesh_VERIFY(IsCooked(_file));
+
+	const char* fileData = _file.getData();
+	const uint  fileSize = _file.getDataSize();
+	FileHeader header;
+	memcpy(&header, fileData, sizeof(FileHeader));
+	CookedMesh_VERIFY(sizeof(FileHeader) + header.tableSizeBytes <= fileSize);
+	CookedMesh_VERIFY((uint64)header.dataOffset + header.dataSizeBytes <= fileSize);
+	CookedMesh_VERIFY((uint64)header.userDataOffset + header.userDataSizeBytes <= header.dataSizeBytes);
+
+	const char* data = fileData + header.dataOffset;
+	auto SectionIsValid = [&header](uint32 _offset, uint32 _sizeBytes)
+		{
+			return _offset % kAlignment == 0 && (uint64)_offset + _sizeBytes <= header.dataSizeBytes;
+		};
+
+	cooked_.primitive     = (Mesh::Primitive)header.primitive;
+	cooked_.indexDataType = (DataType)header.indexDataType;
+	cooked_.vertexCount   = header.vertexCount;
+	CookedMesh_VERIFY(cooked_.primitive > Mesh::Primitive_Invalid && cooked_.primitive < Mesh::Primitive_Count);
+	CookedMesh_VERIFY(cooked_.indexDataType == DataType_Uint16 || cooked_.indexDataType == DataType_Uint32);
+	const uint32 indexSizeBytes = (uint32)DataTypeSizeBytes(cooked_.indexDataType);
+
+	// Parse the table. Sections which need decoding are recorded and decoded below, once the total decoded size is known.
+	struct Decode
+	{
+		const char** dst_;
+		const char*  src;
+		uint32       srcSizeBytes;
+		uint32       count;         // Vertex/index count.
+		uint32       elementSize;   // Vertex/index size.
+		Codec        codec;
+		uint32       dstOffset;
+	};
+	eastl::vector<Decode> decodeList;
+	uint32 decodedSizeBytes = 0;
+	auto AddSection = [&](const char*& dst_, uint32 _offset, uint32 _sizeBytes, Codec _codec, uint32 _count, uint32 _elementSize) -> bool
+		{
+			if (!SectionIsValid(_offset, _sizeBytes))
+			{
+				return false;
+			}
+			if (_codec == Codec_None)
+			{
+				if (_sizeBytes != _count * _elementSize)
+				{
+					return false;
+				}
+				dst_ = data + _offset;
+			}
+			else
+			{
+				decodeList.push_back({ &dst_, data + _offset, _sizeBytes, _count, _elementSize, _codec, decodedSizeBytes });
+				decodedSizeBytes = AlignUp(decodedSizeBytes + _count * _elementSize);
+			}
+			return true;
+		};
+
+	TableReader table = { fileData + sizeof(FileHeader), fileData + sizeof(FileHeader) + header.tableSizeBytes };
+
+	cooked_.vertexStreams.resize(header.vertexStreamCount);
+	for (VertexStream& stream : cooked_.vertexStreams)
+	{
+		StreamEntry streamEntry;
+		CookedMesh_VERIFY(table.read(streamEntry));
+		stream.vertexSizeBytes = streamEntry.vertexSizeBytes;
+		stream.alignmentBytes  = streamEntry.alignmentBytes;
+
+		stream.attributes.resize(streamEntry.attributeCount);
+		for (VertexAttribute& attribute : stream.attributes)
+		{
+			AttributeEntry attributeEntry;
+			CookedMesh_VERIFY(table.read(attributeEntry));
+			attribute.semantic    = attributeEntry.semantic;
+			attribute.dataType    = (DataType)attributeEntry.dataType;
+			attribute.dataCount   = attributeEntry.dataCount;
+			attribute.offsetBytes = attributeEntry.offsetBytes;
+			attribute.quantization = attributeEntry.quantization;
+			memcpy(&attribute.quantizationScale.x, attributeEntry.quantizationScale, sizeof(attributeEntry.quantizationScale));
+			memcpy(&attribute.quantizationBias.x, attributeEntry.quantizationBias, sizeof(attributeEntry.quantizationBias));
+			CookedMesh_VERIFY(attribute.semantic >= Mesh::Semantic_Invalid && attribute.semantic < Mesh::Semantic_Count);
+			CookedMesh_VERIFY(attribute.dataType < DataType_Count);
+			CookedMesh_VERIFY(attribute.quantization < Mesh::Quantization_Count);
+		}
+
+		CookedMesh_VERIFY(streamEntry.codec == Codec_None || streamEntry.codec == Codec_VertexBuffer);
+		CookedMesh_VERIFY(AddSection(stream.data, streamEntry.dataOffset, streamEntry.dataSizeBytes, streamEntry.codec, cooked_.vertexCount, stream.vertexSizeBytes));
+	}
+
+	cooked_.lods.resize(header.lodCount);
+	for (LOD& lod : cooked_.lods)
+	{
+		LODEntry lodEntry;
+		CookedMesh_VERIFY(table.read(lodEntry));
+		CookedMesh_VERIFY(lodEntry.submeshCount > 0);
+
+		lod.submeshes.resize(lodEntry.submeshCount);
+		for (Submesh& submesh : lod.submeshes)
+		{
+			SubmeshEntry submeshEntry;
+			CookedMesh_VERIFY(table.read(submeshEntry));
+			submesh.indexOffset                = submeshEntry.indexOffset;
+			submesh.indexCount                 = submeshEntry.indexCount;
+			submesh.boundingBox.m_min          = vec3(submeshEntry.boundingBoxMin[0], submeshEntry.boundingBoxMin[1], submeshEntry.boundingBoxMin[2]);
+			submesh.boundingBox.m_max          = vec3(submeshEntry.boundingBoxMax[0], submeshEntry.boundingBoxMax[1], submeshEntry.boundingBoxMax[2]);
+			submesh.boundingSphere.m_origin    = vec3(submeshEntry.boundingSphereOrigin[0], submeshEntry.boundingSphereOrigin[1], submeshEntry.boundingSphereOrigin[2]);
+			submesh.boundingSphere.m_radius    = submeshEntry.boundingSphereRadius;
+			CookedMesh_VERIFY((uint64)submesh.indexOffset + submesh.indexCount <= lod.submeshes[0].indexCount);
+		}
+
+		CookedMesh_VERIFY(lodEntry.codec == Codec_None || lodEntry.codec == Codec_IndexBuffer || lodEntry.codec == Codec_IndexSequence);
+		CookedMesh_VERIFY(AddSection(lod.indexData, lodEntry.dataOffset, lodEntry.dataSizeBytes, lodEntry.codec, lod.submeshes[0].indexCount, indexSizeBytes));
+	}
+
+	cooked_.userData          = header.userDataSizeBytes > 0 ? data + header.userDataOffset : nullptr;
+	cooked_.userDataSizeBytes = header.userDataSizeBytes;
+
+	if (!decodeList.empty())
+	{
+		cooked_.m_decodedData = (char*)FRM_MALLOC_ALIGNED(decodedSizeBytes, kAlignment);
+		for (const Decode& decode : decodeList)
+		{
+			char* dst = cooked_.m_decodedData + decode.dstOffset;
+			int err = 0;
+			switch (decode.codec)
+			{
+				default:
+				case Codec_VertexBuffer:
+					err = meshopt_decodeVertexBuffer(dst, decode.count, decode.elementSize, (const unsigned char*)decode.src, decode.srcSizeBytes);
+					break;
+				case Codec_IndexBuffer:
+					err = meshopt_decodeIndexBuffer(dst, decode.count, decode.elementSize, (const unsigned char*)decode.src, decode.srcSizeBytes);
+					break;
+				case Codec_IndexSequence:
+					err = meshopt_decodeIndexSequence(dst, decode.count, decode.elementSize, (const unsigned char*)decode.src, decode.srcSizeBytes);
+					break;
+			};
+			CookedMesh_VERIFY(err == 0);
+			*decode.dst_ = dst;
+		}
+	}
+
+	#undef CookedMesh_VERIFY
+
+	return true;
+}
+
+bool CookedMesh::Write(const CookedMesh& _cooked, File& file_, Flags _flags)
+{
+	FRM_ASSERT(_cooked.indexDataType == DataType_Uint16 || _cooked.indexDataType == DataType_Uint32);
+	FRM_ASSERT(_cooked.vertexStreams.size() <= 0xff && _cooked.lods.size() <= 0xff);
+
+	eastl::vector<char> table;
+	eastl::vector<char> data;
+	eastl::vector<unsigned char> encoded;
+
+	for (const VertexStream& stream : _cooked.vertexStreams)
+	{
+		FRM_ASSERT(stream.data || _cooked.vertexCount == 0);
+		const uint32 dataSizeBytes = _cooked.vertexCount * stream.vertexSizeBytes;
+
+		StreamEntry streamEntry = {};
+		streamEntry.vertexSizeBytes = stream.vertexSizeBytes;
+		streamEntry.alignmentBytes  = stream.alignmentBytes;
+		streamEntry.attributeCount  = (uint8)stream.attributes.size();
+		streamEntry.codec           = Codec_None;
+
+		if ((_flags & Flags_CompressVertexData) && stream.vertexSizeBytes % 4 == 0 && _cooked.vertexCount > 0)
+		{
+			encoded.resize(meshopt_encodeVertexBufferBound(_cooked.vertexCount, stream.vertexSizeBytes));
+			const size_t encodedSizeBytes = meshopt_encodeVertexBuffer(encoded.data(), encoded.size(), stream.data, _cooked.vertexCount, stream.vertexSizeBytes);
+			if (encodedSizeBytes > 0 && encodedSizeBytes < dataSizeBytes)
+			{
+				streamEntry.codec         = Codec_VertexBuffer;
+				streamEntry.dataSizeBytes = (uint32)encodedSizeBytes;
+				streamEntry.dataOffset    = AppendSection(data, encoded.data(), streamEntry.dataSizeBytes);
+			}
+		}
+		if (streamEntry.codec == Codec_None)
+		{
+			streamEntry.dataSizeBytes = dataSizeBytes;
+			streamEntry.dataOffset    = AppendSection(data, stream.data, dataSizeBytes);
+		}
+
+		Append(table, streamEntry);
+		for (const VertexAttribute& attribute : stream.attributes)
+		{
+			AttributeEntry attributeEntry = {};
+			attributeEntry.semantic     = (sint8)attribute.semantic;
+			attributeEntry.dataType     = (uint8)attribute.dataType;
+			attributeEntry.dataCount    = attribute.dataCount;
+			attributeEntry.offsetBytes  = attribute.offsetBytes;
+			attributeEntry.quantization = (uint8)attribute.quantization;
+			memcpy(attributeEntry.quantizationScale, &attribute.quantizationScale.x, sizeof(attributeEntry.quantizationScale));
+			memcpy(attributeEntry.quantizationBias, &attribute.quantizationBias.x, sizeof(attributeEntry.quantizationBias));
+			Append(table, attributeEntry);
+		}
+	}
+
+	for (int lodIndex = 0; lodIndex < (int)_cooked.lods.size(); ++lodIndex)
+	{
+		const LOD& lod = _cooked.lods[lodIndex];
+		FRM_ASSERT(!lod.submeshes.empty());
+		const uint32 indexCount    = lod.submeshes[0].indexCount;
+		const uint32 dataSizeBytes = _cooked.getIndexDataSizeBytes(lodIndex);
+
+		LODEntry lodEntry = {};
+		lodEntry.submeshCount = (uint32)lod.submeshes.size();
+		lodEntry.codec        = Codec_None;
+
+		if ((_flags & Flags_CompressIndexData) && indexCount > 0)
+		{
+			// The index buffer codec is more efficient but requires triangle lists.
+			const bool isTriangleList = _cooked.primitive == Mesh::Primitive_Triangles && indexCount % 3 == 0;
+			size_t encodedSizeBytes = 0;
+			if (isTriangleList)
+			{
+				encoded.resize(meshopt_encodeIndexBufferBound(indexCount, _cooked.vertexCount));
+				encodedSizeBytes = _cooked.indexDataType == DataType_Uint16
+					? meshopt_encodeIndexBuffer(encoded.data(), encoded.size(), (const uint16*)lod.indexData, indexCount)
+					: meshopt_encodeIndexBuffer(encoded.data(), encoded.size(), (const uint32*)lod.indexData, indexCount)
+					;
+			}
+			else
+			{
+				encoded.resize(meshopt_encodeIndexSequenceBound(indexCount, _cooked.vertexCount));
+				encodedSizeBytes = _cooked.indexDataType == DataType_Uint16
+					? meshopt_encodeIndexSequence(encoded.data(), encoded.size(), (const uint16*)lod.indexData, indexCount)
+					: meshopt_encodeIndexSequence(encoded.data(), encoded.size(), (const uint32*)lod.indexData, indexCount)
+					;
+			}
+
+			if (encodedSizeBytes > 0 && encodedSizeBytes < dataSizeBytes)
+			{
+				lodEntry.codec         = isTriangleList ? Codec_IndexBuffer : Codec_IndexSequence;
+				lodEntry.dataSizeBytes = (uint32)encodedSizeBytes;
+				lodEntry.dataOffset    = AppendSection(data, encoded.data(), lodEntry.dataSizeBytes);
+			}
+		}
+		if (lodEntry.codec == Codec_None)
+		{
+			lodEntry.dataSizeBytes = dataSizeBytes;
+			lodEntry.dataOffset    = AppendSection(data, lod.indexData, dataSizeBytes);
+		}
+
+		Append(table, lodEntry);
+		for (const Submesh& submesh : lod.submeshes)
+		{
+			SubmeshEntry submeshEntry;
+			submeshEntry.indexOffset             = submesh.indexOffset;
+			submeshEntry.indexCount              = submesh.indexCount;
+			memcpy(submeshEntry.boundingBoxMin,       &submesh.boundingBox.m_min,       sizeof(float) * 3);
+			memcpy(submeshEntry.boundingBoxMax,       &submesh.boundingBox.m_max,       sizeof(float) * 3);
+			memcpy(submeshEntry.boundingSphereOrigin, &submesh.boundingSphere.m_origin, sizeof(float) * 3);
+			submeshEntry.boundingSphereRadius    = submesh.boundingSphere.m_radius;
+			Append(table, submeshEntry);
+		}
+	}
+
+	FileHeader header = {};
+	header.magic             = kMagic;
+	header.version           = kVersion;
+	header.flags             = _flags;
+	header.vertexCount       = _cooked.vertexCount;
+	header.primitive         = (uint8)_cooked.primitive;
+	header.indexDataType     = (uint8)_cooked.indexDataType;
+	header.vertexStreamCount = (uint8)_cooked.vertexStreams.size();
+	header.lodCount          = (uint8)_cooked.lods.size();
+	header.tableSizeBytes    = (uint32)table.size();
+	header.dataOffset        = AlignUp((uint32)(sizeof(FileHeader) + table.size()));
+	header.userDataSizeBytes = _cooked.userDataSizeBytes;
+	header.userDataOffset    = _cooked.userDataSizeBytes > 0 ? AppendSection(data, _cooked.userData, _cooked.userDataSizeBytes) : 0;
+	header.dataSizeBytes     = (uint32)data.size();
+
+	// Append a null so that File::Write() doesn't strip a trailing zero byte from the data.
+	const uint32 fileSizeBytes = header.dataOffset + header.dataSizeBytes;
+	file_.setData(nullptr, fileSizeBytes + 1);
+	char* dst = file_.getData();
+	memcpy(dst, &header, sizeof(FileHeader));
+	if (!table.empty())
+	{
+		memcpy(dst + sizeof(FileHeader), table.data(), table.size());
+	}
+	if (!data.empty())
+	{
+		memcpy(dst + header.dataOffset, data.data(), data.size());
+	}
+
+	return true;
+}
+
+CookedMesh::~CookedMesh()
+{
+	reset();
+}
+
+// PRIVATE
+
+void CookedMesh::reset()
+{
+	primitive         = Mesh::Primitive_Triangles;
+	indexDataType     = DataType_Uint32;
+	vertexCount       = 0;
+	vertexStreams.clear();
+	lods.clear();
+	userData          = nullptr;
+	userDataSizeBytes = 0;
+	if (m_decodedData)
+	{
+		FRM_FREE_ALIGNED(m_decodedData);
+		m_decodedData = nullptr;
+	}
+}
+
+} // namespace frm
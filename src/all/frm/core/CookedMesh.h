@@ -0,0 +1,108 @@
+#pragma once
+
+#include <frm/core/frm.h>
+#include <frm/core/Mesh.h>
+
+#include <EASTL/vector.h>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// CookedMesh
+// Finalized, optimized vertex/index streams ready for upload to the GPU (see
+// DrawMesh). The file format is designed such that loading is a single read
+// plus an upload, with no parsing or processing of the data.
+//
+// File layout (little endian):
+//   Header      magic 'FRMC', version, flags, counts.
+//   Table       Vertex stream layouts and LOD/submesh descriptions, plus the
+//               offset and size of each data section.
+//   Data        Vertex streams, index data per LOD and user data (e.g. a
+//               skeleton). Each section is aligned to kAlignment.
+// Vertex/index data may optionally be compressed with the meshoptimizer codecs,
+// in which case it is decoded on read (decoding is typically faster than
+// reading the equivalent uncompressed data from disk).
+//
+// On read, uncompressed data is referenced directly from the file, hence the
+// file must outlive the CookedMesh.
+////////////////////////////////////////////////////////////////////////////////
+class CookedMesh: private non_copyable<CookedMesh>
+{
+public:
+
+	static constexpr uint32 kVersion   = 2;
+	static constexpr uint32 kAlignment = 16; // Alignment of data sections in the file.
+
+	enum Flags_
+	{
+		Flags_None               = 0,
+		Flags_CompressVertexData = 1 << 0, // meshopt vertex codec. Streams whose vertex size isn't a multiple of 4 bytes are stored uncompressed.
+		Flags_CompressIndexData  = 1 << 1, // meshopt index codec.
+
+		Flags_Compress           = Flags_CompressVertexData | Flags_CompressIndexData
+	};
+	typedef uint32 Flags;
+
+	using Submesh = Mesh::Submesh;
+
+	struct VertexAttribute
+	{
+		Mesh::VertexDataSemantic semantic          = Mesh::Semantic_Invalid; // Semantic_Invalid for padding.
+		DataType                 dataType          = DataType_Invalid;
+		uint8                    dataCount         = 0;
+		uint8                    offsetBytes       = 0;
+		Mesh::Quantization       quantization      = Mesh::Quantization_None; // See Mesh::finalize().
+		vec4                     quantizationScale = vec4(1.0f);              // Mesh::Quantization_Range16 only.
+		vec4                     quantizationBias  = vec4(0.0f);              //                "
+	};
+
+	struct VertexStream
+	{
+		uint8                          vertexSizeBytes = 0;
+		uint8                          alignmentBytes  = 4;
+		eastl::vector<VertexAttribute> attributes;
+		const char*                    data            = nullptr; // vertexCount * vertexSizeBytes.
+	};
+
+	struct LOD
+	{
+		eastl::vector<Submesh>         submeshes;                 // Submesh 0 represents the whole LOD, index offsets are in indices.
+		const char*                    indexData       = nullptr; // submeshes[0].indexCount indices.
+	};
+
+	Mesh::Primitive                    primitive         = Mesh::Primitive_Triangles;
+	DataType                           indexDataType     = DataType_Uint32;
+	uint32                             vertexCount       = 0;
+	eastl::vector<VertexStream>        vertexStreams;
+	eastl::vector<LOD>                 lods;
+	const char*                        userData          = nullptr;
+	uint32                             userDataSizeBytes = 0;
+
+	// Reference the vertex/index data from _mesh (usually after Mesh::finalize()). Each vertex data semantic is a separate stream. _mesh
+	// must outlive the CookedMesh.
+	static void Cook(CookedMesh& cooked_, const Mesh& _mesh);
+
+	// Return true if _file begins with a valid header.
+	static bool IsCooked(const File& _file);
+
+	// Read from _file. Return false if _file is invalid.
+	static bool Read(CookedMesh& cooked_, const File& _file);
+
+	// Write to file_.
+	static bool Write(const CookedMesh& _cooked, File& file_, Flags _flags = Flags_None);
+
+	CookedMesh() = default;
+	~CookedMesh();
+
+	// Size of the index data for _lod in bytes.
+	uint32      getIndexDataSizeBytes(int _lod) const { return lods[_lod].submeshes.empty() ? 0 : lods[_lod].submeshes[0].indexCount * (uint32)DataTypeSizeBytes(indexDataType); }
+
+private:
+
+	char* m_decodedData = nullptr; // Storage for compressed data after decoding, kAlignment aligned.
+
+	void reset();
+
+}; // class CookedMesh
+
+} // namespace frm
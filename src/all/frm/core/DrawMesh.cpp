@@ -1,19 +1,24 @@
 #include "DrawMesh.h"
 
 #include <frm/core/gl.h>
+#include <frm/core/hash.h>
 #include <frm/core/log.h>
 #include <frm/core/memory.h>
+#include <frm/core/CookedMesh.h>
 #include <frm/core/File.h>
 #include <frm/core/FileSystem.h>
 #include <frm/core/GlContext.h>
 #include <frm/core/Json.h>
 #include <frm/core/Resource.h>
 #include <frm/core/Serializer.h>
+#include <frm/core/SerializerBinary.h>
 #include <frm/core/SkeletonAnimation.h>
 #include <frm/core/Time.h>
 
 #define DRAW_MESH_ENABLE_CACHE 1
 
+static const frm::Mesh::FinalizeOptions kDefaultFinalizeOptions;
+
 static GLenum PrimitiveToGl(frm::Mesh::Primitive _prim)
 {
 	switch (_prim)
@@ -47,6 +52,8 @@ namespace frm {
 
 // PUBLIC
 
+Mesh::FinalizeOptions DrawMesh::s_finalizeOptions;
+
 DrawMesh* DrawMesh::CreateUnique(Mesh::Primitive _primitive, const VertexLayout& _vertexLayout)
 {
 	DrawMesh* ret = FRM_NEW(DrawMesh(GetUniqueId(), ""));
@@ -73,7 +80,7 @@ DrawMesh* DrawMesh::Create(Mesh& _mesh, const VertexLayout& _vertexLayout)
 
 DrawMesh* DrawMesh::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	DrawMesh* ret = Find(id);
 	if (!ret)
 	{
@@ -113,35 +120,67 @@ bool DrawMesh::reload()
 	else
 	{
 		// Path is not a DrawMesh, check the cache.
-		cachedPath.setf("_cache/%s.drawmesh", FileSystem::GetFileName(m_path.c_str()).c_str());
+		// Non-default finalize options produce different data, hence are cached separately.
+		if (memcmp(&s_finalizeOptions, &kDefaultFinalizeOptions, sizeof(Mesh::FinalizeOptions)) == 0)
+		{
+			cachedPath.setf("_cache/%s.drawmesh", FileSystem::GetFileName(m_path.c_str()).c_str());
+		}
+		else
+		{
+			cachedPath.setf("_cache/%s.%016llx.drawmesh", FileSystem::GetFileName(m_path.c_str()).c_str(), (unsigned long long)HashContent64(&s_finalizeOptions, sizeof(Mesh::FinalizeOptions)));
+		}
 
-		if (DRAW_MESH_ENABLE_CACHE && FileSystem::Exists(cachedPath.c_str()))
+		if (DRAW_MESH_ENABLE_CACHE && FileSystem::IsCacheValid(cachedPath.c_str(), m_path.c_str()))
 		{
-			DateTime sourceDate = FileSystem::GetTimeModified(m_path.c_str());
-			DateTime cachedDate = FileSystem::GetTimeModified(cachedPath.c_str());
-			if (sourceDate <= cachedDate)
+			FRM_LOG("DrawMesh: Loading cached data '%s'", cachedPath.c_str());
+			if (!FileSystem::Read(cachedData, cachedPath.c_str()))
 			{
-				FRM_LOG("DrawMesh: Loading cached data '%s'", cachedPath.c_str());
-				if (!FileSystem::Read(cachedData, cachedPath.c_str()))
-				{
-					FRM_LOG_ERR("DrawMesh: Error loading cached data '%s'", cachedPath.c_str());
-					return false;
-				}
+				FRM_LOG_ERR("DrawMesh: Error loading cached data '%s'", cachedPath.c_str());
+				return false;
+			}
+
+			// Cached data written by an older version is rebuilt.
+			if (!CookedMesh::IsCooked(cachedData))
+			{
+				FRM_LOG("DrawMesh: Cached data '%s' is out of date", cachedPath.c_str());
+				cachedData.setData(nullptr, 0);
 			}
 		}
 	}
 
 	if (cachedData.getDataSize() > 0)
 	{
-		// If we loaded DrawMesh data (either directly or from the cache) we can serrialize here.
-		Json json;
-		FRM_VERIFY(Json::Read(json, cachedData));
-		SerializerJson serializer(json, SerializerJson::Mode_Read);
-
-		if (!serialize(serializer))
+		// If we loaded DrawMesh data (either directly or from the cache) we can serialize here. Cached data is a CookedMesh, .drawmesh
+		// files may be binary or Json.
+		if (CookedMesh::IsCooked(cachedData))
 		{
-			FRM_LOG_ERR("Error serializing '%s': %s", cachedPath.c_str(), serializer.getError());
-			return false;
+			CookedMesh cookedMesh;
+			if (!CookedMesh::Read(cookedMesh, cachedData) || !load(cookedMesh))
+			{
+				FRM_LOG_ERR("Error loading cooked mesh '%s'", cachedPath.c_str());
+				return false;
+			}
+		}
+		else if (SerializerBinary::IsBinary(cachedData))
+		{
+			SerializerBinary serializer(SerializerBinary::Mode_Read);
+			if (!SerializerBinary::Read(serializer, cachedData) || !serialize(serializer))
+			{
+				FRM_LOG_ERR("Error serializing '%s': %s", cachedPath.c_str(), serializer.getError() ? serializer.getError() : "invalid data");
+				return false;
+			}
+		}
+		else
+		{
+			Json json;
+			FRM_VERIFY(Json::Read(json, cachedData));
+			SerializerJson serializer(json, SerializerJson::Mode_Read);
+
+			if (!serialize(serializer))
+			{
+				FRM_LOG_ERR("Error serializing '%s': %s", cachedPath.c_str(), serializer.getError());
+				return false;
+			}
 		}
 		return true;
 	}
@@ -154,17 +193,36 @@ bool DrawMesh::reload()
 			return false;
 		}
 		
-		data->finalize(); // Convert mesh data buffers to minimal precision format.
-		FRM_VERIFY(load(*data, VertexLayout()));
-		Mesh::Destroy(data);
+		data->finalize(s_finalizeOptions); // Convert mesh data buffers to minimal precision format.
+		
+		// Cook and cache the result, the skeleton (if any) is stored as user data.
+		CookedMesh cookedMesh;
+		CookedMesh::Cook(cookedMesh, *data);
+		File skeletonData;
+		if (data->getSkeleton())
+		{
+			SerializerBinary serializer(SerializerBinary::Mode_Write);
+			if (serializer.beginObject("m_skeleton"))
+			{
+				FRM_VERIFY(data->getSkeleton()->serialize(serializer));
+				serializer.endObject();
+			}
+			SerializerBinary::Write(serializer, skeletonData);
+			cookedMesh.userData = skeletonData.getData();
+			cookedMesh.userDataSizeBytes = (uint32)skeletonData.getDataSize();
+		}
+		FRM_VERIFY(load(cookedMesh));
 
-		// Cache the result.
-		Json json;
-		SerializerJson serializer(json, SerializerJson::Mode_Write);
-		FRM_VERIFY(serialize(serializer));
+		if (DRAW_MESH_ENABLE_CACHE)
+		{
+			CookedMesh::Write(cookedMesh, cachedData, CookedMesh::Flags_Compress);
+			if (FileSystem::Write(cachedData, cachedPath.c_str()))
+			{
+				FileSystem::SetCacheSource(cachedPath.c_str(), m_path.c_str());
+			}
+		}
 
-		Json::Write(json, cachedData);
-		FileSystem::Write(cachedData, cachedPath.c_str());
+		Mesh::Destroy(data);
 	}
 
 	return true;
@@ -410,6 +468,22 @@ DrawMesh::BindHandleKey DrawMesh::makeBindHandleKey(const VertexSemantic _attrib
 	return ret;
 }
 
+const DrawMesh::VertexLayout::VertexAttribute* DrawMesh::findVertexAttribute(VertexSemantic _semantic) const
+{
+	for (const VertexData& vertexData : m_vertexData)
+	{
+		for (const VertexLayout::VertexAttribute& attribute : vertexData.layout.attributes)
+		{
+			if (attribute.semantic == _semantic)
+			{
+				return &attribute;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
 const mat4* DrawMesh::getBindPose() const
 {
 	return m_skeleton ? m_skeleton->getPose() : nullptr;
@@ -490,111 +564,68 @@ GLuint DrawMesh::findOrCreateBindHandle(int _lodIndex, uint16 _bindHandleKey)
 
 bool DrawMesh::load(const Mesh& _src, const VertexLayout& _vertexLayout)
 {
-	unload();
-
-	m_path = _src.m_path;
-	m_primitive = PrimitiveToGl(_src.m_primitive);
-	
-	#if 0
-	// Deinterleave vertex data.
-	const uint32 vertexCount = (uint32)_DrawMeshData.getVertexCount();
-	const uint32 vertexSizeBytes = desc.getVertexSize();
-	const char* interleavedData = (const char*)_DrawMeshData.getVertexData();
-	for (int attrIndex = 0; attrIndex < desc.getVertexAttrCount(); ++attrIndex)
+	CookedMesh cookedMesh;
+	CookedMesh::Cook(cookedMesh, _src);
+	if (!load(cookedMesh))
 	{
-		const VertexAttr& attr = desc[attrIndex];
-		VertexData vertexData;
-		switch (attr.getSemantic())
-		{
-			case VertexAttr::Semantic_Padding:
-			default:                               continue;
-			case VertexAttr::Semantic_Positions:   vertexData.semantic = VertexSemantic::Positions;   break;
-			case VertexAttr::Semantic_Normals:     vertexData.semantic = VertexSemantic::Normals;     break;
-			case VertexAttr::Semantic_Tangents:    vertexData.semantic = VertexSemantic::Tangents;    break;
-			case VertexAttr::Semantic_Texcoords:   vertexData.semantic = VertexSemantic::MaterialUVs; break;
-			case VertexAttr::Semantic_Colors:      vertexData.semantic = VertexSemantic::Colors;      break;
-			case VertexAttr::Semantic_BoneWeights: vertexData.semantic = VertexSemantic::BoneWeights; break;
-			case VertexAttr::Semantic_BoneIndices: vertexData.semantic = VertexSemantic::BoneIndices; break;			
-		};
-		vertexData.count = attr.getCount();
-		vertexData.type  = attr.getDataType();
-
-		const uint32 attrSizeBytes = attr.getSize();
-		char* deinterleavedData = (char*)FRM_MALLOC(attrSizeBytes * vertexCount);
-		for (uint32 vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
-		{
-			memcpy(
-				deinterleavedData + vertexIndex * attrSizeBytes,
-				interleavedData   + vertexIndex * vertexSizeBytes + attr.getOffset(),
-				attrSizeBytes
-				);
-		}
-
-		glAssert(glGenBuffers(1, &vertexData.buffer));
-		glScopedBufferBinding(GL_ARRAY_BUFFER);
-		glAssert(glBindBuffer(GL_ARRAY_BUFFER, vertexData.buffer)); // \todo This shouldn't be required however glNamedBufferData() fails with GL_INVALID_OPERATION without it.
-		glAssert(glNamedBufferData(vertexData.buffer, vertexCount * attrSizeBytes, deinterleavedData, GL_STATIC_DRAW));
-		
-		FRM_FREE(deinterleavedData);
-
-		m_vertexData[vertexData.semantic] = vertexData;
+		return false;
 	}
 
-	// Init a single LOD.
-	m_lods.push_back();
-	LOD& lod = m_lods.back();
-	glAssert(glGenBuffers(1, &lod.indexBuffer));
-	glScopedBufferBinding(GL_ELEMENT_ARRAY_BUFFER);
-	glAssert(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lod.indexBuffer)); // \todo See above.
-	glAssert(glNamedBufferData(lod.indexBuffer, _DrawMeshData.getIndexCount() * DataTypeSizeBytes(_DrawMeshData.getIndexDataType()), _DrawMeshData.getIndexData(), GL_STATIC_DRAW));
-	lod.indexType = internal::DataTypeToGLenum(_DrawMeshData.getIndexDataType());
-	lod.subDrawMeshes = _DrawMeshData.m_subDrawMeshes;
-
-	if (_DrawMeshData.getSkeleton())
+	m_path = _src.m_path;
+	if (_src.m_skeleton)
 	{
 		if (!m_skeleton)
 		{
 			m_skeleton = FRM_NEW(Skeleton);
 		}
 
-		*m_skeleton = *_DrawMeshData.getSkeleton();
+		*m_skeleton = *_src.m_skeleton;
 	}
 
-	#endif
+	return true;
+}
+
+bool DrawMesh::load(const CookedMesh& _src)
+{
+	unload();
+
+	m_primitive = PrimitiveToGl(_src.primitive);
 
 	glScopedBufferBinding(GL_ARRAY_BUFFER);
 	glScopedBufferBinding(GL_ELEMENT_ARRAY_BUFFER);
 
-	m_vertexCount = _src.m_vertexCount;
-	for (const Mesh::VertexData& srcVertexData : _src.m_vertexData)
+	m_vertexCount = _src.vertexCount;
+	for (const CookedMesh::VertexStream& srcStream : _src.vertexStreams)
 	{
-		if (!srcVertexData.data)
+		VertexData& dstVertexData = m_vertexData.push_back();
+		dstVertexData.layout.vertexSizeBytes = srcStream.vertexSizeBytes;
+		dstVertexData.layout.alignmentBytes = srcStream.alignmentBytes;
+		for (const CookedMesh::VertexAttribute& srcAttribute : srcStream.attributes)
 		{
-			continue;
+			VertexLayout::VertexAttribute& attribute = dstVertexData.layout.attributes.push_back();
+			attribute.semantic = srcAttribute.semantic;
+			attribute.dataType = srcAttribute.dataType;
+			attribute.dataCount = srcAttribute.dataCount;
+			attribute.offsetBytes = srcAttribute.offsetBytes;
+			attribute.quantization = srcAttribute.quantization;
+			attribute.quantizationScale = srcAttribute.quantizationScale;
+			attribute.quantizationBias = srcAttribute.quantizationBias;
 		}
-
-		const uint32 srcDataSizeBytes = srcVertexData.getDataSizeBytes() * _src.m_vertexCount;
-
-		VertexData& dstVertexData = m_vertexData.push_back();
-		VertexLayout::VertexAttribute& attribute = dstVertexData.layout.attributes.push_back(); // Mesh data is separate, layout per vertex data is a single attribute.
-		attribute.semantic = srcVertexData.semantic;
-		attribute.dataType = srcVertexData.dataType;
-		attribute.dataCount = srcVertexData.dataCount;
-		dstVertexData.layout.vertexSizeBytes = (int)DataTypeSizeBytes(srcVertexData.dataType) * srcVertexData.dataCount;
 		glAssert(glGenBuffers(1, &dstVertexData.buffer));
 		glAssert(glBindBuffer(GL_ARRAY_BUFFER, dstVertexData.buffer)); // \todo This shouldn't be required however glNamedBufferData() fails with GL_INVALID_OPERATION without it.
-		glAssert(glNamedBufferData(dstVertexData.buffer, srcDataSizeBytes, srcVertexData.data, GL_STATIC_DRAW));
+		glAssert(glNamedBufferData(dstVertexData.buffer, srcStream.vertexSizeBytes * _src.vertexCount, srcStream.data, GL_STATIC_DRAW));
 	}
 
-	const uint32 indexSizeBytes = (uint32)DataTypeSizeBytes(_src.m_indexDataType);
-	m_indexDataType = internal::DataTypeToGLenum(_src.m_indexDataType);
-	for (const Mesh::LOD& srcLod : _src.m_lods)
+	const uint32 indexSizeBytes = (uint32)DataTypeSizeBytes(_src.indexDataType);
+	m_indexDataType = internal::DataTypeToGLenum(_src.indexDataType);
+	for (int lodIndex = 0; lodIndex < (int)_src.lods.size(); ++lodIndex)
 	{
+		const CookedMesh::LOD& srcLod = _src.lods[lodIndex];
 		LOD& dstLod = m_lods.push_back();
 		dstLod.submeshes = srcLod.submeshes;
 		glAssert(glGenBuffers(1, &dstLod.indexBuffer));
 		glAssert(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, dstLod.indexBuffer)); // \todo See above.
-		glAssert(glNamedBufferData(dstLod.indexBuffer, srcLod.submeshes[0].indexCount * indexSizeBytes, srcLod.indexData, GL_STATIC_DRAW));
+		glAssert(glNamedBufferData(dstLod.indexBuffer, _src.getIndexDataSizeBytes(lodIndex), srcLod.indexData, GL_STATIC_DRAW));
 				
 		// Convert submesh offsets to bytes.
 		for (Submesh& submesh : dstLod.submeshes)
@@ -603,14 +634,21 @@ bool DrawMesh::load(const Mesh& _src, const VertexLayout& _vertexLayout)
 		}
 	}
 
-	if (_src.m_skeleton)
+	if (_src.userDataSizeBytes > 0)
 	{
-		if (!m_skeleton)
+		// User data is a binary stream containing the skeleton.
+		File userData;
+		userData.setDataExternal((char*)_src.userData, _src.userDataSizeBytes);
+		SerializerBinary serializer(SerializerBinary::Mode_Read);
+		if (SerializerBinary::Read(serializer, userData) && serializer.beginObject("m_skeleton"))
 		{
 			m_skeleton = FRM_NEW(Skeleton);
+			if (!m_skeleton->serialize(serializer))
+			{
+				FRM_LOG_ERR("DrawMesh: Error reading skeleton '%s'", m_path.c_str());
+			}
+			serializer.endObject();
 		}
-
-		*m_skeleton = *_src.m_skeleton;
 	}
 
 	setState(State_Loaded);
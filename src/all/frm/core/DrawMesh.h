@@ -11,6 +11,8 @@
 
 namespace frm {
 
+class CookedMesh;
+
 ////////////////////////////////////////////////////////////////////////////////
 // DrawMesh
 // Wraps vertex/index buffers for rendering.
@@ -35,10 +37,13 @@ public:
 	{
 		struct VertexAttribute
 		{
-			VertexSemantic semantic     = Mesh::Semantic_Invalid;
-			DataType       dataType     = DataType_Invalid;
-			uint8          dataCount    = 0;
-			uint8          offsetBytes  = 0;
+			VertexSemantic     semantic          = Mesh::Semantic_Invalid;
+			DataType           dataType          = DataType_Invalid;
+			uint8              dataCount         = 0;
+			uint8              offsetBytes       = 0;
+			Mesh::Quantization quantization      = Mesh::Quantization_None; // See Mesh::finalize(), shaders must decode non-trivial encodings.
+			vec4               quantizationScale = vec4(1.0f);              // Mesh::Quantization_Range16 only.
+			vec4               quantizationBias  = vec4(0.0f);              //                "
 
 			VertexAttribute() = default;
 
@@ -71,6 +76,10 @@ public:
 	static DrawMesh*   Create(const char* _path);
 	static void        Destroy(DrawMesh*& _inst_);
 
+	// Quantization options applied when loading from a source mesh (see Mesh::finalize()). This only affects meshes loaded subsequently.
+	static void        SetFinalizeOptions(const Mesh::FinalizeOptions& _options) { s_finalizeOptions = _options; }
+	static const Mesh::FinalizeOptions& GetFinalizeOptions()                     { return s_finalizeOptions; }
+
 	bool               load()   { return reload(); }
 	bool               reload();
 	bool               serialize(Serializer& _serializer_);
@@ -82,6 +91,9 @@ public:
 
 	BindHandleKey      makeBindHandleKey(const VertexSemantic _attributeList[], uint32 _attributeCount) const;
 
+	// Return the vertex attribute for _semantic (e.g. to get the quantization), or nullptr if not present.
+	const VertexLayout::VertexAttribute* findVertexAttribute(VertexSemantic _semantic) const;
+
 	const int          getSubmeshCount() const                     { return (int)m_lods[0].submeshes.size(); }
 	const int          getLODCount() const                         { return (int)m_lods.size(); }
 	const AlignedBox&  getBoundingBox(int _submesh = 0) const      { return m_lods[0].submeshes[_submesh].boundingBox;    }
@@ -111,6 +123,8 @@ private:
 
 	using VertexDataList = eastl::vector<VertexData>;
 
+	static Mesh::FinalizeOptions s_finalizeOptions;
+
 	VertexDataList     m_vertexData;
 	eastl::vector<LOD> m_lods;
 	GLenum             m_primitive     = GL_TRIANGLES;
@@ -129,6 +143,9 @@ private:
 	// Load from Mesh.
 	bool               load(const Mesh& _src, const VertexLayout& _vertexLayout);
 
+	// Load vertex/index data from CookedMesh.
+	bool               load(const CookedMesh& _src);
+
 	// Release GPU resources, etc.
 	void               unload();
 
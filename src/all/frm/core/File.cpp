@@ -1,41 +1,180 @@
 #include "File.h"
 
+#include <frm/core/hash.h>
 #include <frm/core/memory.h>
+#include <frm/core/math.h>
+
+#include <cstring>
 
 namespace frm {
 
+static void FreeOwnedData(char* _data, uint _size, void* _arg)
+{
+	FRM_FREE(_data);
+}
+
 // PUBLIC
 
 void File::setData(const char* _data, uint _size)
 {
-	m_data.reserve(_size);
+	if (_size == 0)
+	{
+		freeData();
+		return;
+	}
+
+	char* data = m_data;
+	if (isDataExternal() || m_dataCapacity < _size)
+	{
+		data = (char*)FRM_MALLOC(_size);
+	}
 	if (_data)
 	{
-		m_data.assign(_data, _data + _size);
+		memmove(data, _data, _size); // _data may point to the current buffer
 	}
 	else
 	{
-		m_data.assign(_size, '\0');
+		memset(data, 0, _size);
+	}
+	if (data != m_data)
+	{
+		freeData();
+		m_data = data;
+		m_dataCapacity = _size;
 	}
+	m_dataSize = _size;
 }
 
 void File::appendData(const char* _data, uint _size)
 {
-	uint currentSize = getDataSize() - 1;
-	m_data.reserve(currentSize + _size);
+	if (_size == 0)
+	{
+		return;
+	}
+
+	// Insert before the implicit null character, if present.
+	const uint currentSize = (m_dataSize > 0 && m_data[m_dataSize - 1] == '\0') ? m_dataSize - 1 : m_dataSize;
+	const uint newSize = m_dataSize + _size;
+	if (isDataExternal() || m_dataCapacity < newSize)
+	{
+		makeOwned(Max(newSize, m_dataCapacity * 2));
+	}
+	memmove(m_data + currentSize + _size, m_data + currentSize, m_dataSize - currentSize);
 	if (_data)
 	{
-		m_data.insert(m_data.begin() + currentSize, _data, _data + _size);
+		memcpy(m_data + currentSize, _data, _size);
 	}
 	else
 	{
-		m_data.insert(m_data.begin() + currentSize, _size, '\0');
+		memset(m_data + currentSize, 0, _size);
 	}
+	m_dataSize = newSize;
 }
 
 void File::reserveData(uint _capacity)
 {
-	m_data.reserve(_capacity);
+	if (isDataExternal() || m_dataCapacity < _capacity)
+	{
+		makeOwned(Max(_capacity, m_dataSize));
+	}
+}
+
+void File::setDataExternal(char* _data, uint _size, ReleaseFunc* _release, void* _releaseArg)
+{
+	FRM_ASSERT(_data || _size == 0);
+	freeData();
+	m_data         = _data;
+	m_dataSize     = _size;
+	m_dataCapacity = 0;
+	m_release      = _release;
+	m_releaseArg   = _releaseArg;
+}
+
+char* File::releaseData(uint& size_, ReleaseFunc*& release_, void*& releaseArg_)
+{
+	char* ret = m_data;
+	size_ = m_dataSize;
+	if (isDataExternal())
+	{
+		release_    = m_release;
+		releaseArg_ = m_releaseArg;
+	}
+	else
+	{
+		release_    = ret ? &FreeOwnedData : nullptr;
+		releaseArg_ = nullptr;
+	}
+
+	m_data         = nullptr;
+	m_dataSize     = 0;
+	m_dataCapacity = 0;
+	m_release      = nullptr;
+	m_releaseArg   = nullptr;
+
+	return ret;
+}
+
+uint64 File::getHash() const
+{
+	uint size = m_dataSize;
+	if (size > 0 && m_data[size - 1] == '\0')
+	{
+		--size;
+	}
+	return HashContent64(m_data, size);
+}
+
+// PRIVATE
+
+void File::freeData()
+{
+	if (m_data)
+	{
+		if (isDataExternal())
+		{
+			if (m_release)
+			{
+				m_release(m_data, m_dataSize, m_releaseArg);
+			}
+		}
+		else
+		{
+			FRM_FREE(m_data);
+		}
+	}
+	m_data         = nullptr;
+	m_dataSize     = 0;
+	m_dataCapacity = 0;
+	m_release      = nullptr;
+	m_releaseArg   = nullptr;
+}
+
+void File::adoptData(char* _data, uint _size, uint _capacity)
+{
+	FRM_ASSERT(_data != m_data);
+	freeData();
+	m_data         = _data;
+	m_dataSize     = _size;
+	m_dataCapacity = _capacity;
+}
+
+void File::makeOwned(uint _capacity)
+{
+	FRM_ASSERT(_capacity >= m_dataSize);
+	if (isDataExternal())
+	{
+		char* data = (char*)FRM_MALLOC(_capacity);
+		memcpy(data, m_data, m_dataSize);
+		const uint size = m_dataSize;
+		freeData();
+		m_data     = data;
+		m_dataSize = size;
+	}
+	else
+	{
+		m_data = (char*)FRM_REALLOC(m_data, _capacity);
+	}
+	m_dataCapacity = _capacity;
 }
 
 } // namespace frm
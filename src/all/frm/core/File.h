@@ -3,23 +3,30 @@
 #include <frm/core/frm.h>
 #include <frm/core/String.h>
 
-#include <EASTL/vector.h>
-
 namespace frm {
 
 ////////////////////////////////////////////////////////////////////////////////
 // File
 // An implicit null character is appended to the file data on read, so it is 
 // safe to interpret the file as a C string.
-// \todo API should include some interface for either writing to the internal 
-//   buffer directly, or setting the buffer ptr without copying all the data
-//   (prefer the former, buffer ownership issues in the latter case).
-// \todo Checksum/hash util.
+//
+// File data is either owned by the file, or external (e.g. a memory mapped
+// file, see setDataExternal()). Large files may be read as external data by
+// the platform implementation to avoid copying. External data is copied to an
+// owned buffer on the first call to setData()/appendData()/reserveData().
+// Use releaseData() to transfer ownership of the data (either kind) without
+// copying.
 ////////////////////////////////////////////////////////////////////////////////
 class File: private non_copyable<File>
 {
 public:
 
+	// Called to release external data (see setDataExternal(), releaseData()).
+	typedef void (ReleaseFunc)(char* _data, uint _size, void* _arg);
+
+	// Called by ReadBatch() as each read completes. _index is the index of the file in files_.
+	typedef void (ReadCallback)(int _index, bool _result, void* _arg);
+
 	File();
 	~File();
 
@@ -30,6 +37,12 @@ public:
 	// an error occurred. On success, any resources previously associated with file_ are released.
 	static bool Read(File& file_, const char* _path = nullptr);
 
+	// Read _count files from files_[i]->getPath(). The platform may issue the reads concurrently (e.g. via io_uring on Linux), else
+	// this is equivalent to calling Read() for each file. results_ (optional) receives the result of each read. _callback (optional)
+	// is called with _callbackArg as each read completes, in completion order, while the remaining reads may still be in flight. Return
+	// the number of files which were read successfully.
+	static int  ReadBatch(File* const files_[], int _count, bool results_[] = nullptr, ReadCallback* _callback = nullptr, void* _callbackArg = nullptr);
+
 	// Write file to _path (or _file.getPath() by default). Return false if an error occurred, in which case an existing file at _path 
 	// may or may not have been overwritten.
 	static bool Write(const File& _file, const char* _path = nullptr);
@@ -44,18 +57,45 @@ public:
 	// Resize the internal data buffer to _capacity.
 	void        reserveData(uint _capacity);
 
+	// Reference _size bytes at _data without copying. _release (optional) is called with _releaseArg when the file no longer 
+	// references the data (when the file is destroyed or the data is replaced). Any previous data is released. Modifying the data via
+	// the non-const getData() modifies the external buffer.
+	void        setDataExternal(char* _data, uint _size, ReleaseFunc* _release = nullptr, void* _releaseArg = nullptr);
+
+	// Transfer ownership of the data to the caller, the file is subsequently empty. The caller must call release_(ret, size_, 
+	// releaseArg_) when the data is no longer required (release_ may be nullptr, in which case the data doesn't require releasing).
+	char*       releaseData(uint& size_, ReleaseFunc*& release_, void*& releaseArg_);
+
 	const char* getPath() const              { return (const char*)m_path; }
 	void        setPath(const char* _path)   { m_path.set(_path); }
-	const char* getData() const              { return m_data.data(); }
-	char*       getData()                    { return m_data.data(); }
-	uint        getDataSize() const          { return m_data.size(); }
-	uint        getDataCapacity() const      { return m_data.capacity(); }
+	const char* getData() const              { return m_data; }
+	char*       getData()                    { return m_data; }
+	uint        getDataSize() const          { return m_dataSize; }
+	uint        getDataCapacity() const      { return isDataExternal() ? m_dataSize : m_dataCapacity; }
+	bool        isDataExternal() const       { return m_data && m_dataCapacity == 0; }
+
+	// Hash the file data (see HashContent64()), excluding the implicit null character. Not cached, the data may be modified via 
+	// getData().
+	uint64      getHash() const;
 
 private:
 
-	PathStr             m_path  = "";
-	void*               m_impl  = nullptr;
-	eastl::vector<char> m_data;
+	PathStr      m_path         = "";
+	void*        m_impl         = nullptr;
+	char*        m_data         = nullptr;
+	uint         m_dataSize     = 0;
+	uint         m_dataCapacity = 0;       // 0 if m_data is external.
+	ReleaseFunc* m_release      = nullptr; // External data only.
+	void*        m_releaseArg   = nullptr;
+
+	// Release the data and reset to an empty buffer.
+	void        freeData();
+
+	// Take ownership of _data (allocated via FRM_MALLOC), releasing any previous data. Used by the platform implementation.
+	void        adoptData(char* _data, uint _size, uint _capacity);
+
+	// Ensure the data is owned with at least _capacity bytes, copying external data.
+	void        makeOwned(uint _capacity);
 };
 
 } // namespace frm
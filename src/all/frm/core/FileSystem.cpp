@@ -1,16 +1,138 @@
 #include "FileSystem.h"
 
-#include <frm/core/log.h>
+#include <frm/core/Log.h>
 #include <frm/core/memory.h>
 #include <frm/core/File.h>
 #include <frm/core/String.h>
+#include <frm/core/hash.h>
+
+#include <EASTL/sort.h>
+#include <EASTL/vector_map.h>
 
 #include <cstring>
+#include <mutex>
+#define SCOPED_MUTEX_LOCK(mtx) std::lock_guard<std::mutex> FRM_UNIQUE_NAME(_scopedMutexLock)(mtx)
+#if FRM_PLATFORM_LINUX
+	#include <strings.h>
+	#define _stricmp strcasecmp
+#endif
 
 using namespace frm;
 
 FRM_DEFINE_STATIC_INIT(FileSystem, FileSystem::Init, FileSystem::Shutdown);
 
+namespace {
+
+// Persistent content hashes, see FileSystem::GetHash().
+//
+// File layout (little endian):
+//   Header      magic 'FRMH', version, file entry count, cache entry count.
+//   Files       { path hash, modification time, content hash }
+//   Caches      { path hash, modification time, source content hash }
+struct HashManifest
+{
+	static constexpr uint32 kMagic   = 0x484D5246; // 'FRMH'
+	static constexpr uint32 kVersion = 1;
+
+	struct Entry
+	{
+		uint64 modified; // DateTime::getRaw()
+		uint64 hash;
+	};
+
+	std::mutex                       mutex;                // Protects all of the below.
+	PathStr                          path;
+	bool                             isLoaded = false;
+	bool                             isDirty  = false;
+	eastl::vector_map<uint64, Entry> files;                // Keyed by the full path hash.
+	eastl::vector_map<uint64, Entry> caches;               // Keyed by the full path hash of the cached file, hash is the source hash.
+
+	// Call with mutex locked.
+	void load()
+	{
+		if (isLoaded)
+		{
+			return;
+		}
+		isLoaded = true;
+		path = FileSystem::MakePath("_cache/hashes.manifest");
+
+		File file;
+		if (!File::Exists(path.c_str()) || !File::Read(file, path.c_str()))
+		{
+			return;
+		}
+
+		struct Header { uint32 magic, version, fileCount, cacheCount; };
+		constexpr frm::uint kRecordSize = sizeof(uint64) * 3;
+		Header header;
+		const frm::uint dataSize = file.getDataSize() - 1; // exclude the implicit null
+		if (file.getDataSize() < sizeof(Header) + 1)
+		{
+			return;
+		}
+		memcpy(&header, file.getData(), sizeof(Header));
+		if (header.magic != kMagic || header.version != kVersion || dataSize != sizeof(Header) + (header.fileCount + header.cacheCount) * kRecordSize)
+		{
+			FRM_LOG("FileSystem: Ignoring invalid hash manifest '%s'", path.c_str());
+			return;
+		}
+
+		const char* data = file.getData() + sizeof(Header);
+		auto readEntries = [&data](eastl::vector_map<uint64, Entry>& map_, uint32 _count)
+			{
+				map_.reserve(_count);
+				for (uint32 i = 0; i < _count; ++i, data += kRecordSize)
+				{
+					uint64 record[3];
+					memcpy(record, data, kRecordSize);
+					map_.insert(eastl::make_pair(record[0], Entry{ record[1], record[2] }));
+				}
+			};
+		readEntries(files,  header.fileCount);
+		readEntries(caches, header.cacheCount);
+	}
+
+	// Call with mutex locked.
+	bool save()
+	{
+		if (!isDirty)
+		{
+			return true;
+		}
+
+		eastl::vector<uint64> data;
+		data.reserve(2 + (files.size() + caches.size()) * 3);
+		data.push_back((uint64)kMagic | ((uint64)kVersion << 32));
+		data.push_back((uint64)files.size() | ((uint64)caches.size() << 32));
+		for (auto& map : { &files, &caches })
+		{
+			for (auto& it : *map)
+			{
+				data.push_back(it.first);
+				data.push_back(it.second.modified);
+				data.push_back(it.second.hash);
+			}
+		}
+
+		// File::Write() strips a trailing null, append one so that the data is written as-is.
+		const frm::uint dataSize = (frm::uint)(data.size() * sizeof(uint64));
+		File file;
+		file.setData(nullptr, dataSize + 1);
+		memcpy(file.getData(), data.data(), dataSize);
+		if (!File::Write(file, path.c_str()))
+		{
+			return false;
+		}
+		isDirty = false;
+		return true;
+	}
+};
+
+HashManifest* s_hashManifest;
+
+} // namespace
+
 // PUBLIC
 
 int FileSystem::AddRoot(const char* _path)
@@ -51,18 +173,192 @@ bool FileSystem::ReadIfExists(File& file_, const char* _path, int _root)
 	return File::Read(file_);
 }
 
+int FileSystem::ReadBatch(File* const files_[], const char* const _paths[], const int _roots[], int _count, bool results_[], File::ReadCallback* _callback, void* _callbackArg)
+{
+	// Map the chunk index passed to the callback by File::ReadBatch() to the index in files_.
+	struct ChunkCallback
+	{
+		const int*          index;
+		File::ReadCallback* callback;
+		void*               callbackArg;
+
+		static void Call(int _index, bool _result, void* _arg)
+		{
+			const ChunkCallback* chunkCallback = (const ChunkCallback*)_arg;
+			chunkCallback->callback(chunkCallback->index[_index], _result, chunkCallback->callbackArg);
+		}
+	};
+
+	constexpr int kChunkSize = 64;
+	int ret = 0;
+	for (int chunkBegin = 0; chunkBegin < _count; chunkBegin += kChunkSize)
+	{
+		const int chunkEnd = chunkBegin + kChunkSize < _count ? chunkBegin + kChunkSize : _count;
+		File*     found[kChunkSize];
+		int       foundIndex[kChunkSize];
+		bool      foundResults[kChunkSize];
+		int       foundCount = 0;
+		for (int i = chunkBegin; i < chunkEnd; ++i)
+		{
+			const char* path = _paths ? _paths[i] : files_[i]->getPath();
+			PathStr fullPath;
+			if (!FindExisting(fullPath, path, _roots[i]))
+			{
+				FRM_LOG_ERR("Error loading '%s':\n\tFile not found", path);
+				if (results_)
+				{
+					results_[i] = false;
+				}
+				if (_callback)
+				{
+					_callback(i, false, _callbackArg);
+				}
+				continue;
+			}
+			files_[i]->setPath(fullPath.c_str());
+			found[foundCount] = files_[i];
+			foundIndex[foundCount] = i;
+			++foundCount;
+		}
+
+		ChunkCallback chunkCallback = { foundIndex, _callback, _callbackArg };
+		ret += File::ReadBatch(found, foundCount, foundResults, _callback ? &ChunkCallback::Call : nullptr, &chunkCallback);
+		if (results_)
+		{
+			for (int i = 0; i < foundCount; ++i)
+			{
+				results_[foundIndex[i]] = foundResults[i];
+			}
+		}
+	}
+	return ret;
+}
+
 bool FileSystem::Write(const File& _file, const char* _path, int _root)
 {
 	PathStr fullPath = MakePath(_path ? _path : _file.getPath(), _root);
 	return File::Write(_file, (const char*)fullPath);
 }
 
+bool FileSystem::DeleteDir(const char* _path, bool _recursive)
+{
+	bool ret = true;
+	if (_recursive)
+	{
+		eastl::vector<PathStr> list(ListFiles(nullptr, 0, _path, { "*" }, true));
+		ListFiles(list.data(), (int)list.size(), _path, { "*" }, true);
+		for (const PathStr& file : list)
+		{
+			ret &= Delete(file.c_str());
+		}
+
+		// Subdirectories are longer than their parent, hence deleting the longest paths first deletes children before parents.
+		list.resize(ListDirs(nullptr, 0, _path, { "*" }, true));
+		ListDirs(list.data(), (int)list.size(), _path, { "*" }, true);
+		eastl::sort(list.begin(), list.end(), [](const PathStr& _a, const PathStr& _b) { return _a.getLength() > _b.getLength(); });
+		for (const PathStr& dir : list)
+		{
+			ret &= RemoveDir(dir.c_str());
+		}
+	}
+	return RemoveDir(_path) && ret;
+}
+
 bool FileSystem::Exists(const char* _path, int _root)
 {
 	PathStr buf;
 	return FindExisting(buf, _path, _root);
 }
 
+PathStr FileSystem::Resolve(const char* _path, int _root)
+{
+	PathStr ret;
+	if (!FindExisting(ret, _path, _root))
+	{
+		ret = MakePath(_path, _root);
+	}
+	return ret;
+}
+
+uint64 FileSystem::GetHash(const char* _path, int _root)
+{
+	PathStr fullPath;
+	if (!FindExisting(fullPath, _path, _root))
+	{
+		return 0;
+	}
+	const uint64 key      = HashString<uint64>(fullPath.c_str());
+	const uint64 modified = GetTimeModified(_path, _root).getRaw();
+
+	{	SCOPED_MUTEX_LOCK(s_hashManifest->mutex);
+		s_hashManifest->load();
+		auto it = s_hashManifest->files.find(key);
+		if (it != s_hashManifest->files.end() && it->second.modified == modified)
+		{
+			return it->second.hash;
+		}
+	}
+
+	File file;
+	if (!File::Read(file, fullPath.c_str()))
+	{
+		return 0;
+	}
+	const uint64 hash = file.getHash();
+
+	{	SCOPED_MUTEX_LOCK(s_hashManifest->mutex);
+		s_hashManifest->files[key] = { modified, hash };
+		s_hashManifest->isDirty = true;
+	}
+
+	return hash;
+}
+
+bool FileSystem::IsCacheValid(const char* _cachedPath, const char* _sourcePath, int _root)
+{
+	PathStr cachedFullPath;
+	if (!FindExisting(cachedFullPath, _cachedPath, _root))
+	{
+		return false;
+	}
+	if (!Exists(_sourcePath, _root))
+	{
+		// No source, the cache is all we have.
+		return true;
+	}
+	const uint64 key        = HashString<uint64>(cachedFullPath.c_str());
+	const uint64 modified   = GetTimeModified(_cachedPath, _root).getRaw();
+	const uint64 sourceHash = GetHash(_sourcePath, _root);
+
+	SCOPED_MUTEX_LOCK(s_hashManifest->mutex);
+	s_hashManifest->load();
+	auto it = s_hashManifest->caches.find(key);
+	return it != s_hashManifest->caches.end() && it->second.modified == modified && it->second.hash == sourceHash;
+}
+
+void FileSystem::SetCacheSource(const char* _cachedPath, const char* _sourcePath, int _root)
+{
+	PathStr cachedFullPath;
+	if (!FindExisting(cachedFullPath, _cachedPath, _root))
+	{
+		return;
+	}
+	const uint64 key        = HashString<uint64>(cachedFullPath.c_str());
+	const uint64 modified   = GetTimeModified(_cachedPath, _root).getRaw();
+	const uint64 sourceHash = GetHash(_sourcePath, _root);
+
+	SCOPED_MUTEX_LOCK(s_hashManifest->mutex);
+	s_hashManifest->load();
+	s_hashManifest->caches[key] = { modified, sourceHash };
+	s_hashManifest->isDirty = true;
+}
+
+bool FileSystem::SaveHashManifest()
+{
+	SCOPED_MUTEX_LOCK(s_hashManifest->mutex);
+	return s_hashManifest->save();
+}
+
 bool FileSystem::Matches(const char* _pattern, const char* _str)
 {
 // based on https://research.swtch.com/glob
@@ -265,10 +561,13 @@ frm::storage<eastl::vector<PathStr> > FileSystem::s_roots;
 void FileSystem::Init()
 {
 	*s_roots = eastl::vector<PathStr>();
+	s_hashManifest = FRM_NEW(HashManifest);
 }
 
 void FileSystem::Shutdown()
 {
+	FRM_DELETE(s_hashManifest);
+	s_hashManifest = nullptr;
 }
 
 bool FileSystem::FindExisting(PathStr& ret_, const char* _path, int _root)
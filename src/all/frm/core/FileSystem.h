@@ -46,6 +46,11 @@ public:
 	// As Read() but first checks if the file exists. Return false if the file does not exist or if an error occurred.
 	static bool        ReadIfExists(File& file_, const char* _path = nullptr, int _root = GetDefaultRoot());
 
+	// Read _count files via File::ReadBatch(). _paths[i] and _roots[i] are treated as per Read(); _paths may be nullptr, in which case
+	// files_[i]->getPath() is used. results_ (optional) receives the result of each read. _callback (optional) is called as each read
+	// completes, as per File::ReadBatch(); _index is the index in files_. Return the number of files which were read successfully.
+	static int         ReadBatch(File* const files_[], const char* const _paths[], const int _roots[], int _count, bool results_[] = nullptr, File::ReadCallback* _callback = nullptr, void* _callbackArg = nullptr);
+
 	// Write _file's data to _path. If _path is 0, _file.getPath() is used. Return false if an error occurred, in which case 
 	// any existing file at _path may or may not have been overwritten. _root is ignored if _path is absolute.
 	static bool        Write(const File& _file, const char* _path = nullptr, int _root = GetDefaultRoot());
@@ -53,9 +58,17 @@ public:
 	// Return true if _path exists. Each root is searched, beginning at _root.
 	static bool        Exists(const char* _path, int _root = GetDefaultRoot());
 
+	// Return the path of the file which Read() would access for _path (i.e. including the root), or MakePath(_path, _root) if no file 
+	// exists. A path with or without the root prefix resolves to the same result.
+	static PathStr     Resolve(const char* _path, int _root = GetDefaultRoot());
+
 	// Delete a file.
 	static bool        Delete(const char* _path);
 
+	// Delete a directory. If _recursive, all files and subdirectories are deleted first, else the directory must be empty. Return false
+	// if an error occurred.
+	static bool        DeleteDir(const char* _path, bool _recursive = false);
+
 	// Get the creation/last modified time for a file. _path is treated as per Read(). 
 	static DateTime    GetTimeCreated(const char* _path, int _root = GetDefaultRoot());
 	static DateTime    GetTimeModified(const char* _path, int _root = GetDefaultRoot());
@@ -64,6 +77,23 @@ public:
 	// If _path contains only directory names, it must end in a path separator (e.g. "dir0/dir1/").
 	static bool        CreateDir(const char* _path);
 
+ // Content hashes
+
+	// Return a hash of the contents of _path (see File::getHash()), or 0 if the file doesn't exist. _path is treated as per Read().
+	// Hashes are stored in a persistent manifest along with the modification time, the file is only read if it was modified since it 
+	// was last hashed.
+	static uint64      GetHash(const char* _path, int _root = GetDefaultRoot());
+
+	// Return true if _cachedPath exists and was generated from the current contents of _sourcePath (see SetCacheSource()). Unlike
+	// comparing modification times this is robust to touching/checking out the source file and to clock skew.
+	static bool        IsCacheValid(const char* _cachedPath, const char* _sourcePath, int _root = GetDefaultRoot());
+	// Record that _cachedPath was generated from the current contents of _sourcePath. Call after writing _cachedPath.
+	static void        SetCacheSource(const char* _cachedPath, const char* _sourcePath, int _root = GetDefaultRoot());
+
+	// Write the hash manifest if it was modified. The manifest is loaded on first use from '_cache/hashes.manifest', relative to the 
+	// default root at that time.
+	static bool        SaveHashManifest();
+
  // Path manipulation
 
 	// s_roots[_root] + kPathSeparator + _path. _root is ignored if _path is absolute.
@@ -151,6 +181,9 @@ private:
 	// Get a path to an existing file based on _path and _root. Return false if no existing file was found.
 	static bool FindExisting(PathStr& ret_, const char* _path, int _root);
 
+	// Remove an empty directory (platform specific, see DeleteDir()).
+	static bool RemoveDir(const char* _path);
+
 };
 FRM_DECLARE_STATIC_INIT(FileSystem);
 
@@ -1,18 +1,24 @@
 #include "FileSystemAsync.h"
 
 #include "frm/core/memory.h"
+#include "frm/core/math.h"
 #include "frm/core/Log.h"
 #include "frm/core/Pool.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 #define SCOPED_MUTEX_LOCK(mtx) std::lock_guard<std::mutex> FRM_UNIQUE_NAME(_scopedMutexLock)(mtx)
 
+#include <EASTL/algorithm.h>
+#include <EASTL/heap.h>
 #include <EASTL/vector.h>
 
 namespace frm {
 
+static constexpr uint32 kMaxReadBatch = 16; // Max number of read jobs issued together via FileSystem::ReadBatch().
+
 struct FileSystemAsync::Impl
 {
 	enum class JobType : frm::uint8
@@ -20,33 +26,67 @@ struct FileSystemAsync::Impl
 		Read,
 		Write
 	};
-	
+
+	enum class JobState : frm::uint8
+	{
+		Pending,
+		Running,
+		Complete,
+		Cancelled
+	};
+
 	struct Job
 	{
-		JobType           type;
-		PathStr           path;
-		int               root;
-		File*             file;
-		std::atomic<bool> complete;
+		JobType               type;
+		PathStr               path;
+		int                   root;
+		File*                 file;
+		int                   priority;
+		uint64                order;        // Push order, FIFO for equal priorities.
+		CompletionFunc*       callback;
+		void*                 callbackArg;
+		uint32                activeIndex;  // Index in activeJobs.
+		bool                  released;     // Release the job when it completes.
+		std::atomic<JobState> state;
 	};
 
 	eastl::vector<std::thread>  threads;
 	bool                        threadLoopControl = true;
-	
-	eastl::vector<Job*>         activeJobs;
-	eastl::vector<Job*>         jobQueue;
+
+	eastl::vector<Job*>         activeJobs;         // All unreleased jobs.
+	eastl::vector<Job*>         jobQueue;           // Pending jobs, heap ordered by JobLess().
+	eastl::vector<Job*>         batch;              // Pending jobs pushed between BeginBatch()/EndBatch().
+	int                         batchDepth = 0;
+	uint64                      nextOrder = 0;
+	uint32                      runningCount = 0;
 	Pool<Job>                   jobPool;
-	std::mutex                  jobQueueMutex;
-	
+	std::mutex                  mutex;              // Protects all of the above.
+	std::condition_variable     jobQueueCondition;  // Signaled when jobs are pushed or on shutdown.
+	std::condition_variable     completeCondition;  // Signaled when a job completes.
+
 	Impl(int _threadCount);
 	~Impl();
 
-	Job* pushJob(JobType _type, File* _file_, const char* _path, int _root);
-	Job* popJob();
-	bool checkCompleteAndRelease(JobID _jobID);
-	void flush();
+	Job*   pushJob(JobType _type, File* _file_, const char* _path, int _root, int _priority, CompletionFunc* _callback, void* _callbackArg);
+	uint32 popJobs(Job* jobs_[kMaxReadBatch]);
+	void   completeJob(Job* _job, bool _result);
+	void   releaseJob(Job* _job);
+	void   submitBatch();
+
+	// Arg for ReadCallback().
+	struct ReadBatch
+	{
+		Impl* impl;
+		Job** jobs;
+	};
+
+	static bool JobLess(const Job* _a, const Job* _b)
+	{
+		return _a->priority < _b->priority || (_a->priority == _b->priority && _a->order > _b->order);
+	}
 
 	static void ThreadProc(FileSystemAsync::Impl* impl);
+	static void ReadCallback(int _index, bool _result, void* _arg);
 };
 
 FileSystemAsync::Impl* FileSystemAsync::s_impl;
@@ -66,39 +106,143 @@ bool FileSystemAsync::Init(int _threadCount)
 
 void FileSystemAsync::Shutdown()
 {
+	WaitAll();
 	FRM_DELETE(s_impl);
 }
 
 bool FileSystemAsync::IsComplete(JobID& _jobID)
 {
-	bool ret = s_impl->checkCompleteAndRelease(_jobID);
-	_jobID = ret ? kInvalidJobID : _jobID;
-	return ret;
+	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
+	Impl::Job* job = (Impl::Job*)_jobID;
+
+	if (job->state.load() != Impl::JobState::Complete)
+	{
+		return false;
+	}
+
+	SCOPED_MUTEX_LOCK(s_impl->mutex);
+	s_impl->releaseJob(job);
+	_jobID = kInvalidJobID;
+	return true;
 }
 
 void FileSystemAsync::Wait(JobID& _jobID)
 {
-	while (!IsComplete(_jobID))
+	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
+	Impl::Job* job = (Impl::Job*)_jobID;
+
+	std::unique_lock<std::mutex> lock(s_impl->mutex);
+	FRM_ASSERT(eastl::find(s_impl->batch.begin(), s_impl->batch.end(), job) == s_impl->batch.end()); // Job is in an open batch, it would never execute.
+	s_impl->completeCondition.wait(lock, [job]() { return job->state.load() == Impl::JobState::Complete; });
+	s_impl->releaseJob(job);
+	_jobID = kInvalidJobID;
+}
+
+void FileSystemAsync::WaitAll()
+{
+	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
+
+	std::unique_lock<std::mutex> lock(s_impl->mutex);
+	FRM_ASSERT(s_impl->batchDepth == 0);
+	s_impl->completeCondition.wait(lock, []() { return s_impl->jobQueue.empty() && s_impl->runningCount == 0; });
+}
+
+bool FileSystemAsync::Cancel(JobID& _jobID)
+{
+	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
+	Impl::Job* job = (Impl::Job*)_jobID;
+
+	SCOPED_MUTEX_LOCK(s_impl->mutex);
+	if (job->state.load() != Impl::JobState::Pending)
+	{
+		return false;
+	}
+
+	auto it = eastl::find(s_impl->jobQueue.begin(), s_impl->jobQueue.end(), job);
+	if (it != s_impl->jobQueue.end())
 	{
-		std::this_thread::yield();
+		s_impl->jobQueue.erase_unsorted(it);
+		eastl::make_heap(s_impl->jobQueue.begin(), s_impl->jobQueue.end(), &Impl::JobLess);
 	}
+	else
+	{
+		it = eastl::find(s_impl->batch.begin(), s_impl->batch.end(), job);
+		FRM_ASSERT(it != s_impl->batch.end());
+		s_impl->batch.erase(it);
+	}
+
+	job->state.store(Impl::JobState::Cancelled);
+	s_impl->releaseJob(job);
+	_jobID = kInvalidJobID;
+	return true;
 }
 
-void FileSystemAsync::WaitAll()
+void FileSystemAsync::Release(JobID& _jobID)
 {
-	s_impl->flush();
+	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
+	Impl::Job* job = (Impl::Job*)_jobID;
+
+	SCOPED_MUTEX_LOCK(s_impl->mutex);
+	if (job->state.load() == Impl::JobState::Complete)
+	{
+		s_impl->releaseJob(job);
+	}
+	else
+	{
+		job->released = true;
+	}
+	_jobID = kInvalidJobID;
 }
 
-FileSystemAsync::JobID FileSystemAsync::Read(File& file_, const char* _path, int _root)
+void FileSystemAsync::SetPriority(JobID _jobID, int _priority)
 {
-	return s_impl->pushJob(Impl::JobType::Read, &file_, _path, _root);
+	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
+	Impl::Job* job = (Impl::Job*)_jobID;
+
+	SCOPED_MUTEX_LOCK(s_impl->mutex);
+	if (job->state.load() != Impl::JobState::Pending || job->priority == _priority)
+	{
+		return;
+	}
+
+	job->priority = _priority;
+	if (eastl::find(s_impl->jobQueue.begin(), s_impl->jobQueue.end(), job) != s_impl->jobQueue.end())
+	{
+		eastl::make_heap(s_impl->jobQueue.begin(), s_impl->jobQueue.end(), &Impl::JobLess);
+	}
 }
 
-FileSystemAsync::JobID FileSystemAsync::ReadIfExists(File& file_, const char* _path, int _root)
+void FileSystemAsync::BeginBatch()
+{
+	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
+	SCOPED_MUTEX_LOCK(s_impl->mutex);
+	++s_impl->batchDepth;
+}
+
+void FileSystemAsync::EndBatch()
+{
+	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
+	{	SCOPED_MUTEX_LOCK(s_impl->mutex);
+		FRM_ASSERT(s_impl->batchDepth > 0);
+		if (--s_impl->batchDepth > 0)
+		{
+			return;
+		}
+		s_impl->submitBatch();
+	}
+	s_impl->jobQueueCondition.notify_all();
+}
+
+FileSystemAsync::JobID FileSystemAsync::Read(File& file_, const char* _path, int _root, int _priority, CompletionFunc* _callback, void* _callbackArg)
+{
+	return s_impl->pushJob(Impl::JobType::Read, &file_, _path, _root, _priority, _callback, _callbackArg);
+}
+
+FileSystemAsync::JobID FileSystemAsync::ReadIfExists(File& file_, const char* _path, int _root, int _priority, CompletionFunc* _callback, void* _callbackArg)
 {
 	if (FileSystem::Exists(_path ? _path : file_.getPath(), _root))
 	{
-		return Read(file_, _path, _root);
+		return Read(file_, _path, _root, _priority, _callback, _callbackArg);
 	}
 	else
 	{
@@ -106,9 +250,9 @@ FileSystemAsync::JobID FileSystemAsync::ReadIfExists(File& file_, const char* _p
 	}
 }
 
-FileSystemAsync::JobID FileSystemAsync::Write(const File& _file, const char* _path, int _root)
+FileSystemAsync::JobID FileSystemAsync::Write(const File& _file, const char* _path, int _root, int _priority, CompletionFunc* _callback, void* _callbackArg)
 {
-	return s_impl->pushJob(Impl::JobType::Read, const_cast<File*>(&_file), _path, _root);
+	return s_impl->pushJob(Impl::JobType::Write, const_cast<File*>(&_file), _path, _root, _priority, _callback, _callbackArg);
 }
 
 
@@ -117,7 +261,7 @@ FileSystemAsync::JobID FileSystemAsync::Write(const File& _file, const char* _pa
 FileSystemAsync::Impl::Impl(int _threadCount)
 	: jobPool(128)
 {
-	for (; _threadCount != -1; --_threadCount)
+	for (_threadCount = Max(_threadCount, 1); _threadCount > 0; --_threadCount)
 	{
 		threads.push_back(std::thread(&ThreadProc, this));
 	}
@@ -125,7 +269,10 @@ FileSystemAsync::Impl::Impl(int _threadCount)
 
 FileSystemAsync::Impl::~Impl()
 {
-	threadLoopControl = false;
+	{	SCOPED_MUTEX_LOCK(mutex);
+		threadLoopControl = false;
+	}
+	jobQueueCondition.notify_all();
 	for (std::thread& thread : threads)
 	{
 		thread.join();
@@ -134,6 +281,7 @@ FileSystemAsync::Impl::~Impl()
 
 	// Assume we're quitting and just cancel all active jobs.
 	jobQueue.clear();
+	batch.clear();
 	while (!activeJobs.empty())
 	{
 		jobPool.free(activeJobs.back());
@@ -141,112 +289,153 @@ FileSystemAsync::Impl::~Impl()
 	}
 }
 
-FileSystemAsync::Impl::Job* FileSystemAsync::Impl::pushJob(JobType _type, File* _file_, const char* _path, int _root)
+FileSystemAsync::Impl::Job* FileSystemAsync::Impl::pushJob(JobType _type, File* _file_, const char* _path, int _root, int _priority, CompletionFunc* _callback, void* _callbackArg)
 {
 	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
-	SCOPED_MUTEX_LOCK(jobQueueMutex);
-	
-	Job* job       = jobPool.alloc();
-	job->type      = _type;
-	job->path      = _path ? _path : _file_->getPath();
-	job->root      = _root;
-	job->file      = _file_;
-	job->complete  .store(false);
-	
-	jobQueue.push_back(job);
-	activeJobs.push_back(job);
-	
+
+	Job* job = nullptr;
+	bool isBatch = false;
+	{	SCOPED_MUTEX_LOCK(mutex);
+
+		job              = jobPool.alloc();
+		job->type        = _type;
+		job->path        = _path ? _path : _file_->getPath();
+		job->root        = _root;
+		job->file        = _file_;
+		job->priority    = _priority;
+		job->order       = nextOrder++;
+		job->callback    = _callback;
+		job->callbackArg = _callbackArg;
+		job->activeIndex = (uint32)activeJobs.size();
+		job->released    = false;
+		job->state       .store(JobState::Pending);
+		activeJobs.push_back(job);
+
+		isBatch = batchDepth > 0;
+		if (isBatch)
+		{
+			batch.push_back(job);
+		}
+		else
+		{
+			jobQueue.push_back(job);
+			eastl::push_heap(jobQueue.begin(), jobQueue.end(), &JobLess);
+		}
+	}
+
+	if (!isBatch)
+	{
+		jobQueueCondition.notify_one();
+	}
+
 	return job;
 }
 
-FileSystemAsync::Impl::Job* FileSystemAsync::Impl::popJob()
+uint32 FileSystemAsync::Impl::popJobs(Job* jobs_[kMaxReadBatch])
 {
-	SCOPED_MUTEX_LOCK(jobQueueMutex);
+	std::unique_lock<std::mutex> lock(mutex);
+	jobQueueCondition.wait(lock, [this]() { return !jobQueue.empty() || !threadLoopControl; });
+	if (!threadLoopControl)
+	{
+		return 0;
+	}
 
-	Job* job = nullptr;
-	if (!jobQueue.empty())
+	// Consecutive read jobs (in priority order) are popped together and issued via FileSystem::ReadBatch(). Limit the count to a
+	// fair share of the queue so that the remaining jobs are distributed between the other workers.
+	const uint32 threadCount = (uint32)threads.size();
+	const uint32 maxCount = Min(kMaxReadBatch, ((uint32)jobQueue.size() + threadCount - 1) / threadCount);
+	uint32 count = 0;
+	do
 	{
-		job = jobQueue.back();
+		eastl::pop_heap(jobQueue.begin(), jobQueue.end(), &JobLess);
+		Job* job = jobQueue.back();
 		jobQueue.pop_back();
+		job->state.store(JobState::Running);
+		jobs_[count++] = job;
 	}
+	while (count < maxCount && jobs_[0]->type == JobType::Read && jobQueue.front()->type == JobType::Read);
+	runningCount += count;
 
-	return job;
+	return count;
 }
 
-bool FileSystemAsync::Impl::checkCompleteAndRelease(JobID _jobID)
+void FileSystemAsync::Impl::completeJob(Job* _job, bool _result)
 {
-	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
-	FRM_STRICT_ASSERT(_jobID != kInvalidJobID);
-
-	//Job* job = findActiveJob(_jobID);
-	FRM_ASSERT(sizeof(JobID) == sizeof(Job*));
-	Job* job = (Job*)_jobID;
-	
-	if (job)
+	if (_job->callback)
 	{
-		const bool complete = job->complete.load();
-		if (complete)
+		_job->callback((JobID)_job, *_job->file, _result, _job->callbackArg);
+	}
+
+	// Calling Read() or Write() completes the job regardless of whether it succeeded.
+	{	SCOPED_MUTEX_LOCK(mutex);
+		_job->state.store(JobState::Complete);
+		--runningCount;
+		if (_job->released)
 		{
-			SCOPED_MUTEX_LOCK(jobQueueMutex);
-			auto it = eastl::find(activeJobs.begin(), activeJobs.end(), job);
-			FRM_STRICT_ASSERT(it != activeJobs.end());
-			activeJobs.erase_unsorted(it);
-			jobPool.free(*it);
+			releaseJob(_job);
 		}
-
-		return complete;
-	}
-	else
-	{
-		// \todo In this case checkCompleteAndRelease() was called multiple times on the same job. This may be a valid use case if multiple
-		// threads are waiting on the same job, in which case we need to handle JobID reuse more robustly.
-		FRM_ASSERT(false);
-		return true;
 	}
+	completeCondition.notify_all();
 }
 
-
-void FileSystemAsync::Impl::flush()
+void FileSystemAsync::Impl::releaseJob(Job* _job)
 {
-	FRM_ASSERT(std::this_thread::get_id() == s_mainThreadId);
+	// mutex must be locked by the caller
+	FRM_STRICT_ASSERT(_job->activeIndex < activeJobs.size() && activeJobs[_job->activeIndex] == _job);
+	Job* last = activeJobs.back();
+	last->activeIndex = _job->activeIndex;
+	activeJobs[_job->activeIndex] = last;
+	activeJobs.pop_back();
+	jobPool.free(_job);
+}
 
-	while (!activeJobs.empty())
+void FileSystemAsync::Impl::submitBatch()
+{
+	// mutex must be locked by the caller
+	for (Job* job : batch)
 	{
-		JobID jobID = (JobID)activeJobs.front();
-		if (!checkCompleteAndRelease(jobID))
-		{
-			std::this_thread::yield();
-		}
+		jobQueue.push_back(job);
+		eastl::push_heap(jobQueue.begin(), jobQueue.end(), &JobLess);
 	}
+	batch.clear();
 }
 
 void FileSystemAsync::Impl::ThreadProc(FileSystemAsync::Impl* impl)
 {
-	while (impl->threadLoopControl)
+	Job*        jobs[kMaxReadBatch];
+	File*       files[kMaxReadBatch];
+	const char* paths[kMaxReadBatch];
+	int         roots[kMaxReadBatch];
+	ReadBatch   readBatch = { impl, jobs };
+	while (uint32 count = impl->popJobs(jobs))
 	{
-		Job* job = impl->popJob();
-		if (job)
+		switch (jobs[0]->type)
 		{
-			switch (job->type)
-			{
-				default:
-					FRM_ASSERT(false);
-					break;
-				case JobType::Read:
-					FileSystem::Read(*job->file, job->path.c_str(), job->root);
-					break;
-				case JobType::Write:
-					FileSystem::Write(*job->file, job->path.c_str(), job->root);
-					break;
-			};
-
-			job->complete.store(true); // Calling Read() or Write() completes the job regardless of whether it succeeded.
-		}
-		else
-		{
-			std::this_thread::yield();
-		}
+			default:
+				FRM_ASSERT(false);
+				break;
+			case JobType::Read:
+				for (uint32 i = 0; i < count; ++i)
+				{
+					files[i] = jobs[i]->file;
+					paths[i] = jobs[i]->path.c_str();
+					roots[i] = jobs[i]->root;
+				}
+			 // jobs are completed as each read completes, not when the whole batch finishes
+				FileSystem::ReadBatch(files, paths, roots, (int)count, nullptr, &ReadCallback, &readBatch);
+				break;
+			case JobType::Write:
+				FRM_ASSERT(count == 1);
+				impl->completeJob(jobs[0], FileSystem::Write(*jobs[0]->file, jobs[0]->path.c_str(), jobs[0]->root));
+				break;
+		};
 	}
 }
 
+void FileSystemAsync::Impl::ReadCallback(int _index, bool _result, void* _arg)
+{
+	ReadBatch* readBatch = (ReadBatch*)_arg;
+	readBatch->impl->completeJob(readBatch->jobs[_index], _result);
+}
+
 } // namespace frm
@@ -9,10 +9,25 @@ namespace frm {
 // FileSystemAsync
 // Async file loading system.
 //
+// Pending jobs are executed in priority order (higher first, FIFO for equal
+// priorities). Idle workers block on a condition variable. Jobs may be
+// reprioritized or cancelled until a worker begins executing them.
+//
+// Workers pop consecutive read jobs together and issue them via
+// FileSystem::ReadBatch(), which lets the platform overlap the reads (e.g.
+// io_uring on Linux). Each job in a batch completes as soon as its own read
+// completes.
+//
+// Job IDs must be released by IsComplete() (if it returns true), Wait(),
+// Cancel() (if it returns true) or Release().
+//
+// Completion callbacks are called from a worker thread after the job executes
+// (_success is the result of the FileSystem call), and are not called if the
+// job is cancelled.
+//
 // \todo
-// - Batch API.
-// - Internal design is very basic and relies on a single mutex with a single
-//   producer thread issuing jobs.
+// - Jobs are pushed from the main thread only (see BeginBatch()).
+// - Cancel()/SetPriority() are O(n) in the number of pending jobs.
 ////////////////////////////////////////////////////////////////////////////////
 class FileSystemAsync
 {
@@ -21,6 +36,10 @@ public:
 	using JobID = void*;
 	static constexpr JobID kInvalidJobID = JobID(0);
 
+	typedef void (CompletionFunc)(JobID _jobID, File& _file, bool _success, void* _arg);
+
+	static constexpr int kDefaultPriority = 0;
+
 	// Call during application init. Set the number of loading threads.
 	static bool  Init(int _threadCount = 1);
 
@@ -30,20 +49,34 @@ public:
 	// Return the status of a job. If true, the _jobID is implicitly released and set to kInvalidJobID.
 	static bool  IsComplete(JobID& _jobID);
 
-	// Wait until _jobID is complete. _jobID is implicitly released and set to kInvalidJobID. 
+	// Wait until _jobID is complete. _jobID is implicitly released and set to kInvalidJobID.
 	static void  Wait(JobID& _jobID);
-	
+
 	// Wait until all pending jobs are complete.
 	static void  WaitAll();
 
+	// Cancel _jobID if it hasn't started executing. If true, _jobID is implicitly released and set to kInvalidJobID.
+	static bool  Cancel(JobID& _jobID);
+
+	// Release _jobID without waiting. The job still executes (and its callback is called) unless it was cancelled.
+	static void  Release(JobID& _jobID);
+
+	// Change the priority of a pending job (no effect if the job already started executing).
+	static void  SetPriority(JobID _jobID, int _priority);
+
+	// Jobs pushed between BeginBatch() and EndBatch() are submitted together on EndBatch(), hence workers see the whole batch
+	// in priority order and are woken once.
+	static void  BeginBatch();
+	static void  EndBatch();
+
 	// See FileSystem::Read.
-	static JobID Read(File& file_, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot());
+	static JobID Read(File& file_, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot(), int _priority = kDefaultPriority, CompletionFunc* _callback = nullptr, void* _callbackArg = nullptr);
 
 	// See FileSystem::ReadIfExists. Return kInvalidJobID if the file was not found.
-	static JobID ReadIfExists(File& file_, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot());
+	static JobID ReadIfExists(File& file_, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot(), int _priority = kDefaultPriority, CompletionFunc* _callback = nullptr, void* _callbackArg = nullptr);
 
 	// See FileSystem::Write.
-	static JobID Write(const File& _file, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot());
+	static JobID Write(const File& _file, const char* _path = nullptr, int _root = FileSystem::GetDefaultRoot(), int _priority = kDefaultPriority, CompletionFunc* _callback = nullptr, void* _callbackArg = nullptr);
 
 private:
 
@@ -52,4 +85,4 @@ private:
 };
 
 
-} // namespace frm
\ No newline at end of file
+} // namespace frm
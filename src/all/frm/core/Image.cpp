@@ -5,55 +5,26 @@
 #include <frm/core/memory.h>
 #include <frm/core/File.h>
 #include <frm/core/FileSystem.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/Time.h>
 
+#include <EASTL/vector.h>
+
 #include <cmath>
 #include <cstring>
 
+#if FRM_SIMD_AVX2
+	#include <immintrin.h>
+#elif FRM_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
 #ifdef FRM_COMPILER_MSVC
 	#pragma warning(disable: 4244) // possible loss of data
 #endif
 
 using namespace frm;
 
-// Copy at most _srcCount objects from _src to _dst, performing conversion from 
-// tSrc to tDst. If _srcCount < _dstCount, the remaining elements of _dst are
-// initialized as tDst(0).
-template <typename tSrc, typename tDst>
-static void ConvertCopy(const tSrc* _src, tDst* _dst, uint _srcCount, uint _dstCount)
-{
-	do
-	{
-		*_dst = DataTypeConvert<tSrc, tDst>(*_src);
-		++_src;
-		++_dst;
-		--_dstCount;
-		--_srcCount;
-	} while (_dstCount != 0 && _srcCount != 0);
-
-	while (_dstCount != 0)
-	{
-		*_dst = (tDst)0;
-		++_dst;
-		--_dstCount;
-	}
-}
-
-// Copy image data (_size texels) from _src to _dst. _srcCount/_dstCount are the
-// number of components per texel in _src/_dst respectively.
-template <typename tSrc, typename tDst>
-static void ConvertCopyImage(const void* _src, void* _dst, uint _srcCount, uint _dstCount, uint _size)
-{
-	const tSrc* src = (const tSrc*)_src;
-	tDst* dst = (tDst*)_dst;
-	for (uint i = 0, n = _size / _srcCount; i < n; ++i)
-	{
-		ConvertCopy(src, dst, _srcCount, _dstCount);
-		src += _srcCount;
-		dst += _dstCount;
-	}
-}
-
 static uint GetImageSize(uint _w, uint _h, uint _d, Image::CompressionType _compression, uint _bytesPerTexel)
 {
 	switch (_compression)
@@ -73,6 +44,430 @@ static uint GetImageSize(uint _w, uint _h, uint _d, Image::CompressionType _comp
 	return _w * _h * _d * _bytesPerTexel;
 }
 
+namespace {
+
+constexpr uint32 kRowChunkSize   = 16;
+constexpr uint32 kTexelChunkSize = 16 * 1024;
+
+float SrgbToLinear(float _x)
+{
+	return _x <= 0.04045f ? _x / 12.92f : powf((_x + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float _x)
+{
+	return _x <= 0.0031308f ? _x * 12.92f : 1.055f * powf(_x, 1.0f / 2.4f) - 0.055f;
+}
+
+struct SrgbToLinearLUT
+{
+	float m_values[256];
+
+	SrgbToLinearLUT()
+	{
+		for (int i = 0; i < 256; ++i)
+		{
+			m_values[i] = SrgbToLinear((float)i / 255.0f);
+		}
+	}
+};
+
+int WrapIndex(int _i, int _count, Image::Wrap _wrap)
+{
+	switch (_wrap)
+	{
+		case Image::Wrap_Repeat:
+		{
+			const int i = _i % _count;
+			return i < 0 ? i + _count : i;
+		}
+		case Image::Wrap_Mirror:
+		{
+			int i = _i % (2 * _count);
+			i = i < 0 ? i + 2 * _count : i;
+			return i < _count ? i : 2 * _count - 1 - i;
+		}
+		case Image::Wrap_Clamp:
+		default:
+			return FRM_CLAMP(_i, 0, _count - 1);
+	};
+}
+
+// Modified Bessel function of the first kind (order 0), for the Kaiser window.
+float BesselI0(float _x)
+{
+	const float x2 = _x * _x * 0.25f;
+	float ret  = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 64 && term > ret * 1e-8f; ++k)
+	{
+		term *= x2 / (float)(k * k);
+		ret  += term;
+	}
+	return ret;
+}
+
+// Filter radius in destination texels.
+float FilterRadius(const Image::FilterOptions& _options)
+{
+	switch (_options.filter)
+	{
+		case Image::Filter_Triangle: return 1.0f;
+		case Image::Filter_Kaiser:   return _options.kaiserWidth;
+		case Image::Filter_Box:
+		default:                     return 0.5f;
+	};
+}
+
+// Filter weight at _x (destination texels) from the filter center. Box weights are computed directly as the overlap of the filter with
+// each source texel.
+float FilterWeight(const Image::FilterOptions& _options, float _x)
+{
+	switch (_options.filter)
+	{
+		case Image::Filter_Triangle:
+			return FRM_MAX(1.0f - fabsf(_x), 0.0f);
+		case Image::Filter_Kaiser:
+		{
+			const float t = _x / _options.kaiserWidth;
+			if (fabsf(t) >= 1.0f)
+			{
+				return 0.0f;
+			}
+			const float sinc = fabsf(_x) < 1e-6f ? 1.0f : sinf(kPi * _x) / (kPi * _x);
+			return sinc * BesselI0(_options.kaiserAlpha * sqrtf(1.0f - t * t)) / BesselI0(_options.kaiserAlpha);
+		}
+		default:
+			return 0.0f;
+	};
+}
+
+// Source texel indices/weights along 1 axis for each destination texel. Each destination texel has tapCount taps.
+struct Contributors
+{
+	int                  tapCount = 0;
+	eastl::vector<int>   indices;
+	eastl::vector<float> weights;
+};
+
+// If _border > 0 the source data is padded by _border texels on each side (cubemap faces), indices are clamped to the padded range and
+// _options.wrap is ignored.
+Contributors GetContributors(int _srcCount, int _dstCount, int _border, const Image::FilterOptions& _options)
+{
+	const float srcPerDst = (float)_srcCount / (float)_dstCount;
+	const float scale     = FRM_MAX(srcPerDst, 1.0f); // widen the filter when downsampling
+	const float radius    = FilterRadius(_options) * scale;
+	const int   maxTaps   = (int)ceilf(radius * 2.0f) + 2;
+
+	eastl::vector<int>   first(_dstCount);
+	eastl::vector<float> weights(_dstCount * maxTaps, 0.0f);
+	int tapCount = 1;
+	for (int i = 0; i < _dstCount; ++i)
+	{
+		const float center = ((float)i + 0.5f) * srcPerDst;
+		first[i] = (int)floorf(center - radius);
+		float* w = weights.data() + i * maxTaps;
+		float sum = 0.0f;
+		for (int t = 0; t < maxTaps; ++t)
+		{
+			const float j = (float)(first[i] + t);
+			if (_options.filter == Image::Filter_Box)
+			{
+				w[t] = FRM_MAX(FRM_MIN(j + 1.0f, center + radius) - FRM_MAX(j, center - radius), 0.0f);
+			}
+			else
+			{
+				w[t] = FilterWeight(_options, (j + 0.5f - center) / scale);
+			}
+			sum += w[t];
+		}
+		FRM_ASSERT(sum > 0.0f);
+
+	 // normalize, trim zero weights from either end
+		int t0 = maxTaps, t1 = 0;
+		for (int t = 0; t < maxTaps; ++t)
+		{
+			w[t] /= sum;
+			if (w[t] != 0.0f)
+			{
+				t0 = FRM_MIN(t0, t);
+				t1 = t;
+			}
+		}
+		if (t0 > 0)
+		{
+			memmove(w, w + t0, sizeof(float) * (maxTaps - t0));
+			memset(w + maxTaps - t0, 0, sizeof(float) * t0);
+			first[i] += t0;
+		}
+		tapCount = FRM_MAX(tapCount, t1 - t0 + 1);
+	}
+
+	Contributors ret;
+	ret.tapCount = tapCount;
+	ret.indices.resize(_dstCount * tapCount);
+	ret.weights.resize(_dstCount * tapCount);
+	for (int i = 0; i < _dstCount; ++i)
+	{
+		for (int t = 0; t < tapCount; ++t)
+		{
+			const int j = first[i] + t;
+			ret.indices[i * tapCount + t] = _border > 0
+				? FRM_CLAMP(j, -_border, _srcCount + _border - 1) + _border
+				: WrapIndex(j, _srcCount, _options.wrap)
+				;
+			ret.weights[i * tapCount + t] = weights[i * maxTaps + t];
+		}
+	}
+	return ret;
+}
+
+// dst_[i] += _src[i] * _weight
+void AccumulateRow(float* dst_, const float* _src, float _weight, int _count)
+{
+	int i = 0;
+	#if FRM_SIMD_AVX2
+	{
+		const __m256 w = _mm256_set1_ps(_weight);
+		for (; i + 8 <= _count; i += 8)
+		{
+			_mm256_storeu_ps(dst_ + i, _mm256_add_ps(_mm256_loadu_ps(dst_ + i), _mm256_mul_ps(_mm256_loadu_ps(_src + i), w)));
+		}
+	}
+	#endif
+	#if FRM_SIMD_SSE2
+	{
+		const __m128 w = _mm_set1_ps(_weight);
+		for (; i + 4 <= _count; i += 4)
+		{
+			_mm_storeu_ps(dst_ + i, _mm_add_ps(_mm_loadu_ps(dst_ + i), _mm_mul_ps(_mm_loadu_ps(_src + i), w)));
+		}
+	}
+	#endif
+	for (; i < _count; ++i)
+	{
+		dst_[i] += _src[i] * _weight;
+	}
+}
+
+// Resample _rowCount rows of _srcWidth texels (_componentCount floats per texel) to _dstWidth texels.
+void ResampleX(const float* _src, int _srcWidth, float* dst_, int _dstWidth, int _rowCount, int _componentCount, const Contributors& _contributors)
+{
+	const int c = _componentCount;
+	const int tapCount = _contributors.tapCount;
+	JobSystem::ParallelFor((uint32)_rowCount, kRowChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 row = _begin; row < _end; ++row)
+			{
+				const float* src = _src + row * _srcWidth * c;
+				float* dst = dst_ + row * _dstWidth * c;
+				for (int x = 0; x < _dstWidth; ++x)
+				{
+					const int*   indices = _contributors.indices.data() + x * tapCount;
+					const float* weights = _contributors.weights.data() + x * tapCount;
+
+					#if FRM_SIMD_SSE2
+						if (c == 4)
+						{
+							__m128 acc = _mm_setzero_ps();
+							for (int t = 0; t < tapCount; ++t)
+							{
+								acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + indices[t] * 4), _mm_set1_ps(weights[t])));
+							}
+							_mm_storeu_ps(dst + x * 4, acc);
+							continue;
+						}
+					#endif
+
+					for (int k = 0; k < c; ++k)
+					{
+						float acc = 0.0f;
+						for (int t = 0; t < tapCount; ++t)
+						{
+							acc += src[indices[t] * c + k] * weights[t];
+						}
+						dst[x * c + k] = acc;
+					}
+				}
+			}
+		});
+}
+
+// Resample _outerCount blocks of _srcCount rows (_rowSize floats per row) to _dstCount rows. This is the Y pass if the rows are image
+// rows and the Z pass if the rows are image slices.
+void ResampleRows(const float* _src, int _srcCount, float* dst_, int _dstCount, int _outerCount, int _rowSize, const Contributors& _contributors)
+{
+	const int tapCount = _contributors.tapCount;
+	JobSystem::ParallelFor((uint32)(_outerCount * _dstCount), kRowChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 row = _begin; row < _end; ++row)
+			{
+				const int outer = (int)row / _dstCount;
+				const int i     = (int)row % _dstCount;
+				float* dst = dst_ + (size_t)row * _rowSize;
+				memset(dst, 0, sizeof(float) * _rowSize);
+				for (int t = 0; t < tapCount; ++t)
+				{
+					const float weight = _contributors.weights[i * tapCount + t];
+					if (weight != 0.0f)
+					{
+						const int srcRow = outer * _srcCount + _contributors.indices[i * tapCount + t];
+						AccumulateRow(dst, _src + (size_t)srcRow * _rowSize, weight, _rowSize);
+					}
+				}
+			}
+		});
+}
+
+// Separable resample of _src (_srcSize, plus _border texels on each side in x/y for cubemap faces) to dst_ (_dstSize). Passes are
+// skipped where the source and destination sizes match.
+void Resample(const float* _src, const uvec3& _srcSize, int _border, float* dst_, const uvec3& _dstSize, int _componentCount, const Image::FilterOptions& _options)
+{
+	const bool needX = _srcSize.x != _dstSize.x || _border > 0;
+	const bool needY = _srcSize.y != _dstSize.y || _border > 0;
+	const bool needZ = _srcSize.z != _dstSize.z;
+	const int  lastPass = needZ ? 2 : (needY ? 1 : (needX ? 0 : -1));
+	if (lastPass < 0)
+	{
+		memcpy(dst_, _src, sizeof(float) * _srcSize.x * _srcSize.y * _srcSize.z * _componentCount);
+		return;
+	}
+
+	eastl::vector<float> tmp[2];
+	int tmpIndex = 0;
+	auto GetOutput = [&](int _pass, const ivec3& _size) -> float*
+		{
+			if (_pass == lastPass)
+			{
+				return dst_;
+			}
+			eastl::vector<float>& ret = tmp[tmpIndex++];
+			ret.resize((size_t)_size.x * _size.y * _size.z * _componentCount);
+			return ret.data();
+		};
+
+	const float* src = _src;
+	ivec3 size = ivec3(_srcSize.x + _border * 2, _srcSize.y + _border * 2, _srcSize.z);
+	if (needX)
+	{
+		const Contributors contributors = GetContributors((int)_srcSize.x, (int)_dstSize.x, _border, _options);
+		const ivec3 dstSize = ivec3((int)_dstSize.x, size.y, size.z);
+		float* dst = GetOutput(0, dstSize);
+		ResampleX(src, size.x, dst, dstSize.x, size.y * size.z, _componentCount, contributors);
+		src = dst;
+		size = dstSize;
+	}
+	if (needY)
+	{
+		const Contributors contributors = GetContributors((int)_srcSize.y, (int)_dstSize.y, _border, _options);
+		const ivec3 dstSize = ivec3(size.x, (int)_dstSize.y, size.z);
+		float* dst = GetOutput(1, dstSize);
+		ResampleRows(src, size.y, dst, dstSize.y, size.z, size.x * _componentCount, contributors);
+		src = dst;
+		size = dstSize;
+	}
+	if (needZ)
+	{
+		const Contributors contributors = GetContributors((int)_srcSize.z, (int)_dstSize.z, 0, _options);
+		const ivec3 dstSize = ivec3(size.x, size.y, (int)_dstSize.z);
+		float* dst = GetOutput(2, dstSize);
+		ResampleRows(src, size.z, dst, dstSize.z, 1, size.x * size.y * _componentCount, contributors);
+	}
+}
+
+// Direction through _uv ([-1,1], may be outside the face) on _face. Faces are ordered +X,-X,+Y,-Y,+Z,-Z as per the GL convention.
+vec3 CubeFaceDirection(int _face, const vec2& _uv)
+{
+	switch (_face)
+	{
+		case 0:  return vec3( 1.0f,   -_uv.y, -_uv.x);
+		case 1:  return vec3(-1.0f,   -_uv.y,  _uv.x);
+		case 2:  return vec3( _uv.x,   1.0f,   _uv.y);
+		case 3:  return vec3( _uv.x,  -1.0f,  -_uv.y);
+		case 4:  return vec3( _uv.x,  -_uv.y,  1.0f);
+		case 5:
+		default: return vec3(-_uv.x,  -_uv.y, -1.0f);
+	};
+}
+
+// Inverse of CubeFaceDirection(), return the face index and set uv_ ([-1,1]).
+int CubeFaceLookup(const vec3& _dir, vec2& uv_)
+{
+	const vec3 a = Abs(_dir);
+	if (a.x >= a.y && a.x >= a.z)
+	{
+		uv_ = vec2(_dir.x > 0.0f ? -_dir.z : _dir.z, -_dir.y) / a.x;
+		return _dir.x > 0.0f ? 0 : 1;
+	}
+	if (a.y >= a.z)
+	{
+		uv_ = vec2(_dir.x, _dir.y > 0.0f ? _dir.z : -_dir.z) / a.y;
+		return _dir.y > 0.0f ? 2 : 3;
+	}
+	uv_ = vec2(_dir.z > 0.0f ? _dir.x : -_dir.x, -_dir.y) / a.z;
+	return _dir.z > 0.0f ? 4 : 5;
+}
+
+// Border size (source texels) required to filter a cubemap face from _srcSize to _dstSize.
+int GetCubeBorder(uint _srcSize, uint _dstSize, const Image::FilterOptions& _options)
+{
+	const float scale = FRM_MAX((float)_srcSize / (float)_dstSize, 1.0f);
+	return (int)ceilf(FilterRadius(_options) * scale) + 1;
+}
+
+// Copy _face to dst_ with _border texels on each side. Border texels are fetched (nearest) from the adjacent faces.
+void PadCubeFace(const eastl::vector<float>* _faces, int _size, int _face, int _border, int _componentCount, float* dst_)
+{
+	const int c = _componentCount;
+	const int paddedSize = _size + _border * 2;
+	JobSystem::ParallelFor((uint32)paddedSize, kRowChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (int y = (int)_begin; y < (int)_end; ++y)
+			{
+				const int sy = y - _border;
+				float* dst = dst_ + (size_t)y * paddedSize * c;
+				for (int x = 0; x < paddedSize; ++x)
+				{
+					const int sx = x - _border;
+					if (sx >= 0 && sx < _size && sy >= 0 && sy < _size)
+					{
+						memcpy(dst + x * c, _faces[_face].data() + (sy * _size + sx) * c, sizeof(float) * _size * c);
+						x += _size - 1;
+						continue;
+					}
+					const vec2 uv = (vec2((float)sx, (float)sy) + 0.5f) / (float)_size * 2.0f - 1.0f;
+					vec2 faceUv;
+					const int face = CubeFaceLookup(CubeFaceDirection(_face, uv), faceUv);
+					const int fx = FRM_CLAMP((int)floorf((faceUv.x * 0.5f + 0.5f) * (float)_size), 0, _size - 1);
+					const int fy = FRM_CLAMP((int)floorf((faceUv.y * 0.5f + 0.5f) * (float)_size), 0, _size - 1);
+					memcpy(dst + x * c, _faces[face].data() + (fy * _size + fx) * c, sizeof(float) * c);
+				}
+			}
+		});
+}
+
+// Resample _imageCount images from _srcSize to _dstSize. If _isCubemap, _src/dst_ are 6 faces which are filtered across the face edges.
+void ResampleImages(const eastl::vector<float>* _src, eastl::vector<float>* dst_, int _imageCount, bool _isCubemap, const uvec3& _srcSize, const uvec3& _dstSize, int _componentCount, const Image::FilterOptions& _options)
+{
+	const int border = _isCubemap ? GetCubeBorder(_srcSize.x, _dstSize.x, _options) : 0;
+	eastl::vector<float> padded;
+	for (int i = 0; i < _imageCount; ++i)
+	{
+		dst_[i].resize((size_t)_dstSize.x * _dstSize.y * _dstSize.z * _componentCount);
+		const float* src = _src[i].data();
+		if (_isCubemap)
+		{
+			const int paddedSize = (int)_srcSize.x + border * 2;
+			padded.resize((size_t)paddedSize * paddedSize * _componentCount);
+			PadCubeFace(_src, (int)_srcSize.x, i, border, _componentCount, padded.data());
+			src = padded.data();
+		}
+		Resample(src, _srcSize, border, dst_[i].data(), _dstSize, _componentCount, _options);
+	}
+}
+
+} // namespace
+
 /*******************************************************************************
 
                                    Image
@@ -154,6 +549,52 @@ Image* Image::CreateCubemap(uint _width, Layout _layout, DataType _dataType, uin
 	return ret;
 }
 
+Image* Image::CreateResampled(const Image& _img, uint _width, uint _height, uint _depth, const FilterOptions& _options)
+{
+	FRM_ASSERT(_img.m_data);
+	if (_img.isCompressed())
+	{
+		FRM_LOG_ERR("Image::CreateResampled: Compressed images are not supported");
+		return nullptr;
+	}
+	FRM_ASSERT_MSG(!_img.isCubemap() || _width == _height, "Cubemap faces must be square");
+
+	Image* ret = FRM_NEW(Image);
+	FRM_ASSERT(ret);
+	ret->init();
+	ret->m_type        = _img.m_type;
+	ret->m_width       = FRM_MAX(_width, (uint)1);
+	ret->m_height      = _img.is1d() ? 1 : (_img.isCubemap() ? ret->m_width : FRM_MAX(_height, (uint)1));
+	ret->m_depth       = _img.is3d() ? FRM_MAX(_depth, (uint)1) : 1;
+	ret->m_layout      = _img.m_layout;
+	ret->m_dataType    = _img.m_dataType;
+	ret->m_mipmapCount = 1;
+	ret->m_arrayCount  = _img.m_arrayCount;
+	ret->alloc();
+
+	const int   componentCount = (int)GetComponentCount(_img.m_layout);
+	const uvec3 srcSize        = _img.getMipDimensions(0);
+	const uvec3 dstSize        = ret->getMipDimensions(0);
+	const uint  imageCount     = _img.isCubemap() ? _img.m_arrayCount * 6 : _img.m_arrayCount;
+	const int   groupSize      = _img.isCubemap() ? 6 : 1;
+	eastl::vector<float> src[6], dst[6];
+	for (uint image = 0; image < imageCount; image += groupSize)
+	{
+		for (int i = 0; i < groupSize; ++i)
+		{
+			src[i].resize((size_t)srcSize.x * srcSize.y * srcSize.z * componentCount);
+			_img.loadFloat(image + i, 0, _options.isSrgb, src[i].data());
+		}
+		ResampleImages(src, dst, groupSize, _img.isCubemap(), srcSize, dstSize, componentCount, _options);
+		for (int i = 0; i < groupSize; ++i)
+		{
+			ret->storeFloat(image + i, 0, _options.isSrgb, dst[i].data());
+		}
+	}
+
+	return ret;
+}
+
 void Image::Destroy(Image*& _img_)
 {
 	FRM_ASSERT(_img_);
@@ -286,42 +727,123 @@ uint Image::getRawImageSize(uint _mip) const
 }
 
 
-void Image::setRawImage(uint _array, uint _mip, const void* _src, Layout _layout, DataType _dataType, CompressionType _compressionType)
+void Image::setRawImage(uint _array, uint _mip, const void* _src, Layout _layout, DataType _dataType, CompressionType _compressionType, const int* _swizzle)
 {
 	FRM_ASSERT(_src);
 
 	FRM_ASSERT_MSG(_compressionType == m_compression, "Compression types must match");
 
  // layout/type match, memcpy data
-	if (_layout == m_layout && _dataType == m_dataType && _compressionType == m_compression)
+	if (_layout == m_layout && _dataType == m_dataType && _compressionType == m_compression && !_swizzle)
 	{
 		memcpy(const_cast<char*>(getRawImage(_array, _mip)), _src, getRawImageSize(_mip));
 		return;
 	}
 
  // layout/type don't match, must convert
-	uint srcCount = GetComponentCount(_layout);
-	uint dstCount = GetComponentCount(m_layout);
-	void* dst = const_cast<char*>(getRawImage(_array, _mip));
+	FRM_ASSERT_MSG(m_compression == Compression_None, "Can't convert compressed image data");
+	const uint srcCount = GetComponentCount(_layout);
+	const uint dstCount = GetComponentCount(m_layout);
+	const uint texelCount = getRawImageSize(_mip) / (DataTypeSizeBytes(m_dataType) * dstCount);
+	DataTypeConvert(_dataType, (int)srcCount, m_dataType, (int)dstCount, _src, getRawImage(_array, _mip), texelCount, _swizzle);
+}
 
-	#define CONVERT_FROM(type) \
-		switch (m_dataType) \
-		{ \
-			case DataType_Uint8N:   ConvertCopyImage<internal::DataType_EnumToType<type>::Type, uint8N >(_src, dst, srcCount, dstCount, m_arrayLayerSize); break; \
-			case DataType_Uint16N:  ConvertCopyImage<internal::DataType_EnumToType<type>::Type, uint16N>(_src, dst, srcCount, dstCount, m_arrayLayerSize); break; \
-			case DataType_Uint32N:  ConvertCopyImage<internal::DataType_EnumToType<type>::Type, uint32N>(_src, dst, srcCount, dstCount, m_arrayLayerSize); break; \
-			case DataType_Float32:  ConvertCopyImage<internal::DataType_EnumToType<type>::Type, float32>(_src, dst, srcCount, dstCount, m_arrayLayerSize); break; \
-			default: FRM_ASSERT(false); \
+bool Image::generateMipmaps(const FilterOptions& _options, uint _mipmapCount)
+{
+	FRM_ASSERT(m_data);
+	if (m_compression != Compression_None)
+	{
+		FRM_LOG_ERR("Image::generateMipmaps: Compressed images are not supported");
+		return false;
+	}
+
+	const uint maxMipmapCount = GetMaxMipmapCount(m_width, m_height, m_depth);
+	_mipmapCount = _mipmapCount == 0 ? maxMipmapCount : FRM_MIN(_mipmapCount, maxMipmapCount);
+	const uint imageCount = isCubemap() ? m_arrayCount * 6 : m_arrayCount;
+
+ // realloc, preserve level 0
+	if (_mipmapCount != m_mipmapCount)
+	{
+		char* data = m_data;
+		const uint arrayLayerSize = m_arrayLayerSize;
+		m_data = nullptr;
+		m_mipmapCount = _mipmapCount;
+		alloc();
+		for (uint image = 0; image < imageCount; ++image)
+		{
+			memcpy(getRawImage(image, 0), data + image * arrayLayerSize, m_mipSizes[0]);
 		}
-	switch (_dataType)
+		free(data);
+	}
+
+ // each level is filtered from the previous level, kept as float32 to avoid accumulating quantization error
+	const int componentCount = (int)GetComponentCount(m_layout);
+	const int groupSize = isCubemap() ? 6 : 1;
+	eastl::vector<float> src[6], dst[6];
+	for (uint image = 0; image < imageCount; image += groupSize)
 	{
-		case DataType_Uint8N:  CONVERT_FROM(DataType_Uint8N); break;
-		case DataType_Uint16N: CONVERT_FROM(DataType_Uint16N); break;
-		case DataType_Uint32N: CONVERT_FROM(DataType_Uint32N); break;
-		case DataType_Float32: CONVERT_FROM(DataType_Float32); break;
-		default:               FRM_ASSERT_MSG(false, "Unsupported DataType: %s", DataTypeString(_dataType));
-	};
-	#undef CONVERT_FROM
+		const uvec3 size0 = getMipDimensions(0);
+		for (int i = 0; i < groupSize; ++i)
+		{
+			src[i].resize((size_t)size0.x * size0.y * size0.z * componentCount);
+			loadFloat(image + i, 0, _options.isSrgb, src[i].data());
+		}
+		for (uint mip = 1; mip < m_mipmapCount; ++mip)
+		{
+			ResampleImages(src, dst, groupSize, isCubemap(), getMipDimensions(mip - 1), getMipDimensions(mip), componentCount, _options);
+			for (int i = 0; i < groupSize; ++i)
+			{
+				storeFloat(image + i, mip, _options.isSrgb, dst[i].data());
+				eastl::swap(src[i], dst[i]);
+			}
+		}
+	}
+
+	return true;
+}
+
+vec4 Image::sample(const vec3& _uvw, uint _array, uint _mip, Wrap _wrap) const
+{
+	FRM_ASSERT(m_data);
+	FRM_ASSERT_MSG(m_compression == Compression_None, "Can't sample compressed image data");
+	FRM_ASSERT(_mip < m_mipmapCount);
+
+	const uvec3 size = getMipDimensions(_mip);
+	const int   componentCount = (int)GetComponentCount(m_layout);
+	const uint  texelSize = DataTypeSizeBytes(m_dataType) * componentCount;
+	const char* data = getRawImage(_array, _mip);
+
+	int   i0[3], i1[3];
+	float f[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		const float x  = _uvw[k] * (float)size[k] - 0.5f;
+		const float x0 = floorf(x);
+		f[k]  = size[k] > 1 ? x - x0 : 0.0f;
+		i0[k] = WrapIndex((int)x0, (int)size[k], _wrap);
+		i1[k] = WrapIndex((int)x0 + 1, (int)size[k], _wrap);
+	}
+
+	vec4 ret = vec4(0.0f);
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		float weight = 1.0f;
+		int   index[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			const bool hi = (corner >> k) & 1;
+			weight  *= hi ? f[k] : 1.0f - f[k];
+			index[k] = hi ? i1[k] : i0[k];
+		}
+		if (weight == 0.0f)
+		{
+			continue;
+		}
+		vec4 texel;
+		DataTypeConvert(m_dataType, componentCount, DataType_Float32, 4, data + ((index[2] * size.y + index[1]) * size.x + index[0]) * texelSize, &texel.x, 1);
+		ret += texel * weight;
+	}
+	return ret;
 }
 
 // PRIVATE
@@ -395,6 +917,95 @@ void Image::alloc()
 	FRM_ASSERT(m_data);
 }
 
+uvec3 Image::getMipDimensions(uint _mip) const
+{
+	return uvec3(
+		(uint32)FRM_MAX(m_width  >> _mip, (uint)1),
+		(uint32)FRM_MAX(m_height >> _mip, (uint)1),
+		(uint32)FRM_MAX(m_depth  >> _mip, (uint)1)
+		);
+}
+
+void Image::loadFloat(uint _image, uint _mip, bool _isSrgb, float* dst_) const
+{
+	const uvec3 size = getMipDimensions(_mip);
+	const int   c = (int)GetComponentCount(m_layout);
+	const uint  texelCount = size.x * size.y * size.z;
+	const char* src = getRawImage(_image, _mip);
+	DataTypeConvert(m_dataType, c, DataType_Float32, c, src, dst_, texelCount);
+
+	if (!_isSrgb)
+	{
+		return;
+	}
+	const int rgbCount = FRM_MIN(c, 3); // alpha is linear
+	JobSystem::ParallelFor((uint32)texelCount, kTexelChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			if (m_dataType == DataType_Uint8N)
+			{
+				static const SrgbToLinearLUT s_lut;
+				for (uint32 i = _begin; i < _end; ++i)
+				{
+					for (int k = 0; k < rgbCount; ++k)
+					{
+						dst_[i * c + k] = s_lut.m_values[((const uint8*)src)[i * c + k]];
+					}
+				}
+			}
+			else
+			{
+				for (uint32 i = _begin; i < _end; ++i)
+				{
+					for (int k = 0; k < rgbCount; ++k)
+					{
+						dst_[i * c + k] = SrgbToLinear(dst_[i * c + k]);
+					}
+				}
+			}
+		});
+}
+
+void Image::storeFloat(uint _image, uint _mip, bool _isSrgb, const float* _src)
+{
+	const uvec3 size = getMipDimensions(_mip);
+	const int   c = (int)GetComponentCount(m_layout);
+	const uint  texelCount = size.x * size.y * size.z;
+
+ // conversion to integer types truncates, add half a step to round to nearest
+	float bias = 0.0f;
+	if (DataTypeIsNormalized(m_dataType))
+	{
+		const int bits = (int)DataTypeSizeBytes(m_dataType) * 8 - (DataTypeIsSigned(m_dataType) ? 1 : 0);
+		bias = (float)(0.5 / (ldexp(1.0, bits) - 1.0));
+	}
+	else if (DataTypeIsInt(m_dataType))
+	{
+		bias = 0.5f;
+	}
+
+	if (!_isSrgb && bias == 0.0f)
+	{
+		DataTypeConvert(DataType_Float32, c, m_dataType, c, _src, getRawImage(_image, _mip), texelCount);
+		return;
+	}
+
+	eastl::vector<float> tmp(texelCount * c);
+	const int rgbCount = _isSrgb ? FRM_MIN(c, 3) : 0; // alpha is linear
+	JobSystem::ParallelFor((uint32)texelCount, kTexelChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				for (int k = 0; k < c; ++k)
+				{
+					float x = _src[i * c + k];
+					x = k < rgbCount ? LinearToSrgb(x) : x;
+					tmp[i * c + k] = x + (x < 0.0f ? -bias : bias);
+				}
+			}
+		});
+	DataTypeConvert(DataType_Float32, c, m_dataType, c, tmp.data(), getRawImage(_image, _mip), texelCount);
+}
+
 bool Image::validateFileFormat(FileFormat _format) const
 {
 	#define Image_ERR_IF(_cond, _msg, ...) \
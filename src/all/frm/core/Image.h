@@ -1,6 +1,7 @@
 #pragma once
 
 #include <frm/core/frm.h>
+#include <frm/core/math.h>
 #include <frm/core/types.h>
 
 namespace frm {
@@ -17,10 +18,15 @@ namespace frm {
 // a single cubemap has an array count of 1, however access to the faces via
 // getRawImage() should be as array*6+face.
 //
+// Mipmap generation and resampling convert to float32 and filter separably in
+// each dimension. Cubemap faces are filtered across the face edges.
+//
+// Block compression (BC1-7) is implemented in Image_bc.cpp, encoding is done
+// independently per 4x4 block.
+//
 // \todo
 // - Read*() functions and setRawData() should correctly release the 
 //   existing image first (or only if the load succeeded).
-// - 1/2/3D sample functions (need sample/wrap enums).
 ////////////////////////////////////////////////////////////////////////////////
 class Image
 {
@@ -55,6 +61,15 @@ public:
 		Compression_Invalid
 	};
 
+	enum CompressionQuality
+	{
+		CompressionQuality_Fast,    // BC6/7 use a single mode (1 region for BC6, mode 6 + mode 1 with the best estimated partition for BC7).
+		CompressionQuality_Default, // BC6/7 try the most commonly useful modes and the best few partitions.
+		CompressionQuality_High,    // BC6/7 try all modes/partitions/rotations, more refinement iterations for all formats.
+
+		CompressionQuality_Invalid
+	};
+
 	enum Layout
 	{
 		Layout_R,
@@ -65,6 +80,42 @@ public:
 		Layout_Invalid
 	};
 
+	enum Filter
+	{
+		Filter_Box,      // Average over the footprint of each destination texel (a 2x2 average for a power of 2 mip chain).
+		Filter_Triangle, // Tent filter, bilinear when upsampling.
+		Filter_Kaiser,   // Kaiser-windowed sinc, sharper than box/triangle.
+
+		Filter_Invalid
+	};
+
+	enum Wrap
+	{
+		Wrap_Clamp,
+		Wrap_Repeat,
+		Wrap_Mirror,
+
+		Wrap_Invalid
+	};
+
+	struct FilterOptions
+	{
+		Filter filter;
+		Wrap   wrap;        // Ignored for cubemaps, which are filtered across the face edges.
+		bool   isSrgb;      // Filter in linear space. Alpha is always linear.
+		float  kaiserWidth; // Kaiser filter radius (destination texels).
+		float  kaiserAlpha; // Kaiser window shape, larger values reduce ringing at the cost of sharpness.
+
+		FilterOptions(Filter _filter = Filter_Box, Wrap _wrap = Wrap_Clamp, bool _isSrgb = false)
+			: filter(_filter)
+			, wrap(_wrap)
+			, isSrgb(_isSrgb)
+			, kaiserWidth(3.0f)
+			, kaiserAlpha(4.0f)
+		{
+		}
+	};
+
 	enum FileFormat
 	{
 	 // read + write supported
@@ -117,6 +168,18 @@ public:
 		CompressionType _compressionType = Compression_None
 		);
 
+	// Resample mip 0 of each array layer/cubemap face of _img to _width * _height * _depth. The result has a single mip level. Cubemaps
+	// require _width == _height. Return nullptr if _img is compressed.
+	static Image* CreateResampled(const Image& _img, uint _width, uint _height, uint _depth, const FilterOptions& _options = FilterOptions());
+
+	// Block compress all mips/array layers of _img (which must be uncompressed). Source data is converted to Uint8N (Float for BC6, only
+	// unsigned BC6 is supported). BC1 uses 1 bit alpha if _img has an alpha channel. BC4/5 use the first 1/2 components. Multithreaded
+	// via JobSystem if called from a job thread. Return nullptr if _img is compressed or _compression is invalid.
+	static Image* CreateCompressed(const Image& _img, CompressionType _compression, CompressionQuality _quality = CompressionQuality_Default);
+
+	// Decode a block compressed image. The result is Uint8N (Float16 for BC6) with the same layout as _img.
+	static Image* CreateDecompressed(const Image& _img);
+
 	// Release memory, _image_ is set to 0.
 	static void Destroy(Image*& _image_);
 
@@ -165,7 +228,18 @@ public:
 	uint getRawImageSize(uint _mip = 0) const;
 
 	// Fill the image internal data buffer for a given _array/_mip, performing conversion to the image's internal format from the format of _src.
-	void setRawImage(uint _array, uint _mip, const void* _src, Layout _layout, DataType _dataType, CompressionType _compressionType);
+	// _swizzle optionally selects the source component for each component of the image (see DataTypeConvert()). By default missing 
+	// components are set to 0, or 1 for alpha.
+	void setRawImage(uint _array, uint _mip, const void* _src, Layout _layout, DataType _dataType, CompressionType _compressionType, const int* _swizzle = nullptr);
+
+	// Generate _mipmapCount mip levels (the full chain if 0) from level 0, reallocating the image if the mip count changes. Each level is
+	// filtered from the previous level at full precision. Multithreaded via JobSystem if called from a job thread. Return false if the
+	// image is compressed.
+	bool generateMipmaps(const FilterOptions& _options = FilterOptions(), uint _mipmapCount = 0);
+
+	// Bilinear (trilinear for 3d images) sample of _mip at normalized coordinates _uvw. For cubemaps, _array is array*6+face. Missing
+	// components are 0, or 1 for alpha. Uncompressed images only.
+	vec4 sample(const vec3& _uvw, uint _array = 0, uint _mip = 0, Wrap _wrap = Wrap_Repeat) const;
 
 private:
 	
@@ -175,6 +249,15 @@ private:
 	// Allocate m_data, set mip sizes/offsets. Sets m_errorState.
 	void alloc();
 
+	// Width/height/depth of _mip.
+	uvec3 getMipDimensions(uint _mip) const;
+
+	// Load _mip of _image (array*6+face for cubemaps) to dst_ as float32, converting sRGB to linear if _isSrgb.
+	void loadFloat(uint _image, uint _mip, bool _isSrgb, float* dst_) const;
+
+	// Store _src (float32) to _mip of _image, converting linear to sRGB if _isSrgb. Values are rounded to nearest for integer types.
+	void storeFloat(uint _image, uint _mip, bool _isSrgb, const float* _src);
+
 	uint  m_width, m_height, m_depth;    // Image dimensions, min = 1.
 	uint  m_arrayCount;                  // 1 for non-arrays, 6 for cubemaps.
 	uint  m_mipmapCount;                 // Number of valid mipmap levels, min = 1.
@@ -0,0 +1,2235 @@
+#include "Image.h"
+
+#include <frm/core/Log.h>
+#include <frm/core/math.h>
+#include <frm/core/memory.h>
+#include <frm/core/JobSystem.h>
+
+#include <EASTL/vector.h>
+
+#include <cfloat>
+#include <climits>
+#include <cstring>
+
+using namespace frm;
+
+// Block compression encoders/decoders, see the D3D11 functional spec (BC1-5, BC6H, BC7) or the Khronos Data Format spec.
+//
+// All encoders operate on a single 4x4 block. BC1-5 use a principal axis fit followed by least squares refinement of the endpoints.
+// BC6H/BC7 estimate the best partitions for each mode (unquantized endpoints), then quantize, refine and keep the mode/partition with the
+// lowest error. Only unsigned BC4/5/BC6H are supported.
+
+namespace {
+
+constexpr uint32 kBlockRowChunkSize = 1; // BC6/BC7 block rows are expensive, use fine grained jobs.
+
+// Read/write bits LSB first.
+struct BitReader
+{
+	const uint8* m_data;
+	int          m_offset;
+
+	BitReader(const void* _data): m_data((const uint8*)_data), m_offset(0) {}
+
+	uint32 read(int _count)
+	{
+		uint32 ret = 0;
+		for (int i = 0; i < _count; ++i, ++m_offset)
+		{
+			ret |= (uint32)((m_data[m_offset >> 3] >> (m_offset & 7)) & 1) << i;
+		}
+		return ret;
+	}
+};
+
+struct BitWriter
+{
+	uint8* m_data;
+	int    m_offset;
+
+	BitWriter(void* data_, int _sizeBytes): m_data((uint8*)data_), m_offset(0) { memset(m_data, 0, _sizeBytes); }
+
+	void write(uint32 _value, int _count)
+	{
+		for (int i = 0; i < _count; ++i, ++m_offset)
+		{
+			m_data[m_offset >> 3] |= (uint8)(((_value >> i) & 1) << (m_offset & 7));
+		}
+	}
+};
+
+// Mean and principal axis of _count points (_pixels indexes into _points), components [_channel, _channel + _dim). The axis is found
+// via power iteration on the covariance matrix, if all points are equal the axis is the diagonal.
+void PrincipalAxis(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, float* mean_, float* axis_)
+{
+	for (int c = 0; c < _dim; ++c)
+	{
+		mean_[c] = 0.0f;
+		for (int i = 0; i < _count; ++i)
+		{
+			mean_[c] += _points[_pixels[i]][_channel + c];
+		}
+		mean_[c] /= (float)FRM_MAX(_count, 1);
+	}
+
+	float cov[4][4] = {};
+	for (int i = 0; i < _count; ++i)
+	{
+		float d[4];
+		for (int c = 0; c < _dim; ++c)
+		{
+			d[c] = _points[_pixels[i]][_channel + c] - mean_[c];
+		}
+		for (int r = 0; r < _dim; ++r)
+		{
+			for (int c = 0; c < _dim; ++c)
+			{
+				cov[r][c] += d[r] * d[c];
+			}
+		}
+	}
+
+ // start from the row with the largest diagonal, converges quickly for the typical elongated distributions
+	int maxRow = 0;
+	for (int r = 1; r < _dim; ++r)
+	{
+		maxRow = cov[r][r] > cov[maxRow][maxRow] ? r : maxRow;
+	}
+	float axis[4];
+	for (int c = 0; c < _dim; ++c)
+	{
+		axis[c] = cov[maxRow][c];
+	}
+	for (int iteration = 0; iteration < 8; ++iteration)
+	{
+		float next[4] = {};
+		float len2 = 0.0f;
+		for (int r = 0; r < _dim; ++r)
+		{
+			for (int c = 0; c < _dim; ++c)
+			{
+				next[r] += cov[r][c] * axis[c];
+			}
+			len2 += next[r] * next[r];
+		}
+		if (len2 < 1e-12f)
+		{
+			break;
+		}
+		const float rlen = 1.0f / sqrtf(len2);
+		for (int c = 0; c < _dim; ++c)
+		{
+			axis[c] = next[c] * rlen;
+		}
+	}
+
+	float len2 = 0.0f;
+	for (int c = 0; c < _dim; ++c)
+	{
+		len2 += axis[c] * axis[c];
+	}
+	for (int c = 0; c < _dim; ++c)
+	{
+		axis_[c] = len2 > 1e-12f ? axis[c] / sqrtf(len2) : 1.0f / sqrtf((float)_dim);
+	}
+}
+
+// Endpoints at the extents of the projection of the points onto the principal axis.
+void AxisEndpoints(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, float (*ep_)[4])
+{
+	float mean[4], axis[4];
+	PrincipalAxis(_points, _pixels, _count, _channel, _dim, mean, axis);
+	float tmin = FLT_MAX, tmax = -FLT_MAX;
+	for (int i = 0; i < _count; ++i)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < _dim; ++c)
+		{
+			t += (_points[_pixels[i]][_channel + c] - mean[c]) * axis[c];
+		}
+		tmin = FRM_MIN(tmin, t);
+		tmax = FRM_MAX(tmax, t);
+	}
+	for (int c = 0; c < _dim; ++c)
+	{
+		ep_[0][c] = mean[c] + axis[c] * tmin;
+		ep_[1][c] = mean[c] + axis[c] * tmax;
+	}
+}
+
+// Least squares endpoints for fixed interpolation weights (_weights[i] is the weight of endpoint 1 for pixel i). Return false if the
+// system is degenerate (all weights equal).
+bool LeastSquaresEndpoints(const float (*_points)[4], const int* _pixels, const float* _weights, int _count, int _channel, int _dim, float (*ep_)[4])
+{
+	float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+	float ax[4] = {}, bx[4] = {};
+	for (int i = 0; i < _count; ++i)
+	{
+		const float b = _weights[i];
+		const float a = 1.0f - b;
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for (int c = 0; c < _dim; ++c)
+		{
+			const float x = _points[_pixels[i]][_channel + c];
+			ax[c] += a * x;
+			bx[c] += b * x;
+		}
+	}
+	const float det = aa * bb - ab * ab;
+	if (fabsf(det) < 1e-6f)
+	{
+		return false;
+	}
+	const float rdet = 1.0f / det;
+	for (int c = 0; c < _dim; ++c)
+	{
+		ep_[0][c] = (ax[c] * bb - bx[c] * ab) * rdet;
+		ep_[1][c] = (bx[c] * aa - ax[c] * ab) * rdet;
+	}
+	return true;
+}
+
+void StoreLE16(uint8* dst_, uint32 _value)
+{
+	dst_[0] = (uint8)_value;
+	dst_[1] = (uint8)(_value >> 8);
+}
+
+uint32 LoadLE16(const uint8* _src)
+{
+	return (uint32)_src[0] | ((uint32)_src[1] << 8);
+}
+
+/******************************************************************************
+
+                                  BC1-5
+
+******************************************************************************/
+
+int Expand5(int _x) { return (_x << 3) | (_x >> 2); }
+int Expand6(int _x) { return (_x << 2) | (_x >> 4); }
+
+uint32 Pack565(const int* _q)
+{
+	return (uint32)((_q[0] << 11) | (_q[1] << 5) | _q[2]);
+}
+
+void Unpack565(uint32 _c, int* rgb_)
+{
+	rgb_[0] = Expand5((_c >> 11) & 31);
+	rgb_[1] = Expand6((_c >> 5) & 63);
+	rgb_[2] = Expand5(_c & 31);
+}
+
+// 4 colors (or 3 colors + transparent black if _threeColor).
+void BC1_Palette(const int (*_ep)[3], bool _threeColor, int (*palette_)[4])
+{
+	for (int c = 0; c < 3; ++c)
+	{
+		const int a = _ep[0][c];
+		const int b = _ep[1][c];
+		palette_[0][c] = a;
+		palette_[1][c] = b;
+		if (_threeColor)
+		{
+			palette_[2][c] = (a + b) / 2;
+			palette_[3][c] = 0;
+		}
+		else
+		{
+			palette_[2][c] = (2 * a + b) / 3;
+			palette_[3][c] = (a + 2 * b) / 3;
+		}
+	}
+	palette_[0][3] = palette_[1][3] = palette_[2][3] = 255;
+	palette_[3][3] = _threeColor ? 0 : 255;
+}
+
+// Optimal 565 endpoints for a single color, for the 1/3 interpolant (4 color mode) or the midpoint (3 color mode).
+struct BC1SingleColorTable
+{
+	uint8 m_ep[2][3][256][2]; // [threeColor][channel][value][endpoint]
+
+	BC1SingleColorTable()
+	{
+		for (int threeColor = 0; threeColor < 2; ++threeColor)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				const int bits = c == 1 ? 6 : 5;
+				const int count = 1 << bits;
+				for (int v = 0; v < 256; ++v)
+				{
+					int bestError = INT_MAX;
+					for (int a = 0; a < count; ++a)
+					{
+						for (int b = 0; b < count; ++b)
+						{
+							const int ea = bits == 6 ? Expand6(a) : Expand5(a);
+							const int eb = bits == 6 ? Expand6(b) : Expand5(b);
+							const int x = threeColor ? (ea + eb) / 2 : (2 * ea + eb) / 3;
+							const int error = abs(x - v) * 256 + abs(ea - eb); // prefer close endpoints
+							if (error < bestError)
+							{
+								bestError = error;
+								m_ep[threeColor][c][v][0] = (uint8)a;
+								m_ep[threeColor][c][v][1] = (uint8)b;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+struct BC1Fit
+{
+	int   ep[2][3];    // Quantized 565.
+	uint8 indices[16];
+	int   error;
+};
+
+// Assign indices, return the squared error. Transparent texels use index 3.
+int BC1_Evaluate(const float (*_points)[4], uint32 _transparentMask, const int (*_ep)[3], bool _threeColor, uint8* indices_)
+{
+	int ep[2][3];
+	for (int i = 0; i < 2; ++i)
+	{
+		ep[i][0] = Expand5(_ep[i][0]);
+		ep[i][1] = Expand6(_ep[i][1]);
+		ep[i][2] = Expand5(_ep[i][2]);
+	}
+	int palette[4][4];
+	BC1_Palette(ep, _threeColor, palette);
+	const int paletteSize = _threeColor ? 3 : 4;
+
+	int ret = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		if (_transparentMask & (1 << i))
+		{
+			indices_[i] = 3;
+			continue;
+		}
+		int bestError = INT_MAX;
+		for (int j = 0; j < paletteSize; ++j)
+		{
+			int error = 0;
+			for (int c = 0; c < 3; ++c)
+			{
+				const int d = palette[j][c] - (int)_points[i][c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				indices_[i] = (uint8)j;
+			}
+		}
+		ret += bestError;
+	}
+	return ret;
+}
+
+void BC1_Quantize(const float (*_ep)[4], int (*ep_)[3])
+{
+	for (int i = 0; i < 2; ++i)
+	{
+		ep_[i][0] = FRM_CLAMP((int)(_ep[i][0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		ep_[i][1] = FRM_CLAMP((int)(_ep[i][1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+		ep_[i][2] = FRM_CLAMP((int)(_ep[i][2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+	}
+}
+
+void BC1_FitColor(const float (*_points)[4], uint32 _transparentMask, bool _threeColor, Image::CompressionQuality _quality, BC1Fit& fit_)
+{
+	int pixels[16];
+	int count = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		if (!(_transparentMask & (1 << i)))
+		{
+			pixels[count++] = i;
+		}
+	}
+	if (count == 0)
+	{
+		memset(fit_.ep, 0, sizeof(fit_.ep));
+		fit_.error = BC1_Evaluate(_points, _transparentMask, fit_.ep, _threeColor, fit_.indices);
+		return;
+	}
+
+ // single color, use the table
+	bool isSingleColor = true;
+	for (int i = 1; i < count && isSingleColor; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			isSingleColor &= _points[pixels[i]][c] == _points[pixels[0]][c];
+		}
+	}
+	if (isSingleColor)
+	{
+		static const BC1SingleColorTable s_table;
+		for (int c = 0; c < 3; ++c)
+		{
+			const int v = (int)_points[pixels[0]][c];
+			fit_.ep[0][c] = s_table.m_ep[_threeColor][c][v][0];
+			fit_.ep[1][c] = s_table.m_ep[_threeColor][c][v][1];
+		}
+		fit_.error = BC1_Evaluate(_points, _transparentMask, fit_.ep, _threeColor, fit_.indices);
+		return;
+	}
+
+	float ep[2][4];
+	AxisEndpoints(_points, pixels, count, 0, 3, ep);
+	BC1_Quantize(ep, fit_.ep);
+	fit_.error = BC1_Evaluate(_points, _transparentMask, fit_.ep, _threeColor, fit_.indices);
+
+	const int iterationCount = _quality == Image::CompressionQuality_Fast ? 1 : (_quality == Image::CompressionQuality_High ? 8 : 3);
+	static const float kWeights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	static const float kWeights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+	for (int iteration = 0; iteration < iterationCount && fit_.error > 0; ++iteration)
+	{
+		float weights[16];
+		for (int i = 0; i < count; ++i)
+		{
+			weights[i] = (_threeColor ? kWeights3 : kWeights4)[fit_.indices[pixels[i]]];
+		}
+		if (!LeastSquaresEndpoints(_points, pixels, weights, count, 0, 3, ep))
+		{
+			break;
+		}
+		BC1Fit fit;
+		BC1_Quantize(ep, fit.ep);
+		fit.error = BC1_Evaluate(_points, _transparentMask, fit.ep, _threeColor, fit.indices);
+		if (fit.error >= fit_.error)
+		{
+			break;
+		}
+		fit_ = fit;
+	}
+}
+
+// _fourColorOnly for BC2/3, which always interpret the color block in 4 color mode. _alpha enables 1 bit alpha for BC1 (texels with
+// alpha < 128 are transparent).
+void BC1_EncodeColor(const float (*_points)[4], bool _fourColorOnly, bool _alpha, Image::CompressionQuality _quality, uint8* dst_)
+{
+	uint32 transparentMask = 0;
+	if (_alpha && !_fourColorOnly)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			transparentMask |= _points[i][3] < 127.5f ? (1u << i) : 0u;
+		}
+	}
+
+	BC1Fit fit;
+	bool threeColor = transparentMask != 0;
+	BC1_FitColor(_points, transparentMask, threeColor, _quality, fit);
+	if (!threeColor && !_fourColorOnly && _quality != Image::CompressionQuality_Fast && fit.error > 0)
+	{
+		BC1Fit fit3;
+		BC1_FitColor(_points, 0, true, _quality, fit3);
+		if (fit3.error < fit.error)
+		{
+			fit = fit3;
+			threeColor = true;
+		}
+	}
+
+	uint32 c0 = Pack565(fit.ep[0]);
+	uint32 c1 = Pack565(fit.ep[1]);
+	if (threeColor)
+	{
+	 // c0 <= c1
+		if (c0 > c1)
+		{
+			eastl::swap(c0, c1);
+			for (uint8& index : fit.indices)
+			{
+				index = index < 2 ? index ^ 1 : index;
+			}
+		}
+	}
+	else
+	{
+	 // c0 > c1, or c0 == c1 in which case all palette entries are equal
+		if (c0 < c1)
+		{
+			eastl::swap(c0, c1);
+			for (uint8& index : fit.indices)
+			{
+				index ^= 1;
+			}
+		}
+		else if (c0 == c1)
+		{
+			memset(fit.indices, 0, sizeof(fit.indices));
+		}
+	}
+
+	StoreLE16(dst_ + 0, c0);
+	StoreLE16(dst_ + 2, c1);
+	uint32 indices = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		indices |= (uint32)fit.indices[i] << (i * 2);
+	}
+	StoreLE16(dst_ + 4, indices & 0xffff);
+	StoreLE16(dst_ + 6, indices >> 16);
+}
+
+void BC1_DecodeColor(const uint8* _src, bool _fourColorOnly, uint8 (*rgba_)[4])
+{
+	const uint32 c0 = LoadLE16(_src + 0);
+	const uint32 c1 = LoadLE16(_src + 2);
+	const uint32 indices = LoadLE16(_src + 4) | (LoadLE16(_src + 6) << 16);
+	int ep[2][3];
+	Unpack565(c0, ep[0]);
+	Unpack565(c1, ep[1]);
+	int palette[4][4];
+	BC1_Palette(ep, !_fourColorOnly && c0 <= c1, palette);
+	for (int i = 0; i < 16; ++i)
+	{
+		const int index = (indices >> (i * 2)) & 3;
+		for (int c = 0; c < 4; ++c)
+		{
+			rgba_[i][c] = (uint8)palette[index][c];
+		}
+	}
+}
+
+void BC2_EncodeAlpha(const float (*_points)[4], uint8* dst_)
+{
+	memset(dst_, 0, 8);
+	for (int i = 0; i < 16; ++i)
+	{
+		const int a = FRM_CLAMP((int)(_points[i][3] * (15.0f / 255.0f) + 0.5f), 0, 15);
+		dst_[i / 2] |= (uint8)(a << ((i & 1) * 4));
+	}
+}
+
+void BC2_DecodeAlpha(const uint8* _src, uint8 (*rgba_)[4])
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		rgba_[i][3] = (uint8)(((_src[i / 2] >> ((i & 1) * 4)) & 15) * 17);
+	}
+}
+
+// 8 values if _ep[0] > _ep[1], else 6 values plus 0 and 255.
+void BC4_Palette(int _a0, int _a1, int* palette_)
+{
+	palette_[0] = _a0;
+	palette_[1] = _a1;
+	if (_a0 > _a1)
+	{
+		for (int i = 1; i < 7; ++i)
+		{
+			palette_[i + 1] = ((7 - i) * _a0 + i * _a1 + 3) / 7;
+		}
+	}
+	else
+	{
+		for (int i = 1; i < 5; ++i)
+		{
+			palette_[i + 1] = ((5 - i) * _a0 + i * _a1 + 2) / 5;
+		}
+		palette_[6] = 0;
+		palette_[7] = 255;
+	}
+}
+
+int BC4_Evaluate(const float (*_points)[4], int _channel, int _a0, int _a1, uint8* indices_)
+{
+	int palette[8];
+	BC4_Palette(_a0, _a1, palette);
+	int ret = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		const int v = (int)_points[i][_channel];
+		int bestError = INT_MAX;
+		for (int j = 0; j < 8; ++j)
+		{
+			const int error = (palette[j] - v) * (palette[j] - v);
+			if (error < bestError)
+			{
+				bestError = error;
+				indices_[i] = (uint8)j;
+			}
+		}
+		ret += bestError;
+	}
+	return ret;
+}
+
+// Refine endpoints (a0 > a1 for 8 value mode, a0 <= a1 for 6 value mode) via least squares, optionally followed by a local search.
+void BC4_Refine(const float (*_points)[4], int _channel, bool _sixValues, Image::CompressionQuality _quality, int (&ep_)[2], uint8* indices_, int& error_)
+{
+	static const float kWeights8[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+	static const float kWeights6[6] = { 0.0f, 1.0f, 1.0f / 5.0f, 2.0f / 5.0f, 3.0f / 5.0f, 4.0f / 5.0f };
+	auto IsValid = [_sixValues](int _a0, int _a1) { return _sixValues ? _a0 <= _a1 : _a0 > _a1; };
+
+	const int iterationCount = _quality == Image::CompressionQuality_Fast ? 1 : (_quality == Image::CompressionQuality_High ? 8 : 3);
+	for (int iteration = 0; iteration < iterationCount && error_ > 0; ++iteration)
+	{
+		int pixels[16];
+		float weights[16];
+		int count = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			if (!_sixValues || indices_[i] < 6) // 0 and 255 don't depend on the endpoints
+			{
+				weights[count] = _sixValues ? kWeights6[indices_[i]] : kWeights8[indices_[i]];
+				pixels[count++] = i;
+			}
+		}
+		float ep[2][4];
+		if (!LeastSquaresEndpoints(_points, pixels, weights, count, _channel, 1, ep))
+		{
+			break;
+		}
+		const int a0 = FRM_CLAMP((int)(ep[0][0] + 0.5f), 0, 255);
+		const int a1 = FRM_CLAMP((int)(ep[1][0] + 0.5f), 0, 255);
+		if (!IsValid(a0, a1))
+		{
+			break;
+		}
+		uint8 indices[16];
+		const int error = BC4_Evaluate(_points, _channel, a0, a1, indices);
+		if (error >= error_)
+		{
+			break;
+		}
+		ep_[0] = a0;
+		ep_[1] = a1;
+		memcpy(indices_, indices, 16);
+		error_ = error;
+	}
+
+	if (_quality == Image::CompressionQuality_High)
+	{
+		for (bool improved = true; improved && error_ > 0; )
+		{
+			improved = false;
+			for (int i = 0; i < 2; ++i)
+			{
+				for (int d = -2; d <= 2; ++d)
+				{
+					int ep[2] = { ep_[0], ep_[1] };
+					ep[i] += d;
+					if (d == 0 || ep[i] < 0 || ep[i] > 255 || !IsValid(ep[0], ep[1]))
+					{
+						continue;
+					}
+					uint8 indices[16];
+					const int error = BC4_Evaluate(_points, _channel, ep[0], ep[1], indices);
+					if (error < error_)
+					{
+						ep_[0] = ep[0];
+						ep_[1] = ep[1];
+						memcpy(indices_, indices, 16);
+						error_ = error;
+						improved = true;
+					}
+				}
+			}
+		}
+	}
+}
+
+void BC4_Encode(const float (*_points)[4], int _channel, Image::CompressionQuality _quality, uint8* dst_)
+{
+	int vmin = 255, vmax = 0;
+	int imin = 255, imax = 0; // excluding 0, 255
+	for (int i = 0; i < 16; ++i)
+	{
+		const int v = (int)_points[i][_channel];
+		vmin = FRM_MIN(vmin, v);
+		vmax = FRM_MAX(vmax, v);
+		if (v > 0 && v < 255)
+		{
+			imin = FRM_MIN(imin, v);
+			imax = FRM_MAX(imax, v);
+		}
+	}
+
+	int ep[2];
+	uint8 indices[16];
+	int error;
+	if (vmin == vmax)
+	{
+		ep[0] = ep[1] = vmin;
+		memset(indices, 0, sizeof(indices));
+	}
+	else
+	{
+		ep[0] = vmax;
+		ep[1] = vmin;
+		error = BC4_Evaluate(_points, _channel, ep[0], ep[1], indices);
+		BC4_Refine(_points, _channel, false, _quality, ep, indices, error);
+
+	 // 6 value mode is useful if the block contains 0 or 255
+		if (error > 0 && (vmin == 0 || vmax == 255))
+		{
+			int ep6[2] = { FRM_MIN(imin, imax), imax };
+			uint8 indices6[16];
+			int error6 = BC4_Evaluate(_points, _channel, ep6[0], ep6[1], indices6);
+			BC4_Refine(_points, _channel, true, _quality, ep6, indices6, error6);
+			if (error6 < error)
+			{
+				ep[0] = ep6[0];
+				ep[1] = ep6[1];
+				memcpy(indices, indices6, sizeof(indices));
+			}
+		}
+	}
+
+	dst_[0] = (uint8)ep[0];
+	dst_[1] = (uint8)ep[1];
+	uint64 bits = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		bits |= (uint64)indices[i] << (i * 3);
+	}
+	for (int i = 0; i < 6; ++i)
+	{
+		dst_[2 + i] = (uint8)(bits >> (i * 8));
+	}
+}
+
+void BC4_Decode(const uint8* _src, int _channel, uint8 (*rgba_)[4])
+{
+	int palette[8];
+	BC4_Palette(_src[0], _src[1], palette);
+	uint64 bits = 0;
+	for (int i = 0; i < 6; ++i)
+	{
+		bits |= (uint64)_src[2 + i] << (i * 8);
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		rgba_[i][_channel] = (uint8)palette[(bits >> (i * 3)) & 7];
+	}
+}
+
+/******************************************************************************
+
+                                  BC6H/BC7
+
+******************************************************************************/
+
+// Subset of pixel i is (kPartitions2[p] >> i) & 1.
+const uint16 kPartitions2[64] =
+{
+	0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+	0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+	0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+	0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+};
+
+const uint8 kPartitions3[64][16] =
+{
+	{ 0,0,1,1, 0,0,1,1, 0,2,2,1, 2,2,2,2 }, { 0,0,0,1, 0,0,1,1, 2,2,1,1, 2,2,2,1 }, { 0,0,0,0, 2,0,0,1, 2,2,1,1, 2,2,1,1 }, { 0,2,2,2, 0,0,2,2, 0,0,1,1, 0,1,1,1 },
+	{ 0,0,0,0, 0,0,0,0, 1,1,2,2, 1,1,2,2 }, { 0,0,1,1, 0,0,1,1, 0,0,2,2, 0,0,2,2 }, { 0,0,2,2, 0,0,2,2, 1,1,1,1, 1,1,1,1 }, { 0,0,1,1, 0,0,1,1, 2,2,1,1, 2,2,1,1 },
+	{ 0,0,0,0, 0,0,0,0, 1,1,1,1, 2,2,2,2 }, { 0,0,0,0, 1,1,1,1, 1,1,1,1, 2,2,2,2 }, { 0,0,0,0, 1,1,1,1, 2,2,2,2, 2,2,2,2 }, { 0,0,1,2, 0,0,1,2, 0,0,1,2, 0,0,1,2 },
+	{ 0,1,1,2, 0,1,1,2, 0,1,1,2, 0,1,1,2 }, { 0,1,2,2, 0,1,2,2, 0,1,2,2, 0,1,2,2 }, { 0,0,1,1, 0,1,1,2, 1,1,2,2, 1,2,2,2 }, { 0,0,1,1, 2,0,0,1, 2,2,0,0, 2,2,2,0 },
+	{ 0,0,0,1, 0,0,1,1, 0,1,1,2, 1,1,2,2 }, { 0,1,1,1, 0,0,1,1, 2,0,0,1, 2,2,0,0 }, { 0,0,0,0, 1,1,2,2, 1,1,2,2, 1,1,2,2 }, { 0,0,2,2, 0,0,2,2, 0,0,2,2, 1,1,1,1 },
+	{ 0,1,1,1, 0,1,1,1, 0,2,2,2, 0,2,2,2 }, { 0,0,0,1, 0,0,0,1, 2,2,2,1, 2,2,2,1 }, { 0,0,0,0, 0,0,1,1, 0,1,2,2, 0,1,2,2 }, { 0,0,0,0, 1,1,0,0, 2,2,1,0, 2,2,1,0 },
+	{ 0,1,2,2, 0,1,2,2, 0,0,1,1, 0,0,0,0 }, { 0,0,1,2, 0,0,1,2, 1,1,2,2, 2,2,2,2 }, { 0,1,1,0, 1,2,2,1, 1,2,2,1, 0,1,1,0 }, { 0,0,0,0, 0,1,1,0, 1,2,2,1, 1,2,2,1 },
+	{ 0,0,2,2, 1,1,0,2, 1,1,0,2, 0,0,2,2 }, { 0,1,1,0, 0,1,1,0, 2,0,0,2, 2,2,2,2 }, { 0,0,1,1, 0,1,2,2, 0,1,2,2, 0,0,1,1 }, { 0,0,0,0, 2,0,0,0, 2,2,1,1, 2,2,2,1 },
+	{ 0,0,0,0, 0,0,0,2, 1,1,2,2, 1,2,2,2 }, { 0,2,2,2, 0,0,2,2, 0,0,1,2, 0,0,1,1 }, { 0,0,1,1, 0,0,1,2, 0,0,2,2, 0,2,2,2 }, { 0,1,2,0, 0,1,2,0, 0,1,2,0, 0,1,2,0 },
+	{ 0,0,0,0, 1,1,1,1, 2,2,2,2, 0,0,0,0 }, { 0,1,2,0, 1,2,0,1, 2,0,1,2, 0,1,2,0 }, { 0,1,2,0, 2,0,1,2, 1,2,0,1, 0,1,2,0 }, { 0,0,1,1, 2,2,0,0, 1,1,2,2, 0,0,1,1 },
+	{ 0,0,1,1, 1,1,2,2, 2,2,0,0, 0,0,1,1 }, { 0,1,0,1, 0,1,0,1, 2,2,2,2, 2,2,2,2 }, { 0,0,0,0, 0,0,0,0, 2,1,2,1, 2,1,2,1 }, { 0,0,2,2, 1,1,2,2, 0,0,2,2, 1,1,2,2 },
+	{ 0,0,2,2, 0,0,1,1, 0,0,2,2, 0,0,1,1 }, { 0,2,2,0, 1,2,2,1, 0,2,2,0, 1,2,2,1 }, { 0,1,0,1, 2,2,2,2, 2,2,2,2, 0,1,0,1 }, { 0,0,0,0, 2,1,2,1, 2,1,2,1, 2,1,2,1 },
+	{ 0,1,0,1, 0,1,0,1, 0,1,0,1, 2,2,2,2 }, { 0,2,2,2, 0,1,1,1, 0,2,2,2, 0,1,1,1 }, { 0,0,0,2, 1,1,1,2, 0,0,0,2, 1,1,1,2 }, { 0,0,0,0, 2,1,1,2, 2,1,1,2, 2,1,1,2 },
+	{ 0,2,2,2, 0,1,1,1, 0,1,1,1, 0,2,2,2 }, { 0,0,0,2, 1,1,1,2, 1,1,1,2, 0,0,0,2 }, { 0,1,1,0, 0,1,1,0, 0,1,1,0, 2,2,2,2 }, { 0,0,0,0, 0,0,0,0, 2,1,1,2, 2,1,1,2 },
+	{ 0,1,1,0, 0,1,1,0, 2,2,2,2, 2,2,2,2 }, { 0,0,2,2, 0,0,1,1, 0,0,1,1, 0,0,2,2 }, { 0,0,2,2, 1,1,2,2, 1,1,2,2, 0,0,2,2 }, { 0,0,0,0, 0,0,0,0, 0,0,0,0, 2,1,1,2 },
+	{ 0,0,0,2, 0,0,0,1, 0,0,0,2, 0,0,0,1 }, { 0,2,2,2, 1,2,2,2, 0,2,2,2, 1,2,2,2 }, { 0,1,0,1, 2,2,2,2, 2,2,2,2, 2,2,2,2 }, { 0,1,1,1, 2,0,1,1, 2,2,0,1, 2,2,2,0 },
+};
+
+// Anchor (fix-up) index of subset 1 for 2 subsets, subsets 1 and 2 for 3 subsets. The anchor of subset 0 is always pixel 0.
+const uint8 kAnchors2[64] =
+{
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15
+};
+const uint8 kAnchors3[2][64] =
+{
+	{
+		 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+		 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3
+	},
+	{
+		15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+		15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8
+	}
+};
+
+const int kWeights2[4]  = { 0, 21, 43, 64 };
+const int kWeights3[8]  = { 0, 9, 18, 27, 37, 46, 55, 64 };
+const int kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+const int* GetWeights(int _indexBits)
+{
+	return _indexBits == 2 ? kWeights2 : (_indexBits == 3 ? kWeights3 : kWeights4);
+}
+
+int Interpolate(int _a, int _b, int _weight)
+{
+	return ((64 - _weight) * _a + _weight * _b + 32) >> 6;
+}
+
+int GetSubset(int _subsetCount, int _partition, int _pixel)
+{
+	switch (_subsetCount)
+	{
+		case 2:  return (kPartitions2[_partition] >> _pixel) & 1;
+		case 3:  return kPartitions3[_partition][_pixel];
+		default: return 0;
+	};
+}
+
+bool IsAnchor(int _subsetCount, int _partition, int _pixel)
+{
+	switch (_subsetCount)
+	{
+		case 2:  return _pixel == 0 || _pixel == kAnchors2[_partition];
+		case 3:  return _pixel == 0 || _pixel == kAnchors3[0][_partition] || _pixel == kAnchors3[1][_partition];
+		default: return _pixel == 0;
+	};
+}
+
+// Pixel indices per subset.
+struct Subsets
+{
+	int m_pixels[3][16];
+	int m_counts[3];
+
+	Subsets(int _subsetCount, int _partition)
+	{
+		m_counts[0] = m_counts[1] = m_counts[2] = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			const int s = GetSubset(_subsetCount, _partition, i);
+			m_pixels[s][m_counts[s]++] = i;
+		}
+	}
+};
+
+// Estimate the error for a partition: endpoints at the extents of the principal axis (unquantized), nearest of the index levels.
+float EstimatePartitionError(const float (*_points)[4], int _subsetCount, int _partition, int _dim, int _indexBits, const float* _channelWeights)
+{
+	const Subsets subsets(_subsetCount, _partition);
+	const int* weights = GetWeights(_indexBits);
+	const int levelCount = 1 << _indexBits;
+	float ret = 0.0f;
+	for (int s = 0; s < _subsetCount; ++s)
+	{
+		float ep[2][4];
+		AxisEndpoints(_points, subsets.m_pixels[s], subsets.m_counts[s], 0, _dim, ep);
+		for (int i = 0; i < subsets.m_counts[s]; ++i)
+		{
+			const float* p = _points[subsets.m_pixels[s][i]];
+			float bestError = FLT_MAX;
+			for (int j = 0; j < levelCount; ++j)
+			{
+				const float w = (float)weights[j] / 64.0f;
+				float error = 0.0f;
+				for (int c = 0; c < _dim; ++c)
+				{
+					const float d = ep[0][c] + (ep[1][c] - ep[0][c]) * w - p[c];
+					error += d * d * _channelWeights[c];
+				}
+				bestError = FRM_MIN(bestError, error);
+			}
+			ret += bestError;
+		}
+	}
+	return ret;
+}
+
+// Write the _count best partitions to partitions_, return the number written.
+int SelectPartitions(const float (*_points)[4], int _subsetCount, int _partitionCount, int _dim, int _indexBits, const float* _channelWeights, int _count, int* partitions_)
+{
+	float errors[64];
+	int   order[64];
+	for (int p = 0; p < _partitionCount; ++p)
+	{
+		errors[p] = EstimatePartitionError(_points, _subsetCount, p, _dim, _indexBits, _channelWeights);
+		order[p] = p;
+	}
+	const int ret = FRM_MIN(_count, _partitionCount);
+	for (int i = 0; i < ret; ++i)
+	{
+		for (int j = i + 1; j < _partitionCount; ++j)
+		{
+			if (errors[order[j]] < errors[order[i]])
+			{
+				eastl::swap(order[i], order[j]);
+			}
+		}
+		partitions_[i] = order[i];
+	}
+	return ret;
+}
+
+/*	BC7 */
+
+struct BC7ModeInfo
+{
+	int subsetCount;
+	int partitionBits;
+	int rotationBits;
+	int indexSelectionBits;
+	int colorBits;
+	int alphaBits;
+	int endpointPBits;
+	int sharedPBits;
+	int indexBits;
+	int index2Bits;
+};
+const BC7ModeInfo kBC7Modes[8] =
+{
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+struct BC7Block
+{
+	int   mode           = -1;
+	int   partition      = 0;
+	int   rotation       = 0;
+	int   indexSelection = 0;
+	int   endpoints[3][2][4] = {}; // [subset][endpoint][channel], quantized (excluding the p-bit).
+	int   pbits[3][2]        = {}; // [subset][endpoint], equal for shared p-bits.
+	uint8 indices[16]        = {};
+	uint8 indices2[16]       = {}; // Modes 4, 5.
+};
+
+// Expand a quantized endpoint component (including the p-bit if present) to 8 bits.
+int BC7_Unquantize(int _value, int _pbit, int _bits, bool _hasPBit)
+{
+	if (_hasPBit)
+	{
+		_value = (_value << 1) | _pbit;
+		++_bits;
+	}
+	_value <<= 8 - _bits;
+	return _value | (_value >> _bits);
+}
+
+void BC7_Pack(const BC7Block& _block, uint8* dst_)
+{
+	const BC7ModeInfo& mode = kBC7Modes[_block.mode];
+	const int channelCount = mode.alphaBits ? 4 : 3;
+	const bool hasPBits = mode.endpointPBits || mode.sharedPBits;
+	BitWriter bits(dst_, 16);
+	bits.write(1u << _block.mode, _block.mode + 1);
+	bits.write(_block.partition, mode.partitionBits);
+	bits.write(_block.rotation, mode.rotationBits);
+	bits.write(_block.indexSelection, mode.indexSelectionBits);
+	for (int c = 0; c < channelCount; ++c)
+	{
+		for (int s = 0; s < mode.subsetCount; ++s)
+		{
+			for (int e = 0; e < 2; ++e)
+			{
+				bits.write(_block.endpoints[s][e][c], c < 3 ? mode.colorBits : mode.alphaBits);
+			}
+		}
+	}
+	if (hasPBits)
+	{
+		for (int s = 0; s < mode.subsetCount; ++s)
+		{
+			bits.write(_block.pbits[s][0], 1);
+			if (mode.endpointPBits)
+			{
+				bits.write(_block.pbits[s][1], 1);
+			}
+		}
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		bits.write(_block.indices[i], mode.indexBits - (IsAnchor(mode.subsetCount, _block.partition, i) ? 1 : 0));
+	}
+	if (mode.index2Bits)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			bits.write(_block.indices2[i], mode.index2Bits - (i == 0 ? 1 : 0));
+		}
+	}
+	FRM_ASSERT(bits.m_offset == 128);
+}
+
+bool BC7_Unpack(const uint8* _src, BC7Block& block_)
+{
+	int modeIndex = 0;
+	while (modeIndex < 8 && !((_src[0] >> modeIndex) & 1))
+	{
+		++modeIndex;
+	}
+	if (modeIndex == 8)
+	{
+		return false; // reserved
+	}
+	block_.mode = modeIndex;
+	const BC7ModeInfo& mode = kBC7Modes[modeIndex];
+	const int channelCount = mode.alphaBits ? 4 : 3;
+	BitReader bits(_src);
+	bits.read(modeIndex + 1);
+	block_.partition      = (int)bits.read(mode.partitionBits);
+	block_.rotation       = (int)bits.read(mode.rotationBits);
+	block_.indexSelection = (int)bits.read(mode.indexSelectionBits);
+	for (int c = 0; c < channelCount; ++c)
+	{
+		for (int s = 0; s < mode.subsetCount; ++s)
+		{
+			for (int e = 0; e < 2; ++e)
+			{
+				block_.endpoints[s][e][c] = (int)bits.read(c < 3 ? mode.colorBits : mode.alphaBits);
+			}
+		}
+	}
+	for (int s = 0; s < mode.subsetCount; ++s)
+	{
+		if (mode.endpointPBits)
+		{
+			block_.pbits[s][0] = (int)bits.read(1);
+			block_.pbits[s][1] = (int)bits.read(1);
+		}
+		else if (mode.sharedPBits)
+		{
+			block_.pbits[s][0] = block_.pbits[s][1] = (int)bits.read(1);
+		}
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		block_.indices[i] = (uint8)bits.read(mode.indexBits - (IsAnchor(mode.subsetCount, block_.partition, i) ? 1 : 0));
+	}
+	if (mode.index2Bits)
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			block_.indices2[i] = (uint8)bits.read(mode.index2Bits - (i == 0 ? 1 : 0));
+		}
+	}
+	return true;
+}
+
+// Unquantized endpoints, alpha is 255 for modes without alpha.
+void BC7_GetEndpoints(const BC7Block& _block, int (*ep_)[2][4])
+{
+	const BC7ModeInfo& mode = kBC7Modes[_block.mode];
+	const bool hasPBits = mode.endpointPBits || mode.sharedPBits;
+	for (int s = 0; s < mode.subsetCount; ++s)
+	{
+		for (int e = 0; e < 2; ++e)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				ep_[s][e][c] = BC7_Unquantize(_block.endpoints[s][e][c], _block.pbits[s][e], mode.colorBits, hasPBits);
+			}
+			ep_[s][e][3] = mode.alphaBits ? BC7_Unquantize(_block.endpoints[s][e][3], _block.pbits[s][e], mode.alphaBits, hasPBits) : 255;
+		}
+	}
+}
+
+void BC7_Decode(const uint8* _src, uint8 (*rgba_)[4])
+{
+	BC7Block block;
+	if (!BC7_Unpack(_src, block))
+	{
+		memset(rgba_, 0, 16 * 4);
+		return;
+	}
+	const BC7ModeInfo& mode = kBC7Modes[block.mode];
+	int ep[3][2][4];
+	BC7_GetEndpoints(block, ep);
+	for (int i = 0; i < 16; ++i)
+	{
+		const int s = GetSubset(mode.subsetCount, block.partition, i);
+		int colorWeight, alphaWeight;
+		if (mode.index2Bits)
+		{
+			const bool swap = block.indexSelection != 0;
+			colorWeight = swap ? GetWeights(mode.index2Bits)[block.indices2[i]] : GetWeights(mode.indexBits)[block.indices[i]];
+			alphaWeight = swap ? GetWeights(mode.indexBits)[block.indices[i]] : GetWeights(mode.index2Bits)[block.indices2[i]];
+		}
+		else
+		{
+			colorWeight = alphaWeight = GetWeights(mode.indexBits)[block.indices[i]];
+		}
+		for (int c = 0; c < 4; ++c)
+		{
+			rgba_[i][c] = (uint8)Interpolate(ep[s][0][c], ep[s][1][c], c < 3 ? colorWeight : alphaWeight);
+		}
+		if (block.rotation)
+		{
+			eastl::swap(rgba_[i][3], rgba_[i][block.rotation - 1]);
+		}
+	}
+}
+
+// Quantize v (0-255) to _bits, return the quantized value. If _hasPBit, _pbit is fixed.
+int BC7_Quantize(float _v, int _bits, int _pbit, bool _hasPBit)
+{
+	const int maxValue = (1 << _bits) - 1;
+	const int totalBits = _bits + (_hasPBit ? 1 : 0);
+	const float scaled = _v / 255.0f * (float)((1 << totalBits) - 1);
+	int q = _hasPBit ? (int)((scaled - (float)_pbit) * 0.5f + 0.5f) : (int)(scaled + 0.5f);
+	q = FRM_CLAMP(q, 0, maxValue);
+
+ // bit replication isn't exactly linear, check neighbors
+	int best = q;
+	float bestError = FLT_MAX;
+	for (int candidate = FRM_MAX(q - 1, 0); candidate <= FRM_MIN(q + 1, maxValue); ++candidate)
+	{
+		const float error = fabsf((float)BC7_Unquantize(candidate, _pbit, _bits, _hasPBit) - _v);
+		if (error < bestError)
+		{
+			bestError = error;
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+// Fit state for one index set of one subset: channels [channel, channel + dim).
+struct BC7SubsetFit
+{
+	int   endpoints[2][4];
+	int   pbits[2];
+	uint8 indices[16]; // per pixel in the subset
+	float error;
+};
+
+// Assign indices for quantized endpoints, return the error.
+float BC7_EvaluateSubset(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, const int (*_ep)[4], int _indexBits, uint8* indices_)
+{
+	const int* weights = GetWeights(_indexBits);
+	const int levelCount = 1 << _indexBits;
+	int palette[16][4];
+	for (int j = 0; j < levelCount; ++j)
+	{
+		for (int c = 0; c < _dim; ++c)
+		{
+			palette[j][c] = Interpolate(_ep[0][c], _ep[1][c], weights[j]);
+		}
+	}
+	float ret = 0.0f;
+	for (int i = 0; i < _count; ++i)
+	{
+		const float* p = _points[_pixels[i]] + _channel;
+		float bestError = FLT_MAX;
+		for (int j = 0; j < levelCount; ++j)
+		{
+			float error = 0.0f;
+			for (int c = 0; c < _dim; ++c)
+			{
+				const float d = (float)palette[j][c] - p[c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				indices_[i] = (uint8)j;
+			}
+		}
+		ret += bestError;
+	}
+	return ret;
+}
+
+// Quantize float endpoints, try all p-bit combinations and keep the best.
+void BC7_QuantizeSubset(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, const float (*_ep)[4], const BC7ModeInfo& _mode, int _bits, int _indexBits, BC7SubsetFit& fit_)
+{
+	const bool hasPBits = _mode.endpointPBits || _mode.sharedPBits;
+	const int pbitCombinations = _mode.endpointPBits ? 4 : (_mode.sharedPBits ? 2 : 1);
+	fit_.error = FLT_MAX;
+	for (int pc = 0; pc < pbitCombinations; ++pc)
+	{
+		int pbits[2];
+		pbits[0] = pc & 1;
+		pbits[1] = _mode.endpointPBits ? (pc >> 1) : pbits[0];
+		int quantized[2][4];
+		int unquantized[2][4];
+		for (int e = 0; e < 2; ++e)
+		{
+			for (int c = 0; c < _dim; ++c)
+			{
+				quantized[e][c]   = BC7_Quantize(_ep[e][c], _bits, pbits[e], hasPBits);
+				unquantized[e][c] = BC7_Unquantize(quantized[e][c], pbits[e], _bits, hasPBits);
+			}
+		}
+		uint8 indices[16];
+		const float error = BC7_EvaluateSubset(_points, _pixels, _count, _channel, _dim, unquantized, _indexBits, indices);
+		if (error < fit_.error)
+		{
+			fit_.error = error;
+			memcpy(fit_.endpoints, quantized, sizeof(quantized));
+			fit_.pbits[0] = pbits[0];
+			fit_.pbits[1] = pbits[1];
+			memcpy(fit_.indices, indices, _count);
+		}
+	}
+}
+
+// Single color: search endpoint pairs around the color such that one of the interpolated values is as close as possible, this is
+// usually exact whereas quantizing the color directly isn't (e.g. if the p-bit doesn't match).
+bool BC7_FitSingleColor(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, const BC7ModeInfo& _mode, int _bits, int _indexBits, BC7SubsetFit& fit_)
+{
+	for (int i = 1; i < _count; ++i)
+	{
+		for (int c = 0; c < _dim; ++c)
+		{
+			if (_points[_pixels[i]][_channel + c] != _points[_pixels[0]][_channel + c])
+			{
+				return false;
+			}
+		}
+	}
+
+	const bool hasPBits = _mode.endpointPBits || _mode.sharedPBits;
+	const int pbitCombinations = _mode.endpointPBits ? 4 : (_mode.sharedPBits ? 2 : 1);
+	const int maxValue = (1 << _bits) - 1;
+	const int* weights = GetWeights(_indexBits);
+	fit_.error = FLT_MAX;
+	for (int pc = 0; pc < pbitCombinations; ++pc)
+	{
+		int pbits[2];
+		pbits[0] = pc & 1;
+		pbits[1] = _mode.endpointPBits ? (pc >> 1) : pbits[0];
+		for (int j = 0; j < (1 << _indexBits); ++j)
+		{
+			int endpoints[2][4];
+			float error = 0.0f;
+			for (int c = 0; c < _dim; ++c)
+			{
+				const float v = _points[_pixels[0]][_channel + c];
+				const int q = BC7_Quantize(v, _bits, pbits[0], hasPBits);
+				int bestError = INT_MAX;
+				for (int q0 = FRM_MAX(q - 2, 0); q0 <= FRM_MIN(q + 2, maxValue); ++q0)
+				{
+					for (int q1 = FRM_MAX(q - 2, 0); q1 <= FRM_MIN(q + 2, maxValue); ++q1)
+					{
+						const int x = Interpolate(BC7_Unquantize(q0, pbits[0], _bits, hasPBits), BC7_Unquantize(q1, pbits[1], _bits, hasPBits), weights[j]);
+						const int e = abs(x - (int)v);
+						if (e < bestError)
+						{
+							bestError = e;
+							endpoints[0][c] = q0;
+							endpoints[1][c] = q1;
+						}
+					}
+				}
+				error += (float)(bestError * bestError);
+			}
+			error *= (float)_count;
+			if (error < fit_.error)
+			{
+				fit_.error = error;
+				memcpy(fit_.endpoints, endpoints, sizeof(endpoints));
+				fit_.pbits[0] = pbits[0];
+				fit_.pbits[1] = pbits[1];
+				memset(fit_.indices, j, _count);
+			}
+		}
+	}
+	return true;
+}
+
+void BC7_FitSubset(const float (*_points)[4], const int* _pixels, int _count, int _channel, int _dim, const BC7ModeInfo& _mode, int _bits, int _indexBits, int _iterationCount, BC7SubsetFit& fit_)
+{
+	if (BC7_FitSingleColor(_points, _pixels, _count, _channel, _dim, _mode, _bits, _indexBits, fit_))
+	{
+		return;
+	}
+
+	float ep[2][4];
+	AxisEndpoints(_points, _pixels, _count, _channel, _dim, ep);
+	for (int e = 0; e < 2; ++e)
+	{
+		for (int c = 0; c < _dim; ++c)
+		{
+			ep[e][c] = FRM_CLAMP(ep[e][c], 0.0f, 255.0f);
+		}
+	}
+	BC7_QuantizeSubset(_points, _pixels, _count, _channel, _dim, ep, _mode, _bits, _indexBits, fit_);
+
+	const int* weights = GetWeights(_indexBits);
+	for (int iteration = 0; iteration < _iterationCount && fit_.error > 0.0f; ++iteration)
+	{
+		float w[16];
+		for (int i = 0; i < _count; ++i)
+		{
+			w[i] = (float)weights[fit_.indices[i]] / 64.0f;
+		}
+		if (!LeastSquaresEndpoints(_points, _pixels, w, _count, _channel, _dim, ep))
+		{
+			break;
+		}
+		for (int e = 0; e < 2; ++e)
+		{
+			for (int c = 0; c < _dim; ++c)
+			{
+				ep[e][c] = FRM_CLAMP(ep[e][c], 0.0f, 255.0f);
+			}
+		}
+		BC7SubsetFit fit;
+		BC7_QuantizeSubset(_points, _pixels, _count, _channel, _dim, ep, _mode, _bits, _indexBits, fit);
+		if (fit.error >= fit_.error)
+		{
+			break;
+		}
+		fit_ = fit;
+	}
+}
+
+// Swap endpoints (and invert indices) such that the MSB of the anchor index is 0.
+void BC7_FixAnchor(BC7SubsetFit& fit_, int _anchor, int _dimBegin, int _dimEnd, int _indexBits, bool _swapPBits)
+{
+	const int maxIndex = (1 << _indexBits) - 1;
+	if (fit_.indices[_anchor] <= (maxIndex >> 1))
+	{
+		return;
+	}
+	for (int c = _dimBegin; c < _dimEnd; ++c)
+	{
+		eastl::swap(fit_.endpoints[0][c], fit_.endpoints[1][c]);
+	}
+	if (_swapPBits)
+	{
+		eastl::swap(fit_.pbits[0], fit_.pbits[1]);
+	}
+	for (uint8& index : fit_.indices)
+	{
+		index = (uint8)(maxIndex - index);
+	}
+}
+
+// Encode _points with _mode/_partition/_rotation/_indexSelection, return the error.
+float BC7_EncodeMode(const float (*_points)[4], int _modeIndex, int _partition, int _rotation, int _indexSelection, int _iterationCount, BC7Block& block_)
+{
+	const BC7ModeInfo& mode = kBC7Modes[_modeIndex];
+	block_.mode           = _modeIndex;
+	block_.partition      = _partition;
+	block_.rotation       = _rotation;
+	block_.indexSelection = _indexSelection;
+
+	float error = 0.0f;
+	if (mode.index2Bits)
+	{
+	 // separate color/alpha, alpha is swapped with a color channel by the rotation
+		float points[16][4];
+		for (int i = 0; i < 16; ++i)
+		{
+			memcpy(points[i], _points[i], sizeof(points[i]));
+			if (_rotation)
+			{
+				eastl::swap(points[i][3], points[i][_rotation - 1]);
+			}
+		}
+		const int colorIndexBits = _indexSelection ? mode.index2Bits : mode.indexBits;
+		const int alphaIndexBits = _indexSelection ? mode.indexBits : mode.index2Bits;
+		static const int kPixels[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+		BC7SubsetFit color, alpha;
+		BC7_FitSubset(points, kPixels, 16, 0, 3, mode, mode.colorBits, colorIndexBits, _iterationCount, color);
+		BC7_FitSubset(points, kPixels, 16, 3, 1, mode, mode.alphaBits, alphaIndexBits, _iterationCount, alpha);
+		BC7_FixAnchor(color, 0, 0, 3, colorIndexBits, false);
+		BC7_FixAnchor(alpha, 0, 0, 1, alphaIndexBits, false);
+		for (int e = 0; e < 2; ++e)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				block_.endpoints[0][e][c] = color.endpoints[e][c];
+			}
+			block_.endpoints[0][e][3] = alpha.endpoints[e][0];
+		}
+		memcpy(_indexSelection ? block_.indices2 : block_.indices, color.indices, 16);
+		memcpy(_indexSelection ? block_.indices : block_.indices2, alpha.indices, 16);
+		error = color.error + alpha.error;
+	}
+	else
+	{
+		const int dim = mode.alphaBits ? 4 : 3;
+		const Subsets subsets(mode.subsetCount, _partition);
+		for (int s = 0; s < mode.subsetCount; ++s)
+		{
+			const int* pixels = subsets.m_pixels[s];
+			const int count = subsets.m_counts[s];
+			BC7SubsetFit fit;
+			BC7_FitSubset(_points, pixels, count, 0, dim, mode, mode.colorBits, mode.indexBits, _iterationCount, fit);
+
+		 // anchor is the first pixel of the subset in the subset's pixel list for subset 0, else the anchor table entry
+			int anchor = 0;
+			if (s > 0)
+			{
+				const int anchorPixel = mode.subsetCount == 2 ? kAnchors2[_partition] : kAnchors3[s - 1][_partition];
+				while (pixels[anchor] != anchorPixel)
+				{
+					++anchor;
+				}
+			}
+			BC7_FixAnchor(fit, anchor, 0, dim, mode.indexBits, mode.endpointPBits != 0);
+
+			for (int e = 0; e < 2; ++e)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					block_.endpoints[s][e][c] = fit.endpoints[e][c];
+				}
+				block_.pbits[s][e] = fit.pbits[e];
+			}
+			for (int i = 0; i < count; ++i)
+			{
+				block_.indices[pixels[i]] = fit.indices[i];
+			}
+			error += fit.error;
+		}
+
+	 // modes without alpha decode alpha as 255
+		if (!mode.alphaBits)
+		{
+			for (int i = 0; i < 16; ++i)
+			{
+				const float d = 255.0f - _points[i][3];
+				error += d * d;
+			}
+		}
+	}
+	return error;
+}
+
+void BC7_Encode(const float (*_points)[4], Image::CompressionQuality _quality, uint8* dst_)
+{
+	bool isOpaque = true;
+	for (int i = 0; i < 16; ++i)
+	{
+		isOpaque &= _points[i][3] == 255.0f;
+	}
+
+	const int iterationCount = _quality == Image::CompressionQuality_Fast ? 1 : (_quality == Image::CompressionQuality_High ? 4 : 2);
+	const int partitionCount = _quality == Image::CompressionQuality_Fast ? 1 : (_quality == Image::CompressionQuality_High ? 8 : 2);
+	static const float kChannelWeights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	BC7Block best;
+	float bestError = FLT_MAX;
+	auto TryMode = [&](int _mode, int _partition, int _rotation, int _indexSelection)
+		{
+			BC7Block block;
+			const float error = BC7_EncodeMode(_points, _mode, _partition, _rotation, _indexSelection, iterationCount, block);
+			if (error < bestError)
+			{
+				bestError = error;
+				best = block;
+			}
+		};
+
+	TryMode(6, 0, 0, 0);
+	if (_quality != Image::CompressionQuality_Fast)
+	{
+		TryMode(5, 0, 0, 0);
+		if (_quality == Image::CompressionQuality_High)
+		{
+			for (int rotation = 0; rotation < 4; ++rotation)
+			{
+				TryMode(5, 0, rotation, 0);
+				TryMode(4, 0, rotation, 0);
+				TryMode(4, 0, rotation, 1);
+			}
+		}
+	}
+
+ // partitioned modes, estimate the best partitions then encode
+	const int dim = isOpaque ? 3 : 4;
+	const int kModes[]         = { 1, 3, 7, 0, 2 };
+	const int kMinQuality[]    = { Image::CompressionQuality_Fast, Image::CompressionQuality_Default, Image::CompressionQuality_Default, Image::CompressionQuality_High, Image::CompressionQuality_High };
+	for (int m = 0; m < 5 && bestError > 0.0f; ++m)
+	{
+		const BC7ModeInfo& mode = kBC7Modes[kModes[m]];
+		if (_quality < kMinQuality[m] || (kModes[m] == 7 && isOpaque) || (kModes[m] != 7 && !isOpaque && _quality != Image::CompressionQuality_High))
+		{
+			continue;
+		}
+		int partitions[64];
+		const int count = SelectPartitions(_points, mode.subsetCount, 1 << mode.partitionBits, dim, mode.indexBits, kChannelWeights, partitionCount, partitions);
+		for (int p = 0; p < count; ++p)
+		{
+			TryMode(kModes[m], partitions[p], 0, 0);
+		}
+	}
+
+	BC7_Pack(best, dst_);
+}
+
+/*	BC6H */
+
+enum BC6Field
+{
+	BC6_M, BC6_D,
+	BC6_RW, BC6_GW, BC6_BW,
+	BC6_RX, BC6_GX, BC6_BX,
+	BC6_RY, BC6_GY, BC6_BY,
+	BC6_RZ, BC6_GZ, BC6_BZ
+};
+
+// Bits are read starting at 'first' and moving toward 'last', e.g. rw[9:0] is { RW, 0, 9 }, rw[10:15] (reversed) is { RW, 15, 10 }.
+struct BC6Segment
+{
+	uint8 field;
+	uint8 first;
+	uint8 last;
+};
+
+struct BC6ModeInfo
+{
+	int              modeBits;
+	int              regionCount;
+	bool             isTransformed;
+	int              endpointBits;
+	int              deltaBits[3];
+	const BC6Segment* layout;
+	int              layoutCount;
+};
+
+#define BC6_SEG(_field, _last, _first) { BC6_##_field, _first, _last }
+const BC6Segment kBC6Layout1[] =
+{
+	BC6_SEG(M,1,0), BC6_SEG(GY,4,4), BC6_SEG(BY,4,4), BC6_SEG(BZ,4,4), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,4,0),
+	BC6_SEG(GZ,4,4), BC6_SEG(GY,3,0), BC6_SEG(GX,4,0), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,4,0), BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0),
+	BC6_SEG(RY,4,0), BC6_SEG(BZ,2,2), BC6_SEG(RZ,4,0), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout2[] =
+{
+	BC6_SEG(M,1,0), BC6_SEG(GY,5,5), BC6_SEG(GZ,4,4), BC6_SEG(GZ,5,5), BC6_SEG(RW,6,0), BC6_SEG(BZ,0,0), BC6_SEG(BZ,1,1), BC6_SEG(BY,4,4),
+	BC6_SEG(GW,6,0), BC6_SEG(BY,5,5), BC6_SEG(BZ,2,2), BC6_SEG(GY,4,4), BC6_SEG(BW,6,0), BC6_SEG(BZ,3,3), BC6_SEG(BZ,5,5), BC6_SEG(BZ,4,4),
+	BC6_SEG(RX,5,0), BC6_SEG(GY,3,0), BC6_SEG(GX,5,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,5,0), BC6_SEG(BY,3,0), BC6_SEG(RY,5,0), BC6_SEG(RZ,5,0),
+	BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout3[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,4,0), BC6_SEG(RW,10,10), BC6_SEG(GY,3,0), BC6_SEG(GX,3,0),
+	BC6_SEG(GW,10,10), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,3,0), BC6_SEG(BW,10,10), BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0), BC6_SEG(RY,4,0),
+	BC6_SEG(BZ,2,2), BC6_SEG(RZ,4,0), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout4[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,3,0), BC6_SEG(RW,10,10), BC6_SEG(GZ,4,4), BC6_SEG(GY,3,0),
+	BC6_SEG(GX,4,0), BC6_SEG(GW,10,10), BC6_SEG(GZ,3,0), BC6_SEG(BX,3,0), BC6_SEG(BW,10,10), BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0), BC6_SEG(RY,3,0),
+	BC6_SEG(BZ,0,0), BC6_SEG(BZ,2,2), BC6_SEG(RZ,3,0), BC6_SEG(GY,4,4), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout5[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,3,0), BC6_SEG(RW,10,10), BC6_SEG(BY,4,4), BC6_SEG(GY,3,0),
+	BC6_SEG(GX,3,0), BC6_SEG(GW,10,10), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,4,0), BC6_SEG(BW,10,10), BC6_SEG(BY,3,0), BC6_SEG(RY,3,0),
+	BC6_SEG(BZ,1,1), BC6_SEG(BZ,2,2), BC6_SEG(RZ,3,0), BC6_SEG(BZ,4,4), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout6[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,8,0), BC6_SEG(BY,4,4), BC6_SEG(GW,8,0), BC6_SEG(GY,4,4), BC6_SEG(BW,8,0), BC6_SEG(BZ,4,4), BC6_SEG(RX,4,0),
+	BC6_SEG(GZ,4,4), BC6_SEG(GY,3,0), BC6_SEG(GX,4,0), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,4,0), BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0),
+	BC6_SEG(RY,4,0), BC6_SEG(BZ,2,2), BC6_SEG(RZ,4,0), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout7[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,7,0), BC6_SEG(GZ,4,4), BC6_SEG(BY,4,4), BC6_SEG(GW,7,0), BC6_SEG(BZ,2,2), BC6_SEG(GY,4,4), BC6_SEG(BW,7,0),
+	BC6_SEG(BZ,3,3), BC6_SEG(BZ,4,4), BC6_SEG(RX,5,0), BC6_SEG(GY,3,0), BC6_SEG(GX,4,0), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,4,0),
+	BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0), BC6_SEG(RY,5,0), BC6_SEG(RZ,5,0), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout8[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,7,0), BC6_SEG(BZ,0,0), BC6_SEG(BY,4,4), BC6_SEG(GW,7,0), BC6_SEG(GY,5,5), BC6_SEG(GY,4,4), BC6_SEG(BW,7,0),
+	BC6_SEG(GZ,5,5), BC6_SEG(BZ,4,4), BC6_SEG(RX,4,0), BC6_SEG(GZ,4,4), BC6_SEG(GY,3,0), BC6_SEG(GX,5,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,4,0),
+	BC6_SEG(BZ,1,1), BC6_SEG(BY,3,0), BC6_SEG(RY,4,0), BC6_SEG(BZ,2,2), BC6_SEG(RZ,4,0), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout9[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,7,0), BC6_SEG(BZ,1,1), BC6_SEG(BY,4,4), BC6_SEG(GW,7,0), BC6_SEG(BY,5,5), BC6_SEG(GY,4,4), BC6_SEG(BW,7,0),
+	BC6_SEG(BZ,5,5), BC6_SEG(BZ,4,4), BC6_SEG(RX,4,0), BC6_SEG(GZ,4,4), BC6_SEG(GY,3,0), BC6_SEG(GX,4,0), BC6_SEG(BZ,0,0), BC6_SEG(GZ,3,0),
+	BC6_SEG(BX,5,0), BC6_SEG(BY,3,0), BC6_SEG(RY,4,0), BC6_SEG(BZ,2,2), BC6_SEG(RZ,4,0), BC6_SEG(BZ,3,3), BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout10[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,5,0), BC6_SEG(GZ,4,4), BC6_SEG(BZ,0,0), BC6_SEG(BZ,1,1), BC6_SEG(BY,4,4), BC6_SEG(GW,5,0), BC6_SEG(GY,5,5),
+	BC6_SEG(BY,5,5), BC6_SEG(BZ,2,2), BC6_SEG(GY,4,4), BC6_SEG(BW,5,0), BC6_SEG(GZ,5,5), BC6_SEG(BZ,3,3), BC6_SEG(BZ,5,5), BC6_SEG(BZ,4,4),
+	BC6_SEG(RX,5,0), BC6_SEG(GY,3,0), BC6_SEG(GX,5,0), BC6_SEG(GZ,3,0), BC6_SEG(BX,5,0), BC6_SEG(BY,3,0), BC6_SEG(RY,5,0), BC6_SEG(RZ,5,0),
+	BC6_SEG(D,4,0)
+};
+const BC6Segment kBC6Layout11[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,9,0), BC6_SEG(GX,9,0), BC6_SEG(BX,9,0)
+};
+const BC6Segment kBC6Layout12[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,8,0), BC6_SEG(RW,10,10), BC6_SEG(GX,8,0), BC6_SEG(GW,10,10),
+	BC6_SEG(BX,8,0), BC6_SEG(BW,10,10)
+};
+const BC6Segment kBC6Layout13[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,7,0), BC6_SEG(RW,10,11), BC6_SEG(GX,7,0), BC6_SEG(GW,10,11),
+	BC6_SEG(BX,7,0), BC6_SEG(BW,10,11)
+};
+const BC6Segment kBC6Layout14[] =
+{
+	BC6_SEG(M,4,0), BC6_SEG(RW,9,0), BC6_SEG(GW,9,0), BC6_SEG(BW,9,0), BC6_SEG(RX,3,0), BC6_SEG(RW,10,15), BC6_SEG(GX,3,0), BC6_SEG(GW,10,15),
+	BC6_SEG(BX,3,0), BC6_SEG(BW,10,15)
+};
+#undef BC6_SEG
+
+#define BC6_LAYOUT(_layout) _layout, (int)(sizeof(_layout) / sizeof(BC6Segment))
+const BC6ModeInfo kBC6Modes[14] =
+{
+	{  0, 2, true,  10, {  5,  5,  5 }, BC6_LAYOUT(kBC6Layout1)  },
+	{  1, 2, true,   7, {  6,  6,  6 }, BC6_LAYOUT(kBC6Layout2)  },
+	{  2, 2, true,  11, {  5,  4,  4 }, BC6_LAYOUT(kBC6Layout3)  },
+	{  6, 2, true,  11, {  4,  5,  4 }, BC6_LAYOUT(kBC6Layout4)  },
+	{ 10, 2, true,  11, {  4,  4,  5 }, BC6_LAYOUT(kBC6Layout5)  },
+	{ 14, 2, true,   9, {  5,  5,  5 }, BC6_LAYOUT(kBC6Layout6)  },
+	{ 18, 2, true,   8, {  6,  5,  5 }, BC6_LAYOUT(kBC6Layout7)  },
+	{ 22, 2, true,   8, {  5,  6,  5 }, BC6_LAYOUT(kBC6Layout8)  },
+	{ 26, 2, true,   8, {  5,  5,  6 }, BC6_LAYOUT(kBC6Layout9)  },
+	{ 30, 2, false,  6, {  6,  6,  6 }, BC6_LAYOUT(kBC6Layout10) },
+	{  3, 1, false, 10, { 10, 10, 10 }, BC6_LAYOUT(kBC6Layout11) },
+	{  7, 1, true,  11, {  9,  9,  9 }, BC6_LAYOUT(kBC6Layout12) },
+	{ 11, 1, true,  12, {  8,  8,  8 }, BC6_LAYOUT(kBC6Layout13) },
+	{ 15, 1, true,  16, {  4,  4,  4 }, BC6_LAYOUT(kBC6Layout14) },
+};
+#undef BC6_LAYOUT
+
+struct BC6Block
+{
+	int   mode        = -1;      // Index into kBC6Modes.
+	int   partition   = 0;
+	int   endpoints[2][2][3] = {}; // [region][endpoint][channel], quantized absolute values (after the inverse transform).
+	uint8 indices[16] = {};
+};
+
+// Field values (endpoints as stored, i.e. deltas for transformed modes).
+struct BC6Fields
+{
+	int values[14];
+};
+
+int BC6_FieldBits(const BC6ModeInfo& _mode, int _field)
+{
+	if (_field >= BC6_RW && _field <= BC6_BW)
+	{
+		return _mode.endpointBits;
+	}
+	const int channel = (_field - BC6_RW) % 3;
+	return _mode.deltaBits[channel];
+}
+
+int SignExtend(int _value, int _bits)
+{
+	const int shift = 32 - _bits;
+	return (int)((uint32)_value << shift) >> shift;
+}
+
+int BC6_Unquantize(int _value, int _bits)
+{
+	if (_bits >= 15 || _value == 0)
+	{
+		return _value;
+	}
+	if (_value == (1 << _bits) - 1)
+	{
+		return 0xffff;
+	}
+	return ((_value << 16) + 0x8000) >> _bits;
+}
+
+// Return false for reserved modes.
+bool BC6_Unpack(const uint8* _src, BC6Block& block_)
+{
+	int modeBits = _src[0] & 3;
+	if (modeBits > 1)
+	{
+		modeBits = _src[0] & 31;
+	}
+	int modeIndex = 0;
+	while (modeIndex < 14 && kBC6Modes[modeIndex].modeBits != modeBits)
+	{
+		++modeIndex;
+	}
+	if (modeIndex == 14)
+	{
+		return false;
+	}
+	block_.mode = modeIndex;
+	const BC6ModeInfo& mode = kBC6Modes[modeIndex];
+
+	int fields[14] = {};
+	BitReader bits(_src);
+	for (int i = 0; i < mode.layoutCount; ++i)
+	{
+		const BC6Segment& segment = mode.layout[i];
+		const int step = segment.last >= segment.first ? 1 : -1;
+		for (int bit = segment.first; ; bit += step)
+		{
+			fields[segment.field] |= (int)bits.read(1) << bit;
+			if (bit == segment.last)
+			{
+				break;
+			}
+		}
+	}
+	block_.partition = fields[BC6_D];
+
+	const int mask = (1 << mode.endpointBits) - 1;
+	for (int c = 0; c < 3; ++c)
+	{
+		const int w = fields[BC6_RW + c];
+		block_.endpoints[0][0][c] = w;
+		for (int e = 1; e < mode.regionCount * 2; ++e)
+		{
+			int v = fields[BC6_RW + e * 3 + c];
+			if (mode.isTransformed)
+			{
+				v = (w + SignExtend(v, mode.deltaBits[c])) & mask;
+			}
+			block_.endpoints[e / 2][e % 2][c] = v;
+		}
+	}
+
+	const int indexBits = mode.regionCount == 2 ? 3 : 4;
+	for (int i = 0; i < 16; ++i)
+	{
+		const bool isAnchor = i == 0 || (mode.regionCount == 2 && i == kAnchors2[block_.partition]);
+		block_.indices[i] = (uint8)bits.read(indexBits - (isAnchor ? 1 : 0));
+	}
+	return true;
+}
+
+// Return false if the endpoints can't be represented by the mode (deltas out of range).
+bool BC6_Pack(const BC6Block& _block, uint8* dst_)
+{
+	const BC6ModeInfo& mode = kBC6Modes[_block.mode];
+	int fields[14] = {};
+	fields[BC6_M] = mode.modeBits;
+	fields[BC6_D] = _block.partition;
+	const int mask = (1 << mode.endpointBits) - 1;
+	for (int c = 0; c < 3; ++c)
+	{
+		const int w = _block.endpoints[0][0][c];
+		fields[BC6_RW + c] = w;
+		for (int e = 1; e < mode.regionCount * 2; ++e)
+		{
+			int v = _block.endpoints[e / 2][e % 2][c];
+			if (mode.isTransformed)
+			{
+				const int bits = mode.deltaBits[c];
+				const int delta = SignExtend((v - w) & mask, mode.endpointBits); // deltas wrap at endpointBits
+				if (delta < -(1 << (bits - 1)) || delta >= (1 << (bits - 1)))
+				{
+					return false;
+				}
+				v = delta & ((1 << bits) - 1);
+			}
+			fields[BC6_RW + e * 3 + c] = v;
+		}
+	}
+
+	BitWriter bits(dst_, 16);
+	for (int i = 0; i < mode.layoutCount; ++i)
+	{
+		const BC6Segment& segment = mode.layout[i];
+		const int step = segment.last >= segment.first ? 1 : -1;
+		for (int bit = segment.first; ; bit += step)
+		{
+			bits.write((uint32)(fields[segment.field] >> bit) & 1, 1);
+			if (bit == segment.last)
+			{
+				break;
+			}
+		}
+	}
+	const int indexBits = mode.regionCount == 2 ? 3 : 4;
+	for (int i = 0; i < 16; ++i)
+	{
+		const bool isAnchor = i == 0 || (mode.regionCount == 2 && i == kAnchors2[_block.partition]);
+		bits.write(_block.indices[i], indexBits - (isAnchor ? 1 : 0));
+	}
+	FRM_ASSERT(bits.m_offset == 128);
+	return true;
+}
+
+// Output is half float bits.
+void BC6_Decode(const uint8* _src, uint16 (*rgb_)[3])
+{
+	BC6Block block;
+	if (!BC6_Unpack(_src, block))
+	{
+		memset(rgb_, 0, 16 * 3 * sizeof(uint16));
+		return;
+	}
+	const BC6ModeInfo& mode = kBC6Modes[block.mode];
+	const int* weights = GetWeights(mode.regionCount == 2 ? 3 : 4);
+	for (int i = 0; i < 16; ++i)
+	{
+		const int region = mode.regionCount == 2 ? GetSubset(2, block.partition, i) : 0;
+		for (int c = 0; c < 3; ++c)
+		{
+			const int a = BC6_Unquantize(block.endpoints[region][0][c], mode.endpointBits);
+			const int b = BC6_Unquantize(block.endpoints[region][1][c], mode.endpointBits);
+			rgb_[i][c] = (uint16)((Interpolate(a, b, weights[block.indices[i]]) * 31) >> 6);
+		}
+	}
+}
+
+// Quantize v (unquantized 16 bit domain) to _bits.
+int BC6_Quantize(float _v, int _bits)
+{
+	const int maxValue = (1 << _bits) - 1;
+	if (_bits >= 15)
+	{
+		return FRM_CLAMP((int)(_v + 0.5f), 0, maxValue);
+	}
+	int q = FRM_CLAMP((int)((_v * (float)(1 << _bits) - 32768.0f) / 65536.0f + 0.5f), 0, maxValue);
+	int best = q;
+	float bestError = FLT_MAX;
+	for (int candidate = FRM_MAX(q - 1, 0); candidate <= FRM_MIN(q + 1, maxValue); ++candidate)
+	{
+		const float error = fabsf((float)BC6_Unquantize(candidate, _bits) - _v);
+		if (error < bestError)
+		{
+			bestError = error;
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+// Assign indices for quantized endpoints, return the error (in half float bits).
+float BC6_EvaluateRegion(const float (*_halfs)[4], const int* _pixels, int _count, const int (*_ep)[3], int _endpointBits, int _indexBits, uint8* indices_)
+{
+	const int* weights = GetWeights(_indexBits);
+	const int levelCount = 1 << _indexBits;
+	int palette[16][3];
+	for (int c = 0; c < 3; ++c)
+	{
+		const int a = BC6_Unquantize(_ep[0][c], _endpointBits);
+		const int b = BC6_Unquantize(_ep[1][c], _endpointBits);
+		for (int j = 0; j < levelCount; ++j)
+		{
+			palette[j][c] = (Interpolate(a, b, weights[j]) * 31) >> 6;
+		}
+	}
+	float ret = 0.0f;
+	for (int i = 0; i < _count; ++i)
+	{
+		const float* p = _halfs[_pixels[i]];
+		float bestError = FLT_MAX;
+		for (int j = 0; j < levelCount; ++j)
+		{
+			float error = 0.0f;
+			for (int c = 0; c < 3; ++c)
+			{
+				const float d = (float)palette[j][c] - p[c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				indices_[i] = (uint8)j;
+			}
+		}
+		ret += bestError;
+	}
+	return ret;
+}
+
+// Fit one region, _points are in the unquantized domain (half * 64/31).
+float BC6_FitRegion(const float (*_points)[4], const float (*_halfs)[4], const int* _pixels, int _count, int _endpointBits, int _indexBits, int _iterationCount, int (*ep_)[3], uint8* indices_)
+{
+	float ep[2][4];
+	AxisEndpoints(_points, _pixels, _count, 0, 3, ep);
+	auto Quantize = [&]()
+		{
+			for (int e = 0; e < 2; ++e)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					ep_[e][c] = BC6_Quantize(FRM_CLAMP(ep[e][c], 0.0f, 65535.0f), _endpointBits);
+				}
+			}
+		};
+	Quantize();
+	float error = BC6_EvaluateRegion(_halfs, _pixels, _count, ep_, _endpointBits, _indexBits, indices_);
+
+	const int* weights = GetWeights(_indexBits);
+	for (int iteration = 0; iteration < _iterationCount && error > 0.0f; ++iteration)
+	{
+		float w[16];
+		for (int i = 0; i < _count; ++i)
+		{
+			w[i] = (float)weights[indices_[i]] / 64.0f;
+		}
+		int prevEp[2][3];
+		memcpy(prevEp, ep_, sizeof(prevEp));
+		if (!LeastSquaresEndpoints(_points, _pixels, w, _count, 0, 3, ep))
+		{
+			break;
+		}
+		Quantize();
+		uint8 indices[16];
+		const float newError = BC6_EvaluateRegion(_halfs, _pixels, _count, ep_, _endpointBits, _indexBits, indices);
+		if (newError >= error)
+		{
+			memcpy(ep_, prevEp, sizeof(prevEp));
+			break;
+		}
+		error = newError;
+		memcpy(indices_, indices, _count);
+	}
+	return error;
+}
+
+// Encode with _mode/_partition, return the error or FLT_MAX if the endpoints can't be represented.
+float BC6_EncodeMode(const float (*_points)[4], const float (*_halfs)[4], int _modeIndex, int _partition, int _iterationCount, BC6Block& block_, uint8* dst_)
+{
+	const BC6ModeInfo& mode = kBC6Modes[_modeIndex];
+	block_.mode = _modeIndex;
+	block_.partition = _partition;
+	const int indexBits = mode.regionCount == 2 ? 3 : 4;
+	const int maxIndex = (1 << indexBits) - 1;
+	const Subsets regions(mode.regionCount, _partition);
+	float error = 0.0f;
+	for (int r = 0; r < mode.regionCount; ++r)
+	{
+		const int* pixels = regions.m_pixels[r];
+		const int count = regions.m_counts[r];
+		uint8 indices[16];
+		error += BC6_FitRegion(_points, _halfs, pixels, count, mode.endpointBits, indexBits, _iterationCount, block_.endpoints[r], indices);
+
+	 // anchor MSB must be 0
+		const int anchorPixel = r == 0 ? 0 : kAnchors2[_partition];
+		int anchor = 0;
+		while (pixels[anchor] != anchorPixel)
+		{
+			++anchor;
+		}
+		if (indices[anchor] > (maxIndex >> 1))
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				eastl::swap(block_.endpoints[r][0][c], block_.endpoints[r][1][c]);
+			}
+			for (int i = 0; i < count; ++i)
+			{
+				indices[i] = (uint8)(maxIndex - indices[i]);
+			}
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			block_.indices[pixels[i]] = indices[i];
+		}
+	}
+	return BC6_Pack(block_, dst_) ? error : FLT_MAX;
+}
+
+void BC6_Encode(const float (*_rgb)[4], Image::CompressionQuality _quality, uint8* dst_)
+{
+ // work in the half float bit domain, which is approximately logarithmic
+	float halfs[16][4];
+	float points[16][4];
+	for (int i = 0; i < 16; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			const float v = FRM_CLAMP(_rgb[i][c], 0.0f, 65504.0f); // unsigned, negative values and NaN clamp to 0
+			halfs[i][c] = (float)PackFloat16(v == v ? v : 0.0f);
+			points[i][c] = halfs[i][c] * (64.0f / 31.0f);
+		}
+		halfs[i][3] = points[i][3] = 0.0f;
+	}
+
+	const int iterationCount = _quality == Image::CompressionQuality_Fast ? 1 : (_quality == Image::CompressionQuality_High ? 4 : 2);
+	uint8 block[16];
+	float bestError = FLT_MAX;
+	auto TryMode = [&](int _mode, int _partition)
+		{
+			BC6Block bc6;
+			const float error = BC6_EncodeMode(points, halfs, _mode, _partition, iterationCount, bc6, block);
+			if (error < bestError)
+			{
+				bestError = error;
+				memcpy(dst_, block, 16);
+			}
+		};
+
+ // 1 region, mode 11 (10 bit absolute) always fits
+	TryMode(10, 0);
+	if (_quality != Image::CompressionQuality_Fast)
+	{
+		for (int mode = 11; mode < 14 && bestError > 0.0f; ++mode)
+		{
+			TryMode(mode, 0);
+		}
+
+	 // 2 regions, mode 10 (6 bit absolute) always fits
+		static const float kChannelWeights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		int partitions[32];
+		const int partitionCount = SelectPartitions(halfs, 2, 32, 3, 3, kChannelWeights, _quality == Image::CompressionQuality_High ? 8 : 2, partitions);
+		for (int p = 0; p < partitionCount && bestError > 0.0f; ++p)
+		{
+			for (int mode = 0; mode < 10; ++mode)
+			{
+				TryMode(mode, partitions[p]);
+			}
+		}
+	}
+}
+
+/******************************************************************************
+
+                                  Image
+
+******************************************************************************/
+
+int GetBlockSizeBytes(Image::CompressionType _compression)
+{
+	return (_compression == Image::Compression_BC1 || _compression == Image::Compression_BC4) ? 8 : 16;
+}
+
+} // namespace
+
+// PUBLIC
+
+Image* Image::CreateCompressed(const Image& _img, CompressionType _compression, CompressionQuality _quality)
+{
+	FRM_ASSERT(_img.m_data);
+	if (_img.isCompressed())
+	{
+		FRM_LOG_ERR("Image::CreateCompressed: Source image is already compressed");
+		return nullptr;
+	}
+	if (_compression == Compression_None || _compression >= Compression_Invalid)
+	{
+		FRM_LOG_ERR("Image::CreateCompressed: Invalid compression type");
+		return nullptr;
+	}
+
+	const uint srcComponentCount = GetComponentCount(_img.m_layout);
+	Layout layout = Layout_RGBA;
+	switch (_compression)
+	{
+		case Compression_BC1: layout = srcComponentCount == 4 ? Layout_RGBA : Layout_RGB; break;
+		case Compression_BC4: layout = Layout_R;  break;
+		case Compression_BC5: layout = Layout_RG; break;
+		case Compression_BC6: layout = Layout_RGB; break;
+		default:              break;
+	};
+
+	Image* ret = FRM_NEW(Image);
+	FRM_ASSERT(ret);
+	ret->init();
+	ret->m_type        = _img.m_type;
+	ret->m_width       = _img.m_width;
+	ret->m_height      = _img.m_height;
+	ret->m_depth       = _img.m_depth;
+	ret->m_layout      = layout;
+	ret->m_dataType    = _compression == Compression_BC6 ? DataType_Float16 : DataType_Uint8N;
+	ret->m_mipmapCount = _img.m_mipmapCount;
+	ret->m_arrayCount  = _img.m_arrayCount;
+	ret->m_compression = _compression;
+	ret->alloc();
+
+	const bool isFloat = _compression == Compression_BC6;
+	const int  blockSizeBytes = GetBlockSizeBytes(_compression);
+	const uint imageCount = _img.isCubemap() ? _img.m_arrayCount * 6 : _img.m_arrayCount;
+	eastl::vector<char> texels;
+	for (uint image = 0; image < imageCount; ++image)
+	{
+		for (uint mip = 0; mip < _img.m_mipmapCount; ++mip)
+		{
+			const uvec3 size = _img.getMipDimensions(mip);
+			const uint texelCount = size.x * size.y * size.z;
+
+		 // convert to RGBA (Float32 for BC6, Uint8N otherwise), missing components are 0, alpha is 1
+			texels.resize(texelCount * 4 * (isFloat ? sizeof(float) : sizeof(uint8)));
+			DataTypeConvert(_img.m_dataType, (int)srcComponentCount, isFloat ? DataType_Float32 : DataType_Uint8N, 4, _img.getRawImage(image, mip), texels.data(), texelCount);
+
+			const uint blockCountX = (size.x + 3) / 4;
+			const uint blockCountY = (size.y + 3) / 4;
+			char* dst = ret->getRawImage(image, mip);
+			JobSystem::ParallelFor((uint32)(blockCountY * size.z), kBlockRowChunkSize, [&](uint32 _begin, uint32 _end)
+				{
+					for (uint32 row = _begin; row < _end; ++row)
+					{
+						const uint z  = row / blockCountY;
+						const uint by = row % blockCountY;
+						for (uint bx = 0; bx < blockCountX; ++bx)
+						{
+						 // gather, clamp partial blocks
+							float points[16][4];
+							for (int i = 0; i < 16; ++i)
+							{
+								const uint x = FRM_MIN(bx * 4 + (i & 3), (uint)size.x - 1);
+								const uint y = FRM_MIN(by * 4 + (i >> 2), (uint)size.y - 1);
+								const uint offset = ((z * size.y + y) * size.x + x) * 4;
+								for (int c = 0; c < 4; ++c)
+								{
+									points[i][c] = isFloat ? ((const float*)texels.data())[offset + c] : (float)((const uint8*)texels.data())[offset + c];
+								}
+							}
+
+							uint8* block = (uint8*)dst + (row * blockCountX + bx) * blockSizeBytes;
+							switch (_compression)
+							{
+								case Compression_BC1:
+									BC1_EncodeColor(points, false, layout == Layout_RGBA, _quality, block);
+									break;
+								case Compression_BC2:
+									BC2_EncodeAlpha(points, block);
+									BC1_EncodeColor(points, true, false, _quality, block + 8);
+									break;
+								case Compression_BC3:
+									BC4_Encode(points, 3, _quality, block);
+									BC1_EncodeColor(points, true, false, _quality, block + 8);
+									break;
+								case Compression_BC4:
+									BC4_Encode(points, 0, _quality, block);
+									break;
+								case Compression_BC5:
+									BC4_Encode(points, 0, _quality, block);
+									BC4_Encode(points, 1, _quality, block + 8);
+									break;
+								case Compression_BC6:
+									BC6_Encode(points, _quality, block);
+									break;
+								case Compression_BC7:
+									BC7_Encode(points, _quality, block);
+									break;
+								default:
+									break;
+							};
+						}
+					}
+				});
+		}
+	}
+
+	return ret;
+}
+
+Image* Image::CreateDecompressed(const Image& _img)
+{
+	FRM_ASSERT(_img.m_data);
+	if (!_img.isCompressed())
+	{
+		FRM_LOG_ERR("Image::CreateDecompressed: Source image is not compressed");
+		return nullptr;
+	}
+
+	const CompressionType compression = _img.m_compression;
+	const bool isFloat = compression == Compression_BC6;
+	Image* ret = FRM_NEW(Image);
+	FRM_ASSERT(ret);
+	ret->init();
+	ret->m_type        = _img.m_type;
+	ret->m_width       = _img.m_width;
+	ret->m_height      = _img.m_height;
+	ret->m_depth       = _img.m_depth;
+	ret->m_layout      = _img.m_layout;
+	ret->m_dataType    = isFloat ? DataType_Float16 : DataType_Uint8N;
+	ret->m_mipmapCount = _img.m_mipmapCount;
+	ret->m_arrayCount  = _img.m_arrayCount;
+	ret->alloc();
+
+	const uint componentCount = GetComponentCount(ret->m_layout);
+	const int  blockSizeBytes = GetBlockSizeBytes(compression);
+	const uint imageCount = _img.isCubemap() ? _img.m_arrayCount * 6 : _img.m_arrayCount;
+	for (uint image = 0; image < imageCount; ++image)
+	{
+		for (uint mip = 0; mip < _img.m_mipmapCount; ++mip)
+		{
+			const uvec3 size = _img.getMipDimensions(mip);
+			const uint blockCountX = (size.x + 3) / 4;
+			const uint blockCountY = (size.y + 3) / 4;
+			const uint8* src = (const uint8*)_img.getRawImage(image, mip);
+			char* dst = ret->getRawImage(image, mip);
+			JobSystem::ParallelFor((uint32)(blockCountY * size.z), kBlockRowChunkSize, [&](uint32 _begin, uint32 _end)
+				{
+					for (uint32 row = _begin; row < _end; ++row)
+					{
+						const uint z  = row / blockCountY;
+						const uint by = row % blockCountY;
+						for (uint bx = 0; bx < blockCountX; ++bx)
+						{
+							const uint8* block = src + (row * blockCountX + bx) * blockSizeBytes;
+							uint8  rgba[16][4] = {};
+							uint16 rgb16[16][3];
+							switch (compression)
+							{
+								case Compression_BC1:
+									BC1_DecodeColor(block, false, rgba);
+									break;
+								case Compression_BC2:
+									BC1_DecodeColor(block + 8, true, rgba);
+									BC2_DecodeAlpha(block, rgba);
+									break;
+								case Compression_BC3:
+									BC1_DecodeColor(block + 8, true, rgba);
+									BC4_Decode(block, 3, rgba);
+									break;
+								case Compression_BC4:
+									BC4_Decode(block, 0, rgba);
+									break;
+								case Compression_BC5:
+									BC4_Decode(block, 0, rgba);
+									BC4_Decode(block + 8, 1, rgba);
+									break;
+								case Compression_BC6:
+									BC6_Decode(block, rgb16);
+									break;
+								case Compression_BC7:
+									BC7_Decode(block, rgba);
+									break;
+								default:
+									break;
+							};
+
+						 // scatter, discard texels outside the image
+							for (int i = 0; i < 16; ++i)
+							{
+								const uint x = bx * 4 + (i & 3);
+								const uint y = by * 4 + (i >> 2);
+								if (x >= size.x || y >= size.y)
+								{
+									continue;
+								}
+								const uint offset = ((z * size.y + y) * size.x + x) * componentCount;
+								for (uint c = 0; c < componentCount; ++c)
+								{
+									if (isFloat)
+									{
+										((uint16*)dst)[offset + c] = rgb16[i][c];
+									}
+									else
+									{
+										((uint8*)dst)[offset + c] = rgba[i][c];
+									}
+								}
+							}
+						}
+					}
+				});
+		}
+	}
+
+	return ret;
+}
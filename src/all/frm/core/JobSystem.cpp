@@ -0,0 +1,502 @@
+#include "JobSystem.h"
+
+#include <frm/core/Log.h>
+#include <frm/core/math.h>
+#include <frm/core/memory.h>
+
+#include <EASTL/fixed_vector.h>
+#include <EASTL/vector.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace frm {
+
+static constexpr int kSpinCount = 64; // Iterations to yield before a worker goes to sleep.
+
+static thread_local int s_threadIndex = -1;
+
+struct JobSystem::Impl
+{
+	struct Job
+	{
+		JobFunc*   func       = nullptr;
+		RangeFunc* rangeFunc  = nullptr;
+		void*      arg        = nullptr;
+		uint32     begin      = 0;
+		uint32     end        = 0;
+		Counter*   counter    = nullptr;
+		Counter*   dependency = nullptr;
+
+		std::atomic<bool> inFlight { false }; // Set by allocJob(), cleared by execute() when the slot may be reused.
+	};
+
+	// Chase-Lev work-stealing deque (fixed capacity). push()/pop() are only called by the owning thread, steal() may be called by any thread.
+	struct alignas(FRM_DCACHE_LINE_SIZE) Deque
+	{
+		std::atomic<sint64> top;
+		std::atomic<sint64> bottom;
+		std::atomic<Job*>  buffer[kMaxJobsPerThread];
+
+		Deque()
+		{
+			top.store(0);
+			bottom.store(0);
+		}
+
+		// Return false if the deque is full.
+		bool push(Job* _job)
+		{
+			const sint64 b = bottom.load(std::memory_order_relaxed);
+			if (b - top.load(std::memory_order_acquire) >= (sint64)kMaxJobsPerThread)
+			{
+				return false;
+			}
+			buffer[b & (kMaxJobsPerThread - 1)].store(_job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		Job* pop()
+		{
+			const sint64 b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			sint64 t = top.load(std::memory_order_relaxed);
+
+			if (t > b)
+			{
+				// Empty.
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* ret = buffer[b & (kMaxJobsPerThread - 1)].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				// Last job, race against steal().
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					ret = nullptr;
+				}
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return ret;
+		}
+
+		Job* steal()
+		{
+			sint64 t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const sint64 b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+			{
+				return nullptr;
+			}
+
+			Job* ret = buffer[t & (kMaxJobsPerThread - 1)].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+			return ret;
+		}
+	};
+
+	struct ThreadData
+	{
+		Deque  deque;
+		Job    jobs[kMaxJobsPerThread];
+		uint32 nextJob = 0;
+		uint32 rand    = 0;
+	};
+
+	int                        threadCount   = 1;
+	ThreadData*                threadData    = nullptr;
+	eastl::vector<std::thread> threads;
+	std::atomic<bool>          shutdown;
+	std::atomic<int>           queuedJobs;   // Jobs in any deque.
+	std::mutex                 sleepMutex;
+	std::condition_variable    sleepCondition;
+
+	eastl::vector<Job*>        waitingJobs;  // Jobs whose dependency wasn't satisfied when they were pushed.
+	std::atomic<int>           waitingCount;
+	std::mutex                 waitingMutex;
+
+	Impl(int _workerCount);
+	~Impl();
+
+	void submit(JobFunc* _func, RangeFunc* _rangeFunc, void* _arg, uint32 _begin, uint32 _end, Counter* _counter_, Counter* _dependency);
+	Job* allocJob();
+	bool pushJob(Job* _job);
+	void executeInline(Job* _job);
+	Job* getJob(int _threadIndex);
+	bool executeOne();
+	void execute(Job* _job);
+	void releaseWaitingJobs();
+
+	static void ThreadProc(Impl* _impl, int _threadIndex);
+};
+
+constexpr uint32 JobSystem::kMaxJobsPerThread;
+JobSystem::Impl* JobSystem::s_impl;
+
+// PUBLIC
+
+bool JobSystem::Init(int _workerCount)
+{
+	FRM_ASSERT(!s_impl);
+
+	if (_workerCount < 0)
+	{
+		_workerCount = Max((int)std::thread::hardware_concurrency() - 1, 0);
+	}
+	FRM_LOG("#JobSystem::Init(%d)", _workerCount);
+
+	s_threadIndex = 0;
+	s_impl = FRM_NEW(Impl(_workerCount));
+
+	return true;
+}
+
+void JobSystem::Shutdown()
+{
+	FRM_ASSERT(s_threadIndex == 0);
+	FRM_DELETE(s_impl);
+	s_impl = nullptr;
+}
+
+int JobSystem::GetThreadCount()
+{
+	return s_impl ? s_impl->threadCount : 1;
+}
+
+int JobSystem::GetThreadIndex()
+{
+	return s_threadIndex;
+}
+
+void JobSystem::Run(JobFunc* _func, void* _arg, Counter* _counter_, Counter* _dependency)
+{
+	if_unlikely (!s_impl)
+	{
+		FRM_ASSERT(!_dependency || _dependency->load() == 0); // Can't wait on a dependency without worker threads.
+		_func(_arg);
+		return;
+	}
+
+	s_impl->submit(_func, nullptr, _arg, 0, 0, _counter_, _dependency);
+}
+
+void JobSystem::RunRange(RangeFunc* _func, void* _arg, uint32 _begin, uint32 _end, Counter* _counter_, Counter* _dependency)
+{
+	if_unlikely (!s_impl)
+	{
+		FRM_ASSERT(!_dependency || _dependency->load() == 0);
+		_func(_arg, _begin, _end);
+		return;
+	}
+
+	s_impl->submit(nullptr, _func, _arg, _begin, _end, _counter_, _dependency);
+}
+
+void JobSystem::Wait(Counter* _counter)
+{
+	if_unlikely (!s_impl)
+	{
+		FRM_ASSERT(_counter->load() == 0);
+		return;
+	}
+
+	while (_counter->load(std::memory_order_acquire) != 0)
+	{
+		if (!s_impl->executeOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(uint32 _count, uint32 _chunkSize, RangeFunc* _func, void* _arg)
+{
+	if (_count == 0)
+	{
+		return;
+	}
+
+	// Threads which aren't part of the job system (e.g. FileSystemAsync workers) can't push jobs, run serially.
+	_chunkSize = Max(_chunkSize, 1u);
+	if (!s_impl || s_impl->threadCount == 1 || _count <= _chunkSize || s_threadIndex < 0)
+	{
+		_func(_arg, 0, _count);
+		return;
+	}
+
+	Counter counter(0);
+	for (uint32 begin = 0; begin < _count; begin += _chunkSize)
+	{
+		RunRange(_func, _arg, begin, Min(begin + _chunkSize, _count), &counter);
+	}
+	Wait(&counter);
+}
+
+// PRIVATE
+
+JobSystem::Impl::Impl(int _workerCount)
+{
+	threadCount = _workerCount + 1;
+	threadData  = FRM_NEW_ARRAY(ThreadData, threadCount);
+	for (int i = 0; i < threadCount; ++i)
+	{
+		threadData[i].rand = (uint32)i * 0x9e3779b9u + 1u;
+	}
+
+	shutdown.store(false);
+	queuedJobs.store(0);
+	waitingCount.store(0);
+
+	for (int i = 1; i < threadCount; ++i)
+	{
+		threads.push_back(std::thread(&ThreadProc, this, i));
+	}
+}
+
+JobSystem::Impl::~Impl()
+{
+	// Flush remaining jobs on the main thread.
+	while (queuedJobs.load() > 0 || waitingCount.load() > 0)
+	{
+		if (!executeOne())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	{	std::lock_guard<std::mutex> lock(sleepMutex);
+		shutdown.store(true);
+	}
+	sleepCondition.notify_all();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	threads.clear();
+
+	FRM_DELETE_ARRAY(threadData);
+}
+
+void JobSystem::Impl::submit(JobFunc* _func, RangeFunc* _rangeFunc, void* _arg, uint32 _begin, uint32 _end, Counter* _counter_, Counter* _dependency)
+{
+	Job  inlineJob;
+	Job* job = allocJob();
+	if (!job)
+	{
+		job = &inlineJob;
+	}
+	job->func       = _func;
+	job->rangeFunc  = _rangeFunc;
+	job->arg        = _arg;
+	job->begin      = _begin;
+	job->end        = _end;
+	job->counter    = _counter_;
+	job->dependency = _dependency;
+
+	if (_counter_)
+	{
+		_counter_->fetch_add(1);
+	}
+
+	if (job == &inlineJob || !pushJob(job))
+	{
+		executeInline(job);
+	}
+}
+
+JobSystem::Impl::Job* JobSystem::Impl::allocJob()
+{
+	FRM_ASSERT_MSG(s_threadIndex >= 0, "JobSystem: Jobs may only be pushed from the main thread or from within a job.");
+
+	ThreadData& data = threadData[s_threadIndex];
+	Job* ret = &data.jobs[data.nextJob & (kMaxJobsPerThread - 1)];
+	if (ret->inFlight.load(std::memory_order_acquire))
+	{
+	 // ring wrapped onto a job which hasn't completed
+		return nullptr;
+	}
+	ret->inFlight.store(true, std::memory_order_relaxed);
+	++data.nextJob;
+	return ret;
+}
+
+bool JobSystem::Impl::pushJob(Job* _job)
+{
+	if (_job->dependency && _job->dependency->load() != 0)
+	{
+		std::lock_guard<std::mutex> lock(waitingMutex);
+
+		// Increment waitingCount *before* re-checking the dependency; execute() decrements the dependency before checking waitingCount,
+		// hence either we see the dependency complete or the completing thread sees the waiting job.
+		waitingCount.fetch_add(1);
+		if (_job->dependency->load() != 0)
+		{
+			waitingJobs.push_back(_job);
+			return true;
+		}
+		waitingCount.fetch_sub(1);
+	}
+
+	if (!threadData[s_threadIndex].deque.push(_job))
+	{
+		return false;
+	}
+	queuedJobs.fetch_add(1);
+
+	{	std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_one();
+	return true;
+}
+
+void JobSystem::Impl::executeInline(Job* _job)
+{
+	if (_job->dependency)
+	{
+		JobSystem::Wait(_job->dependency);
+	}
+	execute(_job);
+}
+
+JobSystem::Impl::Job* JobSystem::Impl::getJob(int _threadIndex)
+{
+	ThreadData& data = threadData[_threadIndex];
+
+	Job* ret = data.deque.pop();
+	if (!ret && threadCount > 1)
+	{
+		// Steal, starting from a random victim.
+		data.rand ^= data.rand << 13;
+		data.rand ^= data.rand >> 17;
+		data.rand ^= data.rand << 5;
+		const int first = (int)(data.rand % (uint32)threadCount);
+		for (int i = 0; i < threadCount && !ret; ++i)
+		{
+			const int victim = (first + i) % threadCount;
+			if (victim != _threadIndex)
+			{
+				ret = threadData[victim].deque.steal();
+			}
+		}
+	}
+
+	if (ret)
+	{
+		queuedJobs.fetch_sub(1);
+	}
+
+	return ret;
+}
+
+bool JobSystem::Impl::executeOne()
+{
+	Job* job = getJob(s_threadIndex);
+	if (!job)
+	{
+		return false;
+	}
+
+	execute(job);
+	return true;
+}
+
+void JobSystem::Impl::execute(Job* _job)
+{
+	if (_job->rangeFunc)
+	{
+		_job->rangeFunc(_job->arg, _job->begin, _job->end);
+	}
+	else
+	{
+		_job->func(_job->arg);
+	}
+
+	Counter* counter = _job->counter;
+	_job->inFlight.store(false, std::memory_order_release);
+
+	if (counter)
+	{
+		if (counter->fetch_sub(1) == 1 && waitingCount.load() > 0)
+		{
+			releaseWaitingJobs();
+		}
+	}
+}
+
+void JobSystem::Impl::releaseWaitingJobs()
+{
+	eastl::fixed_vector<Job*, 16> released;
+	{	std::lock_guard<std::mutex> lock(waitingMutex);
+		for (auto it = waitingJobs.begin(); it != waitingJobs.end(); )
+		{
+			if ((*it)->dependency->load() == 0)
+			{
+				released.push_back(*it);
+				it = waitingJobs.erase_unsorted(it);
+				waitingCount.fetch_sub(1);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	for (Job* job : released)
+	{
+		if (threadData[s_threadIndex].deque.push(job))
+		{
+			queuedJobs.fetch_add(1);
+		}
+		else
+		{
+			execute(job);
+		}
+	}
+
+	if (!released.empty())
+	{
+		{	std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		sleepCondition.notify_all();
+	}
+}
+
+void JobSystem::Impl::ThreadProc(Impl* _impl, int _threadIndex)
+{
+	s_threadIndex = _threadIndex;
+
+	int spin = 0;
+	while (!_impl->shutdown.load(std::memory_order_relaxed))
+	{
+		if (_impl->executeOne())
+		{
+			spin = 0;
+			continue;
+		}
+
+		if (++spin < kSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_impl->sleepMutex);
+		_impl->sleepCondition.wait(lock, [_impl]() { return _impl->queuedJobs.load() > 0 || _impl->shutdown.load(); });
+		spin = 0;
+	}
+}
+
+} // namespace frm
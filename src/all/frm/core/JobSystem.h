@@ -0,0 +1,90 @@
+#pragma once
+
+#include <frm/core/frm.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// JobSystem
+// Work-stealing job scheduler. Each thread (main + workers) owns a deque of
+// jobs; jobs pushed by a thread go to its own deque (LIFO), idle threads steal
+// from the other deques (FIFO). Workers sleep when there is no work.
+//
+// Jobs are grouped via a Counter (fork/join): the counter is incremented when
+// a job is pushed and decremented when it completes, Wait() blocks until the
+// counter reaches 0. While waiting, the calling thread executes pending jobs.
+//
+// A job may optionally depend on a counter; it won't be executed until the
+// dependency counter reaches 0.
+//
+// Jobs may only be pushed from the main thread or from within other jobs. The
+// main thread is thread index 0. ParallelFor() may be called from any thread,
+// it runs serially on threads which can't push jobs.
+//
+// Per-thread job storage is a ring buffer of kMaxJobsPerThread jobs. If the
+// ring wraps onto a job which hasn't completed, or if the calling thread's
+// deque is full, the new job is executed immediately on the calling thread
+// (after waiting for its dependency) rather than being queued.
+////////////////////////////////////////////////////////////////////////////////
+class JobSystem
+{
+public:
+
+	using Counter = std::atomic<uint32>;
+
+	static constexpr uint32 kMaxJobsPerThread = 4096; // Must be a power of 2.
+
+	typedef void (JobFunc)(void* _arg);
+	typedef void (RangeFunc)(void* _arg, uint32 _begin, uint32 _end);
+
+	// Call during application init. Set the number of worker threads (in addition to the main thread). If -1, use hardware concurrency - 1.
+	static bool   Init(int _workerCount = -1);
+
+	// Call during application shutdown. Pending jobs are executed before the workers are joined.
+	static void   Shutdown();
+
+	// Return the total number of threads (workers + main thread), 1 if not initialized.
+	static int    GetThreadCount();
+
+	// Return the index of the calling thread (0 = main thread, -1 if not a job system thread).
+	static int    GetThreadIndex();
+
+	// Return whether the calling thread is a worker thread.
+	static bool   IsWorkerThread()                   { return GetThreadIndex() > 0; }
+
+	// Push a job. If _counter_, it is incremented and subsequently decremented when the job completes. If _dependency, the job isn't executed until *_dependency is 0.
+	static void   Run(JobFunc* _func, void* _arg, Counter* _counter_ = nullptr, Counter* _dependency = nullptr);
+
+	// Push a range job, _func is called with [_begin, _end). See Run().
+	static void   RunRange(RangeFunc* _func, void* _arg, uint32 _begin, uint32 _end, Counter* _counter_ = nullptr, Counter* _dependency = nullptr);
+
+	// Block until *_counter is 0. The calling thread executes pending jobs while waiting.
+	static void   Wait(Counter* _counter);
+
+	// Split [0, _count) into chunks of _chunkSize and call _func for each chunk across all threads. Block until all chunks are complete.
+	// If the job system isn't initialized, the calling thread isn't a job system thread or there is a single chunk, _func is called directly.
+	static void   ParallelFor(uint32 _count, uint32 _chunkSize, RangeFunc* _func, void* _arg);
+
+	// ParallelFor() variant which accepts a lambda of the form void(uint32 _begin, uint32 _end).
+	template <typename tLambda>
+	static void   ParallelFor(uint32 _count, uint32 _chunkSize, tLambda&& _lambda)
+	{
+		ParallelFor(_count, _chunkSize, &LambdaRangeFunc<typename std::remove_reference<tLambda>::type>, (void*)&_lambda);
+	}
+
+private:
+
+	struct Impl;
+	static Impl* s_impl;
+
+	template <typename tLambda>
+	static void   LambdaRangeFunc(void* _arg, uint32 _begin, uint32 _end)
+	{
+		(*(tLambda*)_arg)(_begin, _end);
+	}
+};
+
+} // namespace frm
@@ -86,6 +86,29 @@ struct Json::Impl
 {
 	rapidjson::Document m_dom;
 
+	// Buffer parsed in situ, referenced by string values in m_dom (see Json::Read()).
+	char*              m_insituData       = nullptr;
+	uint               m_insituSize       = 0;
+	File::ReleaseFunc* m_insituRelease    = nullptr;
+	void*              m_insituReleaseArg = nullptr;
+
+	~Impl()
+	{
+		setInsituData(nullptr, 0, nullptr, nullptr);
+	}
+
+	// Release the current in situ buffer (must be called after m_dom no longer references it).
+	void setInsituData(char* _data, uint _size, File::ReleaseFunc* _release, void* _releaseArg)
+	{
+		if (m_insituRelease) {
+			m_insituRelease(m_insituData, m_insituSize, m_insituReleaseArg);
+		}
+		m_insituData       = _data;
+		m_insituSize       = _size;
+		m_insituRelease    = _release;
+		m_insituReleaseArg = _releaseArg;
+	}
+
 	struct Value
 	{
 		rapidjson::Value* m_value  = nullptr;
@@ -252,7 +275,7 @@ struct Json::Impl
 				return (T)findGet(_name, _i, ValueType_Number)->GetInt();
 			case DataType_Sint64:
 			case DataType_Sint64N:
-				return (T)findGet(_name, _i, ValueType_Number)->GetUint();
+				return (T)findGet(_name, _i, ValueType_Number)->GetInt64();
 			case DataType_Float16: 
 				return (T)PackFloat16(findGet(_name, _i, ValueType_Number)->GetFloat());
 			case DataType_Float32:
@@ -409,6 +432,7 @@ struct Json::Impl
 bool Json::Read(Json& json_, const File& _file)
 {
 	json_.m_impl->m_dom.Parse(_file.getData());
+	json_.m_impl->setInsituData(nullptr, 0, nullptr, nullptr);
 	if (json_.m_impl->m_dom.HasParseError()) {
 		FRM_LOG_ERR("Json: %s\n\t'%s'", _file.getPath(), rapidjson::GetParseError_En(json_.m_impl->m_dom.GetParseError()));
 		return false;
@@ -423,7 +447,22 @@ bool Json::Read(Json& json_, const char* _path, int _root)
 	if (!FileSystem::ReadIfExists(f, _path, _root)) {
 		return false;
 	}
-	return Read(json_, f);
+
+	// Take ownership of the file data and parse in situ, string values then reference the buffer directly.
+	uint size;
+	File::ReleaseFunc* release;
+	void* releaseArg;
+	char* data = f.releaseData(size, release, releaseArg);
+	if (!data) {
+		return Read(json_, f);
+	}
+	json_.m_impl->m_dom.ParseInsitu(data);
+	json_.m_impl->setInsituData(data, size, release, releaseArg);
+	if (json_.m_impl->m_dom.HasParseError()) {
+		FRM_LOG_ERR("Json: %s\n\t'%s'", _path, rapidjson::GetParseError_En(json_.m_impl->m_dom.GetParseError()));
+		return false;
+	}
+	return true;
 }
 
 bool Json::Write(const Json& _json, File& file_)
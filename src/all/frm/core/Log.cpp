@@ -75,7 +75,7 @@ struct Log::Buffer
 	Impl::const_iterator m_flushFrom;
 	PathStr              m_output;
 
-	Log::Buffer(int _bufSize, const char* _output)
+	Buffer(int _bufSize, const char* _output)
 		: m_impl(_bufSize)
 		, m_flushFrom(m_impl.end())
 	{
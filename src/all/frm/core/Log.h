@@ -54,9 +54,9 @@ void LogDebug(const char* _fmt, ...);
 class Log
 {
 public:
-	typedef String<64> String;
-	typedef LogType    Type;
-	typedef Timestamp  Timestamp;
+	typedef frm::String<64> String;
+	typedef LogType         Type;
+	typedef frm::Timestamp  Timestamp;
 
 	struct Message
 	{
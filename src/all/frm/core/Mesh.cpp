@@ -4,6 +4,7 @@
 #include <frm/core/math.h>
 #include <frm/core/memory.h>
 #include <frm/core/FileSystem.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/Json.h>
 #include <frm/core/Serializer.h>
 #include <frm/core/SkeletonAnimation.h>
@@ -12,8 +13,332 @@
 #include <frm/core/extern/meshoptimizer/meshoptimizer.h>
 #include <frm/core/extern/xatlas/xatlas.h>
 
+#include <EASTL/vector.h>
+
+#include <limits>
+
 namespace frm {
 
+namespace {
+
+constexpr uint32 kTriangleChunkSize = 4096;
+constexpr uint32 kVertexChunkSize   = 4096;
+
+// Triangles adjacent to each vertex in ascending order. Gathering per-triangle values per vertex in this order performs the same sequence
+// of additions as a serial scatter over the triangles, hence the result is identical and independent of the number of threads.
+struct VertexTriangleAdjacency
+{
+	eastl::vector<uint32> offsets;   // vertexCount + 1, triangles adjacent to vertex i are [offsets[i], offsets[i + 1]).
+	eastl::vector<uint32> triangles;
+
+	VertexTriangleAdjacency(const uvec3* _triangles, uint32 _triangleCount, uint32 _vertexCount)
+	{
+		offsets.resize(_vertexCount + 1, 0);
+		for (uint32 i = 0; i < _triangleCount; ++i)
+		{
+			++offsets[_triangles[i].x + 1];
+			++offsets[_triangles[i].y + 1];
+			++offsets[_triangles[i].z + 1];
+		}
+		for (uint32 i = 0; i < _vertexCount; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		triangles.resize(_triangleCount * 3);
+		eastl::vector<uint32> cursors(offsets.begin(), offsets.end() - 1);
+		for (uint32 i = 0; i < _triangleCount; ++i)
+		{
+			triangles[cursors[_triangles[i].x]++] = i;
+			triangles[cursors[_triangles[i].y]++] = i;
+			triangles[cursors[_triangles[i].z]++] = i;
+		}
+	}
+};
+
+// Vertex data quantization. Normalized integers are rounded to nearest (DataTypeConvert() truncates) and decoded as per the GL rules.
+
+struct QuantizedVertexData
+{
+	void*              data              = nullptr;
+	DataType           dataType          = DataType_Invalid;
+	int                dataCount         = 0;
+	vec4               quantizationScale = vec4(1.0f);
+	vec4               quantizationBias  = vec4(0.0f);
+};
+
+template <typename tInt>
+constexpr float NormalizedMax()
+{
+	return (float)std::numeric_limits<tInt>::max();
+}
+
+template <typename tInt>
+void QuantizeNormalized(const float* _src, uint32 _count, bool _signed, void* dst_, float* decoded_)
+{
+	const float minValue = _signed ? -1.0f : 0.0f;
+	for (uint32 i = 0; i < _count; ++i)
+	{
+		const tInt q = (tInt)Round(Clamp(_src[i], minValue, 1.0f) * NormalizedMax<tInt>());
+		((tInt*)dst_)[i] = q;
+		decoded_[i] = Max((float)q / NormalizedMax<tInt>(), minValue);
+	}
+}
+
+vec2 OctahedralEncode(vec3 _n)
+{
+	const float l1 = Abs(_n.x) + Abs(_n.y) + Abs(_n.z);
+	if (l1 == 0.0f)
+	{
+		return vec2(0.0f);
+	}
+
+	_n /= l1;
+	vec2 ret = _n.xy();
+	if (_n.z < 0.0f)
+	{
+		ret.x = (1.0f - Abs(_n.y)) * (_n.x >= 0.0f ? 1.0f : -1.0f);
+		ret.y = (1.0f - Abs(_n.x)) * (_n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return ret;
+}
+
+vec3 OctahedralDecode(vec2 _p)
+{
+	vec3 ret = vec3(_p.x, _p.y, 1.0f - Abs(_p.x) - Abs(_p.y));
+	const float t = Max(-ret.z, 0.0f);
+	ret.x += (ret.x >= 0.0f) ? -t : t;
+	ret.y += (ret.y >= 0.0f) ? -t : t;
+	return Normalize(ret);
+}
+
+// Choose the rounding of each component which minimizes the angular error, rather than rounding to nearest.
+template <typename tInt>
+void QuantizeOctahedral(const float* _src, int _srcCount, uint32 _vertexCount, void* dst_, float* decoded_)
+{
+	for (uint32 i = 0; i < _vertexCount; ++i)
+	{
+		const vec3 n = Normalize(*((vec3*)(_src + i * _srcCount)));
+		const vec2 p = OctahedralEncode(n) * NormalizedMax<tInt>();
+		tInt* dst = (tInt*)dst_ + i * 2;
+		vec3 decoded = vec3(0.0f);
+		float bestDot = -FLT_MAX;
+		for (int j = 0; j < 4; ++j)
+		{
+			const vec2 q = vec2((j & 1) ? Ceil(p.x) : Floor(p.x), (j & 2) ? Ceil(p.y) : Floor(p.y));
+			const vec3 d = OctahedralDecode(q / NormalizedMax<tInt>());
+			if (dot(d, n) > bestDot)
+			{
+				bestDot = dot(d, n);
+				dst[0] = (tInt)q.x;
+				dst[1] = (tInt)q.y;
+				decoded = d;
+			}
+		}
+
+		memcpy(decoded_ + i * _srcCount, _src + i * _srcCount, sizeof(float) * _srcCount);
+		*((vec3*)(decoded_ + i * _srcCount)) = decoded;
+	}
+}
+
+QuantizedVertexData QuantizeVertexData(Mesh::Quantization _quantization, const float* _src, int _srcCount, uint32 _vertexCount, float* decoded_)
+{
+	QuantizedVertexData ret;
+	ret.dataCount = _srcCount;
+	const uint32 count = (uint32)_srcCount * _vertexCount;
+
+	switch (_quantization)
+	{
+		default:
+			FRM_ASSERT(false);
+			break;
+		case Mesh::Quantization_Float16:
+			ret.dataType = DataType_Float16;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+			DataTypeConvert(DataType_Float32, DataType_Float16, _src, ret.data, count);
+			DataTypeConvert(DataType_Float16, DataType_Float32, ret.data, decoded_, count);
+			break;
+		case Mesh::Quantization_Snorm16:
+			ret.dataType = DataType_Sint16N;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+			QuantizeNormalized<sint16>(_src, count, true, ret.data, decoded_);
+			break;
+		case Mesh::Quantization_Snorm8:
+			ret.dataType = DataType_Sint8N;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+			QuantizeNormalized<sint8>(_src, count, true, ret.data, decoded_);
+			break;
+		case Mesh::Quantization_Unorm16:
+			ret.dataType = DataType_Uint16N;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+			QuantizeNormalized<uint16>(_src, count, false, ret.data, decoded_);
+			break;
+		case Mesh::Quantization_Unorm8:
+			ret.dataType = DataType_Uint8N;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+			QuantizeNormalized<uint8>(_src, count, false, ret.data, decoded_);
+			break;
+		case Mesh::Quantization_Range16:
+		{
+			FRM_ASSERT(_srcCount <= 4);
+			ret.dataType = DataType_Uint16N;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * count, 4);
+
+			vec4 minValue = vec4(FLT_MAX);
+			vec4 maxValue = vec4(-FLT_MAX);
+			for (uint32 i = 0; i < count; ++i)
+			{
+				const int component = (int)(i % _srcCount);
+				minValue[component] = Min(minValue[component], _src[i]);
+				maxValue[component] = Max(maxValue[component], _src[i]);
+			}
+			ret.quantizationBias = vec4(0.0f);
+			ret.quantizationScale = vec4(1.0f);
+			for (int component = 0; component < _srcCount; ++component)
+			{
+				ret.quantizationBias[component] = minValue[component];
+				ret.quantizationScale[component] = maxValue[component] - minValue[component];
+			}
+
+			for (uint32 i = 0; i < count; ++i)
+			{
+				const int component = (int)(i % _srcCount);
+				const float scale = ret.quantizationScale[component];
+				const float bias = ret.quantizationBias[component];
+				const uint16 q = (scale > 0.0f) ? (uint16)Round(Saturate((_src[i] - bias) / scale) * NormalizedMax<uint16>()) : 0;
+				((uint16*)ret.data)[i] = q;
+				decoded_[i] = bias + scale * ((float)q / NormalizedMax<uint16>());
+			}
+			break;
+		}
+		case Mesh::Quantization_Octahedral16:
+			ret.dataType = DataType_Sint16N;
+			ret.dataCount = 2;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * 2 * _vertexCount, 4);
+			QuantizeOctahedral<sint16>(_src, _srcCount, _vertexCount, ret.data, decoded_);
+			break;
+		case Mesh::Quantization_Octahedral8:
+			ret.dataType = DataType_Sint8N;
+			ret.dataCount = 2;
+			ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * 2 * _vertexCount, 4);
+			QuantizeOctahedral<sint8>(_src, _srcCount, _vertexCount, ret.data, decoded_);
+			break;
+	}
+
+	return ret;
+}
+
+// Encode the tangent frame as a quaternion, the bitangent sign is stored in the sign of w. Tangents are orthogonalized with respect to
+// the normal.
+vec4 QTangentEncode(const vec3& _normal, const vec4& _tangent)
+{
+	const vec3 n = Normalize(_normal);
+	vec3 t = _tangent.xyz() - n * dot(n, _tangent.xyz());
+	if (Length2(t) < 1e-12f)
+	{
+		t = (Abs(n.x) < 0.9f) ? cross(n, vec3(1.0f, 0.0f, 0.0f)) : cross(n, vec3(0.0f, 1.0f, 0.0f));
+	}
+	t = Normalize(t);
+	const vec3 b = cross(n, t);
+
+	quat q = Normalize(RotationQuaternion(mat3(t, b, n)));
+	if (q.w < 0.0f)
+	{
+		q = -q;
+	}
+
+	// Ensure w is non-zero after quantization, else the sign is lost.
+	constexpr float kBias = 1.0f / 32767.0f;
+	if (q.w < kBias)
+	{
+		q = vec4(Normalize(q.xyz()) * sqrtf(1.0f - kBias * kBias), kBias);
+	}
+
+	return (_tangent.w < 0.0f) ? -q : q;
+}
+
+void QTangentDecode(const vec4& _q, vec3& normal_, vec4& tangent_)
+{
+	normal_ = linalg::qrot(_q, vec3(0.0f, 0.0f, 1.0f));
+	tangent_ = vec4(linalg::qrot(_q, vec3(1.0f, 0.0f, 0.0f)), (_q.w < 0.0f) ? -1.0f : 1.0f);
+}
+
+QuantizedVertexData QuantizeQTangents(const float* _normals, int _normalsCount, const float* _tangents, uint32 _vertexCount, float* decodedNormals_, float* decodedTangents_)
+{
+	QuantizedVertexData ret;
+	ret.dataType = DataType_Sint16N;
+	ret.dataCount = 4;
+	ret.data = FRM_MALLOC_ALIGNED(DataTypeSizeBytes(ret.dataType) * 4 * _vertexCount, 4);
+
+	for (uint32 i = 0; i < _vertexCount; ++i)
+	{
+		const vec4 q = QTangentEncode(*((vec3*)(_normals + i * _normalsCount)), *((vec4*)(_tangents + i * 4)));
+		vec4 decodedQ;
+		QuantizeNormalized<sint16>(&q.x, 4, true, (sint16*)ret.data + i * 4, &decodedQ.x);
+
+		vec3 decodedNormal;
+		vec4 decodedTangent;
+		QTangentDecode(decodedQ, decodedNormal, decodedTangent);
+		memcpy(decodedNormals_ + i * _normalsCount, _normals + i * _normalsCount, sizeof(float) * _normalsCount);
+		*((vec3*)(decodedNormals_ + i * _normalsCount)) = decodedNormal;
+		*((vec4*)(decodedTangents_ + i * 4)) = decodedTangent;
+	}
+
+	return ret;
+}
+
+Mesh::QuantizationError ComputeQuantizationError(Mesh::VertexDataSemantic _semantic, const float* _src, const float* _decoded, int _srcCount, uint32 _vertexCount)
+{
+	Mesh::QuantizationError ret;
+	if (_vertexCount == 0)
+	{
+		return ret;
+	}
+
+	double sum = 0.0;
+	uint32 sumCount = 0;
+	for (uint32 i = 0; i < _vertexCount; ++i)
+	{
+		const float* src = _src + i * _srcCount;
+		const float* decoded = _decoded + i * _srcCount;
+		if (_semantic == Mesh::Semantic_Positions && _srcCount >= 3)
+		{
+			const float err = Length(*((vec3*)src) - *((vec3*)decoded));
+			ret.maxError = Max(ret.maxError, err);
+			sum += err;
+			++sumCount;
+		}
+		else if ((_semantic == Mesh::Semantic_Normals || _semantic == Mesh::Semantic_Tangents) && _srcCount >= 3)
+		{
+			const vec3 a = *((vec3*)src);
+			const vec3 b = *((vec3*)decoded);
+			if (Length2(a) == 0.0f)
+			{
+				continue;
+			}
+			const float err = Degrees(atan2f(Length(cross(a, b)), dot(a, b))); // More precise than acos() for small angles.
+			ret.maxError = Max(ret.maxError, err);
+			sum += err;
+			++sumCount;
+		}
+		else
+		{
+			for (int j = 0; j < _srcCount; ++j)
+			{
+				const float err = Abs(src[j] - decoded[j]);
+				ret.maxError = Max(ret.maxError, err);
+				sum += err;
+				++sumCount;
+			}
+		}
+	}
+	ret.meanError = sumCount ? (float)(sum / sumCount) : 0.0f;
+
+	return ret;
+}
+
+} // namespace
+
 // PUBLIC
 
 const char* Mesh::kPrimitiveStr[Primitive_Count] =
@@ -24,6 +349,21 @@ const char* Mesh::kPrimitiveStr[Primitive_Count] =
 	"Triangles", // Primitive_Triangles
 };
 
+const char* Mesh::kQuantizationStr[Quantization_Count] =
+{
+	"Default",      // Quantization_Default
+	"None",         // Quantization_None
+	"Float16",      // Quantization_Float16
+	"Snorm16",      // Quantization_Snorm16
+	"Snorm8",       // Quantization_Snorm8
+	"Unorm16",      // Quantization_Unorm16
+	"Unorm8",       // Quantization_Unorm8
+	"Range16",      // Quantization_Range16
+	"Octahedral16", // Quantization_Octahedral16
+	"Octahedral8",  // Quantization_Octahedral8
+	"QTangent16",   // Quantization_QTangent16
+};
+
 const char* Mesh::kVertexDataSemanticStr[Semantic_Count]
 {
 	"Positions",      // Semantic_Positions
@@ -452,31 +792,41 @@ void Mesh::generateNormals()
 
 	setVertexData(Semantic_Normals, DataType_Float32, 3);
 	VertexDataView<vec3> normals = getVertexDataView<vec3>(Semantic_Normals);
-	memset(normals.begin(), 0, sizeof(vec3) * normals.getCount()); // Zero for accumulation.
 
 	VertexDataView<vec3> positions = getVertexDataView<vec3>(Semantic_Positions);
 	FRM_ASSERT(positions.getCount() > 0);
 
 	IndexDataView<uvec3> triangles = getIndexDataView<uvec3>(0);
-	for (const uvec3& triangle : triangles)
-	{
-		const vec3 a = positions[triangle.x];
-		const vec3 b = positions[triangle.y];
-		const vec3 c = positions[triangle.z];
-
-		const vec3 ab = b - a;
-		const vec3 ac = c - a;
-		const vec3 n  = cross(ab, ac);
-
-		normals[triangle.x] += n;
-		normals[triangle.y] += n;
-		normals[triangle.z] += n;
-	}
+	const uint32 triangleCount = triangles.getCount();
+	eastl::vector<vec3> faceNormals(triangleCount);
+	JobSystem::ParallelFor(triangleCount, kTriangleChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				const uvec3 triangle = triangles[i];
+				const vec3 a = positions[triangle.x];
+				const vec3 b = positions[triangle.y];
+				const vec3 c = positions[triangle.z];
+
+				const vec3 ab = b - a;
+				const vec3 ac = c - a;
+				faceNormals[i] = cross(ab, ac);
+			}
+		});
 
-	for (vec3& n : normals)
-	{
-		n = Normalize(n);
-	}
+	const VertexTriangleAdjacency adjacency(triangles.begin(), triangleCount, m_vertexCount);
+	JobSystem::ParallelFor(m_vertexCount, kVertexChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				vec3 n = vec3(0.0f);
+				for (uint32 j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; ++j)
+				{
+					n += faceNormals[adjacency.triangles[j]];
+				}
+				normals[i] = Normalize(n);
+			}
+		});
 }
 
 void Mesh::generateTangents()
@@ -488,7 +838,6 @@ void Mesh::generateTangents()
 
 	setVertexData(Semantic_Tangents, DataType_Float32, 4);
 	VertexDataView<vec4> tangents = getVertexDataView<vec4>(Semantic_Tangents);
-	memset(tangents.begin(), 0, sizeof(vec3) * tangents.getCount()); // Zero for accumulation.
 
 	VertexDataView<vec3> positions = getVertexDataView<vec3>(Semantic_Positions);
 	FRM_ASSERT(positions.getCount() > 0);
@@ -496,37 +845,48 @@ void Mesh::generateTangents()
 	FRM_ASSERT(uvs.getCount() > 0);
 
 	IndexDataView<uvec3> triangles = getIndexDataView<uvec3>(0);
-	for (const uvec3& triangle : triangles)
-	{
-		const vec3 pa  = positions[triangle.x];
-		const vec3 pb  = positions[triangle.y];
-		const vec3 pc  = positions[triangle.z];
-		const vec3 pab = pb - pa;
-		const vec3 pac = pc - pa;
-
-		const vec2 ta  = uvs[triangle.x];
-		const vec2 tb  = uvs[triangle.y];
-		const vec2 tc  = uvs[triangle.z];
-		const vec2 tab = tb - ta;
-		const vec2 tac = tc - ta;
-
-		vec4 t(
-			tac.y * pab.x - tab.y * pac.x,
-			tac.y * pab.y - tab.y * pac.y,
-			tac.y * pab.z - tab.y * pac.z,
-			0.0f
-			);
-		t /= (tab.x * tac.y - tab.y * tac.x);
-
-		tangents[triangle.x] += t;
-		tangents[triangle.y] += t;
-		tangents[triangle.z] += t;
-	}
-
-	for (vec4& t : tangents)
-	{
-		t = vec4(Normalize(t.xyz()), 1.0f);
-	}
+	const uint32 triangleCount = triangles.getCount();
+	eastl::vector<vec3> faceTangents(triangleCount);
+	JobSystem::ParallelFor(triangleCount, kTriangleChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				const uvec3 triangle = triangles[i];
+				const vec3 pa  = positions[triangle.x];
+				const vec3 pb  = positions[triangle.y];
+				const vec3 pc  = positions[triangle.z];
+				const vec3 pab = pb - pa;
+				const vec3 pac = pc - pa;
+
+				const vec2 ta  = uvs[triangle.x];
+				const vec2 tb  = uvs[triangle.y];
+				const vec2 tc  = uvs[triangle.z];
+				const vec2 tab = tb - ta;
+				const vec2 tac = tc - ta;
+
+				vec3 t(
+					tac.y * pab.x - tab.y * pac.x,
+					tac.y * pab.y - tab.y * pac.y,
+					tac.y * pab.z - tab.y * pac.z
+					);
+				t /= (tab.x * tac.y - tab.y * tac.x);
+				faceTangents[i] = t;
+			}
+		});
+
+	const VertexTriangleAdjacency adjacency(triangles.begin(), triangleCount, m_vertexCount);
+	JobSystem::ParallelFor(m_vertexCount, kVertexChunkSize, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				vec3 t = vec3(0.0f);
+				for (uint32 j = adjacency.offsets[i]; j < adjacency.offsets[i + 1]; ++j)
+				{
+					t += faceTangents[adjacency.triangles[j]];
+				}
+				tangents[i] = vec4(Normalize(t), 1.0f);
+			}
+		});
 }
 
 void Mesh::computeBounds()
@@ -561,7 +921,7 @@ void Mesh::computeBounds()
 
 void Mesh::optimize()
 {
-	// Note that it's only valid to move indices around *within* a submesh.
+	// Note that it's only valid to move indices around *within* a submesh. Submeshes are disjoint and hence optimized concurrently.
 	#define OPTIMIZE_PER_SUBMESH 1
 
 	FRM_AUTOTIMER("Mesh::optimize");
@@ -586,12 +946,15 @@ void Mesh::optimize()
 
 		#if OPTIMIZE_PER_SUBMESH
 		{
-			for (size_t submeshIndex = firstSubmeshIndex; submeshIndex < submeshCount; ++submeshIndex)
-			{
-				const uint32 offset = lod0.submeshes[submeshIndex].indexOffset;
-				const uint32 count  = lod0.submeshes[submeshIndex].indexCount;
-				meshopt_optimizeVertexCache<uint32>(newIndexData + offset, oldIndexData + offset, count, m_vertexCount);
-			}
+			JobSystem::ParallelFor((uint32)(submeshCount - firstSubmeshIndex), 1, [&](uint32 _begin, uint32 _end)
+				{
+					for (size_t submeshIndex = firstSubmeshIndex + _begin; submeshIndex < firstSubmeshIndex + _end; ++submeshIndex)
+					{
+						const uint32 offset = lod0.submeshes[submeshIndex].indexOffset;
+						const uint32 count  = lod0.submeshes[submeshIndex].indexCount;
+						meshopt_optimizeVertexCache<uint32>(newIndexData + offset, oldIndexData + offset, count, m_vertexCount);
+					}
+				});
 		}
 		#else
 		{
@@ -605,12 +968,15 @@ void Mesh::optimize()
 
 		#if OPTIMIZE_PER_SUBMESH
 		{
-			for (size_t submeshIndex = firstSubmeshIndex; submeshIndex < submeshCount; ++submeshIndex)
-			{
-				const uint32 offset = lod0.submeshes[submeshIndex].indexOffset;
-				const uint32 count  = lod0.submeshes[submeshIndex].indexCount;
-				meshopt_optimizeOverdraw<uint32>(newIndexData + offset, oldIndexData + offset, count, vertexPositions, vertexCount, sizeof(vec3), 1.05f);
-			}
+			JobSystem::ParallelFor((uint32)(submeshCount - firstSubmeshIndex), 1, [&](uint32 _begin, uint32 _end)
+				{
+					for (size_t submeshIndex = firstSubmeshIndex + _begin; submeshIndex < firstSubmeshIndex + _end; ++submeshIndex)
+					{
+						const uint32 offset = lod0.submeshes[submeshIndex].indexOffset;
+						const uint32 count  = lod0.submeshes[submeshIndex].indexCount;
+						meshopt_optimizeOverdraw<uint32>(newIndexData + offset, oldIndexData + offset, count, vertexPositions, vertexCount, sizeof(vec3), 1.05f);
+					}
+				});
 		}
 		#else
 		{
@@ -671,6 +1037,11 @@ void Mesh::generateLODs(int _lodCount, float _targetReduction, float _targetErro
 		m_lods.pop_back();
 	}
 
+	if (_lodCount < 2)
+	{
+		return;
+	}
+
 	_targetReduction = Max(_targetReduction, 0.01f);
 		
 	const size_t submeshCount = m_lods[0].submeshes.size();
@@ -683,66 +1054,88 @@ void Mesh::generateLODs(int _lodCount, float _targetReduction, float _targetErro
 	const float errorScale  = meshopt_simplifyScale(vertexPositions, vertexCount, sizeof(vec3));
 	float maxError          = 0.0f;
 
+	// Each LOD of a submesh is simplified from the same submesh in the previous LOD, hence the LOD chain for each submesh is generated
+	// concurrently. LODs are then assembled in order, stopping at the first LOD which failed to simplify (the result is identical to
+	// generating each LOD in turn).
+	const uint32 levelCount = (uint32)_lodCount - 1;
+	const uint32 simplifySubmeshCount = (uint32)(submeshCount - firstSubmeshIndex);
+	eastl::vector<eastl::vector<uint32> > indexDataPerSubmesh(simplifySubmeshCount * levelCount); // [submesh * levelCount + lodIndex - 1]
+	eastl::vector<float> errorPerSubmesh(simplifySubmeshCount * levelCount, 0.0f);
+	{	FRM_AUTOTIMER("Simplify");
+
+		const LOD& lod0 = m_lods[0];
+		JobSystem::ParallelFor(simplifySubmeshCount, 1, [&](uint32 _begin, uint32 _end)
+			{
+				for (uint32 i = _begin; i < _end; ++i)
+				{
+					const uint32* prevIndexData = (uint32*)lod0.indexData + lod0.submeshes[firstSubmeshIndex + i].indexOffset;
+					uint32 count = lod0.submeshes[firstSubmeshIndex + i].indexCount;
+					for (uint32 level = 0; level < levelCount; ++level)
+					{
+						auto& newIndexData = indexDataPerSubmesh[i * levelCount + level];
+						newIndexData.resize(count);
+
+						// Don't simplify if triangle count <= 32. \todo Better heuristic for this? Optimal threshold?
+						if (count / 3 <= 32)
+						{
+							memcpy(newIndexData.data(), prevIndexData, count * sizeof(uint32));
+						}
+						else
+						{
+							// See here for an explanation of geometric deviation: https://documentation.simplygon.com/SimplygonSDK_8.3.31500.0/articles/simplygonapi/apiuserguide/deviationscreensize.html
+							float resultError = 0.0f;
+							newIndexData.resize(meshopt_simplify(newIndexData.data(), prevIndexData, count, vertexPositions, vertexCount, sizeof(vec3), (size_t)Ceil(_targetReduction * count), _targetError, &resultError));
+							errorPerSubmesh[i * levelCount + level] = resultError * errorScale;
+						}
+
+						prevIndexData = newIndexData.data();
+						count = (uint32)newIndexData.size();
+					}
+				}
+			});
+	}
+
 	for (int lodIndex = 1; lodIndex < _lodCount; ++lodIndex)
 	{
-		FRM_AUTOTIMER("LOD%d", lodIndex);
+		const uint32 level = (uint32)lodIndex - 1;
 
-		LOD& lod = m_lods.push_back();
-		const LOD& prevLOD = m_lods[lodIndex - 1];
-		
 		// \todo Remove submeshes based on some size heuristic.
-		eastl::vector<eastl::vector<uint32> > indexDataPerSubmesh;
 		uint32 indexCount = 0;
-		for (size_t submeshIndex = firstSubmeshIndex; submeshIndex < submeshCount; ++submeshIndex)
+		for (uint32 i = 0; i < simplifySubmeshCount; ++i)
 		{
-			const uint32 offset = prevLOD.submeshes[submeshIndex].indexOffset;
-			const uint32 count  = prevLOD.submeshes[submeshIndex].indexCount;
-
-			auto& newIndexData = indexDataPerSubmesh.push_back();
-			newIndexData.resize(count);
-
-			// Don't simplify if triangle count <= 32. \todo Better heuristic for this? Optimal threshold?
-			if (count / 3 <= 32)
-			{
-				memcpy(newIndexData.data(), (uint32*)prevLOD.indexData + offset, count * sizeof(uint32));
-			}
-			else
-			{
-				// See here for an explanation of geometric deviation: https://documentation.simplygon.com/SimplygonSDK_8.3.31500.0/articles/simplygonapi/apiuserguide/deviationscreensize.html
-				float resultError = 0.0f;
-				newIndexData.resize(meshopt_simplify(newIndexData.data(), (uint32*)prevLOD.indexData + offset, count, vertexPositions, vertexCount, sizeof(vec3), (size_t)Ceil(_targetReduction * count), _targetError, &resultError));
-				resultError *= errorScale;
-				maxError = Max(maxError, resultError);
-			}
-
-			indexCount += (uint32)newIndexData.size();
+			indexCount += (uint32)indexDataPerSubmesh[i * levelCount + level].size();
 		}
 
 		// Stop if meshopt failed to simplify the mesh.
-		if (indexCount == prevLOD.submeshes[0].indexCount)
+		if (indexCount == m_lods[lodIndex - 1].submeshes[0].indexCount)
 		{
-			m_lods.pop_back();
 			break;
 		}
 
+		for (uint32 i = 0; i < simplifySubmeshCount; ++i)
+		{
+			maxError = Max(maxError, errorPerSubmesh[i * levelCount + level]);
+		}
+
+		LOD& lod = m_lods.push_back();
 		uint32* indexData = (uint32*)FRM_MALLOC_ALIGNED(sizeof(uint32) * indexCount, alignof(uint32));
 		lod.indexData = indexData;
-		lod.submeshes.resize(prevLOD.submeshes.size());
+		lod.submeshes.resize(submeshCount);
 		lod.submeshes[0].indexOffset = 0;
 		lod.submeshes[0].indexCount = indexCount;
 
 		for (size_t submeshIndex = firstSubmeshIndex; submeshIndex < submeshCount; ++submeshIndex)
 		{
-			uint32 perSubmeshDataIndex = (uint32)(submeshIndex - firstSubmeshIndex);
+			const auto& submeshIndexData = indexDataPerSubmesh[(submeshIndex - firstSubmeshIndex) * levelCount + level];
 			Submesh& submesh = lod.submeshes[submeshIndex];
 			submesh.indexOffset = (submeshIndex > 1) ? (lod.submeshes[submeshIndex - 1].indexOffset + lod.submeshes[submeshIndex - 1].indexCount) : 0;
-			submesh.indexCount  = (uint32)indexDataPerSubmesh[perSubmeshDataIndex].size();
+			submesh.indexCount  = (uint32)submeshIndexData.size();
 
 			// \todo Copy these from the previous LOD's submesh when processing above.
 			//submesh.boundingBox =
 			//submesh.boundingSphere =
 
-			memcpy((uint32*)lod.indexData + submesh.indexOffset, indexDataPerSubmesh[perSubmeshDataIndex].data(), submesh.indexCount * sizeof(uint32));
+			memcpy((uint32*)lod.indexData + submesh.indexOffset, submeshIndexData.data(), submesh.indexCount * sizeof(uint32));
 		}
 	}
 }
@@ -761,6 +1154,7 @@ void Mesh::generateLightmapUVs()
 	packOptions.bruteForce = true;
 	// \todo Need to set texels/unit here to have appropriate padding.
 
+	// Each submesh is added as a separate mesh; xatlas processes meshes concurrently on its own task scheduler (XA_MULTITHREADED).
 	xatlas::Atlas* atlas = xatlas::Create();
 	const size_t submeshCount = m_lods[0].submeshes.size();
 	const size_t submeshStartIndex = (submeshCount == 1) ? 0 : 1;
@@ -778,7 +1172,7 @@ void Mesh::generateLightmapUVs()
 		meshDecl.indexData            = (char*)m_lods[0].indexData + m_lods[0].submeshes[submeshIndex].indexOffset * DataTypeSizeBytes(m_indexDataType);
 		meshDecl.indexFormat          = (m_indexDataType == DataType_Uint16) ? xatlas::IndexFormat::UInt16 : xatlas::IndexFormat::UInt32;
 		
-		xatlas::AddMeshError err = xatlas::AddMesh(atlas, meshDecl);
+		xatlas::AddMeshError err = xatlas::AddMesh(atlas, meshDecl, (uint32_t)(submeshCount - submeshStartIndex));
 		FRM_ASSERT(err == xatlas::AddMeshError::Success);
 	}
 
@@ -791,41 +1185,50 @@ void Mesh::generateLightmapUVs()
 		return;
 	}
 
-	Mesh finalMesh;
-
-	for (uint32_t submeshIndex = 0; submeshIndex < atlas->meshCount; ++submeshIndex)
-	{
-		xatlas::Mesh& atlasMesh = atlas->meshes[submeshIndex];
-		Mesh submesh;
-		submesh.setVertexCount(atlasMesh.vertexCount);
-		for (int semantic = 0; semantic < Semantic_Count; ++semantic)
+	// Remap the vertex data for each submesh concurrently, then combine in order.
+	eastl::vector<Mesh*> submeshes(atlas->meshCount, nullptr);
+	JobSystem::ParallelFor(atlas->meshCount, 1, [&](uint32 _begin, uint32 _end)
 		{
-			if (m_vertexData[semantic].semantic == Semantic_Invalid)
+			for (uint32 submeshIndex = _begin; submeshIndex < _end; ++submeshIndex)
 			{
-				continue;
-			}
+				const xatlas::Mesh& atlasMesh = atlas->meshes[submeshIndex];
+				Mesh& submesh = *(submeshes[submeshIndex] = FRM_NEW(Mesh));
+				submesh.setVertexCount(atlasMesh.vertexCount);
+				for (int semantic = 0; semantic < Semantic_Count; ++semantic)
+				{
+					if (m_vertexData[semantic].semantic == Semantic_Invalid)
+					{
+						continue;
+					}
+
+					submesh.setVertexData(semantic, m_vertexData[semantic].dataType, m_vertexData[semantic].dataCount);
+					const char* srcVertexData = (char*)m_vertexData[semantic].data;
+					char* dstVertexData = (char*)submesh.m_vertexData[semantic].data;
+					const size_t vertexDataSizeBytes = m_vertexData[semantic].getDataSizeBytes();
+					for (uint32_t vertexIndex = 0; vertexIndex < atlasMesh.vertexCount; ++vertexIndex)
+					{
+						const xatlas::Vertex& vertex = atlasMesh.vertexArray[vertexIndex];
+						FRM_ASSERT(vertex.xref < m_vertexCount);
+						memcpy(dstVertexData + vertexIndex * vertexDataSizeBytes, srcVertexData + vertex.xref * vertexDataSizeBytes, vertexDataSizeBytes);
+					}
+				}
 
-			submesh.setVertexData(semantic, m_vertexData[semantic].dataType, m_vertexData[semantic].dataCount);
-			const char* srcVertexData = (char*)m_vertexData[semantic].data;
-			char* dstVertexData = (char*)submesh.m_vertexData[semantic].data;
-			const size_t vertexDataSizeBytes = m_vertexData[semantic].getDataSizeBytes();
-			for (uint32_t vertexIndex = 0; vertexIndex < atlasMesh.vertexCount; ++vertexIndex)
-			{
-				const xatlas::Vertex& vertex = atlasMesh.vertexArray[vertexIndex];
-				FRM_ASSERT(vertex.xref < m_vertexCount);
-				memcpy(dstVertexData + vertexIndex * vertexDataSizeBytes, srcVertexData + vertex.xref * vertexDataSizeBytes, vertexDataSizeBytes);
-			}
-		}
+				VertexDataView<vec2> lightmapUVs = submesh.getVertexDataView<vec2>(Semantic_LightmapUVs);
+				for (uint32_t vertexIndex = 0; vertexIndex < atlasMesh.vertexCount; ++vertexIndex)
+				{
+					const xatlas::Vertex& vertex = atlasMesh.vertexArray[vertexIndex];
+					lightmapUVs[vertexIndex] = vec2(vertex.uv[0], vertex.uv[1]) / vec2(atlas->width, atlas->height);
+				}
 
-		VertexDataView<vec2> lightmapUVs = submesh.getVertexDataView<vec2>(Semantic_LightmapUVs);
-		for (uint32_t vertexIndex = 0; vertexIndex < atlasMesh.vertexCount; ++vertexIndex)
-		{
-			const xatlas::Vertex& vertex = atlasMesh.vertexArray[vertexIndex];
-			lightmapUVs[vertexIndex] = vec2(vertex.uv[0], vertex.uv[1]) / vec2(atlas->width, atlas->height);
-		}
+				submesh.setIndexData(0, DataType_Uint32, atlasMesh.indexCount, atlasMesh.indexArray);
+			}
+		});
 
-		submesh.setIndexData(0, DataType_Uint32, atlasMesh.indexCount, atlasMesh.indexArray);
-		finalMesh.addSubmesh(0, submesh);
+	Mesh finalMesh;
+	for (Mesh*& submesh : submeshes)
+	{
+		finalMesh.addSubmesh(0, *submesh);
+		FRM_DELETE(submesh);
 	}
 
 	{ // \hack Use FRM_AUTOTIMER here only to have the stats appear nicely in the log. 
@@ -845,7 +1248,7 @@ void Mesh::generateLightmapUVs()
 	swap(finalMesh);
 }
 
-void Mesh::finalize()
+void Mesh::finalize(const FinalizeOptions& _options, FinalizeStats* stats_)
 {
 	FRM_AUTOTIMER("Mesh::finalize");
 
@@ -865,58 +1268,140 @@ void Mesh::finalize()
 			*_srcType_ = _newType;
 		};
 
-	// \todo Positions: Float16 if error ratio with bounds is small. I.e. if the maximum error < 1% of the bounding volume size.
-	//if (m_vertexData[Semantic_Positions].data)
-	//{
-	//	VertexData& positions = m_vertexData[Semantic_Positions];
-	//	ConvertBuffer(positions.dataType, positions.data, DataType_Float16, m_vertexCount * positions.dataCount);
-	//}
-	
-	// \todo MaterialUVs/LightMapUVs: Float16 isn't enough precision for textures > 2K. Uint16N would be enough but requires processing UV data to force a [0,1] range which should be valid for most cases.
-	//if (m_vertexData[Semantic_MaterialUVs].data)
-	//{
-	//}
-
-	// Colors: Uint8N for normalized values, else Float16.
-	// \todo RGBM? Would need hints or separate semantics.
-	if (m_vertexData[Semantic_Colors].data)
+	auto GetDataSizeBytes = [this](uint32 sizeBytes_[])
+		{
+			sizeBytes_[0] = sizeBytes_[1] = 0;
+			for (const VertexData& vertexData : m_vertexData)
+			{
+				sizeBytes_[0] += vertexData.data ? vertexData.getDataSizeBytes() * m_vertexCount : 0;
+			}
+			for (const LOD& lod : m_lods)
+			{
+				sizeBytes_[1] += lod.submeshes.empty() ? 0 : lod.submeshes[0].indexCount * (uint32)DataTypeSizeBytes(m_indexDataType);
+			}
+		};
+
+	FinalizeStats stats;
+	uint32 sizeBytes[2];
+	GetDataSizeBytes(sizeBytes);
+	stats.vertexDataSizeBytes[0] = sizeBytes[0];
+	stats.indexDataSizeBytes[0] = sizeBytes[1];
+
+	// Validate the quantization policy for each semantic.
+	Quantization quantization[Semantic_Count];
+	for (int semantic = 0; semantic < Semantic_Count; ++semantic)
 	{
-		VertexData& colors = m_vertexData[Semantic_Colors];
+		const VertexData& vertexData = m_vertexData[semantic];
+		quantization[semantic] = _options.quantization[semantic];
+		if (!vertexData.data)
+		{
+			continue;
+		}
 
-		VertexDataView<float> colorView = getVertexDataView<float>(Semantic_Colors);
-		float colorMin = FLT_MAX;
-		float colorMax = -FLT_MAX;
-		for (float color : colorView)
+		bool valid = true;
+		switch (quantization[semantic])
 		{
-			colorMin = Min(color, colorMin);
-			colorMax = Max(color, colorMax);
+			case Quantization_Default:
+			case Quantization_None:
+				break;
+			case Quantization_Octahedral16:
+			case Quantization_Octahedral8:
+				valid = semantic == Semantic_Normals && vertexData.dataCount >= 3;
+				break;
+			case Quantization_QTangent16:
+				valid = semantic == Semantic_Tangents && vertexData.dataCount == 4 && m_vertexData[Semantic_Normals].data && m_vertexData[Semantic_Normals].dataCount >= 3;
+				break;
+			case Quantization_Range16:
+				valid = semantic != Semantic_BoneIndices && vertexData.dataCount <= 4;
+				break;
+			default:
+				valid = semantic != Semantic_BoneIndices;
+				break;
 		}
 
-		if (colorMin < 0.0f || colorMax > 1.0f)
+		if (!valid)
 		{
-			ConvertBuffer(&colors.dataType, colors.data, DataType_Float16, m_vertexCount * colors.dataCount);
+			FRM_LOG_ERR("Mesh::finalize() -- %s quantization is not valid for %s, using the default", kQuantizationStr[quantization[semantic]], kVertexDataSemanticStr[semantic]);
+			quantization[semantic] = Quantization_Default;
 		}
-		else
+
+		if (quantization[semantic] == Quantization_Default && (semantic == Semantic_Normals || semantic == Semantic_Tangents))
+		{
+			quantization[semantic] = Quantization_Snorm16;
+		}
+		else if (quantization[semantic] == Quantization_Default && semantic != Semantic_Colors && semantic != Semantic_BoneIndices)
 		{
-			ConvertBuffer(&colors.dataType, colors.data, DataType_Uint8N, m_vertexCount * colors.dataCount);
+			quantization[semantic] = Quantization_None;
 		}
 	}
 
-	// Normals/tangents: convert to sint16. 
-	// \todo Test sint8?
-	if (m_vertexData[Semantic_Normals].data)
-	{
-		VertexData& normals = m_vertexData[Semantic_Normals];
-		ConvertBuffer(&normals.dataType, normals.data, DataType_Sint16N, m_vertexCount * normals.dataCount);
-	}
-	if (m_vertexData[Semantic_Tangents].data)
+	for (int semantic = 0; semantic < Semantic_Count; ++semantic)
 	{
-		VertexData& tangents = m_vertexData[Semantic_Tangents];
-		ConvertBuffer(&tangents.dataType, tangents.data, DataType_Sint16N, m_vertexCount * tangents.dataCount);
+		VertexData& vertexData = m_vertexData[semantic];
+		if (!vertexData.data || semantic == Semantic_BoneIndices || quantization[semantic] == Quantization_None)
+		{
+			continue;
+		}
+
+		// Normals are encoded with the tangents.
+		if (semantic == Semantic_Normals && quantization[Semantic_Tangents] == Quantization_QTangent16)
+		{
+			continue;
+		}
+
+		const uint32 count = m_vertexCount * vertexData.dataCount;
+		eastl::vector<float> srcData(count);
+		eastl::vector<float> decodedData(count);
+		DataTypeConvert(vertexData.dataType, DataType_Float32, vertexData.data, srcData.data(), count);
+
+		// Colors: Unorm8 for normalized values, else Float16.
+		// \todo RGBM? Would need hints or separate semantics.
+		if (quantization[semantic] == Quantization_Default)
+		{
+			FRM_ASSERT(semantic == Semantic_Colors);
+
+			float colorMin = FLT_MAX;
+			float colorMax = -FLT_MAX;
+			for (float color : srcData)
+			{
+				colorMin = Min(color, colorMin);
+				colorMax = Max(color, colorMax);
+			}
+			quantization[semantic] = (colorMin < 0.0f || colorMax > 1.0f) ? Quantization_Float16 : Quantization_Unorm8;
+		}
+
+		QuantizedVertexData quantized;
+		if (quantization[semantic] == Quantization_QTangent16)
+		{
+			VertexData& normals = m_vertexData[Semantic_Normals];
+			const uint32 normalsCount = m_vertexCount * normals.dataCount;
+			eastl::vector<float> srcNormals(normalsCount);
+			eastl::vector<float> decodedNormals(normalsCount);
+			DataTypeConvert(normals.dataType, DataType_Float32, normals.data, srcNormals.data(), normalsCount);
+
+			quantized = QuantizeQTangents(srcNormals.data(), normals.dataCount, srcData.data(), m_vertexCount, decodedNormals.data(), decodedData.data());
+			stats.error[Semantic_Normals] = ComputeQuantizationError(Semantic_Normals, srcNormals.data(), decodedNormals.data(), normals.dataCount, m_vertexCount);
+
+			FRM_FREE_ALIGNED(normals.data);
+			normals = VertexData();
+		}
+		else
+		{
+			quantized = QuantizeVertexData(quantization[semantic], srcData.data(), vertexData.dataCount, m_vertexCount, decodedData.data());
+		}
+		stats.error[semantic] = ComputeQuantizationError(semantic, srcData.data(), decodedData.data(), vertexData.dataCount, m_vertexCount);
+
+		FRM_FREE_ALIGNED(vertexData.data);
+		vertexData.data              = quantized.data;
+		vertexData.dataType          = quantized.dataType;
+		vertexData.dataCount         = quantized.dataCount;
+		vertexData.quantization      = quantization[semantic];
+		vertexData.quantizationScale = quantized.quantizationScale;
+		vertexData.quantizationBias  = quantized.quantizationBias;
 	}
 
 	// Bone indices: convert to uint8/uint16 depending on skeleton bone count.
-	if (m_vertexData[Semantic_BoneIndices].data && m_skeleton)
+	if (m_vertexData[Semantic_BoneIndices].data && m_skeleton && quantization[Semantic_BoneIndices] == Quantization_Default)
 	{
 		const size_t boneCount = m_skeleton->getBoneCount();
 		VertexData& boneIndices = m_vertexData[Semantic_BoneIndices];
@@ -945,6 +1430,24 @@ void Mesh::finalize()
 
 		m_indexDataType = DataType_Uint16;
 	}
+
+	GetDataSizeBytes(sizeBytes);
+	stats.vertexDataSizeBytes[1] = sizeBytes[0];
+	stats.indexDataSizeBytes[1] = sizeBytes[1];
+
+	for (int semantic = 0; semantic < Semantic_Count; ++semantic)
+	{
+		if (m_vertexData[semantic].data && m_vertexData[semantic].quantization != Quantization_None)
+		{
+			FRM_LOG_DBG("Mesh::finalize() -- %s: %s, max error = %g, mean error = %g", kVertexDataSemanticStr[semantic], kQuantizationStr[m_vertexData[semantic].quantization], stats.error[semantic].maxError, stats.error[semantic].meanError);
+		}
+	}
+	FRM_LOG_DBG("Mesh::finalize() -- vertex data %u -> %u bytes, index data %u -> %u bytes", stats.vertexDataSizeBytes[0], stats.vertexDataSizeBytes[1], stats.indexDataSizeBytes[0], stats.indexDataSizeBytes[1]);
+
+	if (stats_)
+	{
+		*stats_ = stats;
+	}
 }
 
 void Mesh::addSubmesh(uint32 _lod, uint32 _indexOffset, uint32 _indexCount)
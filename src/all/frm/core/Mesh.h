@@ -61,6 +61,53 @@ public:
 	using VertexDataSemantic = int;
 	static const char* kVertexDataSemanticStr[Semantic_Count];
 
+	// Vertex data quantization policy, see finalize().
+	enum _Quantization
+	{
+		Quantization_Default,      // Per-semantic default, see finalize().
+		Quantization_None,         // Keep the source data type.
+		Quantization_Float16,
+		Quantization_Snorm16,      // Sint16N, values are clamped to [-1,1].
+		Quantization_Snorm8,       // Sint8N, values are clamped to [-1,1].
+		Quantization_Unorm16,      // Uint16N, values are clamped to [0,1].
+		Quantization_Unorm8,       // Uint8N, values are clamped to [0,1].
+		Quantization_Range16,      // Uint16N relative to the range of each component (e.g. positions relative to the mesh bounds), decode as bias + scale * x.
+		Quantization_Octahedral16, // Normals only, 2x Sint16N octahedral encoding (see Normals_DecodeOctahedral() in Normals.glsl).
+		Quantization_Octahedral8,  // Normals only, 2x Sint8N octahedral encoding.
+		Quantization_QTangent16,   // Tangents only, the tangent frame as a Sint16N quaternion with the bitangent sign in the sign of w (see Normals_DecodeQTangent() in Normals.glsl). Normals are discarded.
+
+		Quantization_Count
+	};
+	using Quantization = int;
+	static const char* kQuantizationStr[Quantization_Count];
+
+	struct FinalizeOptions
+	{
+		Quantization quantization[Semantic_Count];
+
+		FinalizeOptions()
+		{
+			for (Quantization& q : quantization)
+			{
+				q = Quantization_Default;
+			}
+		}
+	};
+
+	// Round-trip error per semantic. Positions: distance. Normals/tangents: angle in degrees. Else: absolute error per component.
+	struct QuantizationError
+	{
+		float        maxError  = 0.0f;
+		float        meanError = 0.0f;
+	};
+
+	struct FinalizeStats
+	{
+		QuantizationError error[Semantic_Count];
+		uint32       vertexDataSizeBytes[2] = { 0, 0 }; // Before/after.
+		uint32       indexDataSizeBytes[2]  = { 0, 0 }; // Before/after, all LODs.
+	};
+
 	enum class CreateFlag
 	{
 		Optimize,
@@ -216,14 +263,26 @@ public:
 	void                  addSubmesh(uint32 _lod, uint32 _indexOffset, uint32 _indexCount);
 	void                  addSubmesh(uint32 _lod, const Mesh& _mesh);
 
+	// Quantize vertex data and convert index data to 16 bits where possible, optionally return the round-trip error per semantic in
+	// stats_. Default quantization per semantic:
+	// - Normals/tangents: Snorm16.
+	// - Colors: Unorm8 if all values are in [0,1], else Float16.
+	// - Bone indices: Uint8 or Uint16 depending on the bone count (bone indices can only use Quantization_Default or Quantization_None).
+	// - Others: None.
+	// Note that other functions expect Float32 vertex data, hence this should be called last (usually only when converting to DrawMesh).
+	void                  finalize(const FinalizeOptions& _options = FinalizeOptions(), FinalizeStats* stats_ = nullptr);
+
 protected:
 
 	struct VertexData
 	{
-		VertexDataSemantic semantic  = Semantic_Invalid;
-		void*              data      = nullptr;
-		DataType           dataType  = DataType_Invalid;
-		int                dataCount = 0;
+		VertexDataSemantic semantic          = Semantic_Invalid;
+		void*              data              = nullptr;
+		DataType           dataType          = DataType_Invalid;
+		int                dataCount         = 0;
+		Quantization       quantization      = Quantization_None;
+		vec4               quantizationScale = vec4(1.0f); // Quantization_Range16 only.
+		vec4               quantizationBias  = vec4(0.0f); //          "
 
 		uint32             getDataSizeBytes() const { return (uint32)DataTypeSizeBytes(dataType) * dataCount; }
 	};
@@ -261,10 +320,8 @@ protected:
 	bool                  serialize(Serializer& _serializer_);
 	void                  addLOD(const Mesh& _mesh);
 		
-	// Finalize vertex/index data formats. Note that this is private as we only want to use reduced precision formats when converting to DrawMesh.
-	void                  finalize();
-
 		
+	friend class CookedMesh;
 	friend class DrawMesh;
 };
 
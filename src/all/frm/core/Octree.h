@@ -1,9 +1,11 @@
 #pragma once
 
 #include <frm/core/frm.h>
+#include <frm/core/BitArray.h>
 #include <frm/core/memory.h>
 #include <frm/core/types.h>
 #include <frm/core/math.h>
+#include <frm/core/morton.h>
 
 #include <EASTL/fixed_vector.h>
 #include <EASTL/vector.h>
@@ -33,27 +35,39 @@ namespace frm {
 // Use linearize()/delinearize() functions to convert to/from a linear layout
 // e.g. for conversion to a texture.
 //
+// If tNode is bool, nodes are stored as a bitmap (see BitArray). In this case
+// operator[] returns a proxy and getIndex()/getLevel() are unavailable.
+// findFirst()/count() are word-parallel.
+//
 // \todo (see Quadtree.h)
 ///////////////////////////////////////////////////////////////////////////////
 template <typename tIndex, typename tNode>
 class Octree
 {
+	static constexpr bool kIsBitmap = eastl::is_same<tNode, bool>::value;
+	typedef typename eastl::conditional<kIsBitmap, BitArray, eastl::vector<tNode> >::type NodeStorage;
+
 	int                  m_levelCount;
-	eastl::vector<tNode> m_nodes;
+	NodeStorage          m_nodes;
+
+	// Type used for Morton encoding/decoding (see morton.h).
+	typedef typename eastl::conditional<(sizeof(tIndex) > sizeof(uint32)), uint64, uint32>::type MortonType;
 
 public:
 	typedef tIndex Index;
 	typedef tNode  Node;
+	typedef typename eastl::conditional<kIsBitmap, BitArray::Reference, tNode&>::type NodeReference;
+	typedef typename eastl::conditional<kIsBitmap, bool, const tNode&>::type          ConstNodeReference;
 	static constexpr Index Index_Invalid  = ~Index(0);
 
 	// Absolute max number of levels given number of index bits = bits/3.
 	static constexpr int    GetAbsoluteMaxLevelCount()                                        { return (int)(sizeof(Index) * CHAR_BIT) / 3; }
 
 	// Node count at _level = 8^_level.
-	static constexpr Index  GetNodeCount(int _level)                                          { return 1 << (3 * _level); }
+	static constexpr Index  GetNodeCount(int _level)                                          { return Index(1) << (3 * _level); }
 
 	// Width (in nodes) at _level = sqrt(GetNodeCount(_level)).
-	static constexpr Index  GetWidth(int _level)                                              { return 1 << _level; }
+	static constexpr Index  GetWidth(int _level)                                              { return Index(1) << _level; }
 
 	// Total node count = 8*(leafCount - 1)/7+1.
 	static constexpr Index  GetTotalNodeCount(int _levelCount)                                { return 8 * (GetNodeCount(_levelCount - 1) - 1) / 7 + 1; }
@@ -73,6 +87,10 @@ public:
 	// Convert Cartesian coordinates to an index.
 	static           Index  ToIndex(Index _x, Index _y, Index _z, int _nodeLevel);
 
+	// Batched ToCartesian()/ToIndex() for _count nodes at _nodeLevel.
+	static           void   ToCartesian(const Index* _nodeIndices, int _nodeLevel, uint32 _count, uvec3* out_);
+	static           void   ToIndex(const Index* _x, const Index* _y, const Index* _z, int _nodeLevel, uint32 _count, Index* out_);
+
 
 	Octree(int _levelCount = GetAbsoluteMaxLevelCount(), Node _init = Node());
 	~Octree();
@@ -90,22 +108,53 @@ public:
 	Index       getNodeWidth(int _levelIndex) const                                          { return GetWidth(FRM_MAX(m_levelCount - _levelIndex - 1, 0)); }
 
 	// Node access.
-	Node&       operator[](Index _index)                                                     { FRM_STRICT_ASSERT(_index < GetTotalNodeCount(m_levelCount)); return m_nodes[_index]; }
-	const Node& operator[](Index _index) const                                               { FRM_STRICT_ASSERT(_index < GetTotalNodeCount(m_levelCount)); return m_nodes[_index]; }
+	NodeReference      operator[](Index _index)                                              { FRM_STRICT_ASSERT(_index < GetTotalNodeCount(m_levelCount)); return m_nodes[_index]; }
+	ConstNodeReference operator[](Index _index) const                                        { FRM_STRICT_ASSERT(_index < GetTotalNodeCount(m_levelCount)); return m_nodes[_index]; }
 	int         getTotalNodeCount() const                                                    { return GetTotalNodeCount(m_levelCount); }
-	Index       getIndex(const Node& _node) const                                            { return &_node - m_nodes; }
+	Index       getIndex(const Node& _node) const                                            { return (Index)(&_node - m_nodes.data()); }
 	Index       getParentIndex(Index _childIndex, int _childLevel) const;
 	Index       getFirstChildIndex(Index _parentIndex, int _parentLevel) const;
 
 	// Level access.
-	const Node* getLevel(int _levelIndex) const                                              { FRM_STRICT_ASSERT(_levelIndex < m_levelCount); return m_nodes + GetLevelStartIndex(_level); }
-	Node*       getLevel(int _levelIndex)                                                    { FRM_STRICT_ASSERT(_levelIndex < m_levelCount); return m_nodes + GetLevelStartIndex(_level); }
+	const Node* getLevel(int _levelIndex) const                                              { FRM_STRICT_ASSERT(_levelIndex < m_levelCount); return m_nodes.data() + GetLevelStartIndex(_levelIndex); }
+	Node*       getLevel(int _levelIndex)                                                    { FRM_STRICT_ASSERT(_levelIndex < m_levelCount); return m_nodes.data() + GetLevelStartIndex(_levelIndex); }
 	Index       getNodeCount(int _levelIndex) const                                          { return GetNodeCount(_levelIndex); }
 	int         getLevelCount() const                                                        { return m_levelCount; }
 
 	// Linearize/delinearize nodes for a level. This is useful e.g. when converting to/from a texture representation.
-	void        linearize(int _levelIndex, Node* out_) const                                 { FRM_ASSERT(false); } // \todo
-	void        delinearize(int _levelIndex, const Node* _in)                                { FRM_ASSERT(false); } // \todo
+	// out_/_in are GetWidth(_levelIndex)^3 nodes in row-major order (x varies fastest).
+	void        linearize(int _levelIndex, Node* out_) const;
+	void        delinearize(int _levelIndex, const Node* _in);
+
+	// Find the first node at _levelIndex equal to _value within the subtree at _rootIndex, return Index_Invalid if there is no
+	// such node. Descendants of a node at a given level are contiguous in Morton order, hence this is a linear search over
+	// GetNodeCount(_levelIndex - rootLevel) nodes.
+	Index       findFirst(int _levelIndex, Node _value, Index _rootIndex = 0) const;
+
+	// Number of nodes at _levelIndex equal to _value within the subtree at _rootIndex.
+	Index       count(int _levelIndex, Node _value, Index _rootIndex = 0) const;
+
+private:
+
+	// Range of nodes [begin_, end_) at _levelIndex within the subtree at _rootIndex.
+	void        getSubtreeRange(int _levelIndex, Index _rootIndex, Index& begin_, Index& end_) const;
+
+	static Index Find(const BitArray& _nodes, Index _begin, Index _end, bool _value)                { return (Index)_nodes.find((uint32)_begin, (uint32)_end, _value); }
+	static Index Find(const eastl::vector<tNode>& _nodes, Index _begin, Index _end, const tNode& _value)
+	{
+		for (; _begin < _end && !(_nodes[_begin] == _value); ++_begin);
+		return _begin;
+	}
+	static Index Count(const BitArray& _nodes, Index _begin, Index _end, bool _value)               { return (Index)_nodes.count((uint32)_begin, (uint32)_end, _value); }
+	static Index Count(const eastl::vector<tNode>& _nodes, Index _begin, Index _end, const tNode& _value)
+	{
+		Index ret = 0;
+		for (; _begin < _end; ++_begin)
+		{
+			ret += (_nodes[_begin] == _value) ? 1 : 0;
+		}
+		return ret;
+	}
 };
 
 
@@ -145,20 +194,10 @@ int FRM_OCTREE_CLASS_DECL::FindLevel(Index _nodeIndex)
 FRM_OCTREE_TEMPLATE_DECL 
 uvec3 FRM_OCTREE_CLASS_DECL::ToCartesian(Index _nodeIndex, int _nodeLevel)
 {
- // traverse the index LSB -> MSB summing node width (node width = number of leaf nodes covered, start at 1) 
-	_nodeIndex -= GetLevelStartIndex(_nodeLevel);
-	Index width = 1;
-	uvec3 ret = uvec3(0u);
-	for (int i = 0; i < _nodeLevel; ++i, width *= 2)
-	{
-		ret.y += (_nodeIndex & 1) * width; 
-		_nodeIndex = _nodeIndex >> 1;
-		ret.x += (_nodeIndex & 1) * width;
-		_nodeIndex = _nodeIndex >> 1;
-		ret.z += (_nodeIndex & 1) * width;
-		_nodeIndex = _nodeIndex >> 1;
-	}
-	return ret;
+ // remove level offset, deinterleave the Morton code (y, x, z from LSB -> MSB)
+	MortonType x, y, z;
+	MortonDecode3((MortonType)(_nodeIndex - GetLevelStartIndex(_nodeLevel)), y, x, z);
+	return uvec3((uint32)x, (uint32)y, (uint32)z);
 }
 
 FRM_OCTREE_TEMPLATE_DECL 
@@ -172,18 +211,31 @@ tIndex FRM_OCTREE_CLASS_DECL::ToIndex(Index _x, Index _y, Index _z, int _nodeLev
 	}
 
  // interleave _x, _y and _z to produce the Morton code, add level offset
-	Index ret = 0;
-	for (Index i = 0; i < (sizeof(Index) * CHAR_BIT); ++i)
+	return (Index)MortonEncode3((MortonType)_y, (MortonType)_x, (MortonType)_z) + GetLevelStartIndex(_nodeLevel);
+}
+
+FRM_OCTREE_TEMPLATE_DECL 
+void FRM_OCTREE_CLASS_DECL::ToCartesian(const Index* _nodeIndices, int _nodeLevel, uint32 _count, uvec3* out_)
+{
+	const Index levelStart = GetLevelStartIndex(_nodeLevel);
+	for (uint32 i = 0; i < _count; ++i)
+	{
+		MortonType x, y, z;
+		MortonDecode3((MortonType)(_nodeIndices[i] - levelStart), y, x, z);
+		out_[i] = uvec3((uint32)x, (uint32)y, (uint32)z);
+	}
+}
+
+FRM_OCTREE_TEMPLATE_DECL 
+void FRM_OCTREE_CLASS_DECL::ToIndex(const Index* _x, const Index* _y, const Index* _z, int _nodeLevel, uint32 _count, Index* out_)
+{
+	const Index w = GetWidth(_nodeLevel);
+	const Index levelStart = GetLevelStartIndex(_nodeLevel);
+	for (uint32 i = 0; i < _count; ++i)
 	{
-		const Index mask = 1 << i;
-		const Index base = i << 1;
-		ret = ret 
-			| (_y & mask) << (base + 0)
-			| (_x & mask) << (base + 1)
-			| (_z & mask) << (base + 2)
-			;
+		const Index ret = (Index)MortonEncode3((MortonType)_y[i], (MortonType)_x[i], (MortonType)_z[i]) + levelStart;
+		out_[i] = (_x[i] >= w || _y[i] >= w || _z[i] >= w) ? Index_Invalid : ret;
 	}
-	return ret + GetLevelStartIndex(_nodeLevel);
 }
 
 
@@ -194,12 +246,7 @@ FRM_OCTREE_CLASS_DECL::Octree(int _levelCount, Node _init)
 	FRM_STATIC_ASSERT(!DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(Index))); // use an unsigned type
 	FRM_ASSERT(_levelCount <= GetAbsoluteMaxLevelCount()); // not enough bits in tIndex
 
-	Index totalNodeCount = GetTotalNodeCount(_levelCount);
-	m_nodes.reserve(totalNodeCount);
-	for (Index i = 0, n = GetTotalNodeCount(_levelCount); i < n; ++i) 
-	{
-		m_nodes.emplace_back(_init);	
-	}
+	m_nodes.resize((uint32)GetTotalNodeCount(_levelCount), _init);
 }
 
 FRM_OCTREE_TEMPLATE_DECL 
@@ -243,6 +290,61 @@ tIndex FRM_OCTREE_CLASS_DECL::findValidNeighbor(Index _nodeIndex, int _nodeLevel
 	return ret;
 }
 
+FRM_OCTREE_TEMPLATE_DECL
+void FRM_OCTREE_CLASS_DECL::linearize(int _levelIndex, Node* out_) const
+{
+	FRM_ASSERT(_levelIndex < m_levelCount);
+	const Index levelStart = GetLevelStartIndex(_levelIndex);
+	const Index width      = GetWidth(_levelIndex);
+	for (Index i = 0, n = GetNodeCount(_levelIndex); i < n; ++i)
+	{
+		MortonType x, y, z;
+		MortonDecode3((MortonType)i, y, x, z);
+		out_[(z * width + y) * width + x] = m_nodes[levelStart + i];
+	}
+}
+
+FRM_OCTREE_TEMPLATE_DECL
+void FRM_OCTREE_CLASS_DECL::delinearize(int _levelIndex, const Node* _in)
+{
+	FRM_ASSERT(_levelIndex < m_levelCount);
+	const Index levelStart = GetLevelStartIndex(_levelIndex);
+	const Index width      = GetWidth(_levelIndex);
+	for (Index i = 0, n = GetNodeCount(_levelIndex); i < n; ++i)
+	{
+		MortonType x, y, z;
+		MortonDecode3((MortonType)i, y, x, z);
+		m_nodes[levelStart + i] = _in[(z * width + y) * width + x];
+	}
+}
+
+FRM_OCTREE_TEMPLATE_DECL
+tIndex FRM_OCTREE_CLASS_DECL::findFirst(int _levelIndex, Node _value, Index _rootIndex) const
+{
+	Index begin, end;
+	getSubtreeRange(_levelIndex, _rootIndex, begin, end);
+	const Index ret = Find(m_nodes, begin, end, _value);
+	return ret == end ? Index_Invalid : ret;
+}
+
+FRM_OCTREE_TEMPLATE_DECL
+tIndex FRM_OCTREE_CLASS_DECL::count(int _levelIndex, Node _value, Index _rootIndex) const
+{
+	Index begin, end;
+	getSubtreeRange(_levelIndex, _rootIndex, begin, end);
+	return Count(m_nodes, begin, end, _value);
+}
+
+FRM_OCTREE_TEMPLATE_DECL
+void FRM_OCTREE_CLASS_DECL::getSubtreeRange(int _levelIndex, Index _rootIndex, Index& begin_, Index& end_) const
+{
+	const int rootLevel = FindLevel(_rootIndex);
+	FRM_ASSERT(rootLevel <= _levelIndex && _levelIndex < m_levelCount);
+	const int levelDelta = _levelIndex - rootLevel;
+	begin_ = GetLevelStartIndex(_levelIndex) + ((_rootIndex - GetLevelStartIndex(rootLevel)) << (3 * levelDelta));
+	end_   = begin_ + GetNodeCount(levelDelta);
+}
+
 FRM_OCTREE_TEMPLATE_DECL 
 template<typename OnVisit>
 void FRM_OCTREE_CLASS_DECL::traverse(OnVisit&& _onVisit, Index _root)
@@ -4,6 +4,7 @@
 #include <frm/core/math.h>
 #include <frm/core/memory.h>
 #include <frm/core/GlContext.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/String.h>
 #include <frm/core/StringHash.h>
 #include <frm/core/Time.h>
@@ -480,13 +481,13 @@ void Profiler::NextFrame()
 
 void Profiler::PushCpuMarker(const char* _name)
 {
-	if (!s_pause) {
+	if (!s_pause && !JobSystem::IsWorkerThread()) { // \todo Markers are only recorded on the main thread.
 		g_CpuData.pushMarker(_name).m_startTime = (uint64)Time::GetTimestamp().getRaw();
 	}
 }
 void Profiler::PopCpuMarker(const char* _name)
 {
-	if (!s_pause) {
+	if (!s_pause && !JobSystem::IsWorkerThread()) {
 		g_CpuData.popMarker(_name).m_stopTime = (uint64)Time::GetTimestamp().getRaw();
 	}
 }
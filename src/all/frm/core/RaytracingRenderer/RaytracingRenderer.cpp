@@ -5,6 +5,7 @@
 #include <frm/core/hash.h>
 #include <frm/core/types.h>
 #include <frm/core/Buffer.h>
+#include <frm/core/BVH.h>
 #include <frm/core/DrawMesh.h>
 #include <frm/core/GlContext.h>
 #include <frm/core/File.h>
@@ -38,6 +39,8 @@ namespace frm {
 struct RaytracingRenderer::MeshData
 {
 	physx::PxGeometryHolder   pxGeometry;
+	BVH                       blas;
+	eastl::vector<Triangle>   triangles;                  // Mesh space, in index buffer order.
 
 	uint64_t                  key          = 0;
 	int                       refCount     = 0;
@@ -61,6 +64,8 @@ struct RaytracingRenderer::Instance
 
 	SceneNode*                sceneNode    = nullptr;
 	MeshData*                 meshData     = nullptr;
+	mat4                      world        = identity;
+	mat4                      worldInverse = identity;
 };
 
 struct RaytracingRenderer::Impl
@@ -78,12 +83,25 @@ struct RaytracingRenderer::Impl
 	MeshDataMap               meshDataMap;
 	Pool<MeshData>            meshDataPool;
 
+	BVH                       tlas;
+	eastl::vector<Instance*>  tlasInstances;              // TLAS primitive index -> instance.
+	bool                      tlasDirty  = true;
+	bool                      usePhysX   = false;
+
+	static constexpr uint32   kPacketSize = 8;            // Rays per packet for BVH traversal.
+
+	// Workers poll the job list continuously. state packs the batch generation (high 32 bits) with the read index (low 32 bits), jobs
+	// are claimed by a CAS on state which fails if the batch was reset since it was read (see processJobs() and raycast()).
 	struct RayJobList
 	{
-		const Ray*           raysIn  = nullptr;
-		RayHit*              raysOut = nullptr;
-		std::atomic<uint32>  readAt;
-		std::atomic<uint32>  count;
+		static constexpr uint32 kClosed = ~0u; // Read index while the batch is being reset, no jobs can be claimed.
+
+		std::atomic<const Ray*> raysIn    { nullptr };
+		std::atomic<RayHit*>    raysOut   { nullptr };
+		std::atomic<bool>       anyHit    { false };
+		std::atomic<uint32>     count     { 0 };
+		std::atomic<uint32>     completed { 0 };
+		std::atomic<uint64>     state     { kClosed };
 	};
 
 	ThreadPool                threadPool;
@@ -95,20 +113,71 @@ struct RaytracingRenderer::Impl
 	Impl(): instancePool(256), meshDataPool(256) {}
 
 	uint32 processJobs(uint32 _max)
-	{		
-		uint32 i, n, count;
+	{
+		const Ray* raysIn;
+		RayHit*    raysOut;
+		bool       anyHit;
+		uint32     i, n;
+		uint64     state = rayJobs.state.load(std::memory_order_acquire);
 		while (true)
 		{
-			count = rayJobs.count.load();
-			i = rayJobs.readAt.load();
-			n = Min(i + _max, count);
-			
-			if (rayJobs.readAt.compare_exchange_weak(i, n))
+			i = (uint32)state;
+			if (i == RayJobList::kClosed)
+			{
+				return 0;
+			}
+
+			// The batch is closed before it's modified, hence if any of these loads see the next batch the CAS below fails.
+			raysIn  = rayJobs.raysIn.load(std::memory_order_acquire);
+			raysOut = rayJobs.raysOut.load(std::memory_order_acquire);
+			anyHit  = rayJobs.anyHit.load(std::memory_order_acquire);
+			n = Max(i, Min(i + _max, rayJobs.count.load(std::memory_order_acquire)));
+			if (n == i)
+			{
+				return 0;
+			}
+
+			if (rayJobs.state.compare_exchange_weak(state, (state & ~(uint64)RayJobList::kClosed) | n, std::memory_order_acq_rel, std::memory_order_acquire))
 			{
 				break;
 			}
 		}
 
+		const uint32 ret = n - i;
+		if (usePhysX)
+		{
+			raycastPhysX(raysIn, raysOut, i, n, anyHit);
+		}
+		else
+		{
+			for (; i < n; i += kPacketSize)
+			{
+				raycastPacket(raysIn, raysOut, i, Min(i + kPacketSize, n), anyHit);
+			}
+		}
+
+		// \todo Accessing threadPool is invalid here, it can happen while we're setting up the threadPool :*(
+		bool found = false;
+		for (std::thread& t : threadPool)
+		{
+			if (t.get_id() == std::this_thread::get_id())
+			{
+				jobsPerThread[&t - threadPool.begin() + 1] += (float)ret;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			jobsPerThread[0] += (float)ret;
+		}
+
+		rayJobs.completed.fetch_add(ret);
+		return ret;
+	}
+
+	void raycastPhysX(const Ray* _in, RayHit* out_, uint32 _begin, uint32 _end, bool _anyHit)
+	{
 		pxScene->lockRead();
 
 		const physx::PxHitFlags flags = (physx::PxHitFlags)0
@@ -116,20 +185,24 @@ struct RaytracingRenderer::Impl
 			| physx::PxHitFlag::eNORMAL
 			| physx::PxHitFlag::eUV
 			| physx::PxHitFlag::eFACE_INDEX
-			//| physx::PxHitFlag::eMESH_ANY
+			| (_anyHit ? physx::PxHitFlag::eMESH_ANY : (physx::PxHitFlag::Enum)0)
 			;
+		physx::PxQueryFilterData filterData;
+		if (_anyHit)
+		{
+			filterData.flags |= physx::PxQueryFlag::eANY_HIT;
+		}
 
-		uint32 ret = n - i;
-		for (; i < n; ++i)
+		for (uint32 i = _begin; i < _end; ++i)
 		{
-			const Ray& rayIn = rayJobs.raysIn[i];
-			RayHit& rayHit = rayJobs.raysOut[i];
+			const Ray& rayIn = _in[i];
+			RayHit& rayHit = out_[i];
 			rayHit = RayHit();
 			rayHit.isHit = 0;
 			rayHit.rayID = i;
 
 			physx::PxRaycastBuffer queryResult;
-			if (!pxScene->raycast(Vec3ToPx(rayIn.origin), Vec3ToPx(rayIn.direction), rayIn.maxDistance, queryResult) || !queryResult.hasBlock)
+			if (!pxScene->raycast(Vec3ToPx(rayIn.origin), Vec3ToPx(rayIn.direction), rayIn.maxDistance, queryResult, flags, filterData) || !queryResult.hasBlock)
 			{
 				continue;
 			}
@@ -147,24 +220,133 @@ struct RaytracingRenderer::Impl
 		}
 
 		pxScene->unlockRead();
+	}
 
-		// \todo Accessing threadPool is invalid here, it can happen while we're setting up the threadPool :*(
-		bool found = false;
-		for (std::thread& t : threadPool)
+	// Trace rays [_begin, _end) as a single packet, _end - _begin <= kPacketSize.
+	void raycastPacket(const Ray* _in, RayHit* out_, uint32 _begin, uint32 _end, bool _anyHit)
+	{
+		FRM_STRICT_ASSERT(_end - _begin <= kPacketSize);
+
+		struct PacketHit
 		{
-			if (t.get_id() == std::this_thread::get_id())
+			Instance* instance;
+			uint32    triangleIndex;
+			vec2      barycentrics;
+		};
+
+		vec3      origins[kPacketSize];
+		vec3      directions[kPacketSize];
+		float     tMax[kPacketSize];
+		PacketHit hits[kPacketSize];
+		uint32    rayMask = 0;
+		for (uint32 i = 0; i < kPacketSize; ++i)
+		{
+			const Ray& ray   = _in[Min(_begin + i, _end - 1)]; // Pad the packet with copies of the last ray (inactive).
+			origins[i]       = ray.origin;
+			directions[i]    = ray.direction;
+			tMax[i]          = ray.maxDistance;
+			hits[i].instance = nullptr;
+			rayMask         |= (_begin + i < _end) ? (1u << i) : 0u;
+		}
+
+		tlas.traversePacket<kPacketSize>(origins, directions, tMax, rayMask,
+			[&](uint32 _instanceIndex, uint32 _rayMask) -> uint32
 			{
-				jobsPerThread[&t - threadPool.begin() + 1] += (float)ret;
-				found = true;
-				break;
-			}
+				Instance* instance = tlasInstances[_instanceIndex];
+				const MeshData* meshData = instance->meshData;
+
+				// Transform rays to mesh space. Directions aren't renormalized, hence distances are unchanged.
+				vec3 localOrigins[kPacketSize];
+				vec3 localDirections[kPacketSize];
+				for (uint32 i = 0; i < kPacketSize; ++i)
+				{
+					localOrigins[i]    = TransformPosition(instance->worldInverse, origins[i]);
+					localDirections[i] = TransformDirection(instance->worldInverse, directions[i]);
+				}
+
+				uint32 hitMask = 0;
+				meshData->blas.traversePacket<kPacketSize>(localOrigins, localDirections, tMax, _rayMask,
+					[&](uint32 _triangleIndex, uint32 _rayMask) -> uint32
+					{
+						const Triangle& triangle = meshData->triangles[_triangleIndex];
+						uint32 ret = 0;
+						for (uint32 i = 0; i < kPacketSize; ++i)
+						{
+							if ((_rayMask & (1u << i)) && IntersectClosest(frm::Ray(localOrigins[i], localDirections[i]), triangle, tMax[i], hits[i].barycentrics, true))
+							{
+								hits[i].instance      = instance;
+								hits[i].triangleIndex = _triangleIndex;
+								ret |= 1u << i;
+							}
+						}
+						hitMask |= ret;
+						return _anyHit ? ret : 0u;
+					});
+
+				return _anyHit ? hitMask : 0u;
+			});
+
+		for (uint32 i = 0; _begin + i < _end; ++i)
+		{
+			writeRayHit(_in[_begin + i], _begin + i, hits[i].instance, hits[i].triangleIndex, tMax[i], hits[i].barycentrics, out_[_begin + i]);
 		}
-		if (!found)
+	}
+
+	// Trace a single ray via the BVH.
+	bool raycastBVH(const Ray& _in, uint32 _rayID, bool _anyHit, RayHit& out_)
+	{
+		Instance* hitInstance = nullptr;
+		uint32    hitTriangle = 0;
+		vec2      hitBarycentrics = vec2(0.0f);
+		float     tMax = _in.maxDistance;
+
+		tlas.traverse(_in.origin, _in.direction, tMax,
+			[&](uint32 _instanceIndex, float& tMax_) -> bool
+			{
+				Instance* instance = tlasInstances[_instanceIndex];
+				const MeshData* meshData = instance->meshData;
+				const frm::Ray localRay(TransformPosition(instance->worldInverse, _in.origin), TransformDirection(instance->worldInverse, _in.direction));
+
+				return meshData->blas.traverse(localRay.m_origin, localRay.m_direction, tMax_,
+					[&](uint32 _triangleIndex, float& tTriangleMax_) -> bool
+					{
+						// Don't write hitBarycentrics unless the hit is accepted, a farther triangle may be tested after the closest.
+						if (IntersectClosest(localRay, meshData->triangles[_triangleIndex], tTriangleMax_, hitBarycentrics, true))
+						{
+							hitInstance = instance;
+							hitTriangle = _triangleIndex;
+							return _anyHit;
+						}
+						return false;
+					});
+			});
+
+		writeRayHit(_in, _rayID, hitInstance, hitTriangle, tMax, hitBarycentrics, out_);
+		return hitInstance != nullptr;
+	}
+
+	static void writeRayHit(const Ray& _ray, uint32 _rayID, Instance* _instance, uint32 _triangleIndex, float _distance, const vec2& _barycentrics, RayHit& out_)
+	{
+		out_ = RayHit();
+		out_.isHit = 0;
+		out_.rayID = _rayID;
+		if (!_instance)
 		{
-			jobsPerThread[0] += (float)ret;
+			return;
 		}
 
-		return ret;
+		// Geometric normal, transformed to world space via the inverse transpose.
+		const Triangle& triangle = _instance->meshData->triangles[_triangleIndex];
+		const vec3 normal = Cross(triangle.m_vertices[1] - triangle.m_vertices[0], triangle.m_vertices[2] - triangle.m_vertices[0]);
+
+		out_.isHit         = 1;
+		out_.position      = _ray.origin + _ray.direction * _distance;
+		out_.normal        = Normalize(TransformDirection(Transpose(_instance->worldInverse), normal));
+		out_.distance      = _distance;
+		out_.barycentrics  = _barycentrics;
+		out_.instance      = _instance;
+		out_.triangleIndex = _triangleIndex;
+		out_.meshData      = _instance->meshData;
 	}
 
 	static void ThreadFunc(RaytracingRenderer::Impl* _impl)
@@ -224,14 +406,25 @@ void RaytracingRenderer::update()
 	{
 		for (Instance* instance : it.second)
 		{
+			const mat4 world = instance->sceneNode->getWorld();
+			if (world == instance->world)
+			{
+				continue;
+			}
+			instance->world = world;
+			instance->worldInverse = Inverse(world);
+			m_impl->tlasDirty = true;
+
 			// Calling setGlobalPose() on static actors may incur a performance penalty, so only do it if the pose changed.
-			const physx::PxTransform world = Mat4ToPxTransform(instance->sceneNode->getWorld());
-			if (!(world == instance->pxRigidActor->getGlobalPose()))
+			const physx::PxTransform pxWorld = Mat4ToPxTransform(world);
+			if (!(pxWorld == instance->pxRigidActor->getGlobalPose()))
 			{
-				instance->pxRigidActor->setGlobalPose(world);
+				instance->pxRigidActor->setGlobalPose(pxWorld);
 			}
 		}
 	}
+
+	updateTLAS();
 }
 
 void RaytracingRenderer::drawDebug()
@@ -242,6 +435,8 @@ void RaytracingRenderer::drawDebug()
 	{
 		ImGui::Text("# instances: %u", m_impl->instancePool.getUsedCount());
 		ImGui::Text("# mesh data: %u", m_impl->meshDataPool.getUsedCount());
+		ImGui::Text("TLAS: %u nodes, depth %u", m_impl->tlas.getNodeCount(), m_impl->tlas.getDepth());
+		ImGui::Checkbox("Use PhysX", &m_impl->usePhysX);
 		ImGui::PlotHistogram("Jobs/thread", m_impl->jobsPerThread.data(), (int)m_impl->jobsPerThread.size(), 0, nullptr, 0, 2048, ImVec2(0, 100));
 
 		ImGui::End();
@@ -301,49 +496,59 @@ return;
 	Im3d::PopDrawState();
 }
 
-bool RaytracingRenderer::raycast(const Ray& _in, RayHit& out_)
+bool RaytracingRenderer::raycast(const Ray& _in, RayHit& out_, bool _anyHit)
 {
-	physx::PxRaycastBuffer queryResult;
-	physx::PxHitFlags flags = (physx::PxHitFlags)0
-		| physx::PxHitFlag::ePOSITION
-		| physx::PxHitFlag::eNORMAL
-		//| physx::PxHitFlag::eMESH_ANY
-		| physx::PxHitFlag::eFACE_INDEX
-		;
-
-	if (!m_impl->pxScene->raycast(Vec3ToPx(_in.origin), Vec3ToPx(_in.direction), _in.maxDistance, queryResult) || !queryResult.hasBlock)
+	updateTLAS();
+
+	if (!m_impl->usePhysX)
 	{
-		return false;
+		return m_impl->raycastBVH(_in, 0, _anyHit, out_);
 	}
 
-	out_.position      = PxToVec3(queryResult.block.position);
-	out_.normal        = PxToVec3(queryResult.block.normal);
-	out_.distance      = queryResult.block.distance;
-	out_.triangleIndex = queryResult.block.faceIndex;
-
-	return true;
+	m_impl->raycastPhysX(&_in, &out_, 0, 1, _anyHit);
+	return out_.isHit != 0;
 }
 
-void RaytracingRenderer::raycast(const Ray* _in, RayHit* out_, size_t _count)
+void RaytracingRenderer::raycast(const Ray* _in, RayHit* out_, size_t _count, bool _anyHit)
 {
 	PROFILER_MARKER_CPU("RaytracingRenderer::rayCast");
 
+	updateTLAS();
+
 	m_impl->jobsPerThread.assign(m_impl->jobsPerThread.size(), 0.0f);
 
+	// Close the batch with a new generation before modifying it (claims of the previous batch fail from here on), then open it.
 	Impl::RayJobList& rayJobs = m_impl->rayJobs;
-	rayJobs.raysIn  = _in;
-	rayJobs.raysOut = out_;
+	FRM_ASSERT(_count < Impl::RayJobList::kClosed);
+	const uint64 generation = ((rayJobs.state.load() >> 32) + 1) << 32;
+	rayJobs.state.store(generation | Impl::RayJobList::kClosed);
+	rayJobs.raysIn.store(_in);
+	rayJobs.raysOut.store(out_);
+	rayJobs.anyHit.store(_anyHit);
 	rayJobs.count.store((uint32)_count);
-	rayJobs.readAt.store(0);
+	rayJobs.completed.store(0);
+	rayJobs.state.store(generation, std::memory_order_release);
 
 	while (m_impl->processJobs(m_impl->maxJobsPerThrad) != 0)
 	{
 		std::this_thread::yield();
 	}
 
-	// \todo Need to block here until all jobs have unlocked the pxScene. This is a hack to make sure all jobs are finished before we proceed to update the simulation.
-	m_impl->pxScene->lockWrite();
-	m_impl->pxScene->unlockWrite();
+	// Block until jobs claimed by other threads are complete.
+	while (rayJobs.completed.load() < (uint32)_count)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void RaytracingRenderer::setUsePhysX(bool _usePhysX)
+{
+	m_impl->usePhysX = _usePhysX;
+}
+
+bool RaytracingRenderer::getUsePhysX() const
+{
+	return m_impl->usePhysX;
 }
 
 void RaytracingRenderer::sortRayHits(RayHit* _hits_, size_t _count)
@@ -470,7 +675,6 @@ bool RaytracingRenderer::addInstances(BasicRenderableComponent* _renderable)
 	const PathStr meshPath = _renderable->getMesh()->getPath();
 	Mesh* mesh = Mesh::Create(meshPath.c_str(), Mesh::CreateFlags(0));
 	FRM_ASSERT(mesh);
-	const DateTime meshDate = FileSystem::GetTimeModified(meshPath.c_str());
 
 	// Generate 1 instance per submesh.
 	Impl::SceneMap& sceneMap = m_impl->sceneMap;
@@ -497,17 +701,13 @@ bool RaytracingRenderer::addInstances(BasicRenderableComponent* _renderable)
 			
 			File cachedData;
 			PathStr cachedPath = PathStr("_cache/%s_%d.raytracing", FileSystem::GetFileName(meshPath.c_str()).c_str(), submeshIndex);
-			if (FileSystem::Exists(cachedPath.c_str()))
-			{			
-				const DateTime cachedDate = FileSystem::GetTimeModified(cachedPath.c_str());
-				if (meshDate <= cachedDate)
+			if (FileSystem::IsCacheValid(cachedPath.c_str(), meshPath.c_str()))
+			{
+				FRM_LOG("RaytracingRenderer: Loading cached data '%s'", cachedPath.c_str());
+				if (!FileSystem::Read(cachedData, cachedPath.c_str()))
 				{
-					FRM_LOG("RaytracingRenderer: Loading cached data '%s'", cachedPath.c_str());
-					if (!FileSystem::Read(cachedData, cachedPath.c_str()))
-					{
-						FRM_LOG_ERR("RaytracingRenderer: Error loading cached data '%s'", cachedPath.c_str());
-						continue;
-					}
+					FRM_LOG_ERR("RaytracingRenderer: Error loading cached data '%s'", cachedPath.c_str());
+					continue;
 				}
 			}
 	
@@ -566,7 +766,10 @@ bool RaytracingRenderer::addInstances(BasicRenderableComponent* _renderable)
 					continue;
 				}
 				cachedData.setData((const char*)pxOutput.getData(), pxOutput.getSize()); // \todo avoid this copy?
-				FileSystem::Write(cachedData, cachedPath.c_str());
+				if (FileSystem::Write(cachedData, cachedPath.c_str()))
+				{
+					FileSystem::SetCacheSource(cachedPath.c_str(), meshPath.c_str());
+				}
 			}
 				
 			physx::PxDefaultMemoryInputData pxInput((physx::PxU8*)cachedData.getData(), (physx::PxU32)cachedData.getDataSize() - 1);
@@ -592,6 +795,24 @@ bool RaytracingRenderer::addInstances(BasicRenderableComponent* _renderable)
 				FRM_ASSERT(mesh->getIndexDataType() == DataType_Uint32); // \todo Convert 16 bit indices.
 				meshData->bfIndexData = Buffer::Create(GL_SHADER_STORAGE_BUFFER, (GLsizei)(sizeof(uint32) * mesh->getIndexCount(0, submeshIndex)), 0, mesh->getIndexData(0, submeshIndex));
 			}
+
+			// Build BLAS.
+			{
+				const uint32  triangleCount = (uint32)mesh->getIndexCount(0, submeshIndex) / 3;
+				const uint32* indices       = (const uint32*)mesh->getIndexData(0, submeshIndex);
+				Mesh::VertexDataView<vec3> positionsView = mesh->getVertexDataView<vec3>(Mesh::Semantic_Positions);
+
+				eastl::vector<AlignedBox> triangleBounds(triangleCount);
+				meshData->triangles.resize(triangleCount);
+				for (uint32 i = 0; i < triangleCount; ++i)
+				{
+					const Triangle triangle(positionsView[indices[i * 3]], positionsView[indices[i * 3 + 1]], positionsView[indices[i * 3 + 2]]);
+					meshData->triangles[i] = triangle;
+					triangleBounds[i].m_min = Min(triangle.m_vertices[0], Min(triangle.m_vertices[1], triangle.m_vertices[2]));
+					triangleBounds[i].m_max = Max(triangle.m_vertices[0], Max(triangle.m_vertices[1], triangle.m_vertices[2]));
+				}
+				meshData->blas.build(triangleBounds.data(), triangleCount);
+			}
 		}
 		
 		instance->meshData = meshData;
@@ -601,6 +822,10 @@ bool RaytracingRenderer::addInstances(BasicRenderableComponent* _renderable)
 		meshData->pxGeometry.triangleMesh().scale = physx::PxMeshScale(Vec3ToPx(nodeScale));
 		instance->pxShape = g_pxPhysics->createShape(meshData->pxGeometry.any(), *m_impl->pxMaterial, true, physx::PxShapeFlag::eVISUALIZATION | physx::PxShapeFlag::eSCENE_QUERY_SHAPE);
 
+		instance->world        = sceneNode->getWorld();
+		instance->worldInverse = Inverse(instance->world);
+		m_impl->tlasDirty      = true;
+
 		instance->pxRigidActor = g_pxPhysics->createRigidStatic(Mat4ToPxTransform(sceneNode->getInitial()));
 		instance->pxRigidActor->setActorFlag(physx::PxActorFlag::eVISUALIZATION, true); // \todo enable/disable for all actors when toggling debug draw?
 		instance->pxRigidActor->userData = instance;
@@ -649,6 +874,35 @@ void RaytracingRenderer::removeInstances(BasicRenderableComponent* _renderable)
 		m_impl->instancePool.free(instance);
 	}
 	m_impl->sceneMap.erase(it);
+	m_impl->tlasDirty = true;
+}
+
+void RaytracingRenderer::updateTLAS()
+{
+	if (!m_impl->tlasDirty)
+	{
+		return;
+	}
+	PROFILER_MARKER_CPU("RaytracingRenderer::updateTLAS");
+
+	m_impl->tlasInstances.clear();
+	eastl::vector<AlignedBox> instanceBounds;
+	for (auto& it : m_impl->sceneMap)
+	{
+		for (Instance* instance : it.second)
+		{
+			if (!instance->meshData || instance->meshData->blas.isEmpty())
+			{
+				continue;
+			}
+			AlignedBox bounds = instance->meshData->blas.getBounds();
+			bounds.transform(instance->world);
+			instanceBounds.push_back(bounds);
+			m_impl->tlasInstances.push_back(instance);
+		}
+	}
+	m_impl->tlas.build(instanceBounds.data(), (uint32)instanceBounds.size(), 1);
+	m_impl->tlasDirty = false;
 }
 
 } // namespace
@@ -7,6 +7,10 @@ namespace frm {
 
 ////////////////////////////////////////////////////////////////////////////////
 // RaytracingRenderer
+// Rays are traced against a 2-level BVH: 1 BLAS per MeshData (triangles in 
+// mesh space) and a TLAS over the instances. Batch raycasts are traversed as
+// packets of coherent rays. The PhysX scene is retained as a reference (see
+// setUsePhysX()).
 //
 // \todo
 // - MeshData only needs to load copy the relevant verts for the submesh 
@@ -22,7 +26,8 @@ namespace frm {
 //   affects chart packing (need a static scene processor basically). Note that
 //   any scaling applied to an instance must also be applied to the static mesh
 //   before lightmap UV generation.
-// - Full GPU support (requires custom BVH + CS traversal).
+// - Full GPU support (CS traversal of the BVH).
+// - BLAS build is done for every mesh load, cache with the PhysX trimesh.
 ////////////////////////////////////////////////////////////////////////////////
 class RaytracingRenderer
 {
@@ -64,11 +69,16 @@ public:
 		float pad0;
 	};
 
-	// Perform a single raycast. Return true if intersection found.
-	bool raycast(const Ray& _in, RayHit& out_); 
+	// Perform a single raycast. Return true if intersection found. If _anyHit, return the first intersection found (not 
+	// necessarily the closest), e.g. for shadow rays.
+	bool raycast(const Ray& _in, RayHit& out_, bool _anyHit = false); 
 
-	// Perform a block of raycasts. _in and out_ must contain _count elements.
-	void raycast(const Ray* _in, RayHit* out_, size_t _count);
+	// Perform a block of raycasts. _in and out_ must contain _count elements. See raycast().
+	void raycast(const Ray* _in, RayHit* out_, size_t _count, bool _anyHit = false);
+
+	// Trace rays via the PhysX scene instead of the BVH (for validation).
+	void setUsePhysX(bool _usePhysX);
+	bool getUsePhysX() const;
 
 	// \todo Do this automatically at the end of raycast?
 	void sortRayHits(RayHit* _hits_, size_t _count);
@@ -94,6 +104,7 @@ protected:
 
 	bool addInstances(BasicRenderableComponent* _renderable);
 	void removeInstances(BasicRenderableComponent* _renderable);
+	void updateTLAS();
 };
 
 } // namespace frm
\ No newline at end of file
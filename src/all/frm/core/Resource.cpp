@@ -1,18 +1,37 @@
 #include "Resource.h"
 
 #include <frm/core/hash.h>
-#include <frm/core/log.h>
+#include <frm/core/Log.h>
+#include <frm/core/FileSystem.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/String.h>
 #include <frm/core/Time.h>
 
 #include <EASTL/algorithm.h>
 
 #include <cstdarg> // va_list
+#include <mutex>
+#define SCOPED_MUTEX_LOCK(mtx) std::lock_guard<std::mutex> FRM_UNIQUE_NAME(_scopedMutexLock)(mtx)
 
 #include <imgui/imgui.h>
 
 using namespace frm;
 
+template <typename tDerived>
+struct Resource<tDerived>::AsyncQueue
+{
+	struct Completed
+	{
+		Derived* inst;
+		bool     result; // Return value of loadAsync().
+	};
+
+	JobSystem::Counter       counter;         // Async jobs in flight.
+	int                      pendingCount = 0; // Async loads not yet finalized (main thread only).
+	std::mutex               mutex;           // Protects completed.
+	eastl::vector<Completed> completed;
+};
+
 // PUBLIC
 
 template <typename tDerived>
@@ -21,7 +40,7 @@ void Resource<tDerived>::Use(Derived* _inst_)
 	if (_inst_)
 	{
 		++(_inst_->m_refs);
-		if (_inst_->m_refs == 1 && _inst_->m_state != State_Loaded)
+		if (_inst_->m_refs == 1 && _inst_->m_state != State_Loaded && !_inst_->isAsyncPending())
 		{
 			_inst_->m_state = State_Error;
 			if (_inst_->load())
@@ -39,7 +58,7 @@ void Resource<tDerived>::Release(Derived*& _inst_)
 	{
 		--(_inst_->m_refs);
 		FRM_ASSERT(_inst_->m_refs >= 0);
-		if (_inst_->m_refs == 0)
+		if (_inst_->m_refs == 0 && !_inst_->isAsyncPending()) // else destroyed by Update()
 		{
 			Derived::Destroy(_inst_);
 		}
@@ -47,41 +66,100 @@ void Resource<tDerived>::Release(Derived*& _inst_)
 	}
 }
 
+template <typename tDerived>
+void Resource<tDerived>::UseAsync(Derived* _inst_)
+{
+	if (_inst_)
+	{
+		++(_inst_->m_refs);
+		if (_inst_->m_refs == 1 && _inst_->m_state != State_Loaded && !_inst_->isAsyncPending())
+		{
+			_inst_->m_state = State_Pending;
+			++s_asyncQueue.pendingCount;
+			JobSystem::Run(&LoadAsyncJob, _inst_, &s_asyncQueue.counter);
+		}
+	}
+}
+
 template <typename tDerived>
 bool Resource<tDerived>::ReloadAll()
 {
 	bool ret = true;
 	for (auto& inst : s_instances)
 	{
-		ret &= inst->reload();
+		if (!inst->isAsyncPending())
+		{
+			ret &= inst->reload();
+		}
 	}
 	return ret;
 }
 
 template <typename tDerived>
-tDerived* Resource<tDerived>::Find(Id _id)
+int Resource<tDerived>::Update()
 {
-	for (auto it = s_instances.begin(); it != s_instances.end(); ++it)
+	FRM_ASSERT(JobSystem::GetThreadIndex() <= 0);
+
+	eastl::vector<typename AsyncQueue::Completed> completed;
+	{	SCOPED_MUTEX_LOCK(s_asyncQueue.mutex);
+		eastl::swap(completed, s_asyncQueue.completed);
+	}
+
+	for (auto& it : completed)
 	{
-		if ((*it)->m_id == _id)
+		Derived* inst = it.inst;
+		--s_asyncQueue.pendingCount;
+		if (inst->m_refs == 0)
+		{
+		 // released while the load was in flight
+			inst->m_state = State_Unloaded;
+			Derived::Destroy(inst);
+			continue;
+		}
+		inst->m_state = State_Error;
+		if (it.result && inst->loadFinalize())
 		{
-			return *it;
+			inst->m_state = State_Loaded;
 		}
 	}
-	return nullptr;
+
+	return (int)completed.size();
+}
+
+template <typename tDerived>
+void Resource<tDerived>::WaitAsync()
+{
+	JobSystem::Wait(&s_asyncQueue.counter);
+	Update();
+}
+
+template <typename tDerived>
+int Resource<tDerived>::GetPendingCount()
+{
+	return s_asyncQueue.pendingCount;
+}
+
+template <typename tDerived>
+tDerived* Resource<tDerived>::Find(Id _id)
+{
+	auto it = s_idIndex.find(_id);
+	return it == s_idIndex.end() ? nullptr : it->second;
 }
 
 template <typename tDerived>
 tDerived* Resource<tDerived>::Find(const char* _name)
 {
-	for (auto it = s_instances.begin(); it != s_instances.end(); ++it)
+ // multiple instances may share a name, return the first in the instance list for consistency with GetInstance()
+	Derived* ret = nullptr;
+	auto range = s_nameIndex.equal_range(HashString<uint64>(_name));
+	for (auto it = range.first; it != range.second; ++it)
 	{
-		if ((*it)->m_name == _name)
+		if (it->second->m_name == _name && (!ret || it->second->m_index < ret->m_index))
 		{
-			return *it;
+			ret = it->second;
 		}
 	}
-	return nullptr;
+	return ret;
 }
 
 
@@ -101,6 +179,12 @@ typename Resource<tDerived>::Id Resource<tDerived>::GetHashId(const char* _str)
 	return (Id)HashString<uint32>(_str) << 32;
 }
 
+template <typename tDerived>
+typename Resource<tDerived>::Id Resource<tDerived>::GetPathId(const char* _path)
+{
+	return GetHashId(FileSystem::Resolve(_path).c_str());
+}
+
 template <typename tDerived>
 Resource<tDerived>::Resource(const char* _name)
 {
@@ -117,18 +201,26 @@ template <typename tDerived>
 Resource<tDerived>::~Resource()
 {
 	FRM_ASSERT(m_refs == 0); // resource still in use
-	auto it = eastl::find(s_instances.begin(), s_instances.end(), (Derived*)this);
+	FRM_ASSERT(!isAsyncPending());
+	auto idIt = s_idIndex.find(m_id);
+	if (idIt != s_idIndex.end() && idIt->second == (Derived*)this)
+	{
+		s_idIndex.erase(idIt);
+	}
+	removeNameIndex();
 	s_instances.back()->m_index = m_index;
-	s_instances.erase_unsorted(it);
+	s_instances.erase_unsorted(s_instances.begin() + m_index);
 }
 
 template <typename tDerived>
 void Resource<tDerived>::setNamef(const char* _fmt, ...)
 {	
+	removeNameIndex();
 	va_list args;
 	va_start(args, _fmt);
 	m_name.setfv(_fmt, args);
 	va_end(args);
+	s_nameIndex.insert(eastl::make_pair(HashString<uint64>(m_name.c_str()), (Derived*)this));
 }
 
 
@@ -136,6 +228,9 @@ void Resource<tDerived>::setNamef(const char* _fmt, ...)
 
 template <typename tDerived> uint32 Resource<tDerived>::s_nextUniqueId;
 template <typename tDerived> typename Resource<tDerived>::InstanceList Resource<tDerived>::s_instances;
+template <typename tDerived> typename Resource<tDerived>::IdIndex Resource<tDerived>::s_idIndex;
+template <typename tDerived> typename Resource<tDerived>::NameIndex Resource<tDerived>::s_nameIndex;
+template <typename tDerived> typename Resource<tDerived>::AsyncQueue Resource<tDerived>::s_asyncQueue;
 
 template <typename tDerived>
 void Resource<tDerived>::init(Id _id, const char* _name)
@@ -149,6 +244,33 @@ void Resource<tDerived>::init(Id _id, const char* _name)
 	m_refs = 0;
 	m_index = (int)s_instances.size();
 	s_instances.push_back((Derived*)this);
+	s_idIndex[_id] = (Derived*)this;
+	s_nameIndex.insert(eastl::make_pair(HashString<uint64>(m_name.c_str()), (Derived*)this));
+}
+
+template <typename tDerived>
+void Resource<tDerived>::removeNameIndex()
+{
+	auto range = s_nameIndex.equal_range(HashString<uint64>(m_name.c_str()));
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == (Derived*)this)
+		{
+			s_nameIndex.erase(it);
+			return;
+		}
+	}
+}
+
+template <typename tDerived>
+void Resource<tDerived>::LoadAsyncJob(void* _inst)
+{
+	Derived* inst = (Derived*)_inst;
+	inst->m_state = State_Loading;
+	const bool result = inst->loadAsync();
+
+	SCOPED_MUTEX_LOCK(s_asyncQueue.mutex);
+	s_asyncQueue.completed.push_back({ inst, result });
 }
 
 template <typename tDerived>
@@ -371,4 +493,23 @@ DECL_RESOURCE(Texture);
 	DECL_RESOURCE(PhysicsMaterial);
 	#include <frm/physics/PhysicsGeometry.h>
 	DECL_RESOURCE(PhysicsGeometry);
-#endif
\ No newline at end of file
+#endif
+
+void frm::UpdateResources()
+{
+	BasicMaterial::Update();
+	DrawMesh::Update();
+	SkeletonAnimation::Update();
+	Shader::Update();
+	SplinePath::Update();
+	Texture::Update();
+
+	#if FRM_MODULE_AUDIO
+		AudioData::Update();
+	#endif
+
+	#if FRM_MODULE_PHYSICS
+		PhysicsMaterial::Update();
+		PhysicsGeometry::Update();
+	#endif
+}
@@ -3,8 +3,11 @@
 #include <frm/core/frm.h>
 #include <frm/core/String.h>
 
+#include <EASTL/unordered_map.h>
 #include <EASTL/vector.h>
 
+#include <atomic>
+
 namespace frm {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -17,6 +20,18 @@ namespace frm {
 // refcount is 1. Calling Release() implicitly calls Destroy() when the 
 // refcount is 0.
 //
+// UseAsync() is the asynchronous version of Use(): loadAsync() is called on a
+// worker thread (JobSystem), then loadFinalize() is called on the main thread
+// during Update() (e.g. for GPU uploads). The default loadAsync() does nothing
+// and the default loadFinalize() calls load(), deriving classes override these
+// to move work off the main thread. Resources released while an async load is
+// in flight are destroyed during Update().
+//
+// Lookup by id or name is O(1) via hash indices. Resources loaded from a file
+// should use GetPathId(), which hashes the *resolved* path (see
+// FileSystem::Resolve()) such that different relative paths to the same file
+// map to the same resource.
+//
 // Deriving classes must:
 //   - Add an explicit instantiation to Resource.cpp.
 //   - Implement Create(), Destroy(), load(), reload().
@@ -24,9 +39,6 @@ namespace frm {
 //   - Correctly set the resource state during load(), reload().
 //
 // \todo
-// - Use of paths to generate resource IDs is generally flawed: the *resolved*
-//   file path should be used, not the relative path passed to the Create() 
-//   function.
 // - Refactor: 
 //   - Use dynamic binding rather than CRTP.
 //   - Specific resource base class for resources backed by a disk file, with
@@ -45,19 +57,34 @@ public:
 		State_Error,       // Failed to load.
 		State_Unloaded,    // Created but not loaded.
 		State_Loaded,      // Successfully loaded.
+		State_Pending,     // Async load queued (see UseAsync()).
+		State_Loading,     // Async load in progress on a worker thread.
 
 		State_Count
 	};
 	typedef int State;
 	
-	// Increment the reference count for _inst, load if 1.
+	// Increment the reference count for _inst, load if 1. Note that if an async load is pending (see UseAsync()) Use() doesn't block,
+	// the resource is returned in State_Pending/State_Loading until the load is finalized by Update(). Check getState() or call
+	// WaitAsync() if the resource must be loaded.
 	static void     Use(Derived* _inst_);
+	// Increment the reference count for _inst_, begin an async load if 1. The resource is State_Pending/State_Loading until the 
+	// load is finalized by Update().
+	static void     UseAsync(Derived* _inst_);
 	// Decrement the reference count for _inst_, destroy if 0.
 	static void     Release(Derived*& _inst_);
 
-	// Call reload() on all instances. Return true if *all* instances were successfully reloaded, false if any failed.
+	// Call reload() on all instances. Return true if *all* instances were successfully reloaded, false if any failed. Instances with
+	// an async load in flight are skipped.
 	static bool     ReloadAll();
 
+	// Finalize completed async loads (main thread only). Return the number of resources finalized.
+	static int      Update();
+	// Block until all async loads are complete, then call Update() (main thread only).
+	static void     WaitAsync();
+	// Return the number of async loads which have not yet been finalized.
+	static int      GetPendingCount();
+
 	static bool     Load(Derived* _inst_)            { return _inst_->load(); }
 	static bool     Reload(Derived* _inst_)          { return _inst_->reload(); }
 
@@ -69,6 +96,7 @@ public:
 
 	static Derived* Find(Id _id);
 	static Derived* Find(const char* _name);
+	static Derived* FindPath(const char* _path)      { return Find(GetPathId(_path)); }
 	static int      GetInstanceCount()               { return (int)s_instances.size(); }
 	static Derived* GetInstance(int _index)          { FRM_ASSERT(_index < GetInstanceCount()); return s_instances[_index]; }
 	static const char* GetClassName()                { return s_className; }
@@ -79,9 +107,10 @@ public:
 	Id              getId() const                    { return m_id; }
 	const char*     getName() const                  { return (const char*)m_name; }
 	State           getState() const                 { return m_state; }
+	bool            isAsyncPending() const           { State state = m_state; return state == State_Pending || state == State_Loading; }
 	sint64          getRefCount() const              { return m_refs; }
 
-	void            setName(const char* _name)       { setNamef(_name); }
+	void            setName(const char* _name)       { setNamef("%s", _name); }
 	void            setNamef(const char* _fmt, ...);
 
 	// \hack Dummy method Select().
@@ -91,9 +120,9 @@ protected:
 
 	static Id       GetUniqueId();
 	static Id       GetHashId(const char* _str);
+	static Id       GetPathId(const char* _path);
 	
 	typedef frm::String<32> NameStr;
-	NameStr m_name;
 
 	Resource(const char* _name);
 	Resource(Id _id, const char* _name);
@@ -101,6 +130,10 @@ protected:
 
 	void setState(State _state) { m_state = _state; }
 
+	// Default async load implementation, see UseAsync().
+	bool loadAsync()            { return true; }
+	bool loadFinalize()         { return static_cast<Derived*>(this)->load(); }
+
 private:
 
 	struct InstanceList: public eastl::vector<Derived*>
@@ -109,16 +142,28 @@ private:
 		InstanceList(): BaseType() {}
 		~InstanceList(); // dtor used to check resources were correctly released
 	};
+	struct AsyncQueue;
+	typedef eastl::unordered_map<Id, Derived*>          IdIndex;
+	typedef eastl::unordered_multimap<uint64, Derived*> NameIndex; // Keyed by the name hash.
+
 	static const char*  s_className;
 	static InstanceList s_instances;
+	static IdIndex      s_idIndex;
+	static NameIndex    s_nameIndex;
+	static AsyncQueue   s_asyncQueue;
 	static uint32       s_nextUniqueId;
-	State               m_state;
+	NameStr             m_name; // Private, modify via setName() so that the name index is updated.
+	std::atomic<State>  m_state;
 	int                 m_index;
 	Id                  m_id;
 	sint64              m_refs;
 
 	void init(Id _id, const char* _name);
 
+	void removeNameIndex();
+
+	static void LoadAsyncJob(void* _inst);
+
 }; // class Resource
 
 template <typename tResourceType>
@@ -127,6 +172,9 @@ bool CheckResource(const tResourceType* _resource)
 	return _resource && _resource->getState() != tResourceType::State_Error;
 }
 
+// Finalize completed async loads for all resource types (see Resource::UseAsync()). Call once per frame on the main thread.
+void UpdateResources();
+
 void ShowResourceViewer(bool* _open_);
 
 } // namespace frm
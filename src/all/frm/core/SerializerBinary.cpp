@@ -0,0 +1,759 @@
+#include "SerializerBinary.h"
+
+#include <frm/core/memory.h>
+#include <frm/core/compress.h>
+#include <frm/core/File.h>
+#include <frm/core/Log.h>
+
+#include <cstdlib>
+
+namespace frm {
+
+namespace {
+
+struct Header
+{
+	char   magic[4];
+	uint16 version;
+	uint16 flags;
+	uint32 bodySizeBytes;
+	uint32 nameSizeBytes;
+};
+static_assert(sizeof(Header) == 16, "Header has padding");
+
+constexpr char kMagic[4] = { 'F', 'R', 'M', 'B' };
+
+enum HeaderFlags_
+{
+	HeaderFlags_Compressed = 1 << 0, // Header is followed by the compressed size (uint32) and the compressed body + name table.
+};
+
+constexpr uint32 kObjectHeaderSizeBytes = 8; // uint32 size, uint32 count
+constexpr uint32 kArrayHeaderSizeBytes  = 9; // uint32 size, uint32 count, uint8 packed type
+constexpr uint32 kBinaryHeaderSizeBytes = 5; // uint8 compressed, uint32 size
+
+} // namespace
+
+template <> SerializerBinary::Type SerializerBinary::TypeOf<bool>()    { return Type_Bool;    }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<sint8>()   { return Type_Sint8;   }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<uint8>()   { return Type_Uint8;   }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<sint16>()  { return Type_Sint16;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<uint16>()  { return Type_Uint16;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<sint32>()  { return Type_Sint32;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<uint32>()  { return Type_Uint32;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<sint64>()  { return Type_Sint64;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<uint64>()  { return Type_Uint64;  }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<float32>() { return Type_Float32; }
+template <> SerializerBinary::Type SerializerBinary::TypeOf<float64>() { return Type_Float64; }
+
+uint32 SerializerBinary::GetTypeSizeBytes(Type _type)
+{
+	switch (_type)
+	{
+		case Type_Bool:
+		case Type_Sint8:
+		case Type_Uint8:   return 1;
+		case Type_Sint16:
+		case Type_Uint16:  return 2;
+		case Type_Sint32:
+		case Type_Uint32:
+		case Type_Float32: return 4;
+		case Type_Sint64:
+		case Type_Uint64:
+		case Type_Float64: return 8;
+		default:           FRM_ASSERT(false); return 0;
+	};
+}
+
+// PUBLIC
+
+bool SerializerBinary::Read(SerializerBinary& serializer_, const File& _file)
+{
+	if (!IsBinary(_file))
+	{
+		FRM_LOG_ERR("SerializerBinary: %s\n\tInvalid header", _file.getPath());
+		return false;
+	}
+
+	const char* data = _file.getData();
+	const uint32 dataSizeBytes = (uint32)_file.getDataSize() - 1; // exclude the null terminator appended by File::Read()
+	Header header;
+	memcpy(&header, data, sizeof(Header));
+	if (header.version != kVersion)
+	{
+		FRM_LOG_ERR("SerializerBinary: %s\n\tVersion was %u (expected %u)", _file.getPath(), (unsigned)header.version, (unsigned)kVersion);
+		return false;
+	}
+	data += sizeof(Header);
+
+	const uint32 payloadSizeBytes = header.bodySizeBytes + header.nameSizeBytes;
+	void* decompressed = nullptr;
+	if (header.flags & HeaderFlags_Compressed)
+	{
+		uint32 compressedSizeBytes = 0;
+		if (dataSizeBytes >= sizeof(Header) + sizeof(uint32))
+		{
+			memcpy(&compressedSizeBytes, data, sizeof(uint32));
+			data += sizeof(uint32);
+		}
+		if (compressedSizeBytes == 0 || sizeof(Header) + sizeof(uint32) + compressedSizeBytes > dataSizeBytes)
+		{
+			FRM_LOG_ERR("SerializerBinary: %s\n\tUnexpected end of file", _file.getPath());
+			return false;
+		}
+		uint decompressedSizeBytes = 0;
+		Decompress(data, compressedSizeBytes, decompressed, decompressedSizeBytes);
+		if (decompressedSizeBytes != payloadSizeBytes)
+		{
+			FRM_LOG_ERR("SerializerBinary: %s\n\tDecompressed size was %u (expected %u)", _file.getPath(), (unsigned)decompressedSizeBytes, (unsigned)payloadSizeBytes);
+			free(decompressed);
+			return false;
+		}
+		data = (const char*)decompressed;
+	}
+	else if (sizeof(Header) + payloadSizeBytes > dataSizeBytes)
+	{
+		FRM_LOG_ERR("SerializerBinary: %s\n\tUnexpected end of file", _file.getPath());
+		return false;
+	}
+
+	serializer_.m_body.assign(data, data + header.bodySizeBytes);
+	serializer_.m_nameData.assign(data + header.bodySizeBytes, data + payloadSizeBytes);
+	if (decompressed)
+	{
+		free(decompressed);
+	}
+
+	bool ret = serializer_.m_nameData.empty() || serializer_.m_nameData.back() == '\0';
+	if (ret)
+	{
+		serializer_.m_nameOffsets.clear();
+		serializer_.m_nameMap.clear();
+		for (uint32 offset = 0; offset < (uint32)serializer_.m_nameData.size(); )
+		{
+			const char* name = serializer_.m_nameData.data() + offset;
+			serializer_.m_nameMap[StringHash(name)] = (uint16)serializer_.m_nameOffsets.size();
+			serializer_.m_nameOffsets.push_back(offset);
+			offset += (uint32)strlen(name) + 1;
+		}
+		ret = serializer_.m_nameOffsets.size() < kNoName;
+	}
+	if (!ret)
+	{
+		FRM_LOG_ERR("SerializerBinary: %s\n\tInvalid name table", _file.getPath());
+		serializer_.m_body.clear();
+		serializer_.m_nameData.clear();
+	}
+
+	serializer_.m_mode = Mode_Read; // bypass onModeChange(), which would discard the data
+	serializer_.reset();
+
+	return ret;
+}
+
+bool SerializerBinary::Write(const SerializerBinary& _serializer, File& file_, CompressionFlags _compressionFlags)
+{
+	FRM_ASSERT(_serializer.getMode() == Mode_Write);
+	FRM_ASSERT(_serializer.m_scopes.size() == 1); // missing endObject()/endArray()
+
+	const uint32 bodySizeBytes = (uint32)_serializer.m_body.size();
+	const uint32 nameSizeBytes = (uint32)_serializer.m_nameData.size();
+
+	Header header;
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version       = (uint16)kVersion;
+	header.flags         = 0;
+	header.bodySizeBytes = bodySizeBytes;
+	header.nameSizeBytes = nameSizeBytes;
+
+	// File data is expected to be null terminated (the terminator is stripped by File::Write()).
+	eastl::vector<char> data;
+	if (_compressionFlags != CompressionFlags_None && bodySizeBytes + nameSizeBytes > 0)
+	{
+		eastl::vector<char> payload;
+		payload.reserve(bodySizeBytes + nameSizeBytes);
+		payload.insert(payload.end(), _serializer.m_body.begin(), _serializer.m_body.end());
+		payload.insert(payload.end(), _serializer.m_nameData.begin(), _serializer.m_nameData.end());
+
+		void* compressed = nullptr;
+		uint compressedSizeBytes = 0;
+		Compress(payload.data(), (uint)payload.size(), compressed, compressedSizeBytes, _compressionFlags);
+		header.flags |= HeaderFlags_Compressed;
+
+		const uint32 compressedSizeBytes32 = (uint32)compressedSizeBytes;
+		data.reserve(sizeof(Header) + sizeof(uint32) + compressedSizeBytes + 1);
+		data.insert(data.end(), (const char*)&header, (const char*)&header + sizeof(Header));
+		data.insert(data.end(), (const char*)&compressedSizeBytes32, (const char*)&compressedSizeBytes32 + sizeof(uint32));
+		data.insert(data.end(), (const char*)compressed, (const char*)compressed + compressedSizeBytes);
+		free(compressed);
+	}
+	else
+	{
+		data.reserve(sizeof(Header) + bodySizeBytes + nameSizeBytes + 1);
+		data.insert(data.end(), (const char*)&header, (const char*)&header + sizeof(Header));
+		data.insert(data.end(), _serializer.m_body.begin(), _serializer.m_body.end());
+		data.insert(data.end(), _serializer.m_nameData.begin(), _serializer.m_nameData.end());
+	}
+	data.push_back('\0');
+
+	file_.setData(data.data(), (uint)data.size());
+	return true;
+}
+
+bool SerializerBinary::IsBinary(const File& _file)
+{
+	return _file.getDataSize() >= sizeof(Header) && memcmp(_file.getData(), kMagic, sizeof(kMagic)) == 0;
+}
+
+SerializerBinary::SerializerBinary(Mode _mode)
+	: Serializer(_mode)
+{
+	reset();
+}
+
+bool SerializerBinary::beginObject(const char* _name)
+{
+	if (m_mode == Mode_Read)
+	{
+		Record record;
+		if (!readRecord(_name, record) || record.type != Type_Object)
+		{
+			return false;
+		}
+
+		Scope scope;
+		scope.header = record.data;
+		scope.begin  = record.data + kObjectHeaderSizeBytes;
+		scope.end    = record.end;
+		scope.cursor = scope.begin;
+		scope.count  = readAt<uint32>(record.data + sizeof(uint32));
+		m_scopes.push_back(scope);
+	}
+	else
+	{
+		writeRecordHeader(Type_Object, _name);
+
+		Scope scope;
+		scope.header = (uint32)m_body.size();
+		writeData<uint32>(0); // size, patched by endObject()
+		writeData<uint32>(0); // count, patched by endObject()
+		scope.begin  = (uint32)m_body.size();
+		m_scopes.push_back(scope);
+	}
+
+	return true;
+}
+
+void SerializerBinary::endObject()
+{
+	FRM_ASSERT(m_scopes.size() > 1 && !m_scopes.back().isArray);
+
+	if (m_mode == Mode_Write)
+	{
+		const Scope& scope = m_scopes.back();
+		writeAt<uint32>(scope.header, (uint32)m_body.size() - scope.begin);
+		writeAt<uint32>(scope.header + sizeof(uint32), scope.count);
+	}
+	m_scopes.pop_back();
+}
+
+bool SerializerBinary::beginArray(uint& _length_, const char* _name)
+{
+	if (m_mode == Mode_Read)
+	{
+		Record record;
+		if (!readRecord(_name, record) || record.type != Type_Array)
+		{
+			return false;
+		}
+
+		Scope scope;
+		scope.header     = record.data;
+		scope.begin      = record.data + kArrayHeaderSizeBytes;
+		scope.end        = record.end;
+		scope.cursor     = scope.begin;
+		scope.count      = readAt<uint32>(record.data + sizeof(uint32));
+		scope.packedType = readAt<Type>(record.data + sizeof(uint32) * 2);
+		scope.isArray    = true;
+		if (scope.packedType != Type_Count && (scope.packedType >= Type_String || (scope.end - scope.begin) != scope.count * GetTypeSizeBytes(scope.packedType)))
+		{
+			setError("Error serializing array '%s': corrupt data", _name ? _name : "");
+			return false;
+		}
+		m_scopes.push_back(scope);
+		_length_ = (uint)scope.count;
+	}
+	else
+	{
+		writeRecordHeader(Type_Array, _name);
+
+		Scope scope;
+		scope.header  = (uint32)m_body.size();
+		writeData<uint32>(0);     // size, patched by endArray()
+		writeData<uint32>(0);     // count, patched by endArray()
+		writeData<Type>(Type_Count); // packed type, patched by endArray()
+		scope.begin   = (uint32)m_body.size();
+		scope.isArray = true;
+		m_scopes.push_back(scope);
+	}
+
+	return true;
+}
+
+void SerializerBinary::endArray()
+{
+	FRM_ASSERT(m_scopes.size() > 1 && m_scopes.back().isArray);
+
+	if (m_mode == Mode_Write)
+	{
+		const Scope& scope = m_scopes.back();
+
+		// If all members have the same scalar type, strip the per-member type to pack the array.
+		Type packedType = Type_Count;
+		if (scope.count > 0 && scope.packedType < Type_String)
+		{
+			packedType = scope.packedType;
+			const uint32 typeSizeBytes = GetTypeSizeBytes(packedType);
+			char* dst = m_body.data() + scope.begin;
+			const char* src = dst;
+			for (uint32 i = 0; i < scope.count; ++i)
+			{
+				FRM_STRICT_ASSERT((Type)*src == packedType);
+				++src;
+				memmove(dst, src, typeSizeBytes);
+				dst += typeSizeBytes;
+				src += typeSizeBytes;
+			}
+			m_body.resize(scope.begin + scope.count * typeSizeBytes);
+		}
+
+		writeAt<uint32>(scope.header, (uint32)m_body.size() - scope.begin);
+		writeAt<uint32>(scope.header + sizeof(uint32), scope.count);
+		writeAt<Type>(scope.header + sizeof(uint32) * 2, packedType);
+	}
+	m_scopes.pop_back();
+}
+
+const char* SerializerBinary::getName() const
+{
+	const uint16 name = m_scopes.back().name;
+	return name == kNoName ? "" : m_nameData.data() + m_nameOffsets[name];
+}
+
+uint32 SerializerBinary::getIndex() const
+{
+	return m_scopes.back().index;
+}
+
+template <typename tType>
+bool SerializerBinary::valueImpl(tType& _value_, const char* _name)
+{
+	if (m_mode == Mode_Read)
+	{
+		Record record;
+		if (!readRecord(_name, record))
+		{
+			return false;
+		}
+
+		// Convert from the written type, as per SerializerJson (which doesn't distinguish numeric types).
+		switch (record.type)
+		{
+			case Type_Bool:    _value_ = (tType)(readAt<uint8>(record.data) != 0); break;
+			case Type_Sint8:   _value_ = (tType)readAt<sint8>  (record.data);      break;
+			case Type_Uint8:   _value_ = (tType)readAt<uint8>  (record.data);      break;
+			case Type_Sint16:  _value_ = (tType)readAt<sint16> (record.data);      break;
+			case Type_Uint16:  _value_ = (tType)readAt<uint16> (record.data);      break;
+			case Type_Sint32:  _value_ = (tType)readAt<sint32> (record.data);      break;
+			case Type_Uint32:  _value_ = (tType)readAt<uint32> (record.data);      break;
+			case Type_Sint64:  _value_ = (tType)readAt<sint64> (record.data);      break;
+			case Type_Uint64:  _value_ = (tType)readAt<uint64> (record.data);      break;
+			case Type_Float32: _value_ = (tType)readAt<float32>(record.data);      break;
+			case Type_Float64: _value_ = (tType)readAt<float64>(record.data);      break;
+			default:
+				setError("Error serializing %s '%s': not a number", ValueTypeToStr<tType>(), _name ? _name : "");
+				return false;
+		};
+	}
+	else
+	{
+		writeRecordHeader(TypeOf<tType>(), _name);
+		if (TypeOf<tType>() == Type_Bool)
+		{
+			writeData<uint8>(_value_ ? 1 : 0);
+		}
+		else
+		{
+			writeData<tType>(_value_);
+		}
+	}
+
+	return true;
+}
+
+bool SerializerBinary::value(bool&    _value_, const char* _name) { return valueImpl<bool>   (_value_, _name); }
+bool SerializerBinary::value(sint8&   _value_, const char* _name) { return valueImpl<sint8>  (_value_, _name); }
+bool SerializerBinary::value(uint8&   _value_, const char* _name) { return valueImpl<uint8>  (_value_, _name); }
+bool SerializerBinary::value(sint16&  _value_, const char* _name) { return valueImpl<sint16> (_value_, _name); }
+bool SerializerBinary::value(uint16&  _value_, const char* _name) { return valueImpl<uint16> (_value_, _name); }
+bool SerializerBinary::value(sint32&  _value_, const char* _name) { return valueImpl<sint32> (_value_, _name); }
+bool SerializerBinary::value(uint32&  _value_, const char* _name) { return valueImpl<uint32> (_value_, _name); }
+bool SerializerBinary::value(sint64&  _value_, const char* _name) { return valueImpl<sint64> (_value_, _name); }
+bool SerializerBinary::value(uint64&  _value_, const char* _name) { return valueImpl<uint64> (_value_, _name); }
+bool SerializerBinary::value(float32& _value_, const char* _name) { return valueImpl<float32>(_value_, _name); }
+bool SerializerBinary::value(float64& _value_, const char* _name) { return valueImpl<float64>(_value_, _name); }
+
+bool SerializerBinary::value(StringBase& _value_, const char* _name)
+{
+	if (m_mode == Mode_Read)
+	{
+		Record record;
+		if (!readRecord(_name, record))
+		{
+			return false;
+		}
+		if (record.type != Type_String)
+		{
+			setError("Error serializing StringBase; '%s' not a string", _name ? _name : "");
+			return false;
+		}
+
+		const uint32 len = readAt<uint32>(record.data);
+		if (len == 0)
+		{
+			_value_.clear();
+		}
+		else
+		{
+			_value_.set(m_body.data() + record.data + sizeof(uint32), (int)len);
+		}
+	}
+	else
+	{
+		const uint32 len = (uint32)_value_.getLength();
+		writeRecordHeader(Type_String, _name);
+		writeData<uint32>(len);
+		writeData((const char*)_value_, len);
+	}
+
+	return true;
+}
+
+bool SerializerBinary::binary(void*& _data_, uint& _sizeBytes_, const char* _name, CompressionFlags _compressionFlags)
+{
+	if (m_mode == Mode_Read)
+	{
+		Record record;
+		if (!readRecord(_name, record))
+		{
+			return false;
+		}
+		if (record.type != Type_Binary)
+		{
+			setError("Error serializing %s; not binary data", _name ? _name : "");
+			return false;
+		}
+
+		const bool   compressed = readAt<uint8>(record.data) != 0;
+		const uint32 sizeBytes  = readAt<uint32>(record.data + 1);
+		const char*  data       = m_body.data() + record.data + kBinaryHeaderSizeBytes;
+
+		if (compressed && _data_)
+		{
+			// Decompress directly to the destination buffer.
+			struct Output
+			{
+				char* dst;
+				uint  remaining;
+
+				static bool Write(const void* _data, uint _sizeBytes, void* _output)
+				{
+					Output* output = (Output*)_output;
+					if (_sizeBytes > output->remaining)
+					{
+						return false;
+					}
+					memcpy(output->dst, _data, _sizeBytes);
+					output->dst += _sizeBytes;
+					output->remaining -= _sizeBytes;
+					return true;
+				}
+			};
+			Output output = { (char*)_data_, _sizeBytes_ };
+			Decompressor decompressor(&Output::Write, &output);
+			if (!decompressor.decompress(data, sizeBytes) || !decompressor.isComplete() || output.remaining != 0)
+			{
+				setError("Error serializing %s, buffer size was %llu (decompression failed or size mismatch)", _name ? _name : "", (unsigned long long)_sizeBytes_);
+				return false;
+			}
+			return true;
+		}
+
+		void* decompressed = nullptr;
+		uint  retSizeBytes = sizeBytes;
+		if (compressed)
+		{
+			Decompress(data, sizeBytes, decompressed, retSizeBytes);
+			data = (const char*)decompressed;
+		}
+
+		bool ret = true;
+		if (_data_)
+		{
+			if (retSizeBytes != _sizeBytes_)
+			{
+				setError("Error serializing %s, buffer size was %llu (expected %llu)", _name ? _name : "", (unsigned long long)_sizeBytes_, (unsigned long long)retSizeBytes);
+				ret = false;
+			}
+			else
+			{
+				memcpy(_data_, data, retSizeBytes);
+			}
+		}
+		else
+		{
+			_data_ = FRM_MALLOC(retSizeBytes);
+			memcpy(_data_, data, retSizeBytes);
+			_sizeBytes_ = retSizeBytes;
+		}
+
+		if (decompressed)
+		{
+			free(decompressed);
+		}
+		return ret;
+	}
+	else
+	{
+		FRM_ASSERT(_data_ || _sizeBytes_ == 0);
+		writeRecordHeader(Type_Binary, _name);
+		if (_compressionFlags != CompressionFlags_None && _sizeBytes_ > 0)
+		{
+			void* compressed = nullptr;
+			uint compressedSizeBytes = 0;
+			Compress(_data_, _sizeBytes_, compressed, compressedSizeBytes, _compressionFlags);
+			writeData<uint8>(1);
+			writeData<uint32>((uint32)compressedSizeBytes);
+			writeData(compressed, (uint32)compressedSizeBytes);
+			free(compressed);
+		}
+		else
+		{
+			writeData<uint8>(0);
+			writeData<uint32>((uint32)_sizeBytes_);
+			writeData(_data_, (uint32)_sizeBytes_);
+		}
+	}
+
+	return true;
+}
+
+// PRIVATE
+
+void SerializerBinary::onModeChange(Mode _mode)
+{
+	if (_mode == Mode_Write)
+	{
+		m_body.clear();
+		m_nameData.clear();
+		m_nameOffsets.clear();
+		m_nameMap.clear();
+	}
+	else
+	{
+		// Switching from write to read, read back the current body.
+		FRM_ASSERT(m_mode == Mode_Read || m_scopes.size() == 1); // missing endObject()/endArray()
+	}
+	reset();
+}
+
+void SerializerBinary::reset()
+{
+	// The body is the content of an implicit root object.
+	Scope root;
+	root.end    = (uint32)m_body.size();
+	root.cursor = 0;
+	root.count  = 0;
+	m_scopes.clear();
+	m_scopes.push_back(root);
+}
+
+uint16 SerializerBinary::addName(const char* _name)
+{
+	const StringHash hash(_name);
+	auto it = m_nameMap.find(hash);
+	if (it != m_nameMap.end())
+	{
+		return it->second;
+	}
+
+	const uint16 ret = (uint16)m_nameOffsets.size();
+	FRM_ASSERT(ret < kNoName); // too many unique names
+	m_nameOffsets.push_back((uint32)m_nameData.size());
+	m_nameData.insert(m_nameData.end(), _name, _name + strlen(_name) + 1);
+	m_nameMap[hash] = ret;
+	return ret;
+}
+
+void SerializerBinary::writeRecordHeader(Type _type, const char* _name)
+{
+	Scope& scope = m_scopes.back();
+	writeData<Type>(_type);
+	if (scope.isArray)
+	{
+		// Array members are anonymous (the name is ignored, as per SerializerJson). Track whether the array can be packed.
+		if (scope.count == 0)
+		{
+			scope.packedType = _type < Type_String ? _type : (Type)Type_Mixed;
+		}
+		else if (scope.packedType != _type)
+		{
+			scope.packedType = Type_Mixed;
+		}
+		scope.name = kNoName;
+	}
+	else
+	{
+		scope.name = _name ? addName(_name) : (uint16)kNoName;
+		writeData<uint16>(scope.name);
+	}
+	++scope.count;
+	++scope.index;
+}
+
+void SerializerBinary::writeData(const void* _data, uint32 _sizeBytes)
+{
+	const char* data = (const char*)_data;
+	m_body.insert(m_body.end(), data, data + _sizeBytes);
+}
+
+uint16 SerializerBinary::findName(const char* _name) const
+{
+	auto it = m_nameMap.find(StringHash(_name));
+	return it == m_nameMap.end() ? (uint16)kNoName : it->second;
+}
+
+bool SerializerBinary::parseRecord(const Scope& _scope, uint32 _offset, Record& record_)
+{
+	if (_scope.packedType != Type_Count)
+	{
+		record_.type = _scope.packedType;
+		record_.name = kNoName;
+		record_.data = _offset;
+		record_.end  = _offset + GetTypeSizeBytes(_scope.packedType);
+		return true; // size was validated by beginArray()
+	}
+
+	const uint32 recordHeaderSizeBytes = _scope.isArray ? sizeof(Type) : sizeof(Type) + sizeof(uint16);
+	if (_offset + recordHeaderSizeBytes > _scope.end)
+	{
+		setError("Error serializing: corrupt data");
+		return false;
+	}
+	record_.type = readAt<Type>(_offset);
+	record_.name = _scope.isArray ? kNoName : readAt<uint16>(_offset + sizeof(Type));
+	record_.data = _offset + recordHeaderSizeBytes;
+
+	uint32 headerSizeBytes = 0;
+	switch (record_.type)
+	{
+		default:
+			if (record_.type < Type_String)
+			{
+				record_.end = record_.data + GetTypeSizeBytes(record_.type);
+				break;
+			}
+			setError("Error serializing: corrupt data (invalid type %u)", (unsigned)record_.type);
+			return false;
+		case Type_String: headerSizeBytes = sizeof(uint32);         break;
+		case Type_Binary: headerSizeBytes = kBinaryHeaderSizeBytes; break;
+		case Type_Object: headerSizeBytes = kObjectHeaderSizeBytes; break;
+		case Type_Array:  headerSizeBytes = kArrayHeaderSizeBytes;  break;
+	};
+
+	if (headerSizeBytes > 0)
+	{
+		if (record_.data + headerSizeBytes > _scope.end)
+		{
+			setError("Error serializing: corrupt data");
+			return false;
+		}
+		const uint32 sizeOffset = record_.type == Type_Binary ? 1 : 0;
+		record_.end = record_.data + headerSizeBytes + readAt<uint32>(record_.data + sizeOffset);
+	}
+
+	if (record_.end > _scope.end || record_.end < record_.data)
+	{
+		setError("Error serializing: corrupt data");
+		return false;
+	}
+	if (record_.name != kNoName && record_.name >= (uint16)m_nameOffsets.size())
+	{
+		setError("Error serializing: corrupt data (invalid name index %u)", (unsigned)record_.name);
+		return false;
+	}
+
+	return true;
+}
+
+bool SerializerBinary::readRecord(const char* _name, Record& record_)
+{
+	Scope& scope = m_scopes.back();
+
+	if (_name && !scope.isArray)
+	{
+		const uint16 name = findName(_name);
+		if (name == kNoName)
+		{
+			return false; // name doesn't appear anywhere in the stream
+		}
+
+		// Scan from the cursor to the end of the scope, then wrap to the beginning. In the common case the values are read in the
+		// written order and the first record matches.
+		uint32 offset  = scope.cursor;
+		uint32 index   = scope.index + 1;
+		bool   wrapped = false;
+		for (;;)
+		{
+			if (offset >= scope.end)
+			{
+				if (wrapped || scope.cursor == scope.begin)
+				{
+					return false;
+				}
+				offset  = scope.begin;
+				index   = 0;
+				wrapped = true;
+			}
+			if (wrapped && offset >= scope.cursor)
+			{
+				return false;
+			}
+			if (!parseRecord(scope, offset, record_))
+			{
+				return false;
+			}
+			if (record_.name == name)
+			{
+				break;
+			}
+			offset = record_.end;
+			++index;
+		}
+		scope.index = index;
+	}
+	else
+	{
+		if (scope.cursor >= scope.end || !parseRecord(scope, scope.cursor, record_))
+		{
+			return false;
+		}
+		++scope.index;
+	}
+
+	scope.cursor = record_.end;
+	scope.name   = record_.name;
+	return true;
+}
+
+} // namespace frm
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <frm/core/frm.h>
+#include <frm/core/Serializer.h>
+#include <frm/core/StringHash.h>
+
+#include <EASTL/vector.h>
+#include <EASTL/vector_map.h>
+
+#include <cstring>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// SerializerBinary
+// Compact binary serializer with the same semantics as SerializerJson.
+//
+// Stream layout (little endian):
+//   Header      magic 'FRMB', version, flags, body/name table sizes.
+//   Body        Sequence of values. Object members are prefixed with a type and
+//               a name index, array members with a type only. Arrays whose
+//               members have the same scalar type are packed (a single type
+//               followed by the raw values). Objects/arrays store their size in
+//               bytes so that unknown values can be skipped.
+//   Name table  Unique value names, referenced by index from the body.
+// If the stream is compressed the body and name table are compressed together.
+//
+// Reads in the written order are sequential; named values are found by
+// scanning forward from the current position (wrapping to the start of the
+// current object), hence reading members in a different order, or missing
+// members, is slower but still valid.
+//
+// Use IsBinary() to distinguish a binary stream from Json (e.g. when loading
+// cached data which may have been written by an older version).
+////////////////////////////////////////////////////////////////////////////////
+class SerializerBinary: public Serializer
+{
+public:
+
+	static constexpr uint32 kVersion = 1;
+
+	// Load a stream from _file and set Mode_Read. Return false if _file is not a valid stream.
+	static bool Read(SerializerBinary& serializer_, const File& _file);
+
+	// Write the stream to file_. All objects/arrays must have been closed.
+	static bool Write(const SerializerBinary& _serializer, File& file_, CompressionFlags _compressionFlags = CompressionFlags_None);
+
+	// Return true if _file begins with a valid header.
+	static bool IsBinary(const File& _file);
+
+	SerializerBinary(Mode _mode = Mode_Write);
+
+	bool        beginObject(const char* _name = nullptr) override;
+	void        endObject() override;
+
+	bool        beginArray(uint& _length_, const char* _name = nullptr) override;
+	void        endArray() override;
+
+	const char* getName() const override;
+	uint32      getIndex() const override;
+
+	bool        value(bool&       _value_, const char* _name = nullptr) override;
+	bool        value(sint8&      _value_, const char* _name = nullptr) override;
+	bool        value(uint8&      _value_, const char* _name = nullptr) override;
+	bool        value(sint16&     _value_, const char* _name = nullptr) override;
+	bool        value(uint16&     _value_, const char* _name = nullptr) override;
+	bool        value(sint32&     _value_, const char* _name = nullptr) override;
+	bool        value(uint32&     _value_, const char* _name = nullptr) override;
+	bool        value(sint64&     _value_, const char* _name = nullptr) override;
+	bool        value(uint64&     _value_, const char* _name = nullptr) override;
+	bool        value(float32&    _value_, const char* _name = nullptr) override;
+	bool        value(float64&    _value_, const char* _name = nullptr) override;
+	bool        value(StringBase& _value_, const char* _name = nullptr) override;
+
+	bool        binary(void*& _data_, uint& _sizeBytes_, const char* _name = nullptr, CompressionFlags _compressionFlags = CompressionFlags_None) override;
+
+	// Size of the (uncompressed) body in bytes.
+	uint32      getBodySizeBytes() const { return (uint32)m_body.size(); }
+
+private:
+
+	enum Type_: uint8
+	{
+		Type_Bool,
+		Type_Sint8,
+		Type_Uint8,
+		Type_Sint16,
+		Type_Uint16,
+		Type_Sint32,
+		Type_Uint32,
+		Type_Sint64,
+		Type_Uint64,
+		Type_Float32,
+		Type_Float64,
+		Type_String,
+		Type_Binary,
+		Type_Object,
+		Type_Array,
+
+		Type_Count,
+		Type_Mixed              // Array members have different or non-scalar types, the array can't be packed.
+	};
+	typedef uint8 Type;
+
+	static constexpr uint16 kNoName = 0xffff;
+
+	struct Scope
+	{
+		uint32 header     = 0;          // Offset of the object/array header.
+		uint32 begin      = 0;          // Offset of the first member.
+		uint32 end        = 0;          // Offset of the end of the last member (read only).
+		uint32 cursor     = 0;          // Offset of the next member (read only).
+		uint32 count      = 0;          // Member count.
+		uint32 index      = ~0u;        // Index of the current member.
+		uint16 name       = kNoName;    // Name of the current member.
+		Type   packedType = Type_Count; // Type of all members (write), or of packed array members (read). Type_Count if none.
+		bool   isArray    = false;
+	};
+
+	// Location of a value in m_body.
+	struct Record
+	{
+		Type   type;
+		uint16 name;
+		uint32 data;                    // Offset of the value data.
+		uint32 end;                     // Offset of the next record.
+	};
+
+	eastl::vector<char>                     m_body;
+	eastl::vector<Scope>                    m_scopes;
+	eastl::vector<char>                     m_nameData;    // Null-terminated names.
+	eastl::vector<uint32>                   m_nameOffsets; // Offset of each name in m_nameData.
+	eastl::vector_map<StringHash, uint16>   m_nameMap;
+
+	void        onModeChange(Mode _mode) override;
+	void        reset();
+
+	// Write helpers.
+	uint16      addName(const char* _name);
+	void        writeRecordHeader(Type _type, const char* _name);
+	void        writeData(const void* _data, uint32 _sizeBytes);
+	template <typename tType>
+	void        writeData(const tType& _value)                      { writeData(&_value, sizeof(tType)); }
+	template <typename tType>
+	void        writeAt(uint32 _offset, const tType& _value)       { memcpy(m_body.data() + _offset, &_value, sizeof(tType)); }
+
+	// Read helpers.
+	uint16      findName(const char* _name) const;
+	bool        parseRecord(const Scope& _scope, uint32 _offset, Record& record_);
+	bool        readRecord(const char* _name, Record& record_);
+	template <typename tType>
+	tType       readAt(uint32 _offset) const                       { tType ret; memcpy(&ret, m_body.data() + _offset, sizeof(tType)); return ret; }
+
+	template <typename tType>
+	bool        valueImpl(tType& _value_, const char* _name);
+
+	template <typename tType>
+	static Type TypeOf();
+	static uint32 GetTypeSizeBytes(Type _type);
+
+}; // class SerializerBinary
+
+} // namespace frm
@@ -8,6 +8,7 @@
 #include <frm/core/memory.h>
 #include <frm/core/FileSystem.h>
 #include <frm/core/GlContext.h>
+#include <frm/core/ShaderCache.h>
 #include <frm/core/String.h>
 #include <frm/core/TextParser.h>
 #include <frm/core/Texture.h>
@@ -17,6 +18,8 @@
 
 #include <imgui/imgui.h>
 
+#define SHADER_ENABLE_CACHE 1
+
 using namespace frm;
 
 /*******************************************************************************
@@ -567,6 +570,10 @@ uint64 ShaderDesc::getHash() const
 		{
 			ret = HashString<uint64>((const char*)stage.m_path, ret);
 		}
+		else
+		{
+			ret = HashString<uint64>((const char*)stage.m_source, ret);
+		}
 		for (auto& def : stage.m_defines)
 		{
 			ret = HashString<uint64>((const char*)def.first, ret);
@@ -832,6 +839,68 @@ bool ShaderDesc::StageDesc::loadSource(ShaderDesc& _shaderDesc, const char* _pat
 	return true;
 }
 
+bool ShaderDesc::StageDesc::loadSourceCached(ShaderDesc& _shaderDesc)
+{
+ // the preprocessed source depends only on the path and virtual includes, hence all permutations share the same cache entry
+	uint64 key = HashString<uint64>((const char*)m_path);
+	for (auto& vinc : _shaderDesc.m_vincludes)
+	{
+		key = HashString<uint64>((const char*)vinc.first, key);
+		key = HashString<uint64>((const char*)vinc.second, key);
+	}
+
+	ShaderCache::SourceEntry entry;
+	if (!ShaderCache::FindSource(key, entry))
+	{
+	 // loadSource() sets the version/extensions on the desc, load via a temporary desc to capture only what was found in the source
+		ShaderDesc tmpDesc;
+		tmpDesc.m_vincludes = _shaderDesc.m_vincludes;
+		StageDesc& tmpStage = tmpDesc.m_stages[internal::ShaderStageToIndex(m_stage)];
+		tmpStage.m_path = m_path;
+		if (!tmpStage.loadSource(tmpDesc))
+		{
+			return false;
+		}
+
+		entry.source  = tmpStage.m_source;
+		entry.version = tmpDesc.m_version.c_str();
+		for (auto& ext : tmpStage.m_extensions)
+		{
+			entry.extensions.push_back(eastl::make_pair(ext.first, ext.second));
+		}
+		for (auto& dep : tmpStage.m_dependencies)
+		{
+			entry.dependencies.push_back().path = dep;
+		}
+		ShaderCache::AddSource(key, entry);
+	}
+
+	m_source.clear();
+	m_source.append(entry.source.c_str());
+	m_dependencies.clear();
+	for (auto& dep : entry.dependencies)
+	{
+		m_dependencies.push_back(dep.path);
+	}
+	for (auto& ext : entry.extensions)
+	{
+		_shaderDesc.addExtension(m_stage, ext.first.c_str(), ext.second.c_str());
+	}
+	if (!entry.version.isEmpty())
+	{
+		if (_shaderDesc.m_version.isEmpty())
+		{
+			_shaderDesc.m_version = entry.version.c_str();
+		}
+		else if (_shaderDesc.m_version != entry.version)
+		{
+			FRM_LOG_ERR("Shader: version already set ('#version %s'), encountered '#version %s' ('%s')", _shaderDesc.m_version.c_str(), entry.version.c_str(), (const char*)m_path);
+		}
+	}
+
+	return true;
+}
+
 String<0> ShaderDesc::StageDesc::getLogInfo() const
 {
 	String<0> ret;
@@ -866,6 +935,34 @@ String<0> ShaderDesc::StageDesc::getLogInfo() const
 
 *******************************************************************************/
 
+#if SHADER_ENABLE_CACHE
+
+static bool IsProgramBinarySupported()
+{
+	static GLint s_formatCount = -1;
+	if (s_formatCount < 0)
+	{
+		glAssert(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &s_formatCount));
+	}
+	return s_formatCount > 0;
+}
+
+// Program binaries are driver-specific, hence the key includes the driver version. Return 0 if program binaries aren't supported.
+static uint64 GetProgramKey(const ShaderDesc& _desc)
+{
+	if (!IsProgramBinarySupported())
+	{
+		return 0;
+	}
+	uint64 ret = _desc.getHash();
+	ret = HashString<uint64>(internal::GlGetString(GL_VENDOR), ret);
+	ret = HashString<uint64>(internal::GlGetString(GL_RENDERER), ret);
+	ret = HashString<uint64>(internal::GlGetString(GL_VERSION), ret);
+	return ret;
+}
+
+#endif // SHADER_ENABLE_CACHE
+
 // PUBLIC
 
 Shader* Shader::Create(const ShaderDesc& _desc)
@@ -1057,28 +1154,14 @@ Shader::~Shader()
 	setState(State_Unloaded);
 }
 
-bool Shader::loadStage(int _i, bool _loadSource)
+bool Shader::loadStage(int _i)
 {
 	ShaderDesc::StageDesc& stageDesc = m_desc.m_stages[_i];
 	FRM_ASSERT(stageDesc.isEnabled());
 
- // process source file if required
-	if (_loadSource && !stageDesc.m_path.isEmpty()) 
-	{
-		stageDesc.m_source.clear();
-		if (!stageDesc.loadSource(m_desc)) 
-		{
-			return false;
-		}
-	}
-
  // build final source
 	String<0> src;
 	// version pragma
-	if (m_desc.m_version.isEmpty())
-	{
-		m_desc.m_version = ShaderDesc::GetDefaultVersion();
-	}
 	src.appendf("#version %s\n", (const char*)m_desc.m_version);
 	// extensions
 	for (auto& ext : stageDesc.m_extensions)
@@ -1157,12 +1240,44 @@ bool Shader::loadStage(int _i, bool _loadSource)
 
 bool Shader::loadEnabledStagesAndLinkProgram(bool _loadSource)
 {
+ // process source files if required, this must happen for all stages before the program key is computed as the source may add
+ // extensions or set the version
+	for (int i = 0; _loadSource && i < internal::kShaderStageCount; ++i)
+	{
+		ShaderDesc::StageDesc& stageDesc = m_desc.m_stages[i];
+		if (stageDesc.isEnabled() && !stageDesc.m_path.isEmpty())
+		{
+			stageDesc.m_source.clear();
+			#if SHADER_ENABLE_CACHE
+				const bool loaded = stageDesc.loadSourceCached(m_desc);
+			#else
+				const bool loaded = stageDesc.loadSource(m_desc);
+			#endif
+			if (!loaded)
+			{
+				return false;
+			}
+		}
+	}
+	if (m_desc.m_version.isEmpty())
+	{
+		m_desc.m_version = ShaderDesc::GetDefaultVersion();
+	}
+
+	#if SHADER_ENABLE_CACHE
+		const uint64 programKey = GetProgramKey(m_desc);
+		if (programKey != 0 && loadProgramBinary(programKey))
+		{
+			return true;
+		}
+	#endif
+
 	bool ret = true;
 	for (int i = 0; i < internal::kShaderStageCount; ++i) 
 	{
 		if (m_desc.m_stages[i].isEnabled()) 
 		{
-			if (!loadStage(i, _loadSource)) 
+			if (!loadStage(i)) 
 			{
 				ret = false;
 				break;
@@ -1173,9 +1288,72 @@ bool Shader::loadEnabledStagesAndLinkProgram(bool _loadSource)
 	{
 		ret &= linkProgram();
 	}
+
+	#if SHADER_ENABLE_CACHE
+		if (ret && programKey != 0)
+		{
+			storeProgramBinary(programKey);
+		}
+	#endif
+
 	return ret;
 }
 
+bool Shader::loadProgramBinary(uint64 _key)
+{
+	ShaderCache::ProgramEntry entry;
+	if (!ShaderCache::FindProgram(_key, entry))
+	{
+		return false;
+	}
+
+	GLuint handle;
+	glAssert(handle = glCreateProgram());
+	glAssert(glProgramBinary(handle, (GLenum)entry.binaryFormat, entry.binary.data(), (GLsizei)entry.binary.size()));
+	GLint linkStatus = GL_FALSE;
+	glAssert(glGetProgramiv(handle, GL_LINK_STATUS, &linkStatus));
+	if (linkStatus == GL_FALSE)
+	{
+	 // the driver may reject a binary for any reason, this isn't an error
+		FRM_LOG("'%s' program binary rejected", getName());
+		glAssert(glDeleteProgram(handle));
+		return false;
+	}
+
+	FRM_LOG("'%s' loaded program binary", getName());
+	if (m_handle != 0)
+	{
+		glAssert(glDeleteProgram(m_handle));
+	}
+	m_handle = handle;
+	setState(State_Loaded);
+	return true;
+}
+
+void Shader::storeProgramBinary(uint64 _key)
+{
+	GLint binarySize = 0;
+	glAssert(glGetProgramiv(m_handle, GL_PROGRAM_BINARY_LENGTH, &binarySize));
+	if (binarySize <= 0)
+	{
+		return;
+	}
+
+	ShaderCache::ProgramEntry entry;
+	entry.binary.resize((uint)binarySize);
+	GLenum binaryFormat = 0;
+	glAssert(glGetProgramBinary(m_handle, binarySize, nullptr, &binaryFormat, entry.binary.data()));
+	entry.binaryFormat = (uint32)binaryFormat;
+	for (auto& stage : m_desc.m_stages)
+	{
+		for (auto& dep : stage.m_dependencies)
+		{
+			entry.dependencies.push_back().path = dep;
+		}
+	}
+	ShaderCache::AddProgram(_key, entry);
+}
+
 bool Shader::linkProgram()
 {
 	bool ret = true;
@@ -1189,6 +1367,12 @@ bool Shader::linkProgram()
 			glAssert(glAttachShader(handle, m_stageHandles[i]));
 		}
 	}
+	#if SHADER_ENABLE_CACHE
+		if (IsProgramBinarySupported())
+		{
+			glAssert(glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+		}
+	#endif
 
 	glAssert(glLinkProgram(handle));
 		
@@ -1238,6 +1422,8 @@ bool Shader::linkProgram()
 
 void Shader::setAutoName()
 {
+	NameStr name;
+	name.set(getName());
 	bool first = true;
 	for (int i = 0; i < internal::kShaderStageCount; ++i)
 	{
@@ -1245,7 +1431,7 @@ void Shader::setAutoName()
 		{
 			if (!first) 
 			{
-				m_name.append("__");
+				name.append("__");
 			}
 			first = false;
 
@@ -1255,7 +1441,8 @@ void Shader::setAutoName()
 			beg = beg ? beg + 1 : (const char*)stage.m_path;
 			end = end ? end : (const char*)stage.m_path + stage.m_path.getLength();
 
-			m_name.append(beg, end - beg);
+			name.append(beg, end - beg);
 		}
 	}
+	setName(name.c_str());
 }
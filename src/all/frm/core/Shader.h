@@ -120,6 +120,7 @@ private:
 		bool isEnabled() const;
 		bool hasDependency(const char* _path) const;
 		bool loadSource(ShaderDesc& _shaderDesc, const char* _path = nullptr);
+		bool loadSourceCached(ShaderDesc& _shaderDesc); // As loadSource() via ShaderCache.
 		frm::String<0> getLogInfo() const;
 	};
 	
@@ -210,12 +211,17 @@ private:
 	Shader(Id _id, const char* _name);
 	~Shader();	
 
-	// Load the specified stage, return status.
-	bool loadStage(int _i, bool _loadSource = true);
+	// Compile the specified stage, return status.
+	bool loadStage(int _i);
 
-	// Call loadStage for all enabled stages, call linkProgram() if no compilation errors.
+	// Load the source for all enabled stages (optional), then either load a cached program binary (see ShaderCache) or call loadStage
+	// for all enabled stages and call linkProgram() if no compilation errors.
 	bool loadEnabledStagesAndLinkProgram(bool _loadSource = true);
 
+	// Load/store a program binary via ShaderCache. _key identifies the program and driver.
+	bool loadProgramBinary(uint64 _key);
+	void storeProgramBinary(uint64 _key);
+
 	// Link stages to generate the final program.
 	bool linkProgram();
 
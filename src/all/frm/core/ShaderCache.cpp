@@ -0,0 +1,320 @@
+#include "ShaderCache.h"
+
+#include <frm/core/Log.h>
+#include <frm/core/memory.h>
+#include <frm/core/File.h>
+#include <frm/core/FileSystem.h>
+
+#include <EASTL/vector_map.h>
+
+#include <cstring>
+#include <mutex>
+#define SCOPED_MUTEX_LOCK(mtx) std::lock_guard<std::mutex> FRM_UNIQUE_NAME(_scopedMutexLock)(mtx)
+
+using namespace frm;
+
+FRM_DEFINE_STATIC_INIT(ShaderCache, ShaderCache::Init, ShaderCache::Shutdown);
+
+namespace {
+
+constexpr uint32 kMagic = 0x534D5246; // 'FRMS'
+
+enum EntryType
+{
+	EntryType_Source,
+	EntryType_Program
+};
+
+struct Header
+{
+	uint32 magic;
+	uint32 version;
+	uint32 type;
+	uint32 dependencyCount;
+	uint64 key;
+};
+
+struct Cache
+{
+	std::mutex                                           mutex; // Protects all of the below.
+	eastl::vector_map<uint64, ShaderCache::SourceEntry>  sources;
+	eastl::vector_map<uint64, ShaderCache::ProgramEntry> programs;
+};
+
+Cache* s_cache;
+
+template <typename tType>
+void Append(eastl::vector<char>& buffer_, const tType& _value)
+{
+	const char* src = (const char*)&_value;
+	buffer_.insert(buffer_.end(), src, src + sizeof(tType));
+}
+
+void AppendString(eastl::vector<char>& buffer_, const char* _str, uint32 _length)
+{
+	Append(buffer_, _length);
+	buffer_.insert(buffer_.end(), _str, _str + _length);
+}
+
+// Bounds-checked sequential read.
+struct Reader
+{
+	const char* cursor;
+	const char* end;
+
+	template <typename tType>
+	bool read(tType& value_)
+	{
+		if (cursor + sizeof(tType) > end)
+		{
+			return false;
+		}
+		memcpy(&value_, cursor, sizeof(tType));
+		cursor += sizeof(tType);
+		return true;
+	}
+
+	bool readString(StringBase& str_)
+	{
+		uint32 length;
+		if (!read(length) || length > (uint32)(end - cursor))
+		{
+			return false;
+		}
+		if (length == 0)
+		{
+			str_.clear(); // set() with a count of 0 copies to the first null
+		}
+		else
+		{
+			str_.set(cursor, length);
+		}
+		cursor += length;
+		return true;
+	}
+};
+
+PathStr GetCachePath(uint64 _key, EntryType _type)
+{
+	PathStr ret;
+	ret.setf("_cache/shaders/%016llx.%s", (unsigned long long)_key, _type == EntryType_Source ? "src" : "bin");
+	return ret;
+}
+
+bool IsValid(const eastl::vector<ShaderCache::Dependency>& _dependencies)
+{
+	for (const ShaderCache::Dependency& dependency : _dependencies)
+	{
+		if (FileSystem::GetHash(dependency.path.c_str()) != dependency.hash)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void WriteData(eastl::vector<char>& buffer_, const ShaderCache::SourceEntry& _entry)
+{
+	AppendString(buffer_, _entry.version.c_str(), (uint32)_entry.version.getLength());
+	Append(buffer_, (uint32)_entry.extensions.size());
+	for (auto& extension : _entry.extensions)
+	{
+		AppendString(buffer_, extension.first.c_str(), (uint32)extension.first.getLength());
+		AppendString(buffer_, extension.second.c_str(), (uint32)extension.second.getLength());
+	}
+	AppendString(buffer_, _entry.source.c_str(), (uint32)_entry.source.getLength());
+}
+
+void WriteData(eastl::vector<char>& buffer_, const ShaderCache::ProgramEntry& _entry)
+{
+	Append(buffer_, _entry.binaryFormat);
+	AppendString(buffer_, _entry.binary.data(), (uint32)_entry.binary.size());
+}
+
+bool ReadData(Reader& _reader, ShaderCache::SourceEntry& entry_)
+{
+	uint32 extensionCount;
+	if (!_reader.readString(entry_.version) || !_reader.read(extensionCount))
+	{
+		return false;
+	}
+	entry_.extensions.clear();
+	for (uint32 i = 0; i < extensionCount; ++i)
+	{
+		auto& extension = entry_.extensions.push_back();
+		if (!_reader.readString(extension.first) || !_reader.readString(extension.second))
+		{
+			return false;
+		}
+	}
+	return _reader.readString(entry_.source);
+}
+
+bool ReadData(Reader& _reader, ShaderCache::ProgramEntry& entry_)
+{
+	uint32 binarySize;
+	if (!_reader.read(entry_.binaryFormat) || !_reader.read(binarySize) || binarySize > (uint32)(_reader.end - _reader.cursor))
+	{
+		return false;
+	}
+	entry_.binary.assign(_reader.cursor, _reader.cursor + binarySize);
+	_reader.cursor += binarySize;
+	return true;
+}
+
+template <typename tEntry>
+bool WriteEntry(uint64 _key, EntryType _type, const tEntry& _entry)
+{
+	eastl::vector<char> buffer;
+	Header header = { kMagic, ShaderCache::kVersion, (uint32)_type, (uint32)_entry.dependencies.size(), _key };
+	Append(buffer, header);
+	for (const ShaderCache::Dependency& dependency : _entry.dependencies)
+	{
+		Append(buffer, dependency.hash);
+		AppendString(buffer, dependency.path.c_str(), (uint32)dependency.path.getLength());
+	}
+	WriteData(buffer, _entry);
+
+	// File::Write() strips a trailing null, append one so that the data is written as-is.
+	File file;
+	file.setData(nullptr, buffer.size() + 1);
+	memcpy(file.getData(), buffer.data(), buffer.size());
+	return FileSystem::Write(file, GetCachePath(_key, _type).c_str());
+}
+
+template <typename tEntry>
+bool ReadEntry(uint64 _key, EntryType _type, tEntry& entry_)
+{
+	const PathStr path = GetCachePath(_key, _type);
+	File file;
+	if (!FileSystem::ReadIfExists(file, path.c_str()))
+	{
+		return false;
+	}
+
+	Reader reader = { file.getData(), file.getData() + file.getDataSize() - 1 }; // exclude the implicit null
+	Header header;
+	if (file.getDataSize() < sizeof(Header) + 1 || !reader.read(header) || header.magic != kMagic || header.version != ShaderCache::kVersion || header.type != (uint32)_type || header.key != _key)
+	{
+		FRM_LOG("ShaderCache: Ignoring invalid entry '%s'", path.c_str());
+		return false;
+	}
+
+	entry_.dependencies.clear();
+	for (uint32 i = 0; i < header.dependencyCount; ++i)
+	{
+		ShaderCache::Dependency& dependency = entry_.dependencies.push_back();
+		if (!reader.read(dependency.hash) || !reader.readString(dependency.path))
+		{
+			FRM_LOG("ShaderCache: Ignoring invalid entry '%s'", path.c_str());
+			return false;
+		}
+	}
+	if (!ReadData(reader, entry_))
+	{
+		FRM_LOG("ShaderCache: Ignoring invalid entry '%s'", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+template <typename tEntry>
+bool Find(eastl::vector_map<uint64, tEntry>& _map, uint64 _key, EntryType _type, tEntry& entry_)
+{
+	bool found = false;
+	{	SCOPED_MUTEX_LOCK(s_cache->mutex);
+		auto it = _map.find(_key);
+		if (it != _map.end())
+		{
+			entry_ = it->second;
+			found = true;
+		}
+	}
+
+	if (!found)
+	{
+		if (!ReadEntry(_key, _type, entry_))
+		{
+			return false;
+		}
+	}
+
+	// Dependencies are validated on every call, the in-memory entry may be stale if a file was modified since it was added.
+	if (!IsValid(entry_.dependencies))
+	{
+		SCOPED_MUTEX_LOCK(s_cache->mutex);
+		_map.erase(_key);
+		return false;
+	}
+
+	if (!found)
+	{
+		SCOPED_MUTEX_LOCK(s_cache->mutex);
+		_map[_key] = entry_;
+	}
+	return true;
+}
+
+template <typename tEntry>
+bool Add(eastl::vector_map<uint64, tEntry>& _map, uint64 _key, EntryType _type, const tEntry& _entry)
+{
+	tEntry entry = _entry;
+	for (ShaderCache::Dependency& dependency : entry.dependencies)
+	{
+		dependency.hash = FileSystem::GetHash(dependency.path.c_str());
+	}
+
+	const bool ret = WriteEntry(_key, _type, entry);
+	if (!ret)
+	{
+		FRM_LOG_ERR("ShaderCache: Error writing '%s'", GetCachePath(_key, _type).c_str());
+	}
+
+	SCOPED_MUTEX_LOCK(s_cache->mutex);
+	_map[_key] = eastl::move(entry);
+	return ret;
+}
+
+} // namespace
+
+// PUBLIC
+
+bool ShaderCache::FindSource(uint64 _key, SourceEntry& entry_)
+{
+	return Find(s_cache->sources, _key, EntryType_Source, entry_);
+}
+
+bool ShaderCache::FindProgram(uint64 _key, ProgramEntry& entry_)
+{
+	return Find(s_cache->programs, _key, EntryType_Program, entry_);
+}
+
+bool ShaderCache::AddSource(uint64 _key, const SourceEntry& _entry)
+{
+	return Add(s_cache->sources, _key, EntryType_Source, _entry);
+}
+
+bool ShaderCache::AddProgram(uint64 _key, const ProgramEntry& _entry)
+{
+	return Add(s_cache->programs, _key, EntryType_Program, _entry);
+}
+
+void ShaderCache::Clear()
+{
+	SCOPED_MUTEX_LOCK(s_cache->mutex);
+	s_cache->sources.clear();
+	s_cache->programs.clear();
+}
+
+// PRIVATE
+
+void ShaderCache::Init()
+{
+	s_cache = FRM_NEW(Cache);
+}
+
+void ShaderCache::Shutdown()
+{
+	FRM_DELETE(s_cache);
+	s_cache = nullptr;
+}
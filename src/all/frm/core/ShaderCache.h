@@ -0,0 +1,84 @@
+#pragma once
+
+#include <frm/core/frm.h>
+#include <frm/core/String.h>
+#include <frm/core/StaticInitializer.h>
+
+#include <EASTL/utility.h>
+#include <EASTL/vector.h>
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// ShaderCache
+// Persistent cache of preprocessed shader source and program binaries (see
+// Shader). Entries are kept in memory and written to '_cache/shaders/',
+// relative to the default root.
+//
+// Source entries are the result of #include expansion for a single stage. Keys
+// are derived from the inputs to the preprocessor only (stage path + virtual
+// includes), hence all permutations (sets of defines) of a stage share the
+// same entry. Program entries are driver-specific binaries (glGetProgramBinary),
+// the key must identify the program and the driver.
+//
+// Each entry records the content hash of all its dependencies (see
+// FileSystem::GetHash()), an entry is valid only if none of the dependencies
+// have changed. Keys are opaque, the cache doesn't depend on GL.
+//
+// File layout (little endian):
+//   Header        magic 'FRMS', version, type, key, dependency count.
+//   Dependencies  { content hash, path length, path }
+//   Data          Source: version, extension count, { name, behavior }, source.
+//                 Program: binary format, binary size, binary.
+////////////////////////////////////////////////////////////////////////////////
+class ShaderCache
+{
+public:
+
+	static constexpr uint32 kVersion = 1;
+
+	typedef frm::String<64> Str;
+
+	struct Dependency
+	{
+		PathStr path;     // Including the root, as per File::getPath().
+		uint64  hash = 0; // Set by AddSource()/AddProgram().
+	};
+
+	struct SourceEntry
+	{
+		String<0>                            source;       // As per ShaderDesc::StageDesc::m_source.
+		Str                                  version;      // From a #version directive, empty if none was found.
+		eastl::vector<eastl::pair<Str, Str>> extensions;   // Name, behavior from #extension directives.
+		eastl::vector<Dependency>            dependencies;
+	};
+
+	struct ProgramEntry
+	{
+		uint32                               binaryFormat = 0;
+		eastl::vector<char>                  binary;
+		eastl::vector<Dependency>            dependencies; // All stages.
+	};
+
+	// Find a valid entry for _key, check memory then disk. Return false if no entry was found or if any dependency changed.
+	static bool FindSource(uint64 _key, SourceEntry& entry_);
+	static bool FindProgram(uint64 _key, ProgramEntry& entry_);
+
+	// Add or replace the entry for _key and write it to disk, return false if the write failed. Dependency hashes are computed from
+	// the current file contents.
+	static bool AddSource(uint64 _key, const SourceEntry& _entry);
+	static bool AddProgram(uint64 _key, const ProgramEntry& _entry);
+
+	// Clear entries from memory (disk entries are unaffected).
+	static void Clear();
+
+private:
+
+	FRM_DECLARE_STATIC_INIT_FRIEND(ShaderCache);
+	static void Init();
+	static void Shutdown();
+
+}; // class ShaderCache
+FRM_DECLARE_STATIC_INIT(ShaderCache);
+
+} // namespace frm
@@ -5,6 +5,8 @@
 #include <frm/core/Framebuffer.h>
 #include <frm/core/Texture.h>
 
+#include <EASTL/sort.h>
+
 
 static int RoundUpToPow2(int x)
 {
@@ -22,20 +24,6 @@ static int RoundUpToPow2(int x)
 	return x;
 }
 
-static int FindFirstBit(int x)
-{
-	int ret = 0;
-
-	int y = 1;
-	while (!(x & y))
-	{
-		y = y << 1;
-		++ret;
-	}
-
-	return ret;
-}
-
 namespace frm {
 
 // PUBLIC
@@ -60,26 +48,50 @@ ShadowAtlas::ShadowMap* ShadowAtlas::alloc(float _lod)
 
 ShadowAtlas::ShadowMap* ShadowAtlas::alloc(GLsizei _size)
 {
-	_size = RoundUpToPow2(_size);
-	_size = Min(m_maxSize, _size);
+	const int level = getLevel(_size);
+	if (level < 0)
+	{
+		return nullptr;
+	}
 
-	if (_size < m_minSize)
+	Allocator::Allocation allocation;
+	if (!m_allocator->alloc(level, allocation))
 	{
 		return nullptr;
 	}
+	return createShadowMap(allocation, level);
+}
+
+int ShadowAtlas::alloc(const float* _lods, int _count, ShadowMap** shadowMaps_)
+{
+	m_batchSizes.resize(_count);
+	for (int i = 0; i < _count; ++i)
+	{
+		m_batchSizes[i] = (GLsizei)lerp((float)m_minSize, (float)m_maxSize, _lods[i]);
+	}
+	return alloc(m_batchSizes.data(), _count, shadowMaps_);
+}
 
-	// convert _size to a quadtree level index
-	int targetLevel = FindFirstBit((m_texture->getWidth() / _size));
+int ShadowAtlas::alloc(const GLsizei* _sizes, int _count, ShadowMap** shadowMaps_)
+{
+	m_batchLevels.resize(_count);
+	m_batchAllocations.resize(_count);
+	for (int i = 0; i < _count; ++i)
+	{
+		m_batchLevels[i] = getLevel(_sizes[i]);
+	}
 
-	ShadowMap* ret = nullptr;
-	for (GLsizei arrayIndex = 0; arrayIndex < m_arrayCount; ++arrayIndex)
+	const int ret = m_allocator->alloc(m_batchLevels.data(), _count, m_batchAllocations.data());
+
+	for (int i = 0; i < _count; ++i)
 	{
-		ret = allocRecursive(arrayIndex, targetLevel, 0, 0, _size);
-		if (ret)
+		shadowMaps_[i] = nullptr;
+		if (m_batchAllocations[i].nodeIndex != Allocator::Quadtree::Index_Invalid)
 		{
-			break;
+			shadowMaps_[i] = createShadowMap(m_batchAllocations[i], m_batchLevels[i]);
 		}
 	}
+
 	return ret;
 }
 
@@ -87,18 +99,29 @@ void ShadowAtlas::free(ShadowMap*& _shadowMap_)
 {
 	FRM_ASSERT(_shadowMap_);
 
-	Quadtree& quadtree = *m_quadtrees[_shadowMap_->arrayIndex];
-	const Quadtree::Index nodeIndex = _shadowMap_->nodeIndex;
-	const int nodeLevel = Quadtree::FindLevel(nodeIndex);
-	const Quadtree::Index parentIndex = quadtree.getParentIndex(nodeIndex, nodeLevel);
-
-	quadtree[nodeIndex] = true;
-	freeRecursive(_shadowMap_->arrayIndex, parentIndex, nodeLevel - 1);
+	Allocator::Allocation allocation;
+	allocation.arrayIndex = _shadowMap_->arrayIndex;
+	allocation.nodeIndex  = _shadowMap_->nodeIndex;
+	m_allocator->free(allocation);
 
 	m_shadowMapPool.free(_shadowMap_);
 	_shadowMap_ = nullptr;
 }
 
+ShadowAtlas::Stats ShadowAtlas::getStats() const
+{
+	const uint64 minTexels = (uint64)m_minSize * (uint64)m_minSize;
+	const int largestFreeLevel = m_allocator->findLargestFreeLevel();
+
+	Stats ret;
+	ret.shadowMapCount  = m_allocator->getAllocationCount();
+	ret.usedTexels      = m_allocator->getUsedArea() * minTexels;
+	ret.totalTexels     = m_allocator->getTotalArea() * minTexels;
+	ret.utilization     = (float)((double)ret.usedTexels / (double)ret.totalTexels);
+	ret.largestFreeSize = largestFreeLevel < 0 ? 0 : Min(m_maxSize, m_textureSize >> largestFreeLevel);
+	return ret;
+}
+
 // PRIVATE
 
 ShadowAtlas::ShadowAtlas(GLsizei _maxSize, GLsizei _minSize, GLenum _format, GLsizei _arrayCount)
@@ -110,6 +133,13 @@ ShadowAtlas::ShadowAtlas(GLsizei _maxSize, GLsizei _minSize, GLenum _format, GLs
 {
 	FRM_ASSERT(m_maxSize >= m_minSize);
 	FRM_ASSERT(m_arrayCount > 0);
+
+	m_textureSize = m_maxSize * 2; // reduce the chance of filling up the atlas with max size allocations
+
+	// clamp m_minSize to the max quadtree depth
+	const int maxLevelCount = Allocator::Quadtree::GetAbsoluteMaxLevelCount();
+	m_minSize = Max(m_minSize, m_textureSize >> (maxLevelCount - 1));
+
 	FRM_VERIFY(init());
 }
 
@@ -126,8 +156,7 @@ bool ShadowAtlas::init()
 
 	bool ret = true;
 
-	GLsizei textureSize = m_maxSize * 2; // reduce the chance of filling up the atlas with max size allocations
-	m_texture = Texture::Create2dArray(textureSize, textureSize, m_arrayCount, m_format);
+	m_texture = Texture::Create2dArray(m_textureSize, m_textureSize, m_arrayCount, m_format);
 	if (!m_texture || m_texture->getState() != Texture::State_Loaded)
 	{
 		return false;
@@ -136,17 +165,16 @@ bool ShadowAtlas::init()
 	m_texture->setName("txShadowAtlas");
 
 	m_framebuffers.resize(m_arrayCount);
-	m_quadtrees.resize(m_arrayCount);
 	for (GLsizei i = 0; i < m_arrayCount; ++i)
 	{
 		Framebuffer*& fb = m_framebuffers[i];
 		fb = Framebuffer::Create();
 		fb->attachLayer(m_texture, GL_DEPTH_ATTACHMENT, i);
-
-		Quadtree*& qt = m_quadtrees[i];
-		qt = FRM_NEW(Quadtree(Quadtree::GetAbsoluteMaxLevelCount(), true)); // \todo compute the actual number of levels required
 	}
 
+	const int levelCount = (int)FindFirstSet((uint32)(m_textureSize / m_minSize)) + 1;
+	m_allocator = FRM_NEW(Allocator(levelCount, m_arrayCount));
+
 	return true;
 }
 
@@ -160,6 +188,61 @@ void ShadowAtlas::shutdown()
 	}
 	m_framebuffers.clear();
 
+	FRM_DELETE(m_allocator);
+	m_allocator = nullptr;
+}
+
+int ShadowAtlas::getLevel(GLsizei _size) const
+{
+	_size = RoundUpToPow2(_size);
+	_size = Min(m_maxSize, _size);
+
+	if (_size < m_minSize)
+	{
+		return -1;
+	}
+
+	return (int)FindFirstSet((uint32)(m_textureSize / _size));
+}
+
+ShadowAtlas::ShadowMap* ShadowAtlas::createShadowMap(const Allocator::Allocation& _allocation, int _level)
+{
+	const GLsizei size = m_textureSize >> _level;
+
+	ShadowMap* ret  = m_shadowMapPool.alloc();
+	ret->arrayIndex = _allocation.arrayIndex;
+	ret->nodeIndex  = _allocation.nodeIndex;
+	ret->size       = size;
+	ret->origin     = ivec2(Allocator::Quadtree::ToCartesian(_allocation.nodeIndex, _level) * (uint32)size);
+	ret->uvBias     = vec2(ret->origin) / (float)m_textureSize;
+	ret->uvScale    = (float)size / (float)m_textureSize;
+	return ret;
+}
+
+
+/*******************************************************************************
+
+                            ShadowAtlas::Allocator
+
+*******************************************************************************/
+
+// PUBLIC
+
+ShadowAtlas::Allocator::Allocator(int _levelCount, int _arrayCount)
+	: m_levelCount(_levelCount)
+{
+	FRM_ASSERT(_levelCount > 0 && _levelCount <= Quadtree::GetAbsoluteMaxLevelCount());
+	FRM_ASSERT(_arrayCount > 0);
+
+	m_quadtrees.resize(_arrayCount);
+	for (Quadtree*& quadtree : m_quadtrees)
+	{
+		quadtree = FRM_NEW(Quadtree(m_levelCount, true));
+	}
+}
+
+ShadowAtlas::Allocator::~Allocator()
+{
 	while (!m_quadtrees.empty())
 	{
 		FRM_DELETE(m_quadtrees.back());
@@ -167,69 +250,145 @@ void ShadowAtlas::shutdown()
 	}
 }
 
-ShadowAtlas::ShadowMap* ShadowAtlas::allocRecursive(uint32 _arrayIndex, int _targetLevel, uint16 _nodeIndex, int _nodeLevel, GLsizei _size)
+bool ShadowAtlas::Allocator::alloc(int _level, Allocation& allocation_, uint32 _firstArrayIndex)
 {
-	Quadtree& quadtree = *m_quadtrees[_arrayIndex];
-	
-	ShadowMap* ret = nullptr;
+	FRM_ASSERT(_level >= 0 && _level < m_levelCount);
 
-	if (_nodeLevel == _targetLevel)
+	for (uint32 arrayIndex = _firstArrayIndex; arrayIndex < (uint32)m_quadtrees.size(); ++arrayIndex)
 	{
-		if (quadtree[_nodeIndex]) // node is empty
+		Quadtree& quadtree = *m_quadtrees[arrayIndex];
+		const Index nodeIndex = quadtree.findFirst(_level, true);
+		if (nodeIndex == Quadtree::Index_Invalid)
+		{
+			continue;
+		}
+
+		// node and descendants are now used
+		quadtree[nodeIndex] = false;
+		for (int level = _level + 1; level < m_levelCount; ++level)
+		{
+			quadtree.fill(level, false, nodeIndex);
+		}
+
+		// ancestors are partially used, stop at the first ancestor which was already used (its ancestors must also be used)
+		Index parentIndex = quadtree.getParentIndex(nodeIndex, _level);
+		for (int level = _level - 1; parentIndex != Quadtree::Index_Invalid && quadtree[parentIndex]; --level)
 		{
-			quadtree[_nodeIndex] = false;
-			
-			ret             = m_shadowMapPool.alloc();
-			ret->arrayIndex = _arrayIndex;
-			ret->nodeIndex  = _nodeIndex;
-			ret->size       = _size;
-			ret->origin     = ivec2(Quadtree::ToCartesian(_nodeIndex, _nodeLevel) * (uint32)_size);
-			ret->uvBias     = vec2(ret->origin) / (float)m_texture->getWidth();
-			ret->uvScale    = (float)_size / (float)m_texture->getWidth();
+			quadtree[parentIndex] = false;
+			parentIndex = quadtree.getParentIndex(parentIndex, level);
 		}
+
+		allocation_.arrayIndex = arrayIndex;
+		allocation_.nodeIndex  = nodeIndex;
+		++m_allocationCount;
+		m_usedArea += getArea(_level);
+		return true;
 	}
-	else
+
+	return false;
+}
+
+int ShadowAtlas::Allocator::alloc(const int* _levels, int _count, Allocation* allocations_)
+{
+	m_batchOrder.clear();
+	for (int i = 0; i < _count; ++i)
 	{
-		Quadtree::Index firstChildIndex = quadtree.getFirstChildIndex(_nodeIndex, _nodeLevel);
-		for (Quadtree::Index childIndex = 0; childIndex < 4; ++childIndex)
+		allocations_[i] = Allocation();
+		if (_levels[i] >= 0)
 		{
-			ret = allocRecursive(_arrayIndex, _targetLevel, firstChildIndex + childIndex, _nodeLevel + 1, _size);
-			if (ret)
-			{
-				quadtree[_nodeIndex] = false;					
-				break;
-			}
+			m_batchOrder.push_back(i);
+		}
+	}
+	eastl::sort(m_batchOrder.begin(), m_batchOrder.end(),
+		[_levels](int _a, int _b)
+		{
+			return _levels[_a] != _levels[_b] ? _levels[_a] < _levels[_b] : _a < _b;
+		});
+
+	// nothing is freed during the batch, hence once a layer is full at a level it's also full for the remaining allocations at
+	// that level; restart the search from the first layer only when the level changes
+	int ret = 0;
+	int prevLevel = -1;
+	uint32 firstArrayIndex = 0;
+	for (int i : m_batchOrder)
+	{
+		const int level = _levels[i];
+		if (level != prevLevel)
+		{
+			prevLevel = level;
+			firstArrayIndex = 0;
+		}
+
+		if (alloc(level, allocations_[i], firstArrayIndex))
+		{
+			firstArrayIndex = allocations_[i].arrayIndex;
+			++ret;
+		}
+		else
+		{
+			firstArrayIndex = (uint32)m_quadtrees.size();
 		}
 	}
 
 	return ret;
 }
 
-void ShadowAtlas::freeRecursive(uint32 _arrayIndex, uint16 _nodeIndex, int _nodeLevel)
+void ShadowAtlas::Allocator::free(const Allocation& _allocation)
 {
-	if (_nodeIndex == Quadtree::Index_Invalid)
+	FRM_ASSERT(_allocation.arrayIndex < (uint32)m_quadtrees.size());
+	FRM_ASSERT(m_allocationCount > 0);
+
+	Quadtree& quadtree = *m_quadtrees[_allocation.arrayIndex];
+	const Index nodeIndex = _allocation.nodeIndex;
+	const int nodeLevel = Quadtree::FindLevel(nodeIndex);
+	FRM_ASSERT(nodeLevel >= 0 && nodeLevel < m_levelCount);
+	FRM_ASSERT(!quadtree[nodeIndex]); // double free?
+
+	// node and descendants are free
+	quadtree[nodeIndex] = true;
+	for (int level = nodeLevel + 1; level < m_levelCount; ++level)
+	{
+		quadtree.fill(level, true, nodeIndex);
+	}
+
+	// ancestors are free if all 4 children are free
+	Index parentIndex = quadtree.getParentIndex(nodeIndex, nodeLevel);
+	for (int level = nodeLevel; parentIndex != Quadtree::Index_Invalid && quadtree.count(level, true, parentIndex) == 4; --level)
 	{
-		return;
+		quadtree[parentIndex] = true;
+		parentIndex = quadtree.getParentIndex(parentIndex, level - 1);
 	}
 
-	Quadtree& quadtree = *m_quadtrees[_arrayIndex];
-	
-	const Quadtree::Index firstChildIndex = quadtree.getFirstChildIndex(_nodeIndex, _nodeLevel);
-	FRM_ASSERT(firstChildIndex != Quadtree::Index_Invalid);
-	
-	quadtree[_nodeIndex] = true
-		&& quadtree[firstChildIndex + 0]
-		&& quadtree[firstChildIndex + 1]
-		&& quadtree[firstChildIndex + 2]
-		&& quadtree[firstChildIndex + 3]
-		;
+	--m_allocationCount;
+	m_usedArea -= getArea(nodeLevel);
+}
 
-	const Quadtree::Index parentIndex = quadtree.getParentIndex(_nodeIndex, _nodeLevel);
-	if (parentIndex != Quadtree::Index_Invalid)
+void ShadowAtlas::Allocator::reset()
+{
+	for (Quadtree* quadtree : m_quadtrees)
 	{
-		freeRecursive(_arrayIndex, parentIndex, _nodeLevel - 1);
+		for (int level = 0; level < m_levelCount; ++level)
+		{
+			quadtree->fill(level, true);
+		}
 	}
+	m_allocationCount = 0;
+	m_usedArea = 0;
 }
 
+int ShadowAtlas::Allocator::findLargestFreeLevel() const
+{
+	for (int level = 0; level < m_levelCount; ++level)
+	{
+		for (const Quadtree* quadtree : m_quadtrees)
+		{
+			if (quadtree->findFirst(level, true) != Quadtree::Index_Invalid)
+			{
+				return level;
+			}
+		}
+	}
+	return -1;
+}
 
 } // namespace frm
@@ -11,6 +11,8 @@ namespace frm {
 
 ////////////////////////////////////////////////////////////////////////////////
 // ShadowAtlas
+// Power of 2 shadow map allocations in a 2d array texture. Allocation is via a
+// bitmap quadtree per array layer (see Allocator).
 ////////////////////////////////////////////////////////////////////////////////
 class ShadowAtlas
 {
@@ -29,35 +31,108 @@ public:
 		uint16 nodeIndex  = 0;
 	};
 
+	struct Stats
+	{
+		uint32  shadowMapCount  = 0;
+		uint64  usedTexels      = 0;
+		uint64  totalTexels     = 0;    // All array layers.
+		float   utilization     = 0.0f; // usedTexels / totalTexels.
+		GLsizei largestFreeSize = 0;    // Largest size which can currently be allocated, 0 if the atlas is full.
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+	// Allocator
+	// Node allocator, doesn't depend on GL. Each array layer is a bitmap
+	// quadtree where a node is set if no allocation overlaps it, hence alloc()
+	// is a word-parallel search for the first set bit at the target level (see
+	// Quadtree::findFirst()). Level 0 is the whole layer.
+	////////////////////////////////////////////////////////////////////////////
+	class Allocator
+	{
+	public:
+		typedef frm::Quadtree<uint16, bool> Quadtree; // 16 bit index = 8 levels
+		typedef Quadtree::Index             Index;
+
+		struct Allocation
+		{
+			uint32 arrayIndex = 0;
+			Index  nodeIndex  = Quadtree::Index_Invalid;
+		};
+
+		Allocator(int _levelCount, int _arrayCount);
+		~Allocator();
+
+		// Allocate a node at _level, search array layers starting at _firstArrayIndex. Return false if there was no space.
+		bool   alloc(int _level, Allocation& allocation_, uint32 _firstArrayIndex = 0);
+		// Batched alloc(), allocate _count nodes coarsest level (i.e. largest size) first. Negative levels are skipped. allocations_
+		// receives _count allocations in the same order as _levels, failed allocations have nodeIndex Index_Invalid. Return the
+		// number of successful allocations.
+		int    alloc(const int* _levels, int _count, Allocation* allocations_);
+		void   free(const Allocation& _allocation);
+		// Free all nodes.
+		void   reset();
+
+		// Coarsest level which has a free node in any array layer, or -1 if full.
+		int    findLargestFreeLevel() const;
+		// Area in units of nodes at the finest level.
+		uint64 getUsedArea() const        { return m_usedArea; }
+		uint64 getTotalArea() const       { return (uint64)Quadtree::GetNodeCount(m_levelCount - 1) * m_quadtrees.size(); }
+		uint32 getAllocationCount() const { return m_allocationCount; }
+		int    getLevelCount() const      { return m_levelCount; }
+		int    getArrayCount() const      { return (int)m_quadtrees.size(); }
+
+		bool   isFree(uint32 _arrayIndex, Index _nodeIndex) const { return (*m_quadtrees[_arrayIndex])[_nodeIndex]; }
+
+	private:
+
+		int                      m_levelCount      = 0;
+		eastl::vector<Quadtree*> m_quadtrees;            // per array layer
+		uint32                   m_allocationCount = 0;
+		uint64                   m_usedArea        = 0;
+		eastl::vector<int>       m_batchOrder;           // alloc() scratch
+
+		uint64 getArea(int _level) const  { return (uint64)Quadtree::GetNodeCount(m_levelCount - 1 - _level); }
+	};
+
 	ShadowMap*   alloc(float _lod);
 	ShadowMap*   alloc(GLsizei _size);
+	// Batched alloc(), allocate _count shadow maps largest first across all array layers. shadowMaps_ receives _count ptrs in the
+	// same order as _lods/_sizes, nullptr if the allocation failed. Return the number of successful allocations.
+	int          alloc(const float* _lods, int _count, ShadowMap** shadowMaps_);
+	int          alloc(const GLsizei* _sizes, int _count, ShadowMap** shadowMaps_);
 
 	void         free(ShadowMap*& _shadowMap_);
-	
+
+	Stats        getStats() const;
 
 	Texture*     getTexture()              { return m_texture; }
 	Framebuffer* getFramebuffer(int i = 0) { return m_framebuffers[i]; }
 
 private:
-	using Quadtree = Quadtree<uint16, bool>; // 16 bit index = 8 levels, bool determines if a node is empty (false if any children were allocated)
 
 	GLsizei                     m_minSize       = 0;
 	GLsizei                     m_maxSize       = 0;
+	GLsizei                     m_textureSize   = 0;
 	GLsizei                     m_arrayCount    = 0;
 	GLenum                      m_format        = GL_NONE;
 	Texture*                    m_texture       = nullptr;
 	Pool<ShadowMap>             m_shadowMapPool;
-	eastl::vector<Quadtree*>    m_quadtrees;    // per array layer
+	Allocator*                  m_allocator     = nullptr;
 	eastl::vector<Framebuffer*>	m_framebuffers; // per array layer
 
+	eastl::vector<GLsizei>               m_batchSizes;       // alloc() scratch
+	eastl::vector<int>                   m_batchLevels;      //      "
+	eastl::vector<Allocator::Allocation> m_batchAllocations; //      "
+
 	ShadowAtlas(GLsizei _maxSize, GLsizei _minSize, GLenum _format, GLsizei _arrayCount);
 	~ShadowAtlas();
 
 	bool init();
 	void shutdown();
 
-	ShadowMap* allocRecursive(uint32 _arrayIndex, int _targetLevel, uint16 _nodeIndex, int _nodeLevel, GLsizei _size);
-	void       freeRecursive(uint32 _arrayIndex, uint16 _nodeIndex, int _nodeLevel);
+	// Convert _size to a quadtree level, return -1 if _size < m_minSize.
+	int        getLevel(GLsizei _size) const;
+	ShadowMap* createShadowMap(const Allocator::Allocation& _allocation, int _level);
 
 };
 
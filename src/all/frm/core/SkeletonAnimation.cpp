@@ -9,8 +9,51 @@
 
 #include <im3d/im3d.h>
 
+#include <EASTL/sort.h>
+
+#if FRM_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
 using namespace frm;
 
+namespace {
+
+// Local TRS -> matrix, equivalent to TransformationMatrix() without the matrix multiply.
+inline void BoneMatrix(const vec3& _translation, const quat& _rotation, const vec3& _scale, mat4& out_)
+{
+	out_[0] = vec4(linalg::qxdir(_rotation) * _scale.x, 0.0f);
+	out_[1] = vec4(linalg::qydir(_rotation) * _scale.y, 0.0f);
+	out_[2] = vec4(linalg::qzdir(_rotation) * _scale.z, 0.0f);
+	out_[3] = vec4(_translation, 1.0f);
+}
+
+// out_ = _a * _b, out_ must not alias _a or _b.
+inline void MulMatrix(const mat4& _a, const mat4& _b, mat4& out_)
+{
+	#if FRM_SIMD_SSE2
+		const float* a = &_a[0][0];
+		const float* b = &_b[0][0];
+		float* out = &out_[0][0];
+		const __m128 a0 = _mm_loadu_ps(a + 0);
+		const __m128 a1 = _mm_loadu_ps(a + 4);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 a3 = _mm_loadu_ps(a + 12);
+		for (int i = 0; i < 4; ++i)
+		{
+			__m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[i * 4 + 0]));
+			r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[i * 4 + 1])));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[i * 4 + 2])));
+			r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[i * 4 + 3])));
+			_mm_storeu_ps(out + i * 4, r);
+		}
+	#else
+		out_ = _a * _b;
+	#endif
+}
+
+} // namespace
+
 /******************************************************************************
 
                                  Skeleton
@@ -139,17 +182,18 @@ const mat4* Skeleton::resolve()
 	{
 		const Bone& bone = m_bones[i];
 
-		mat4 m = TransformationMatrix(bone.translation, bone.rotation, bone.scale);
-
 		if (bone.parentIndex >= 0)
 		{
-			FRM_ASSERT(bone.parentIndex <= i); // parent must come before children
+			FRM_ASSERT(bone.parentIndex < i); // parent must come before children
 
-			// \todo Cheaper to apply the parent position/orientation/scale separately then build the matrix?
-			m = m_pose[bone.parentIndex] * m;
+			mat4 m;
+			BoneMatrix(bone.translation, bone.rotation, bone.scale, m);
+			MulMatrix(m_pose[bone.parentIndex], m, m_pose[i]);
+		}
+		else
+		{
+			BoneMatrix(bone.translation, bone.rotation, bone.scale, m_pose[i]);
 		}
-
-		m_pose[i] = m;
 	}
 
 	return m_pose.data();
@@ -189,6 +233,344 @@ void Skeleton::draw() const
 }
 
 
+/******************************************************************************
+
+                                SkeletonPose
+
+******************************************************************************/
+
+namespace {
+
+// Per lane blend weight.
+inline float LaneWeight(float _weight, const float* _boneMask, int _i)
+{
+	return _boneMask ? _weight * _boneMask[_i] : _weight;
+}
+
+#if FRM_SIMD_SSE2
+	inline __m128 LaneWeight4(__m128 _weight, const float* _boneMask, int _i)
+	{
+		return _boneMask ? _mm_mul_ps(_weight, _mm_loadu_ps(_boneMask + _i)) : _weight;
+	}
+
+	inline __m128 Lerp4(__m128 _a, __m128 _b, __m128 _t)
+	{
+		return _mm_add_ps(_a, _mm_mul_ps(_mm_sub_ps(_b, _a), _t));
+	}
+
+	// Normalize 4 quaternions (SoA).
+	inline void Normalize4(__m128 q_[4])
+	{
+		__m128 len2 = _mm_mul_ps(q_[0], q_[0]);
+		len2 = _mm_add_ps(len2, _mm_mul_ps(q_[1], q_[1]));
+		len2 = _mm_add_ps(len2, _mm_mul_ps(q_[2], q_[2]));
+		len2 = _mm_add_ps(len2, _mm_mul_ps(q_[3], q_[3]));
+		const __m128 rlen = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2));
+		for (int i = 0; i < 4; ++i)
+		{
+			q_[i] = _mm_mul_ps(q_[i], rlen);
+		}
+	}
+
+	// Negate _q_ where _dot < 0 (select the shortest path).
+	inline void Align4(__m128 _dot, __m128 q_[4])
+	{
+		const __m128 sign = _mm_and_ps(_mm_cmplt_ps(_dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+		for (int i = 0; i < 4; ++i)
+		{
+			q_[i] = _mm_xor_ps(q_[i], sign);
+		}
+	}
+
+	// out_ = _a * _b for 4 quaternions (SoA), see linalg::qmul().
+	inline void QuatMul4(const __m128 _a[4], const __m128 _b[4], __m128 out_[4])
+	{
+		#define MUL(_i, _j) _mm_mul_ps(_a[_i], _b[_j])
+		out_[0] = _mm_sub_ps(_mm_add_ps(_mm_add_ps(MUL(0, 3), MUL(3, 0)), MUL(1, 2)), MUL(2, 1));
+		out_[1] = _mm_sub_ps(_mm_add_ps(_mm_add_ps(MUL(1, 3), MUL(3, 1)), MUL(2, 0)), MUL(0, 2));
+		out_[2] = _mm_sub_ps(_mm_add_ps(_mm_add_ps(MUL(2, 3), MUL(3, 2)), MUL(0, 1)), MUL(1, 0));
+		out_[3] = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(MUL(3, 3), MUL(0, 0)), MUL(1, 1)), MUL(2, 2));
+		#undef MUL
+	}
+#endif
+
+inline quat LoadQuat(const float* const _q[4], int _i)
+{
+	return quat(_q[0][_i], _q[1][_i], _q[2][_i], _q[3][_i]);
+}
+
+inline void StoreQuat(const quat& _q, float* const q_[4], int _i)
+{
+	q_[0][_i] = _q.x;
+	q_[1][_i] = _q.y;
+	q_[2][_i] = _q.z;
+	q_[3][_i] = _q.w;
+}
+
+} // namespace
+
+// PUBLIC
+
+void SkeletonPose::setBoneCount(int _boneCount)
+{
+	m_boneCount = _boneCount;
+	m_stride    = (_boneCount + 3) & ~3;
+	m_data.resize(Component_Count * m_stride);
+	setIdentity();
+}
+
+void SkeletonPose::setIdentity()
+{
+	for (int i = 0; i < Component_Count; ++i)
+	{
+		const float value = (i == Component_RotationW || i >= Component_ScaleX) ? 1.0f : 0.0f;
+		eastl::fill(getComponent(i), getComponent(i) + m_stride, value);
+	}
+}
+
+void SkeletonPose::set(const Skeleton& _skeleton)
+{
+	if (m_boneCount != _skeleton.getBoneCount())
+	{
+		setBoneCount(_skeleton.getBoneCount());
+	}
+
+	for (int i = 0; i < m_boneCount; ++i)
+	{
+		const Skeleton::Bone& bone = _skeleton.getBone(i);
+		setTranslation(i, bone.translation);
+		setRotation(i, bone.rotation);
+		setScale(i, bone.scale);
+	}
+}
+
+void SkeletonPose::get(Skeleton& skeleton_) const
+{
+	FRM_ASSERT(skeleton_.getBoneCount() == m_boneCount);
+
+	for (int i = 0; i < m_boneCount; ++i)
+	{
+		Skeleton::Bone& bone = skeleton_.getBone(i);
+		bone.translation = getTranslation(i);
+		bone.rotation    = getRotation(i);
+		bone.scale       = getScale(i);
+	}
+}
+
+void SkeletonPose::Blend(const SkeletonPose& _a, const SkeletonPose& _b, float _weight, SkeletonPose& out_, const float* _boneMask)
+{
+	FRM_ASSERT(_a.m_boneCount == _b.m_boneCount);
+	if (out_.m_boneCount != _a.m_boneCount)
+	{
+		out_.setBoneCount(_a.m_boneCount);
+	}
+	const int n = _a.m_stride;
+
+	// Translation, scale: lerp.
+	static const Component kLerpComponents[] = { Component_TranslationX, Component_TranslationY, Component_TranslationZ, Component_ScaleX, Component_ScaleY, Component_ScaleZ };
+	for (Component component : kLerpComponents)
+	{
+		const float* a = _a.getComponent(component);
+		const float* b = _b.getComponent(component);
+		float* out = out_.getComponent(component);
+		int i = 0;
+		#if FRM_SIMD_SSE2
+			const __m128 weight = _mm_set1_ps(_weight);
+			for (; i + 4 <= n; i += 4)
+			{
+				_mm_storeu_ps(out + i, Lerp4(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i), LaneWeight4(weight, _boneMask, i)));
+			}
+		#endif
+		for (; i < n; ++i)
+		{
+			out[i] = lerp(a[i], b[i], LaneWeight(_weight, _boneMask, i));
+		}
+	}
+
+	// Rotation: nlerp.
+	const float* const a[4] = { _a.getComponent(Component_RotationX), _a.getComponent(Component_RotationY), _a.getComponent(Component_RotationZ), _a.getComponent(Component_RotationW) };
+	const float* const b[4] = { _b.getComponent(Component_RotationX), _b.getComponent(Component_RotationY), _b.getComponent(Component_RotationZ), _b.getComponent(Component_RotationW) };
+	float* const out[4] = { out_.getComponent(Component_RotationX), out_.getComponent(Component_RotationY), out_.getComponent(Component_RotationZ), out_.getComponent(Component_RotationW) };
+	int i = 0;
+	#if FRM_SIMD_SSE2
+		const __m128 weight = _mm_set1_ps(_weight);
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128 qa[4], qb[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				qa[j] = _mm_loadu_ps(a[j] + i);
+				qb[j] = _mm_loadu_ps(b[j] + i);
+			}
+			__m128 dot = _mm_mul_ps(qa[0], qb[0]);
+			for (int j = 1; j < 4; ++j)
+			{
+				dot = _mm_add_ps(dot, _mm_mul_ps(qa[j], qb[j]));
+			}
+			Align4(dot, qb);
+
+			const __m128 w = LaneWeight4(weight, _boneMask, i);
+			for (int j = 0; j < 4; ++j)
+			{
+				qa[j] = Lerp4(qa[j], qb[j], w);
+			}
+			Normalize4(qa);
+			for (int j = 0; j < 4; ++j)
+			{
+				_mm_storeu_ps(out[j] + i, qa[j]);
+			}
+		}
+	#endif
+	for (; i < n; ++i)
+	{
+		StoreQuat(linalg::qnlerp(LoadQuat(a, i), LoadQuat(b, i), LaneWeight(_weight, _boneMask, i)), out, i);
+	}
+}
+
+void SkeletonPose::Add(const SkeletonPose& _base, const SkeletonPose& _additive, float _weight, SkeletonPose& out_, const float* _boneMask)
+{
+	FRM_ASSERT(_base.m_boneCount == _additive.m_boneCount);
+	if (out_.m_boneCount != _base.m_boneCount)
+	{
+		out_.setBoneCount(_base.m_boneCount);
+	}
+	const int n = _base.m_stride;
+
+	// Translation: base + additive * w, scale: base * lerp(1, additive, w).
+	for (int c = 0; c < 3; ++c)
+	{
+		const float* baseT = _base.getComponent(Component_TranslationX + c);
+		const float* addT  = _additive.getComponent(Component_TranslationX + c);
+		float*       outT  = out_.getComponent(Component_TranslationX + c);
+		const float* baseS = _base.getComponent(Component_ScaleX + c);
+		const float* addS  = _additive.getComponent(Component_ScaleX + c);
+		float*       outS  = out_.getComponent(Component_ScaleX + c);
+		int i = 0;
+		#if FRM_SIMD_SSE2
+			const __m128 weight = _mm_set1_ps(_weight);
+			const __m128 one = _mm_set1_ps(1.0f);
+			for (; i + 4 <= n; i += 4)
+			{
+				const __m128 w = LaneWeight4(weight, _boneMask, i);
+				_mm_storeu_ps(outT + i, _mm_add_ps(_mm_loadu_ps(baseT + i), _mm_mul_ps(_mm_loadu_ps(addT + i), w)));
+				_mm_storeu_ps(outS + i, _mm_mul_ps(_mm_loadu_ps(baseS + i), Lerp4(one, _mm_loadu_ps(addS + i), w)));
+			}
+		#endif
+		for (; i < n; ++i)
+		{
+			const float w = LaneWeight(_weight, _boneMask, i);
+			outT[i] = baseT[i] + addT[i] * w;
+			outS[i] = baseS[i] * lerp(1.0f, addS[i], w);
+		}
+	}
+
+	// Rotation: base * nlerp(identity, additive, w).
+	const float* const base[4] = { _base.getComponent(Component_RotationX), _base.getComponent(Component_RotationY), _base.getComponent(Component_RotationZ), _base.getComponent(Component_RotationW) };
+	const float* const add[4]  = { _additive.getComponent(Component_RotationX), _additive.getComponent(Component_RotationY), _additive.getComponent(Component_RotationZ), _additive.getComponent(Component_RotationW) };
+	float* const out[4] = { out_.getComponent(Component_RotationX), out_.getComponent(Component_RotationY), out_.getComponent(Component_RotationZ), out_.getComponent(Component_RotationW) };
+	int i = 0;
+	#if FRM_SIMD_SSE2
+		const __m128 weight = _mm_set1_ps(_weight);
+		const __m128 identity[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_set1_ps(1.0f) };
+		for (; i + 4 <= n; i += 4)
+		{
+			__m128 qbase[4], qadd[4];
+			for (int j = 0; j < 4; ++j)
+			{
+				qbase[j] = _mm_loadu_ps(base[j] + i);
+				qadd[j]  = _mm_loadu_ps(add[j] + i);
+			}
+			Align4(qadd[3], qadd); // dot(identity, q) = q.w
+
+			const __m128 w = LaneWeight4(weight, _boneMask, i);
+			for (int j = 0; j < 4; ++j)
+			{
+				qadd[j] = Lerp4(identity[j], qadd[j], w);
+			}
+			Normalize4(qadd);
+
+			__m128 q[4];
+			QuatMul4(qbase, qadd, q);
+			for (int j = 0; j < 4; ++j)
+			{
+				_mm_storeu_ps(out[j] + i, q[j]);
+			}
+		}
+	#endif
+	for (; i < n; ++i)
+	{
+		const quat q = linalg::qnlerp(quat(0.0f, 0.0f, 0.0f, 1.0f), LoadQuat(add, i), LaneWeight(_weight, _boneMask, i));
+		StoreQuat(linalg::qmul(LoadQuat(base, i), q), out, i);
+	}
+}
+
+void SkeletonPose::MakeAdditive(const SkeletonPose& _pose, const SkeletonPose& _reference, SkeletonPose& out_)
+{
+	FRM_ASSERT(_pose.m_boneCount == _reference.m_boneCount);
+	if (out_.m_boneCount != _pose.m_boneCount)
+	{
+		out_.setBoneCount(_pose.m_boneCount);
+	}
+
+	// Not performance critical (called once per clip for the reference pose, or per sample for additive layers), hence scalar.
+	for (int i = 0; i < _pose.m_boneCount; ++i)
+	{
+		const vec3 referenceScale = _reference.getScale(i);
+		const vec3 scale = _pose.getScale(i);
+		out_.setTranslation(i, _pose.getTranslation(i) - _reference.getTranslation(i));
+		out_.setRotation(i, linalg::qmul(linalg::qconj(_reference.getRotation(i)), _pose.getRotation(i)));
+		out_.setScale(i, vec3(
+			referenceScale.x == 0.0f ? 1.0f : scale.x / referenceScale.x,
+			referenceScale.y == 0.0f ? 1.0f : scale.y / referenceScale.y,
+			referenceScale.z == 0.0f ? 1.0f : scale.z / referenceScale.z
+			));
+	}
+}
+
+vec3 SkeletonPose::getTranslation(int _boneIndex) const
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	return vec3(getComponent(Component_TranslationX)[_boneIndex], getComponent(Component_TranslationY)[_boneIndex], getComponent(Component_TranslationZ)[_boneIndex]);
+}
+
+quat SkeletonPose::getRotation(int _boneIndex) const
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	return quat(getComponent(Component_RotationX)[_boneIndex], getComponent(Component_RotationY)[_boneIndex], getComponent(Component_RotationZ)[_boneIndex], getComponent(Component_RotationW)[_boneIndex]);
+}
+
+vec3 SkeletonPose::getScale(int _boneIndex) const
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	return vec3(getComponent(Component_ScaleX)[_boneIndex], getComponent(Component_ScaleY)[_boneIndex], getComponent(Component_ScaleZ)[_boneIndex]);
+}
+
+void SkeletonPose::setTranslation(int _boneIndex, const vec3& _translation)
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	getComponent(Component_TranslationX)[_boneIndex] = _translation.x;
+	getComponent(Component_TranslationY)[_boneIndex] = _translation.y;
+	getComponent(Component_TranslationZ)[_boneIndex] = _translation.z;
+}
+
+void SkeletonPose::setRotation(int _boneIndex, const quat& _rotation)
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	getComponent(Component_RotationX)[_boneIndex] = _rotation.x;
+	getComponent(Component_RotationY)[_boneIndex] = _rotation.y;
+	getComponent(Component_RotationZ)[_boneIndex] = _rotation.z;
+	getComponent(Component_RotationW)[_boneIndex] = _rotation.w;
+}
+
+void SkeletonPose::setScale(int _boneIndex, const vec3& _scale)
+{
+	FRM_STRICT_ASSERT(_boneIndex < m_boneCount);
+	getComponent(Component_ScaleX)[_boneIndex] = _scale.x;
+	getComponent(Component_ScaleY)[_boneIndex] = _scale.y;
+	getComponent(Component_ScaleZ)[_boneIndex] = _scale.z;
+}
+
+
 /******************************************************************************
 
                            SkeletonAnimationTrack
@@ -318,7 +700,7 @@ int SkeletonAnimationTrack::findFrame(float _t)
 
 SkeletonAnimation* SkeletonAnimation::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	SkeletonAnimation* ret = Find(id);
 	if (!ret)
 	{
@@ -354,20 +736,26 @@ bool SkeletonAnimation::reload()
 		return false;
 	}
 
+	bool ret = false;
 	if (FileSystem::CompareExtension("gltf", m_path.c_str()))
 	{
-		return ReadGltf(*this, f.getData(), f.getDataSize());
+		ret = ReadGltf(*this, f.getData(), f.getDataSize());
 	}
 	else if (FileSystem::CompareExtension("md5anim", m_path.c_str()))
 	{
-		return ReadMd5(*this, f.getData(), f.getDataSize());
+		ret = ReadMd5(*this, f.getData(), f.getDataSize());
 	}
 	else
 	{
 		FRM_ASSERT(false); // unsupported format
 	}
 
-	return false;
+	if (ret)
+	{
+		bake();
+	}
+
+	return ret;
 }
 
 
@@ -385,11 +773,220 @@ void SkeletonAnimation::sample(float _t, Skeleton& _out_, int _hints_[])
 	}
 }
 
+void SkeletonAnimation::sample(float _t, SkeletonPose& pose_, int* _cursor_)
+{
+	if (m_bakeDirty)
+	{
+		bake();
+	}
+
+	const int keyCount = (int)m_keyTimes.size();
+	if (keyCount == 0)
+	{
+		return;
+	}
+
+	// Find the key segment, shared by all tracks.
+	int key = 0;
+	float alpha = 0.0f;
+	if (keyCount == 1 || _t <= m_keyTimes.front())
+	{
+		key = 0;
+	}
+	else if (_t >= m_keyTimes.back())
+	{
+		key = keyCount - 2;
+		alpha = 1.0f;
+	}
+	else
+	{
+		key = _cursor_ ? *_cursor_ : -1;
+		if (key < 0 || key >= keyCount - 1 || _t < m_keyTimes[key])
+		{
+			// No cursor or _t moved backwards, use binary search.
+			key = (int)(eastl::upper_bound(m_keyTimes.begin(), m_keyTimes.end(), _t) - m_keyTimes.begin()) - 1;
+		}
+		else
+		{
+			// Cursor, use linear search (_t < m_keyTimes.back() hence the loop terminates).
+			while (_t >= m_keyTimes[key + 1])
+			{
+				++key;
+			}
+		}
+		alpha = (_t - m_keyTimes[key]) / (m_keyTimes[key + 1] - m_keyTimes[key]);
+	}
+	if (_cursor_)
+	{
+		*_cursor_ = key;
+	}
+	const int nextKey = Min(key + 1, keyCount - 1);
+
+	// Interpolate all tracks in each group 4 at a time, scatter the results to the pose bones.
+	for (const TrackGroup& group : m_trackGroups)
+	{
+		if (group.m_trackCount == 0)
+		{
+			continue;
+		}
+
+		const int    keySize = group.m_componentCount * group.m_stride;
+		const float* a = group.m_data.data() + key * keySize;
+		const float* b = group.m_data.data() + nextKey * keySize;
+		float* out[4] = {};
+		for (int c = 0; c < group.m_componentCount; ++c)
+		{
+			out[c] = pose_.getComponent(group.m_firstComponent + c);
+		}
+
+		int i = 0;
+		#if FRM_SIMD_SSE2
+			const __m128 t = _mm_set1_ps(alpha);
+			for (; i < group.m_trackCount; i += 4) // m_stride is a multiple of 4
+			{
+				__m128 v[4];
+				for (int c = 0; c < group.m_componentCount; ++c)
+				{
+					v[c] = Lerp4(_mm_loadu_ps(a + c * group.m_stride + i), _mm_loadu_ps(b + c * group.m_stride + i), t);
+				}
+				if (group.m_componentCount == 4)
+				{
+					Normalize4(v); // keys are aligned to the same hemisphere by bake()
+				}
+
+				float lanes[4][4];
+				for (int c = 0; c < group.m_componentCount; ++c)
+				{
+					_mm_storeu_ps(lanes[c], v[c]);
+				}
+				for (int j = 0, n = Min(4, group.m_trackCount - i); j < n; ++j)
+				{
+					const int boneIndex = group.m_boneIndices[i + j];
+					FRM_STRICT_ASSERT(boneIndex < pose_.getBoneCount());
+					for (int c = 0; c < group.m_componentCount; ++c)
+					{
+						out[c][boneIndex] = lanes[c][j];
+					}
+				}
+			}
+		#endif
+		for (; i < group.m_trackCount; ++i)
+		{
+			float v[4];
+			float len2 = 0.0f;
+			for (int c = 0; c < group.m_componentCount; ++c)
+			{
+				v[c] = lerp(a[c * group.m_stride + i], b[c * group.m_stride + i], alpha);
+				len2 += v[c] * v[c];
+			}
+			const float scale = group.m_componentCount == 4 ? 1.0f / sqrtf(len2) : 1.0f;
+
+			const int boneIndex = group.m_boneIndices[i];
+			FRM_STRICT_ASSERT(boneIndex < pose_.getBoneCount());
+			for (int c = 0; c < group.m_componentCount; ++c)
+			{
+				out[c][boneIndex] = v[c] * scale;
+			}
+		}
+	}
+}
+
+void SkeletonAnimation::bake()
+{
+	// Union of all track key times.
+	m_keyTimes.clear();
+	for (const SkeletonAnimationTrack& track : m_tracks)
+	{
+		m_keyTimes.insert(m_keyTimes.end(), track.m_frames.begin(), track.m_frames.end());
+	}
+	eastl::sort(m_keyTimes.begin(), m_keyTimes.end());
+	m_keyTimes.erase(eastl::unique(m_keyTimes.begin(), m_keyTimes.end(), [](float _a, float _b) { return _b - _a < 1e-6f; }), m_keyTimes.end());
+	const int keyCount = (int)m_keyTimes.size();
+
+	static const int kGroupOffsets[TrackGroup_Count]         = { offsetof(Skeleton::Bone, translation) / sizeof(float), offsetof(Skeleton::Bone, rotation) / sizeof(float), offsetof(Skeleton::Bone, scale) / sizeof(float) };
+	static const int kGroupComponentCounts[TrackGroup_Count] = { 3, 4, 3 };
+	static const int kGroupFirstComponents[TrackGroup_Count] = { SkeletonPose::Component_TranslationX, SkeletonPose::Component_RotationX, SkeletonPose::Component_ScaleX };
+	static const float kGroupIdentity[TrackGroup_Count][4]   = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+
+	for (int groupIndex = 0; groupIndex < TrackGroup_Count; ++groupIndex)
+	{
+		TrackGroup& group = m_trackGroups[groupIndex];
+		group.m_componentCount = kGroupComponentCounts[groupIndex];
+		group.m_firstComponent = kGroupFirstComponents[groupIndex];
+		group.m_boneIndices.clear();
+		eastl::vector<SkeletonAnimationTrack*> tracks;
+		for (SkeletonAnimationTrack& track : m_tracks)
+		{
+			if (track.m_boneDataOffset == kGroupOffsets[groupIndex] && track.m_boneDataSize == group.m_componentCount && !track.m_frames.empty())
+			{
+				tracks.push_back(&track);
+				group.m_boneIndices.push_back(track.m_boneIndex);
+			}
+		}
+		group.m_trackCount = (int)tracks.size();
+		group.m_stride     = (group.m_trackCount + 3) & ~3;
+
+		// Padding lanes are identity.
+		const int keySize = group.m_componentCount * group.m_stride;
+		group.m_data.resize(keyCount * keySize);
+		for (int key = 0; key < keyCount; ++key)
+		{
+			for (int c = 0; c < group.m_componentCount; ++c)
+			{
+				float* data = group.m_data.data() + key * keySize + c * group.m_stride;
+				eastl::fill(data + group.m_trackCount, data + group.m_stride, kGroupIdentity[groupIndex][c]);
+			}
+		}
+
+		for (int i = 0; i < group.m_trackCount; ++i)
+		{
+			SkeletonAnimationTrack& track = *tracks[i];
+			float prev[4] = {};
+			for (int key = 0; key < keyCount; ++key)
+			{
+				// Resample the track at the key time, clamp outside the track's range.
+				const float t = m_keyTimes[key];
+				float v[4];
+				if (t <= track.m_frames.front())
+				{
+					memcpy(v, track.m_data.data(), sizeof(float) * group.m_componentCount);
+				}
+				else if (t >= track.m_frames.back())
+				{
+					memcpy(v, track.m_data.data() + track.m_data.size() - group.m_componentCount, sizeof(float) * group.m_componentCount);
+				}
+				else
+				{
+					track.sample(t, v);
+				}
+
+				// Align rotations to the previous key so that sample() can nlerp without checking the sign.
+				if (group.m_componentCount == 4 && key > 0 && (v[0] * prev[0] + v[1] * prev[1] + v[2] * prev[2] + v[3] * prev[3]) < 0.0f)
+				{
+					for (int c = 0; c < 4; ++c)
+					{
+						v[c] = -v[c];
+					}
+				}
+				memcpy(prev, v, sizeof(prev));
+
+				for (int c = 0; c < group.m_componentCount; ++c)
+				{
+					group.m_data[key * keySize + c * group.m_stride + i] = v[c];
+				}
+			}
+		}
+	}
+
+	m_bakeDirty = false;
+}
+
 SkeletonAnimationTrack* SkeletonAnimation::addTranslationTrack(int _boneIndex, int _frameCount, float* _normalizedTimes, float* _data)
 {
 	const int offset = offsetof(Skeleton::Bone, translation) / sizeof(float);
 	FRM_ASSERT(findTrack(_boneIndex, offset, 3) == nullptr); // track already exists
 	m_tracks.push_back(SkeletonAnimationTrack(_boneIndex, offset, 3, _frameCount, _normalizedTimes, _data));
+	m_bakeDirty = true;
 	return &m_tracks.back();
 }
 SkeletonAnimationTrack* SkeletonAnimation::addRotationTrack(int _boneIndex, int _frameCount, float* _normalizedTimes, float* _data)
@@ -397,6 +994,7 @@ SkeletonAnimationTrack* SkeletonAnimation::addRotationTrack(int _boneIndex, int
 	const int offset = offsetof(Skeleton::Bone, rotation) / sizeof(float);
 	FRM_ASSERT(findTrack(_boneIndex, offset, 4) == nullptr); // track already exists
 	m_tracks.push_back(SkeletonAnimationTrack(_boneIndex, offset, 4, _frameCount, _normalizedTimes, _data));
+	m_bakeDirty = true;
 	return &m_tracks.back();
 }
 SkeletonAnimationTrack* SkeletonAnimation::addScaleTrack(int _boneIndex, int _frameCount, float* _normalizedTimes, float* _data)
@@ -404,6 +1002,7 @@ SkeletonAnimationTrack* SkeletonAnimation::addScaleTrack(int _boneIndex, int _fr
 	const int offset = offsetof(Skeleton::Bone, scale) / sizeof(float);
 	FRM_ASSERT(findTrack(_boneIndex, offset, 3) == nullptr); // track already exists
 	m_tracks.push_back(SkeletonAnimationTrack(_boneIndex, offset, 3, _frameCount, _normalizedTimes, _data));
+	m_bakeDirty = true;
 	return &m_tracks.back();
 }
 
@@ -431,3 +1030,151 @@ SkeletonAnimationTrack* SkeletonAnimation::findTrack(int _boneIndex, int _boneDa
 	}
 	return nullptr;
 }
+
+
+/******************************************************************************
+
+                              SkeletonBlendTree
+
+******************************************************************************/
+
+// PUBLIC
+
+SkeletonBlendTree::SkeletonBlendTree(const Skeleton& _basePose)
+{
+	m_basePose.set(_basePose);
+	m_pose      = m_basePose;
+	m_layerPose = m_basePose;
+	m_fadePose  = m_basePose;
+}
+
+int SkeletonBlendTree::addLayer(BlendMode _mode, float _weight)
+{
+	Layer& layer = m_layers.push_back();
+	layer.m_mode   = _mode;
+	layer.m_weight = _weight;
+	return (int)m_layers.size() - 1;
+}
+
+void SkeletonBlendTree::setLayerMask(int _layer, const float* _boneWeights)
+{
+	Layer& layer = m_layers[_layer];
+	if (_boneWeights == nullptr)
+	{
+		layer.m_mask.clear();
+		return;
+	}
+
+	layer.m_mask.assign(m_basePose.getStride(), 0.0f);
+	memcpy(layer.m_mask.data(), _boneWeights, sizeof(float) * m_basePose.getBoneCount());
+}
+
+void SkeletonBlendTree::play(int _layer, SkeletonAnimation* _anim, float _fadeDuration, float _speed, float _time)
+{
+	Layer& layer = m_layers[_layer];
+
+	if (_fadeDuration > 0.0f)
+	{
+		layer.m_previous = layer.m_current;
+		layer.m_fade     = 0.0f;
+		layer.m_fadeRate = 1.0f / _fadeDuration;
+	}
+	else
+	{
+		layer.m_previous = Clip();
+		layer.m_fade     = 1.0f;
+		layer.m_fadeRate = 0.0f;
+	}
+
+	layer.m_current = Clip();
+	layer.m_current.m_anim  = _anim;
+	layer.m_current.m_speed = _speed;
+	layer.m_current.m_time  = _time;
+	if (_anim && layer.m_mode == BlendMode_Additive)
+	{
+		layer.m_current.m_reference = m_basePose;
+		_anim->sample(0.0f, layer.m_current.m_reference);
+	}
+}
+
+void SkeletonBlendTree::update(float _dt)
+{
+	for (Layer& layer : m_layers)
+	{
+		for (Clip* clip : { &layer.m_current, &layer.m_previous })
+		{
+			if (clip->m_anim)
+			{
+				clip->m_time = Fract(clip->m_time + _dt * clip->m_speed);
+			}
+		}
+
+		if (layer.m_fade < 1.0f)
+		{
+			layer.m_fade = Min(layer.m_fade + _dt * layer.m_fadeRate, 1.0f);
+			if (layer.m_fade >= 1.0f)
+			{
+				layer.m_previous = Clip();
+			}
+		}
+	}
+}
+
+void SkeletonBlendTree::evaluate(Skeleton& skeleton_)
+{
+	m_pose = m_basePose;
+
+	for (Layer& layer : m_layers)
+	{
+		const bool hasCurrent  = layer.m_current.m_anim != nullptr;
+		const bool hasPrevious = layer.m_previous.m_anim != nullptr && layer.m_fade < 1.0f;
+		float weight = layer.m_weight;
+		if ((!hasCurrent && !hasPrevious) || weight <= 0.0f)
+		{
+			continue;
+		}
+
+		if (hasCurrent)
+		{
+			sampleClip(layer.m_current, layer.m_mode, m_layerPose);
+			if (hasPrevious)
+			{
+				sampleClip(layer.m_previous, layer.m_mode, m_fadePose);
+				SkeletonPose::Blend(m_fadePose, m_layerPose, layer.m_fade, m_layerPose);
+			}
+			else
+			{
+				weight *= layer.m_fade; // fade in from no clip
+			}
+		}
+		else
+		{
+			sampleClip(layer.m_previous, layer.m_mode, m_layerPose);
+			weight *= 1.0f - layer.m_fade; // fade out to no clip
+		}
+
+		const float* mask = layer.m_mask.empty() ? nullptr : layer.m_mask.data();
+		if (layer.m_mode == BlendMode_Additive)
+		{
+			SkeletonPose::Add(m_pose, m_layerPose, weight, m_pose, mask);
+		}
+		else
+		{
+			SkeletonPose::Blend(m_pose, m_layerPose, weight, m_pose, mask);
+		}
+	}
+
+	m_pose.get(skeleton_);
+}
+
+// PRIVATE
+
+void SkeletonBlendTree::sampleClip(Clip& _clip, BlendMode _mode, SkeletonPose& pose_)
+{
+	pose_ = m_basePose;
+	_clip.m_anim->sample(_clip.m_time, pose_, &_clip.m_cursor);
+	if (_mode == BlendMode_Additive)
+	{
+		SkeletonPose::MakeAdditive(pose_, _clip.m_reference, pose_);
+	}
+}
@@ -58,6 +58,73 @@ private:
 	eastl::vector<BoneName> m_boneNames;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// SkeletonPose
+// Local space bone transforms in SoA layout for SIMD sampling/blending. Each
+// component (translation x, y, z, rotation x, y, z, w, scale x, y, z) is a
+// separate array of getStride() floats; the stride is the bone count rounded
+// up to a multiple of 4, padding bones are identity.
+//
+// Blend functions may be called with out_ aliasing either input. _boneMask is
+// optional per bone weights in [0,1] (getStride() floats, see SkeletonBlendTree).
+///////////////////////////////////////////////////////////////////////////////
+class SkeletonPose
+{
+public:
+
+	enum Component_
+	{
+		Component_TranslationX,
+		Component_TranslationY,
+		Component_TranslationZ,
+		Component_RotationX,
+		Component_RotationY,
+		Component_RotationZ,
+		Component_RotationW,
+		Component_ScaleX,
+		Component_ScaleY,
+		Component_ScaleZ,
+
+		Component_Count
+	};
+	typedef int Component;
+
+	             SkeletonPose(int _boneCount = 0) { setBoneCount(_boneCount); }
+
+	// Resize to _boneCount bones, new bones are identity.
+	void         setBoneCount(int _boneCount);
+	void         setIdentity();
+
+	// Copy local bone transforms from/to _skeleton.
+	void         set(const Skeleton& _skeleton);
+	void         get(Skeleton& skeleton_) const;
+
+	// Crossfade, out_ = lerp(_a, _b, _weight), rotations are nlerp'd along the shortest path.
+	static void  Blend(const SkeletonPose& _a, const SkeletonPose& _b, float _weight, SkeletonPose& out_, const float* _boneMask = nullptr);
+	// Apply a difference pose (see MakeAdditive()) to _base: translations are added, rotations/scales are multiplied.
+	static void  Add(const SkeletonPose& _base, const SkeletonPose& _additive, float _weight, SkeletonPose& out_, const float* _boneMask = nullptr);
+	// Difference between _pose and _reference such that Add(_reference, out_, 1.0f) == _pose.
+	static void  MakeAdditive(const SkeletonPose& _pose, const SkeletonPose& _reference, SkeletonPose& out_);
+
+	vec3         getTranslation(int _boneIndex) const;
+	quat         getRotation(int _boneIndex) const;
+	vec3         getScale(int _boneIndex) const;
+	void         setTranslation(int _boneIndex, const vec3& _translation);
+	void         setRotation(int _boneIndex, const quat& _rotation);
+	void         setScale(int _boneIndex, const vec3& _scale);
+
+	      float* getComponent(Component _component)       { return m_data.data() + _component * m_stride; }
+	const float* getComponent(Component _component) const { return m_data.data() + _component * m_stride; }
+	int          getBoneCount() const                     { return m_boneCount; }
+	int          getStride() const                        { return m_stride; }
+
+private:
+
+	int                  m_boneCount = 0;
+	int                  m_stride    = 0;
+	eastl::vector<float> m_data;        // Component_Count * m_stride
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // SkeletonAnimationTrack
 // Ordered list of frame data and normalized frame times.
@@ -110,6 +177,15 @@ public:
 
 	void sample(float _t, Skeleton& out_, int _hints_[] = nullptr);
 
+	// Sample all tracks at _t (in [0,1]) into the bones of pose_, bones without a track are unchanged. _cursor_ is a key index
+	// shared by all tracks; as with the hints above it avoids a binary search when _t increases monotonically between calls.
+	// \note This uses the baked track data (see bake()), which is only valid for concurrent use after calling bake().
+	void sample(float _t, SkeletonPose& pose_, int* _cursor_ = nullptr);
+
+	// Resample all tracks at the union of their key times into SoA blocks for sample(SkeletonPose&). Called by reload() and
+	// lazily by sample() after add*(); call manually after SkeletonAnimationTrack::addFrames().
+	void bake();
+
 	// \note add* functions invalidate ptrs previously returned.
 	SkeletonAnimationTrack* addTranslationTrack(int _boneIndex, int _frameCount = 0, float* _normalizedTimes = nullptr, float* _data = nullptr);
 	SkeletonAnimationTrack* addRotationTrack(int _boneIndex, int _frameCount = 0, float* _normalizedTimes = nullptr, float* _data = nullptr);
@@ -130,6 +206,21 @@ private:
 	eastl::vector<SkeletonAnimationTrack> m_tracks;
 	Skeleton m_baseFrame;
 
+	// Baked tracks of the same type (translation, rotation or scale), see bake().
+	struct TrackGroup
+	{
+		int                  m_componentCount = 0; // floats per track
+		int                  m_firstComponent = 0; // see SkeletonPose::Component
+		int                  m_trackCount     = 0;
+		int                  m_stride         = 0; // m_trackCount rounded up to a multiple of 4
+		eastl::vector<int>   m_boneIndices;        // per track
+		eastl::vector<float> m_data;               // per key, m_componentCount * m_stride floats (SoA)
+	};
+	enum TrackGroup_ { TrackGroup_Translation, TrackGroup_Rotation, TrackGroup_Scale, TrackGroup_Count };
+	TrackGroup           m_trackGroups[TrackGroup_Count];
+	eastl::vector<float> m_keyTimes;              // union of all track key times
+	bool                 m_bakeDirty = true;
+
 	SkeletonAnimationTrack* findTrack(int _boneIndex, int _boneDataOffset, int _boneDataSize);
 
 	static bool ReadMd5(SkeletonAnimation& anim_, const char* _srcData, uint _srcDataSize);
@@ -137,5 +228,88 @@ private:
 
 }; // class SkeletonAnimation
 
+///////////////////////////////////////////////////////////////////////////////
+// SkeletonBlendTree
+// Layered animation blending for a single skeleton instance. Layers are
+// evaluated in order on top of the base pose:
+//
+// BlendMode_Override  Crossfade from the accumulated pose by the layer weight.
+// BlendMode_Additive  Add the difference between the clip and its first frame,
+//                     scaled by the layer weight.
+//
+// Each layer has an optional per bone mask (e.g. to restrict an upper body
+// layer) and can crossfade between clips (see play()). Clip times are
+// normalized, layer speeds are in clip lengths per second.
+///////////////////////////////////////////////////////////////////////////////
+class SkeletonBlendTree
+{
+public:
+
+	enum BlendMode_
+	{
+		BlendMode_Override,
+		BlendMode_Additive,
+
+		BlendMode_Count
+	};
+	typedef int BlendMode;
+
+	// _basePose provides bones with no animation track, usually SkeletonAnimation::getBaseFrame().
+	             SkeletonBlendTree(const Skeleton& _basePose);
+
+	// Return the index of the new layer.
+	int          addLayer(BlendMode _mode = BlendMode_Override, float _weight = 1.0f);
+	void         setLayerWeight(int _layer, float _weight)      { m_layers[_layer].m_weight = _weight; }
+	float        getLayerWeight(int _layer) const               { return m_layers[_layer].m_weight; }
+	// Per bone weights for _layer (getBoneCount() floats), nullptr to remove the mask.
+	void         setLayerMask(int _layer, const float* _boneWeights);
+
+	// Play _anim on _layer from _time, crossfade from the current clip over _fadeDuration seconds. _anim may be nullptr to fade
+	// out the layer.
+	void         play(int _layer, SkeletonAnimation* _anim, float _fadeDuration = 0.0f, float _speed = 1.0f, float _time = 0.0f);
+	float        getLayerTime(int _layer) const                 { return m_layers[_layer].m_current.m_time; }
+	void         setLayerTime(int _layer, float _time)          { m_layers[_layer].m_current.m_time = _time; }
+
+	// Advance clip times and crossfades by _dt seconds.
+	void         update(float _dt);
+	// Evaluate all layers, write the result to the local bones of skeleton_. Call Skeleton::resolve() to get the final pose.
+	void         evaluate(Skeleton& skeleton_);
+
+	const SkeletonPose& getPose() const                         { return m_pose; }
+	int          getLayerCount() const                          { return (int)m_layers.size(); }
+	int          getBoneCount() const                           { return m_basePose.getBoneCount(); }
+
+private:
+
+	struct Clip
+	{
+		SkeletonAnimation* m_anim      = nullptr;
+		float              m_time      = 0.0f;
+		float              m_speed     = 1.0f;
+		int                m_cursor    = 0;
+		SkeletonPose       m_reference;           // additive layers only, the clip's first frame
+	};
+
+	struct Layer
+	{
+		BlendMode            m_mode      = BlendMode_Override;
+		float                m_weight    = 1.0f;
+		eastl::vector<float> m_mask;              // empty if no mask, else SkeletonPose::getStride() floats
+		Clip                 m_current;
+		Clip                 m_previous;          // crossfade source
+		float                m_fade      = 1.0f;  // crossfade progress in [0,1]
+		float                m_fadeRate  = 0.0f;
+	};
+
+	SkeletonPose         m_basePose;
+	SkeletonPose         m_pose;
+	SkeletonPose         m_layerPose;  // evaluate() scratch
+	SkeletonPose         m_fadePose;   //         "
+	eastl::vector<Layer> m_layers;
+
+	void sampleClip(Clip& _clip, BlendMode _mode, SkeletonPose& pose_);
+
+}; // class SkeletonBlendTree
+
 } // namespace frm
 
@@ -35,7 +35,7 @@ SplinePath* SplinePath::Create(Serializer& _serializer_)
 
 SplinePath* SplinePath::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	SplinePath* ret = Find(id);
 	if (!ret)
 	{
@@ -64,7 +64,7 @@ private:
 #define FRM_DECLARE_STATIC_INIT(_type) \
 	static frm::StaticInitializer<_type> _type ## _StaticInitializer
 #define FRM_DEFINE_STATIC_INIT(_type, _onInit, _onShutdown) \
-	template <> int  frm::StaticInitializer<_type>::s_initCounter; \
+	template <> int  frm::StaticInitializer<_type>::s_initCounter = 0; \
 	template <> void frm::StaticInitializer<_type>::Init()     { _onInit(); } \
 	template <> void frm::StaticInitializer<_type>::Shutdown() { _onShutdown(); }
 
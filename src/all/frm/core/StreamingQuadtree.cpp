@@ -5,24 +5,23 @@
 #include <im3d/im3d.h>
 #include <imgui/imgui.h>
 
-#include <EASTL/sort.h>
+#include <EASTL/fixed_vector.h>
 
 namespace frm {
 
 // PUBLIC
 
 StreamingQuadtree::StreamingQuadtree(int _levelCount, int _nodePoolSize)
-	: m_nodePool(_nodePoolSize)
-	, m_nodeQuadtree(_levelCount, nullptr)
-	, m_stateQuadtree(_levelCount, NodeState_Invalid)
-	, m_dataQuadtree(_levelCount, nullptr)
+	: m_handleQuadtree(_levelCount, NodeHandle_Invalid)
 	, m_maxLevel(_levelCount - 1)
 {
 	m_lodRadii2.resize(_levelCount);
 	setLodScale(m_lodScale);
 
-	m_nodeQuadtree[0] = m_nodePool.alloc();
-	queueForLoad(0);
+	m_nodePool.reserve((uint)_nodePoolSize);
+	NodeHandle root = m_nodePool.alloc(0, 0, vec2(0.0f), 2.0f);
+	m_handleQuadtree[0] = root;
+	queueForLoad(root);
 }
 
 StreamingQuadtree::~StreamingQuadtree()
@@ -36,92 +35,66 @@ void StreamingQuadtree::update()
 	if (m_updateDrawList)
 	{
 		m_drawList.clear();
-		m_nodeQuadtree.traverse(
-			[&](NodeIndex _nodeIndex, int _nodeLevel)
+
+	 // split/merge and build the draw list in a single traversal
+	 // a node is drawn if it's loaded and it has no children or any child isn't loaded; 'covered' nodes have a drawn ancestor
+		struct Visit { NodeHandle m_node; bool m_covered; };
+		eastl::fixed_vector<Visit, Quadtree_Handle::GetAbsoluteMaxLevelCount() * 4> tstack;
+		if (getHandle(0) != NodeHandle_Invalid)
+		{
+			tstack.push_back({ getHandle(0), false });
+		}
+		while (!tstack.empty())
+		{
+			Visit visit = tstack.back();
+			tstack.pop_back();
+			NodeHandle node = visit.m_node;
+
+			if (wantSplit(node))
 			{
-				PROFILER_MARKER_CPU("Visit Node");
+				split(node);
 
-				#if 0
+				NodeIndex firstChildIndex = m_handleQuadtree.getFirstChildIndex(m_nodePool.index[node], m_nodePool.level[node]);
+				bool childrenLoaded = true;
+				for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
 				{
-				 // \todo it's probaly possible to update the draw list during the split/merge traversal but the node selection code below need
-				 // to be merged with the split/merge logic
-					if (m_stateQuadtree[_nodeIndex] == NodeState_Loaded)
-					{
-						NodeIndex firstChildIndex = m_nodeQuadtree.getFirstChildIndex(_nodeIndex, _nodeLevel);
-						if (firstChildIndex == NodeIndex_Invalid)
-						{
-							m_drawList.push_back(_nodeIndex);
-						}
-						else
-						{
-							for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
-							{
-								if (m_stateQuadtree[childIndex] != NodeState_Loaded)
-								{
-									m_drawList.push_back(_nodeIndex);
-									break;
-								}
-							}
-						}
-					}
+					childrenLoaded &= m_nodePool.state[getHandle(childIndex)] == NodeState_Loaded;
 				}
-				#endif
 
-				Node* node = m_nodeQuadtree[_nodeIndex];
-				if (wantSplit(node))
+				bool draw = !visit.m_covered && !childrenLoaded; // wantSplit() implies that node is loaded
+				if (draw)
 				{
-					split(node);
-					return true;
+					m_drawList.push_back(m_nodePool.index[node]);
 				}
-				else
+				for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
 				{
-					merge(node);
-					return false;
+					tstack.push_back({ getHandle(childIndex), visit.m_covered || draw });
 				}
-			},
-			0
-			);
-
-		#if 1
-		{
-		 // \todo see the comment in the first traversal above
-			m_nodeQuadtree.traverse(
-				[&](NodeIndex _nodeIndex, int _nodeLevel)
+			}
+			else
+			{
+				merge(node);
+				if (!visit.m_covered && m_nodePool.state[node] == NodeState_Loaded)
 				{
-					if (m_stateQuadtree[_nodeIndex] != NodeState_Loaded)
-					{
-						return false;
-					}
-					NodeIndex firstChildIndex = m_nodeQuadtree.getFirstChildIndex(_nodeIndex, _nodeLevel);
-					if (firstChildIndex == NodeIndex_Invalid)
-					{
-						m_drawList.push_back(_nodeIndex);
-						return false;
-					}
-					for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
-					{
-						if (m_stateQuadtree[childIndex] != NodeState_Loaded)
-						{
-							m_drawList.push_back(_nodeIndex);
-							return false;
-						}
-					}
-					return true;
-				},
-				0
-				);		
+					m_drawList.push_back(m_nodePool.index[node]);
+				}
+			}
 		}
-		#endif
 
 		m_updateDrawList = false;
 	}
-	sortLoadQueue();
+
+	if (m_updateLoadQueue)
+	{
+		updateLoadQueue();
+		m_updateLoadQueue = false;
+	}
 }
 
 void StreamingQuadtree::drawDebug(const mat4& _world)
 {
 	/*ImGui::Text("Total node count: %u", m_nodePool.getUsedCount());
-	ImGui::Text("Load queue:       %u", m_loadQueue.size());
+	ImGui::Text("Load queue:       %u", m_loadQueueCount);
 	ImGui::Text("Release queue:    %u", m_releaseQueue.size());
 	ImGui::Text("Draw list:        %u", m_drawList.size());
 	if (ImGui::SliderFloat("LOD Scale", &m_lodScale, 1e-4f, 2.0f))
@@ -138,7 +111,7 @@ void StreamingQuadtree::drawDebug(const mat4& _world)
 
 	Im3d::SetSize(2.0f);
 
-	m_nodeQuadtree.traverse(
+	m_handleQuadtree.traverse(
 		[&](NodeIndex _nodeIndex, int _nodeLevel)
 		{
 			const Im3d::Color kLevelColors[] =
@@ -151,8 +124,8 @@ void StreamingQuadtree::drawDebug(const mat4& _world)
 				Im3d::Color_Cyan
 			};
 
-			Node* node = m_nodeQuadtree[_nodeIndex];
-			if (!node)
+			NodeHandle node = getHandle(_nodeIndex);
+			if (node == NodeHandle_Invalid)
 			{
 				return false;
 			}
@@ -160,20 +133,20 @@ void StreamingQuadtree::drawDebug(const mat4& _world)
 			{
 				return true;
 			}
-			vec3 boxSize = vec3(node->m_widthQ / 2.0f, node->m_widthQ / 2.0f, node->m_heightQ);
-			vec3 boxMin  = node->m_originQ + vec3(-boxSize.xy(), 0.0f);
-			vec3 boxMax  = node->m_originQ + vec3( boxSize.xy(), boxSize.z);
+			float halfWidthQ = m_nodePool.widthQ[node] / 2.0f;
+			vec3 boxMin = vec3(m_nodePool.originQ[node] - vec2(halfWidthQ), 0.0f);
+			vec3 boxMax = vec3(m_nodePool.originQ[node] + vec2(halfWidthQ), 1.0f);
 			Im3d::SetColor(kLevelColors[_nodeLevel % FRM_ARRAY_COUNT(kLevelColors)]);
 			Im3d::SetAlpha(1.0f);
 			Im3d::DrawAlignedBox(boxMin, boxMax);
-	
-			NodeState state = m_stateQuadtree[_nodeIndex];
-			if (m_stateQuadtree[_nodeIndex] != NodeState_Loaded)
+
+			NodeState state = m_nodePool.state[node];
+			if (state != NodeState_Loaded)
 			{
 				Im3d::PushEnableSorting();
 				Im3d::SetColor(state == NodeState_QueuedForLoad ? Im3d::Color_Yellow : Im3d::Color_Cyan);
 				Im3d::SetAlpha(0.25f);
-				Im3d::DrawAlignedBoxFilled(boxMin, boxMax);				
+				Im3d::DrawAlignedBoxFilled(boxMin, boxMax);
 				Im3d::PopEnableSorting();
 			}
 			return false;
@@ -186,19 +159,15 @@ void StreamingQuadtree::drawDebug(const mat4& _world)
 	Im3d::PushEnableSorting();
 	for (NodeIndex nodeIndex : m_drawList)
 	{
-		Node* node = m_nodeQuadtree[nodeIndex];
-		if (!node)
+		NodeHandle node = getHandle(nodeIndex);
+		if (node == NodeHandle_Invalid)
 		{
 			continue;
 		}
-		vec3 boxSize = vec3(node->m_widthQ / 2.0f, node->m_widthQ / 2.0f, node->m_heightQ);
-		vec3 boxMin  = node->m_originQ + vec3(-boxSize.xy(), 0.0f);
-		vec3 boxMax  = node->m_originQ + vec3( boxSize.xy(), boxSize.z);
-		Im3d::DrawAlignedBoxFilled(boxMin, boxMax);	
-
-		int nodeLevel = Quadtree<NodeIndex, Node*>::FindLevel(nodeIndex);
-		uvec2 cartesian = Quadtree<NodeIndex, Node*>::ToCartesian(nodeIndex, nodeLevel);
-		//Im3d::Text((boxMin + boxMax) * 0.5f, 1.0f, Im3d::Color_White, Im3d::TextFlags_AlignLeft, "[%d] %u, %u\n%.2f, %.2f", nodeLevel, cartesian.x, cartesian.y, node->m_originQ.x * 0.5f + 0.5f, node->m_originQ.y * 0.5f + 0.5f);
+		float halfWidthQ = m_nodePool.widthQ[node] / 2.0f;
+		vec3 boxMin = vec3(m_nodePool.originQ[node] - vec2(halfWidthQ), 0.0f);
+		vec3 boxMax = vec3(m_nodePool.originQ[node] + vec2(halfWidthQ), 1.0f);
+		Im3d::DrawAlignedBoxFilled(boxMin, boxMax);
 	}
 	Im3d::PopEnableSorting();
 
@@ -208,13 +177,18 @@ void StreamingQuadtree::drawDebug(const mat4& _world)
 
 void StreamingQuadtree::setPivot(const vec3& _pivotQ, const vec3& _directionQ)
 {
-	m_directionQ = _directionQ;
+	if (length2(_directionQ - m_directionQ) >= FLT_EPSILON)
+	{
+		m_directionQ = _directionQ;
+		m_updateLoadQueue = true;
+	}
 	if (length2(_pivotQ - m_pivotQ) < FLT_EPSILON) // \todo use leaf node half width instead of FLT_EPSILON
 	{
 		return;
 	}
 	m_pivotQ = _pivotQ;
 	m_updateDrawList = true;
+	m_updateLoadQueue = true;
 }
 
 void StreamingQuadtree::setLodScale(float _lodScale)
@@ -234,41 +208,69 @@ void StreamingQuadtree::setLodScale(float _lodScale)
 
 void StreamingQuadtree::setMaxLevel(int _maxLevel)
 {
-	const int kAbsoluteMaxLevel = m_nodeQuadtree.getLevelCount() - 1;
+	const int kAbsoluteMaxLevel = m_handleQuadtree.getLevelCount() - 1;
 	int newMaxLevel = (_maxLevel < 0) ? kAbsoluteMaxLevel : Min(_maxLevel, kAbsoluteMaxLevel);
 	bool requireMerge = newMaxLevel < m_maxLevel;
 	m_maxLevel = newMaxLevel;
 	if (requireMerge)
-	{		
-		merge(m_nodeQuadtree[0]);
+	{
+		merge(getHandle(0));
 	}
 	m_updateDrawList = true;
 }
 
+StreamingQuadtree::Node StreamingQuadtree::getNode(NodeIndex _nodeIndex) const
+{
+	NodeHandle node = getHandle(_nodeIndex);
+	FRM_ASSERT(node != NodeHandle_Invalid);
+
+	Node ret;
+	ret.m_index   = _nodeIndex;
+	ret.m_level   = m_nodePool.level[node];
+	ret.m_originQ = vec3(m_nodePool.originQ[node], 0.0f);
+	ret.m_widthQ  = m_nodePool.widthQ[node];
+	ret.m_heightQ = 1.0f;
+	return ret;
+}
+
+StreamingQuadtree::NodeState StreamingQuadtree::getNodeState(NodeIndex _nodeIndex) const
+{
+	NodeHandle node = getHandle(_nodeIndex);
+	return node == NodeHandle_Invalid ? (NodeState)NodeState_Invalid : m_nodePool.state[node];
+}
+
+void* StreamingQuadtree::getNodeData(NodeIndex _nodeIndex) const
+{
+	NodeHandle node = getHandle(_nodeIndex);
+	return node == NodeHandle_Invalid ? nullptr : m_nodePool.data[node];
+}
+
 void StreamingQuadtree::setNodeData(NodeIndex _nodeIndex, void* _data)
 {
-	FRM_ASSERT(m_nodeQuadtree[_nodeIndex]);
-	m_dataQuadtree[_nodeIndex] = _data;
+	NodeHandle node = getHandle(_nodeIndex);
+	FRM_ASSERT(node != NodeHandle_Invalid);
+	m_nodePool.data[node] = _data;
 	if (_data)
 	{
 		m_updateDrawList = true; // node may be split in the next update
-		m_stateQuadtree[_nodeIndex] = NodeState_Loaded;
+		m_nodePool.state[node] = NodeState_Loaded;
 	}
 	else
 	{
-		releaseNode(_nodeIndex);
+		releaseNode(node);
 	}
 }
 
 StreamingQuadtree::NodeIndex StreamingQuadtree::popLoadQueue()
 {
-	if (m_loadQueue.empty())
+	if (m_loadBucketMask == 0)
 	{
 		return NodeIndex_Invalid;
 	}
-	NodeIndex ret = m_loadQueue.back();
-	m_loadQueue.pop_back();
-	return ret;
+	NodeQueue& bucket = m_loadBuckets[FindFirstSet(m_loadBucketMask)];
+	NodeHandle node = bucket.back();
+	eraseLoadQueue(node);
+	return m_nodePool.index[node];
 }
 
 StreamingQuadtree::NodeIndex StreamingQuadtree::popReleaseQueue()
@@ -277,126 +279,173 @@ StreamingQuadtree::NodeIndex StreamingQuadtree::popReleaseQueue()
 	{
 		return NodeIndex_Invalid;
 	}
-	NodeIndex ret = m_releaseQueue.back();
-	m_releaseQueue.pop_back();
-	return ret;
+	NodeHandle node = m_releaseQueue.back();
+	eraseQueue(m_releaseQueue, node);
+	return m_nodePool.index[node];
 }
 
 void StreamingQuadtree::releaseAll()
 {
-	merge(m_nodeQuadtree[0]);
-	queueForRelease(0);
+	NodeHandle root = getHandle(0);
+	if (root != NodeHandle_Invalid)
+	{
+		merge(root);
+		queueForRelease(root);
+	}
+	m_updateDrawList = true;
 }
 
 // PROTECTED
 
-bool StreamingQuadtree::isLeaf(const Node* _node) const
+void StreamingQuadtree::NodePool::reserve(uint _capacity)
 {
-	FRM_ASSERT(_node);
-	NodeIndex firstChildIndex = m_nodeQuadtree.getFirstChildIndex(_node->m_index, _node->m_level);
-	return firstChildIndex == NodeIndex_Invalid || m_stateQuadtree[firstChildIndex] == NodeState_Invalid;
+	index.reserve(_capacity);
+	level.reserve(_capacity);
+	state.reserve(_capacity);
+	originQ.reserve(_capacity);
+	widthQ.reserve(_capacity);
+	data.reserve(_capacity);
+	loadBucket.reserve(_capacity);
+	queuePosition.reserve(_capacity);
 }
 
-bool StreamingQuadtree::wantSplit(const Node* _node) const
+StreamingQuadtree::NodeHandle StreamingQuadtree::NodePool::alloc(NodeIndex _index, int _level, const vec2& _originQ, float _widthQ)
 {
-	FRM_ASSERT(_node);
-	
+	NodeHandle ret;
+	if (freeList.empty())
+	{
+		FRM_ASSERT(index.size() < NodeHandle_Invalid); // too many nodes
+		ret = (NodeHandle)index.size();
+		index.push_back();
+		level.push_back();
+		state.push_back();
+		originQ.push_back();
+		widthQ.push_back();
+		data.push_back();
+		loadBucket.push_back();
+		queuePosition.push_back();
+	}
+	else
+	{
+		ret = freeList.back();
+		freeList.pop_back();
+	}
+
+	index[ret]         = _index;
+	level[ret]         = (uint8)_level;
+	state[ret]         = NodeState_Invalid;
+	originQ[ret]       = _originQ;
+	widthQ[ret]        = _widthQ;
+	data[ret]          = nullptr;
+	loadBucket[ret]    = 0;
+	queuePosition[ret] = (uint16)~0;
+	return ret;
+}
+
+void StreamingQuadtree::NodePool::free(NodeHandle _handle)
+{
+	FRM_ASSERT(queuePosition[_handle] == (uint16)~0); // still in a queue
+	index[_handle] = NodeIndex_Invalid;
+	state[_handle] = NodeState_Invalid;
+	freeList.push_back(_handle);
+}
+
+bool StreamingQuadtree::isLeaf(NodeHandle _node) const
+{
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+	NodeIndex firstChildIndex = m_handleQuadtree.getFirstChildIndex(m_nodePool.index[_node], m_nodePool.level[_node]);
+	return firstChildIndex == NodeIndex_Invalid || getHandle(firstChildIndex) == NodeHandle_Invalid;
+}
+
+bool StreamingQuadtree::wantSplit(NodeHandle _node) const
+{
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+
  // split only if not a leaf node and if loaded
-	if (_node->m_level == m_maxLevel || m_stateQuadtree[_node->m_index] != NodeState_Loaded)
+	const int level = m_nodePool.level[_node];
+	if (level == m_maxLevel || m_nodePool.state[_node] != NodeState_Loaded)
 	{
 		return false;
 	}
 
-	float halfWidthQ = _node->m_widthQ / 2.0f;
-	vec3 boxMin = vec3(_node->m_originQ.x - halfWidthQ, _node->m_originQ.y - halfWidthQ, 0.0f);
-	vec3 boxMax = vec3(_node->m_originQ.x + halfWidthQ, _node->m_originQ.y + halfWidthQ, _node->m_heightQ);
-	
+	float halfWidthQ = m_nodePool.widthQ[_node] / 2.0f;
+	vec2  originQ    = m_nodePool.originQ[_node];
+	vec3  boxMin     = vec3(originQ.x - halfWidthQ, originQ.y - halfWidthQ, 0.0f);
+	vec3  boxMax     = vec3(originQ.x + halfWidthQ, originQ.y + halfWidthQ, 1.0f);
+
  // sphere-AABB intersection
 	float d2 = 0.0f;
 	for (int i = 0; i < 3; ++i)
 	{
 		float v = m_pivotQ[i];
 		float d = 0.0f;
-		if (v < boxMin[i]) 
+		if (v < boxMin[i])
 		{
 			d = boxMin[i] - v;
 		}
-		if (v > boxMax[i]) 
+		if (v > boxMax[i])
 		{
 			d = v - boxMax[i];
 		}
 		d2 += d * d;
 	}
-	return d2 < m_lodRadii2[_node->m_level];
+	return d2 < m_lodRadii2[level];
 }
 
-void StreamingQuadtree::split(const Node* _node)
+void StreamingQuadtree::split(NodeHandle _node)
 {
 	PROFILER_MARKER_CPU("StreamingQuadtree::split");
 
-	FRM_ASSERT(_node);
-	FRM_ASSERT(_node->m_level != m_maxLevel);
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+	FRM_ASSERT(m_nodePool.level[_node] != m_maxLevel);
+
+	const int   level           = m_nodePool.level[_node];
+	const vec2  originQ         = m_nodePool.originQ[_node];
+	const float childWidthQ     = m_nodePool.widthQ[_node] / 2.0f;
+	const float childOffset     = childWidthQ / 2.0f;
+	const vec2  childOffsets[4] = { vec2(-childOffset, -childOffset), vec2(-childOffset, childOffset), vec2(childOffset, -childOffset), vec2(childOffset, childOffset) };
+	NodeIndex firstChildIndex = m_handleQuadtree.getFirstChildIndex(m_nodePool.index[_node], level);
 
-	NodeIndex firstChildIndex = m_nodeQuadtree.getFirstChildIndex(_node->m_index, _node->m_level);
- 
  // can't make any assumptions about the state of child nodes since the release queue can be processed arbitrarily
-	//if (m_nodeQuadtree[firstChildIndex])
-	//{
-	//	queueForLoad(firstChildIndex + 0);
-	//	queueForLoad(firstChildIndex + 1);
-	//	queueForLoad(firstChildIndex + 2);
-	//	queueForLoad(firstChildIndex + 3);
-	//	return;
-	//}
-	
-	for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
+	for (int i = 0; i < 4; ++i)
 	{
-		Node*& child = m_nodeQuadtree[childIndex];
-		if (!child)
+		NodeIndex childIndex = firstChildIndex + (NodeIndex)i;
+		NodeHandle& child = m_handleQuadtree[childIndex];
+		if (child == NodeHandle_Invalid)
 		{
-			child           = m_nodePool.alloc();
-			child->m_index  = childIndex;
-			child->m_level  = _node->m_level + 1;
-			child->m_widthQ = _node->m_widthQ / 2.0f;
+			child = m_nodePool.alloc(childIndex, level + 1, originQ + childOffsets[i], childWidthQ);
 		}
-		queueForLoad(childIndex);
+		queueForLoad(child);
 	}
-	float childOffset = _node->m_widthQ / 4.0f;
-	m_nodeQuadtree[firstChildIndex + 0]->m_originQ = _node->m_originQ + vec3(-childOffset, -childOffset, _node->m_originQ.z);
-	m_nodeQuadtree[firstChildIndex + 1]->m_originQ = _node->m_originQ + vec3(-childOffset,  childOffset, _node->m_originQ.z);
-	m_nodeQuadtree[firstChildIndex + 2]->m_originQ = _node->m_originQ + vec3( childOffset, -childOffset, _node->m_originQ.z);
-	m_nodeQuadtree[firstChildIndex + 3]->m_originQ = _node->m_originQ + vec3( childOffset,  childOffset, _node->m_originQ.z);
 }
 
-void StreamingQuadtree::merge(const Node* _node)
+void StreamingQuadtree::merge(NodeHandle _node)
 {
-	if (!_node || isLeaf(_node))
+	if (_node == NodeHandle_Invalid || isLeaf(_node))
 	{
 		return;
 	}
 
 	PROFILER_MARKER_CPU("StreamingQuadtree::merge");
 
-	NodeIndex firstChildIndex = m_nodeQuadtree.getFirstChildIndex(_node->m_index, _node->m_level);
+	NodeIndex firstChildIndex = m_handleQuadtree.getFirstChildIndex(m_nodePool.index[_node], m_nodePool.level[_node]);
 	for (NodeIndex childIndex = firstChildIndex; childIndex < (firstChildIndex + 4); ++childIndex)
 	{
-		Node*& child = m_nodeQuadtree[childIndex];
-		if (!child)
+		NodeHandle child = getHandle(childIndex);
+		if (child == NodeHandle_Invalid)
 		{
 			continue;
 		}
-		FRM_ASSERT(child->m_index == childIndex);
+		FRM_ASSERT(m_nodePool.index[child] == childIndex);
 		merge(child);
-		queueForRelease(childIndex);
+		queueForRelease(child);
 	}
 }
 
-void StreamingQuadtree::queueForLoad(NodeIndex _nodeIndex)
+void StreamingQuadtree::queueForLoad(NodeHandle _node)
 {
-	PROFILER_MARKER_CPU("StreamingQuadtree::queueForLoad");
-
-	FRM_ASSERT(m_nodeQuadtree[_nodeIndex]);
-	NodeState& state = m_stateQuadtree[_nodeIndex];
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+	NodeState& state = m_nodePool.state[_node];
 	if (state == NodeState_QueuedForLoad || state == NodeState_Loaded)
 	{
 		return;
@@ -405,28 +454,23 @@ void StreamingQuadtree::queueForLoad(NodeIndex _nodeIndex)
  // cancel pending release (in which case node can return to a loaded state and we don't need to queue it)
 	if (state == NodeState_QueuedForRelease)
 	{
-		auto it = eastl::find(m_releaseQueue.begin(), m_releaseQueue.end(), _nodeIndex);
-		FRM_ASSERT(it != m_releaseQueue.end());
-		m_releaseQueue.erase_unsorted(it);
-		FRM_ASSERT(m_dataQuadtree[_nodeIndex] != nullptr); // if queued for release the data should still be present
+		eraseQueue(m_releaseQueue, _node);
+		FRM_ASSERT(m_nodePool.data[_node] != nullptr); // if queued for release the data should still be present
 		state = NodeState_Loaded;
 	}
  // else push into load queue
 	else
 	{
-		FRM_ASSERT(eastl::find(m_loadQueue.begin(), m_loadQueue.end(), _nodeIndex) == m_loadQueue.end()); // shouldn't already be in the queue
-		m_loadQueue.push_back(_nodeIndex);
+		pushLoadQueue(_node);
 		state = NodeState_QueuedForLoad;
 	}
 }
 
-void StreamingQuadtree::queueForRelease(NodeIndex _nodeIndex)
+void StreamingQuadtree::queueForRelease(NodeHandle _node)
 {
-	PROFILER_MARKER_CPU("StreamingQuadtree::queueForRelease");
-
-	FRM_ASSERT(m_nodeQuadtree[_nodeIndex]);
-	NodeState& state = m_stateQuadtree[_nodeIndex];
-	if (state == NodeState_QueuedForRelease|| state == NodeState_Invalid)
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+	NodeState& state = m_nodePool.state[_node];
+	if (state == NodeState_QueuedForRelease || state == NodeState_Invalid)
 	{
 		return;
 	}
@@ -434,47 +478,101 @@ void StreamingQuadtree::queueForRelease(NodeIndex _nodeIndex)
  // cancel pending load (in which case the node can be freed and we don't need to queue it)
 	if (state == NodeState_QueuedForLoad)
 	{
-		auto it = eastl::find(m_loadQueue.begin(), m_loadQueue.end(), _nodeIndex);
-		FRM_ASSERT(it != m_loadQueue.end());
-		m_loadQueue.erase_unsorted(it);
-		FRM_ASSERT(m_dataQuadtree[_nodeIndex] == nullptr); // if queued for load the data should not be present
-		releaseNode(_nodeIndex);
+		eraseLoadQueue(_node);
+		FRM_ASSERT(m_nodePool.data[_node] == nullptr); // if queued for load the data should not be present
+		releaseNode(_node);
 	}
  // else push into release queue
 	else
 	{
-		FRM_ASSERT(eastl::find(m_releaseQueue.begin(), m_releaseQueue.end(), _nodeIndex) == m_releaseQueue.end()); // shouldn't already be in the queue
-		m_releaseQueue.push_back(_nodeIndex);
+		pushQueue(m_releaseQueue, _node);
 		state = NodeState_QueuedForRelease;
 	}
 }
 
-void StreamingQuadtree::releaseNode(NodeIndex _nodeIndex)
+void StreamingQuadtree::releaseNode(NodeHandle _node)
 {
-	PROFILER_MARKER_CPU("StreamingQuadtree::releaseNode");
+	FRM_ASSERT(_node != NodeHandle_Invalid);
+	FRM_ASSERT(m_nodePool.data[_node] == nullptr);
+	m_handleQuadtree[m_nodePool.index[_node]] = NodeHandle_Invalid;
+	m_nodePool.free(_node);
+}
 
-	FRM_ASSERT(m_dataQuadtree[_nodeIndex] == nullptr);
-	FRM_ASSERT(m_nodeQuadtree[_nodeIndex]);
-	m_nodePool.free(m_nodeQuadtree[_nodeIndex]);
-	m_nodeQuadtree[_nodeIndex] = nullptr;
-	m_stateQuadtree[_nodeIndex] = NodeState_Invalid;
+int StreamingQuadtree::getLoadBucket(NodeHandle _node) const
+{
+ // priority is the distance from the pivot along the view direction, nodes furthest along the view direction are loaded first
+ // \todo bucket range is a heuristic, covers the quadtree plus some margin for the pivot being outside
+	constexpr float kRange = 4.0f;
+	float len2 = length2(m_directionQ);
+	if (len2 < FLT_EPSILON)
+	{
+		return kLoadBucketCount / 2;
+	}
+	vec3  directionQ = m_directionQ / sqrtf(len2);
+	float priority   = Dot(directionQ, vec3(m_nodePool.originQ[_node], 0.0f) - m_pivotQ);
+	int   ret        = (int)((kRange - priority) / (2.0f * kRange) * (float)kLoadBucketCount);
+	return Clamp(ret, 0, kLoadBucketCount - 1);
+}
+
+void StreamingQuadtree::pushQueue(NodeQueue& _queue, NodeHandle _node)
+{
+	FRM_ASSERT(m_nodePool.queuePosition[_node] == (uint16)~0); // shouldn't already be in a queue
+	m_nodePool.queuePosition[_node] = (uint16)_queue.size();
+	_queue.push_back(_node);
+}
+
+void StreamingQuadtree::eraseQueue(NodeQueue& _queue, NodeHandle _node)
+{
+ // swap with the back, O(1)
+	uint16& position = m_nodePool.queuePosition[_node];
+	FRM_ASSERT(position < _queue.size() && _queue[position] == _node);
+	NodeHandle back = _queue.back();
+	_queue[position] = back;
+	m_nodePool.queuePosition[back] = position;
+	_queue.pop_back();
+	position = (uint16)~0;
+}
+
+void StreamingQuadtree::pushLoadQueue(NodeHandle _node)
+{
+	int bucket = getLoadBucket(_node);
+	m_nodePool.loadBucket[_node] = (uint8)bucket;
+	pushQueue(m_loadBuckets[bucket], _node);
+	m_loadBucketMask |= (uint64)1 << bucket;
+	++m_loadQueueCount;
 }
 
-void StreamingQuadtree::sortLoadQueue()
+void StreamingQuadtree::eraseLoadQueue(NodeHandle _node)
 {
-	PROFILER_MARKER_CPU("StreamingQuadtree::sortLoadQueue");
+	int bucket = m_nodePool.loadBucket[_node];
+	eraseQueue(m_loadBuckets[bucket], _node);
+	if (m_loadBuckets[bucket].empty())
+	{
+		m_loadBucketMask &= ~((uint64)1 << bucket);
+	}
+	--m_loadQueueCount;
+}
 
-	if (m_loadQueue.size() > 2) 
+void StreamingQuadtree::updateLoadQueue()
+{
+	PROFILER_MARKER_CPU("StreamingQuadtree::updateLoadQueue");
+
+ // move nodes whose priority changed, O(n) in the size of the load queue
+	for (int bucket = 0; bucket < kLoadBucketCount; ++bucket)
 	{
-		eastl::sort(m_loadQueue.begin(), m_loadQueue.end(), 
-			[this](NodeIndex _a, NodeIndex _b)
+		NodeQueue& queue = m_loadBuckets[bucket];
+		for (size_t i = 0; i < queue.size();)
+		{
+			NodeHandle node = queue[i];
+			if (getLoadBucket(node) == bucket)
 			{
-				vec3 da = m_pivotQ - m_nodeQuadtree[_a]->m_originQ;
-				vec3 db = m_pivotQ - m_nodeQuadtree[_b]->m_originQ;
-				return Dot(m_directionQ, db) < Dot(m_directionQ, da);
+				++i;
+				continue;
 			}
-			);
+			eraseLoadQueue(node); // swaps the back into i
+			pushLoadQueue(node);
+		}
 	}
 }
 
-} // namespace frm
\ No newline at end of file
+} // namespace frm
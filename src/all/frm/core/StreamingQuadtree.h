@@ -2,7 +2,6 @@
 
 #include <frm/core/frm.h>
 #include <frm/core/math.h>
-#include <frm/core/Pool.h>
 #include <frm/core/Quadtree.h>
 
 #include <EASTL/vector.h>
@@ -13,21 +12,26 @@ namespace frm {
 // StreamingQuadtree
 // Manages quadtree subdivision, with load/release requests.
 //
-// Node subdivision is controlled by periodically setting the 'pivot' (subdivision 
+// Node subdivision is controlled by periodically setting the 'pivot' (subdivision
 // center) and servicing data requests. Each level in the quadtree has a
-// corresponding LOD sphere centered on the pivot; a node is subdivided if it 
-// intersects the corresponding sphere. LOD sphere radii are controlled by a 
+// corresponding LOD sphere centered on the pivot; a node is subdivided if it
+// intersects the corresponding sphere. LOD sphere radii are controlled by a
 // single scale value (see setLodScale()).
 //
 // Nodes are identified by their linear quadtree index. Node origin is at node
 // center in XY, the node base in Z.
 //
-// Quadtree space (suffix Q) is in [-1,1] (XY), [0,1] (Z) with 0 being the origin 
+// Quadtree space (suffix Q) is in [-1,1] (XY), [0,1] (Z) with 0 being the origin
 // of the root node (like NDC).
 //
-// \todo
-// - Don't store Node*/void* in the quadtrees, use a special pool which can be
-//   accessed by a 16 bit index (and just store 16 bits).
+// Internally the quadtree stores a 16 bit handle per node into a SoA node pool,
+// unallocated nodes are NodeHandle_Invalid. update() performs split/merge and
+// builds the draw list in a single traversal.
+//
+// The load queue is bucketed by priority (distance from the pivot along the
+// view direction, see setPivot()). popLoadQueue() returns a node from the
+// highest priority non-empty bucket, nodes within a bucket are unordered.
+// Buckets are recomputed only when the pivot changes.
 ////////////////////////////////////////////////////////////////////////////////
 class StreamingQuadtree
 {
@@ -42,7 +46,7 @@ public:
 		NodeState_QueuedForLoad,
 		NodeState_Loaded,
 		NodeState_QueuedForRelease,
-	
+
 		NodeState_Count
 	};
 	typedef uint8 NodeState;
@@ -66,17 +70,18 @@ public:
 	void      setLodScale(float _lodScale);
 	float     getLodScale() const { return m_lodScale; }
 
-	// Set the max subdivision level. -1 = absolute max level for the quadtree. 
+	// Set the max subdivision level. -1 = absolute max level for the quadtree.
 	void      setMaxLevel(int _maxLevel);
 
-	const Node* getNode(NodeIndex _nodeIndex) const      { return m_nodeQuadtree[_nodeIndex]; }
-	NodeState   getNodeState(NodeIndex _nodeIndex) const { return m_stateQuadtree[_nodeIndex]; }
+	// Return the node at _nodeIndex, which must be allocated (state != NodeState_Invalid).
+	Node      getNode(NodeIndex _nodeIndex) const;
+	NodeState getNodeState(NodeIndex _nodeIndex) const;
 
-	void*     getNodeData(NodeIndex _nodeIndex) const { return m_dataQuadtree[_nodeIndex]; }
+	void*     getNodeData(NodeIndex _nodeIndex) const;
 	void      setNodeData(NodeIndex _nodeIndex, void* _data);
 
 	NodeIndex popLoadQueue();
-	size_t    getLoadQueueCount() const    { return m_loadQueue.size(); }
+	size_t    getLoadQueueCount() const    { return m_loadQueueCount; }
 	NodeIndex popReleaseQueue();
 	size_t    getReleaseQueueCount() const { return m_releaseQueue.size(); }
 
@@ -87,15 +92,36 @@ public:
 	NodeIndex getDrawList(int i) const     { return m_drawList[i]; }
 
 protected:
-	
-	typedef Quadtree<NodeIndex, Node*>     Quadtree_Node;
-	typedef Quadtree<NodeIndex, NodeState> Quadtree_State;
-	typedef Quadtree<NodeIndex, void*>     Quadtree_Data;
-
-	Pool<Node>               m_nodePool;
-	Quadtree_Node            m_nodeQuadtree;
-	Quadtree_State           m_stateQuadtree;
-	Quadtree_Data            m_dataQuadtree;
+
+	typedef uint16 NodeHandle;
+	static constexpr NodeHandle NodeHandle_Invalid = ~NodeHandle(0);
+
+	// SoA node storage, addressed by NodeHandle.
+	struct NodePool
+	{
+		eastl::vector<NodeIndex>  index;
+		eastl::vector<uint8>      level;
+		eastl::vector<NodeState>  state;
+		eastl::vector<vec2>       originQ;       // XY, Z is always 0.
+		eastl::vector<float>      widthQ;
+		eastl::vector<void*>      data;
+		eastl::vector<uint8>      loadBucket;    // If NodeState_QueuedForLoad.
+		eastl::vector<uint16>     queuePosition; // Position in the load bucket or release queue, ~0 if not queued.
+		eastl::vector<NodeHandle> freeList;
+
+		void       reserve(uint _capacity);
+		NodeHandle alloc(NodeIndex _index, int _level, const vec2& _originQ, float _widthQ);
+		void       free(NodeHandle _handle);
+		size_t     getUsedCount() const          { return index.size() - freeList.size(); }
+	};
+
+	typedef Quadtree<NodeIndex, NodeHandle> Quadtree_Handle;
+
+	static constexpr int kLoadBucketCount = 64;
+	typedef eastl::vector<NodeHandle> NodeQueue;
+
+	NodePool                 m_nodePool;
+	Quadtree_Handle          m_handleQuadtree;
 	int                      m_maxLevel        = 0;
 	vec3                     m_pivotQ          = vec3(0.0f);
 	vec3                     m_directionQ      = vec3(0.0f, 0.0f, 1.0f);
@@ -103,19 +129,27 @@ protected:
 	eastl::vector<float>     m_lodRadii2;
 	bool                     m_updateDrawList  = true;
 	eastl::vector<NodeIndex> m_drawList;
-	eastl::vector<NodeIndex> m_loadQueue;
-	eastl::vector<NodeIndex> m_releaseQueue;
-
-	bool isLeaf(const Node* _node) const;
-	bool wantSplit(const Node* _node) const;
-	void split(const Node* _node);
-	void merge(const Node* _node);
-	void queueForLoad(NodeIndex _nodeIndex);
-	void queueForRelease(NodeIndex _nodeIndex);
-	void releaseNode(NodeIndex _nodeIndex);
-	void sortLoadQueue();
+	NodeQueue                m_loadBuckets[kLoadBucketCount]; // Bucket 0 is the highest priority.
+	uint64                   m_loadBucketMask  = 0;           // Bit per non-empty bucket.
+	size_t                   m_loadQueueCount  = 0;
+	bool                     m_updateLoadQueue = false;       // Recompute load buckets during the next update().
+	NodeQueue                m_releaseQueue;
+
+	NodeHandle getHandle(NodeIndex _nodeIndex) const { return m_handleQuadtree[_nodeIndex]; }
+	bool isLeaf(NodeHandle _node) const;
+	bool wantSplit(NodeHandle _node) const;
+	void split(NodeHandle _node);
+	void merge(NodeHandle _node);
+	void queueForLoad(NodeHandle _node);
+	void queueForRelease(NodeHandle _node);
+	void releaseNode(NodeHandle _node);
+	int  getLoadBucket(NodeHandle _node) const;
+	void pushQueue(NodeQueue& _queue, NodeHandle _node);
+	void eraseQueue(NodeQueue& _queue, NodeHandle _node);
+	void pushLoadQueue(NodeHandle _node);
+	void eraseLoadQueue(NodeHandle _node);
+	void updateLoadQueue();
 
 }; // class StreamingQuadtree
 
 } // namespace frm
-
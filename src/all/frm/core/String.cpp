@@ -56,7 +56,7 @@ using namespace frm;
 
 // PUBLIC
 
-uint StringBase::set(const char* _src, uint _count)
+frm::uint StringBase::set(const char* _src, uint _count)
 {
 	if (!_src) {
 		return m_length;
@@ -74,7 +74,7 @@ uint StringBase::set(const char* _src, uint _count)
 	return srclen;
 }
 
-uint StringBase::setf(const char* _fmt, ...)
+frm::uint StringBase::setf(const char* _fmt, ...)
 {
 	va_list args;
 	va_start(args, _fmt);
@@ -83,7 +83,7 @@ uint StringBase::setf(const char* _fmt, ...)
 	return ret;
 }
 
-uint StringBase::setfv(const char* _fmt, va_list _args)
+frm::uint StringBase::setfv(const char* _fmt, va_list _args)
 {
 	va_list args;
 	va_copy(args, _args);
@@ -95,20 +95,20 @@ uint StringBase::setfv(const char* _fmt, va_list _args)
 	if (m_capacity < (uint)len + 1) {
 		alloc(len + 1);
 	}
-	FRM_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, args) >= 0);
+	FRM_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, _args) >= 0); // args was consumed by the first pass
 #else
 	int len = vsnprintf(m_buf, m_capacity, _fmt, args);
 	FRM_STRICT_ASSERT(len >= 0);
 	if (m_capacity < len + 1) {
 		alloc(len + 1);
-		FRM_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, args) >= 0);
+		FRM_VERIFY(vsnprintf(m_buf, m_capacity, _fmt, _args) >= 0);
 	}
 #endif
 	m_length = (uint)len;
 	return m_length;
 }
 
-uint StringBase::append(const char* _src, uint _count)
+frm::uint StringBase::append(const char* _src, uint _count)
 {
 	if (!_src) {
 		return m_length;
@@ -128,7 +128,7 @@ uint StringBase::append(const char* _src, uint _count)
 	return len;
 }
 
-uint StringBase::appendf(const char* _fmt, ...)
+frm::uint StringBase::appendf(const char* _fmt, ...)
 {
 	va_list args;
 	va_start(args, _fmt);
@@ -137,7 +137,7 @@ uint StringBase::appendf(const char* _fmt, ...)
 	return ret;
 }
 
-uint StringBase::appendfv(const char* _fmt, va_list _args)
+frm::uint StringBase::appendfv(const char* _fmt, va_list _args)
 {
 	va_list args;
 	va_copy(args, _args);
@@ -148,7 +148,7 @@ uint StringBase::appendfv(const char* _fmt, va_list _args)
 	if (m_capacity < len + srclen + 1) {
 		realloc(len + srclen + 1);
 	}
-	FRM_VERIFY(vsnprintf(m_buf + len, m_capacity, _fmt, args) >= 0);
+	FRM_VERIFY(vsnprintf(m_buf + len, m_capacity - len, _fmt, _args) >= 0); // args was consumed by the first pass
 	m_length = (uint)srclen + len;
 	return m_length;
 }
@@ -188,7 +188,7 @@ const char* StringBase::find(const char* _str) const
 	return strstr(m_buf, _str);
 }
 
-uint StringBase::replace(char _find, char _replace)
+frm::uint StringBase::replace(char _find, char _replace)
 {
 	char* tmp = m_buf;
 	uint ret = 0;
@@ -201,7 +201,7 @@ uint StringBase::replace(char _find, char _replace)
 	return ret;
 }
 
-uint StringBase::replace(const char* _find, const char* _replace)
+frm::uint StringBase::replace(const char* _find, const char* _replace)
 {
 	String<256> tmp;
 	const uint findlen = strlen(_find);
@@ -226,7 +226,7 @@ uint StringBase::replace(const char* _find, const char* _replace)
 	return ret;
 }
 
-uint StringBase::replacef(const char* _find, const char* _fmt, ...)
+frm::uint StringBase::replacef(const char* _find, const char* _fmt, ...)
 {
 	va_list args;
 	va_start(args, _fmt);
@@ -235,14 +235,14 @@ uint StringBase::replacef(const char* _find, const char* _fmt, ...)
 	return ret;
 }
 
-uint StringBase::replacefv(const char* _find, const char* _fmt, va_list _args)
+frm::uint StringBase::replacefv(const char* _find, const char* _fmt, va_list _args)
 {
 	String<64> tmp;
 	tmp.setfv(_fmt, _args);
 	return replace(_find, (const char*)tmp);
 }
 
-uint StringBase::replacei(char _find, char _replace)
+frm::uint StringBase::replacei(char _find, char _replace)
 {
 	_find = tolower(_find);
 	char* tmp = m_buf;
@@ -256,7 +256,7 @@ uint StringBase::replacei(char _find, char _replace)
 	return ret;
 }
 
-uint StringBase::replacei(const char* _find, const char* _replace)
+frm::uint StringBase::replacei(const char* _find, const char* _replace)
 {
 	String<256> tmp;
 	const uint findlen = strlen(_find);
@@ -281,7 +281,7 @@ uint StringBase::replacei(const char* _find, const char* _replace)
 	return ret;
 }
 
-uint StringBase::replaceif(const char* _find, const char* _fmt, ...)
+frm::uint StringBase::replaceif(const char* _find, const char* _fmt, ...)
 {
 	va_list args;
 	va_start(args, _fmt);
@@ -290,7 +290,7 @@ uint StringBase::replaceif(const char* _find, const char* _fmt, ...)
 	return ret;
 }
 
-uint StringBase::replaceifv(const char* _find, const char* _fmt, va_list _args)
+frm::uint StringBase::replaceifv(const char* _find, const char* _fmt, va_list _args)
 {
 	String<64> tmp;
 	tmp.setfv(_fmt, _args);
@@ -477,8 +477,13 @@ void StringBase::alloc(uint _capacity)
 void StringBase::realloc(uint _capacity)
 {
 	if (!m_buf || isLocal()) {
-		m_buf = (char*)FRM_MALLOC(_capacity * sizeof(char));
-		memcpy(m_buf, getLocalBuf(), m_length + 1);
+		char* buf = (char*)FRM_MALLOC(_capacity * sizeof(char));
+		if (m_buf) {
+			memcpy(buf, m_buf, m_length + 1);
+		} else {
+			buf[0] = '\0'; // String<0> has no local buffer
+		}
+		m_buf = buf;
 		m_capacity = _capacity;
 	
 	} else {
@@ -615,7 +615,7 @@ static double GlGetBytesPerPixel(GLenum _format)
 
 Texture* Texture::Create(const char* _path, SourceLayout _layout)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	Texture* ret = Find(id);
 	if (!ret)
 	{
@@ -631,6 +631,20 @@ Texture* Texture::Create(const char* _path, SourceLayout _layout)
 	return ret;
 }
 
+Texture* Texture::CreateAsync(const char* _path, SourceLayout _layout)
+{
+	Id id = GetPathId(_path);
+	Texture* ret = Find(id);
+	if (!ret)
+	{
+		ret = FRM_NEW(Texture(id, _path));
+		ret->m_path.set(_path);
+		ret->m_sourceLayout = _layout;
+	}
+	UseAsync(ret);
+	return ret;
+}
+
 Texture* Texture::Create(const Image& _img, SourceLayout _layout)
 {
 	Id id = GetUniqueId();
@@ -1015,6 +1029,54 @@ bool Texture::reload()
 	return true;
 }
 
+struct Texture::AsyncLoad
+{
+	PathStr path;  // Including the root.
+	Image   image;
+};
+
+bool Texture::loadAsync()
+{
+	if (m_path.isEmpty())
+	{
+		return true;
+	}
+
+ // no GL calls here, this runs on a worker thread
+	File f;
+	if (!FileSystem::Read(f, (const char*)m_path))
+	{
+		return false;
+	}
+	AsyncLoad* asyncLoad = FRM_NEW(AsyncLoad);
+	asyncLoad->path = f.getPath();
+	if (!Image::Read(asyncLoad->image, f))
+	{
+		FRM_DELETE(asyncLoad);
+		return false;
+	}
+	m_asyncLoad = asyncLoad;
+	return true;
+}
+
+bool Texture::loadFinalize()
+{
+	if (!m_asyncLoad)
+	{
+		return m_path.isEmpty();
+	}
+
+	m_path = m_asyncLoad->path.c_str(); // see reload()
+	const bool ret = loadImage(m_asyncLoad->image);
+	FRM_DELETE(m_asyncLoad);
+	m_asyncLoad = nullptr;
+	if (ret)
+	{
+		g_textureViewer.addTextureView(this);
+	}
+	return ret;
+}
+
 void Texture::setData(const void* _data, GLenum _dataFormat, GLenum _dataType, GLint _mip)
 {
 	setSubData(0, 0, 0, m_width, m_height, m_depth, _data, _dataFormat, _dataType, _mip);
@@ -1377,6 +1439,12 @@ Texture::Texture(
 
 Texture::~Texture()
 {
+	if (m_asyncLoad)
+	{
+	 // released before the async load was finalized
+		FRM_DELETE(m_asyncLoad);
+		m_asyncLoad = nullptr;
+	}
 	if (m_ownsHandle && m_handle)
 	{
 		glAssert(glDeleteTextures(1, &m_handle));
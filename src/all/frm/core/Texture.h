@@ -26,6 +26,9 @@ public:
 
 	// Load from a file.
 	static Texture* Create(const char* _path, SourceLayout _layout = SourceLayout_Default);
+	// Load from a file asynchronously (see Resource::UseAsync()). The file is read and decoded on a worker thread, the upload happens
+	// during Resource::Update().
+	static Texture* CreateAsync(const char* _path, SourceLayout _layout = SourceLayout_Default);
 	// From Image.
 	static Texture* Create(const Image& _img, SourceLayout _layout = SourceLayout_Default);
 	// Init from another texture, optionally copy texture data.
@@ -60,6 +63,11 @@ public:
 	bool load()   { return reload(); }
 	bool reload();
 
+	// Async load, see Resource::UseAsync(). Until loadFinalize() is called by Resource::Update() the texture has no GL handle, this
+	// includes textures returned by Create() for a path which already has an async load pending (Resource::Use() doesn't block).
+	bool loadAsync();
+	bool loadFinalize();
+
 	// Upload data to the GPU. The image dimensions and mip count must exactly match those 
 	// used to create the texture (texture storage is immutable).
 	void setData(const void* _data, GLenum _dataFormat, GLenum _dataType, GLint _mip = 0);
@@ -149,8 +157,11 @@ protected:
 	~Texture();
 
 private:
+	struct AsyncLoad;
+
 	frm::String<32> m_path;  // Empty if not from a file.
 	SourceLayout    m_sourceLayout = SourceLayout_Default;
+	AsyncLoad*      m_asyncLoad = nullptr; // Written by loadAsync(), consumed by loadFinalize().
 
 	GLuint  m_handle;
 	bool    m_ownsHandle;    // False if this is a proxy.
@@ -5,7 +5,6 @@
 
 #ifdef frm_TextureAtlas_DEBUG
 	#include <imgui/imgui.h>
-	static eastl::vector<frm::TextureAtlas::Region*> s_dbgRegionList;
 #endif
 
 using namespace frm;
@@ -16,37 +15,13 @@ using namespace frm;
 
 *******************************************************************************/
 
-struct TextureAtlas::Node
-{
-	Node* m_parent;
-	Node* m_children[4];
-
-	bool m_isEmpty;
-	uint16 m_sizeX, m_sizeY;
-	uint16 m_startX, m_startY;
-
-	Node(Node* _parent)
-		: m_parent(_parent)
-		, m_isEmpty(true)
-	{
-		m_children[0] = 0;
-		m_children[1] = 0;
-		m_children[2] = 0;
-		m_children[3] = 0;
-	}
-
-	bool isLeaf() const  { return m_children[0] == 0; }
-	bool isEmpty() const { return m_isEmpty; }
-};
-
-
 // PUBLIC
 
-TextureAtlas* TextureAtlas::Create(GLsizei _width, GLsizei _height, GLenum _format, GLsizei _mipCount)
+TextureAtlas* TextureAtlas::Create(GLsizei _width, GLsizei _height, GLenum _format, GLsizei _mipCount, AtlasAllocator::Type _allocatorType)
 {
 	uint64 id = GetUniqueId();
 	FRM_ASSERT(!Find(id)); // id collision
-	TextureAtlas* ret = new TextureAtlas(id, "", _format, _width, _height, _mipCount);
+	TextureAtlas* ret = new TextureAtlas(id, "", _format, _width, _height, _mipCount, _allocatorType);
 	ret->setNamef("%llu", id);
 	Use((Texture*&)ret);
 	return ret;
@@ -66,33 +41,34 @@ void TextureAtlas::Destroy(TextureAtlas*& _inst_)
 
 TextureAtlas::Region* TextureAtlas::alloc(GLsizei _width, GLsizei _height)
 {
-	Node* node = insert(m_root, _width, _height);
-	if (node) {
-		Region* ret = m_regionPool.alloc();
-		ret->m_uvScale = vec2(_width, _height) * m_rsize; // note it's the requested size, not the node size
-		ret->m_uvBias = vec2(node->m_startX, node->m_startY) * m_rsize;
-		
-		if (isCompressed()) {
-		 // compressed atlas, the smallest usable region is 4x4, hence the max lod is log2(w/4)
-			ret->m_lodMax = FRM_MIN((int)log2((double)(_width / 4)), (int)log2((double)(_height / 4)));
-		} else {
-		 // uncompressed, the smallest usable region is log2(w)
-			ret->m_lodMax = FRM_MIN((int)log2((double)(_width)), (int)log2((double)(_height)));
-		}
-		
-		#ifdef frm_TextureAtlas_DEBUG
-			s_dbgRegionList.push_back(ret);
-		#endif
-		return ret;
+	AtlasAllocator::Rect rect;
+	if (!m_allocator->alloc((uint16)_width, (uint16)_height, rect)) {
+		return 0;
 	}
 
-	return 0;
+	Region* ret = m_regionPool.alloc();
+	setRegion(*ret, rect);
+	
+	if (isCompressed()) {
+	 // compressed atlas, the smallest usable region is 4x4, hence the max lod is log2(w/4)
+		ret->m_lodMax = FRM_MIN((int)log2((double)(_width / 4)), (int)log2((double)(_height / 4)));
+	} else {
+	 // uncompressed, the smallest usable region is log2(w)
+		ret->m_lodMax = FRM_MIN((int)log2((double)(_width)), (int)log2((double)(_height)));
+	}
+
+	m_regionsByOrigin[AtlasAllocator::GetKey(rect.x, rect.y)] = ret;
+	return ret;
 }
 
 TextureAtlas::Region* TextureAtlas::alloc(const frm::Image& _img, RegionId _id)
 {
 	FRM_ASSERT(_img.getType() == Image::Type_2d);
+	FRM_ASSERT(_id == 0 || m_regionMap.find(_id) == m_regionMap.end()); // id collision, use findUse() first
 	Region* ret = alloc((GLsizei)_img.getWidth(), (GLsizei)_img.getHeight());
+	if (!ret) {
+		return 0;
+	}
 
 	GLenum srcFormat;
 	switch (_img.getLayout()) {
@@ -100,7 +76,7 @@ TextureAtlas::Region* TextureAtlas::alloc(const frm::Image& _img, RegionId _id)
 		case Image::Layout_RG:   srcFormat = GL_RG;   break;
 		case Image::Layout_RGB:  srcFormat = GL_RGB;  break;
 		case Image::Layout_RGBA: srcFormat = GL_RGBA; break;
-		default:                   FRM_ASSERT(false); return false;
+		default:                 FRM_ASSERT(false); free(ret); return 0;
 	};
 	GLenum srcType = _img.isCompressed() ? GL_UNSIGNED_BYTE : internal::DataTypeToGLenum(_img.getImageDataType());
 	int mipMax = FRM_MIN(FRM_MIN((int)getMipCount(), (int)_img.getMipmapCount()), ret->m_lodMax + 1);
@@ -112,10 +88,9 @@ TextureAtlas::Region* TextureAtlas::alloc(const frm::Image& _img, RegionId _id)
 	}
 
 	if (_id != 0) {
-		m_regionMap.push_back(RegionRef());
-		m_regionMap.back().m_id = _id;
-		m_regionMap.back().m_region = ret;
-		m_regionMap.back().m_refCount = 1;
+		ret->m_id = _id;
+		ret->m_refCount = 1;
+		m_regionMap[_id] = ret;
 	}
 	return ret;
 }
@@ -123,17 +98,10 @@ TextureAtlas::Region* TextureAtlas::alloc(const frm::Image& _img, RegionId _id)
 void TextureAtlas::free(Region*& _region_)
 {
 	FRM_ASSERT(_region_);
-	#ifdef FRM_DEBUG
-		for (auto it = m_regionMap.begin(); it != m_regionMap.end(); ++it) {
-			if (it->m_region == _region_) {
-				FRM_ASSERT(false); // named regions must be freed via unuseFree()
-			}
-		}
-	#endif
+	FRM_ASSERT(_region_->m_id == 0); // named regions must be freed via unuseFree()
 
-	Node* node = find(*_region_);
-	FRM_ASSERT(node);
-	remove(node);
+	m_allocator->free(_region_->m_rect);
+	m_regionsByOrigin.erase(AtlasAllocator::GetKey(_region_->m_rect.x, _region_->m_rect.y));
 
 	m_regionPool.free(_region_);
 	_region_ = 0;
@@ -141,48 +109,95 @@ void TextureAtlas::free(Region*& _region_)
 
 TextureAtlas::Region* TextureAtlas::findUse(RegionId _id)
 {
-	for (auto it = m_regionMap.begin(); it != m_regionMap.end(); ++it) {
-		if (it->m_id == _id) {
-			++it->m_refCount;
-			return it->m_region;
-		}
+	auto it = m_regionMap.find(_id);
+	if (it == m_regionMap.end()) {
+		return 0; // not found
 	}
-	return 0; // not found
+	++it->second->m_refCount;
+	return it->second;
 }
 
 void TextureAtlas::unuseFree(Region*& _region_)
 {
-	for (auto it = m_regionMap.begin(); it != m_regionMap.end(); ++it) {
-		if (it->m_region == _region_) {
-			if (--it->m_refCount == 0) {
-				m_regionMap.erase(it);
-				free(_region_);
-			}
-			_region_ = 0; // always null the ptr
-			return;
-		}
+	FRM_ASSERT(_region_);
+	FRM_ASSERT(_region_->m_id != 0); // region not named, didn't set the region name via alloc()?
+	FRM_ASSERT(m_regionMap.find(_region_->m_id) != m_regionMap.end());
+
+	if (--_region_->m_refCount == 0) {
+		m_regionMap.erase(_region_->m_id);
+		_region_->m_id = 0;
+		free(_region_);
 	}
-	FRM_ASSERT(false); // region not found, didn't set the region name via alloc()?
+	_region_ = 0; // always null the ptr
 }
 
 void TextureAtlas::upload(const Region& _region, const void* _data, GLenum _dataFormat, GLenum _dataType, GLint _mip)
 {
 	FRM_ASSERT(_mip < getMipCount());
-	
-	GLsizei x = (GLsizei)(_region.m_uvBias.x  * (float)getWidth());
-	GLsizei y = (GLsizei)(_region.m_uvBias.y  * (float)getHeight());
-	GLsizei w = (GLsizei)(_region.m_uvScale.x * (float)getWidth());
-	GLsizei h = (GLsizei)(_region.m_uvScale.y * (float)getHeight());
-	
-	GLsizei div = (GLsizei)pow(2.0, (double)_mip);
-	w = w  / div;
-	h = h  / div;
-	x = x  / div;
-	y = y  / div;
+
+	GLsizei x = (GLsizei)(_region.m_rect.x >> _mip);
+	GLsizei y = (GLsizei)(_region.m_rect.y >> _mip);
+	GLsizei w = (GLsizei)(_region.m_rect.w >> _mip);
+	GLsizei h = (GLsizei)(_region.m_rect.h >> _mip);
 
 	setSubData(x, y, 0, w, h, 0, _data, _dataFormat, _dataType, _mip);
 }
 
+bool TextureAtlas::compact(eastl::vector<AtlasAllocator::Copy>* copies_)
+{
+	eastl::vector<AtlasAllocator::Copy> copies;
+	AtlasAllocator* allocator = m_allocator->compact(copies);
+	if (!allocator) {
+		return false;
+	}
+
+	if (!copies.empty()) {
+	 // moved regions may overlap their previous positions, copy via a scratch texture: atlas src -> scratch dst, then scratch dst -> atlas dst
+		Texture* scratch = Texture::Create2d(getWidth(), getHeight(), getFormat(), getMipCount());
+		auto copyRects = [&](GLuint _src, bool _fromSrc, GLuint _dst) {
+			for (const AtlasAllocator::Copy& copy : copies) {
+				const AtlasAllocator::Rect& src = _fromSrc ? copy.src : copy.dst;
+				const Region* region = m_regionsByOrigin[AtlasAllocator::GetKey(copy.src.x, copy.src.y)];
+				const int mipMax = FRM_MIN((int)getMipCount(), region->m_lodMax + 1);
+				for (int mip = 0; mip < mipMax; ++mip) {
+					GLsizei w = (GLsizei)(copy.dst.w >> mip);
+					GLsizei h = (GLsizei)(copy.dst.h >> mip);
+					if (w == 0 || h == 0) {
+						break;
+					}
+					glAssert(glCopyImageSubData(
+						_src, GL_TEXTURE_2D, mip, (GLint)(src.x >> mip),      (GLint)(src.y >> mip),      0,
+						_dst, GL_TEXTURE_2D, mip, (GLint)(copy.dst.x >> mip), (GLint)(copy.dst.y >> mip), 0,
+						w, h, 1
+						));
+				}
+			}
+		};
+		copyRects(getHandle(), true, scratch->getHandle());
+		copyRects(scratch->getHandle(), false, getHandle());
+		Texture::Release(scratch);
+
+	 // update moved regions (lookup by the old origin, then rebuild the origin map)
+		for (const AtlasAllocator::Copy& copy : copies) {
+			Region* region = m_regionsByOrigin[AtlasAllocator::GetKey(copy.src.x, copy.src.y)];
+			setRegion(*region, copy.dst);
+		}
+		eastl::unordered_map<uint32, Region*> regionsByOrigin;
+		for (auto& it : m_regionsByOrigin) {
+			regionsByOrigin[AtlasAllocator::GetKey(it.second->m_rect.x, it.second->m_rect.y)] = it.second;
+		}
+		m_regionsByOrigin.swap(regionsByOrigin);
+	}
+
+	AtlasAllocator::Destroy(m_allocator);
+	m_allocator = allocator;
+
+	if (copies_) {
+		copies_->swap(copies);
+	}
+	return true;
+}
+
 
 // PROTECTED
 
@@ -192,139 +207,31 @@ TextureAtlas::TextureAtlas(
 	GLenum      _format,
 	GLsizei     _width, 
 	GLsizei     _height,
-	GLsizei     _mipCount	
+	GLsizei     _mipCount,
+	AtlasAllocator::Type _allocatorType
 	)
 	: Texture(_id, _name, GL_TEXTURE_2D, _width, _height, 0, 0, _mipCount, _format)
 	, m_regionPool(256)
 {
-
 	m_rsize = 1.0f / vec2(getWidth(), getHeight());
-
- // init allocator
- 	m_nodePool = new Pool<Node>(128);
-	m_root = m_nodePool->alloc(Node(0));
-	m_root->m_startX = m_root->m_startY = 0;
-	m_root->m_sizeX = getWidth();
-	m_root->m_sizeY = getHeight();
+	m_allocator = AtlasAllocator::Create(_allocatorType, (uint16)getWidth(), (uint16)getHeight());
 }
 
 TextureAtlas::~TextureAtlas()
 {
- // destroy allocator
-	m_nodePool->free(m_root);
-	delete m_nodePool;
-}
-
-// PRIVATE
-
-TextureAtlas::Node* TextureAtlas::insert(Node* _root, uint16 _sizeX, uint16 _sizeY)
-{
-	if (!_root->isEmpty()) {
-		return 0;
-	}
-	
-	if (_root->isLeaf()) {
-	 // node is too small
-		if (_root->m_sizeX < _sizeX || _root->m_sizeY < _sizeY) {
-			return 0;
-		}
-	 // node is best fit
-		uint16 nextSizeX = _root->m_sizeX / 2;
-		uint16 nextSizeY = _root->m_sizeY / 2;
-		if (nextSizeX < _sizeX || nextSizeY < _sizeY) {
-			_root->m_isEmpty = false;
-			return _root;
-		}
-
-	 // subdivide the node
-	 // +---+---+
-	 // | 0 | 1 |
-	 // +---+---+
-	 // | 3 | 2 |
-	 // +---+---+
-		for (int i = 0; i < 4; ++i) {
-			_root->m_children[i] = m_nodePool->alloc(Node(_root));
-			_root->m_children[i]->m_sizeX = nextSizeX;
-			_root->m_children[i]->m_sizeY = nextSizeY;
-		}
-		_root->m_children[0]->m_startX = _root->m_startX;
-		_root->m_children[0]->m_startY = _root->m_startY;
-		_root->m_children[1]->m_startX = _root->m_startX + nextSizeX;
-		_root->m_children[1]->m_startY = _root->m_startY;
-		_root->m_children[2]->m_startX = _root->m_startX + nextSizeX;
-		_root->m_children[2]->m_startY = _root->m_startY + nextSizeY;		
-		_root->m_children[3]->m_startX = _root->m_startX;
-		_root->m_children[3]->m_startY = _root->m_startY + nextSizeY;
-
-		return insert(_root->m_children[0], _sizeX, _sizeY);
-
-	} else {
-		Node* ret = 0;
-		for (int i = 0; i < 4; ++i) {
-			ret = insert(_root->m_children[i], _sizeX, _sizeY);
-			if (ret != 0) {
-				break;
-			}
-		}
-		return ret;
-	}
-
-}
-
-void TextureAtlas::remove(Node*& _node_)
-{
-	FRM_ASSERT(_node_->isLeaf());
-	_node_->m_isEmpty = true;
-	Node* parent = _node_->m_parent;
-
- // remove parent if all children are empty leaves
- 	for (int i = 0; i < 4; ++i) {
-		bool canRemove = parent->m_children[i]->isEmpty() && parent->m_children[i]->isLeaf();
-		if (!canRemove) {
-			return;
-		}
-	}
-	for (int i = 0; i < 4; ++i) {
-		m_nodePool->free(parent->m_children[i]);
-		parent->m_children[i] = 0;
-	}
-	if (parent != m_root) {
-		remove(parent);
+	for (auto& it : m_regionsByOrigin) {
+		m_regionPool.free(it.second);
 	}
+	AtlasAllocator::Destroy(m_allocator);
 }
 
-// \todo improve find(), search for the node corner rather than the node center
-TextureAtlas::Node* TextureAtlas::find(const Region& _region)
-{
- // convert region -> node center
-	uint16 startX = (uint16)(_region.m_uvBias.x  * (float)getWidth());
-	uint16 startY = (uint16)(_region.m_uvBias.y  * (float)getHeight());
-	uint16 sizeX  = (uint16)(_region.m_uvScale.x * (float)getWidth());
-	uint16 sizeY  = (uint16)(_region.m_uvScale.y * (float)getHeight());
-	uint16 originX = startX + sizeX / 2;
-	uint16 originY = startY + sizeY / 2;
-
-	return find(m_root, originX, originY);
-}
+// PRIVATE
 
-TextureAtlas::Node* TextureAtlas::find(Node* _root, uint16 _originX, uint16 _originY)
+void TextureAtlas::setRegion(Region& _region_, const AtlasAllocator::Rect& _rect)
 {
-	uint16 x0 = _root->m_startX;
-	uint16 y0 = _root->m_startY;
-	uint16 x1 = x0 + _root->m_sizeX; 
-	uint16 y1 = y0 + _root->m_sizeY;
-	if (_originX >= x0 && _originX <= x1 && _originY >= y0 && _originY <= y1) {
-		if (_root->isLeaf()) {
-			return _root;
-		}
-		for (int i = 0; i < 4; ++i) {
-			Node* ret = find(_root->m_children[i], _originX, _originY);
-			if (ret) {
-				return ret;
-			}
-		}
-	}
-	return 0;
+	_region_.m_rect = _rect;
+	_region_.m_uvScale = vec2(_rect.w, _rect.h) * m_rsize; // note it's the requested size, not the allocated size
+	_region_.m_uvBias = vec2(_rect.x, _rect.y) * m_rsize;
 }
 
 
@@ -335,58 +242,53 @@ TextureAtlas::Node* TextureAtlas::find(Node* _root, uint16 _originX, uint16 _ori
 	static const float kDbgLineThickness   = 1.0f;
 	void TextureAtlas::debug()
 	{
+		const AtlasAllocator::Stats stats = getStats();
+		ImGui::Text("%s: %u regions, occupancy %.2f, fragmentation %.2f", AtlasAllocator::GetTypeName(getAllocatorType()), stats.allocationCount, stats.occupancy, stats.fragmentation);
+		if (ImGui::Button("Compact")) {
+			compact();
+		}
+
 		ImDrawList* drawList = ImGui::GetWindowDrawList();
 		const vec2 drawSize = ImGui::GetContentRegionAvail();
 		const vec2 drawStart = vec2(ImGui::GetWindowPos()) + vec2(ImGui::GetCursorPos());
 		const vec2 drawEnd   = drawStart + drawSize;
 		drawList->AddRectFilled(drawStart, drawStart + drawSize, kDbgColorBackground);
 	
-		const vec2 txSize = vec2(getWidth(), getHeight());
 		const vec2 buttonStart = ImGui::GetCursorPos();
-		for (int i = 0; i < s_dbgRegionList.size(); ++i) {
-			ImGui::PushID(i);
-			vec2 start = s_dbgRegionList[i]->m_uvBias * drawSize;
-			vec2 size  = s_dbgRegionList[i]->m_uvScale * drawSize;
+		Region* toFree = 0;
+		int i = 0;
+		for (auto& it : m_regionsByOrigin) {
+			Region* region = it.second;
+			ImGui::PushID(i++);
+			vec2 start = region->m_uvBias * drawSize;
+			vec2 size  = region->m_uvScale * drawSize;
 			ImGui::SetCursorPos(buttonStart + start);
 			if (ImGui::Button("", size)) {
-				free(s_dbgRegionList[i]);
-				s_dbgRegionList.erase(s_dbgRegionList.begin() + i);
+				if (region->m_id == 0) {
+					toFree = region; // defer, free() modifies m_regionsByOrigin
+				}
 			} else {
 				if (ImGui::IsItemHovered()) {
 					ImGui::BeginTooltip();
-						ImGui::Text("Uv Bias:  %1.2f, %1.2f", s_dbgRegionList[i]->m_uvBias.x, s_dbgRegionList[i]->m_uvBias.y);
-						ImGui::Text("Uv Scale: %1.2f, %1.2f", s_dbgRegionList[i]->m_uvScale.x, s_dbgRegionList[i]->m_uvScale.y);
-						ImGui::Text("Max Lod:  %d", s_dbgRegionList[i]->m_lodMax);
+						ImGui::Text("Rect:     %u, %u, %u, %u", region->m_rect.x, region->m_rect.y, region->m_rect.w, region->m_rect.h);
+						ImGui::Text("Uv Bias:  %1.2f, %1.2f", region->m_uvBias.x, region->m_uvBias.y);
+						ImGui::Text("Uv Scale: %1.2f, %1.2f", region->m_uvScale.x, region->m_uvScale.y);
+						ImGui::Text("Max Lod:  %d", region->m_lodMax);
+						if (region->m_id != 0) {
+							ImGui::Text("Id:       %llu (%d refs)", (unsigned long long)region->m_id, region->m_refCount);
+						}
 					ImGui::EndTooltip();
 				}
 			}
 			ImGui::PopID();
 		}
+		if (toFree) {
+			free(toFree);
+		}
 	
 		drawList->AddLine(vec2(drawStart.x, drawStart.y), vec2(drawEnd.x,   drawStart.y), kDbgColorLines, kDbgLineThickness);
 		drawList->AddLine(vec2(drawEnd.x,   drawStart.y), vec2(drawEnd.x,   drawEnd.y),   kDbgColorLines, kDbgLineThickness);
 		drawList->AddLine(vec2(drawEnd.x,   drawEnd.y),   vec2(drawStart.x, drawEnd.y),   kDbgColorLines, kDbgLineThickness);
 		drawList->AddLine(vec2(drawStart.x, drawEnd.y),   vec2(drawStart.x, drawStart.y), kDbgColorLines, kDbgLineThickness);
-		debugDrawNode(m_root, drawStart, drawSize);
-	}
-	void TextureAtlas::debugDrawNode(const Node* _node, const vec2& _drawStart, const vec2& _drawSize)
-	{
-		if (!_node->isLeaf()) {
-			ImDrawList* drawList = ImGui::GetWindowDrawList();
-	
-	
-			vec2 a, b;
-			a = vec2((float)(_node->m_startX + _node->m_sizeX / 2), (float)(_node->m_startY                 )) * m_rsize;
-			b = vec2((float)(_node->m_startX + _node->m_sizeX / 2), (float)(_node->m_startY + _node->m_sizeY)) * m_rsize;
-			drawList->AddLine(_drawStart + a * _drawSize, _drawStart + b * _drawSize, kDbgColorLines, kDbgLineThickness);
-			
-			a = vec2((float)(_node->m_startX                 ), (float)(_node->m_startY + _node->m_sizeY / 2)) * m_rsize;
-			b = vec2((float)(_node->m_startX + _node->m_sizeX), (float)(_node->m_startY + _node->m_sizeY / 2)) * m_rsize;
-			drawList->AddLine(_drawStart + a * _drawSize, _drawStart + b * _drawSize, kDbgColorLines, kDbgLineThickness);
-			
-			for (int i = 0; i < 4; ++i) {
-				debugDrawNode(_node->m_children[i], _drawStart, _drawSize);
-			}
-		}
 	}
 #endif // frm_TextureAtlas_DEBUG
@@ -2,10 +2,12 @@
 
 #include <frm/core/frm.h>
 #include <frm/core/gl.h>
+#include <frm/core/AtlasAllocator.h>
 #include <frm/core/Texture.h>
 #include <frm/core/Pool.h>
 #include <frm/core/StringHash.h>
 
+#include <EASTL/unordered_map.h>
 #include <EASTL/vector.h>
 
 #ifdef FRM_DEBUG
@@ -16,10 +18,9 @@ namespace frm {
 
 ////////////////////////////////////////////////////////////////////////////////
 // TextureAtlas
-// \todo Pass an ID when uploading an image (detect if you already uploaded the
-//   the image). Requires refcounting for regions!
-// \todo Select between quadtree/BSP allocator, more efficient implementation
-//   for both. See commit 7c6ac7e for a working version of the BSP.
+// Regions are allocated via an AtlasAllocator, the allocator type is selected
+// at creation (see AtlasAllocator for the tradeoffs). Named regions and the
+// region -> allocation mapping are hash-indexed.
 ////////////////////////////////////////////////////////////////////////////////
 class TextureAtlas: public Texture
 {
@@ -28,12 +29,16 @@ public:
 
 	struct Region
 	{
-		vec2 m_uvScale;
-		vec2 m_uvBias;
-		int  m_lodMax;
+		vec2                 m_uvScale;
+		vec2                 m_uvBias;
+		int                  m_lodMax;
+
+		AtlasAllocator::Rect m_rect;         // Allocated texel rect.
+		RegionId             m_id       = 0; // Named regions only, see alloc().
+		int                  m_refCount = 0; //           "
 	};
 
-	static TextureAtlas* Create(GLsizei _width, GLsizei _height, GLenum _format, GLint _mipCount = 1);
+	static TextureAtlas* Create(GLsizei _width, GLsizei _height, GLenum _format, GLint _mipCount = 1, AtlasAllocator::Type _allocatorType = AtlasAllocator::Type_Quadtree);
 	static void Destroy(TextureAtlas*& _inst_);
 
 	// Alloc an uninitialized _width * _height region. Return 0 if the allocation failed.
@@ -53,6 +58,13 @@ public:
 	// Upload data to a previously allocated region.
 	void upload(const Region& _region, const void* _data, GLenum _dataFormat, GLenum _dataType, GLint _mip = 0);
 
+	// Repack all regions to reduce fragmentation, texel data is moved on the GPU and the uv bias of moved regions is updated in place.
+	// Optionally return the moved texel rects in copies_. Return false if the repack failed, in which case the atlas is unchanged.
+	bool compact(eastl::vector<AtlasAllocator::Copy>* copies_ = nullptr);
+
+	AtlasAllocator::Stats getStats() const  { return m_allocator->getStats(); }
+	AtlasAllocator::Type  getAllocatorType() const { return m_allocator->getType(); }
+
 
 protected:
 	TextureAtlas(
@@ -61,31 +73,24 @@ protected:
 		GLenum      _format,
 		GLsizei     _width, 
 		GLsizei     _height,
-		GLsizei     _mipCount
+		GLsizei     _mipCount,
+		AtlasAllocator::Type _allocatorType
 		);
 	~TextureAtlas();
 
 private:
 	vec2 m_rsize;
 	frm::Pool<Region> m_regionPool;
+	AtlasAllocator* m_allocator;
 
-	struct RegionRef { RegionId m_id; Region* m_region; int m_refCount; };
-	eastl::vector<RegionRef> m_regionMap;
-
- // quad tree allocator
- 	struct Node;
-	Node* m_root;
-	frm::Pool<Node>* m_nodePool;	
+	eastl::unordered_map<RegionId, Region*> m_regionMap;       // Named regions.
+	eastl::unordered_map<uint32, Region*>   m_regionsByOrigin; // All regions, keyed by texel origin.
 
-	Node* insert(Node* _root, uint16 _sizeX, uint16 _sizeY);
-	void  remove(Node*& _node_);
-	Node* find(const Region& _region);
-	Node* find(Node* _root, uint16 _originX, uint16 _originY);
+	void setRegion(Region& _region_, const AtlasAllocator::Rect& _rect);
 
 #ifdef frm_TextureAtlas_DEBUG
 public:
 	void debug();
-	void debugDrawNode(const Node* _node, const vec2& _drawStart, const vec2& _drawSize);
 #endif
 
 }; // class TextureAtlas
@@ -1,22 +1,39 @@
 #include <frm/core/compress.h>
 
+#include <frm/core/math.h>
+#include <frm/core/memory.h>
+#include <frm/core/JobSystem.h>
+
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES // 'compress' macro conflicts with Compressor::compress()
 #include <miniz/miniz.h>
 
+#include <EASTL/vector.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
 using namespace frm;
 
-void frm::Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags)
+static int GetTdeflFlags(CompressionFlags _flags)
 {
-	FRM_ASSERT(_in);
-	FRM_ASSERT(_inSizeBytes);
-	FRM_ASSERT(!out_);
 	FRM_ASSERT(_flags != CompressionFlags_None); // the calling code should skip calling Compress in this case
 
-	int tdeflFlags = TDEFL_WRITE_ZLIB_HEADER;
+	int ret = TDEFL_WRITE_ZLIB_HEADER;
 	if (_flags & CompressionFlags_Speed)
 	{
-		tdeflFlags |= TDEFL_GREEDY_PARSING_FLAG;
+		ret |= TDEFL_GREEDY_PARSING_FLAG;
 	}
-	out_ = tdefl_compress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, tdeflFlags);
+	return ret;
+}
+
+void frm::Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags)
+{
+	FRM_ASSERT(_in);
+	FRM_ASSERT(_inSizeBytes);
+	FRM_ASSERT(!out_);
+
+	out_ = tdefl_compress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, GetTdeflFlags(_flags));
 	FRM_ASSERT(out_);
 }
 
@@ -30,3 +47,337 @@ void frm::Decompress(const void* _in, uint _inSizeBytes, void*& out_, uint& outS
 	out_ = tinfl_decompress_mem_to_heap(_in, _inSizeBytes, &outSizeBytes_, tinflFlags);
 	FRM_ASSERT(out_);
 }
+
+/*******************************************************************************
+
+                                 Compressor
+
+*******************************************************************************/
+
+struct Compressor::Impl
+{
+	tdefl_compressor*      compressor;
+	CompressionOutputFunc* output;
+	void*                  outputArg;
+	bool                   finished = false;
+
+	static mz_bool PutBuf(const void* _data, int _sizeBytes, void* _impl)
+	{
+		Impl* impl = (Impl*)_impl;
+		return impl->output(_data, (uint)_sizeBytes, impl->outputArg) ? MZ_TRUE : MZ_FALSE;
+	}
+};
+
+Compressor::Compressor(CompressionOutputFunc* _output, void* _outputArg, CompressionFlags _flags)
+{
+	FRM_ASSERT(_output);
+
+	m_impl = FRM_NEW(Impl);
+	m_impl->compressor = tdefl_compressor_alloc();
+	m_impl->output     = _output;
+	m_impl->outputArg  = _outputArg;
+	FRM_VERIFY(tdefl_init(m_impl->compressor, &Impl::PutBuf, m_impl, GetTdeflFlags(_flags)) == TDEFL_STATUS_OKAY);
+}
+
+Compressor::~Compressor()
+{
+	tdefl_compressor_free(m_impl->compressor);
+	FRM_DELETE(m_impl);
+}
+
+bool Compressor::compress(const void* _in, uint _inSizeBytes)
+{
+	FRM_ASSERT(!m_impl->finished);
+	return tdefl_compress_buffer(m_impl->compressor, _in, _inSizeBytes, TDEFL_NO_FLUSH) == TDEFL_STATUS_OKAY;
+}
+
+bool Compressor::finish()
+{
+	FRM_ASSERT(!m_impl->finished);
+	m_impl->finished = true;
+	return tdefl_compress_buffer(m_impl->compressor, nullptr, 0, TDEFL_FINISH) == TDEFL_STATUS_DONE;
+}
+
+/*******************************************************************************
+
+                                 Decompressor
+
+*******************************************************************************/
+
+struct Decompressor::Impl
+{
+	tinfl_decompressor     decompressor;
+	mz_uint8               dict[TINFL_LZ_DICT_SIZE]; // Output wraps around the dictionary.
+	size_t                 dictOffset = 0;
+	CompressionOutputFunc* output;
+	void*                  outputArg;
+	tinfl_status           status = TINFL_STATUS_NEEDS_MORE_INPUT;
+};
+
+Decompressor::Decompressor(CompressionOutputFunc* _output, void* _outputArg)
+{
+	FRM_ASSERT(_output);
+
+	m_impl = FRM_NEW(Impl);
+	m_impl->output    = _output;
+	m_impl->outputArg = _outputArg;
+	tinfl_init(&m_impl->decompressor);
+}
+
+Decompressor::~Decompressor()
+{
+	FRM_DELETE(m_impl);
+}
+
+bool Decompressor::decompress(const void* _in, uint _inSizeBytes)
+{
+	const mz_uint8* in = (const mz_uint8*)_in;
+	size_t inRemaining = _inSizeBytes;
+	while (m_impl->status > TINFL_STATUS_DONE)
+	{
+		size_t inBytes  = inRemaining;
+		size_t outBytes = TINFL_LZ_DICT_SIZE - m_impl->dictOffset;
+		m_impl->status = tinfl_decompress(&m_impl->decompressor, in, &inBytes, m_impl->dict, m_impl->dict + m_impl->dictOffset, &outBytes, TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+		in          += inBytes;
+		inRemaining -= inBytes;
+
+		if (outBytes > 0)
+		{
+			if (!m_impl->output(m_impl->dict + m_impl->dictOffset, (uint)outBytes, m_impl->outputArg))
+			{
+				return false;
+			}
+			m_impl->dictOffset = (m_impl->dictOffset + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+		}
+
+		if (m_impl->status == TINFL_STATUS_NEEDS_MORE_INPUT)
+		{
+			// All input was consumed.
+			FRM_ASSERT(inRemaining == 0);
+			return true;
+		}
+	}
+
+	// Any input after the end of the stream is ignored.
+	return m_impl->status == TINFL_STATUS_DONE;
+}
+
+bool Decompressor::isComplete() const
+{
+	return m_impl->status == TINFL_STATUS_DONE;
+}
+
+/*******************************************************************************
+
+                              CompressedBlocks
+
+*******************************************************************************/
+
+namespace {
+
+struct BlocksHeader
+{
+	char   magic[4];
+	uint32 blockSizeBytes;
+	uint32 blockCount;
+	uint32 reserved;
+	uint64 decompressedSizeBytes;
+};
+static_assert(sizeof(BlocksHeader) == 24, "BlocksHeader has padding");
+
+constexpr char kBlocksMagic[4] = { 'F', 'R', 'M', 'Z' };
+
+} // namespace
+
+// PUBLIC
+
+void CompressedBlocks::Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags, uint32 _blockSizeBytes)
+{
+	FRM_ASSERT(_in || _inSizeBytes == 0);
+	FRM_ASSERT(!out_);
+	FRM_ASSERT(_blockSizeBytes > 0);
+
+	const int tdeflFlags = GetTdeflFlags(_flags);
+	const uint32 blockCount = (uint32)((_inSizeBytes + _blockSizeBytes - 1) / _blockSizeBytes);
+
+	// Compress blocks into a temporary buffer (one block-sized slot per block), then pack them into the output.
+	char* blocks = (char*)FRM_MALLOC((size_t)blockCount * _blockSizeBytes);
+	eastl::vector<uint32> blockSizes(blockCount);
+	JobSystem::ParallelFor(blockCount, 1, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				const char* src = (const char*)_in + (size_t)i * _blockSizeBytes;
+				const size_t srcSizeBytes = Min((size_t)_blockSizeBytes, (size_t)_inSizeBytes - (size_t)i * _blockSizeBytes);
+				char* dst = blocks + (size_t)i * _blockSizeBytes;
+
+				// Store the block as-is if the compressed size isn't smaller (tdefl_compress_mem_to_mem() returns 0 if the output doesn't fit).
+				size_t dstSizeBytes = tdefl_compress_mem_to_mem(dst, srcSizeBytes - 1, src, srcSizeBytes, tdeflFlags);
+				if (dstSizeBytes == 0)
+				{
+					memcpy(dst, src, srcSizeBytes);
+					dstSizeBytes = srcSizeBytes;
+				}
+				blockSizes[i] = (uint32)dstSizeBytes;
+			}
+		});
+
+	const uint headerSizeBytes = sizeof(BlocksHeader) + (uint)blockCount * sizeof(uint64);
+	uint totalSizeBytes = headerSizeBytes;
+	for (uint32 blockSize : blockSizes)
+	{
+		totalSizeBytes += blockSize;
+	}
+
+	char* ret = (char*)malloc(totalSizeBytes);
+	BlocksHeader header;
+	memcpy(header.magic, kBlocksMagic, sizeof(kBlocksMagic));
+	header.blockSizeBytes        = _blockSizeBytes;
+	header.blockCount            = blockCount;
+	header.reserved              = 0;
+	header.decompressedSizeBytes = (uint64)_inSizeBytes;
+	memcpy(ret, &header, sizeof(BlocksHeader));
+
+	uint64 offset = headerSizeBytes;
+	for (uint32 i = 0; i < blockCount; ++i)
+	{
+		memcpy(ret + offset, blocks + (size_t)i * _blockSizeBytes, blockSizes[i]);
+		offset += blockSizes[i];
+		memcpy(ret + sizeof(BlocksHeader) + i * sizeof(uint64), &offset, sizeof(uint64));
+	}
+	FRM_ASSERT(offset == totalSizeBytes);
+	FRM_FREE(blocks);
+
+	out_ = ret;
+	outSizeBytes_ = totalSizeBytes;
+}
+
+uint CompressedBlocks::GetHeaderSizeBytes(const void* _in, uint _inSizeBytes)
+{
+	if (_inSizeBytes < sizeof(BlocksHeader) || memcmp(_in, kBlocksMagic, sizeof(kBlocksMagic)) != 0)
+	{
+		return 0;
+	}
+	BlocksHeader header;
+	memcpy(&header, _in, sizeof(BlocksHeader));
+	const uint64 headerSizeBytes = sizeof(BlocksHeader) + (uint64)header.blockCount * sizeof(uint64);
+	if (headerSizeBytes > (uint64)(uint)~0u)
+	{
+		return 0;
+	}
+	return (uint)headerSizeBytes;
+}
+
+CompressedBlocks::CompressedBlocks(const void* _data, uint _sizeBytes)
+{
+	const uint headerSizeBytes = GetHeaderSizeBytes(_data, _sizeBytes);
+	if (headerSizeBytes == 0 || headerSizeBytes > _sizeBytes)
+	{
+		return;
+	}
+
+	BlocksHeader header;
+	memcpy(&header, _data, sizeof(BlocksHeader));
+	if (header.blockSizeBytes == 0 || header.decompressedSizeBytes > (uint64)header.blockCount * header.blockSizeBytes)
+	{
+		return;
+	}
+	// Only the last block may be partial and it can't be empty, otherwise its decompressed size underflows.
+	if (header.blockCount > 0 && header.decompressedSizeBytes <= (uint64)(header.blockCount - 1) * header.blockSizeBytes)
+	{
+		return;
+	}
+
+	m_data                  = (const char*)_data;
+	m_blockTable            = m_data + sizeof(BlocksHeader);
+	m_decompressedSizeBytes = header.decompressedSizeBytes;
+	m_blockCount            = header.blockCount;
+	m_blockSizeBytes        = header.blockSizeBytes;
+	m_headerSizeBytes       = (uint32)headerSizeBytes;
+
+	// Validate the block table, block offsets must be increasing.
+	for (uint32 i = 0; i < m_blockCount; ++i)
+	{
+		if (getBlockEnd(i) < getBlockBegin(i))
+		{
+			m_blockTable = nullptr;
+			return;
+		}
+	}
+}
+
+uint32 CompressedBlocks::getBlockDecompressedSizeBytes(uint32 _index) const
+{
+	FRM_ASSERT(_index < m_blockCount);
+	return (uint32)Min((uint64)m_blockSizeBytes, m_decompressedSizeBytes - (uint64)_index * m_blockSizeBytes);
+}
+
+uint32 CompressedBlocks::getAvailableBlockCount(uint _sizeBytes) const
+{
+	// Block ends are increasing, binary search for the first block which isn't resident.
+	uint32 lo = 0, hi = m_blockCount;
+	while (lo < hi)
+	{
+		const uint32 mid = lo + (hi - lo) / 2;
+		if (getBlockEnd(mid) <= (uint64)_sizeBytes)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+bool CompressedBlocks::decompressBlock(uint32 _index, void* out_) const
+{
+	FRM_ASSERT(isValid());
+	FRM_ASSERT(_index < m_blockCount);
+
+	const char*  src            = m_data + getBlockBegin(_index);
+	const size_t srcSizeBytes   = (size_t)(getBlockEnd(_index) - getBlockBegin(_index));
+	const size_t dstSizeBytes   = getBlockDecompressedSizeBytes(_index);
+	if (srcSizeBytes == dstSizeBytes)
+	{
+		// Stored block.
+		memcpy(out_, src, dstSizeBytes);
+		return true;
+	}
+	return tinfl_decompress_mem_to_mem(out_, dstSizeBytes, src, srcSizeBytes, TINFL_FLAG_PARSE_ZLIB_HEADER) == dstSizeBytes;
+}
+
+bool CompressedBlocks::decompress(void* out_, uint32 _first, uint32 _count) const
+{
+	FRM_ASSERT(isValid());
+	FRM_ASSERT(_first <= m_blockCount);
+	_count = Min(_count, m_blockCount - _first);
+
+	std::atomic<bool> ret(true);
+	JobSystem::ParallelFor(_count, 1, [&](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				if (!decompressBlock(_first + i, (char*)out_ + (size_t)i * m_blockSizeBytes))
+				{
+					ret = false;
+				}
+			}
+		});
+	return ret;
+}
+
+// PRIVATE
+
+uint64 CompressedBlocks::getBlockBegin(uint32 _index) const
+{
+	return _index == 0 ? (uint64)m_headerSizeBytes : getBlockEnd(_index - 1);
+}
+
+uint64 CompressedBlocks::getBlockEnd(uint32 _index) const
+{
+	uint64 ret;
+	memcpy(&ret, m_blockTable + _index * sizeof(uint64), sizeof(uint64));
+	return ret;
+}
@@ -20,4 +20,125 @@ void Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeByte
 // out_ should subsequently be release via free().
 void Decompress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_);
 
+// Output callback for Compressor/Decompressor. Return false to abort.
+typedef bool (CompressionOutputFunc)(const void* _data, uint _sizeBytes, void* _arg);
+
+////////////////////////////////////////////////////////////////////////////////
+// Compressor
+// Streaming compression. Input is supplied in arbitrary slices via compress(),
+// output is passed to a callback as it becomes available. The resulting stream
+// is compatible with Decompress()/Decompressor.
+////////////////////////////////////////////////////////////////////////////////
+class Compressor
+{
+public:
+
+	Compressor(CompressionOutputFunc* _output, void* _outputArg, CompressionFlags _flags = CompressionFlags_Default);
+	~Compressor();
+
+	// Compress _inSizeBytes from _in. Return false if the output callback failed.
+	bool compress(const void* _in, uint _inSizeBytes);
+
+	// Flush pending output and end the stream. Return false if the output callback failed. compress() may not be called subsequently.
+	bool finish();
+
+private:
+
+	struct Impl;
+	Impl* m_impl;
+
+}; // class Compressor
+
+////////////////////////////////////////////////////////////////////////////////
+// Decompressor
+// Streaming decompression of a stream produced by Compress()/Compressor. Input
+// is supplied in arbitrary slices via decompress() (e.g. as it is read from a
+// file), output is passed to a callback in chunks of at most 32kb. Memory use
+// is bounded by the size of the dictionary (32kb) regardless of the stream
+// size.
+////////////////////////////////////////////////////////////////////////////////
+class Decompressor
+{
+public:
+
+	Decompressor(CompressionOutputFunc* _output, void* _outputArg);
+	~Decompressor();
+
+	// Decompress _inSizeBytes from _in. Return false if the stream is corrupt or if the output callback failed.
+	bool decompress(const void* _in, uint _inSizeBytes);
+
+	// Return true if the end of the stream was reached.
+	bool isComplete() const;
+
+private:
+
+	struct Impl;
+	Impl* m_impl;
+
+}; // class Decompressor
+
+////////////////////////////////////////////////////////////////////////////////
+// CompressedBlocks
+// Container of independently compressed blocks. Blocks can be decompressed in
+// any order (random access) or in parallel, and as soon as they are resident
+// (i.e. while the rest of the container is still being read).
+//
+// Layout:
+//   Header       magic 'FRMZ', block size, block count, decompressed size.
+//   Block table  End offset of each block (uint64).
+//   Blocks       Compressed blocks. Blocks which don't compress are stored
+//                as-is (compressed size == decompressed size).
+////////////////////////////////////////////////////////////////////////////////
+class CompressedBlocks
+{
+public:
+
+	static constexpr uint32 kDefaultBlockSizeBytes = 256 * 1024;
+
+	// Compress _inSizeBytes from _in to out_ (allocated by the function, release via free()). Blocks are compressed in parallel via
+	// JobSystem.
+	static void Compress(const void* _in, uint _inSizeBytes, void*& out_, uint& outSizeBytes_, CompressionFlags _flags = CompressionFlags_Default, uint32 _blockSizeBytes = kDefaultBlockSizeBytes);
+
+	// Return the size of the header + block table, or 0 if _in doesn't begin with a valid header. _inSizeBytes may be less than the
+	// size of the whole container.
+	static uint GetHeaderSizeBytes(const void* _in, uint _inSizeBytes);
+
+	// _data must contain at least the header and block table (see GetHeaderSizeBytes()), and must remain valid for the lifetime of
+	// the object. Use isValid() to check the result.
+	CompressedBlocks(const void* _data, uint _sizeBytes);
+
+	bool   isValid() const                    { return m_blockTable != nullptr; }
+
+	uint32 getBlockCount() const              { return m_blockCount; }
+	uint32 getBlockSizeBytes() const          { return m_blockSizeBytes; }
+	uint   getDecompressedSizeBytes() const   { return (uint)m_decompressedSizeBytes; }
+
+	// Return the decompressed size of block _index (the last block may be smaller than getBlockSizeBytes()).
+	uint32 getBlockDecompressedSizeBytes(uint32 _index) const;
+
+	// Return the number of blocks which are fully resident if the first _sizeBytes of the container are available.
+	uint32 getAvailableBlockCount(uint _sizeBytes) const;
+
+	// Decompress block _index to out_, which must be at least getBlockDecompressedSizeBytes(_index). Return false if the block is
+	// corrupt.
+	bool   decompressBlock(uint32 _index, void* out_) const;
+
+	// Decompress _count blocks starting at _first in parallel via JobSystem. out_ receives block _first at offset 0. Return false if
+	// any block is corrupt.
+	bool   decompress(void* out_, uint32 _first = 0, uint32 _count = ~0u) const;
+
+private:
+
+	const char*   m_data                  = nullptr;
+	const char*   m_blockTable            = nullptr; // uint64 block end offsets, may be unaligned (see getBlockEnd()).
+	uint64        m_decompressedSizeBytes = 0;
+	uint32        m_blockCount            = 0;
+	uint32        m_blockSizeBytes        = 0;
+	uint32        m_headerSizeBytes       = 0;
+
+	uint64 getBlockBegin(uint32 _index) const;
+	uint64 getBlockEnd(uint32 _index) const;
+
+}; // class CompressedBlocks
+
 } // namespace frm
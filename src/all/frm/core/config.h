@@ -24,6 +24,8 @@
 // Platform 
 #if defined(_WIN32) || defined(_WIN64)
 	#define FRM_PLATFORM_WIN 1
+#elif defined(__linux__)
+	#define FRM_PLATFORM_LINUX 1
 #else
 	#error frm: Platform not defined
 #endif
@@ -35,6 +37,34 @@
 	#error frm: Architecture not defined
 #endif
 
+// SIMD instruction sets. SSE2 is the baseline for x86-64, AVX2 must be enabled via the compiler (e.g. /arch:AVX2, -mavx2).
+// BMI2 (pdep/pext) and F16C (half precision conversion) are assumed to be available with AVX2 (MSVC doesn't define __BMI2__
+// or __F16C__).
+#if defined(_M_X64) || defined(__x86_64)
+	#define FRM_SIMD_SSE2 1
+#endif
+#if defined(__AVX2__)
+	#define FRM_SIMD_AVX2 1
+#endif
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+	#define FRM_SIMD_BMI2 1
+#endif
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+	#define FRM_SIMD_F16C 1
+#endif
+#ifndef FRM_SIMD_SSE2
+	#define FRM_SIMD_SSE2 0
+#endif
+#ifndef FRM_SIMD_AVX2
+	#define FRM_SIMD_AVX2 0
+#endif
+#ifndef FRM_SIMD_BMI2
+	#define FRM_SIMD_BMI2 0
+#endif
+#ifndef FRM_SIMD_F16C
+	#define FRM_SIMD_F16C 0
+#endif
+
 // Modules
 #ifndef FRM_MODULE_CORE
 	#define FRM_MODULE_CORE 0
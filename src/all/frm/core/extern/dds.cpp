@@ -719,13 +719,13 @@ bool Image::WriteDds(File& file_, const Image& _img)
 	dxt10h = (DDS_HEADER_DXT10*)(buf + sizeof(DWORD) + sizeof(DDS_HEADER));
 	if (_img.isCompressed()) {
 		switch (_img.m_compression) {
-			case Image::Compression_BC1:     dxt10h->dxgiFormat = DXGI_FORMAT_BC1_TYPELESS; break;
-			case Image::Compression_BC2:     dxt10h->dxgiFormat = DXGI_FORMAT_BC2_TYPELESS; break;
-			case Image::Compression_BC3:     dxt10h->dxgiFormat = DXGI_FORMAT_BC3_TYPELESS; break;
-			case Image::Compression_BC4:     dxt10h->dxgiFormat = DXGI_FORMAT_BC4_TYPELESS; break;
-			case Image::Compression_BC5:     dxt10h->dxgiFormat = DXGI_FORMAT_BC5_TYPELESS; break;
-			case Image::Compression_BC6:     dxt10h->dxgiFormat = DXGI_FORMAT_BC6H_TYPELESS; break;
-			case Image::Compression_BC7:     dxt10h->dxgiFormat = DXGI_FORMAT_BC7_TYPELESS; break;
+			case Image::Compression_BC1:     dxt10h->dxgiFormat = DXGI_FORMAT_BC1_UNORM; break;
+			case Image::Compression_BC2:     dxt10h->dxgiFormat = DXGI_FORMAT_BC2_UNORM; break;
+			case Image::Compression_BC3:     dxt10h->dxgiFormat = DXGI_FORMAT_BC3_UNORM; break;
+			case Image::Compression_BC4:     dxt10h->dxgiFormat = DXGI_FORMAT_BC4_UNORM; break;
+			case Image::Compression_BC5:     dxt10h->dxgiFormat = DXGI_FORMAT_BC5_UNORM; break;
+			case Image::Compression_BC6:     dxt10h->dxgiFormat = DXGI_FORMAT_BC6H_UF16; break;
+			case Image::Compression_BC7:     dxt10h->dxgiFormat = DXGI_FORMAT_BC7_UNORM; break;
 			default:
 				FRM_ASSERT(false);
 				goto WriteDds_End;
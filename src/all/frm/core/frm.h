@@ -117,6 +117,7 @@ namespace frm {
 	class  App;
 	class  AppSample;
 	class  AppSample3d;
+	class  AtlasAllocator;
 	class  BasicMaterial;
 	class  BasicRenderer;
 		class BasicRenderableComponent;
@@ -161,6 +162,8 @@ namespace frm {
 	class  Skeleton;
 	class  SkeletonAnimation;
 	class  SkeletonAnimationTrack;
+	class  SkeletonBlendTree;
+	class  SkeletonPose;
 	class  SplinePath;
 	class  StreamingQuadtree;
 	class  Texture;
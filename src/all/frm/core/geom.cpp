@@ -3,6 +3,12 @@
 #include <frm/core/math.h>
 #include <frm/core/interpolation.h>
 
+#if FRM_SIMD_AVX2
+	#include <immintrin.h>
+#elif FRM_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
 #define geom_debug
 #ifdef geom_debug
 	#include <imgui/imgui.h>
@@ -267,6 +273,36 @@ vec3 Capsule::getOrigin() const
 	return 0.5f * (m_end + m_start);
 }
 
+/*******************************************************************************
+
+                                 Triangle
+
+*******************************************************************************/
+
+Triangle::Triangle(const vec3& _v0, const vec3& _v1, const vec3& _v2)
+{
+	m_vertices[0] = _v0;
+	m_vertices[1] = _v1;
+	m_vertices[2] = _v2;
+}
+
+void Triangle::transform(const mat4& _mat)
+{
+	m_vertices[0] = TransformPosition(_mat, m_vertices[0]);
+	m_vertices[1] = TransformPosition(_mat, m_vertices[1]);
+	m_vertices[2] = TransformPosition(_mat, m_vertices[2]);
+}
+
+vec3 Triangle::getOrigin() const
+{
+	return (m_vertices[0] + m_vertices[1] + m_vertices[2]) / 3.0f;
+}
+
+vec3 Triangle::getNormal() const
+{
+	return Normalize(Cross(m_vertices[1] - m_vertices[0], m_vertices[2] - m_vertices[0]));
+}
+
 /*******************************************************************************
 
                                  Frustum
@@ -396,6 +432,25 @@ bool Frustum::insideIgnoreNear(const Sphere& _sphere) const
 	return true;
 }
 
+bool Frustum::insideIgnoreNear(const AlignedBox& _box) const
+{
+	for (int i = 1; i < Plane_Count; ++i)
+	{
+		vec3 n = m_planes[i].m_normal;
+		float d = 
+			Max(_box.m_min.x * n.x, _box.m_max.x * n.x) +
+			Max(_box.m_min.y * n.y, _box.m_max.y * n.y) +
+			Max(_box.m_min.z * n.z, _box.m_max.z * n.z) -
+			m_planes[i].m_offset
+			;
+		if (d < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 bool Frustum::inside(const AlignedBox& _box) const
 {
 #if 0
@@ -448,6 +503,218 @@ bool Frustum::inside(const AlignedBox& _box) const
 #endif
 }
 
+// Batch tests. The SIMD paths evaluate the plane distances in the same order as the scalar tests (mul + add, no FMA) and
+// use unordered compares (!(d < x)), hence results are identical to the per-object tests.
+namespace {
+
+#if FRM_SIMD_AVX2
+	inline int SphereMask8(const Plane* _planes, int _firstPlane, const SphereSoA& _spheres, uint32 _i)
+	{
+		const __m256 x = _mm256_loadu_ps(_spheres.m_originX + _i);
+		const __m256 y = _mm256_loadu_ps(_spheres.m_originY + _i);
+		const __m256 z = _mm256_loadu_ps(_spheres.m_originZ + _i);
+		const __m256 r = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(_spheres.m_radius + _i));
+		__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+		{
+			const Plane& plane = _planes[p];
+			__m256 d = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.m_normal.x)), _mm256_mul_ps(y, _mm256_set1_ps(plane.m_normal.y)));
+			d = _mm256_add_ps(d, _mm256_mul_ps(z, _mm256_set1_ps(plane.m_normal.z)));
+			d = _mm256_sub_ps(d, _mm256_set1_ps(plane.m_offset));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(d, r, _CMP_NLT_UQ));
+		}
+		return _mm256_movemask_ps(mask);
+	}
+
+	inline int BoxMask8(const Plane* _planes, int _firstPlane, const AlignedBoxSoA& _boxes, uint32 _i)
+	{
+		const __m256 minX = _mm256_loadu_ps(_boxes.m_minX + _i);
+		const __m256 minY = _mm256_loadu_ps(_boxes.m_minY + _i);
+		const __m256 minZ = _mm256_loadu_ps(_boxes.m_minZ + _i);
+		const __m256 maxX = _mm256_loadu_ps(_boxes.m_maxX + _i);
+		const __m256 maxY = _mm256_loadu_ps(_boxes.m_maxY + _i);
+		const __m256 maxZ = _mm256_loadu_ps(_boxes.m_maxZ + _i);
+		__m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+		{
+			const Plane& plane = _planes[p];
+			const __m256 nx = _mm256_set1_ps(plane.m_normal.x);
+			const __m256 ny = _mm256_set1_ps(plane.m_normal.y);
+			const __m256 nz = _mm256_set1_ps(plane.m_normal.z);
+			__m256 d = _mm256_add_ps(_mm256_max_ps(_mm256_mul_ps(minX, nx), _mm256_mul_ps(maxX, nx)), _mm256_max_ps(_mm256_mul_ps(minY, ny), _mm256_mul_ps(maxY, ny)));
+			d = _mm256_add_ps(d, _mm256_max_ps(_mm256_mul_ps(minZ, nz), _mm256_mul_ps(maxZ, nz)));
+			d = _mm256_sub_ps(d, _mm256_set1_ps(plane.m_offset));
+			mask = _mm256_and_ps(mask, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_NLT_UQ));
+		}
+		return _mm256_movemask_ps(mask);
+	}
+#endif
+
+#if FRM_SIMD_SSE2
+	inline int SphereMask4(const Plane* _planes, int _firstPlane, const SphereSoA& _spheres, uint32 _i)
+	{
+		const __m128 x = _mm_loadu_ps(_spheres.m_originX + _i);
+		const __m128 y = _mm_loadu_ps(_spheres.m_originY + _i);
+		const __m128 z = _mm_loadu_ps(_spheres.m_originZ + _i);
+		const __m128 r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(_spheres.m_radius + _i));
+		__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+		{
+			const Plane& plane = _planes[p];
+			__m128 d = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.m_normal.x)), _mm_mul_ps(y, _mm_set1_ps(plane.m_normal.y)));
+			d = _mm_add_ps(d, _mm_mul_ps(z, _mm_set1_ps(plane.m_normal.z)));
+			d = _mm_sub_ps(d, _mm_set1_ps(plane.m_offset));
+			mask = _mm_and_ps(mask, _mm_cmpnlt_ps(d, r));
+		}
+		return _mm_movemask_ps(mask);
+	}
+
+	inline int BoxMask4(const Plane* _planes, int _firstPlane, const AlignedBoxSoA& _boxes, uint32 _i)
+	{
+		const __m128 minX = _mm_loadu_ps(_boxes.m_minX + _i);
+		const __m128 minY = _mm_loadu_ps(_boxes.m_minY + _i);
+		const __m128 minZ = _mm_loadu_ps(_boxes.m_minZ + _i);
+		const __m128 maxX = _mm_loadu_ps(_boxes.m_maxX + _i);
+		const __m128 maxY = _mm_loadu_ps(_boxes.m_maxY + _i);
+		const __m128 maxZ = _mm_loadu_ps(_boxes.m_maxZ + _i);
+		__m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+		{
+			const Plane& plane = _planes[p];
+			const __m128 nx = _mm_set1_ps(plane.m_normal.x);
+			const __m128 ny = _mm_set1_ps(plane.m_normal.y);
+			const __m128 nz = _mm_set1_ps(plane.m_normal.z);
+			__m128 d = _mm_add_ps(_mm_max_ps(_mm_mul_ps(minX, nx), _mm_mul_ps(maxX, nx)), _mm_max_ps(_mm_mul_ps(minY, ny), _mm_mul_ps(maxY, ny)));
+			d = _mm_add_ps(d, _mm_max_ps(_mm_mul_ps(minZ, nz), _mm_mul_ps(maxZ, nz)));
+			d = _mm_sub_ps(d, _mm_set1_ps(plane.m_offset));
+			mask = _mm_and_ps(mask, _mm_cmpnlt_ps(d, _mm_setzero_ps()));
+		}
+		return _mm_movemask_ps(mask);
+	}
+#endif
+
+bool SphereInside(const Plane* _planes, int _firstPlane, const SphereSoA& _spheres, uint32 _i)
+{
+	const vec3 origin(_spheres.m_originX[_i], _spheres.m_originY[_i], _spheres.m_originZ[_i]);
+	for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+	{
+		if (Distance(_planes[p], origin) < -_spheres.m_radius[_i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool BoxInside(const Plane* _planes, int _firstPlane, const AlignedBoxSoA& _boxes, uint32 _i)
+{
+	for (int p = _firstPlane; p < Frustum::Plane_Count; ++p)
+	{
+		vec3 n = _planes[p].m_normal;
+		float d = 
+			Max(_boxes.m_minX[_i] * n.x, _boxes.m_maxX[_i] * n.x) +
+			Max(_boxes.m_minY[_i] * n.y, _boxes.m_maxY[_i] * n.y) +
+			Max(_boxes.m_minZ[_i] * n.z, _boxes.m_maxZ[_i] * n.z) -
+			_planes[p].m_offset
+			;
+		if (d < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Test 16 objects per iteration (AVX2), then 4 (SSE2), then the scalar remainder. i is always a multiple of the current
+// batch size, hence each batch mask fits in a single word of visible_.
+uint32 SphereBatch(const Plane* _planes, int _firstPlane, const SphereSoA& _spheres, uint32 _count, uint32* visible_)
+{
+	memset(visible_, 0, sizeof(uint32) * ((_count + 31) / 32));
+
+	uint32 ret = 0;
+	uint32 i = 0;
+	#if FRM_SIMD_AVX2
+		for (; i + 16 <= _count; i += 16)
+		{
+			const uint32 mask = (uint32)SphereMask8(_planes, _firstPlane, _spheres, i) | ((uint32)SphereMask8(_planes, _firstPlane, _spheres, i + 8) << 8);
+			visible_[i / 32] |= mask << (i % 32);
+			ret += CountBits(mask);
+		}
+	#endif
+	#if FRM_SIMD_SSE2
+		for (; i + 4 <= _count; i += 4)
+		{
+			const uint32 mask = (uint32)SphereMask4(_planes, _firstPlane, _spheres, i);
+			visible_[i / 32] |= mask << (i % 32);
+			ret += CountBits(mask);
+		}
+	#endif
+	for (; i < _count; ++i)
+	{
+		if (SphereInside(_planes, _firstPlane, _spheres, i))
+		{
+			visible_[i / 32] |= 1u << (i % 32);
+			++ret;
+		}
+	}
+	return ret;
+}
+
+uint32 BoxBatch(const Plane* _planes, int _firstPlane, const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_)
+{
+	memset(visible_, 0, sizeof(uint32) * ((_count + 31) / 32));
+
+	uint32 ret = 0;
+	uint32 i = 0;
+	#if FRM_SIMD_AVX2
+		for (; i + 16 <= _count; i += 16)
+		{
+			const uint32 mask = (uint32)BoxMask8(_planes, _firstPlane, _boxes, i) | ((uint32)BoxMask8(_planes, _firstPlane, _boxes, i + 8) << 8);
+			visible_[i / 32] |= mask << (i % 32);
+			ret += CountBits(mask);
+		}
+	#endif
+	#if FRM_SIMD_SSE2
+		for (; i + 4 <= _count; i += 4)
+		{
+			const uint32 mask = (uint32)BoxMask4(_planes, _firstPlane, _boxes, i);
+			visible_[i / 32] |= mask << (i % 32);
+			ret += CountBits(mask);
+		}
+	#endif
+	for (; i < _count; ++i)
+	{
+		if (BoxInside(_planes, _firstPlane, _boxes, i))
+		{
+			visible_[i / 32] |= 1u << (i % 32);
+			++ret;
+		}
+	}
+	return ret;
+}
+
+} // namespace
+
+uint32 Frustum::inside(const SphereSoA& _spheres, uint32 _count, uint32* visible_) const
+{
+	return SphereBatch(m_planes, 0, _spheres, _count, visible_);
+}
+
+uint32 Frustum::inside(const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_) const
+{
+	return BoxBatch(m_planes, 0, _boxes, _count, visible_);
+}
+
+uint32 Frustum::insideIgnoreNear(const SphereSoA& _spheres, uint32 _count, uint32* visible_) const
+{
+	return SphereBatch(m_planes, 1, _spheres, _count, visible_);
+}
+
+uint32 Frustum::insideIgnoreNear(const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_) const
+{
+	return BoxBatch(m_planes, 1, _boxes, _count, visible_);
+}
+
 void Frustum::setVertices(const vec3 _vertices[8])
 {
 	memcpy(m_vertices, _vertices, sizeof(m_vertices));
@@ -1120,6 +1387,385 @@ bool frm::Intersect(const Ray& _ray, const Cylinder& _cylinder, float& t0_, floa
 	return true;
 }
 
+bool frm::Intersects(const Ray& _ray, const Triangle& _triangle, bool _cullBackFace)
+{
+	float t0;
+	vec2 barycentrics;
+	return Intersect(_ray, _triangle, t0, barycentrics, _cullBackFace);
+}
+bool frm::Intersect(const Ray& _ray, const Triangle& _triangle, float& t0_, vec2& barycentrics_, bool _cullBackFace)
+{
+ // Note that the batch kernels (see TriangleMask4()) must match the order of operations here.
+	const vec3  e1  = _triangle.m_vertices[1] - _triangle.m_vertices[0];
+	const vec3  e2  = _triangle.m_vertices[2] - _triangle.m_vertices[0];
+	const vec3  pv  = Cross(_ray.m_direction, e2);
+	const float det = Dot(e1, pv);
+	if (_cullBackFace ? !(det > 0.0f) : det == 0.0f)
+	{
+		return false;
+	}
+	const float invDet = 1.0f / det;
+	const vec3  tv = _ray.m_origin - _triangle.m_vertices[0];
+	const float u  = Dot(tv, pv) * invDet;
+	if (!(u >= 0.0f && u <= 1.0f))
+	{
+		return false;
+	}
+	const vec3  qv = Cross(tv, e1);
+	const float v  = Dot(_ray.m_direction, qv) * invDet;
+	if (!(v >= 0.0f && u + v <= 1.0f))
+	{
+		return false;
+	}
+	const float t = Dot(e2, qv) * invDet;
+	if (!(t >= 0.0f))
+	{
+		return false;
+	}
+	t0_ = t;
+	barycentrics_ = vec2(u, v);
+	return true;
+}
+bool frm::IntersectClosest(const Ray& _ray, const Triangle& _triangle, float& tMax_, vec2& barycentrics_, bool _cullBackFace)
+{
+	float t0;
+	vec2 barycentrics;
+	if (Intersect(_ray, _triangle, t0, barycentrics, _cullBackFace) && t0 < tMax_)
+	{
+		tMax_ = t0;
+		barycentrics_ = barycentrics;
+		return true;
+	}
+	return false;
+}
+bool frm::IntersectWatertight(const Ray& _ray, const Triangle& _triangle, float& t0_, vec2& barycentrics_, bool _cullBackFace)
+{
+ // Permute axes such that kz is the dominant axis of the ray direction, swap kx,ky to preserve the winding.
+	const vec3 absDirection = abs(_ray.m_direction);
+	const int kz = (absDirection.x > absDirection.y) ? (absDirection.x > absDirection.z ? 0 : 2) : (absDirection.y > absDirection.z ? 1 : 2);
+	const int kx = (_ray.m_direction[kz] < 0.0f) ? (kz + 2) % 3 : (kz + 1) % 3;
+	const int ky = (_ray.m_direction[kz] < 0.0f) ? (kz + 1) % 3 : (kz + 2) % 3;
+
+ // Shear/scale such that the ray direction is +z.
+	const float sx = _ray.m_direction[kx] / _ray.m_direction[kz];
+	const float sy = _ray.m_direction[ky] / _ray.m_direction[kz];
+	const float sz = 1.0f / _ray.m_direction[kz];
+	const vec3  a  = _triangle.m_vertices[0] - _ray.m_origin;
+	const vec3  b  = _triangle.m_vertices[1] - _ray.m_origin;
+	const vec3  c  = _triangle.m_vertices[2] - _ray.m_origin;
+	const float ax = a[kx] - sx * a[kz];
+	const float ay = a[ky] - sy * a[kz];
+	const float bx = b[kx] - sx * b[kz];
+	const float by = b[ky] - sy * b[kz];
+	const float cx = c[kx] - sx * c[kz];
+	const float cy = c[ky] - sy * c[kz];
+
+ // Scaled barycentrics, fall back to double precision on edges.
+	float u = cx * by - cy * bx;
+	float v = ax * cy - ay * cx;
+	float w = bx * ay - by * ax;
+	if (u == 0.0f || v == 0.0f || w == 0.0f)
+	{
+		u = (float)((double)cx * (double)by - (double)cy * (double)bx);
+		v = (float)((double)ax * (double)cy - (double)ay * (double)cx);
+		w = (float)((double)bx * (double)ay - (double)by * (double)ax);
+	}
+
+ // Front faces have positive scaled barycentrics (see Triangle).
+	const bool anyNegative = u < 0.0f || v < 0.0f || w < 0.0f;
+	const bool anyPositive = u > 0.0f || v > 0.0f || w > 0.0f;
+	if ((_cullBackFace && anyNegative) || (anyNegative && anyPositive))
+	{
+		return false;
+	}
+	const float det = u + v + w;
+	if (det == 0.0f)
+	{
+		return false;
+	}
+
+	const float t = u * (sz * a[kz]) + v * (sz * b[kz]) + w * (sz * c[kz]);
+	if ((det < 0.0f && t > 0.0f) || (det > 0.0f && t < 0.0f))
+	{
+		return false;
+	}
+	const float invDet = 1.0f / det;
+	t0_ = t * invDet;
+	barycentrics_ = vec2(v * invDet, w * invDet);
+	return true;
+}
+
+// Batch ray-primitive intersection
+
+namespace {
+
+inline uint32 BoxMask1(const vec3& _origin, const vec3& _invDirection, const AlignedBoxSoA& _boxes, uint32 _i, float _tMax, float* t0_)
+{
+	const vec3 t0 = (vec3(_boxes.m_minX[_i], _boxes.m_minY[_i], _boxes.m_minZ[_i]) - _origin) * _invDirection;
+	const vec3 t1 = (vec3(_boxes.m_maxX[_i], _boxes.m_maxY[_i], _boxes.m_maxZ[_i]) - _origin) * _invDirection;
+	const vec3 tmin = Min(t0, t1);
+	const vec3 tmax = Max(t0, t1);
+	const float tnear = Max(Max(tmin.x, tmin.y), Max(tmin.z, 0.0f));
+	const float tfar  = Min(Min(tmax.x, tmax.y), Min(tmax.z, _tMax));
+	if (tnear <= tfar)
+	{
+		t0_[_i] = tnear;
+		return 1u << _i;
+	}
+	return 0;
+}
+
+inline uint32 TriangleMask1(const Ray& _ray, const TriangleSoA& _triangles, uint32 _i, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace)
+{
+	const Triangle triangle(
+		vec3(_triangles.m_v0X[_i], _triangles.m_v0Y[_i], _triangles.m_v0Z[_i]),
+		vec3(_triangles.m_v1X[_i], _triangles.m_v1Y[_i], _triangles.m_v1Z[_i]),
+		vec3(_triangles.m_v2X[_i], _triangles.m_v2Y[_i], _triangles.m_v2Z[_i])
+		);
+	float t0;
+	vec2 barycentrics;
+	if (Intersect(_ray, triangle, t0, barycentrics, _cullBackFace) && t0 < _tMax)
+	{
+		t0_[_i] = t0;
+		u_[_i]  = barycentrics.x;
+		v_[_i]  = barycentrics.y;
+		return 1u << _i;
+	}
+	return 0;
+}
+
+inline AlignedBoxSoA Offset(const AlignedBoxSoA& _boxes, uint32 _offset)
+{
+	return { _boxes.m_minX + _offset, _boxes.m_minY + _offset, _boxes.m_minZ + _offset, _boxes.m_maxX + _offset, _boxes.m_maxY + _offset, _boxes.m_maxZ + _offset };
+}
+
+inline TriangleSoA Offset(const TriangleSoA& _triangles, uint32 _offset)
+{
+	return {
+		_triangles.m_v0X + _offset, _triangles.m_v0Y + _offset, _triangles.m_v0Z + _offset,
+		_triangles.m_v1X + _offset, _triangles.m_v1Y + _offset, _triangles.m_v1Z + _offset,
+		_triangles.m_v2X + _offset, _triangles.m_v2Y + _offset, _triangles.m_v2Z + _offset
+		};
+}
+
+#if FRM_SIMD_SSE2
+	inline uint32 BoxMask4(const vec3& _origin, const vec3& _invDirection, const AlignedBoxSoA& _boxes, float _tMax, float* t0_)
+	{
+		const __m128 ox = _mm_set1_ps(_origin.x), oy = _mm_set1_ps(_origin.y), oz = _mm_set1_ps(_origin.z);
+		const __m128 ix = _mm_set1_ps(_invDirection.x), iy = _mm_set1_ps(_invDirection.y), iz = _mm_set1_ps(_invDirection.z);
+		const __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_minX), ox), ix);
+		const __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_minY), oy), iy);
+		const __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_minZ), oz), iz);
+		const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_maxX), ox), ix);
+		const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_maxY), oy), iy);
+		const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(_boxes.m_maxZ), oz), iz);
+		const __m128 tnear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+		const __m128 tfar  = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(_tMax)));
+		const uint32 mask = (uint32)_mm_movemask_ps(_mm_cmple_ps(tnear, tfar));
+		float tnear4[4];
+		_mm_storeu_ps(tnear4, tnear);
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			if (mask & (1u << i))
+			{
+				t0_[i] = tnear4[i];
+			}
+		}
+		return mask;
+	}
+
+	inline __m128 Dot4(__m128 _ax, __m128 _ay, __m128 _az, __m128 _bx, __m128 _by, __m128 _bz)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_ax, _bx), _mm_mul_ps(_ay, _by)), _mm_mul_ps(_az, _bz));
+	}
+
+	inline uint32 TriangleMask4(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace)
+	{
+		const __m128 dx  = _mm_set1_ps(_ray.m_direction.x), dy = _mm_set1_ps(_ray.m_direction.y), dz = _mm_set1_ps(_ray.m_direction.z);
+		const __m128 v0x = _mm_loadu_ps(_triangles.m_v0X), v0y = _mm_loadu_ps(_triangles.m_v0Y), v0z = _mm_loadu_ps(_triangles.m_v0Z);
+		const __m128 e1x = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v1X), v0x);
+		const __m128 e1y = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v1Y), v0y);
+		const __m128 e1z = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v1Z), v0z);
+		const __m128 e2x = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v2X), v0x);
+		const __m128 e2y = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v2Y), v0y);
+		const __m128 e2z = _mm_sub_ps(_mm_loadu_ps(_triangles.m_v2Z), v0z);
+
+		const __m128 pvx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 pvy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 pvz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		const __m128 det = Dot4(e1x, e1y, e1z, pvx, pvy, pvz);
+		const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		const __m128 tvx = _mm_sub_ps(_mm_set1_ps(_ray.m_origin.x), v0x);
+		const __m128 tvy = _mm_sub_ps(_mm_set1_ps(_ray.m_origin.y), v0y);
+		const __m128 tvz = _mm_sub_ps(_mm_set1_ps(_ray.m_origin.z), v0z);
+		const __m128 u   = _mm_mul_ps(Dot4(tvx, tvy, tvz, pvx, pvy, pvz), invDet);
+
+		const __m128 qvx = _mm_sub_ps(_mm_mul_ps(tvy, e1z), _mm_mul_ps(tvz, e1y));
+		const __m128 qvy = _mm_sub_ps(_mm_mul_ps(tvz, e1x), _mm_mul_ps(tvx, e1z));
+		const __m128 qvz = _mm_sub_ps(_mm_mul_ps(tvx, e1y), _mm_mul_ps(tvy, e1x));
+		const __m128 v   = _mm_mul_ps(Dot4(dx, dy, dz, qvx, qvy, qvz), invDet);
+		const __m128 t   = _mm_mul_ps(Dot4(e2x, e2y, e2z, qvx, qvy, qvz), invDet);
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one  = _mm_set1_ps(1.0f);
+		__m128 valid = _cullBackFace ? _mm_cmpgt_ps(det, zero) : _mm_cmpneq_ps(det, zero);
+		valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+		valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+		valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(_tMax))));
+		const uint32 mask = (uint32)_mm_movemask_ps(valid);
+		if (mask)
+		{
+			float t4[4], u4[4], v4[4];
+			_mm_storeu_ps(t4, t);
+			_mm_storeu_ps(u4, u);
+			_mm_storeu_ps(v4, v);
+			for (uint32 i = 0; i < 4; ++i)
+			{
+				if (mask & (1u << i))
+				{
+					t0_[i] = t4[i];
+					u_[i]  = u4[i];
+					v_[i]  = v4[i];
+				}
+			}
+		}
+		return mask;
+	}
+#endif
+
+#if FRM_SIMD_AVX2
+	inline uint32 BoxMask8(const vec3& _origin, const vec3& _invDirection, const AlignedBoxSoA& _boxes, float _tMax, float* t0_)
+	{
+		const __m256 ox = _mm256_set1_ps(_origin.x), oy = _mm256_set1_ps(_origin.y), oz = _mm256_set1_ps(_origin.z);
+		const __m256 ix = _mm256_set1_ps(_invDirection.x), iy = _mm256_set1_ps(_invDirection.y), iz = _mm256_set1_ps(_invDirection.z);
+		const __m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_minX), ox), ix);
+		const __m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_minY), oy), iy);
+		const __m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_minZ), oz), iz);
+		const __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_maxX), ox), ix);
+		const __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_maxY), oy), iy);
+		const __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(_boxes.m_maxZ), oz), iz);
+		const __m256 tnear = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)), _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+		const __m256 tfar  = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)), _mm256_min_ps(_mm256_max_ps(t0z, t1z), _mm256_set1_ps(_tMax)));
+		const uint32 mask = (uint32)_mm256_movemask_ps(_mm256_cmp_ps(tnear, tfar, _CMP_LE_OQ));
+		float tnear8[8];
+		_mm256_storeu_ps(tnear8, tnear);
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			if (mask & (1u << i))
+			{
+				t0_[i] = tnear8[i];
+			}
+		}
+		return mask;
+	}
+
+	inline __m256 Dot8(__m256 _ax, __m256 _ay, __m256 _az, __m256 _bx, __m256 _by, __m256 _bz)
+	{
+		return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_ax, _bx), _mm256_mul_ps(_ay, _by)), _mm256_mul_ps(_az, _bz));
+	}
+
+	inline uint32 TriangleMask8(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace)
+	{
+		const __m256 dx  = _mm256_set1_ps(_ray.m_direction.x), dy = _mm256_set1_ps(_ray.m_direction.y), dz = _mm256_set1_ps(_ray.m_direction.z);
+		const __m256 v0x = _mm256_loadu_ps(_triangles.m_v0X), v0y = _mm256_loadu_ps(_triangles.m_v0Y), v0z = _mm256_loadu_ps(_triangles.m_v0Z);
+		const __m256 e1x = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v1X), v0x);
+		const __m256 e1y = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v1Y), v0y);
+		const __m256 e1z = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v1Z), v0z);
+		const __m256 e2x = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v2X), v0x);
+		const __m256 e2y = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v2Y), v0y);
+		const __m256 e2z = _mm256_sub_ps(_mm256_loadu_ps(_triangles.m_v2Z), v0z);
+
+		const __m256 pvx = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+		const __m256 pvy = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+		const __m256 pvz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+		const __m256 det = Dot8(e1x, e1y, e1z, pvx, pvy, pvz);
+		const __m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+		const __m256 tvx = _mm256_sub_ps(_mm256_set1_ps(_ray.m_origin.x), v0x);
+		const __m256 tvy = _mm256_sub_ps(_mm256_set1_ps(_ray.m_origin.y), v0y);
+		const __m256 tvz = _mm256_sub_ps(_mm256_set1_ps(_ray.m_origin.z), v0z);
+		const __m256 u   = _mm256_mul_ps(Dot8(tvx, tvy, tvz, pvx, pvy, pvz), invDet);
+
+		const __m256 qvx = _mm256_sub_ps(_mm256_mul_ps(tvy, e1z), _mm256_mul_ps(tvz, e1y));
+		const __m256 qvy = _mm256_sub_ps(_mm256_mul_ps(tvz, e1x), _mm256_mul_ps(tvx, e1z));
+		const __m256 qvz = _mm256_sub_ps(_mm256_mul_ps(tvx, e1y), _mm256_mul_ps(tvy, e1x));
+		const __m256 v   = _mm256_mul_ps(Dot8(dx, dy, dz, qvx, qvy, qvz), invDet);
+		const __m256 t   = _mm256_mul_ps(Dot8(e2x, e2y, e2z, qvx, qvy, qvz), invDet);
+
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one  = _mm256_set1_ps(1.0f);
+		__m256 valid = _cullBackFace ? _mm256_cmp_ps(det, zero, _CMP_GT_OQ) : _mm256_cmp_ps(det, zero, _CMP_NEQ_UQ);
+		valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+		valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+		valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(_tMax), _CMP_LT_OQ)));
+		const uint32 mask = (uint32)_mm256_movemask_ps(valid);
+		if (mask)
+		{
+			float t8[8], u8[8], v8[8];
+			_mm256_storeu_ps(t8, t);
+			_mm256_storeu_ps(u8, u);
+			_mm256_storeu_ps(v8, v);
+			for (uint32 i = 0; i < 8; ++i)
+			{
+				if (mask & (1u << i))
+				{
+					t0_[i] = t8[i];
+					u_[i]  = u8[i];
+					v_[i]  = v8[i];
+				}
+			}
+		}
+		return mask;
+	}
+#endif
+
+} // namespace
+
+uint32 frm::Intersect4(const Ray& _ray, const AlignedBoxSoA& _boxes, float _tMax, float* t0_)
+{
+	const vec3 invDirection = 1.0f / _ray.m_direction;
+	#if FRM_SIMD_SSE2
+		return BoxMask4(_ray.m_origin, invDirection, _boxes, _tMax, t0_);
+	#else
+		uint32 ret = 0;
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			ret |= BoxMask1(_ray.m_origin, invDirection, _boxes, i, _tMax, t0_);
+		}
+		return ret;
+	#endif
+}
+uint32 frm::Intersect8(const Ray& _ray, const AlignedBoxSoA& _boxes, float _tMax, float* t0_)
+{
+	#if FRM_SIMD_AVX2
+		return BoxMask8(_ray.m_origin, 1.0f / _ray.m_direction, _boxes, _tMax, t0_);
+	#else
+		return Intersect4(_ray, _boxes, _tMax, t0_) | (Intersect4(_ray, Offset(_boxes, 4), _tMax, t0_ + 4) << 4);
+	#endif
+}
+uint32 frm::Intersect4(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace)
+{
+	#if FRM_SIMD_SSE2
+		return TriangleMask4(_ray, _triangles, _tMax, t0_, u_, v_, _cullBackFace);
+	#else
+		uint32 ret = 0;
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			ret |= TriangleMask1(_ray, _triangles, i, _tMax, t0_, u_, v_, _cullBackFace);
+		}
+		return ret;
+	#endif
+}
+uint32 frm::Intersect8(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace)
+{
+	#if FRM_SIMD_AVX2
+		return TriangleMask8(_ray, _triangles, _tMax, t0_, u_, v_, _cullBackFace);
+	#else
+		return Intersect4(_ray, _triangles, _tMax, t0_, u_, v_, _cullBackFace) | (Intersect4(_ray, Offset(_triangles, 4), _tMax, t0_ + 4, u_ + 4, v_ + 4, _cullBackFace) << 4);
+	#endif
+}
+
 
 // Primitive-primitive intersection
 
@@ -162,6 +162,65 @@ struct Capsule
 }; // struct Capsule
 
 
+////////////////////////////////////////////////////////////////////////////////
+// Triangle
+// Front faces have a counter-clockwise winding, i.e. the normal is 
+// Cross(m_vertices[1] - m_vertices[0], m_vertices[2] - m_vertices[0]).
+////////////////////////////////////////////////////////////////////////////////
+struct Triangle
+{
+	vec3 m_vertices[3];
+
+	Triangle() {}
+	Triangle(const vec3& _v0, const vec3& _v1, const vec3& _v2);
+
+	void transform(const mat4& _mat);
+	vec3 getOrigin() const;
+	vec3 getNormal() const; // unit length
+
+}; // struct Triangle
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SphereSoA, AlignedBoxSoA, TriangleSoA
+// Structure-of-arrays primitives for batch tests (see Frustum::inside(),
+// Intersect4()). Arrays don't require any particular alignment.
+////////////////////////////////////////////////////////////////////////////////
+struct SphereSoA
+{
+	const float* m_originX;
+	const float* m_originY;
+	const float* m_originZ;
+	const float* m_radius;
+
+}; // struct SphereSoA
+
+struct AlignedBoxSoA
+{
+	const float* m_minX;
+	const float* m_minY;
+	const float* m_minZ;
+	const float* m_maxX;
+	const float* m_maxY;
+	const float* m_maxZ;
+
+}; // struct AlignedBoxSoA
+
+struct TriangleSoA
+{
+	const float* m_v0X;
+	const float* m_v0Y;
+	const float* m_v0Z;
+	const float* m_v1X;
+	const float* m_v1Y;
+	const float* m_v1Z;
+	const float* m_v2X;
+	const float* m_v2Y;
+	const float* m_v2Z;
+
+}; // struct TriangleSoA
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Frustum
 // 6 planes/8 vertices. The vertex ordering is as follows:
@@ -224,6 +283,15 @@ struct Frustum
 	bool inside(const AlignedBox& _box) const;
 	
 	bool insideIgnoreNear(const Sphere& _sphere) const;
+	bool insideIgnoreNear(const AlignedBox& _box) const;
+
+	// Batch variants, test _count objects. Bit i of visible_ is set if object i is inside (visible_ must contain at least 
+	// (_count + 31) / 32 words). Return the number of visible objects. Results match the per-object tests above.
+	uint32 inside(const SphereSoA& _spheres, uint32 _count, uint32* visible_) const;
+	uint32 inside(const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_) const;
+
+	uint32 insideIgnoreNear(const SphereSoA& _spheres, uint32 _count, uint32* visible_) const;
+	uint32 insideIgnoreNear(const AlignedBoxSoA& _boxes, uint32 _count, uint32* visible_) const;
 
 	void setVertices(const vec3 _vertices[8]);
 
@@ -293,6 +361,29 @@ bool Intersect (const Ray& _ray, const Capsule& _capsule, float& t0_, float& t1_
 bool Intersects(const Ray& _ray, const Cylinder& _cylinder);
 bool Intersect (const Ray& _ray, const Cylinder& _cylinder, float& t0_, float& t1_);
 
+// Ray-triangle intersection.
+// t0_ returns the intersection, barycentrics_ the barycentric coordinates of the intersection relative to m_vertices[1], m_vertices[2]. 
+// If _cullBackFace, triangles facing away from the ray origin are ignored. Ray::m_direction needn't be unit length for these tests (t0_ 
+// is then in units of m_direction).
+// Intersect() uses the Moller-Trumbore algorithm. IntersectWatertight() uses the algorithm from Woop et al. ("Watertight Ray/Triangle 
+// Intersection", JCGT 2013) which is a little slower but guarantees no false misses along shared edges/vertices.
+bool Intersects(const Ray& _ray, const Triangle& _triangle, bool _cullBackFace = false);
+bool Intersect (const Ray& _ray, const Triangle& _triangle, float& t0_, vec2& barycentrics_, bool _cullBackFace = false);
+bool IntersectWatertight(const Ray& _ray, const Triangle& _triangle, float& t0_, vec2& barycentrics_, bool _cullBackFace = false);
+// Closest hit variant of Intersect(), e.g. for BVH leaf callbacks which test triangles in arbitrary order. If the intersection is closer
+// than tMax_, write tMax_ and barycentrics_ and return true. Otherwise the outputs are unmodified.
+bool IntersectClosest(const Ray& _ray, const Triangle& _triangle, float& tMax_, vec2& barycentrics_, bool _cullBackFace = false);
+
+// Batch ray-primitive intersection.
+// Test _ray against primitives [0, 4) (Intersect4) or [0, 8) (Intersect8). Return a bitmask of primitives which intersect the ray 
+// within _tMax (bit i = primitive i). For intersected primitives, t0_[i] returns the first intersection (boxes are clamped to 0 if the
+// ray origin is inside) and u_[i],v_[i] the barycentrics (triangles, see Intersect()). Triangle results match Intersect(). SSE2/AVX2 
+// are used where available.
+uint32 Intersect4(const Ray& _ray, const AlignedBoxSoA& _boxes, float _tMax, float* t0_);
+uint32 Intersect8(const Ray& _ray, const AlignedBoxSoA& _boxes, float _tMax, float* t0_);
+uint32 Intersect4(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace = false);
+uint32 Intersect8(const Ray& _ray, const TriangleSoA& _triangles, float _tMax, float* t0_, float* u_, float* v_, bool _cullBackFace = false);
+
 // Primitive-primitive intersection.
 bool Intersects(const Sphere& _sphere0, const Sphere& _sphere1);
 bool Intersects(const Sphere& _sphere, const Plane& _plane);
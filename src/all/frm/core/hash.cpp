@@ -2,6 +2,10 @@
 
 #include <frm/core/frm.h>
 
+#include <EASTL/algorithm.h>
+
+#include <cstring>
+
 using namespace frm;
 
 constexpr uint32 kFnv1aPrime32 = 0x01000193u;
@@ -82,3 +86,151 @@ uint64 internal::HashString64(const char* _str, uint64 _base)
 	}
 	return ret;
 }
+
+// xxHash64, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+
+constexpr uint64 kXxhPrime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64 kXxhPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64 kXxhPrime64_3 = 0x165667B19E3779F9ull;
+constexpr uint64 kXxhPrime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64 kXxhPrime64_5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64 Rotl64(uint64 _x, int _r)
+{
+	return (_x << _r) | (_x >> (64 - _r));
+}
+
+static inline uint64 Read64(const uint8* _p)
+{
+	uint64 ret;
+	memcpy(&ret, _p, sizeof(ret)); // little endian
+	return ret;
+}
+
+static inline uint32 Read32(const uint8* _p)
+{
+	uint32 ret;
+	memcpy(&ret, _p, sizeof(ret));
+	return ret;
+}
+
+static inline uint64 XxhRound(uint64 _acc, uint64 _input)
+{
+	_acc += _input * kXxhPrime64_2;
+	_acc  = Rotl64(_acc, 31);
+	return _acc * kXxhPrime64_1;
+}
+
+static inline uint64 XxhMergeRound(uint64 _acc, uint64 _val)
+{
+	_acc ^= XxhRound(0, _val);
+	return _acc * kXxhPrime64_1 + kXxhPrime64_4;
+}
+
+// Consume 32 byte stripes from _buf, return ptr to the remaining data.
+static inline const uint8* XxhStripes(uint64 acc_[4], const uint8* _buf, const uint8* _end)
+{
+	uint64 a0 = acc_[0], a1 = acc_[1], a2 = acc_[2], a3 = acc_[3];
+	for (; _buf + 32 <= _end; _buf += 32)
+	{
+		a0 = XxhRound(a0, Read64(_buf +  0));
+		a1 = XxhRound(a1, Read64(_buf +  8));
+		a2 = XxhRound(a2, Read64(_buf + 16));
+		a3 = XxhRound(a3, Read64(_buf + 24));
+	}
+	acc_[0] = a0; acc_[1] = a1; acc_[2] = a2; acc_[3] = a3;
+	return _buf;
+}
+
+uint64 frm::HashContent64(const void* _buf, uint _bufSize, uint64 _seed)
+{
+	ContentHasher64 hasher(_seed);
+	hasher.update(_buf, _bufSize);
+	return hasher.finish();
+}
+
+void ContentHasher64::reset(uint64 _seed)
+{
+	m_acc[0]     = _seed + kXxhPrime64_1 + kXxhPrime64_2;
+	m_acc[1]     = _seed + kXxhPrime64_2;
+	m_acc[2]     = _seed;
+	m_acc[3]     = _seed - kXxhPrime64_1;
+	m_stripeSize = 0;
+	m_totalSize  = 0;
+	m_seed       = _seed;
+}
+
+void ContentHasher64::update(const void* _buf, uint _bufSize)
+{
+	FRM_STRICT_ASSERT(_buf || _bufSize == 0);
+	const uint8* buf = (const uint8*)_buf;
+	const uint8* end = buf + _bufSize;
+	m_totalSize += _bufSize;
+
+	// Complete a partial stripe.
+	if (m_stripeSize > 0)
+	{
+		const uint32 n = (uint32)eastl::min((uint)(32 - m_stripeSize), _bufSize);
+		memcpy(m_stripe + m_stripeSize, buf, n);
+		m_stripeSize += n;
+		buf += n;
+		if (m_stripeSize < 32)
+		{
+			return;
+		}
+		XxhStripes(m_acc, m_stripe, m_stripe + 32);
+		m_stripeSize = 0;
+	}
+
+	buf = XxhStripes(m_acc, buf, end);
+
+	if (buf < end)
+	{
+		m_stripeSize = (uint32)(end - buf);
+		memcpy(m_stripe, buf, m_stripeSize);
+	}
+}
+
+uint64 ContentHasher64::finish() const
+{
+	uint64 ret;
+	if (m_totalSize >= 32)
+	{
+		ret = Rotl64(m_acc[0], 1) + Rotl64(m_acc[1], 7) + Rotl64(m_acc[2], 12) + Rotl64(m_acc[3], 18);
+		ret = XxhMergeRound(ret, m_acc[0]);
+		ret = XxhMergeRound(ret, m_acc[1]);
+		ret = XxhMergeRound(ret, m_acc[2]);
+		ret = XxhMergeRound(ret, m_acc[3]);
+	}
+	else
+	{
+		ret = m_seed + kXxhPrime64_5;
+	}
+	ret += m_totalSize;
+
+	const uint8* p   = m_stripe;
+	const uint8* end = m_stripe + m_stripeSize;
+	for (; p + 8 <= end; p += 8)
+	{
+		ret ^= XxhRound(0, Read64(p));
+		ret  = Rotl64(ret, 27) * kXxhPrime64_1 + kXxhPrime64_4;
+	}
+	if (p + 4 <= end)
+	{
+		ret ^= (uint64)Read32(p) * kXxhPrime64_1;
+		ret  = Rotl64(ret, 23) * kXxhPrime64_2 + kXxhPrime64_3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+	{
+		ret ^= (uint64)*p * kXxhPrime64_5;
+		ret  = Rotl64(ret, 11) * kXxhPrime64_1;
+	}
+
+	ret ^= ret >> 33;
+	ret *= kXxhPrime64_2;
+	ret ^= ret >> 29;
+	ret *= kXxhPrime64_3;
+	ret ^= ret >> 32;
+	return ret;
+}
@@ -52,4 +52,31 @@ tType HashString(const char* _str);
 	template <> inline uint32 HashString<uint32>(const char* _str) { return internal::HashString32(_str); }
 	template <> inline uint64 HashString<uint64>(const char* _str) { return internal::HashString64(_str); }
 
+// Hash _bufSize bytes from _buf (xxHash64 algorithm). Use for large buffers (e.g. file contents), Hash() is faster for short keys.
+uint64 HashContent64(const void* _buf, uint _bufSize, uint64 _seed = 0);
+
+////////////////////////////////////////////////////////////////////////////////
+// ContentHasher64
+// Streaming version of HashContent64(); the result is the same as calling
+// HashContent64() on the concatenated input.
+////////////////////////////////////////////////////////////////////////////////
+class ContentHasher64
+{
+public:
+
+	ContentHasher64(uint64 _seed = 0)        { reset(_seed); }
+
+	void   reset(uint64 _seed = 0);
+	void   update(const void* _buf, uint _bufSize);
+	uint64 finish() const;
+
+private:
+
+	uint64 m_acc[4];
+	uint8  m_stripe[32];   // Partial stripe.
+	uint32 m_stripeSize;
+	uint64 m_totalSize;
+	uint64 m_seed;
+};
+
 } // namespace frm
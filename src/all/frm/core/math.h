@@ -4,6 +4,10 @@
 
 #include <linalg/linalg.h>
 
+#if FRM_COMPILER_MSVC
+	#include <intrin.h>
+#endif
+
 namespace frm {
 	using linalg::identity;
 
@@ -196,6 +200,54 @@ namespace frm {
 	inline tType ModPow2(const tType& _x, const tType& _y)                      { return _x & (_y - 1); }
 	#define FRM_MOD_POW2(_x, _y) frm::ModPow2(_x, _y)
 
+	// Return the number of set bits in _x. Use popcnt if available.
+	inline uint32 CountBits(uint32 _x)
+	{
+		#if FRM_COMPILER_MSVC && FRM_SIMD_AVX2
+			return (uint32)__popcnt(_x);
+		#elif FRM_COMPILER_GNU
+			return (uint32)__builtin_popcount(_x);
+		#else
+			_x = _x - ((_x >> 1) & 0x55555555u);
+			_x = (_x & 0x33333333u) + ((_x >> 2) & 0x33333333u);
+			return (((_x + (_x >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+		#endif
+	}
+	inline uint32 CountBits(uint64 _x)
+	{
+		#if FRM_COMPILER_MSVC && FRM_SIMD_AVX2
+			return (uint32)__popcnt64(_x);
+		#elif FRM_COMPILER_GNU
+			return (uint32)__builtin_popcountll(_x);
+		#else
+			return CountBits((uint32)_x) + CountBits((uint32)(_x >> 32));
+		#endif
+	}
+
+	// Return the index of the least significant set bit in _x. _x must be nonzero.
+	inline uint32 FindFirstSet(uint32 _x)
+	{
+		FRM_STRICT_ASSERT(_x != 0);
+		#if FRM_COMPILER_MSVC
+			unsigned long ret;
+			_BitScanForward(&ret, _x);
+			return (uint32)ret;
+		#else
+			return (uint32)__builtin_ctz(_x);
+		#endif
+	}
+	inline uint32 FindFirstSet(uint64 _x)
+	{
+		FRM_STRICT_ASSERT(_x != 0);
+		#if FRM_COMPILER_MSVC
+			unsigned long ret;
+			_BitScanForward64(&ret, _x);
+			return (uint32)ret;
+		#else
+			return (uint32)__builtin_ctzll(_x);
+		#endif
+	}
+
 	namespace internal {
 		template <typename tType>
 		inline tType Fract(const tType& _x, FloatT)                             { return _x - std::floor(_x); }
@@ -1,7 +1,80 @@
 #include "memory.h"
 
+#include <cstdint>
 #include <cstdlib>
 
+#if FRM_COMPILER_MSVC
+	#define AlignedMalloc(_size, _align)                _aligned_malloc(_size, _align)
+	#define AlignedOffsetMalloc(_size, _align, _offset) _aligned_offset_malloc(_size, _align, _offset)
+	#define AlignedRealloc(_ptr, _size, _align)         _aligned_realloc(_ptr, _size, _align)
+	#define AlignedFree(_ptr)                           _aligned_free(_ptr)
+#else
+	namespace {
+
+	// Equivalent to the MSVC _aligned_* functions. The header is stored immediately before the returned pointer (unaligned, hence
+	// the memcpy).
+	struct AlignedHeader
+	{
+		void*  raw;  // Pointer returned by malloc().
+		size_t size; // Requested size, for AlignedRealloc().
+	};
+
+	// Return a pointer p such that (p + _offset) is a multiple of _align.
+	void* AlignedOffsetMalloc(size_t _size, size_t _align, size_t _offset)
+	{
+		FRM_ASSERT(_align > 0 && (_align & (_align - 1)) == 0); // must be a power of 2
+		void* raw = malloc(sizeof(AlignedHeader) + _align - 1 + _size);
+		if (!raw)
+		{
+			return nullptr;
+		}
+		uintptr_t ret = (uintptr_t)raw + sizeof(AlignedHeader) + _offset;
+		ret = ((ret + _align - 1) & ~(uintptr_t)(_align - 1)) - _offset;
+		const AlignedHeader header = { raw, _size };
+		memcpy((char*)ret - sizeof(AlignedHeader), &header, sizeof(AlignedHeader));
+		return (void*)ret;
+	}
+
+	void* AlignedMalloc(size_t _size, size_t _align)
+	{
+		return AlignedOffsetMalloc(_size, _align, 0);
+	}
+
+	AlignedHeader GetAlignedHeader(void* _ptr)
+	{
+		AlignedHeader ret;
+		memcpy(&ret, (char*)_ptr - sizeof(AlignedHeader), sizeof(AlignedHeader));
+		return ret;
+	}
+
+	void AlignedFree(void* _ptr)
+	{
+		if (_ptr)
+		{
+			free(GetAlignedHeader(_ptr).raw);
+		}
+	}
+
+	void* AlignedRealloc(void* _ptr, size_t _size, size_t _align)
+	{
+		if (_size == 0)
+		{
+			AlignedFree(_ptr);
+			return nullptr;
+		}
+		void* ret = AlignedMalloc(_size, _align);
+		if (ret && _ptr)
+		{
+			const size_t size = GetAlignedHeader(_ptr).size;
+			memcpy(ret, _ptr, size < _size ? size : _size);
+			AlignedFree(_ptr);
+		}
+		return ret;
+	}
+
+	} // namespace
+#endif
+
 // \todo
 // EASTL's allocator can allocate aligned memory via the operator new[] overloads (bottom of this file), however it uniformly deallocates via delete[].
 // Effectively this means that we must make *all* operator new/delete aligned, hence the code below.
@@ -9,19 +82,29 @@
 #if 1
 	void* operator new(size_t _size)
 	{ 
-		return _aligned_malloc(_size, 1);
+		return AlignedMalloc(_size, 1);
 	}
-	void  operator delete(void* _ptr)
+	void  operator delete(void* _ptr) noexcept
 	{ 
-		_aligned_free(_ptr);
+		AlignedFree(_ptr);
 	}
 	void* operator new[](size_t _size)
 	{ 
-		return _aligned_malloc(_size, 1);
+		return AlignedMalloc(_size, 1);
 	}
-	void  operator delete[](void* _ptr)
+	void  operator delete[](void* _ptr) noexcept
 	{
-		_aligned_free(_ptr);
+		AlignedFree(_ptr);
+	}
+
+	// C++14 sized deallocation, the default implementation isn't guaranteed to call the unsized versions above.
+	void  operator delete(void* _ptr, size_t) noexcept
+	{ 
+		AlignedFree(_ptr);
+	}
+	void  operator delete[](void* _ptr, size_t) noexcept
+	{
+		AlignedFree(_ptr);
 	}
 #endif
 
@@ -42,33 +125,17 @@ void frm::internal::free(void* _ptr)
 
 void* frm::internal::malloc_aligned(size_t _size, size_t _align) 
 {
-#if 1//#ifdef FRM_COMPILER_MSVC
-	return _aligned_malloc(_size, _align);
-#else
-	aligned_alloc(_align, _size);
-#endif
+	return AlignedMalloc(_size, _align);
 }
 
 void* frm::internal::realloc_aligned(void* _ptr, size_t _size, size_t _align)
 {
-#if 1//#ifdef FRM_COMPILER_MSVC
-	return _aligned_realloc(_ptr, _size, _align);
-#else
-	if (_ptr) {
-		return realloc(_ptr, _size);
-	} else {
-		return malloc_aligned(_size, _align);
-	}
-#endif
+	return AlignedRealloc(_ptr, _size, _align);
 }
 
 void frm::internal::free_aligned(void* _ptr) 
 {
-#if 1//#ifdef FRM_COMPILER_MSVC
-	_aligned_free(_ptr);
-#else
-	free(_ptr);
-#endif
+	AlignedFree(_ptr);
 }
 
 // EASTL new[] overloads
@@ -85,16 +152,10 @@ void frm::internal::free_aligned(void* _ptr)
 
 void* operator new[](size_t size, const char* /*name*/, int /*flags*/, unsigned /*debugFlags*/, const char* /*file*/, int /*line*/) THROW_SPEC_1(std::bad_alloc)
 {
-	return _aligned_malloc(size, 1);
+	return AlignedMalloc(size, 1);
 }
 
 void* operator new[](size_t size, size_t alignment, size_t alignmentOffset, const char* /*name*/, int flags, unsigned /*debugFlags*/, const char* /*file*/, int /*line*/) THROW_SPEC_1(std::bad_alloc)
 {
-#if 1//#ifdef FRM_COMPILER_MSVC
-	return _aligned_offset_malloc(size, alignment, alignmentOffset);
-#else
- // \todo no standard 'offset' version, implement via aligned_alloc
-	FRM_ASSERT(false);
-	return nullptr;
-#endif
+	return AlignedOffsetMalloc(size, alignment, alignmentOffset);
 }
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <frm/core/frm.h>
+
+#if FRM_SIMD_BMI2
+	#include <immintrin.h>
+#endif
+
+namespace frm {
+
+////////////////////////////////////////////////////////////////////////////////
+// Morton (Z-order) codes.
+// Bit interleaving uses pdep/pext if FRM_SIMD_BMI2, else 'magic bits' shifts
+// (https://graphics.stanford.edu/~seander/bithacks.html#InterleaveBMN).
+//
+// MortonEncode2(_a, _b): bits of _a occupy the even bits of the code, _b the
+// odd bits. MortonEncode3(_a, _b, _c): bits of _a occupy bits 3n, _b 3n+1, _c
+// 3n+2. Input bits which don't fit in the code are discarded (16/10 bits per
+// coordinate for uint32, 32/21 bits per coordinate for uint64).
+//
+// \todo
+// - pdep/pext are microcoded (slow) on AMD prior to Zen 3, may want to select
+//   the magic bits path at runtime.
+////////////////////////////////////////////////////////////////////////////////
+
+// Spread the low 16 (32) bits of _x to the even bits of the result.
+inline uint32 MortonSpread2(uint32 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pdep_u32(_x, 0x55555555u);
+	#else
+		_x &= 0x0000ffffu;
+		_x = (_x | (_x << 8)) & 0x00ff00ffu;
+		_x = (_x | (_x << 4)) & 0x0f0f0f0fu;
+		_x = (_x | (_x << 2)) & 0x33333333u;
+		_x = (_x | (_x << 1)) & 0x55555555u;
+		return _x;
+	#endif
+}
+inline uint64 MortonSpread2(uint64 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pdep_u64(_x, 0x5555555555555555ull);
+	#else
+		_x &= 0x00000000ffffffffull;
+		_x = (_x | (_x << 16)) & 0x0000ffff0000ffffull;
+		_x = (_x | (_x << 8))  & 0x00ff00ff00ff00ffull;
+		_x = (_x | (_x << 4))  & 0x0f0f0f0f0f0f0f0full;
+		_x = (_x | (_x << 2))  & 0x3333333333333333ull;
+		_x = (_x | (_x << 1))  & 0x5555555555555555ull;
+		return _x;
+	#endif
+}
+
+// Inverse of MortonSpread2(), gather the even bits of _x.
+inline uint32 MortonCompact2(uint32 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pext_u32(_x, 0x55555555u);
+	#else
+		_x &= 0x55555555u;
+		_x = (_x ^ (_x >> 1)) & 0x33333333u;
+		_x = (_x ^ (_x >> 2)) & 0x0f0f0f0fu;
+		_x = (_x ^ (_x >> 4)) & 0x00ff00ffu;
+		_x = (_x ^ (_x >> 8)) & 0x0000ffffu;
+		return _x;
+	#endif
+}
+inline uint64 MortonCompact2(uint64 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pext_u64(_x, 0x5555555555555555ull);
+	#else
+		_x &= 0x5555555555555555ull;
+		_x = (_x ^ (_x >> 1))  & 0x3333333333333333ull;
+		_x = (_x ^ (_x >> 2))  & 0x0f0f0f0f0f0f0f0full;
+		_x = (_x ^ (_x >> 4))  & 0x00ff00ff00ff00ffull;
+		_x = (_x ^ (_x >> 8))  & 0x0000ffff0000ffffull;
+		_x = (_x ^ (_x >> 16)) & 0x00000000ffffffffull;
+		return _x;
+	#endif
+}
+
+// Spread the low 10 (21) bits of _x to every 3rd bit of the result.
+inline uint32 MortonSpread3(uint32 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pdep_u32(_x, 0x09249249u);
+	#else
+		_x &= 0x000003ffu;
+		_x = (_x | (_x << 16)) & 0x030000ffu;
+		_x = (_x | (_x << 8))  & 0x0300f00fu;
+		_x = (_x | (_x << 4))  & 0x030c30c3u;
+		_x = (_x | (_x << 2))  & 0x09249249u;
+		return _x;
+	#endif
+}
+inline uint64 MortonSpread3(uint64 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pdep_u64(_x, 0x1249249249249249ull);
+	#else
+		_x &= 0x00000000001fffffull;
+		_x = (_x | (_x << 32)) & 0x001f00000000ffffull;
+		_x = (_x | (_x << 16)) & 0x001f0000ff0000ffull;
+		_x = (_x | (_x << 8))  & 0x100f00f00f00f00full;
+		_x = (_x | (_x << 4))  & 0x10c30c30c30c30c3ull;
+		_x = (_x | (_x << 2))  & 0x1249249249249249ull;
+		return _x;
+	#endif
+}
+
+// Inverse of MortonSpread3(), gather every 3rd bit of _x.
+inline uint32 MortonCompact3(uint32 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pext_u32(_x, 0x09249249u);
+	#else
+		_x &= 0x09249249u;
+		_x = (_x ^ (_x >> 2))  & 0x030c30c3u;
+		_x = (_x ^ (_x >> 4))  & 0x0300f00fu;
+		_x = (_x ^ (_x >> 8))  & 0xff0000ffu;
+		_x = (_x ^ (_x >> 16)) & 0x000003ffu;
+		return _x;
+	#endif
+}
+inline uint64 MortonCompact3(uint64 _x)
+{
+	#if FRM_SIMD_BMI2
+		return _pext_u64(_x, 0x1249249249249249ull);
+	#else
+		_x &= 0x1249249249249249ull;
+		_x = (_x ^ (_x >> 2))  & 0x10c30c30c30c30c3ull;
+		_x = (_x ^ (_x >> 4))  & 0x100f00f00f00f00full;
+		_x = (_x ^ (_x >> 8))  & 0x001f0000ff0000ffull;
+		_x = (_x ^ (_x >> 16)) & 0x001f00000000ffffull;
+		_x = (_x ^ (_x >> 32)) & 0x00000000001fffffull;
+		return _x;
+	#endif
+}
+
+// tType = uint32, uint64
+template <typename tType>
+inline tType MortonEncode2(tType _a, tType _b)
+{
+	return MortonSpread2(_a) | (MortonSpread2(_b) << 1);
+}
+template <typename tType>
+inline void MortonDecode2(tType _code, tType& a_, tType& b_)
+{
+	a_ = MortonCompact2(_code);
+	b_ = MortonCompact2(_code >> 1);
+}
+
+// tType = uint32, uint64
+template <typename tType>
+inline tType MortonEncode3(tType _a, tType _b, tType _c)
+{
+	return MortonSpread3(_a) | (MortonSpread3(_b) << 1) | (MortonSpread3(_c) << 2);
+}
+template <typename tType>
+inline void MortonDecode3(tType _code, tType& a_, tType& b_, tType& c_)
+{
+	a_ = MortonCompact3(_code);
+	b_ = MortonCompact3(_code >> 1);
+	c_ = MortonCompact3(_code >> 2);
+}
+
+} // namespace frm
@@ -2,13 +2,19 @@
 
 #include <frm/core/frm.h>
 
-#if !(FRM_PLATFORM_WIN)
-	#error frm: FRM_PLATFORM_WIN was not defined, probably the build system was configured incorrectly
+#if !(FRM_PLATFORM_WIN || FRM_PLATFORM_LINUX)
+	#error frm: FRM_PLATFORM_WIN or FRM_PLATFORM_LINUX was not defined, probably the build system was configured incorrectly
 #endif
 
 // ASSERT/VERIFY with platform-specific error string (use to wrap OS calls).
-#define FRM_PLATFORM_ASSERT(_err) FRM_ASSERT_MSG(_err, frm::GetPlatformErrorString((uint64)::GetLastError()))
-#define FRM_PLATFORM_VERIFY(_err) FRM_VERIFY_MSG(_err, frm::GetPlatformErrorString((uint64)::GetLastError()))
+#if FRM_PLATFORM_WIN
+	#define FRM_PLATFORM_ASSERT(_err) FRM_ASSERT_MSG(_err, frm::GetPlatformErrorString((uint64)::GetLastError()))
+	#define FRM_PLATFORM_VERIFY(_err) FRM_VERIFY_MSG(_err, frm::GetPlatformErrorString((uint64)::GetLastError()))
+#else
+	#include <cerrno>
+	#define FRM_PLATFORM_ASSERT(_err) FRM_ASSERT_MSG(_err, frm::GetPlatformErrorString((uint64)errno))
+	#define FRM_PLATFORM_VERIFY(_err) FRM_VERIFY_MSG(_err, frm::GetPlatformErrorString((uint64)errno))
+#endif
 
 namespace frm {
 
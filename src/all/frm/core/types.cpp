@@ -3,6 +3,12 @@
 #include <cstring>
 #include <limits>
 
+#if FRM_SIMD_AVX2 || FRM_SIMD_F16C
+	#include <immintrin.h>
+#elif FRM_SIMD_SSE2
+	#include <emmintrin.h>
+#endif
+
 namespace frm { namespace internal {
 
 const sint8   DataType_Limits<sint8  >::kMin = std::numeric_limits<sint8  >::min();
@@ -100,52 +106,477 @@ const char* kDataTypeStr[DataType_Count] =
 	"Float64",
 };
 
+namespace {
+
+// Bulk conversion kernels. Conversions to/from float types go via float32 (which can exactly represent all of the types below), 
+// hence any ToFloat32/FromFloat32 pair can be combined. The SIMD paths match the scalar DataTypeConvert<tDst, tSrc>() exactly,
+// the remainder is converted by the scalar path.
+
+template <typename tType>
+struct DataType_Raw { typedef tType Type; };
+template <typename tBase, DataType kEnum>
+struct DataType_Raw<internal::DataTypeBase<tBase, kEnum> > { typedef tBase Type; };
+
+#if FRM_SIMD_SSE2
+	// Load 4 values as sint32.
+	inline __m128i Load4(const sint8* _src)
+	{
+		sint32 v; memcpy(&v, _src, sizeof(v));
+		__m128i ret = _mm_cvtsi32_si128(v);
+		ret = _mm_unpacklo_epi8(ret, ret);
+		ret = _mm_unpacklo_epi16(ret, ret);
+		return _mm_srai_epi32(ret, 24);
+	}
+	inline __m128i Load4(const uint8* _src)
+	{
+		sint32 v; memcpy(&v, _src, sizeof(v));
+		const __m128i ret = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), _mm_setzero_si128());
+		return _mm_unpacklo_epi16(ret, _mm_setzero_si128());
+	}
+	inline __m128i Load4(const sint16* _src)
+	{
+		const __m128i ret = _mm_loadl_epi64((const __m128i*)_src);
+		return _mm_srai_epi32(_mm_unpacklo_epi16(ret, ret), 16);
+	}
+	inline __m128i Load4(const uint16* _src)
+	{
+		return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)_src), _mm_setzero_si128());
+	}
+	inline __m128i Load4(const sint32* _src)
+	{
+		return _mm_loadu_si128((const __m128i*)_src);
+	}
+
+	// Store 4 sint32 values, which must be in range for the destination type.
+	inline void Store4(sint8* dst_, __m128i _v)
+	{
+		_v = _mm_packs_epi32(_v, _v);
+		const sint32 v = _mm_cvtsi128_si32(_mm_packs_epi16(_v, _v));
+		memcpy(dst_, &v, sizeof(v));
+	}
+	inline void Store4(uint8* dst_, __m128i _v)
+	{
+		_v = _mm_packs_epi32(_v, _v);
+		const sint32 v = _mm_cvtsi128_si32(_mm_packus_epi16(_v, _v));
+		memcpy(dst_, &v, sizeof(v));
+	}
+	inline void Store4(sint16* dst_, __m128i _v)
+	{
+		_mm_storel_epi64((__m128i*)dst_, _mm_packs_epi32(_v, _v));
+	}
+	inline void Store4(uint16* dst_, __m128i _v)
+	{
+	 // SSE2 has no unsigned saturating pack, bias to the signed range and back
+		_v = _mm_packs_epi32(_mm_sub_epi32(_v, _mm_set1_epi32(0x8000)), _mm_setzero_si128());
+		_mm_storel_epi64((__m128i*)dst_, _mm_xor_si128(_v, _mm_set1_epi16((short)0x8000)));
+	}
+	inline void Store4(sint32* dst_, __m128i _v)
+	{
+		_mm_storeu_si128((__m128i*)dst_, _v);
+	}
+#endif
+
+#if FRM_SIMD_AVX2
+	// Load 8 values as sint32.
+	inline __m256i Load8(const sint8* _src)  { return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)_src)); }
+	inline __m256i Load8(const uint8* _src)  { return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)_src)); }
+	inline __m256i Load8(const sint16* _src) { return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)_src)); }
+	inline __m256i Load8(const uint16* _src) { return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)_src)); }
+	inline __m256i Load8(const sint32* _src) { return _mm256_loadu_si256((const __m256i*)_src); }
+
+	// Store 8 sint32 values, which must be in range for the destination type.
+	template <typename tRaw>
+	inline void Store8(tRaw* dst_, __m256i _v)
+	{
+		Store4(dst_,     _mm256_castsi256_si128(_v));
+		Store4(dst_ + 4, _mm256_extracti128_si256(_v, 1));
+	}
+#endif
+
+template <typename tType>
+void ToFloat32(const void* _src, float32* dst_, uint _count)
+{
+	typedef typename DataType_Raw<tType>::Type tRaw;
+	const bool  isNormalized = DataTypeIsNormalized(FRM_DATA_TYPE_TO_ENUM(tType));
+	const bool  isSigned     = DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tType));
+	const float scalePos     = (float)std::numeric_limits<tRaw>::max();
+	const float scaleNeg     = -(float)std::numeric_limits<tRaw>::min(); // signed normalized types divide negative values by |min|
+	const tRaw* src          = (const tRaw*)_src;
+	uint i = 0;
+
+	#if FRM_SIMD_AVX2
+	{
+		const __m256 pos = _mm256_set1_ps(scalePos);
+		const __m256 neg = _mm256_set1_ps(scaleNeg);
+		for (; i + 8 <= _count; i += 8) {
+			__m256 f = _mm256_cvtepi32_ps(Load8(src + i));
+			if (isNormalized) {
+				f = _mm256_div_ps(f, isSigned ? _mm256_blendv_ps(pos, neg, f) : pos);
+			}
+			_mm256_storeu_ps(dst_ + i, f);
+		}
+	}
+	#endif
+	#if FRM_SIMD_SSE2
+	{
+		const __m128 pos = _mm_set1_ps(scalePos);
+		const __m128 neg = _mm_set1_ps(scaleNeg);
+		for (; i + 4 <= _count; i += 4) {
+			__m128 f = _mm_cvtepi32_ps(Load4(src + i));
+			if (isNormalized) {
+				const __m128 mask = _mm_cmplt_ps(f, _mm_setzero_ps());
+				f = _mm_div_ps(f, isSigned ? _mm_or_ps(_mm_and_ps(mask, neg), _mm_andnot_ps(mask, pos)) : pos);
+			}
+			_mm_storeu_ps(dst_ + i, f);
+		}
+	}
+	#endif
+
+	for (; i < _count; ++i) {
+		dst_[i] = DataTypeConvert<float32, tType>(*((const tType*)(src + i)));
+	}
+}
+
+template <typename tType>
+void FromFloat32(const float32* _src, void* dst_, uint _count)
+{
+	typedef typename DataType_Raw<tType>::Type tRaw;
+	const bool  isNormalized = DataTypeIsNormalized(FRM_DATA_TYPE_TO_ENUM(tType));
+	const bool  isSigned     = DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tType));
+	const bool  isClamped    = isNormalized || sizeof(tRaw) < sizeof(sint32); // out of range values saturate (sint32 isn't representable as float32)
+	const float minValue     = isNormalized ? (isSigned ? -1.0f : 0.0f) : (float)std::numeric_limits<tRaw>::min();
+	const float maxValue     = isNormalized ? 1.0f : (float)std::numeric_limits<tRaw>::max();
+	const float scalePos     = isNormalized ? (float)std::numeric_limits<tRaw>::max() : 1.0f;
+	const float scaleNeg     = isNormalized && isSigned ? -(float)std::numeric_limits<tRaw>::min() : scalePos;
+	tRaw*       dst          = (tRaw*)dst_;
+	uint i = 0;
+
+	#if FRM_SIMD_AVX2
+	{
+		const __m256 mn  = _mm256_set1_ps(minValue);
+		const __m256 mx  = _mm256_set1_ps(maxValue);
+		const __m256 pos = _mm256_set1_ps(scalePos);
+		const __m256 neg = _mm256_set1_ps(scaleNeg);
+		for (; i + 8 <= _count; i += 8) {
+			__m256 f = _mm256_loadu_ps(_src + i);
+			if (isClamped) {
+				f = _mm256_min_ps(_mm256_max_ps(f, mn), mx);
+			}
+			if (isNormalized) {
+				f = _mm256_mul_ps(f, isSigned ? _mm256_blendv_ps(pos, neg, _mm256_cmp_ps(f, _mm256_setzero_ps(), _CMP_LT_OQ)) : pos);
+			}
+			Store8(dst + i, _mm256_cvttps_epi32(f));
+		}
+	}
+	#endif
+	#if FRM_SIMD_SSE2
+	{
+		const __m128 mn  = _mm_set1_ps(minValue);
+		const __m128 mx  = _mm_set1_ps(maxValue);
+		const __m128 pos = _mm_set1_ps(scalePos);
+		const __m128 neg = _mm_set1_ps(scaleNeg);
+		for (; i + 4 <= _count; i += 4) {
+			__m128 f = _mm_loadu_ps(_src + i);
+			if (isClamped) {
+				f = _mm_min_ps(_mm_max_ps(f, mn), mx);
+			}
+			if (isNormalized) {
+				const __m128 mask = _mm_cmplt_ps(f, _mm_setzero_ps());
+				f = _mm_mul_ps(f, isSigned ? _mm_or_ps(_mm_and_ps(mask, neg), _mm_andnot_ps(mask, pos)) : pos);
+			}
+			Store4(dst + i, _mm_cvttps_epi32(f));
+		}
+	}
+	#endif
+
+	for (; i < _count; ++i) {
+		float32 f = _src[i];
+		if (isClamped) { // same as the SIMD min/max, NaN -> minValue
+			f = f > minValue ? f : minValue;
+			f = f < maxValue ? f : maxValue;
+		}
+		*((tType*)(dst + i)) = DataTypeConvert<tType, float32>(f);
+	}
+}
+
+void Float16ToFloat32(const void* _src, float32* dst_, uint _count)
+{
+	const uint16* src = (const uint16*)_src;
+	uint i = 0;
+	#if FRM_SIMD_F16C
+		for (; i + 8 <= _count; i += 8) {
+			_mm256_storeu_ps(dst_ + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+		}
+	#endif
+	for (; i < _count; ++i) {
+		dst_[i] = UnpackFloat16(src[i]);
+	}
+}
+
+void Float16FromFloat32(const float32* _src, void* dst_, uint _count)
+{
+	uint16* dst = (uint16*)dst_;
+	uint i = 0;
+	#if FRM_SIMD_F16C
+		for (; i + 8 <= _count; i += 8) {
+			_mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(_src + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+	#endif
+	for (; i < _count; ++i) {
+		dst[i] = PackFloat16(_src[i]);
+	}
+}
+
+void Float32ToFloat32(const void* _src, float32* dst_, uint _count)
+{
+	memcpy(dst_, _src, sizeof(float32) * _count);
+}
+
+void Float32FromFloat32(const float32* _src, void* dst_, uint _count)
+{
+	memcpy(dst_, _src, sizeof(float32) * _count);
+}
+
+typedef void (ToFloat32Func)(const void* _src, float32* dst_, uint _count);
+typedef void (FromFloat32Func)(const float32* _src, void* dst_, uint _count);
+
+ToFloat32Func* GetToFloat32(DataType _type)
+{
+	switch (_type) {
+		case DataType_Sint8:   return &ToFloat32<sint8>;
+		case DataType_Uint8:   return &ToFloat32<uint8>;
+		case DataType_Sint16:  return &ToFloat32<sint16>;
+		case DataType_Uint16:  return &ToFloat32<uint16>;
+		case DataType_Sint32:  return &ToFloat32<sint32>;
+		case DataType_Sint8N:  return &ToFloat32<sint8N>;
+		case DataType_Uint8N:  return &ToFloat32<uint8N>;
+		case DataType_Sint16N: return &ToFloat32<sint16N>;
+		case DataType_Uint16N: return &ToFloat32<uint16N>;
+		case DataType_Float16: return &Float16ToFloat32;
+		case DataType_Float32: return &Float32ToFloat32;
+		default:               return nullptr;
+	};
+}
+
+FromFloat32Func* GetFromFloat32(DataType _type)
+{
+	switch (_type) {
+		case DataType_Sint8:   return &FromFloat32<sint8>;
+		case DataType_Uint8:   return &FromFloat32<uint8>;
+		case DataType_Sint16:  return &FromFloat32<sint16>;
+		case DataType_Uint16:  return &FromFloat32<uint16>;
+		case DataType_Sint32:  return &FromFloat32<sint32>;
+		case DataType_Sint8N:  return &FromFloat32<sint8N>;
+		case DataType_Uint8N:  return &FromFloat32<uint8N>;
+		case DataType_Sint16N: return &FromFloat32<sint16N>;
+		case DataType_Uint16N: return &FromFloat32<uint16N>;
+		case DataType_Float16: return &Float16FromFloat32;
+		case DataType_Float32: return &Float32FromFloat32;
+		default:               return nullptr;
+	};
+}
+
+// x * 257 (replicate the byte).
+void Uint8NToUint16N(const void* _src, void* dst_, uint _count)
+{
+	const uint8* src = (const uint8*)_src;
+	uint16* dst = (uint16*)dst_;
+	uint i = 0;
+	#if FRM_SIMD_AVX2
+		for (; i + 32 <= _count; i += 32) {
+			const __m256i v = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(src + i)), 0xd8); // unpack is per 128 bit lane
+			_mm256_storeu_si256((__m256i*)(dst + i),      _mm256_unpacklo_epi8(v, v));
+			_mm256_storeu_si256((__m256i*)(dst + i + 16), _mm256_unpackhi_epi8(v, v));
+		}
+	#endif
+	#if FRM_SIMD_SSE2
+		for (; i + 16 <= _count; i += 16) {
+			const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+			_mm_storeu_si128((__m128i*)(dst + i),     _mm_unpacklo_epi8(v, v));
+			_mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(v, v));
+		}
+	#endif
+	for (; i < _count; ++i) {
+		dst[i] = (uint16)(src[i] * 257);
+	}
+}
+
+// x / 257 (truncated), computed as (x * 0xff01) >> 24 which is exact for all 16 bit values.
+void Uint16NToUint8N(const void* _src, void* dst_, uint _count)
+{
+	const uint16* src = (const uint16*)_src;
+	uint8* dst = (uint8*)dst_;
+	uint i = 0;
+	#if FRM_SIMD_AVX2
+		for (; i + 32 <= _count; i += 32) {
+			const __m256i m = _mm256_set1_epi16((short)0xff01);
+			const __m256i a = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_loadu_si256((const __m256i*)(src + i)),      m), 8);
+			const __m256i b = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_loadu_si256((const __m256i*)(src + i + 16)), m), 8);
+			_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8));
+		}
+	#endif
+	#if FRM_SIMD_SSE2
+		for (; i + 16 <= _count; i += 16) {
+			const __m128i m = _mm_set1_epi16((short)0xff01);
+			const __m128i a = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(src + i)),     m), 8);
+			const __m128i b = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(src + i + 8)), m), 8);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+		}
+	#endif
+	for (; i < _count; ++i) {
+		dst[i] = (uint8)(src[i] / 257);
+	}
+}
+
+// Size of the intermediate buffers (elements).
+constexpr uint kBlockSize = 1024;
+
+bool ConvertBulk(DataType _srcType, DataType _dstType, const void* _src, void* dst_, uint _count)
+{
+	if (_srcType == DataType_Uint8N && _dstType == DataType_Uint16N) {
+		Uint8NToUint16N(_src, dst_, _count);
+		return true;
+	}
+	if (_srcType == DataType_Uint16N && _dstType == DataType_Uint8N) {
+		Uint16NToUint8N(_src, dst_, _count);
+		return true;
+	}
+
+ // int -> int conversions don't go via float
+	if (!DataTypeIsFloat(_srcType) && !DataTypeIsFloat(_dstType)) {
+		return false;
+	}
+	ToFloat32Func*   toFloat32   = GetToFloat32(_srcType);
+	FromFloat32Func* fromFloat32 = GetFromFloat32(_dstType);
+	if (!toFloat32 || !fromFloat32) {
+		return false;
+	}
+
+	if (_srcType == DataType_Float32) {
+		fromFloat32((const float32*)_src, dst_, _count);
+	} else if (_dstType == DataType_Float32) {
+		toFloat32(_src, (float32*)dst_, _count);
+	} else {
+		const uint srcSize = DataTypeSizeBytes(_srcType);
+		const uint dstSize = DataTypeSizeBytes(_dstType);
+		float32 tmp[kBlockSize];
+		for (uint i = 0; i < _count; i += kBlockSize) {
+			const uint n = std::min(kBlockSize, _count - i);
+			toFloat32((const char*)_src + i * srcSize, tmp, n);
+			fromFloat32(tmp, (char*)dst_ + i * dstSize, n);
+		}
+	}
+	return true;
+}
+
+template <typename tDst, typename tSrc>
+void ConvertScalar(const void* _src, void* dst_, uint _count)
+{
+	const tSrc* src = (const tSrc*)_src;
+	tDst* dst = (tDst*)dst_;
+	for (uint i = 0; i < _count; ++i) {
+		dst[i] = DataTypeConvert<tDst, tSrc>(src[i]);
+	}
+}
+
+template <typename tElement>
+void Swizzle(const tElement* _src, int _srcComponents, tElement* dst_, int _dstComponents, const int* _swizzle, tElement _one, uint _count)
+{
+	for (uint i = 0; i < _count; ++i, _src += _srcComponents, dst_ += _dstComponents) {
+		for (int j = 0; j < _dstComponents; ++j) {
+			const int k = _swizzle[j];
+			dst_[j] = k >= 0 ? _src[k] : (k == DataTypeSwizzle_One ? _one : (tElement)0);
+		}
+	}
+}
+
+} // namespace
+
 void DataTypeConvert(DataType _srcType, DataType _dstType, const void* _src, void* dst_, uint _count)
 {
 	if (_srcType == _dstType) {
 		memcpy(dst_, _src, DataTypeSizeBytes(_srcType) * _count);
+		return;
+	}
+	if (ConvertBulk(_srcType, _dstType, _src, dst_, _count)) {
+		return;
+	}
 
-	} else {
-	 // \hack need special cases for the Float32 <-> Float16 conversions as DataTypeConvert cannot handle them
-		#define DataType_case_decl(_srcType, _srcEnum) \
-			case _srcEnum: \
-				switch (_dstType) { \
-					case DataType_Sint8:   *((sint8*  )dst_) = DataTypeConvert<sint8,   _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint8:   *((uint8*  )dst_) = DataTypeConvert<uint8,   _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint16:  *((sint16* )dst_) = DataTypeConvert<sint16,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint16:  *((uint16* )dst_) = DataTypeConvert<uint16,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint32:  *((sint32* )dst_) = DataTypeConvert<sint32,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint32:  *((uint32* )dst_) = DataTypeConvert<uint32,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint64:  *((sint64* )dst_) = DataTypeConvert<sint64,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint64:  *((uint64* )dst_) = DataTypeConvert<uint64,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint8N:  *((sint8N* )dst_) = DataTypeConvert<sint8N,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint8N:  *((uint8N* )dst_) = DataTypeConvert<uint8N,  _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint16N: *((sint16N*)dst_) = DataTypeConvert<sint16N, _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint16N: *((uint16N*)dst_) = DataTypeConvert<uint16N, _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint32N: *((sint32N*)dst_) = DataTypeConvert<sint32N, _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint32N: *((uint32N*)dst_) = DataTypeConvert<uint32N, _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Sint64N: *((sint64N*)dst_) = DataTypeConvert<sint64N, _srcType>(*((const _srcType*)_src)); break; \
-					case DataType_Uint64N: *((uint64N*)dst_) = DataTypeConvert<uint64N, _srcType>(*((const _srcType*)_src)); break; \
-				case DataType_Float16: \
-					*((float16*)dst_) = internal::DataType_FloatToFloat<float16, float32>(DataTypeConvert<float32, _srcType>(*((const _srcType*)_src))); break; \
-				case DataType_Float32: \
-					if (_srcEnum == DataType_Float16) { \
-						*((float32*)dst_) = internal::DataType_FloatToFloat<float32, float16>(*((const _srcType*)_src)); break; \
-					} else { \
-						*((float32*)dst_) = DataTypeConvert<float32, _srcType>(*((const _srcType*)_src)); \
-					} break; \
-					case DataType_Float64: *((float64*)dst_) = DataTypeConvert<float64, _srcType>(*((const _srcType*)_src)); break; \
-				}; \
-				break;			
-
-		for (uint i = 0; i < _count; ++i) {
-			switch (_srcType) {
-				FRM_DataType_decl(DataType_case_decl)
-				default: FRM_ASSERT(false); break;
-			};
-			_src = (const char*)_src + DataTypeSizeBytes(_srcType);
-			dst_ = (char*)dst_ + DataTypeSizeBytes(_dstType);
+	#define DataType_case_decl(_srcType, _srcEnum) \
+		case _srcEnum: \
+			switch (_dstType) { \
+				case DataType_Sint8:   ConvertScalar<sint8,   _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint8:   ConvertScalar<uint8,   _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint16:  ConvertScalar<sint16,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint16:  ConvertScalar<uint16,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint32:  ConvertScalar<sint32,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint32:  ConvertScalar<uint32,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint64:  ConvertScalar<sint64,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint64:  ConvertScalar<uint64,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint8N:  ConvertScalar<sint8N,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint8N:  ConvertScalar<uint8N,  _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint16N: ConvertScalar<sint16N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint16N: ConvertScalar<uint16N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint32N: ConvertScalar<sint32N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint32N: ConvertScalar<uint32N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Sint64N: ConvertScalar<sint64N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Uint64N: ConvertScalar<uint64N, _srcType>(_src, dst_, _count); break; \
+				case DataType_Float16: ConvertScalar<float16, _srcType>(_src, dst_, _count); break; \
+				case DataType_Float32: ConvertScalar<float32, _srcType>(_src, dst_, _count); break; \
+				case DataType_Float64: ConvertScalar<float64, _srcType>(_src, dst_, _count); break; \
+				default:               FRM_ASSERT(false); break; \
+			}; \
+			break;
+
+	switch (_srcType) {
+		FRM_DataType_decl(DataType_case_decl)
+		default: FRM_ASSERT(false); break;
+	};
+	#undef DataType_case_decl
+}
+
+void DataTypeConvert(DataType _srcType, int _srcComponents, DataType _dstType, int _dstComponents, const void* _src, void* dst_, uint _count, const int* _swizzle)
+{
+	FRM_ASSERT(_srcComponents >= 1 && _srcComponents <= 4);
+	FRM_ASSERT(_dstComponents >= 1 && _dstComponents <= 4);
+
+	int  swizzle[4];
+	bool isIdentity = _srcComponents == _dstComponents;
+	for (int i = 0; i < _dstComponents; ++i) {
+		if (_swizzle) {
+			swizzle[i] = _swizzle[i];
+		} else {
+			swizzle[i] = i < _srcComponents ? i : (i == 3 ? DataTypeSwizzle_One : DataTypeSwizzle_Zero);
 		}
+		FRM_ASSERT(swizzle[i] < _srcComponents && swizzle[i] >= DataTypeSwizzle_One);
+		isIdentity = isIdentity && swizzle[i] == i;
+	}
+	if (isIdentity) {
+		DataTypeConvert(_srcType, _dstType, _src, dst_, _count * _srcComponents);
+		return;
+	}
+
+	uint64 one = 0;
+	const float32 oneF32 = 1.0f;
+	DataTypeConvert(DataType_Float32, _dstType, &oneF32, &one);
+
+ // convert blocks of vectors to _dstType with _srcComponents, then swizzle into dst_
+	const uint srcSize    = DataTypeSizeBytes(_srcType) * _srcComponents;
+	const uint dstSize    = DataTypeSizeBytes(_dstType) * _dstComponents;
+	const uint blockCount = kBlockSize / _srcComponents;
+	uint64 tmp[kBlockSize];
+	for (uint i = 0; i < _count; i += blockCount) {
+		const uint n = std::min(blockCount, _count - i);
+		const char* src = (const char*)_src + i * srcSize;
+		char* dst = (char*)dst_ + i * dstSize;
+		DataTypeConvert(_srcType, _dstType, src, tmp, n * _srcComponents);
+		switch (DataTypeSizeBytes(_dstType)) {
+			case 1: Swizzle((const uint8* )tmp, _srcComponents, (uint8* )dst, _dstComponents, swizzle, *((uint8* )&one), n); break;
+			case 2: Swizzle((const uint16*)tmp, _srcComponents, (uint16*)dst, _dstComponents, swizzle, *((uint16*)&one), n); break;
+			case 4: Swizzle((const uint32*)tmp, _srcComponents, (uint32*)dst, _dstComponents, swizzle, *((uint32*)&one), n); break;
+			case 8: Swizzle((const uint64*)tmp, _srcComponents, (uint64*)dst, _dstComponents, swizzle, *((uint64*)&one), n); break;
+			default: FRM_ASSERT(false); break;
+		};
 	}
 }
 
@@ -207,4 +638,60 @@ float UnpackFloat(uint32 _value, int _signBits, int _exponentBits, int _mantissa
 	return ret.f;
 }
 
+uint16 PackFloat16(float _f32)
+{
+ // see https://gist.github.com/rygorous/2156668 (float_to_half_fast3_rtne)
+	const uint32 kF32Infinity   = 255u << 23;
+	const uint32 kF16Overflow   = (127u + 16u) << 23; // values >= 65536 are always infinity
+	const uint32 kF16MinNormal  = (127u - 14u) << 23;
+	const uint32 kDenormalMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	internal::iee754_f32 in;
+	in.f = _f32;
+	const uint32 sign = in.u & 0x80000000u;
+	uint32 u = in.u ^ sign;
+	uint16 ret;
+	if (u >= kF16Overflow) {
+		ret = u > kF32Infinity ? (uint16)(0x7e00u | ((u >> 13) & 0x3ffu)) : (uint16)0x7c00u; // NaN is quietened, as per F16C
+	} else if (u < kF16MinNormal) {
+	 // denormal, let the FPU do the rounding
+		internal::iee754_f32 magic, denormal;
+		magic.u = kDenormalMagic;
+		denormal.u = u;
+		denormal.f += magic.f;
+		ret = (uint16)(denormal.u - kDenormalMagic);
+	} else {
+		const uint32 mantissaOdd = (u >> 13) & 1u;
+		u += ((15u - 127u) << 23) + 0xfffu; // rebias exponent, round
+		u += mantissaOdd;
+		ret = (uint16)(u >> 13);
+	}
+	return ret | (uint16)(sign >> 16);
+}
+
+float UnpackFloat16(uint16 _f16)
+{
+	const uint32 kShiftedExponent = 0x7c00u << 13;
+
+	internal::iee754_f32 ret;
+	ret.u = (uint32)(_f16 & 0x7fffu) << 13;
+	const uint32 exponent = ret.u & kShiftedExponent;
+	ret.u += (127u - 15u) << 23;
+	if (exponent == kShiftedExponent) {
+	 // infinity/NaN
+		ret.u += (128u - 16u) << 23;
+		if (ret.u & 0x7fffffu) {
+			ret.u |= 0x400000u;
+		}
+	} else if (exponent == 0) {
+	 // zero/denormal, renormalize
+		internal::iee754_f32 magic;
+		magic.u = 113u << 23;
+		ret.u += 1u << 23;
+		ret.f -= magic.f;
+	}
+	ret.u |= (uint32)(_f16 & 0x8000u) << 16;
+	return ret.f;
+}
+
 } // namespace frm
@@ -4,6 +4,7 @@
 #include <cfloat>
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 #if defined(_MSC_VER)
 	#pragma warning(push)
@@ -116,6 +117,8 @@ typedef internal::DataTypeBase<std::uint16_t, DataType_Float16> float16;
 typedef float                                                   float32;
 typedef double                                                  float64;
 
+// \note glibc's <sys/types.h> declares ::uint (unsigned int), hence code outside of namespace frm which has 'using namespace frm' must
+//   write frm::uint on Linux.
 typedef std::ptrdiff_t sint;
 typedef std::size_t    uint;
 
@@ -237,28 +240,30 @@ inline tDst DataType_IntNToFloat(tSrc _src)
 template <typename tDst, typename tSrc>
 inline tDst DataType_IntNPrecisionChange(tSrc _src)
 {
-	return _src;
 	FRM_ASSERT(DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)) == DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tDst))); // perform signed -> unsigned conversion before precision change
-	if (sizeof(tSrc) > sizeof(tDst)) {
-		tDst mn = FRM_DATA_TYPE_MIN(tDst) == (tDst)0 ? (tDst)1 : FRM_DATA_TYPE_MIN(tDst); // prevent DBZ
-		tDst mx = FRM_DATA_TYPE_MAX(tDst);
-		return (tDst)(_src < 0 ? -(_src / (FRM_DATA_TYPE_MIN(tSrc) / mn))
-		                       :   _src / (FRM_DATA_TYPE_MAX(tSrc) / mx));
+	if (sizeof(tSrc) == sizeof(tDst)) {
+		return (tDst)_src;
+	}
+ // rescale via a 64 bit intermediate; the result is truncated
+	typedef typename std::conditional<DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)), sint64, uint64>::type tWide;
+	const tWide src    = (tWide)_src;
+	const bool  isNeg  = DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)) && src < (tWide)0;
+	const tWide srcLim = isNeg ? (tWide)FRM_DATA_TYPE_MIN(tSrc) : (tWide)FRM_DATA_TYPE_MAX(tSrc);
+	const tWide dstLim = isNeg ? (tWide)FRM_DATA_TYPE_MIN(tDst) : (tWide)FRM_DATA_TYPE_MAX(tDst);
+	if (sizeof(tSrc) <= 4 && sizeof(tDst) <= 4) {
+		return (tDst)(src * dstLim / srcLim);
 	} else if (sizeof(tSrc) < sizeof(tDst)) {
-		tSrc mn = FRM_DATA_TYPE_MIN(tSrc) == (tSrc)0 ? (tSrc)1 : FRM_DATA_TYPE_MIN(tSrc); // prevent DBZ
-		tSrc mx = FRM_DATA_TYPE_MAX(tSrc);
-		return (tDst)(_src < 0 ? -(_src * (FRM_DATA_TYPE_MIN(tDst) / mn))
-	                           :   _src * (FRM_DATA_TYPE_MAX(tDst) / mx));
+		return (tDst)(src * (dstLim / srcLim));
 	} else {
-		return _src;
+		return (tDst)(src / (srcLim / dstLim));
 	}
 }
 template <typename tDst, typename tSrc>
 inline tDst DataType_IntNToIntN(tSrc _src)
 {
-	if (DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)) && !DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tDst))) { // signed -> unsigned
+	if (DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)) && !DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tDst))) { // signed -> unsigned, clamp at zero
 		typedef FRM_DATA_TYPE_FROM_ENUM((DataType)(FRM_DATA_TYPE_TO_ENUM(tSrc) + 1)) tUnsigned;
-		tUnsigned tmp = (tUnsigned)(_src * 2);
+		tUnsigned tmp = (tUnsigned)(_src < 0 ? 0 : _src * 2);
 		return DataType_IntNPrecisionChange<tDst, tUnsigned>(tmp);
 	} else if (!DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tSrc)) && DataTypeIsSigned(FRM_DATA_TYPE_TO_ENUM(tDst))) { // unsigned -> signed
 		typedef FRM_DATA_TYPE_FROM_ENUM((DataType)(FRM_DATA_TYPE_TO_ENUM(tSrc) - 1)) tSigned;
@@ -271,6 +276,15 @@ inline tDst DataType_IntNToIntN(tSrc _src)
 
 } // namespace internal
 
+// Pack/unpack IEEE754 float with arbitrary precision for sign, exponent and mantissa.
+uint32 PackFloat(float _value, int _signBits, int _exponentBits, int _mantissaBits);
+float UnpackFloat(uint32 _value, int _signBits, int _exponentBits, int _mantissaBits);
+
+// Pack/unpack IEEE754 16-bit float. Rounding is to nearest even, denormals/infinity/NaN are preserved (results match the F16C 
+// instructions).
+uint16 PackFloat16(float _f32);
+float UnpackFloat16(uint16 _f16);
+
 // Convert from tSrc -> tDst.
 template <typename tDst, typename tSrc>
 inline tDst DataTypeConvert(tSrc _src)
@@ -279,11 +293,9 @@ inline tDst DataTypeConvert(tSrc _src)
 		return _src;
 	}
 	if (FRM_DATA_TYPE_TO_ENUM(tSrc) == DataType_Float16) {
-		//return DataTypeConvert<tDst>(internal::DataType_FloatToFloat<float32>(_src));
-		FRM_ASSERT(false); return (tDst)0;
+		return DataTypeConvert<tDst, float32>(UnpackFloat16((uint16)_src));
 	} else if (FRM_DATA_TYPE_TO_ENUM(tDst) == DataType_Float16) {
-		//return internal::DataType_FloatToFloat<float16>(DataTypeConvert<float32>(_src));
-		FRM_ASSERT(false); return (tDst)0;
+		return (tDst)PackFloat16(DataTypeConvert<float32, tSrc>(_src));
 	} else if (DataTypeIsNormalized(FRM_DATA_TYPE_TO_ENUM(tSrc)) && DataTypeIsNormalized(FRM_DATA_TYPE_TO_ENUM(tDst))) {
 		return internal::DataType_IntNToIntN<tDst, tSrc>(_src);
 	} else if (DataTypeIsFloat(FRM_DATA_TYPE_TO_ENUM(tSrc)) && DataTypeIsNormalized(FRM_DATA_TYPE_TO_ENUM(tDst))) {
@@ -297,9 +309,21 @@ inline tDst DataTypeConvert(tSrc _src)
 	return (tDst)0;
 }
 
-// Copy _count objects from _src to _dst, converting from _srcType to _dstType.
+// Copy _count objects from _src to _dst, converting from _srcType to _dstType. Conversions to/from float types and between 8/16-bit
+// normalized types use SIMD kernels, results are identical to the scalar DataTypeConvert<tDst, tSrc>().
 void DataTypeConvert(DataType _srcType, DataType _dstType, const void* _src, void* dst_, uint _count = 1);
 
+enum DataTypeSwizzle_
+{
+	DataTypeSwizzle_Zero = -1,
+	DataTypeSwizzle_One  = -2, // 1 converted to the destination type (i.e. the max value for normalized types).
+};
+
+// Copy _count vectors from _src to _dst, converting from _srcType/_srcComponents to _dstType/_dstComponents (at most 4). _swizzle
+// specifies the source component index or a DataTypeSwizzle_ value for each destination component. If _swizzle is null, the first
+// _srcComponents are copied and any remaining components are set to 0, or 1 for the 4th component (e.g. RGB -> RGB1).
+void DataTypeConvert(DataType _srcType, int _srcComponents, DataType _dstType, int _dstComponents, const void* _src, void* dst_, uint _count, const int* _swizzle = nullptr);
+
 inline uint DataTypeSizeBytes(DataType _dataType)
 {
 	#define FRM_DataType_case_decl(_type, _enum) \
@@ -386,20 +410,6 @@ namespace internal {
 	};
 }
 
-// Pack/unpack IEEE754 float with arbitrary precision for sign, exponent and mantissa.
-uint32 PackFloat(float _value, int _signBits, int _exponentBits, int _mantissaBits);
-float UnpackFloat(uint32 _value, int _signBits, int _exponentBits, int _mantissaBits);
-
-// Pack/unpack 16-bit float via the generic functions.
-inline uint16 PackFloat16(float _f32)
-{
-	return (uint16)PackFloat(_f32, 1, 5, 10);
-}
-inline float UnpackFloat16(uint16 _f16)
-{
-	return UnpackFloat((uint32)_f16, 1, 5, 10);
-}
-
 } // namespace frm
 
 #ifdef _MSC_VER
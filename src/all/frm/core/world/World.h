@@ -181,7 +181,7 @@ public:
 	static Camera*           GetDrawCamera();
 	static Camera*           GetCullCamera();
 	
-	// Update the root scene for the specified phase.
+	// Update the root scene for the specified phase. Component updates may be distributed across JobSystem threads (see Component.h).
 	void                     update(float _dt, UpdatePhase _phase = UpdatePhase::All);
 	
 	// Serialize world. Note that m_rootScene is serialized inline if it has no path.
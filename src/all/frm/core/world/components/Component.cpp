@@ -2,6 +2,7 @@
 
 #include <frm/core/interpolation.h>
 #include <frm/core/Input.h>
+#include <frm/core/JobSystem.h>
 #include <frm/core/Profiler.h>
 #include <frm/core/Serializer.h>
 #include <frm/core/Serializable.inl>
@@ -51,20 +52,35 @@ void Component::Update(float _dt, World::UpdatePhase _phase)
 			continue;
 		}
 
-		(*s_updateFuncs)[it.first](it.second.begin(), it.second.end(), _dt, _phase);
+		const UpdateFuncInfo& updateFunc = (*s_updateFuncs)[it.first];
+		if (updateFunc.parallelChunkSize > 0 && it.second.size() > updateFunc.parallelChunkSize)
+		{
+			Component** components = it.second.data();
+			JobSystem::ParallelFor((uint32)it.second.size(), updateFunc.parallelChunkSize,
+				[&updateFunc, components, _dt, _phase](uint32 _begin, uint32 _end)
+				{
+					updateFunc.func(components + _begin, components + _end, _dt, _phase);
+				});
+		}
+		else
+		{
+			updateFunc.func(it.second.begin(), it.second.end(), _dt, _phase);
+		}
 	}
 }
 
-Component::RegisterUpdateFunc::RegisterUpdateFunc(UpdateFunc* _func, const char* _className)
+Component::RegisterUpdateFunc::RegisterUpdateFunc(UpdateFunc* _func, const char* _className, uint32 _parallelChunkSize)
 {
 	if_unlikely (!s_updateFuncs)
 	{
-		s_updateFuncs = new eastl::map<StringHash, Component::UpdateFunc*>();
+		s_updateFuncs = new eastl::map<StringHash, Component::UpdateFuncInfo>();
 	}
 
 	classNameHash = StringHash(_className);
 	FRM_ASSERT(s_updateFuncs->find(classNameHash) == s_updateFuncs->end()); // double registration?
-	(*s_updateFuncs)[classNameHash] = _func;
+	UpdateFuncInfo& updateFunc = (*s_updateFuncs)[classNameHash];
+	updateFunc.func = _func;
+	updateFunc.parallelChunkSize = _parallelChunkSize;
 }
 
 Component::RegisterUpdateFunc::~RegisterUpdateFunc()
@@ -131,7 +147,7 @@ void Component::setActive()
 	activeComponents.push_back(this);
 }
 
-eastl::map<StringHash, Component::ComponentList> Component::s_activeComponents;
-eastl::map<StringHash, Component::UpdateFunc*>*  Component::s_updateFuncs;
+eastl::map<StringHash, Component::ComponentList>   Component::s_activeComponents;
+eastl::map<StringHash, Component::UpdateFuncInfo>* Component::s_updateFuncs;
 
 } // namespace frm
@@ -17,6 +17,12 @@ namespace frm {
 // function which is called for a range of active components during each update
 // phase (see World.h).
 //
+// Components defined via FRM_COMPONENT_DEFINE_PARALLEL() have their active list
+// split into chunks which are updated concurrently via the JobSystem. Update()
+// must therefore be thread safe for such components (e.g. only modify the
+// component and its parent node). The phase barrier is preserved: all chunks
+// complete before the next class/phase is updated.
+//
 // \todo
 // - Static accessor for active components (see BasicRenderableComponent).
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,7 +36,8 @@ public:
 
 	struct RegisterUpdateFunc
 	{
-		RegisterUpdateFunc(UpdateFunc* _func, const char* _className);
+		// If _parallelChunkSize > 0, the active list is split into chunks of this size which are updated concurrently.
+		RegisterUpdateFunc(UpdateFunc* _func, const char* _className, uint32 _parallelChunkSize = 0);
 		~RegisterUpdateFunc();
 
 		StringHash classNameHash;
@@ -107,8 +114,14 @@ private:
 	SceneID      m_id = 0u;
 	World::State m_state = World::State::Shutdown;
 
-	static eastl::map<StringHash, ComponentList> s_activeComponents;
-	static eastl::map<StringHash, UpdateFunc*>*  s_updateFuncs;
+	struct UpdateFuncInfo
+	{
+		UpdateFunc* func              = nullptr;
+		uint32      parallelChunkSize = 0;
+	};
+
+	static eastl::map<StringHash, ComponentList>  s_activeComponents;
+	static eastl::map<StringHash, UpdateFuncInfo>* s_updateFuncs;
 
 
 	friend class Scene;
@@ -129,4 +142,11 @@ private:
 	static frm::Component::RegisterUpdateFunc s_ ## _class ## ComponentUpdateFunc(&_class::Update, #_class); \
 	FRM_FORCE_LINK_REF(_class)
 
+// As FRM_COMPONENT_DEFINE(), _class::Update() is called concurrently for chunks of _chunkSize active components.
+#define FRM_COMPONENT_DEFINE_PARALLEL(_class, _version, _chunkSize) \
+	FRM_SERIALIZABLE_DEFINE(_class, _version); \
+	FRM_FACTORY_REGISTER_DEFAULT(frm::Component, _class); \
+	static frm::Component::RegisterUpdateFunc s_ ## _class ## ComponentUpdateFunc(&_class::Update, #_class, _chunkSize); \
+	FRM_FORCE_LINK_REF(_class)
+
 } // namespace frm
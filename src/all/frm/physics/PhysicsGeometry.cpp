@@ -29,7 +29,7 @@ static const char* kTypeStr[PhysicsGeometry::Type_Count]
 
 PhysicsGeometry* PhysicsGeometry::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	PhysicsGeometry* ret = Find(id);
 	if (!ret) 
 	{
@@ -275,10 +275,10 @@ bool PhysicsGeometry::edit()
 
 	ImGui::PushID(this);
 	
-	/*String<32> buf = m_name;
+	/*String<32> buf = getName();
 	if (ImGui::InputText("Name", &buf[0], buf.getCapacity(), ImGuiInputTextFlags_EnterReturnsTrue) && buf[0] != '\0')
 	{
-		m_name.set(buf.c_str());
+		setName(buf.c_str());
 		ret = true;
 	}*/
 	
@@ -423,7 +423,11 @@ bool PhysicsGeometry::serialize(Serializer& _serializer_)
 		}
 	};
 	
-	Serialize(_serializer_, m_name, "Name"); // optional
+	NameStr name = getName();
+	if (Serialize(_serializer_, name, "Name")) // optional
+	{
+		setName(name.c_str()); // update the name index
+	}
 	setState(ret ? State_Unloaded : State_Error);
 
 	return ret;
@@ -434,7 +438,7 @@ PhysicsGeometry::Id PhysicsGeometry::getHash() const
 	Id ret = 0;
 	ret = Hash<Id>(&m_type, sizeof(m_type), ret);
 	ret = Hash<Id>(&m_data, sizeof(m_data), ret);
-	ret = HashString<Id>(m_name.c_str(), ret);
+	ret = HashString<Id>(getName(), ret);
 	return ret;
 }
 
@@ -462,17 +466,12 @@ bool PhysicsGeometry::initImpl()
 
 		cachedPath.setf("_cache/%s.physx", FileSystem::GetFileName(m_dataPath.c_str()).c_str());
 			
-		if (FileSystem::Exists(cachedPath.c_str()))
+		if (FileSystem::IsCacheValid(cachedPath.c_str(), m_dataPath.c_str()))
 		{
-			DateTime sourceDate = FileSystem::GetTimeModified(m_dataPath.c_str());
-			DateTime cachedDate = FileSystem::GetTimeModified(cachedPath.c_str());
-			if (sourceDate <= cachedDate)
+			FRM_LOG("PhysicsGeometry: Loading cached data '%s'", cachedPath.c_str());
+			if (!FileSystem::Read(cachedData, cachedPath.c_str()))
 			{
-				FRM_LOG("PhysicsGeometry: Loading cached data '%s'", cachedPath.c_str());
-				if (!FileSystem::Read(cachedData, cachedPath.c_str()))
-				{
-					FRM_LOG_ERR("PhysicsGeometry: Error loading cached data '%s'", cachedPath.c_str());
-				}
+				FRM_LOG_ERR("PhysicsGeometry: Error loading cached data '%s'", cachedPath.c_str());
 			}
 		}
 	}
@@ -513,7 +512,10 @@ bool PhysicsGeometry::initImpl()
 				}
 
 				cachedData.setData((const char*)pxOutput.getData(), pxOutput.getSize());
-				FileSystem::Write(cachedData, cachedPath.c_str());
+				if (FileSystem::Write(cachedData, cachedPath.c_str()))
+				{
+					FileSystem::SetCacheSource(cachedPath.c_str(), m_dataPath.c_str());
+				}
 			}
 
 			physx::PxDefaultMemoryInputData pxInput((physx::PxU8*)cachedData.getData(), (physx::PxU32)cachedData.getDataSize());
@@ -540,7 +542,10 @@ bool PhysicsGeometry::initImpl()
 				}
 
 				cachedData.setData((const char*)pxOutput.getData(), pxOutput.getSize()); // \todo avoid this copy?
-				FileSystem::Write(cachedData, cachedPath.c_str());
+				if (FileSystem::Write(cachedData, cachedPath.c_str()))
+				{
+					FileSystem::SetCacheSource(cachedPath.c_str(), m_dataPath.c_str());
+				}
 			}
 
 			physx::PxDefaultMemoryInputData pxInput((physx::PxU8*)cachedData.getData(), (physx::PxU32)cachedData.getDataSize());
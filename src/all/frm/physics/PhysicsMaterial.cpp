@@ -14,7 +14,7 @@ using namespace frm;
 
 PhysicsMaterial* PhysicsMaterial::Create(const char* _path)
 {
-	Id id = GetHashId(_path);
+	Id id = GetPathId(_path);
 	PhysicsMaterial* ret = Find(id);
 	if (!ret) 
 	{
@@ -206,10 +206,10 @@ bool PhysicsMaterial::edit()
 	bool ret = false;
 
 	ImGui::PushID(this);
-	/*String<32> buf = m_name;
+	/*String<32> buf = getName();
 	if (ImGui::InputText("Name", &buf[0], buf.getCapacity(), ImGuiInputTextFlags_EnterReturnsTrue) && buf[0] != '\0')
 	{
-		m_name.set(buf.c_str());
+		setName(buf.c_str());
 		ret = true;
 	}*/
 	ret |= ImGui::SliderFloat("Static Friction", &m_staticFriction, 0.0f, 1.0f);
@@ -249,7 +249,11 @@ bool PhysicsMaterial::serialize(Serializer& _serializer_)
 	ret &= Serialize(_serializer_, m_staticFriction,  "m_staticFriction");
 	ret &= Serialize(_serializer_, m_dynamicFriction, "m_dynamicFriction");
 	ret &= Serialize(_serializer_, m_restitution,     "m_restitution");
-	       Serialize(_serializer_, m_name,            "m_name"); // optional
+	NameStr name = getName();
+	if (Serialize(_serializer_, name, "m_name")) // optional
+	{
+		setName(name.c_str()); // update the name index
+	}
 	setState(ret ? State_Unloaded : State_Error);
 	return ret;
 }
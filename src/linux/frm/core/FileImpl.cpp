@@ -0,0 +1,554 @@
+#include <frm/core/File.h>
+
+#include <frm/core/Log.h>
+#include <frm/core/memory.h>
+#include <frm/core/platform.h>
+#include <frm/core/FileSystem.h>
+#include <frm/core/String.h>
+
+#include <EASTL/vector.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// io_uring is used for File::ReadBatch() if liburing is available (link with -luring), else reads are issued sequentially via pread().
+#ifndef FRM_FILE_IO_URING
+	#if __has_include(<liburing.h>)
+		#define FRM_FILE_IO_URING 1
+	#else
+		#define FRM_FILE_IO_URING 0
+	#endif
+#endif
+#if FRM_FILE_IO_URING
+	#include <liburing.h>
+#endif
+
+namespace {
+
+using namespace frm;
+
+// Files larger than this are memory mapped rather than read via pread(). The mapping is referenced directly by the File (see
+// File::setDataExternal()), hence large files are never copied.
+// \note Truncating a mapped file while it is referenced causes SIGBUS on access; large assets are assumed not to be modified while
+//   loaded.
+constexpr size_t kMmapThreshold = 1024 * 1024;
+
+int OpenRead(const char* _path)
+{
+	int fd;
+	do
+	{
+		fd = open(_path, O_RDONLY | O_CLOEXEC);
+	} while (fd == -1 && errno == EINTR);
+	return fd;
+}
+
+void Close(int _fd)
+{
+	// Don't retry on EINTR, the descriptor is released regardless.
+	FRM_PLATFORM_VERIFY(close(_fd) == 0 || errno == EINTR);
+}
+
+// Read up to _size bytes at _offset. Return the number of bytes read (less than _size if the file was truncated), or -1 on error.
+ssize_t PRead(int _fd, char* data_, size_t _size, size_t _offset)
+{
+	size_t bytesRead = 0;
+	while (bytesRead < _size)
+	{
+		const ssize_t n = pread(_fd, data_ + bytesRead, _size - bytesRead, (off_t)(_offset + bytesRead));
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+		if (n == 0)
+		{
+			break;
+		}
+		bytesRead += (size_t)n;
+	}
+	return (ssize_t)bytesRead;
+}
+
+// Size of the mapping for a file of _size bytes plus the null terminator.
+size_t GetMappingSize(size_t _size)
+{
+	const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	return (_size + 1 + pageSize - 1) & ~(pageSize - 1);
+}
+
+void ReleaseMapping(char* _data, frm::uint _size, void* _arg)
+{
+	FRM_PLATFORM_VERIFY(munmap(_data, GetMappingSize((size_t)_size - 1)) == 0);
+}
+
+// Map _size bytes of _fd, followed by a null character. The mapping is private (writes aren't visible in the file). Return nullptr if
+// the mapping failed.
+char* MapFile(int _fd, size_t _size)
+{
+	// Reserve the whole range as zero-filled anonymous memory, then map the file over the start. The remainder of the last page of
+	// the file is zero-filled by the kernel, if the file size is a multiple of the page size the null comes from the reserved page.
+	const size_t mappingSize = GetMappingSize(_size);
+	void* base = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	void* map = mmap(base, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED | MAP_POPULATE, _fd, 0);
+	if (map == MAP_FAILED)
+	{
+		FRM_PLATFORM_VERIFY(munmap(base, mappingSize) == 0);
+		return nullptr;
+	}
+	madvise(map, _size, MADV_SEQUENTIAL);
+	return (char*)map;
+}
+
+// Buffer for the contents of a file, plus a null terminator.
+struct ReadBuffer
+{
+	char*  data   = nullptr;
+	size_t size   = 0;       // Including the null terminator.
+	bool   mapped = false;
+
+	void alloc(size_t _size)
+	{
+		data = (char*)FRM_MALLOC(_size + 1);
+		size = _size + 1;
+	}
+
+	void release()
+	{
+		if (data)
+		{
+			if (mapped)
+			{
+				ReleaseMapping(data, (frm::uint)size, nullptr);
+			}
+			else
+			{
+				FRM_FREE(data);
+			}
+		}
+		data = nullptr;
+		size = 0;
+		mapped = false;
+	}
+};
+
+// Return the size of _fd, or -1 on error (errno is set).
+ssize_t GetFileSize(int _fd)
+{
+	struct stat st;
+	if (fstat(_fd, &st) != 0)
+	{
+		return -1;
+	}
+	if (!S_ISREG(st.st_mode))
+	{
+		errno = EISDIR;
+		return -1;
+	}
+	return (ssize_t)st.st_size;
+}
+
+// Read the contents of _fd into buffer_. Return 0 on success or an errno value.
+int ReadAll(int _fd, ReadBuffer& buffer_)
+{
+	const ssize_t fileSize = GetFileSize(_fd);
+	if (fileSize < 0)
+	{
+		return errno;
+	}
+
+	size_t size = (size_t)fileSize;
+	if (size >= kMmapThreshold)
+	{
+		if (char* map = MapFile(_fd, size))
+		{
+			buffer_.data   = map;
+			buffer_.size   = size + 1;
+			buffer_.mapped = true;
+			return 0;
+		}
+	}
+
+	buffer_.alloc(size);
+	const ssize_t bytesRead = PRead(_fd, buffer_.data, size, 0);
+	if (bytesRead < 0)
+	{
+		const int err = errno;
+		buffer_.release();
+		return err;
+	}
+	buffer_.size = (size_t)bytesRead + 1;
+	buffer_.data[bytesRead] = '\0';
+	return 0;
+}
+
+#if FRM_FILE_IO_URING
+
+// One ring per thread; rings aren't thread safe and FileSystemAsync workers call ReadBatch() concurrently.
+struct IoUring
+{
+	static constexpr unsigned kQueueDepth = 64;
+
+	io_uring ring;
+	bool     isInit = false;
+	bool     isSupported = true; // false if io_uring_queue_init() failed (e.g. disabled by the kernel or a seccomp policy)
+
+	~IoUring()
+	{
+		if (isInit)
+		{
+			io_uring_queue_exit(&ring);
+		}
+	}
+
+	io_uring* get()
+	{
+		if (!isInit && isSupported)
+		{
+			const int err = io_uring_queue_init(kQueueDepth, &ring, 0);
+			if (err < 0)
+			{
+				FRM_LOG_DBG("io_uring_queue_init: %s, falling back to pread", GetPlatformErrorString((uint64)-err));
+				isSupported = false;
+				return nullptr;
+			}
+			isInit = true;
+		}
+		return isInit ? &ring : nullptr;
+	}
+};
+static thread_local IoUring s_ioUring;
+
+#endif // FRM_FILE_IO_URING
+
+} // namespace
+
+namespace frm {
+
+File::File()
+{
+	m_impl = nullptr;
+}
+
+File::~File()
+{
+	freeData();
+}
+
+bool File::Exists(const char* _path)
+{
+	return access(_path, F_OK) == 0;
+}
+
+bool File::Read(File& file_, const char* _path)
+{
+	if (!_path)
+	{
+		_path = file_.getPath();
+	}
+	FRM_ASSERT(_path);
+
+	ReadBuffer buffer;
+	int err = 0;
+
+	const int fd = OpenRead(_path);
+	if (fd == -1)
+	{
+		err = errno;
+	}
+	else
+	{
+		err = ReadAll(fd, buffer);
+		Close(fd);
+	}
+
+	if (err != 0)
+	{
+		FRM_LOG_ERR("Error reading '%s':\n\t%s", _path, GetPlatformErrorString((uint64)err));
+		return false;
+	}
+
+	if (buffer.mapped)
+	{
+		file_.setDataExternal(buffer.data, (uint)buffer.size, &ReleaseMapping);
+	}
+	else
+	{
+		file_.adoptData(buffer.data, (uint)buffer.size, (uint)buffer.size);
+	}
+	file_.setPath(_path);
+	return true;
+}
+
+int File::ReadBatch(File* const files_[], int _count, bool results_[], ReadCallback* _callback, void* _callbackArg)
+{
+	int ret = 0;
+
+	#if FRM_FILE_IO_URING
+	io_uring* ring = _count > 1 ? s_ioUring.get() : nullptr;
+	if (ring)
+	{
+		struct Op
+		{
+			int                 fd     = -1;
+			size_t              size   = 0;
+			size_t              offset = 0;
+			int                 err    = 0;
+			bool                done   = false;
+			ReadBuffer          buffer;
+		};
+		eastl::vector<Op>  ops(_count);
+		eastl::vector<int> submitQueue; // Ops waiting for an SQE (initial reads and resubmitted short reads).
+		submitQueue.reserve(_count);
+
+		// Finish op i as soon as its last read completes: close the file, pass the buffer to the file and call _callback.
+		auto complete = [&](int i)
+		{
+			Op& op = ops[i];
+			FRM_ASSERT(!op.done);
+			op.done = true;
+			if (op.fd != -1)
+			{
+				Close(op.fd);
+				op.fd = -1;
+			}
+
+			const bool result = op.err == 0;
+			if (result)
+			{
+				if (op.buffer.mapped)
+				{
+					files_[i]->setDataExternal(op.buffer.data, (uint)op.buffer.size, &ReleaseMapping);
+				}
+				else
+				{
+					op.buffer.data[op.size] = '\0';
+					files_[i]->adoptData(op.buffer.data, (uint)op.size + 1, (uint)op.buffer.size);
+				}
+				op.buffer = ReadBuffer(); // owned by the file
+				++ret;
+			}
+			else
+			{
+				op.buffer.release();
+				FRM_LOG_ERR("Error reading '%s':\n\t%s", files_[i]->getPath(), GetPlatformErrorString((uint64)op.err));
+			}
+			if (results_)
+			{
+				results_[i] = result;
+			}
+			if (_callback)
+			{
+				_callback(i, result, _callbackArg);
+			}
+		};
+
+		for (int i = 0; i < _count; ++i)
+		{
+			Op& op = ops[i];
+			op.fd = OpenRead(files_[i]->getPath());
+			if (op.fd == -1)
+			{
+				op.err = errno;
+				complete(i);
+				continue;
+			}
+
+			const ssize_t fileSize = GetFileSize(op.fd);
+			if (fileSize < 0)
+			{
+				op.err = errno;
+				complete(i);
+				continue;
+			}
+
+			op.size = (size_t)fileSize;
+			if (op.size >= kMmapThreshold)
+			{
+			 // large files are mapped directly, io_uring only saves syscall overhead for small files
+				op.err = ReadAll(op.fd, op.buffer);
+				complete(i);
+			}
+			else
+			{
+				op.buffer.alloc(op.size);
+				if (op.size > 0)
+				{
+					submitQueue.push_back(i);
+				}
+				else
+				{
+					complete(i);
+				}
+			}
+		}
+
+		unsigned pendingCount = 0;
+		int submitErr = 0;
+		while (!submitQueue.empty() || pendingCount > 0)
+		{
+			while (!submitQueue.empty())
+			{
+				io_uring_sqe* sqe = io_uring_get_sqe(ring);
+				if (!sqe)
+				{
+					break;
+				}
+				const int i = submitQueue.back();
+				submitQueue.pop_back();
+				Op& op = ops[i];
+				io_uring_prep_read(sqe, op.fd, op.buffer.data + op.offset, (unsigned)(op.size - op.offset), (uint64)op.offset);
+				io_uring_sqe_set_data(sqe, (void*)(intptr_t)i);
+				++pendingCount;
+			}
+
+			int err = io_uring_submit_and_wait(ring, 1);
+			if (err < 0 && err != -EINTR)
+			{
+				FRM_LOG_ERR("io_uring_submit_and_wait: %s", GetPlatformErrorString((uint64)-err));
+				FRM_ASSERT(false);
+				submitErr = -err;
+				break;
+			}
+
+			io_uring_cqe* cqe;
+			while (pendingCount > 0 && io_uring_peek_cqe(ring, &cqe) == 0)
+			{
+				const int i = (int)(intptr_t)io_uring_cqe_get_data(cqe);
+				const int res = cqe->res;
+				io_uring_cqe_seen(ring, cqe);
+				--pendingCount;
+
+				Op& op = ops[i];
+				if (res == -EINTR || res == -EAGAIN)
+				{
+					submitQueue.push_back(i);
+				}
+				else if (res < 0)
+				{
+					op.err = -res;
+					complete(i);
+				}
+				else if (res == 0)
+				{
+				 // file was truncated since fstat()
+					op.size = op.offset;
+					complete(i);
+				}
+				else
+				{
+					op.offset += (size_t)res;
+					if (op.offset < op.size)
+					{
+						submitQueue.push_back(i); // short read
+					}
+					else
+					{
+						complete(i);
+					}
+				}
+			}
+		}
+		FRM_ASSERT(pendingCount == 0); // buffers are released below
+
+		// Only if the submission failed.
+		for (int i = 0; i < _count; ++i)
+		{
+			if (!ops[i].done)
+			{
+				ops[i].err = ops[i].err ? ops[i].err : submitErr;
+				complete(i);
+			}
+		}
+
+		return ret;
+	}
+	#endif // FRM_FILE_IO_URING
+
+	for (int i = 0; i < _count; ++i)
+	{
+		const bool result = Read(*files_[i]);
+		if (results_)
+		{
+			results_[i] = result;
+		}
+		if (_callback)
+		{
+			_callback(i, result, _callbackArg);
+		}
+		ret += result ? 1 : 0;
+	}
+	return ret;
+}
+
+bool File::Write(const File& _file, const char* _path)
+{
+	if (!_path)
+	{
+		_path = _file.getPath();
+	}
+	FRM_ASSERT(_path);
+
+	int fd;
+	do
+	{
+		fd = open(_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	} while (fd == -1 && errno == EINTR);
+	if (fd == -1)
+	{
+		const int err = errno;
+		if (err == ENOENT)
+		{
+			if (FileSystem::CreateDir(_path))
+			{
+				return Write(_file, _path);
+			}
+			else
+			{
+				return false;
+			}
+		}
+		FRM_LOG_ERR("Error writing '%s':\n\t%s", _path, GetPlatformErrorString((uint64)err));
+		return false;
+	}
+
+	size_t dataSize = (size_t)_file.getDataSize();
+	if (dataSize > 0 && _file.getData()[dataSize - 1] == '\0')
+	{
+		--dataSize;
+	}
+
+	bool ret = true;
+	const char* data = _file.getData();
+	for (size_t bytesWritten = 0; bytesWritten < dataSize; )
+	{
+		const ssize_t n = write(fd, data + bytesWritten, dataSize - bytesWritten);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			FRM_LOG_ERR("Error writing '%s':\n\t%s", _path, GetPlatformErrorString((uint64)errno));
+			ret = false;
+			break;
+		}
+		bytesWritten += (size_t)n;
+	}
+	Close(fd);
+
+	return ret;
+}
+
+} // namespace frm
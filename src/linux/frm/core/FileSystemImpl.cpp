@@ -0,0 +1,690 @@
+#include <frm/core/FileSystem.h>
+
+#include <frm/core/Log.h>
+#include <frm/core/memory.h>
+#include <frm/core/platform.h>
+#include <frm/core/Pool.h>
+#include <frm/core/String.h>
+#include <frm/core/StringHash.h>
+#include <frm/core/TextParser.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <EASTL/vector.h>
+#include <EASTL/vector_map.h>
+
+using namespace frm;
+
+// DateTime raw values use the same units as the Windows implementation (100ns intervals since 1601-01-01), hence timestamps are
+// comparable across platforms.
+static DateTime TimespecToDateTime(const timespec& _ts)
+{
+	constexpr sint64 kEpochOffset = 116444736000000000ll; // 1601-01-01 -> 1970-01-01
+	return DateTime((sint64)_ts.tv_sec * 10000000ll + (sint64)_ts.tv_nsec / 100ll + kEpochOffset);
+}
+
+static bool GetFileDateTime(const char* _fullPath, DateTime& created_, DateTime& modified_)
+{
+	const char* err = nullptr;
+	#if defined(STATX_BTIME)
+	{
+		struct statx stx;
+		if (statx(AT_FDCWD, _fullPath, 0, STATX_MTIME | STATX_BTIME, &stx) != 0)
+		{
+			err = GetPlatformErrorString(errno);
+			goto GetFileDateTime_End;
+		}
+		const timespec mtime = { (time_t)stx.stx_mtime.tv_sec, (long)stx.stx_mtime.tv_nsec };
+		modified_ = TimespecToDateTime(mtime);
+		if (stx.stx_mask & STATX_BTIME) // not all file systems record the creation time
+		{
+			const timespec btime = { (time_t)stx.stx_btime.tv_sec, (long)stx.stx_btime.tv_nsec };
+			created_ = TimespecToDateTime(btime);
+		}
+		else
+		{
+			created_ = modified_;
+		}
+	}
+	#else
+	{
+		struct stat st;
+		if (stat(_fullPath, &st) != 0)
+		{
+			err = GetPlatformErrorString(errno);
+			goto GetFileDateTime_End;
+		}
+		modified_ = TimespecToDateTime(st.st_mtim);
+		created_  = modified_;
+	}
+	#endif
+GetFileDateTime_End:
+	if (err)
+	{
+		FRM_LOG_ERR("GetFileDateTime: %s", err);
+		FRM_ASSERT(false);
+	}
+	return err == nullptr;
+}
+
+// Lexically normalize _path ('.', '..' and repeated separators), prepending the working directory if _path is relative.
+static void GetFullPath(const char* _path, char ret_[PATH_MAX])
+{
+	char tmp[PATH_MAX];
+	if (*_path == '/')
+	{
+		strncpy(tmp, _path, PATH_MAX - 1);
+		tmp[PATH_MAX - 1] = '\0';
+	}
+	else
+	{
+		FRM_PLATFORM_VERIFY(getcwd(tmp, PATH_MAX) != nullptr);
+		const size_t len = strlen(tmp);
+		snprintf(tmp + len, PATH_MAX - len, "/%s", _path);
+	}
+
+	char* dst = ret_;
+	for (const char* src = tmp; *src != '\0'; )
+	{
+		while (*src == '/')
+		{
+			++src;
+		}
+		const char* end = src;
+		while (*end != '\0' && *end != '/')
+		{
+			++end;
+		}
+		const size_t len = (size_t)(end - src);
+		if (len == 0 || (len == 1 && src[0] == '.'))
+		{
+			// skip
+		}
+		else if (len == 2 && src[0] == '.' && src[1] == '.')
+		{
+			while (dst > ret_ && *--dst != '/');
+		}
+		else
+		{
+			*dst++ = '/';
+			memcpy(dst, src, len);
+			dst += len;
+		}
+		src = end;
+	}
+	if (dst == ret_)
+	{
+		*dst++ = '/';
+	}
+	*dst = '\0';
+}
+
+static void GetAppPath(char ret_[PATH_MAX], const char* _append = nullptr)
+{
+	char tmp[PATH_MAX];
+	const ssize_t len = readlink("/proc/self/exe", tmp, PATH_MAX - 1);
+	FRM_PLATFORM_VERIFY(len != -1);
+	tmp[len == -1 ? 0 : len] = '\0';
+
+	char* pathEnd = strrchr(tmp, '/');
+	if (pathEnd)
+	{
+		*pathEnd = '\0';
+	}
+	if (_append && *_append != '\0')
+	{
+		const size_t tmpLen = strlen(tmp);
+		snprintf(tmp + tmpLen, PATH_MAX - tmpLen, "/%s", _append);
+	}
+	GetFullPath(tmp, ret_);
+}
+
+static void GetRootPath(const char* _root, char ret_[PATH_MAX])
+{
+	if (FileSystem::IsAbsolute(_root))
+	{
+		GetFullPath(_root, ret_);
+	}
+	else
+	{
+		GetAppPath(ret_, _root);
+	}
+}
+
+static bool IsDirectory(const char* _path, const dirent* _entry)
+{
+	if (_entry->d_type != DT_UNKNOWN && _entry->d_type != DT_LNK)
+	{
+		return _entry->d_type == DT_DIR;
+	}
+ // some file systems don't fill d_type, follow symbolic links as per Windows
+	PathStr path("%s/%s", _path, _entry->d_name);
+	struct stat st;
+	return stat((const char*)path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// PUBLIC
+
+bool FileSystem::Delete(const char* _path)
+{
+	if (unlink(_path) != 0)
+	{
+		const int err = errno;
+		if (err != ENOENT)
+		{
+			FRM_LOG_ERR("unlink(%s): %s", _path, GetPlatformErrorString(err));
+		}
+		return false;
+	}
+	return true;
+}
+
+bool FileSystem::RemoveDir(const char* _path)
+{
+	if (rmdir(_path) != 0)
+	{
+		FRM_LOG_ERR("rmdir(%s): %s", _path, GetPlatformErrorString(errno));
+		return false;
+	}
+	return true;
+}
+
+DateTime FileSystem::GetTimeCreated(const char* _path, int _rootHint)
+{
+	PathStr fullPath;
+	if (!FindExisting(fullPath, _path, _rootHint))
+	{
+		return DateTime(); // \todo return invalid sentinel
+	}
+	DateTime created, modified;
+	GetFileDateTime((const char*)fullPath, created, modified);
+	return created;
+}
+
+DateTime FileSystem::GetTimeModified(const char* _path, int _rootHint)
+{
+	PathStr fullPath;
+	if (!FindExisting(fullPath, _path, _rootHint))
+	{
+		return DateTime(); // \todo return invalid sentinel
+	}
+	DateTime created, modified;
+	GetFileDateTime((const char*)fullPath, created, modified);
+	return modified;
+}
+
+bool FileSystem::CreateDir(const char* _path)
+{
+	TextParser tp(_path);
+	while (tp.advanceToNext("\\/") != 0)
+	{
+		if (tp.getCharCount() == 0) // absolute path, skip the root
+		{
+			tp.advance();
+			continue;
+		}
+		PathStr dir;
+		dir.set(_path, tp.getCharCount());
+		if (mkdir((const char*)dir, 0755) != 0)
+		{
+			const int err = errno;
+			if (err != EEXIST)
+			{
+				FRM_LOG_ERR("mkdir(%s): %s", _path, GetPlatformErrorString(err));
+				return false;
+			}
+		}
+		tp.advance(); // skip the delimiter
+	}
+	return true;
+}
+
+PathStr FileSystem::MakeRelative(const char* _path, int _root)
+{
+ // \todo see the Windows implementation
+	char root[PATH_MAX];
+	GetRootPath((const char*)(*s_roots)[_root], root);
+
+	char path[PATH_MAX];
+	GetFullPath(_path, path);
+
+ // find the length of the common directory prefix
+	size_t common = 0;
+	for (size_t i = 0; root[i] != '\0' && root[i] == path[i]; ++i)
+	{
+		if (root[i] == '/')
+		{
+			common = i;
+		}
+	}
+	const size_t rootLen = strlen(root);
+	if (strncmp(root, path, rootLen) == 0 && (path[rootLen] == '/' || path[rootLen] == '\0'))
+	{
+		common = rootLen;
+	}
+
+	PathStr ret;
+	if (common == 0)
+	{
+	 // no common prefix, return the absolute path
+		ret.set(path);
+	}
+	else
+	{
+	 // as per the Windows implementation, return the path following the common prefix
+		const char* tmp = path + common;
+		while (*tmp == '.' || *tmp == '/')
+		{
+			++tmp;
+		}
+		ret.set(tmp);
+	}
+	return ret;
+}
+
+bool FileSystem::IsAbsolute(const char* _path)
+{
+	return _path[0] == '/';
+}
+
+PathStr FileSystem::StripRoot(const char* _path)
+{
+	char path[PATH_MAX];
+	GetFullPath(_path, path);
+
+	for (auto& root : (*s_roots))
+	{
+		if (root.isEmpty())
+		{
+			continue;
+		}
+		char pathRoot[PATH_MAX];
+		GetRootPath((const char*)root, pathRoot);
+		const char* rootBeg = strstr(path, pathRoot);
+		if (rootBeg != nullptr)
+		{
+			const char* ret = rootBeg + strlen(pathRoot);
+			return PathStr(*ret == '/' ? ret + 1 : ret);
+		}
+	}
+ // no root found, strip the whole path if not absolute
+	if (!IsAbsolute(_path))
+	{
+		return StripPath(_path);
+	}
+	return _path;
+}
+
+bool FileSystem::PlatformSelect(PathStr& ret_, std::initializer_list<const char*> _filterList)
+{
+	FRM_LOG_ERR("FileSystem::PlatformSelect: not supported on this platform");
+	return false;
+}
+
+bool FileSystem::PlatformSelectDir(PathStr& ret_, const char* _prompt)
+{
+	FRM_LOG_ERR("FileSystem::PlatformSelectDir: not supported on this platform");
+	return false;
+}
+
+int FileSystem::PlatformSelectMulti(PathStr retList_[], int _maxResults, std::initializer_list<const char*> _filterList)
+{
+	FRM_LOG_ERR("FileSystem::PlatformSelectMulti: not supported on this platform");
+	return 0;
+}
+
+int FileSystem::ListFiles(PathStr retList_[], int _maxResults, const char* _path, std::initializer_list<const char*> _filterList, bool _recursive)
+{
+	eastl::vector<PathStr> dirs;
+	dirs.push_back(_path);
+	int ret = 0;
+	while (!dirs.empty())
+	{
+		PathStr root = (PathStr&&)dirs.back();
+		dirs.pop_back();
+		Sanitize(root);
+
+		DIR* dir = opendir((const char*)root);
+		if (!dir)
+		{
+			const int err = errno;
+			if (err != ENOENT)
+			{
+				FRM_LOG_ERR("ListFiles (opendir): %s", GetPlatformErrorString(err));
+			}
+			continue;
+		}
+
+		errno = 0;
+		while (dirent* entry = readdir(dir))
+		{
+			if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+			{
+				if (IsDirectory((const char*)root, entry))
+				{
+					if (_recursive)
+					{
+						dirs.push_back(root);
+						dirs.back().appendf("/%s", entry->d_name);
+					}
+				}
+				else
+				{
+					if (MatchesMulti(_filterList, (const char*)entry->d_name))
+					{
+						if (ret < _maxResults)
+						{
+							retList_[ret].setf("%s/%s", (const char*)root, entry->d_name);
+						}
+						++ret;
+					}
+				}
+			}
+			errno = 0;
+		}
+		if (errno != 0)
+		{
+			FRM_LOG_ERR("ListFiles (readdir): %s", GetPlatformErrorString(errno));
+		}
+
+		closedir(dir);
+	}
+
+	return ret;
+}
+
+int FileSystem::ListDirs(PathStr retList_[], int _maxResults, const char* _path, std::initializer_list<const char*> _filterList, bool _recursive)
+{
+	eastl::vector<PathStr> dirs;
+	dirs.push_back(_path);
+	int ret = 0;
+	// 'Deferred' recursion, see the Windows implementation.
+	while (!dirs.empty())
+	{
+		PathStr root = (PathStr&&)dirs.back();
+		dirs.pop_back();
+		Sanitize(root);
+
+		DIR* dir = opendir((const char*)root);
+		if (!dir)
+		{
+			const int err = errno;
+			if (err != ENOENT)
+			{
+				FRM_LOG_ERR("ListDirs (opendir): %s", GetPlatformErrorString(err));
+			}
+			continue;
+		}
+
+		errno = 0;
+		while (dirent* entry = readdir(dir))
+		{
+			if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+			{
+				if (IsDirectory((const char*)root, entry))
+				{
+					if (_recursive)
+					{
+						dirs.push_back(root);
+						dirs.back().appendf("/%s", entry->d_name);
+					}
+					if (MatchesMulti(_filterList, (const char*)entry->d_name))
+					{
+						if (ret < _maxResults)
+						{
+							retList_[ret].setf("%s/%s", (const char*)root, entry->d_name);
+						}
+						++ret;
+					}
+				}
+			}
+			errno = 0;
+		}
+		if (errno != 0)
+		{
+			FRM_LOG_ERR("ListDirs (readdir): %s", GetPlatformErrorString(errno));
+		}
+
+		closedir(dir);
+	}
+
+	return ret;
+}
+
+
+namespace {
+/* Notes:
+	- inotify watches aren't recursive, hence each watch adds an inotify watch descriptor per subdir. New subdirs are watched as
+	  they're created, files created in a new subdir before its watch is added don't generate events.
+	- The inotify fd is non-blocking and is polled by DispatchNotifications(), there is no equivalent of the Windows completion
+	  routine.
+	- IN_CLOSE_WRITE is used in place of IN_MODIFY, which is generated for every write() and would report partially written files.
+	- As per the Windows implementation, duplicate actions are filtered via m_prevAction.
+*/
+	struct Watch
+	{
+		int        m_fd         = -1;
+		uint32     m_mask       = 0;
+		PathStr    m_dirPath    = "";
+
+		eastl::vector_map<int, PathStr> m_subdirs; // Watch descriptor -> subdir path relative to m_dirPath ("" for the root).
+
+		eastl::pair<PathStr, FileSystem::FileAction> m_prevAction;
+		FileSystem::FileActionCallback* m_dispatchCallback;
+		eastl::vector<eastl::pair<PathStr, FileSystem::FileAction> > m_dispatchQueue;
+	};
+	static Pool<Watch> s_WatchPool(8);
+	static eastl::vector_map<StringHash, Watch*> s_WatchMap;
+
+	void WatchAddDir(Watch* _watch, const char* _subdir);
+	void WatchUpdate(Watch* _watch);
+
+
+	void WatchAddDir(Watch* _watch, const char* _subdir)
+	{
+		PathStr path = _watch->m_dirPath;
+		if (*_subdir != '\0')
+		{
+			path.appendf("/%s", _subdir);
+		}
+
+		const int wd = inotify_add_watch(_watch->m_fd, (const char*)path, _watch->m_mask);
+		if (wd == -1)
+		{
+			FRM_LOG_ERR("FileSystem: inotify_add_watch(%s) '%s'", (const char*)path, GetPlatformErrorString(errno));
+			return;
+		}
+		_watch->m_subdirs[wd] = _subdir;
+
+		DIR* dir = opendir((const char*)path);
+		if (!dir)
+		{
+			return;
+		}
+		while (dirent* entry = readdir(dir))
+		{
+			if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0 && IsDirectory((const char*)path, entry))
+			{
+				PathStr subdir = _subdir;
+				subdir.appendf(*_subdir != '\0' ? "/%s" : "%s", entry->d_name);
+				WatchAddDir(_watch, (const char*)subdir);
+			}
+		}
+		closedir(dir);
+	}
+
+	void WatchUpdate(Watch* _watch)
+	{
+		alignas(inotify_event) char buf[1024 * 32]; // 32kb
+		for (;;)
+		{
+			const ssize_t bytes = read(_watch->m_fd, buf, sizeof(buf));
+			if (bytes <= 0)
+			{
+				if (bytes == -1 && errno != EAGAIN && errno != EINTR)
+				{
+					FRM_LOG_ERR("FileSystem: inotify read error '%s'", GetPlatformErrorString(errno));
+				}
+				return;
+			}
+
+			for (ssize_t off = 0; off < bytes; )
+			{
+				const inotify_event* info = (const inotify_event*)(buf + off);
+				off += sizeof(inotify_event) + info->len;
+
+				if (info->mask & IN_Q_OVERFLOW)
+				{
+					FRM_LOG("FileSystem: inotify queue overflow, notifications were lost");
+					continue;
+				}
+				auto subdir = _watch->m_subdirs.find(info->wd);
+				if (subdir == _watch->m_subdirs.end())
+				{
+					continue;
+				}
+				if (info->mask & IN_IGNORED) // watch was removed (dir deleted or moved)
+				{
+					_watch->m_subdirs.erase(subdir);
+					continue;
+				}
+				if (info->len == 0) // event on the watched dir itself, the parent dir reports these
+				{
+					continue;
+				}
+
+				PathStr fileName = subdir->second;
+				fileName.appendf(subdir->second.isEmpty() ? "%s" : "/%s", info->name);
+
+				FileSystem::FileAction action = FileSystem::FileAction_Count;
+				if (info->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					action = FileSystem::FileAction_Created;
+					if (info->mask & IN_ISDIR)
+					{
+						WatchAddDir(_watch, (const char*)fileName);
+					}
+				}
+				else if (info->mask & (IN_DELETE | IN_MOVED_FROM))
+				{
+					action = FileSystem::FileAction_Deleted;
+				}
+				else
+				{
+					action = FileSystem::FileAction_Modified;
+				}
+
+			 // check to see if the action was duplicated
+				auto& prev = _watch->m_prevAction;
+				if (prev.second != action || prev.first != fileName)
+				{
+					_watch->m_prevAction = eastl::make_pair(fileName, action);
+					_watch->m_dispatchQueue.push_back(_watch->m_prevAction);
+				}
+			}
+		}
+	}
+}
+
+void FileSystem::BeginNotifications(const char* _dir, FileActionCallback* _callback)
+{
+	StringHash dirHash(_dir);
+	if (s_WatchMap.find(dirHash) != s_WatchMap.end())
+	{
+		FRM_ASSERT(false);
+		return;
+	}
+	mkdir(_dir, 0755); // create if it doesn't already exist
+
+	Watch* watch = s_WatchPool.alloc();
+	watch->m_dirPath = _dir;
+	watch->m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	FRM_PLATFORM_ASSERT(watch->m_fd != -1);
+
+	s_WatchMap[dirHash] = watch;
+	watch->m_mask = 0
+			| IN_CREATE
+			| IN_DELETE
+			| IN_CLOSE_WRITE
+			| IN_ATTRIB
+			| IN_MOVED_FROM
+			| IN_MOVED_TO
+			;
+	watch->m_prevAction.second = FileAction_Count;
+	watch->m_dispatchCallback = _callback;
+	WatchAddDir(watch, "");
+}
+
+void FileSystem::EndNotifications(const char* _dir)
+{
+	StringHash dirHash(_dir);
+	auto it = s_WatchMap.find(dirHash);
+	if (it == s_WatchMap.end())
+	{
+		FRM_ASSERT(false);
+		return;
+	}
+	auto watch = it->second;
+	FRM_PLATFORM_VERIFY(close(watch->m_fd) == 0); // implicitly removes all watch descriptors
+	s_WatchPool.free(watch);
+	s_WatchMap.erase(it);
+}
+
+void FileSystem::DispatchNotifications(const char* _dir)
+{
+ // clear 'prevAction' - identical consecutive actions *between* calls to DispatchNotifications are allowed
+	if (_dir)
+	{
+		auto it = s_WatchMap.find(StringHash(_dir));
+		if (it == s_WatchMap.end())
+		{
+			FRM_ASSERT(false);
+			return;
+		}
+		it->second->m_prevAction.second = FileAction_Count;
+		WatchUpdate(it->second);
+	}
+	else
+	{
+		for (auto& it : s_WatchMap)
+		{
+			it.second->m_prevAction.second = FileAction_Count;
+			WatchUpdate(it.second);
+		}
+	}
+
+ // dispatch
+	if (_dir)
+	{
+		auto it = s_WatchMap.find(StringHash(_dir));
+		Watch& watch = *it->second;
+		for (auto& file : watch.m_dispatchQueue)
+		{
+			PathStr filePath("%s/%s", watch.m_dirPath.c_str(), file.first.c_str());
+			watch.m_dispatchCallback(filePath.c_str(), file.second);
+		}
+		watch.m_dispatchQueue.clear();
+
+	}
+	else
+	{
+		for (auto& it : s_WatchMap)
+		{
+			Watch& watch = *it.second;
+			for (auto& file : watch.m_dispatchQueue)
+			{
+				PathStr filePath("%s/%s", watch.m_dirPath.c_str(), file.first.c_str());
+				watch.m_dispatchCallback(filePath.c_str(), file.second);
+			}
+			watch.m_dispatchQueue.clear();
+		}
+	}
+}
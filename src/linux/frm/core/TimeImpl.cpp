@@ -0,0 +1,263 @@
+#include <frm/core/Time.h>
+
+#include <frm/core/memory.h>
+#include <frm/core/platform.h>
+#include <frm/core/String.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+
+using namespace frm;
+
+// DateTime raw values use the same units as the Windows implementation (100ns intervals since 1601-01-01), see FileSystemImpl.cpp.
+static constexpr sint64 kTicksPerSecond = 10000000ll;
+static constexpr sint64 kEpochOffset    = 116444736000000000ll; // 1601-01-01 -> 1970-01-01
+
+// Broken down time, equivalent to the Windows SYSTEMTIME.
+struct SystemTime
+{
+	sint32 year, month, day, hour, minute, second, millisecond;
+};
+
+// Split _raw into seconds since the Unix epoch and the remaining ticks.
+static time_t ToUnixTime(sint64 _raw, sint64& ticks_)
+{
+	sint64 t = _raw - kEpochOffset;
+	ticks_ = t % kTicksPerSecond;
+	if (ticks_ < 0)
+	{
+		ticks_ += kTicksPerSecond;
+	}
+	return (time_t)((t - ticks_) / kTicksPerSecond);
+}
+
+static sint64 FromUnixTime(time_t _time, sint64 _ticks)
+{
+	return (sint64)_time * kTicksPerSecond + _ticks + kEpochOffset;
+}
+
+static SystemTime ToSystemTime(sint64 _raw)
+{
+	sint64 ticks;
+	const time_t t = ToUnixTime(_raw, ticks);
+	tm tm = {};
+	gmtime_r(&t, &tm);
+
+	SystemTime ret;
+	ret.year        = tm.tm_year + 1900;
+	ret.month       = tm.tm_mon + 1;
+	ret.day         = tm.tm_mday;
+	ret.hour        = tm.tm_hour;
+	ret.minute      = tm.tm_min;
+	ret.second      = tm.tm_sec;
+	ret.millisecond = (sint32)(ticks / (kTicksPerSecond / 1000));
+	return ret;
+}
+
+static DateTime FromSystemTime(const SystemTime& _st)
+{
+	tm tm = {};
+	tm.tm_year = _st.year - 1900;
+	tm.tm_mon  = _st.month - 1;
+	tm.tm_mday = _st.day;
+	tm.tm_hour = _st.hour;
+	tm.tm_min  = _st.minute;
+	tm.tm_sec  = _st.second;
+	return DateTime(FromUnixTime(timegm(&tm), (sint64)_st.millisecond * (kTicksPerSecond / 1000)));
+}
+
+/*******************************************************************************
+
+                                 Time
+
+*******************************************************************************/
+
+static storage<Timestamp, 1> s_appInit;
+
+Timestamp Time::GetTimestamp()
+{
+	timespec ts;
+	FRM_PLATFORM_VERIFY(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+	return Timestamp((sint64)ts.tv_sec * 1000000000ll + (sint64)ts.tv_nsec);
+}
+
+sint64 Time::GetSystemFrequency()
+{
+	return 1000000000ll; // CLOCK_MONOTONIC, nanoseconds
+}
+
+DateTime Time::GetDateTime()
+{
+	timespec ts;
+	FRM_PLATFORM_VERIFY(clock_gettime(CLOCK_REALTIME, &ts) == 0);
+	return DateTime(FromUnixTime(ts.tv_sec, (sint64)ts.tv_nsec / 100ll));
+}
+
+DateTime Time::ToLocal(DateTime _utc)
+{
+	sint64 ticks;
+	const time_t utc = ToUnixTime(_utc.getRaw(), ticks);
+	tm local = {};
+	localtime_r(&utc, &local);
+	return DateTime(FromUnixTime(timegm(&local), ticks)); // local broken down time as if it were UTC
+}
+
+DateTime Time::ToUTC(DateTime _local)
+{
+	sint64 ticks;
+	const time_t local = ToUnixTime(_local.getRaw(), ticks);
+	tm tm = {};
+	gmtime_r(&local, &tm);
+	tm.tm_isdst = -1; // let mktime() determine DST
+	return DateTime(FromUnixTime(mktime(&tm), ticks));
+}
+
+Timestamp Time::GetApplicationElapsed()
+{
+	return GetTimestamp() - *s_appInit;
+}
+
+void Time::Sleep(sint64 _ms)
+{
+	timespec ts;
+	ts.tv_sec  = (time_t)(_ms / 1000ll);
+	ts.tv_nsec = (long)((_ms % 1000ll) * 1000000ll);
+	while (nanosleep(&ts, &ts) == -1 && errno == EINTR);
+}
+
+void Time::Init()
+{
+	*s_appInit = GetTimestamp();
+}
+
+void Time::Shutdown()
+{
+}
+
+/*******************************************************************************
+
+                                 Timestamp
+
+*******************************************************************************/
+
+double Timestamp::asSeconds() const
+{
+	return asMicroseconds() / 1000000.0;
+}
+
+double Timestamp::asMilliseconds() const
+{
+	return asMicroseconds() / 1000.0;
+}
+
+double Timestamp::asMicroseconds() const
+{
+	// m_raw is in nanoseconds (see GetSystemFrequency()), avoid m_raw * 1000000 which overflows after ~2.5 hours of uptime.
+	return (double)(m_raw / 1000ll);
+}
+
+/*******************************************************************************
+
+                                   DateTime
+
+*******************************************************************************/
+
+sint32 DateTime::getYear() const         { return ToSystemTime(m_raw).year; }
+sint32 DateTime::getMonth() const        { return ToSystemTime(m_raw).month; }
+sint32 DateTime::getDay() const          { return ToSystemTime(m_raw).day; }
+sint32 DateTime::getHour() const         { return ToSystemTime(m_raw).hour; }
+sint32 DateTime::getMinute() const       { return ToSystemTime(m_raw).minute; }
+sint32 DateTime::getSecond() const       { return ToSystemTime(m_raw).second; }
+sint32 DateTime::getMillisecond() const  { return ToSystemTime(m_raw).millisecond; }
+
+frm::DateTime::DateTime(const char* _str, const char* _format)
+{
+	_format = _format ? _format : "%Y-%m-%dT%H:%M:%SZ"; // default ISO 8601
+
+	SystemTime st = { 1601, 1, 1, 0, 0, 0, 0 };
+	while (*_format)
+	{
+		if (*_format == '%')
+		{
+			char* str;
+			switch (*(++_format))
+			{
+				case 'Y':
+					st.year = (sint32)strtol(_str, &str, 0);
+					break;
+				case 'm':
+					st.month = (sint32)strtol(_str, &str, 0);
+					break;
+				case 'd':
+					st.day = (sint32)strtol(_str, &str, 0);
+					break;
+				case 'H':
+					st.hour = (sint32)strtol(_str, &str, 0);
+					break;
+				case 'M':
+					st.minute = (sint32)strtol(_str, &str, 0);
+					break;
+				case 'S':
+					st.second = (sint32)strtol(_str, &str, 0);
+					break;
+				case 's':
+					st.millisecond = (sint32)strtol(_str, &str, 0);
+					break;
+				default:
+					break;
+			};
+			++_format;
+			_str = str;
+
+		}
+		else
+		{
+			FRM_ASSERT(*_str == *_format); // mismatch
+			++_format;
+			++_str;
+		}
+	}
+	*this = FromSystemTime(st);
+}
+
+
+const char* frm::DateTime::asString(const char* _format) const
+{
+	static String<128> s_buf;
+	SystemTime st = ToSystemTime(m_raw);
+	if (!_format) // default ISO 8601 format
+	{
+		s_buf.setf("%.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ", st.year, st.month, st.day, st.hour, st.minute, st.second);
+	}
+	else
+	{
+		s_buf.clear();
+		for (int i = 0; _format[i] != 0; ++i)
+		{
+			if (_format[i] == '%')
+			{
+				switch (_format[++i])
+				{
+					case 'Y': s_buf.appendf("%.4d", st.year);        break;
+					case 'm': s_buf.appendf("%.2d", st.month);       break;
+					case 'd': s_buf.appendf("%.2d", st.day);         break;
+					case 'H': s_buf.appendf("%.2d", st.hour);        break;
+					case 'M': s_buf.appendf("%.2d", st.minute);      break;
+					case 'S': s_buf.appendf("%.2d", st.second);      break;
+					case 's': s_buf.appendf("%.2d", st.millisecond); break;
+					default:
+						if (_format[i] != 0)
+						{
+							s_buf.append(&_format[i], 1);
+						}
+				};
+			}
+			else
+			{
+				s_buf.append(&_format[i], 1);
+			}
+		}
+	}
+	return (const char*)s_buf;
+}
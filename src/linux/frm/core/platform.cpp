@@ -0,0 +1,140 @@
+#include <frm/core/platform.h>
+
+#include <frm/core/memory.h>
+#include <frm/core/String.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <spawn.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace frm {
+
+const char* GetPlatformErrorString(uint64 _err)
+{
+	static thread_local String<1024> ret;
+	char buf[256] = {};
+	#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+		const char* msg = strerror_r((int)_err, buf, sizeof(buf)); // GNU variant, may return a static string instead of buf
+	#else
+		const char* msg = strerror_r((int)_err, buf, sizeof(buf)) == 0 ? buf : "Unknown error";
+	#endif
+	ret.setf("(%llu) %s", _err, msg);
+	return (const char*)ret;
+}
+
+const char* GetPlatformInfoString()
+{
+	static thread_local String<1024> ret;
+
+ // OS version
+	ret.appendf("\tOS:     ");
+	struct utsname osinf;
+	if (uname(&osinf) != 0)
+	{
+		ret.append((const char*)GetPlatformErrorString(errno));
+	}
+	else
+	{
+		ret.appendf("%s %s", osinf.sysname, osinf.release);
+	}
+
+ // cpu brand
+	String<64> cpustr = "Unknown";
+	if (FILE* cpuinf = fopen("/proc/cpuinfo", "r"))
+	{
+		char line[256];
+		while (fgets(line, sizeof(line), cpuinf))
+		{
+			if (strncmp(line, "model name", 10) == 0)
+			{
+				const char* beg = strchr(line, ':');
+				if (beg)
+				{
+					beg += 2;
+					cpustr.set(beg, (int)strcspn(beg, "\n"));
+				}
+				break;
+			}
+		}
+		fclose(cpuinf);
+	}
+	ret.appendf("\n\tCPU:    %s", (const char*)cpustr);
+
+ // proccessor count
+	ret.appendf(" (%ld cores)", sysconf(_SC_NPROCESSORS_ONLN));
+
+ // physical memory
+	ret.append("\n\tMemory: ");
+	const long pageCount = sysconf(_SC_PHYS_PAGES);
+	const long pageSize  = sysconf(_SC_PAGE_SIZE);
+	if (pageCount < 0 || pageSize < 0)
+	{
+		ret.append((const char*)GetPlatformErrorString(errno));
+	}
+	else
+	{
+		ret.appendf("%lluMb", (unsigned long long)pageCount * (unsigned long long)pageSize / 1024 / 1024);
+	}
+
+	return (const char*)ret;
+}
+
+PlatformHandle PlatformForkProcess(const char* _command)
+{
+	pid_t pid = 0;
+	char* argv[] = { (char*)"/bin/sh", (char*)"-c", (char*)_command, nullptr };
+	const int err = posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv, environ);
+	FRM_VERIFY_MSG(err == 0, GetPlatformErrorString((uint64)err));
+
+	return (PlatformHandle)(intptr_t)pid;
+}
+
+int PlatformJoinProcess(PlatformHandle _handle, int _timeoutMilliseconds)
+{
+	const pid_t pid = (pid_t)(intptr_t)_handle;
+	int status = 0;
+	if (_timeoutMilliseconds == PlatformJoinProcess_Infinite)
+	{
+		while (waitpid(pid, &status, 0) == -1)
+		{
+			FRM_PLATFORM_ASSERT(errno == EINTR);
+			if (errno != EINTR)
+			{
+				return PlatformJoinProcess_Timeout;
+			}
+		}
+	}
+	else
+	{
+	 // no waitpid() with a timeout, poll
+		const timespec sleepTime = { 0, 1000000 }; // 1ms
+		for (int elapsed = 0;; ++elapsed)
+		{
+			const pid_t result = waitpid(pid, &status, WNOHANG);
+			FRM_PLATFORM_ASSERT(result != -1);
+			if (result == pid)
+			{
+				break;
+			}
+			if (result == -1 || elapsed >= _timeoutMilliseconds)
+			{
+				return PlatformJoinProcess_Timeout;
+			}
+			nanosleep(&sleepTime, nullptr);
+		}
+	}
+
+	const int ret = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status); // shell convention for signals
+	FRM_ASSERT(ret != PlatformJoinProcess_Timeout); // conflicts with the retval meaning 'timed out'
+
+	return ret;
+}
+
+} // namespace frm
@@ -8,8 +8,6 @@
 #include <frm/core/String.h>
 #include <frm/core/TextParser.h>
 
-#include <utility> // swap
-
 namespace frm {
 
 File::File()
@@ -23,6 +21,7 @@ File::~File()
 	{
 		FRM_PLATFORM_VERIFY(CloseHandle((HANDLE)m_impl));
 	}
+	freeData();
 }
 
 bool File::Exists(const char* _path)
@@ -38,7 +37,8 @@ bool File::Read(File& file_, const char* _path)
 	}
 	FRM_ASSERT(_path);
 
-	eastl::vector<char> data;
+	char* data      = nullptr;
+	uint  dataSize  = 0;
 	bool  ret       = false;
 	DWORD err       = 0;
 	int   tryCount  = 5; // avoid sharing violations, especially when loading a file after a file change notification
@@ -78,14 +78,15 @@ bool File::Read(File& file_, const char* _path)
 		err = GetLastError();
 		goto File_Read_end;
 	}
-	data.resize((uint)li.QuadPart + 1);
+	dataSize = (uint)li.QuadPart + 1;
+	data = (char*)FRM_MALLOC(dataSize);
 
-	if (!ReadFile(h, data.data(), (DWORD)data.size() - 1, &bytesRead, 0)) // ReadFile can only read DWORD bytes
+	if (!ReadFile(h, data, (DWORD)dataSize - 1, &bytesRead, 0)) // ReadFile can only read DWORD bytes
 	{
 		err = GetLastError();
 		goto File_Read_end;
 	}
-	data.back() = '\0';
+	data[dataSize - 1] = '\0';
 
 	ret = true;
 	
@@ -95,13 +96,14 @@ bool File::Read(File& file_, const char* _path)
 		FRM_PLATFORM_VERIFY(CloseHandle((HANDLE)file_.m_impl));
 	}
 	
-	swap(file_.m_data, data);
+	file_.adoptData(data, dataSize, dataSize);
 	file_.setPath(_path);
 
 File_Read_end:
 	if (!ret) 
 	{
 		FRM_LOG_ERR("Error reading '%s':\n\t%s", _path, GetPlatformErrorString((uint64)err));
+		FRM_FREE(data);
 	}
 	if (h != INVALID_HANDLE_VALUE) 
 	{
@@ -110,6 +112,25 @@ File_Read_end:
 	return ret;
 }
 
+int File::ReadBatch(File* const files_[], int _count, bool results_[], ReadCallback* _callback, void* _callbackArg)
+{
+	int ret = 0;
+	for (int i = 0; i < _count; ++i)
+	{
+		const bool result = Read(*files_[i]);
+		if (results_)
+		{
+			results_[i] = result;
+		}
+		if (_callback)
+		{
+			_callback(i, result, _callbackArg);
+		}
+		ret += result ? 1 : 0;
+	}
+	return ret;
+}
+
 bool File::Write(const File& _file, const char* _path)
 {
 	if (!_path) 
@@ -151,7 +172,7 @@ bool File::Write(const File& _file, const char* _path)
 	}
 
 	DWORD dataSize = (DWORD)_file.getDataSize();
-	if (dataSize > 0 && _file.m_data[dataSize - 1] == '\0')
+	if (dataSize > 0 && _file.getData()[dataSize - 1] == '\0')
 	{
 		--dataSize;
 	}
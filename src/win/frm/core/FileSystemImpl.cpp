@@ -141,6 +141,16 @@ bool FileSystem::Delete(const char* _path)
 	return true;
 }
 
+bool FileSystem::RemoveDir(const char* _path)
+{
+	if (RemoveDirectory(_path) == 0)
+	{
+		FRM_LOG_ERR("RemoveDirectory(%s): %s", _path, GetPlatformErrorString(GetLastError()));
+		return false;
+	}
+	return true;
+}
+
 DateTime FileSystem::GetTimeCreated(const char* _path, int _rootHint)
 {
 	PathStr fullPath;
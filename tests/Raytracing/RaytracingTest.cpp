@@ -98,6 +98,7 @@ bool RaytracingTest::update()
 	}
 
 	ImGui::Checkbox("Draw Debug", &m_drawDebug);
+	ImGui::Checkbox("Validate (PhysX)", &m_validate);
 
 	ImGui::SetNextWindowSize(ImVec2(512, 512), ImGuiCond_Once);
 	if (ImGui::Begin("Output", nullptr, ImGuiWindowFlags_NoScrollbar))
@@ -157,6 +158,35 @@ bool RaytracingTest::update()
 		};
 
 		m_raytracingRenderer->raycast(rayList.data(), rayHitList.data(), rayList.size());
+
+		if (m_validate)
+		{
+			PROFILER_MARKER_CPU("Validate");
+
+			static eastl::vector<RaytracingRenderer::RayHit> referenceHitList;
+			referenceHitList.resize(rayCount);
+			const bool usePhysX = m_raytracingRenderer->getUsePhysX();
+			m_raytracingRenderer->setUsePhysX(!usePhysX);
+			m_raytracingRenderer->raycast(rayList.data(), referenceHitList.data(), rayList.size());
+			m_raytracingRenderer->setUsePhysX(usePhysX);
+
+			int mismatchCount = 0;
+			float maxDistanceError = 0.0f;
+			for (size_t i = 0; i < rayCount; ++i)
+			{
+				const RaytracingRenderer::RayHit& hit = rayHitList[i];
+				const RaytracingRenderer::RayHit& reference = referenceHitList[i];
+				if (hit.isHit != reference.isHit || (hit.isHit && (hit.instance != reference.instance || hit.triangleIndex != reference.triangleIndex)))
+				{
+					++mismatchCount;
+				}
+				else if (hit.isHit)
+				{
+					maxDistanceError = Max(maxDistanceError, abs(hit.distance - reference.distance));
+				}
+			}
+			ImGui::Text("Validation: %d/%d mismatches, max distance error %f", mismatchCount, (int)rayCount, maxDistanceError);
+		}
 		//m_raytracingRenderer->sortRayHits(rayHitList.data(), rayHitList.size()); // .22ms in release
 		buildHitMap(rayHitList.data(), rayHitList.size()); // .41ms in release, mostly sending the data to GL.
 		
@@ -29,6 +29,7 @@ protected:
 	ivec2               m_resolution         = ivec2(128);
 	float*              m_result             = nullptr;
 	bool                m_drawDebug          = true;
+	bool                m_validate           = false; // Compare BVH results against PhysX.
 	int                 m_rayThreadCount     = 8;
 	int                 m_raysPerThread      = 256;
 
@@ -0,0 +1,212 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/Log.h>
+#include <frm/core/rand.h>
+#include <frm/core/AtlasAllocator.h>
+#include <frm/core/Time.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+typedef AtlasAllocator::Rect Rect;
+
+bool Overlaps(const Rect& _a, const Rect& _b)
+{
+	return _a.x < _b.x + _b.w && _b.x < _a.x + _a.w && _a.y < _b.y + _b.h && _b.y < _a.y + _a.h;
+}
+
+// All rects are within the allocator and don't overlap.
+bool IsValid(const AtlasAllocator& _allocator)
+{
+	eastl::vector<Rect> rects;
+	_allocator.visit([&](const Rect& _rect) { rects.push_back(_rect); });
+	for (size_t i = 0; i < rects.size(); ++i)
+	{
+		if (rects[i].x + rects[i].w > _allocator.getWidth() || rects[i].y + rects[i].h > _allocator.getHeight())
+		{
+			return false;
+		}
+		for (size_t j = i + 1; j < rects.size(); ++j)
+		{
+			if (Overlaps(rects[i], rects[j]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Glyph-like sizes in [_min,_max].
+void RandomSize(Rand<>& _rand, uint16 _min, uint16 _max, uint16& w_, uint16& h_)
+{
+	w_ = (uint16)_rand.get<sint32>(_min, _max);
+	h_ = (uint16)_rand.get<sint32>(_min, _max);
+}
+
+} // namespace
+
+TEST_CASE("AllocFree", "[AtlasAllocator]")
+{
+	for (AtlasAllocator::Type type = 0; type < AtlasAllocator::Type_Count; ++type)
+	{
+		AtlasAllocator* allocator = AtlasAllocator::Create(type, 512, 256);
+		Rand<> rand;
+
+		Rect full;
+		REQUIRE(!allocator->alloc(513, 1, full));
+		REQUIRE(allocator->alloc(512, 256, full));
+		REQUIRE(full.x == 0);
+		REQUIRE(full.y == 0);
+		Rect rect;
+		REQUIRE(!allocator->alloc(1, 1, rect));
+		allocator->free(full);
+		REQUIRE(allocator->getStats().freeArea == 512 * 256);
+
+		// Fill, then free half at random and refill.
+		eastl::vector<Rect> rects;
+		for (int i = 0; i < 2000; ++i)
+		{
+			uint16 w, h;
+			RandomSize(rand, 4, 24, w, h);
+			if (allocator->alloc(w, h, rect))
+			{
+				REQUIRE(rect.w == w);
+				REQUIRE(rect.h == h);
+				rects.push_back(rect);
+			}
+		}
+		REQUIRE(IsValid(*allocator));
+		REQUIRE(allocator->getStats().allocationCount == rects.size());
+		for (size_t i = 0; i < rects.size() / 2; ++i)
+		{
+			size_t j = (size_t)rand.get<sint32>(0, (sint32)rects.size() - 1);
+			allocator->free(rects[j]);
+			rects.erase_unsorted(rects.begin() + j);
+		}
+		REQUIRE(allocator->getStats().allocationCount == rects.size());
+		for (int i = 0; i < 500; ++i)
+		{
+			uint16 w, h;
+			RandomSize(rand, 4, 24, w, h);
+			if (allocator->alloc(w, h, rect))
+			{
+				rects.push_back(rect);
+			}
+		}
+		REQUIRE(IsValid(*allocator));
+
+		// Freeing everything restores a single free rect.
+		for (const Rect& r : rects)
+		{
+			allocator->free(r);
+		}
+		AtlasAllocator::Stats stats = allocator->getStats();
+		REQUIRE(stats.allocationCount == 0);
+		REQUIRE(stats.usedArea == 0);
+		REQUIRE(stats.freeArea == 512 * 256);
+		REQUIRE(stats.fragmentation == 0.0f);
+
+		REQUIRE(allocator->alloc(100, 100, rect));
+		allocator->reset();
+		REQUIRE(allocator->getStats().allocationCount == 0);
+		REQUIRE(allocator->getStats().largestFreeArea == 512 * 256);
+
+		AtlasAllocator::Destroy(allocator);
+		REQUIRE(allocator == nullptr);
+	}
+}
+
+TEST_CASE("Compact", "[AtlasAllocator]")
+{
+	for (AtlasAllocator::Type type = 0; type < AtlasAllocator::Type_Count; ++type)
+	{
+		AtlasAllocator* allocator = AtlasAllocator::Create(type, 256, 256);
+		Rand<> rand;
+
+		eastl::vector<Rect> rects;
+		Rect rect;
+		for (int i = 0; i < 1000; ++i)
+		{
+			uint16 w, h;
+			RandomSize(rand, 2, 16, w, h);
+			if (allocator->alloc(w, h, rect))
+			{
+				rects.push_back(rect);
+			}
+		}
+		for (size_t i = 0; i < rects.size(); i += 2)
+		{
+			allocator->free(rects[i]);
+		}
+		const AtlasAllocator::Stats before = allocator->getStats();
+
+		eastl::vector<AtlasAllocator::Copy> copies;
+		AtlasAllocator* compacted = allocator->compact(copies);
+		REQUIRE(compacted != nullptr);
+		REQUIRE(compacted->getType() == type);
+		REQUIRE(IsValid(*compacted));
+
+		const AtlasAllocator::Stats after = compacted->getStats();
+		REQUIRE(after.allocationCount == before.allocationCount);
+		REQUIRE(after.usedArea == before.usedArea);
+		REQUIRE(after.largestFreeArea >= before.largestFreeArea);
+
+		// Each copy moves an existing allocation, sizes are preserved.
+		for (const AtlasAllocator::Copy& copy : copies)
+		{
+			REQUIRE(copy.src.w == copy.dst.w);
+			REQUIRE(copy.src.h == copy.dst.h);
+			bool found = false;
+			allocator->visit([&](const Rect& _rect) { found |= _rect.x == copy.src.x && _rect.y == copy.src.y; });
+			REQUIRE(found);
+		}
+
+		FRM_LOG("%-10s compact: %u moves, fragmentation %.3f -> %.3f, largest free %llu -> %llu",
+			AtlasAllocator::GetTypeName(type),
+			(uint32)copies.size(),
+			before.fragmentation, after.fragmentation,
+			(unsigned long long)before.largestFreeArea, (unsigned long long)after.largestFreeArea
+			);
+
+		AtlasAllocator::Destroy(compacted);
+		AtlasAllocator::Destroy(allocator);
+	}
+}
+
+TEST_CASE("PackingEfficiency", "[AtlasAllocator]")
+{
+	// Pack glyph-like rects until the first failure, compare occupancy and allocation time.
+	for (AtlasAllocator::Type type = 0; type < AtlasAllocator::Type_Count; ++type)
+	{
+		AtlasAllocator* allocator = AtlasAllocator::Create(type, 1024, 1024);
+		Rand<> rand;
+
+		{	FRM_AUTOTIMER("%s alloc", AtlasAllocator::GetTypeName(type));
+			Rect rect;
+			for (;;)
+			{
+				uint16 w, h;
+				RandomSize(rand, 8, 32, w, h);
+				if (!allocator->alloc(w, h, rect))
+				{
+					break;
+				}
+			}
+		}
+
+		const AtlasAllocator::Stats stats = allocator->getStats();
+		FRM_LOG("%-10s %u allocations, occupancy %.3f", AtlasAllocator::GetTypeName(type), stats.allocationCount, stats.occupancy);
+		REQUIRE(IsValid(*allocator));
+		if (type != AtlasAllocator::Type_Quadtree)
+		{
+			REQUIRE(stats.occupancy > 0.75f);
+		}
+
+		AtlasAllocator::Destroy(allocator);
+	}
+}
@@ -0,0 +1,168 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/BVH.h>
+#include <frm/core/math.h>
+#include <frm/core/rand.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+bool IntersectTriangle(const vec3& _origin, const vec3& _direction, const vec3* _triangle, float _tMax, float& t_)
+{
+	float t0;
+	vec2  barycentrics;
+	if (Intersect(Ray(_origin, _direction), Triangle(_triangle[0], _triangle[1], _triangle[2]), t0, barycentrics) && t0 < _tMax)
+	{
+		t_ = t0;
+		return true;
+	}
+	return false;
+}
+
+struct TestScene
+{
+	eastl::vector<vec3>       triangles;
+	eastl::vector<AlignedBox> triangleBounds;
+	eastl::vector<vec3>       rayOrigins;
+	eastl::vector<vec3>       rayDirections;
+	BVH                       bvh;
+
+	TestScene(uint32 _triangleCount, uint32 _rayCount)
+	{
+		Rand<> rnd;
+		for (uint32 i = 0; i < _triangleCount; ++i)
+		{
+			const vec3 center = vec3(rnd.get<float>(-50.0f, 50.0f), rnd.get<float>(-50.0f, 50.0f), rnd.get<float>(-50.0f, 50.0f));
+			AlignedBox& bounds = triangleBounds.push_back();
+			bounds.m_min = vec3( FLT_MAX);
+			bounds.m_max = vec3(-FLT_MAX);
+			for (int j = 0; j < 3; ++j)
+			{
+				const vec3 p = center + vec3(rnd.get<float>(-2.0f, 2.0f), rnd.get<float>(-2.0f, 2.0f), rnd.get<float>(-2.0f, 2.0f));
+				triangles.push_back(p);
+				bounds.m_min = Min(bounds.m_min, p);
+				bounds.m_max = Max(bounds.m_max, p);
+			}
+		}
+
+		// Rays are generated in coherent groups of 8 (same origin, similar directions) to exercise packet traversal.
+		for (uint32 i = 0; i < _rayCount; i += 8)
+		{
+			const vec3 origin = vec3(rnd.get<float>(-60.0f, 60.0f), rnd.get<float>(-60.0f, 60.0f), rnd.get<float>(-60.0f, 60.0f));
+			const vec3 target = vec3(rnd.get<float>(-30.0f, 30.0f), rnd.get<float>(-30.0f, 30.0f), rnd.get<float>(-30.0f, 30.0f));
+			for (uint32 j = 0; j < 8; ++j)
+			{
+				rayOrigins.push_back(origin);
+				rayDirections.push_back(Normalize(target + vec3(rnd.get<float>(-2.0f, 2.0f), rnd.get<float>(-2.0f, 2.0f), 0.0f) - origin));
+			}
+		}
+
+		bvh.build(triangleBounds.data(), _triangleCount);
+	}
+
+	float bruteForce(uint32 _rayIndex) const
+	{
+		float tMax = FLT_MAX;
+		for (uint32 i = 0; i < (uint32)triangleBounds.size(); ++i)
+		{
+			IntersectTriangle(rayOrigins[_rayIndex], rayDirections[_rayIndex], &triangles[i * 3], tMax, tMax);
+		}
+		return tMax;
+	}
+};
+
+} // namespace
+
+TEST_CASE("BVH build", "[BVH]")
+{
+	TestScene scene(5000, 0);
+
+	// Each primitive must be referenced by exactly 1 leaf and be contained by the leaf bounds.
+	eastl::vector<uint32> primitiveRefs(5000, 0u);
+	for (uint32 i = 0; i < scene.bvh.getNodeCount(); ++i)
+	{
+		const BVH::Node& node = scene.bvh.getNodes()[i];
+		if (!node.isLeaf())
+		{
+			continue;
+		}
+		for (uint32 j = node.m_first; j < node.m_first + node.m_count; ++j)
+		{
+			const uint32 primitiveIndex = scene.bvh.getPrimitiveIndices()[j];
+			++primitiveRefs[primitiveIndex];
+			const AlignedBox& bounds = scene.triangleBounds[primitiveIndex];
+			REQUIRE(bounds.m_min.x >= node.m_boundsMin.x);
+			REQUIRE(bounds.m_min.y >= node.m_boundsMin.y);
+			REQUIRE(bounds.m_min.z >= node.m_boundsMin.z);
+			REQUIRE(bounds.m_max.x <= node.m_boundsMax.x);
+			REQUIRE(bounds.m_max.y <= node.m_boundsMax.y);
+			REQUIRE(bounds.m_max.z <= node.m_boundsMax.z);
+		}
+	}
+	for (uint32 refs : primitiveRefs)
+	{
+		REQUIRE(refs == 1);
+	}
+	REQUIRE(scene.bvh.getDepth() < BVH::kMaxDepth);
+}
+
+TEST_CASE("BVH traversal", "[BVH]")
+{
+	TestScene scene(5000, 4096);
+	const uint32 rayCount = (uint32)scene.rayOrigins.size();
+
+	// Closest hit, any hit.
+	for (uint32 i = 0; i < rayCount; ++i)
+	{
+		const float reference = scene.bruteForce(i);
+
+		float tMax = FLT_MAX;
+		scene.bvh.traverse(scene.rayOrigins[i], scene.rayDirections[i], tMax,
+			[&](uint32 _primitiveIndex, float& tMax_) -> bool
+			{
+				IntersectTriangle(scene.rayOrigins[i], scene.rayDirections[i], &scene.triangles[_primitiveIndex * 3], tMax_, tMax_);
+				return false;
+			});
+		REQUIRE(tMax == reference);
+
+		float tAny = FLT_MAX;
+		const bool anyHit = scene.bvh.traverse(scene.rayOrigins[i], scene.rayDirections[i], tAny,
+			[&](uint32 _primitiveIndex, float& tMax_) -> bool
+			{
+				return IntersectTriangle(scene.rayOrigins[i], scene.rayDirections[i], &scene.triangles[_primitiveIndex * 3], tMax_, tMax_);
+			});
+		REQUIRE(anyHit == (reference != FLT_MAX));
+	}
+
+	// Packets.
+	for (uint32 i = 0; i < rayCount; i += 8)
+	{
+		float tMax[8];
+		for (float& t : tMax)
+		{
+			t = FLT_MAX;
+		}
+		const uint32 rayMask = 0xbf; // Ray 6 inactive.
+		scene.bvh.traversePacket<8>(&scene.rayOrigins[i], &scene.rayDirections[i], tMax, rayMask,
+			[&](uint32 _primitiveIndex, uint32 _rayMask) -> uint32
+			{
+				for (uint32 j = 0; j < 8; ++j)
+				{
+					if (_rayMask & (1u << j))
+					{
+						IntersectTriangle(scene.rayOrigins[i + j], scene.rayDirections[i + j], &scene.triangles[_primitiveIndex * 3], tMax[j], tMax[j]);
+					}
+				}
+				return 0u;
+			});
+
+		for (uint32 j = 0; j < 8; ++j)
+		{
+			REQUIRE(tMax[j] == ((rayMask & (1u << j)) ? scene.bruteForce(i + j) : FLT_MAX));
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/geom.h>
+#include <frm/core/math.h>
+#include <frm/core/rand.h>
+#include <frm/core/BasicRenderer/BasicRenderer.h>
+
+#include <EASTL/vector.h>
+
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+struct Bounds
+{
+	eastl::vector<float> bsX, bsY, bsZ, bsRadius;
+	eastl::vector<float> bbMinX, bbMinY, bbMinZ, bbMaxX, bbMaxY, bbMaxZ;
+
+	void push(const Sphere& _bs, const AlignedBox& _bb)
+	{
+		bsX.push_back(_bs.m_origin.x);
+		bsY.push_back(_bs.m_origin.y);
+		bsZ.push_back(_bs.m_origin.z);
+		bsRadius.push_back(_bs.m_radius);
+		bbMinX.push_back(_bb.m_min.x);
+		bbMinY.push_back(_bb.m_min.y);
+		bbMinZ.push_back(_bb.m_min.z);
+		bbMaxX.push_back(_bb.m_max.x);
+		bbMaxY.push_back(_bb.m_max.y);
+		bbMaxZ.push_back(_bb.m_max.z);
+	}
+
+	uint32 size() const { return (uint32)bsX.size(); }
+};
+
+} // namespace
+
+TEST_CASE("CullBounds", "[BasicRenderer]")
+{
+	Frustum frustum(0.6f, -0.6f, 1.0f, -1.0f, 0.1f, 100.0f, false);
+	frustum.transform(LookAt(vec3(1.0f, 2.0f, 3.0f), vec3(0.0f, 0.0f, -20.0f)));
+
+	Rand<> rnd;
+	Bounds bounds;
+
+	// Bounds straddling each plane: centered on the plane at the center of the frustum face, and offset either side by a fraction of
+	// the size. Faces are listed per Frustum::FrustumPlane, see the vertex order in geom.h.
+	const int faces[Frustum::Plane_Count][4] =
+	{
+		{ 0, 1, 2, 3 }, // near
+		{ 4, 5, 6, 7 }, // far
+		{ 0, 1, 5, 4 }, // top
+		{ 1, 2, 6, 5 }, // right
+		{ 2, 3, 7, 6 }, // bottom
+		{ 3, 0, 4, 7 }, // left
+	};
+	for (int plane = 0; plane < Frustum::Plane_Count; ++plane)
+	{
+		vec3 faceCenter = vec3(0.0f);
+		for (int vertex : faces[plane])
+		{
+			faceCenter += frustum.m_vertices[vertex] * 0.25f;
+		}
+		const vec3 normal = frustum.m_planes[plane].m_normal;
+		for (float offset : { -2.0f, -1.0f, -0.999f, -0.5f, 0.0f, 0.5f, 0.999f, 1.0f, 2.0f })
+		{
+			const float size = rnd.get<float>(0.1f, 5.0f);
+			const vec3 center = faceCenter + normal * offset * size;
+			const vec3 extents = vec3(rnd.get<float>(0.1f, 1.0f), rnd.get<float>(0.1f, 1.0f), rnd.get<float>(0.1f, 1.0f)) * size;
+			bounds.push(Sphere(center, size), AlignedBox(center - extents, center + extents));
+		}
+	}
+
+	// Random bounds. The sphere encloses the box as per BasicRenderableComponent, or is independent of it such that the sphere and
+	// box results differ.
+	while (bounds.size() < BasicRenderer::kCullChunkSize * 4)
+	{
+		const vec3 center  = vec3(rnd.get<float>(-120.0f, 120.0f), rnd.get<float>(-120.0f, 120.0f), rnd.get<float>(-120.0f, 120.0f));
+		const vec3 extents = vec3(rnd.get<float>(0.0f, 10.0f), rnd.get<float>(0.0f, 10.0f), rnd.get<float>(0.0f, 10.0f));
+		const AlignedBox bb(center - extents, center + extents);
+		if (rnd.get<float>() < 0.5f)
+		{
+			bounds.push(Sphere(center, Length(extents)), bb);
+		}
+		else
+		{
+			const vec3 bsCenter = vec3(rnd.get<float>(-120.0f, 120.0f), rnd.get<float>(-120.0f, 120.0f), rnd.get<float>(-120.0f, 120.0f));
+			bounds.push(Sphere(bsCenter, rnd.get<float>(0.0f, 10.0f)), bb);
+		}
+	}
+
+	uint32 visibleCount = 0;
+	uint32 culledCount = 0;
+	for (uint32 count : { 0u, 1u, 7u, 31u, 32u, 33u, 100u, BasicRenderer::kCullChunkSize - 1, BasicRenderer::kCullChunkSize })
+	{
+		for (uint32 begin = 0; begin + count <= bounds.size(); begin += BasicRenderer::kCullChunkSize - 3)
+		{
+			const SphereSoA spheres = { &bounds.bsX[begin], &bounds.bsY[begin], &bounds.bsZ[begin], &bounds.bsRadius[begin] };
+			const AlignedBoxSoA boxes = { &bounds.bbMinX[begin], &bounds.bbMinY[begin], &bounds.bbMinZ[begin], &bounds.bbMaxX[begin], &bounds.bbMaxY[begin], &bounds.bbMaxZ[begin] };
+			uint32 visible[(BasicRenderer::kCullChunkSize + 31) / 32];
+			memset(visible, 0xff, sizeof(visible));
+			BasicRenderer::CullBounds(frustum, spheres, boxes, count, visible);
+
+			for (uint32 i = begin; i < begin + count; ++i)
+			{
+				const Sphere bs(vec3(bounds.bsX[i], bounds.bsY[i], bounds.bsZ[i]), bounds.bsRadius[i]);
+				const AlignedBox bb(vec3(bounds.bbMinX[i], bounds.bbMinY[i], bounds.bbMinZ[i]), vec3(bounds.bbMaxX[i], bounds.bbMaxY[i], bounds.bbMaxZ[i]));
+				const bool reference = frustum.insideIgnoreNear(bs) && frustum.insideIgnoreNear(bb);
+				const uint32 j = i - begin;
+				REQUIRE(reference == ((visible[j / 32] & (1u << (j % 32))) != 0));
+				++(reference ? visibleCount : culledCount);
+			}
+		}
+	}
+
+	// Both outcomes were tested.
+	REQUIRE(visibleCount > 0);
+	REQUIRE(culledCount > 0);
+}
@@ -0,0 +1,217 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/CookedMesh.h>
+#include <frm/core/File.h>
+
+#include <EASTL/vector.h>
+
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+// Grid of _n * _n vertices with positions (float3), normals (sint16N x4) and UVs (float16 x2, not a multiple of 4 bytes).
+struct TestMesh
+{
+	eastl::vector<float>  positions;
+	eastl::vector<sint16> normals;
+	eastl::vector<uint16> uvs;
+	eastl::vector<uint16> indices;
+	eastl::vector<uint16> lod1Indices;
+	uint32                vertexCount = 0;
+
+	void init(int _n)
+	{
+		vertexCount = (uint32)(_n * _n);
+		for (int y = 0; y < _n; ++y)
+		{
+			for (int x = 0; x < _n; ++x)
+			{
+				positions.push_back((float)x);
+				positions.push_back(0.0f);
+				positions.push_back((float)y);
+				normals.push_back(0);
+				normals.push_back(32767);
+				normals.push_back((sint16)(x * 31));
+				normals.push_back(0);
+				uvs.push_back((uint16)(x * 100));
+			}
+		}
+		for (int y = 0; y < _n - 1; ++y)
+		{
+			for (int x = 0; x < _n - 1; ++x)
+			{
+				const uint16 i = (uint16)(y * _n + x);
+				for (uint16 index : { i, (uint16)(i + _n), (uint16)(i + 1), (uint16)(i + 1), (uint16)(i + _n), (uint16)(i + _n + 1) })
+				{
+					indices.push_back(index);
+				}
+			}
+		}
+		lod1Indices.assign(indices.begin(), indices.begin() + indices.size() / 2);
+	}
+
+	void cook(CookedMesh& cooked_, Mesh::Primitive _primitive = Mesh::Primitive_Triangles)
+	{
+		cooked_.primitive     = _primitive;
+		cooked_.indexDataType = DataType_Uint16;
+		cooked_.vertexCount   = vertexCount;
+
+		auto AddStream = [&cooked_](Mesh::VertexDataSemantic _semantic, DataType _dataType, int _dataCount, const void* _data)
+			{
+				CookedMesh::VertexStream& stream = cooked_.vertexStreams.push_back();
+				CookedMesh::VertexAttribute& attribute = stream.attributes.push_back();
+				attribute.semantic = _semantic;
+				attribute.dataType = _dataType;
+				attribute.dataCount = (uint8)_dataCount;
+				stream.vertexSizeBytes = (uint8)(DataTypeSizeBytes(_dataType) * _dataCount);
+				stream.data = (const char*)_data;
+			};
+		AddStream(Mesh::Semantic_Positions,   DataType_Float32, 3, positions.data());
+		AddStream(Mesh::Semantic_Normals,     DataType_Sint16N, 4, normals.data());
+		AddStream(Mesh::Semantic_MaterialUVs, DataType_Float16, 1, uvs.data());
+		cooked_.vertexStreams[0].attributes[0].quantization = Mesh::Quantization_Range16;
+		cooked_.vertexStreams[0].attributes[0].quantizationScale = vec4(2.0f, 3.0f, 4.0f, 1.0f);
+		cooked_.vertexStreams[0].attributes[0].quantizationBias = vec4(-1.0f, 0.0f, 1.0f, 0.0f);
+
+		CookedMesh::LOD& lod0 = cooked_.lods.push_back();
+		lod0.submeshes.resize(2);
+		lod0.submeshes[0].indexCount = (uint32)indices.size();
+		lod0.submeshes[0].boundingBox.m_min = vec3(0.0f);
+		lod0.submeshes[0].boundingBox.m_max = vec3(1.0f, 2.0f, 3.0f);
+		lod0.submeshes[0].boundingSphere.m_origin = vec3(0.5f);
+		lod0.submeshes[0].boundingSphere.m_radius = 4.0f;
+		lod0.submeshes[1].indexOffset = 6;
+		lod0.submeshes[1].indexCount = 12;
+		lod0.indexData = (const char*)indices.data();
+
+		CookedMesh::LOD& lod1 = cooked_.lods.push_back();
+		lod1.submeshes.resize(1);
+		lod1.submeshes[0].indexCount = (uint32)lod1Indices.size();
+		lod1.indexData = (const char*)lod1Indices.data();
+	}
+};
+
+bool IsAligned(const void* _ptr)
+{
+	return (uintptr_t)_ptr % CookedMesh::kAlignment == 0;
+}
+
+} // namespace
+
+TEST_CASE("RoundTrip", "[CookedMesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(64);
+
+	const char userData[] = "user data";
+
+	for (CookedMesh::Flags flags : { CookedMesh::Flags_None, CookedMesh::Flags_Compress })
+	{
+		File file;
+		{	CookedMesh src;
+			testMesh.cook(src);
+			src.userData = userData;
+			src.userDataSizeBytes = sizeof(userData);
+			REQUIRE(CookedMesh::Write(src, file, flags));
+		}
+		REQUIRE(CookedMesh::IsCooked(file));
+
+		CookedMesh dst;
+		REQUIRE(CookedMesh::Read(dst, file));
+		REQUIRE(dst.primitive == Mesh::Primitive_Triangles);
+		REQUIRE(dst.indexDataType == DataType_Uint16);
+		REQUIRE(dst.vertexCount == testMesh.vertexCount);
+
+		REQUIRE(dst.vertexStreams.size() == 3);
+		REQUIRE(dst.vertexStreams[1].attributes.size() == 1);
+		REQUIRE(dst.vertexStreams[1].attributes[0].semantic == Mesh::Semantic_Normals);
+		REQUIRE(dst.vertexStreams[1].attributes[0].dataType == DataType_Sint16N);
+		REQUIRE(dst.vertexStreams[1].attributes[0].dataCount == 4);
+		REQUIRE(dst.vertexStreams[1].attributes[0].quantization == Mesh::Quantization_None);
+		REQUIRE(dst.vertexStreams[0].attributes[0].quantization == Mesh::Quantization_Range16);
+		REQUIRE(dst.vertexStreams[0].attributes[0].quantizationScale == vec4(2.0f, 3.0f, 4.0f, 1.0f));
+		REQUIRE(dst.vertexStreams[0].attributes[0].quantizationBias == vec4(-1.0f, 0.0f, 1.0f, 0.0f));
+		REQUIRE(memcmp(dst.vertexStreams[0].data, testMesh.positions.data(), testMesh.positions.size() * sizeof(float)) == 0);
+		REQUIRE(memcmp(dst.vertexStreams[1].data, testMesh.normals.data(), testMesh.normals.size() * sizeof(sint16)) == 0);
+		REQUIRE(memcmp(dst.vertexStreams[2].data, testMesh.uvs.data(), testMesh.uvs.size() * sizeof(uint16)) == 0);
+
+		REQUIRE(dst.lods.size() == 2);
+		REQUIRE(dst.lods[0].submeshes.size() == 2);
+		REQUIRE(dst.lods[0].submeshes[1].indexOffset == 6);
+		REQUIRE(dst.lods[0].submeshes[1].indexCount == 12);
+		REQUIRE(dst.lods[0].submeshes[0].boundingBox.m_max == vec3(1.0f, 2.0f, 3.0f));
+		REQUIRE(dst.lods[0].submeshes[0].boundingSphere.m_radius == 4.0f);
+		REQUIRE(memcmp(dst.lods[0].indexData, testMesh.indices.data(), testMesh.indices.size() * sizeof(uint16)) == 0);
+		REQUIRE(memcmp(dst.lods[1].indexData, testMesh.lod1Indices.data(), testMesh.lod1Indices.size() * sizeof(uint16)) == 0);
+
+		REQUIRE(dst.userDataSizeBytes == sizeof(userData));
+		REQUIRE(memcmp(dst.userData, userData, sizeof(userData)) == 0);
+
+		for (const CookedMesh::VertexStream& stream : dst.vertexStreams)
+		{
+			REQUIRE(IsAligned(stream.data));
+		}
+		for (const CookedMesh::LOD& lod : dst.lods)
+		{
+			REQUIRE(IsAligned(lod.indexData));
+		}
+
+		// Uncompressed data is referenced directly from the file. Streams whose vertex size isn't a multiple of 4 are never compressed.
+		const char* fileBegin = file.getData();
+		const char* fileEnd = fileBegin + file.getDataSize();
+		auto IsInFile = [fileBegin, fileEnd](const char* _ptr) { return _ptr >= fileBegin && _ptr < fileEnd; };
+		REQUIRE(IsInFile(dst.vertexStreams[2].data));
+		REQUIRE(IsInFile(dst.vertexStreams[0].data) == (flags == CookedMesh::Flags_None));
+		REQUIRE(IsInFile(dst.lods[0].indexData) == (flags == CookedMesh::Flags_None));
+	}
+}
+
+TEST_CASE("Lines", "[CookedMesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(16);
+	testMesh.indices.resize(testMesh.indices.size() - 2); // not a multiple of 3, the index sequence codec is used
+
+	File file;
+	{	CookedMesh src;
+		testMesh.cook(src, Mesh::Primitive_Lines);
+		src.lods.resize(1);
+		src.lods[0].submeshes.resize(1);
+		src.lods[0].submeshes[0].indexCount = (uint32)testMesh.indices.size();
+		REQUIRE(CookedMesh::Write(src, file, CookedMesh::Flags_Compress));
+	}
+
+	CookedMesh dst;
+	REQUIRE(CookedMesh::Read(dst, file));
+	REQUIRE(dst.primitive == Mesh::Primitive_Lines);
+	REQUIRE(dst.lods[0].submeshes[0].indexCount == testMesh.indices.size());
+	REQUIRE(memcmp(dst.lods[0].indexData, testMesh.indices.data(), testMesh.indices.size() * sizeof(uint16)) == 0);
+}
+
+TEST_CASE("Invalid", "[CookedMesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(8);
+
+	File file;
+	{	CookedMesh src;
+		testMesh.cook(src);
+		REQUIRE(CookedMesh::Write(src, file, CookedMesh::Flags_Compress));
+	}
+
+	// Truncated.
+	File truncated;
+	truncated.setData(file.getData(), file.getDataSize() / 2);
+	CookedMesh dst;
+	REQUIRE(!CookedMesh::Read(dst, truncated));
+	REQUIRE(dst.vertexStreams.empty());
+
+	// Not a cooked mesh.
+	File text;
+	text.setData("{ \"json\": true }", 17);
+	REQUIRE(!CookedMesh::IsCooked(text));
+	REQUIRE(!CookedMesh::Read(dst, text));
+}
@@ -0,0 +1,269 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/types.h>
+
+#include <EASTL/vector.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+float AsFloat(uint32 _u)
+{
+	float ret;
+	memcpy(&ret, &_u, sizeof(ret));
+	return ret;
+}
+
+uint32 AsUint(float _f)
+{
+	uint32 ret;
+	memcpy(&ret, &_f, sizeof(ret));
+	return ret;
+}
+
+// Random source data: floats in [-1.5, 1.5] plus a few special values, random bits for all other types.
+eastl::vector<char> RandomData(DataType _type, uint _count)
+{
+	eastl::vector<char> ret(DataTypeSizeBytes(_type) * _count);
+	if (_type == DataType_Float32)
+	{
+		float* f = (float*)ret.data();
+		for (uint i = 0; i < _count; ++i)
+		{
+			f[i] = ((float)rand() / (float)RAND_MAX) * 3.0f - 1.5f;
+		}
+		const float specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 1e-6f, -1e-6f, 65504.0f, -65520.0f, 1e30f, -1e30f };
+		for (uint i = 0; i < sizeof(specials) / sizeof(float) && i < _count; ++i)
+		{
+			f[i * 7 % _count] = specials[i];
+		}
+	}
+	else
+	{
+		for (char& c : ret)
+		{
+			c = (char)rand();
+		}
+		if (_type == DataType_Float16)
+		{
+		 // avoid NaN, payloads may legitimately differ
+			uint16* h = (uint16*)ret.data();
+			for (uint i = 0; i < _count; ++i)
+			{
+				if ((h[i] & 0x7c00) == 0x7c00)
+				{
+					h[i] &= 0xbfff;
+				}
+			}
+		}
+	}
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE("Float16", "[DataTypeConvert]")
+{
+	REQUIRE(PackFloat16(0.0f)     == 0x0000);
+	REQUIRE(PackFloat16(-0.0f)    == 0x8000);
+	REQUIRE(PackFloat16(1.0f)     == 0x3c00);
+	REQUIRE(PackFloat16(-2.0f)    == 0xc000);
+	REQUIRE(PackFloat16(65504.0f) == 0x7bff);
+	REQUIRE(PackFloat16(65520.0f) == 0x7c00); // rounds to infinity
+	REQUIRE(PackFloat16(1e10f)    == 0x7c00);
+	REQUIRE(PackFloat16(ldexpf(1.0f, -24))   == 0x0001); // smallest denormal
+	REQUIRE(PackFloat16(ldexpf(1.0f, -25))   == 0x0000); // tie, round to even
+	REQUIRE(PackFloat16(ldexpf(1.5f, -25))   == 0x0001);
+	REQUIRE(PackFloat16(1.0f + ldexpf(1.0f, -11)) == 0x3c00); // tie, round to even
+	REQUIRE(PackFloat16(1.0f + ldexpf(3.0f, -11)) == 0x3c02); // tie, round to even
+	REQUIRE((PackFloat16(AsFloat(0x7fc00000)) & 0x7e00) == 0x7e00);
+
+	// All non-NaN values round trip, denormals are preserved.
+	for (uint32 h = 0; h < 0x10000; ++h)
+	{
+		if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0)
+		{
+			REQUIRE(std::isnan(UnpackFloat16((uint16)h)));
+			continue;
+		}
+		REQUIRE(PackFloat16(UnpackFloat16((uint16)h)) == h);
+	}
+
+	// Unpacking is bit exact (compare bits, -0 == 0).
+	REQUIRE(AsUint(UnpackFloat16(0x0000)) == 0x00000000);
+	REQUIRE(AsUint(UnpackFloat16(0x8000)) == 0x80000000);
+	REQUIRE(AsUint(UnpackFloat16(0x0001)) == AsUint(ldexpf(1.0f, -24)));
+	REQUIRE(AsUint(UnpackFloat16(0x8001)) == AsUint(-ldexpf(1.0f, -24)));
+	REQUIRE(AsUint(UnpackFloat16(0x7c00)) == 0x7f800000);
+	REQUIRE(AsUint(UnpackFloat16(0xfc00)) == 0xff800000);
+	REQUIRE(AsUint(UnpackFloat16(0x3555)) == 0x3eaaa000);
+
+	// Bulk conversion (F16C if available) round trips all values bit exactly and matches UnpackFloat16().
+	eastl::vector<uint16> halves(0x10000);
+	for (uint32 h = 0; h < 0x10000; ++h)
+	{
+		halves[h] = (uint16)h;
+	}
+	eastl::vector<float> floats(halves.size());
+	eastl::vector<uint16> roundTrip(halves.size());
+	DataTypeConvert(DataType_Float16, DataType_Float32, halves.data(), floats.data(), (uint)halves.size());
+	DataTypeConvert(DataType_Float32, DataType_Float16, floats.data(), roundTrip.data(), (uint)halves.size());
+	for (uint32 h = 0; h < 0x10000; ++h)
+	{
+		if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0)
+		{
+			REQUIRE(std::isnan(floats[h]));
+			REQUIRE((roundTrip[h] & 0x7e00) == 0x7e00);
+			continue;
+		}
+		REQUIRE(AsUint(floats[h]) == AsUint(UnpackFloat16((uint16)h)));
+		REQUIRE(roundTrip[h] == h);
+	}
+
+	// Every float rounds to the nearest half (sample the whole range).
+	for (uint32 u = 0; u < 0x7f800000; u += 0x1231)
+	{
+		const float f = AsFloat(u);
+		const uint16 h = PackFloat16(f);
+		if (f >= 65520.0f)
+		{
+			REQUIRE(h == 0x7c00);
+			continue;
+		}
+		const float err = fabsf(UnpackFloat16(h) - f);
+		REQUIRE(err <= fabsf(UnpackFloat16((uint16)(h + 1)) - f));
+		if (h > 0)
+		{
+			REQUIRE(err <= fabsf(UnpackFloat16((uint16)(h - 1)) - f));
+		}
+	}
+}
+
+TEST_CASE("Bulk", "[DataTypeConvert]")
+{
+	const DataType types[] =
+	{
+		DataType_Sint8,  DataType_Uint8,  DataType_Sint16,  DataType_Uint16,  DataType_Sint32, DataType_Uint32,
+		DataType_Sint8N, DataType_Uint8N, DataType_Sint16N, DataType_Uint16N, DataType_Uint32N,
+		DataType_Float16, DataType_Float32, DataType_Float64
+	};
+	const uint kCount = 1000 + 27; // not a multiple of any vector width
+
+	// Bulk conversion (SIMD + scalar remainder) matches per-element conversion (scalar only) for all pairs.
+	srand(1);
+	for (DataType srcType : types)
+	{
+		const eastl::vector<char> src = RandomData(srcType, kCount);
+		for (DataType dstType : types)
+		{
+			const uint dstSize = DataTypeSizeBytes(dstType);
+			eastl::vector<char> bulk(dstSize * kCount);
+			eastl::vector<char> scalar(dstSize * kCount);
+			DataTypeConvert(srcType, dstType, src.data(), bulk.data(), kCount);
+			for (uint i = 0; i < kCount; ++i)
+			{
+				DataTypeConvert(srcType, dstType, src.data() + i * DataTypeSizeBytes(srcType), scalar.data() + i * dstSize, 1);
+			}
+			INFO(DataTypeString(srcType) << " -> " << DataTypeString(dstType));
+			REQUIRE(memcmp(bulk.data(), scalar.data(), bulk.size()) == 0);
+		}
+	}
+
+	// Normalized types.
+	const float f[] = { 1.0f, -1.0f, 0.5f, 2.0f, -0.25f, 0.0f, 0.999f, -0.999f };
+	uint8  u8[8];
+	sint16 s16[8];
+	DataTypeConvert(DataType_Float32, DataType_Uint8N, f, u8, 8);
+	DataTypeConvert(DataType_Float32, DataType_Sint16N, f, s16, 8);
+	const uint8  u8Expected[8]  = { 255, 0, 127, 255, 0, 0, 254, 0 };
+	const sint16 s16Expected[8] = { 32767, -32768, 16383, 32767, -8192, 0, 32734, -32735 };
+	REQUIRE(memcmp(u8, u8Expected, sizeof(u8)) == 0);
+	REQUIRE(memcmp(s16, s16Expected, sizeof(s16)) == 0);
+
+	float back[8];
+	DataTypeConvert(DataType_Sint16N, DataType_Float32, s16, back, 8);
+	REQUIRE(back[0] == 1.0f);
+	REQUIRE(back[1] == -1.0f);
+	REQUIRE(back[4] == -0.25f);
+
+	// 8 <-> 16 bit normalized rescale.
+	eastl::vector<uint16> u16(0x10000);
+	for (uint i = 0; i < u16.size(); ++i)
+	{
+		u16[i] = (uint16)i;
+	}
+	eastl::vector<uint8> u16To8(u16.size());
+	DataTypeConvert(DataType_Uint16N, DataType_Uint8N, u16.data(), u16To8.data(), (uint)u16.size());
+	for (uint i = 0; i < u16.size(); ++i)
+	{
+		REQUIRE(u16To8[i] == i / 257);
+	}
+	uint8 u8All[256];
+	uint16 u8To16[256];
+	for (uint i = 0; i < 256; ++i)
+	{
+		u8All[i] = (uint8)i;
+	}
+	DataTypeConvert(DataType_Uint8N, DataType_Uint16N, u8All, u8To16, 256);
+	for (uint i = 0; i < 256; ++i)
+	{
+		REQUIRE(u8To16[i] == i * 257);
+	}
+	REQUIRE(DataTypeConvert<uint16N>(uint8N(255)) == 65535);
+	REQUIRE(DataTypeConvert<uint8N>(uint16N(65535)) == 255);
+	REQUIRE(DataTypeConvert<uint8N>(sint8N(-5)) == 0);
+	REQUIRE(DataTypeConvert<sint16N>(sint8N(-128)) == -32768);
+	REQUIRE(DataTypeConvert<sint16N>(sint8N(127)) == 32767);
+
+	// Float16 via the templated conversion.
+	REQUIRE((uint16)DataTypeConvert<float16>(0.5f) == 0x3800);
+	REQUIRE(DataTypeConvert<float32>(float16(0x3800)) == 0.5f);
+	REQUIRE(DataTypeConvert<uint8N>(float16(0x3c00)) == 255);
+}
+
+TEST_CASE("Components", "[DataTypeConvert]")
+{
+	const uint8 rgb[] = { 255, 0, 51, 0, 255, 102 };
+
+	// Expand, alpha is 1.
+	float rgba[8];
+	DataTypeConvert(DataType_Uint8N, 3, DataType_Float32, 4, rgb, rgba, 2);
+	const float rgbaExpected[8] = { 1.0f, 0.0f, 0.2f, 1.0f, 0.0f, 1.0f, 0.4f, 1.0f };
+	REQUIRE(memcmp(rgba, rgbaExpected, sizeof(rgba)) == 0);
+
+	// R -> RGBA is (r, 0, 0, 1).
+	uint16 r16[4];
+	DataTypeConvert(DataType_Uint8N, 1, DataType_Float16, 4, rgb, r16, 1);
+	REQUIRE(r16[0] == 0x3c00);
+	REQUIRE(r16[1] == 0);
+	REQUIRE(r16[2] == 0);
+	REQUIRE(r16[3] == 0x3c00);
+
+	// Swizzle BGR -> RGB0, same type.
+	const int bgr0[] = { 2, 1, 0, DataTypeSwizzle_Zero };
+	uint8 swizzled[8];
+	DataTypeConvert(DataType_Uint8N, 3, DataType_Uint8N, 4, rgb, swizzled, 2, bgr0);
+	const uint8 swizzledExpected[8] = { 51, 0, 255, 0, 102, 255, 0, 0 };
+	REQUIRE(memcmp(swizzled, swizzledExpected, sizeof(swizzled)) == 0);
+
+	// Reduce, large enough to span several blocks.
+	eastl::vector<float>  src(5000 * 4);
+	eastl::vector<uint16> dst(5000 * 2);
+	for (uint i = 0; i < src.size(); ++i)
+	{
+		src[i] = (float)(i % 4) * 0.25f;
+	}
+	const int ga[] = { 1, 3 };
+	DataTypeConvert(DataType_Float32, 4, DataType_Uint16N, 2, src.data(), dst.data(), 5000, ga);
+	for (uint i = 0; i < 5000; ++i)
+	{
+		REQUIRE(dst[i * 2 + 0] == 16383);
+		REQUIRE(dst[i * 2 + 1] == 49151);
+	}
+}
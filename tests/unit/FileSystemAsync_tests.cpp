@@ -0,0 +1,300 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/File.h>
+#include <frm/core/FileSystem.h>
+#include <frm/core/FileSystemAsync.h>
+#include <frm/core/Time.h>
+
+#include <EASTL/algorithm.h>
+#include <EASTL/vector.h>
+
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+using namespace frm;
+
+// All tests use a single worker thread, hence jobs execute one batch at a time in the order in which they're popped from the queue.
+// Write jobs are never batched, so the order of write callbacks is the pop order. The order of read callbacks within a batch depends
+// on the platform (e.g. io_uring completion order).
+
+namespace {
+
+// Unique temporary directory, deleted with its contents on destruction.
+struct TempDir
+{
+	PathStr path;
+
+	TempDir(const char* _name)
+	{
+		FileSystem::AddRoot(""); // no-op if already added, the root is ignored for absolute paths but must exist
+
+		const char* tmp = getenv("TMPDIR");
+		tmp = tmp ? tmp : getenv("TEMP");
+		tmp = tmp ? tmp : "/tmp";
+		path.setf("%s/%s_%llu/", tmp, _name, (unsigned long long)Time::GetTimestamp().getRaw());
+		FileSystem::Sanitize(path);
+		REQUIRE(FileSystem::CreateDir(path.c_str()));
+	}
+
+	~TempDir()
+	{
+		FileSystem::DeleteDir(path.c_str(), true);
+	}
+
+	PathStr operator()(const char* _name) const
+	{
+		return PathStr("%s%s", path.c_str(), _name);
+	}
+};
+
+// Block the worker thread in a job callback so that jobs can be queued deterministically.
+struct Gate
+{
+	std::mutex              mutex;
+	std::condition_variable condition;
+	bool                    entered = false;
+	bool                    open    = false;
+	File                    file;
+	FileSystemAsync::JobID  jobID   = FileSystemAsync::kInvalidJobID;
+
+	static void Callback(FileSystemAsync::JobID _jobID, File& _file, bool _success, void* _arg)
+	{
+		Gate* gate = (Gate*)_arg;
+		std::unique_lock<std::mutex> lock(gate->mutex);
+		gate->entered = true;
+		gate->condition.notify_all();
+		gate->condition.wait(lock, [gate]() { return gate->open; });
+	}
+
+	// Push a job and return when the worker is blocked in its callback (the queue is then empty).
+	void close(const TempDir& _dir)
+	{
+		file.setData("gate", 4);
+		jobID = FileSystemAsync::Write(file, _dir("gate.txt").c_str(), FileSystem::GetDefaultRoot(), FileSystemAsync::kDefaultPriority, &Callback, this);
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this]() { return entered; });
+	}
+
+	void release()
+	{
+		{	std::lock_guard<std::mutex> lock(mutex);
+			open = true;
+		}
+		condition.notify_all();
+		FileSystemAsync::Wait(jobID);
+	}
+};
+
+// Records the order of callbacks. Only accessed by the worker thread until WaitAll() returns.
+eastl::vector<int> s_completed;
+eastl::vector<int> s_failed;
+
+void RecordCallback(FileSystemAsync::JobID _jobID, File& _file, bool _success, void* _arg)
+{
+	(_success ? s_completed : s_failed).push_back((int)(intptr_t)_arg);
+}
+
+void WriteTextFile(const char* _path, const char* _text)
+{
+	File file;
+	file.setData(_text, strlen(_text));
+	REQUIRE(FileSystem::Write(file, _path));
+}
+
+bool FileEquals(const File& _file, const char* _text)
+{
+	return _file.getDataSize() == strlen(_text) + 1 && strcmp(_file.getData(), _text) == 0;
+}
+
+} // namespace
+
+TEST_CASE("Priority", "[FileSystemAsync]")
+{
+	FileSystemAsync::Init(1);
+	TempDir dir("FileSystemAsync_tests");
+	s_completed.clear();
+	s_failed.clear();
+
+	// Higher priorities first, FIFO for equal priorities. SetPriority() applies to pending jobs.
+	const int priorities[] = { 0, 5, -1, 5, 10, 0, 3 };
+	const int kJobCount = (int)FRM_ARRAY_COUNT(priorities);
+	File files[kJobCount];
+	FileSystemAsync::JobID jobIDs[kJobCount];
+	Gate gate;
+	gate.close(dir);
+	for (int i = 0; i < kJobCount; ++i)
+	{
+		files[i].setData("x", 1);
+		jobIDs[i] = FileSystemAsync::Write(files[i], dir(PathStr("%d.txt", i).c_str()).c_str(), FileSystem::GetDefaultRoot(), priorities[i], &RecordCallback, (void*)(intptr_t)i);
+	}
+	FileSystemAsync::SetPriority(jobIDs[2], 7); // -1 -> 7
+	gate.release();
+	FileSystemAsync::WaitAll();
+
+	const int expected[] = { 4, 2, 1, 3, 6, 0, 5 };
+	REQUIRE(s_failed.empty());
+	REQUIRE(s_completed.size() == kJobCount);
+	for (int i = 0; i < kJobCount; ++i)
+	{
+		REQUIRE(s_completed[i] == expected[i]);
+		REQUIRE(FileSystemAsync::IsComplete(jobIDs[i]));
+		REQUIRE(jobIDs[i] == FileSystemAsync::kInvalidJobID);
+	}
+
+	FileSystemAsync::Shutdown();
+}
+
+TEST_CASE("Cancel", "[FileSystemAsync]")
+{
+	FileSystemAsync::Init(1);
+	TempDir dir("FileSystemAsync_tests");
+	s_completed.clear();
+	s_failed.clear();
+
+	const int kJobCount = 4;
+	File files[kJobCount];
+	FileSystemAsync::JobID jobIDs[kJobCount];
+	for (int i = 0; i < kJobCount; ++i)
+	{
+		files[i].setData("x", 1);
+	}
+
+	// Cancel a queued job, the callback never fires and nothing is written.
+	Gate gate;
+	gate.close(dir);
+	for (int i = 0; i < kJobCount; ++i)
+	{
+		jobIDs[i] = FileSystemAsync::Write(files[i], dir(PathStr("%d.txt", i).c_str()).c_str(), FileSystem::GetDefaultRoot(), FileSystemAsync::kDefaultPriority, &RecordCallback, (void*)(intptr_t)i);
+	}
+	REQUIRE(FileSystemAsync::Cancel(jobIDs[1]));
+	REQUIRE(jobIDs[1] == FileSystemAsync::kInvalidJobID);
+	gate.release();
+	FileSystemAsync::WaitAll();
+
+	REQUIRE(s_completed.size() == kJobCount - 1);
+	REQUIRE(eastl::find(s_completed.begin(), s_completed.end(), 1) == s_completed.end());
+	REQUIRE(!FileSystem::Exists(dir("1.txt").c_str()));
+	for (int i : { 0, 2, 3 })
+	{
+		REQUIRE(FileSystem::Exists(dir(PathStr("%d.txt", i).c_str()).c_str()));
+
+		// Completed jobs can't be cancelled.
+		REQUIRE(!FileSystemAsync::Cancel(jobIDs[i]));
+		FileSystemAsync::Release(jobIDs[i]);
+	}
+
+	// Cancel a job in an open batch.
+	s_completed.clear();
+	FileSystemAsync::BeginBatch();
+	for (int i = 0; i < kJobCount; ++i)
+	{
+		jobIDs[i] = FileSystemAsync::Write(files[i], dir(PathStr("batch%d.txt", i).c_str()).c_str(), FileSystem::GetDefaultRoot(), FileSystemAsync::kDefaultPriority, &RecordCallback, (void*)(intptr_t)i);
+	}
+	REQUIRE(FileSystemAsync::Cancel(jobIDs[2]));
+	FileSystemAsync::EndBatch();
+	FileSystemAsync::WaitAll();
+
+	const int expected[] = { 0, 1, 3 };
+	REQUIRE(s_completed.size() == FRM_ARRAY_COUNT(expected));
+	for (int i = 0; i < (int)FRM_ARRAY_COUNT(expected); ++i)
+	{
+		REQUIRE(s_completed[i] == expected[i]);
+		FileSystemAsync::Release(jobIDs[expected[i]]);
+	}
+	REQUIRE(!FileSystem::Exists(dir("batch2.txt").c_str()));
+
+	FileSystemAsync::Shutdown();
+}
+
+TEST_CASE("Batch", "[FileSystemAsync]")
+{
+	FileSystemAsync::Init(1);
+	TempDir dir("FileSystemAsync_tests");
+	s_completed.clear();
+	s_failed.clear();
+
+	// Jobs pushed between BeginBatch()/EndBatch() execute in priority order, not push order. Consecutive reads are popped together, a
+	// write ends the read batch: 'b.txt' is written by job 2 after jobs 0 and 1 read the initial contents, and before jobs 3 and 4 read
+	// the new contents.
+	WriteTextFile(dir("a.txt").c_str(), "a");
+	WriteTextFile(dir("b.txt").c_str(), "b");
+
+	File files[6];
+	files[2].setData("B", 1);
+	struct JobDesc { int index; bool write; const char* name; int priority; };
+	const JobDesc jobs[] =
+	{
+		{ 4, false, "b.txt",       1 },
+		{ 2, true,  "b.txt",       2 },
+		{ 5, false, "missing.txt", 0 },
+		{ 0, false, "a.txt",       3 },
+		{ 3, false, "a.txt",       1 },
+		{ 1, false, "b.txt",       3 },
+	};
+
+	FileSystemAsync::BeginBatch();
+	for (const JobDesc& job : jobs)
+	{
+		const PathStr path = dir(job.name);
+		FileSystemAsync::JobID jobID = job.write
+			? FileSystemAsync::Write(files[job.index], path.c_str(), FileSystem::GetDefaultRoot(), job.priority, &RecordCallback, (void*)(intptr_t)job.index)
+			: FileSystemAsync::Read(files[job.index], path.c_str(), FileSystem::GetDefaultRoot(), job.priority, &RecordCallback, (void*)(intptr_t)job.index)
+			;
+		FileSystemAsync::Release(jobID);
+	}
+	FileSystemAsync::EndBatch();
+	FileSystemAsync::WaitAll();
+
+	REQUIRE(s_completed.size() == 5);
+	REQUIRE(eastl::is_permutation(s_completed.begin(), s_completed.begin() + 2, eastl::vector<int>({ 0, 1 }).begin()));
+	REQUIRE(s_completed[2] == 2);
+	REQUIRE(eastl::is_permutation(s_completed.begin() + 3, s_completed.end(), eastl::vector<int>({ 3, 4 }).begin()));
+	REQUIRE(s_failed.size() == 1);
+	REQUIRE(s_failed[0] == 5);
+
+	REQUIRE(FileEquals(files[0], "a"));
+	REQUIRE(FileEquals(files[1], "b"));
+	REQUIRE(FileEquals(files[3], "a"));
+	REQUIRE(FileEquals(files[4], "B"));
+
+	FileSystemAsync::Shutdown();
+}
+
+TEST_CASE("Write", "[FileSystemAsync]")
+{
+	FileSystemAsync::Init(1);
+	TempDir dir("FileSystemAsync_tests");
+	s_completed.clear();
+	s_failed.clear();
+
+	// Write jobs write the file to disk (missing directories are created) and don't modify the source file.
+	File file;
+	file.setData("write", 5);
+	FileSystemAsync::JobID jobID = FileSystemAsync::Write(file, dir("sub/write.txt").c_str(), FileSystem::GetDefaultRoot(), FileSystemAsync::kDefaultPriority, &RecordCallback, (void*)(intptr_t)0);
+	FileSystemAsync::Wait(jobID);
+	REQUIRE(jobID == FileSystemAsync::kInvalidJobID);
+	REQUIRE(s_completed.size() == 1);
+	REQUIRE(file.getDataSize() == 5);
+	REQUIRE(memcmp(file.getData(), "write", 5) == 0);
+
+	File result;
+	REQUIRE(FileSystem::Read(result, dir("sub/write.txt").c_str()));
+	REQUIRE(FileEquals(result, "write"));
+
+	// The callback receives the source file.
+	struct Arg { File* file = nullptr; };
+	Arg arg;
+	jobID = FileSystemAsync::Write(file, dir("sub/write2.txt").c_str(), FileSystem::GetDefaultRoot(), FileSystemAsync::kDefaultPriority,
+		[](FileSystemAsync::JobID _jobID, File& _file, bool _success, void* _arg)
+		{
+			((Arg*)_arg)->file = _success ? &_file : nullptr;
+		},
+		&arg);
+	FileSystemAsync::Wait(jobID);
+	REQUIRE(arg.file == &file);
+
+	FileSystemAsync::Shutdown();
+}
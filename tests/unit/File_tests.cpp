@@ -0,0 +1,176 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/File.h>
+#include <frm/core/hash.h>
+
+#include <EASTL/algorithm.h>
+
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+struct ReleaseCounter
+{
+	int   count = 0;
+	char* data  = nullptr;
+	uint  size  = 0;
+
+	static void Release(char* _data, uint _size, void* _arg)
+	{
+		ReleaseCounter* counter = (ReleaseCounter*)_arg;
+		++counter->count;
+		counter->data = _data;
+		counter->size = _size;
+	}
+};
+
+} // namespace
+
+TEST_CASE("OwnedData", "[File]")
+{
+	File file;
+	REQUIRE(file.getData() == nullptr);
+	REQUIRE(file.getDataSize() == 0);
+
+	file.setData("abc", 4);
+	REQUIRE(file.getDataSize() == 4);
+	REQUIRE(strcmp(file.getData(), "abc") == 0);
+	REQUIRE(!file.isDataExternal());
+
+	// Appended data is inserted before the null character.
+	file.appendData("def", 3);
+	REQUIRE(file.getDataSize() == 7);
+	REQUIRE(strcmp(file.getData(), "abcdef") == 0);
+
+	// Append to an empty file.
+	File empty;
+	empty.appendData("xyz", 3);
+	REQUIRE(empty.getDataSize() == 3);
+	REQUIRE(memcmp(empty.getData(), "xyz", 3) == 0);
+
+	file.reserveData(1024);
+	REQUIRE(file.getDataCapacity() >= 1024);
+	REQUIRE(strcmp(file.getData(), "abcdef") == 0);
+
+	file.setData(nullptr, 0);
+	REQUIRE(file.getData() == nullptr);
+	REQUIRE(file.getDataSize() == 0);
+}
+
+TEST_CASE("ExternalData", "[File]")
+{
+	char buffer[] = "external";
+	ReleaseCounter counter;
+
+	{	File file;
+		file.setDataExternal(buffer, sizeof(buffer), &ReleaseCounter::Release, &counter);
+		REQUIRE(file.isDataExternal());
+		REQUIRE(file.getData() == buffer);
+		REQUIRE(file.getDataSize() == sizeof(buffer));
+		REQUIRE(counter.count == 0);
+	}
+	REQUIRE(counter.count == 1);
+	REQUIRE(counter.data == buffer);
+	REQUIRE(counter.size == sizeof(buffer));
+
+	// Modifying external data copies it to an owned buffer and releases the external buffer.
+	counter = ReleaseCounter();
+	{	File file;
+		file.setDataExternal(buffer, sizeof(buffer), &ReleaseCounter::Release, &counter);
+		file.appendData("!", 1);
+		REQUIRE(counter.count == 1);
+		REQUIRE(!file.isDataExternal());
+		REQUIRE(strcmp(file.getData(), "external!") == 0);
+		REQUIRE(strcmp(buffer, "external") == 0);
+	}
+	REQUIRE(counter.count == 1);
+
+	counter = ReleaseCounter();
+	{	File file;
+		file.setDataExternal(buffer, sizeof(buffer), &ReleaseCounter::Release, &counter);
+		file.setData("abc", 4);
+		REQUIRE(counter.count == 1);
+		REQUIRE(strcmp(file.getData(), "abc") == 0);
+	}
+}
+
+TEST_CASE("ReleaseData", "[File]")
+{
+	// Owned data.
+	{	File file;
+		file.setData("abc", 4);
+		const char* data = file.getData();
+
+		uint size;
+		File::ReleaseFunc* release;
+		void* releaseArg;
+		char* released = file.releaseData(size, release, releaseArg);
+		REQUIRE(released == data);
+		REQUIRE(size == 4);
+		REQUIRE(release != nullptr);
+		REQUIRE(file.getData() == nullptr);
+		REQUIRE(file.getDataSize() == 0);
+		release(released, size, releaseArg);
+	}
+
+	// External data, the release callback is transferred to the caller.
+	{	char buffer[] = "external";
+		ReleaseCounter counter;
+		{	File file;
+			file.setDataExternal(buffer, sizeof(buffer), &ReleaseCounter::Release, &counter);
+
+			uint size;
+			File::ReleaseFunc* release;
+			void* releaseArg;
+			char* released = file.releaseData(size, release, releaseArg);
+			REQUIRE(released == buffer);
+			REQUIRE(release == &ReleaseCounter::Release);
+			REQUIRE(releaseArg == &counter);
+		}
+		REQUIRE(counter.count == 0);
+	}
+
+	// Empty.
+	{	File file;
+		uint size;
+		File::ReleaseFunc* release;
+		void* releaseArg;
+		REQUIRE(file.releaseData(size, release, releaseArg) == nullptr);
+		REQUIRE(size == 0);
+		REQUIRE(release == nullptr);
+	}
+}
+
+TEST_CASE("Hash", "[File]")
+{
+	// xxHash64 reference values.
+	REQUIRE(HashContent64("", 0) == 0xEF46DB3751D8E999ull);
+	REQUIRE(HashContent64("abc", 3) == 0x44BC2CF5AD770999ull);
+	const char* str = "Nobody inspects the spammish repetition";
+	REQUIRE(HashContent64(str, (uint)strlen(str)) == 0xFBCEA83C8A378BF1ull);
+
+	// Streaming matches a single call regardless of the update size.
+	char data[1000];
+	for (int i = 0; i < (int)sizeof(data); ++i)
+	{
+		data[i] = (char)(i * 131 + 7);
+	}
+	const uint64 hash = HashContent64(data, sizeof(data));
+	for (uint step : { 1, 7, 31, 32, 33, 500 })
+	{
+		ContentHasher64 hasher;
+		for (uint i = 0; i < sizeof(data); i += step)
+		{
+			hasher.update(data + i, eastl::min(step, (uint)sizeof(data) - i));
+		}
+		REQUIRE(hasher.finish() == hash);
+	}
+
+	// The implicit null character is excluded.
+	File file;
+	file.setData(str, (uint)strlen(str) + 1);
+	REQUIRE(file.getHash() == HashContent64(str, (uint)strlen(str)));
+}
@@ -0,0 +1,222 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+#include <frm/core/Image.h>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace frm;
+
+namespace {
+
+uint GetComponentCount(const Image& _img)
+{
+	switch (_img.getLayout())
+	{
+		case Image::Layout_R:   return 1;
+		case Image::Layout_RG:  return 2;
+		case Image::Layout_RGB: return 3;
+		default:                return 4;
+	};
+}
+
+// Smooth gradients plus noise, with a few hard edges (64x64 is a multiple of the block size, 37x21 isn't).
+Image* CreateTestImage(uint _width, uint _height, Image::Layout _layout)
+{
+	srand(1);
+	Image* ret = Image::Create2d(_width, _height, _layout, DataType_Uint8N);
+	const uint componentCount = GetComponentCount(*ret);
+	uint8* texels = (uint8*)ret->getRawImage();
+	for (uint y = 0; y < _height; ++y)
+	{
+		for (uint x = 0; x < _width; ++x)
+		{
+			for (uint c = 0; c < componentCount; ++c)
+			{
+				float v = 0.5f + 0.5f * sinf((float)(x * (c + 1)) * 0.1f + (float)y * 0.07f);
+				v += ((float)rand() / (float)RAND_MAX - 0.5f) * 0.05f;
+				v = ((x / 16 + y / 16) & 1) && c == 0 ? 1.0f - v : v;
+				texels[(y * _width + x) * componentCount + c] = (uint8)FRM_CLAMP(v * 255.0f + 0.5f, 0.0f, 255.0f);
+			}
+		}
+	}
+	return ret;
+}
+
+// Compare the first _componentCount components.
+double Psnr(const Image& _a, const Image& _b, uint _componentCount)
+{
+	const uint8* a = (const uint8*)_a.getRawImage();
+	const uint8* b = (const uint8*)_b.getRawImage();
+	const uint strideA = GetComponentCount(_a);
+	const uint strideB = GetComponentCount(_b);
+	const uint texelCount = _a.getWidth() * _a.getHeight();
+	double mse = 0.0;
+	for (uint i = 0; i < texelCount; ++i)
+	{
+		for (uint c = 0; c < _componentCount; ++c)
+		{
+			const double d = (double)a[i * strideA + c] - (double)b[i * strideB + c];
+			mse += d * d;
+		}
+	}
+	mse /= (double)(texelCount * _componentCount);
+	return mse == 0.0 ? 999.0 : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+double RoundTripPsnr(const Image& _img, Image::CompressionType _compression, Image::CompressionQuality _quality, uint _componentCount)
+{
+	Image* compressed = Image::CreateCompressed(_img, _compression, _quality);
+	Image* decompressed = Image::CreateDecompressed(*compressed);
+	const double ret = Psnr(_img, *decompressed, _componentCount);
+	Image::Destroy(compressed);
+	Image::Destroy(decompressed);
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE("BlockCompressionLayout", "[Image]")
+{
+	Image* img = CreateTestImage(37, 21, Image::Layout_RGBA);
+	REQUIRE(Image::CreateCompressed(*img, Image::Compression_None) == nullptr);
+
+	Image* bc1 = Image::CreateCompressed(*img, Image::Compression_BC1);
+	REQUIRE(bc1->getCompressionType() == Image::Compression_BC1);
+	REQUIRE(bc1->getLayout() == Image::Layout_RGBA);
+	REQUIRE(bc1->getRawImageSize() == 10 * 6 * 8);
+	REQUIRE(Image::CreateCompressed(*bc1, Image::Compression_BC7) == nullptr);
+
+	Image* bc5 = Image::CreateCompressed(*img, Image::Compression_BC5);
+	REQUIRE(bc5->getLayout() == Image::Layout_RG);
+	REQUIRE(bc5->getRawImageSize() == 10 * 6 * 16);
+
+	Image* decompressed = Image::CreateDecompressed(*bc5);
+	REQUIRE(decompressed->getWidth() == 37);
+	REQUIRE(decompressed->getHeight() == 21);
+	REQUIRE(decompressed->getLayout() == Image::Layout_RG);
+	REQUIRE(decompressed->getImageDataType() == DataType_Uint8N);
+	REQUIRE(!decompressed->isCompressed());
+
+	// Mips are compressed individually.
+	REQUIRE(img->generateMipmaps());
+	Image* bc7 = Image::CreateCompressed(*img, Image::Compression_BC7, Image::CompressionQuality_Fast);
+	REQUIRE(bc7->getMipmapCount() == img->getMipmapCount());
+	REQUIRE(bc7->getRawImageSize(5) == 16);
+
+	Image::Destroy(img);
+	Image::Destroy(bc1);
+	Image::Destroy(bc5);
+	Image::Destroy(bc7);
+	Image::Destroy(decompressed);
+}
+
+TEST_CASE("BlockCompressionQuality", "[Image]")
+{
+	Image* rgba = CreateTestImage(64, 64, Image::Layout_RGBA);
+	Image* rgb  = CreateTestImage(37, 21, Image::Layout_RGB);
+	Image* rg   = CreateTestImage(64, 64, Image::Layout_RG);
+
+	// Minimum PSNR per format.
+	REQUIRE(RoundTripPsnr(*rgb,  Image::Compression_BC1, Image::CompressionQuality_Default, 3) > 30.0);
+	REQUIRE(RoundTripPsnr(*rgba, Image::Compression_BC2, Image::CompressionQuality_Default, 4) > 30.0);
+	REQUIRE(RoundTripPsnr(*rgba, Image::Compression_BC3, Image::CompressionQuality_Default, 4) > 30.0);
+	REQUIRE(RoundTripPsnr(*rg,   Image::Compression_BC4, Image::CompressionQuality_Default, 1) > 42.0);
+	REQUIRE(RoundTripPsnr(*rg,   Image::Compression_BC5, Image::CompressionQuality_Default, 2) > 40.0);
+	REQUIRE(RoundTripPsnr(*rgb,  Image::Compression_BC7, Image::CompressionQuality_Default, 3) > 37.0);
+	REQUIRE(RoundTripPsnr(*rgba, Image::Compression_BC7, Image::CompressionQuality_Default, 4) > 33.0);
+
+	// Higher quality levels don't increase the error.
+	for (Image::CompressionType compression : { Image::Compression_BC1, Image::Compression_BC4, Image::Compression_BC7 })
+	{
+		const double fast = RoundTripPsnr(*rgb, compression, Image::CompressionQuality_Fast, compression == Image::Compression_BC4 ? 1 : 3);
+		const double high = RoundTripPsnr(*rgb, compression, Image::CompressionQuality_High, compression == Image::Compression_BC4 ? 1 : 3);
+		REQUIRE(high >= fast);
+	}
+
+	Image::Destroy(rgba);
+	Image::Destroy(rgb);
+	Image::Destroy(rg);
+}
+
+TEST_CASE("BlockCompressionSolid", "[Image]")
+{
+	// Solid colors are exact for BC4/5/7 and within the 565 interpolation error for BC1.
+	Image* img = Image::Create2d(8, 8, Image::Layout_RGBA, DataType_Uint8N);
+	uint8* texels = (uint8*)img->getRawImage();
+	for (uint i = 0; i < 64; ++i)
+	{
+		texels[i * 4 + 0] = 200;
+		texels[i * 4 + 1] = 17;
+		texels[i * 4 + 2] = 99;
+		texels[i * 4 + 3] = 255;
+	}
+	for (Image::CompressionType compression : { Image::Compression_BC1, Image::Compression_BC4, Image::Compression_BC5, Image::Compression_BC7 })
+	{
+		Image* compressed = Image::CreateCompressed(*img, compression);
+		Image* decompressed = Image::CreateDecompressed(*compressed);
+		const uint componentCount = compression == Image::Compression_BC4 ? 1 : (compression == Image::Compression_BC5 ? 2 : 4);
+		const uint8* result = (const uint8*)decompressed->getRawImage();
+		for (uint i = 0; i < 64; ++i)
+		{
+			for (uint c = 0; c < componentCount; ++c)
+			{
+				const int error = abs((int)result[i * componentCount + c] - (int)texels[i * 4 + c]);
+				REQUIRE(error <= (compression == Image::Compression_BC1 ? 1 : 0));
+			}
+		}
+		Image::Destroy(compressed);
+		Image::Destroy(decompressed);
+	}
+
+	// BC1 1-bit alpha.
+	texels[3] = texels[7] = 0;
+	Image* bc1 = Image::CreateCompressed(*img, Image::Compression_BC1);
+	Image* decompressed = Image::CreateDecompressed(*bc1);
+	const uint8* result = (const uint8*)decompressed->getRawImage();
+	REQUIRE(result[3] == 0);
+	REQUIRE(result[7] == 0);
+	REQUIRE(result[11] == 255);
+
+	Image::Destroy(img);
+	Image::Destroy(bc1);
+	Image::Destroy(decompressed);
+}
+
+TEST_CASE("BlockCompressionHdr", "[Image]")
+{
+	// Exponential ramp, the relative error is roughly constant. Channels are proportional so each block lies on a line.
+	Image* img = Image::Create2d(32, 32, Image::Layout_RGB, DataType_Float32);
+	float* texels = (float*)img->getRawImage();
+	for (uint y = 0; y < 32; ++y)
+	{
+		for (uint x = 0; x < 32; ++x)
+		{
+			const float k = exp2f((float)x * 0.125f + (float)y * 0.0625f - 4.0f);
+			texels[(y * 32 + x) * 3 + 0] = k;
+			texels[(y * 32 + x) * 3 + 1] = k * 0.5f;
+			texels[(y * 32 + x) * 3 + 2] = k * 0.25f;
+		}
+	}
+
+	for (Image::CompressionQuality quality : { Image::CompressionQuality_Fast, Image::CompressionQuality_Default, Image::CompressionQuality_High })
+	{
+		Image* compressed = Image::CreateCompressed(*img, Image::Compression_BC6, quality);
+		REQUIRE(compressed->getImageDataType() == DataType_Float16);
+		Image* decompressed = Image::CreateDecompressed(*compressed);
+		REQUIRE(decompressed->getLayout() == Image::Layout_RGB);
+		const uint16* result = (const uint16*)decompressed->getRawImage();
+		float maxRelativeError = 0.0f;
+		for (uint i = 0; i < 32 * 32 * 3; ++i)
+		{
+			maxRelativeError = FRM_MAX(maxRelativeError, fabsf(UnpackFloat16(result[i]) - texels[i]) / texels[i]);
+		}
+		REQUIRE(maxRelativeError < (quality == Image::CompressionQuality_Fast ? 0.025f : 0.02f));
+		Image::Destroy(compressed);
+		Image::Destroy(decompressed);
+	}
+
+	Image::Destroy(img);
+}
@@ -0,0 +1,231 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+#include <frm/core/Image.h>
+
+#include <cmath>
+
+using namespace frm;
+
+namespace {
+
+float* Texels(Image& _img, uint _array = 0, uint _mip = 0)
+{
+	return (float*)_img.getRawImage(_array, _mip);
+}
+
+void Fill(Image& img_, float _value)
+{
+	const uint imageCount = img_.isCubemap() ? img_.getArrayCount() * 6 : img_.getArrayCount();
+	for (uint i = 0; i < imageCount; ++i)
+	{
+		float* texels = Texels(img_, i);
+		for (uint j = 0; j < img_.getRawImageSize(0) / sizeof(float); ++j)
+		{
+			texels[j] = _value;
+		}
+	}
+}
+
+float MaxError(Image& _img, uint _array, uint _mip, float _value)
+{
+	float ret = 0.0f;
+	const float* texels = Texels(_img, _array, _mip);
+	for (uint j = 0; j < _img.getRawImageSize(_mip) / sizeof(float); ++j)
+	{
+		ret = FRM_MAX(ret, fabsf(texels[j] - _value));
+	}
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE("MipmapsBox", "[Image]")
+{
+	Image* img = Image::Create2d(4, 4, Image::Layout_R, DataType_Float32);
+	for (uint i = 0; i < 16; ++i)
+	{
+		Texels(*img)[i] = (float)i;
+	}
+	REQUIRE(img->generateMipmaps());
+	REQUIRE(img->getMipmapCount() == 3);
+	REQUIRE(img->getRawImageSize(1) == 2 * 2 * sizeof(float));
+	REQUIRE(img->getRawImageSize(2) == sizeof(float));
+
+	// Level 0 is preserved, each texel in level 1 is the average of a 2x2 block.
+	for (uint i = 0; i < 16; ++i)
+	{
+		REQUIRE(Texels(*img)[i] == (float)i);
+	}
+	const float* mip1 = Texels(*img, 0, 1);
+	REQUIRE(mip1[0] == 2.5f);
+	REQUIRE(mip1[1] == 4.5f);
+	REQUIRE(mip1[2] == 10.5f);
+	REQUIRE(mip1[3] == 12.5f);
+	REQUIRE(Texels(*img, 0, 2)[0] == 7.5f);
+
+	// Non-power of 2, partial chain.
+	Image* npot = Image::Create2d(7, 3, Image::Layout_RGBA, DataType_Float32, 1, 2);
+	Fill(*npot, 0.25f);
+	REQUIRE(npot->generateMipmaps(Image::FilterOptions(), 2));
+	REQUIRE(npot->getMipmapCount() == 2);
+	REQUIRE(npot->getRawImageSize(1) == 3 * 1 * 4 * sizeof(float));
+	REQUIRE(MaxError(*npot, 1, 1, 0.25f) == 0.0f);
+
+	Image::Destroy(img);
+	Image::Destroy(npot);
+}
+
+TEST_CASE("MipmapsSrgb", "[Image]")
+{
+	// Black/white, alpha 0/1.
+	Image* img = Image::Create2d(2, 1, Image::Layout_RGBA, DataType_Uint8N);
+	const uint8 texels[] = { 0, 0, 0, 0, 255, 255, 255, 255 };
+	memcpy(img->getRawImage(0, 0), texels, sizeof(texels));
+
+	REQUIRE(img->generateMipmaps());
+	const uint8* mip1 = (const uint8*)img->getRawImage(0, 1);
+	REQUIRE(mip1[0] == 128); // 127.5 rounds to nearest
+	REQUIRE(mip1[3] == 128);
+
+	REQUIRE(img->generateMipmaps(Image::FilterOptions(Image::Filter_Box, Image::Wrap_Clamp, true)));
+	REQUIRE(mip1[0] == 188); // linear 0.5
+	REQUIRE(mip1[1] == 188);
+	REQUIRE(mip1[2] == 188);
+	REQUIRE(mip1[3] == 128); // alpha is linear
+
+	Image::Destroy(img);
+}
+
+TEST_CASE("MipmapsFilters", "[Image]")
+{
+	// All filters preserve a constant image.
+	for (Image::Filter filter : { Image::Filter_Box, Image::Filter_Triangle, Image::Filter_Kaiser })
+	{
+		for (Image::Wrap wrap : { Image::Wrap_Clamp, Image::Wrap_Repeat, Image::Wrap_Mirror })
+		{
+			Image* img = Image::Create3d(13, 6, 5, Image::Layout_RG, DataType_Float32);
+			Fill(*img, 0.75f);
+			REQUIRE(img->generateMipmaps(Image::FilterOptions(filter, wrap)));
+			REQUIRE(img->getMipmapCount() == 4);
+			for (uint mip = 1; mip < img->getMipmapCount(); ++mip)
+			{
+				REQUIRE(MaxError(*img, 0, mip, 0.75f) < 1e-5f);
+			}
+			Image::Destroy(img);
+		}
+	}
+
+	// Wrap mode affects the edges: a single bright texel at x = 0 bleeds to the opposite edge with repeat.
+	for (Image::Wrap wrap : { Image::Wrap_Clamp, Image::Wrap_Repeat })
+	{
+		Image* img = Image::Create1d(16, Image::Layout_R, DataType_Float32);
+		Fill(*img, 0.0f);
+		Texels(*img)[0] = 1.0f;
+		REQUIRE(img->generateMipmaps(Image::FilterOptions(Image::Filter_Kaiser, wrap)));
+		const float* mip1 = Texels(*img, 0, 1);
+		REQUIRE(mip1[0] > 0.25f);
+		REQUIRE((fabsf(mip1[7]) > 1e-3f) == (wrap == Image::Wrap_Repeat));
+		Image::Destroy(img);
+	}
+}
+
+TEST_CASE("MipmapsCubemap", "[Image]")
+{
+	// Constant cubemap is preserved by all filters (border texels are valid).
+	for (Image::Filter filter : { Image::Filter_Box, Image::Filter_Triangle, Image::Filter_Kaiser })
+	{
+		Image* img = Image::CreateCubemap(16, Image::Layout_RGBA, DataType_Float32);
+		Fill(*img, 2.0f);
+		REQUIRE(img->generateMipmaps(Image::FilterOptions(filter)));
+		REQUIRE(img->getMipmapCount() == 5);
+		for (uint face = 0; face < 6; ++face)
+		{
+			for (uint mip = 1; mip < img->getMipmapCount(); ++mip)
+			{
+				REQUIRE(MaxError(*img, face, mip, 2.0f) < 1e-5f);
+			}
+		}
+		Image::Destroy(img);
+	}
+
+	// Faces with different values: box filter doesn't cross the face edges, triangle filter blends edge texels with the adjacent faces.
+	for (Image::Filter filter : { Image::Filter_Box, Image::Filter_Triangle })
+	{
+		Image* img = Image::CreateCubemap(8, Image::Layout_R, DataType_Float32);
+		for (uint face = 0; face < 6; ++face)
+		{
+			for (uint i = 0; i < 64; ++i)
+			{
+				Texels(*img, face)[i] = (float)face;
+			}
+		}
+		REQUIRE(img->generateMipmaps(Image::FilterOptions(filter), 2));
+		for (uint face = 0; face < 6; ++face)
+		{
+			const float* mip1 = Texels(*img, face, 1);
+			REQUIRE(fabsf(mip1[1 * 4 + 1] - (float)face) < 1e-5f); // interior
+			REQUIRE((fabsf(mip1[0] - (float)face) > 1e-3f) == (filter == Image::Filter_Triangle));
+		}
+		Image::Destroy(img);
+	}
+}
+
+TEST_CASE("Resample", "[Image]")
+{
+	Image* img = Image::Create2d(16, 8, Image::Layout_R, DataType_Float32, 3, 3);
+	for (uint array = 0; array < 3; ++array)
+	{
+		for (uint i = 0; i < 16 * 8; ++i)
+		{
+			Texels(*img, array)[i] = (float)(i % 16) + (float)array;
+		}
+	}
+
+	Image* downsampled = Image::CreateResampled(*img, 5, 3, 1, Image::FilterOptions(Image::Filter_Kaiser));
+	REQUIRE(downsampled->getWidth() == 5);
+	REQUIRE(downsampled->getHeight() == 3);
+	REQUIRE(downsampled->getArrayCount() == 3);
+	REQUIRE(downsampled->getMipmapCount() == 1);
+	REQUIRE(downsampled->getRawImageSize(0) == 5 * 3 * sizeof(float));
+
+	// Upsampling a linear gradient with the triangle filter is exact away from the edges.
+	Image* upsampled = Image::CreateResampled(*img, 32, 8, 1, Image::FilterOptions(Image::Filter_Triangle));
+	for (uint array = 0; array < 3; ++array)
+	{
+		const float* texels = Texels(*upsampled, array);
+		for (uint x = 1; x < 31; ++x)
+		{
+			REQUIRE(fabsf(texels[4 * 32 + x] - (((float)x + 0.5f) * 0.5f - 0.5f + (float)array)) < 1e-5f);
+		}
+	}
+
+	Image::Destroy(img);
+	Image::Destroy(downsampled);
+	Image::Destroy(upsampled);
+}
+
+TEST_CASE("Sample", "[Image]")
+{
+	Image* img = Image::Create2d(2, 2, Image::Layout_RG, DataType_Uint8N);
+	const uint8 texels[] = { 0, 255, 255, 255, 0, 0, 255, 0 };
+	memcpy(img->getRawImage(0, 0), texels, sizeof(texels));
+
+	REQUIRE(img->sample(vec3(0.25f, 0.25f, 0.0f)) == vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	REQUIRE(img->sample(vec3(0.5f, 0.5f, 0.0f)) == vec4(0.5f, 0.5f, 0.0f, 1.0f));
+	REQUIRE(img->sample(vec3(0.5f, 0.25f, 0.0f)) == vec4(0.5f, 1.0f, 0.0f, 1.0f));
+
+	// u = 0 is halfway between the first and last texel with repeat, the first texel with clamp.
+	REQUIRE(img->sample(vec3(0.0f, 0.25f, 0.0f), 0, 0, Image::Wrap_Repeat) == vec4(0.5f, 1.0f, 0.0f, 1.0f));
+	REQUIRE(img->sample(vec3(0.0f, 0.25f, 0.0f), 0, 0, Image::Wrap_Clamp) == vec4(0.0f, 1.0f, 0.0f, 1.0f));
+
+	Image* volume = Image::Create3d(1, 1, 2, Image::Layout_R, DataType_Float32);
+	Texels(*volume)[0] = 1.0f;
+	Texels(*volume)[1] = 3.0f;
+	REQUIRE(volume->sample(vec3(0.5f, 0.5f, 0.5f)).x == 2.0f);
+	REQUIRE(volume->sample(vec3(0.5f, 0.5f, 0.75f), 0, 0, Image::Wrap_Clamp).x == 3.0f);
+
+	Image::Destroy(img);
+	Image::Destroy(volume);
+}
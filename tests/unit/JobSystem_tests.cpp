@@ -0,0 +1,234 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+#include <frm/core/JobSystem.h>
+#include <frm/core/Serializable.inl>
+#include <frm/core/world/World.h>
+#include <frm/core/world/components/Component.h>
+
+#include <EASTL/vector.h>
+
+#include <thread>
+
+using namespace frm;
+
+// Synthetic component for the World update stress test. Update() is deliberately non-trivial and depends only on the component's own state.
+FRM_COMPONENT_DECLARE(JobSystemTestComponent)
+{
+public:
+
+	static void Update(Component** _from, Component** _to, float _dt, World::UpdatePhase _phase)
+	{
+		for (; _from != _to; ++_from)
+		{
+			JobSystemTestComponent* component = (JobSystemTestComponent*)*_from;
+			for (int i = 0; i < 16; ++i)
+			{
+				component->m_value = Fract(component->m_value * 1.618034f + _dt * (float)((int)_phase + 1));
+			}
+		}
+	}
+
+	void  activate()             { setActive(); }
+	float getValue() const       { return m_value; }
+	void  setValue(float _value) { m_value = _value; }
+
+private:
+
+	float m_value = 0.0f;
+
+	bool isStatic() override { return false; }
+};
+FRM_COMPONENT_DEFINE_PARALLEL(JobSystemTestComponent, 0, 64);
+
+TEST_CASE("ParallelFor", "[JobSystem]")
+{
+	JobSystem::Init(7);
+
+	eastl::vector<uint32> data(100000, 0u);
+	JobSystem::ParallelFor((uint32)data.size(), 64, [&data](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				data[i] = i * 2u;
+			}
+		});
+
+	for (uint32 i = 0; i < (uint32)data.size(); ++i)
+	{
+		REQUIRE(data[i] == i * 2u);
+	}
+
+	// Threads which aren't part of the job system run serially on the calling thread.
+	eastl::vector<std::thread::id> threadIDs(1000);
+	std::thread thread([&threadIDs]()
+		{
+			JobSystem::ParallelFor((uint32)threadIDs.size(), 64, [&threadIDs](uint32 _begin, uint32 _end)
+				{
+					for (uint32 i = _begin; i < _end; ++i)
+					{
+						threadIDs[i] = std::this_thread::get_id();
+					}
+				});
+		});
+	const std::thread::id threadID = thread.get_id();
+	thread.join();
+	for (const std::thread::id& id : threadIDs)
+	{
+		REQUIRE(id == threadID);
+	}
+
+	JobSystem::Shutdown();
+}
+
+TEST_CASE("Dependencies", "[JobSystem]")
+{
+	JobSystem::Init(7);
+
+	struct Data
+	{
+		std::atomic<int> first;
+		std::atomic<int> second;
+		std::atomic<int> orderFailures;
+	};
+	Data data;
+	data.first.store(0);
+	data.second.store(0);
+	data.orderFailures.store(0);
+
+	JobSystem::Counter firstCounter(0);
+	JobSystem::Counter secondCounter(0);
+	for (int i = 0; i < 256; ++i)
+	{
+		JobSystem::Run([](void* _arg) { ((Data*)_arg)->first.fetch_add(1); }, &data, &firstCounter);
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		JobSystem::Run(
+			[](void* _arg)
+			{
+				Data* data = (Data*)_arg;
+				if (data->first.load() != 256)
+				{
+					data->orderFailures.fetch_add(1);
+				}
+				data->second.fetch_add(1);
+			},
+			&data, &secondCounter, &firstCounter);
+	}
+	JobSystem::Wait(&secondCounter);
+
+	REQUIRE(firstCounter.load() == 0);
+	REQUIRE(data.second.load() == 16);
+	REQUIRE(data.orderFailures.load() == 0);
+
+	JobSystem::Shutdown();
+}
+
+TEST_CASE("Job storage overflow", "[JobSystem]")
+{
+	// More jobs than kMaxJobsPerThread, the ring wraps onto jobs which haven't completed. With no workers nothing is executed before
+	// Wait(), hence all jobs beyond the ring size are executed inline.
+	const uint32 kJobCount = JobSystem::kMaxJobsPerThread * 3 + 17;
+	for (int workerCount : { 0, 3 })
+	{
+		JobSystem::Init(workerCount);
+
+		eastl::vector<uint32> data(kJobCount, 0u);
+		JobSystem::Counter counter(0);
+		for (uint32 i = 0; i < kJobCount; ++i)
+		{
+			JobSystem::Run([](void* _arg) { ++(*(uint32*)_arg); }, &data[i], &counter);
+		}
+		JobSystem::Wait(&counter);
+
+		bool match = true;
+		for (uint32 i = 0; i < kJobCount; ++i)
+		{
+			match &= data[i] == 1u;
+		}
+		REQUIRE(match);
+
+		JobSystem::Shutdown();
+	}
+
+	// Nested ParallelFor(), each level creates more chunks than kMaxJobsPerThread.
+	JobSystem::Init(3);
+	const uint32 kOuterCount = 8;
+	eastl::vector<uint32> data(kOuterCount * kJobCount, 0u);
+	JobSystem::ParallelFor(kOuterCount, 1, [&data, kJobCount](uint32 _begin, uint32 _end)
+		{
+			for (uint32 i = _begin; i < _end; ++i)
+			{
+				uint32* outer = data.data() + i * kJobCount;
+				JobSystem::ParallelFor(kJobCount, 1, [outer](uint32 _begin, uint32 _end)
+					{
+						for (uint32 j = _begin; j < _end; ++j)
+						{
+							++outer[j];
+						}
+					});
+			}
+		});
+	bool match = true;
+	for (uint32 value : data)
+	{
+		match &= value == 1u;
+	}
+	REQUIRE(match);
+	JobSystem::Shutdown();
+}
+
+TEST_CASE("World update stress", "[JobSystem]")
+{
+	constexpr int kComponentCount = 50000;
+	constexpr float kDt = 1.0f / 60.0f;
+
+	eastl::vector<JobSystemTestComponent*> components;
+	for (int i = 0; i < kComponentCount; ++i)
+	{
+		JobSystemTestComponent* component = (JobSystemTestComponent*)Component::Create(StringHash("JobSystemTestComponent"));
+		component->setValue((float)i / (float)kComponentCount);
+		components.push_back(component);
+	}
+
+	auto UpdateAllPhases = [&components, kDt]()
+		{
+			Component::ClearActiveComponents();
+			for (JobSystemTestComponent* component : components)
+			{
+				component->activate();
+			}
+			for (int phase = 0; phase < (int)World::UpdatePhase::_Count; ++phase)
+			{
+				Component::Update(kDt, (World::UpdatePhase)phase);
+			}
+		};
+
+	// Serial reference.
+	UpdateAllPhases();
+	eastl::vector<float> reference;
+	for (int i = 0; i < kComponentCount; ++i)
+	{
+		reference.push_back(components[i]->getValue());
+		components[i]->setValue((float)i / (float)kComponentCount);
+	}
+
+	// Parallel.
+	JobSystem::Init();
+	UpdateAllPhases();
+	JobSystem::Shutdown();
+
+	for (int i = 0; i < kComponentCount; ++i)
+	{
+		REQUIRE(components[i]->getValue() == reference[i]);
+	}
+
+	Component::ClearActiveComponents();
+	for (JobSystemTestComponent* component : components)
+	{
+		Component* base = component;
+		Component::Destroy(base);
+	}
+}
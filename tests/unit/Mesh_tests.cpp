@@ -0,0 +1,264 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+#include <frm/core/JobSystem.h>
+#include <frm/core/Mesh.h>
+
+#include <EASTL/vector.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+float Rand(float _min, float _max)
+{
+	return _min + (_max - _min) * ((float)rand() / (float)RAND_MAX);
+}
+
+vec3 RandUnitVector()
+{
+	vec3 ret;
+	do
+	{
+		ret = vec3(Rand(-1.0f, 1.0f), Rand(-1.0f, 1.0f), Rand(-1.0f, 1.0f));
+	}
+	while (Length2(ret) < 0.01f || Length2(ret) > 1.0f);
+	return Normalize(ret);
+}
+
+// Random vertex data with orthogonal tangent frames, 1 triangle per 3 vertices.
+struct TestMesh
+{
+	eastl::vector<vec3> positions;
+	eastl::vector<vec3> normals;
+	eastl::vector<vec4> tangents;
+	eastl::vector<vec2> uvs;
+	eastl::vector<vec4> colors;
+
+	void init(uint32 _vertexCount)
+	{
+		srand(1);
+		for (uint32 i = 0; i < _vertexCount; ++i)
+		{
+			positions.push_back(vec3(Rand(-50.0f, 50.0f), Rand(0.0f, 10.0f), Rand(-1.0f, 1.0f)));
+			const vec3 n = RandUnitVector();
+			const vec3 t = Normalize(cross(n, RandUnitVector()));
+			normals.push_back(n);
+			tangents.push_back(vec4(t, (i % 2) ? 1.0f : -1.0f));
+			uvs.push_back(vec2(Rand(0.0f, 1.0f), Rand(0.0f, 1.0f)));
+			colors.push_back(vec4(Rand(0.0f, 1.0f), Rand(0.0f, 1.0f), Rand(0.0f, 1.0f), 1.0f));
+		}
+	}
+
+	void create(Mesh& mesh_)
+	{
+		const uint32 vertexCount = (uint32)positions.size();
+		mesh_.setVertexCount(vertexCount);
+		mesh_.setVertexData(Mesh::Semantic_Positions,   DataType_Float32, 3, positions.data());
+		mesh_.setVertexData(Mesh::Semantic_Normals,     DataType_Float32, 3, normals.data());
+		mesh_.setVertexData(Mesh::Semantic_Tangents,    DataType_Float32, 4, tangents.data());
+		mesh_.setVertexData(Mesh::Semantic_MaterialUVs, DataType_Float32, 2, uvs.data());
+		mesh_.setVertexData(Mesh::Semantic_Colors,      DataType_Float32, 4, colors.data());
+
+		eastl::vector<uint32> indices(vertexCount);
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			indices[i] = i;
+		}
+		mesh_.setIndexData(0, DataType_Uint32, vertexCount, indices.data());
+	}
+};
+
+// Box with 6 submeshes of 64x64 segments, displaced along the normals such that LOD generation has something to preserve. Vertex and
+// triangle counts span several chunks of the parallel loops in Mesh.cpp.
+Mesh* CreateTestBox()
+{
+	Mesh* ret = Mesh::CreateBox(10.0f, 10.0f, 10.0f, 64, 64, 64);
+	Mesh::VertexDataView<vec3> positions = ret->getVertexDataView<vec3>(Mesh::Semantic_Positions);
+	Mesh::VertexDataView<vec3> normals   = ret->getVertexDataView<vec3>(Mesh::Semantic_Normals);
+	for (uint32 i = 0; i < positions.getCount(); ++i)
+	{
+		const vec3 p = positions[i];
+		positions[i] += normals[i] * (sinf(p.x * 1.3f) * cosf(p.y * 0.7f + p.z * 1.1f) * 0.2f);
+	}
+	return ret;
+}
+
+template <typename tType>
+bool VertexDataEquals(Mesh& _a, Mesh& _b, Mesh::VertexDataSemantic _semantic)
+{
+	Mesh::VertexDataView<tType> a = _a.getVertexDataView<tType>(_semantic);
+	Mesh::VertexDataView<tType> b = _b.getVertexDataView<tType>(_semantic);
+	return a.getCount() == b.getCount() && memcmp(a.begin(), b.begin(), sizeof(tType) * a.getCount()) == 0;
+}
+
+} // namespace
+
+TEST_CASE("FinalizeDefault", "[Mesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(3000);
+	Mesh mesh;
+	testMesh.create(mesh);
+
+	Mesh::FinalizeStats stats;
+	mesh.finalize(Mesh::FinalizeOptions(), &stats);
+
+	REQUIRE(stats.error[Mesh::Semantic_Positions].maxError == 0.0f);
+	REQUIRE(stats.error[Mesh::Semantic_MaterialUVs].maxError == 0.0f);
+	REQUIRE(stats.error[Mesh::Semantic_Normals].maxError < 0.01f);
+	REQUIRE(stats.error[Mesh::Semantic_Tangents].maxError < 0.01f);
+	REQUIRE(stats.error[Mesh::Semantic_Colors].maxError <= 0.5f / 255.0f + 1e-6f);
+
+	// Positions 12 + normals 6 + tangents 8 + uvs 8 + colors 4 bytes.
+	REQUIRE(stats.vertexDataSizeBytes[0] == 3000 * (12 + 12 + 16 + 8 + 16));
+	REQUIRE(stats.vertexDataSizeBytes[1] == 3000 * (12 + 6 + 8 + 8 + 4));
+	REQUIRE(stats.indexDataSizeBytes[1] == stats.indexDataSizeBytes[0] / 2);
+	REQUIRE(mesh.getIndexDataType() == DataType_Uint16);
+}
+
+TEST_CASE("FinalizeQuantization", "[Mesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(3000);
+
+	Mesh::FinalizeOptions options;
+	options.quantization[Mesh::Semantic_Positions]   = Mesh::Quantization_Range16;
+	options.quantization[Mesh::Semantic_Normals]     = Mesh::Quantization_Octahedral16;
+	options.quantization[Mesh::Semantic_MaterialUVs] = Mesh::Quantization_Unorm16;
+	options.quantization[Mesh::Semantic_Colors]      = Mesh::Quantization_Float16;
+
+	{	Mesh mesh;
+		testMesh.create(mesh);
+		Mesh::FinalizeStats stats;
+		mesh.finalize(options, &stats);
+
+		// Half a quantization step of the largest component range.
+		REQUIRE(stats.error[Mesh::Semantic_Positions].maxError < Length(vec3(100.0f, 10.0f, 2.0f) / 65535.0f) * 0.5f + 1e-5f);
+		REQUIRE(stats.error[Mesh::Semantic_Normals].maxError < 0.02f);
+		REQUIRE(stats.error[Mesh::Semantic_MaterialUVs].maxError <= 0.5f / 65535.0f + 1e-6f);
+		REQUIRE(stats.error[Mesh::Semantic_Colors].maxError < 1e-3f);
+
+		// Positions 6 + normals 4 + tangents 8 + uvs 4 + colors 8 bytes.
+		REQUIRE(stats.vertexDataSizeBytes[1] == 3000 * (6 + 4 + 8 + 4 + 8));
+		REQUIRE(stats.vertexDataSizeBytes[0] >= stats.vertexDataSizeBytes[1] * 2);
+	}
+
+	options.quantization[Mesh::Semantic_Normals] = Mesh::Quantization_Octahedral8;
+	{	Mesh mesh;
+		testMesh.create(mesh);
+		Mesh::FinalizeStats stats;
+		mesh.finalize(options, &stats);
+		REQUIRE(stats.error[Mesh::Semantic_Normals].maxError < 1.0f);
+	}
+}
+
+TEST_CASE("FinalizeQTangent", "[Mesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(3000);
+
+	Mesh::FinalizeOptions options;
+	options.quantization[Mesh::Semantic_Tangents] = Mesh::Quantization_QTangent16;
+
+	Mesh mesh;
+	testMesh.create(mesh);
+	Mesh::FinalizeStats stats;
+	mesh.finalize(options, &stats);
+
+	REQUIRE(stats.error[Mesh::Semantic_Normals].maxError < 0.02f);
+	REQUIRE(stats.error[Mesh::Semantic_Tangents].maxError < 0.02f);
+	REQUIRE(mesh.getVertexData(Mesh::Semantic_Tangents) != nullptr);
+
+	// Decode as per Normals_DecodeQTangent() in Normals.glsl.
+	const sint16* qtangents = (const sint16*)mesh.getVertexData(Mesh::Semantic_Tangents);
+	for (uint32 i = 0; i < 3000; ++i)
+	{
+		vec4 q = vec4(qtangents[i * 4 + 0], qtangents[i * 4 + 1], qtangents[i * 4 + 2], qtangents[i * 4 + 3]) / 32767.0f;
+		const float sign = q.w < 0.0f ? -1.0f : 1.0f;
+		q = Normalize(q);
+		const vec3 n = vec3(2.0f * (q.x * q.z + q.y * q.w), 2.0f * (q.y * q.z - q.x * q.w), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+		const vec3 t = vec3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.z * q.w), 2.0f * (q.x * q.z - q.y * q.w));
+		REQUIRE(dot(n, testMesh.normals[i]) > 0.9999f);
+		REQUIRE(dot(t, testMesh.tangents[i].xyz()) > 0.9999f);
+		REQUIRE(sign == testMesh.tangents[i].w);
+	}
+}
+
+TEST_CASE("FinalizeInvalid", "[Mesh]")
+{
+	TestMesh testMesh;
+	testMesh.init(300);
+
+	// Octahedral encoding is only valid for normals, the default is used instead.
+	Mesh::FinalizeOptions options;
+	options.quantization[Mesh::Semantic_Positions] = Mesh::Quantization_Octahedral16;
+
+	Mesh mesh;
+	testMesh.create(mesh);
+	Mesh::FinalizeStats stats;
+	mesh.finalize(options, &stats);
+	REQUIRE(stats.error[Mesh::Semantic_Positions].maxError == 0.0f);
+	REQUIRE(stats.vertexDataSizeBytes[1] == 300 * (12 + 6 + 8 + 8 + 4));
+}
+
+TEST_CASE("ParallelDeterminism", "[Mesh]")
+{
+	// Results must be bitwise identical whether or not the processing is split across the job system.
+	auto Process = [](Mesh& mesh_)
+		{
+			mesh_.generateNormals();
+			mesh_.generateTangents();
+			mesh_.optimize();
+			mesh_.generateLODs(4, 0.5f, 0.05f);
+		};
+
+	// Serial, ParallelFor() calls the function directly if the job system isn't initialized.
+	Mesh* serial = CreateTestBox();
+	Process(*serial);
+	REQUIRE(serial->getIndexData(1) != nullptr); // At least 1 LOD was generated.
+
+	for (int workerCount : { 1, 3, 7 })
+	{
+		JobSystem::Init(workerCount);
+		Mesh* parallel = CreateTestBox();
+		Process(*parallel);
+		JobSystem::Shutdown();
+
+		REQUIRE(parallel->getVertexCount() == serial->getVertexCount());
+		REQUIRE(VertexDataEquals<vec3>(*parallel, *serial, Mesh::Semantic_Positions));
+		REQUIRE(VertexDataEquals<vec3>(*parallel, *serial, Mesh::Semantic_Normals));
+		REQUIRE(VertexDataEquals<vec4>(*parallel, *serial, Mesh::Semantic_Tangents));
+		REQUIRE(VertexDataEquals<vec2>(*parallel, *serial, Mesh::Semantic_MaterialUVs));
+
+		// Index data and submesh ranges for all LODs.
+		uint32 lod = 0;
+		for (; serial->getIndexData(lod) != nullptr; ++lod)
+		{
+			REQUIRE(parallel->getIndexData(lod) != nullptr);
+			const uint32 indexCount = serial->getIndexCount(lod);
+			REQUIRE(parallel->getIndexCount(lod) == indexCount);
+			REQUIRE(memcmp(parallel->getIndexData(lod), serial->getIndexData(lod), sizeof(uint32) * indexCount) == 0);
+
+			uint32 submesh = 1;
+			for (; serial->getIndexData(lod, submesh) != nullptr; ++submesh)
+			{
+				REQUIRE(parallel->getIndexData(lod, submesh) != nullptr);
+				REQUIRE(parallel->getIndexCount(lod, submesh) == serial->getIndexCount(lod, submesh));
+				REQUIRE((char*)parallel->getIndexData(lod, submesh) - (char*)parallel->getIndexData(lod) == (char*)serial->getIndexData(lod, submesh) - (char*)serial->getIndexData(lod));
+			}
+			REQUIRE(submesh == 7);
+			REQUIRE(parallel->getIndexData(lod, submesh) == nullptr);
+		}
+		REQUIRE(parallel->getIndexData(lod) == nullptr);
+
+		Mesh::Destroy(parallel);
+	}
+
+	Mesh::Destroy(serial);
+}
@@ -0,0 +1,182 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/BitArray.h>
+#include <frm/core/rand.h>
+#include <frm/core/Octree.h>
+#include <frm/core/Quadtree.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+TEST_CASE("BitArray", "[Quadtree]")
+{
+	Rand<> rnd;
+
+	BitArray bits(1000, true);
+	eastl::vector<bool> reference(1000, true);
+	REQUIRE(bits.count(0, 1000, true) == 1000);
+	REQUIRE(bits.find(0, 1000, false) == 1000);
+
+	for (int i = 0; i < 200; ++i)
+	{
+		const uint32 index = rnd.get<sint32>(0, 999);
+		bits[index] = false;
+		reference[index] = false;
+	}
+	bits.resize(1100, false);
+	reference.resize(1100, false);
+	bits.setRange(1030, 1070, true);
+	for (uint32 i = 1030; i < 1070; ++i)
+	{
+		reference[i] = true;
+	}
+
+	bool match = true;
+	for (int i = 0; i < 1000; ++i)
+	{
+		uint32 begin = rnd.get<sint32>(0, 1100);
+		uint32 end   = rnd.get<sint32>(0, 1100);
+		if (begin > end)
+		{
+			eastl::swap(begin, end);
+		}
+		for (int value = 0; value < 2; ++value)
+		{
+			uint32 refFind = end, refCount = 0;
+			for (uint32 j = begin; j < end; ++j)
+			{
+				if (reference[j] == (value != 0))
+				{
+					refFind = Min(refFind, j);
+					++refCount;
+				}
+			}
+			match &= bits.find(begin, end, value != 0) == refFind;
+			match &= bits.count(begin, end, value != 0) == refCount;
+		}
+	}
+	for (uint32 i = 0; i < 1100; ++i)
+	{
+		match &= bits[i] == reference[i];
+	}
+	REQUIRE(match);
+}
+
+TEST_CASE("Quadtree linearize/delinearize", "[Quadtree]")
+{
+	typedef Quadtree<uint32, uint32> QuadtreeType;
+	QuadtreeType quadtree(6, 0);
+	for (int level = 0; level < quadtree.getLevelCount(); ++level)
+	{
+		const uint32 width = QuadtreeType::GetWidth(level);
+		eastl::vector<uint32> linear(width * width);
+		for (uint32 i = 0; i < (uint32)linear.size(); ++i)
+		{
+			linear[i] = i;
+		}
+		quadtree.delinearize(level, linear.data());
+
+		bool match = true;
+		for (uint32 y = 0; y < width; ++y)
+		{
+			for (uint32 x = 0; x < width; ++x)
+			{
+				match &= quadtree[QuadtreeType::ToIndex(x, y, level)] == y * width + x;
+			}
+		}
+		eastl::vector<uint32> roundTrip(width * width);
+		quadtree.linearize(level, roundTrip.data());
+		match &= roundTrip == linear;
+		REQUIRE(match);
+	}
+
+	typedef Octree<uint32, uint32> OctreeType;
+	OctreeType octree(5, 0);
+	for (int level = 0; level < octree.getLevelCount(); ++level)
+	{
+		const uint32 width = OctreeType::GetWidth(level);
+		eastl::vector<uint32> linear(width * width * width);
+		for (uint32 i = 0; i < (uint32)linear.size(); ++i)
+		{
+			linear[i] = i;
+		}
+		octree.delinearize(level, linear.data());
+
+		bool match = true;
+		for (uint32 z = 0; z < width; ++z)
+		{
+			for (uint32 y = 0; y < width; ++y)
+			{
+				for (uint32 x = 0; x < width; ++x)
+				{
+					match &= octree[OctreeType::ToIndex(x, y, z, level)] == (z * width + y) * width + x;
+				}
+			}
+		}
+		eastl::vector<uint32> roundTrip(width * width * width);
+		octree.linearize(level, roundTrip.data());
+		match &= roundTrip == linear;
+		REQUIRE(match);
+	}
+}
+
+TEST_CASE("Quadtree bitmap", "[Quadtree]")
+{
+	// Bitmap (bool) and byte (uint8) quadtrees should give identical results.
+	typedef Quadtree<uint16, bool>  BitmapQuadtree;
+	typedef Quadtree<uint16, uint8> ByteQuadtree;
+	const int kLevelCount = 7;
+	BitmapQuadtree bitmapQuadtree(kLevelCount, true);
+	ByteQuadtree   byteQuadtree(kLevelCount, 1);
+
+	Rand<> rnd;
+	for (int i = 0; i < 2000; ++i)
+	{
+		const uint16 index = (uint16)rnd.get<sint32>(0, bitmapQuadtree.getTotalNodeCount() - 1);
+		const bool   value = (rnd.raw() & 1) != 0;
+		bitmapQuadtree[index] = value;
+		byteQuadtree[index]   = value ? 1 : 0;
+	}
+
+	bool match = true;
+	for (int i = 0; i < bitmapQuadtree.getTotalNodeCount(); ++i)
+	{
+		match &= (bool)bitmapQuadtree[(uint16)i] == (byteQuadtree[(uint16)i] != 0);
+	}
+	REQUIRE(match);
+
+	for (int rootLevel = 0; rootLevel < kLevelCount; ++rootLevel)
+	{
+		for (uint16 rootIndex = BitmapQuadtree::GetLevelStartIndex(rootLevel); rootIndex < BitmapQuadtree::GetLevelStartIndex(rootLevel + 1); ++rootIndex)
+		{
+			for (int level = rootLevel; level < kLevelCount; ++level)
+			{
+				for (int value = 0; value < 2; ++value)
+				{
+					match &= bitmapQuadtree.findFirst(level, value != 0, rootIndex) == byteQuadtree.findFirst(level, (uint8)value, rootIndex);
+					match &= bitmapQuadtree.count(level, value != 0, rootIndex) == byteQuadtree.count(level, (uint8)value, rootIndex);
+				}
+			}
+		}
+	}
+	REQUIRE(match);
+
+	// findFirst() returns a node within the subtree.
+	BitmapQuadtree quadtree(kLevelCount, false);
+	const uint16 leafIndex = BitmapQuadtree::ToIndex(37, 21, kLevelCount - 1);
+	quadtree[leafIndex] = true;
+	REQUIRE(quadtree.findFirst(kLevelCount - 1, true) == leafIndex);
+	REQUIRE(quadtree.count(kLevelCount - 1, true) == 1);
+	REQUIRE(quadtree.findFirst(kLevelCount - 1, true, BitmapQuadtree::ToIndex(0, 0, 1)) == BitmapQuadtree::Index_Invalid);
+	REQUIRE(quadtree.findFirst(kLevelCount - 1, true, BitmapQuadtree::ToIndex(1, 0, 1)) == leafIndex);
+
+	// fill() only touches nodes within the subtree.
+	const uint16 rootIndex = BitmapQuadtree::ToIndex(1, 1, 2);
+	quadtree.fill(kLevelCount - 1, true, rootIndex);
+	REQUIRE(quadtree.count(kLevelCount - 1, true) == 1 + BitmapQuadtree::GetNodeCount(kLevelCount - 1 - 2));
+	REQUIRE(quadtree.count(kLevelCount - 1, true, rootIndex) == BitmapQuadtree::GetNodeCount(kLevelCount - 1 - 2));
+	quadtree.fill(kLevelCount - 1, false, rootIndex);
+	REQUIRE(quadtree.count(kLevelCount - 1, true) == 1);
+}
@@ -0,0 +1,100 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/memory.h>
+#include <frm/core/JobSystem.h>
+#include <frm/core/SkeletonAnimation.h>
+#include <frm/core/SplinePath.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+// Unloaded resource with no refs (SkeletonAnimation::Create() requires a path and calls Use()). Adds no members, hence it's safe for
+// SkeletonAnimation::Destroy() to delete via the base.
+class TestAnimation: public SkeletonAnimation
+{
+public:
+	TestAnimation(): SkeletonAnimation(GetUniqueId(), "TestAnimation") {}
+};
+
+} // namespace
+
+TEST_CASE("Find", "[Resource]")
+{
+	const int instanceCount = SplinePath::GetInstanceCount();
+	SplinePath* a = SplinePath::CreateUnique();
+	SplinePath* b = SplinePath::CreateUnique();
+	const SplinePath::Id idA = a->getId();
+	REQUIRE(SplinePath::Find(idA) == a);
+	REQUIRE(SplinePath::Find(b->getId()) == b);
+
+	a->setName("ResourceTestA");
+	REQUIRE(SplinePath::Find("ResourceTestA") == a);
+
+	// Rename, the old name is removed from the index.
+	a->setName("ResourceTestRenamed");
+	REQUIRE(SplinePath::Find("ResourceTestA") == nullptr);
+	REQUIRE(SplinePath::Find("ResourceTestRenamed") == a);
+
+	// Shared names, Find() returns the first in the instance list.
+	b->setName("ResourceTestRenamed");
+	REQUIRE(SplinePath::Find("ResourceTestRenamed") == a);
+
+	// setName() isn't a format string.
+	b->setName("ResourceTest%d");
+	REQUIRE(SplinePath::Find("ResourceTest%d") == b);
+	REQUIRE(strcmp(b->getName(), "ResourceTest%d") == 0);
+
+	// Destroy removes the instance from both indices.
+	SplinePath::Release(a);
+	REQUIRE(SplinePath::Find(idA) == nullptr);
+	REQUIRE(SplinePath::Find("ResourceTestRenamed") == nullptr);
+	REQUIRE(SplinePath::Find("ResourceTest%d") == b);
+	REQUIRE(SplinePath::GetInstanceCount() == instanceCount + 1);
+	SplinePath::Release(b);
+	REQUIRE(SplinePath::GetInstanceCount() == instanceCount);
+}
+
+TEST_CASE("Async", "[Resource]")
+{
+	JobSystem::Init(2);
+
+	const int instanceCount = SkeletonAnimation::GetInstanceCount();
+	eastl::vector<SkeletonAnimation*> anims;
+	for (int i = 0; i < 8; ++i)
+	{
+		anims.push_back(FRM_NEW(TestAnimation));
+		SkeletonAnimation::UseAsync(anims.back());
+		REQUIRE(anims.back()->isAsyncPending());
+	}
+	REQUIRE(SkeletonAnimation::GetPendingCount() == 8);
+
+	// Use() doesn't block, the resource remains pending until Update().
+	SkeletonAnimation::Use(anims[0]);
+	REQUIRE(anims[0]->isAsyncPending());
+	REQUIRE(anims[0]->getRefCount() == 2);
+	SkeletonAnimation* anim0 = anims[0];
+	SkeletonAnimation::Release(anim0);
+
+	// Released while the load is in flight, destroyed by Update().
+	SkeletonAnimation* released = anims.back();
+	anims.pop_back();
+	SkeletonAnimation::Release(released);
+	REQUIRE(SkeletonAnimation::GetInstanceCount() == instanceCount + 8);
+
+	SkeletonAnimation::WaitAsync();
+	REQUIRE(SkeletonAnimation::GetPendingCount() == 0);
+	REQUIRE(SkeletonAnimation::GetInstanceCount() == instanceCount + 7);
+	for (SkeletonAnimation*& anim : anims)
+	{
+		REQUIRE(anim->getState() == SkeletonAnimation::State_Loaded);
+		REQUIRE(SkeletonAnimation::Find(anim->getId()) == anim);
+		SkeletonAnimation::Release(anim);
+	}
+	REQUIRE(SkeletonAnimation::GetInstanceCount() == instanceCount);
+
+	JobSystem::Shutdown();
+}
@@ -0,0 +1,305 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/memory.h>
+#include <frm/core/File.h>
+#include <frm/core/Json.h>
+#include <frm/core/SerializerBinary.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+// Representative of a cooked asset: scalars of all types, nested objects, arrays which can/can't be packed, strings and binary data.
+struct TestData
+{
+	struct Node
+	{
+		String<32> name;
+		mat4       world      = identity;
+		uint32     meshIndex  = 0;
+		eastl::vector<sint32> children;
+	};
+
+	bool                  flag       = false;
+	sint8                 s8         = 0;
+	uint8                 u8         = 0;
+	sint16                s16        = 0;
+	uint16                u16        = 0;
+	sint32                s32        = 0;
+	uint32                u32        = 0;
+	sint64                s64        = 0;
+	uint64                u64        = 0;
+	float32               f32        = 0.0f;
+	float64               f64        = 0.0;
+	vec3                  position   = vec3(0.0f);
+	String<64>            str;
+	String<64>            emptyStr   = "not empty";
+	eastl::vector<Node>   nodes;
+	eastl::vector<uint16> indices;
+	eastl::vector<char>   blob;
+	eastl::vector<char>   compressedBlob;
+
+	void init()
+	{
+		flag       = true;
+		s8         = -8;
+		u8         = 200;
+		s16        = -1600;
+		u16        = 60000;
+		s32        = -3200000;
+		u32        = 4000000000u;
+		s64        = -6400000000000ll;
+		u64        = 18000000000000000000ull;
+		f32        = 3.25f;
+		f64        = 1.0 / 3.0;
+		position   = vec3(1.0f, -2.0f, 3.5f);
+		str        = "Hello, world";
+		emptyStr   = "";
+
+		for (int i = 0; i < 8; ++i)
+		{
+			Node node;
+			node.name.setf("Node%d", i);
+			node.world = TranslationMatrix(vec3((float)i, 0.0f, -(float)i));
+			node.meshIndex = (uint32)i * 3;
+			for (int j = 0; j < i; ++j)
+			{
+				node.children.push_back(j);
+			}
+			nodes.push_back(node);
+		}
+
+		for (int i = 0; i < 1000; ++i)
+		{
+			indices.push_back((uint16)(i * 7 % 1001));
+		}
+
+		for (int i = 0; i < 333; ++i)
+		{
+			blob.push_back((char)(i * 31));
+			compressedBlob.push_back((char)(i / 16));
+		}
+	}
+
+	bool serialize(Serializer& _serializer_)
+	{
+		bool ret = true;
+		ret &= Serialize(_serializer_, flag,     "Flag");
+		ret &= Serialize(_serializer_, s8,       "S8");
+		ret &= Serialize(_serializer_, u8,       "U8");
+		ret &= Serialize(_serializer_, s16,      "S16");
+		ret &= Serialize(_serializer_, u16,      "U16");
+		ret &= Serialize(_serializer_, s32,      "S32");
+		ret &= Serialize(_serializer_, u32,      "U32");
+		ret &= Serialize(_serializer_, s64,      "S64");
+		ret &= Serialize(_serializer_, u64,      "U64");
+		ret &= Serialize(_serializer_, f32,      "F32");
+		ret &= Serialize(_serializer_, f64,      "F64");
+		ret &= Serialize(_serializer_, position, "Position");
+		ret &= Serialize(_serializer_, str,      "Str");
+		ret &= Serialize(_serializer_, emptyStr, "EmptyStr");
+
+		uint nodeCount = (uint)nodes.size();
+		if (_serializer_.beginArray(nodeCount, "Nodes"))
+		{
+			nodes.resize(nodeCount);
+			for (Node& node : nodes)
+			{
+				ret &= _serializer_.beginObject();
+				ret &= Serialize(_serializer_, node.name,      "Name");
+				ret &= Serialize(_serializer_, node.world,     "World");
+				ret &= Serialize(_serializer_, node.meshIndex, "MeshIndex");
+				uint childCount = (uint)node.children.size();
+				if (_serializer_.beginArray(childCount, "Children"))
+				{
+					node.children.resize(childCount);
+					for (sint32& child : node.children)
+					{
+						ret &= _serializer_.value(child);
+					}
+					_serializer_.endArray();
+				}
+				_serializer_.endObject();
+			}
+			_serializer_.endArray();
+		}
+
+		uint indexCount = (uint)indices.size();
+		if (_serializer_.beginArray(indexCount, "Indices"))
+		{
+			indices.resize(indexCount);
+			for (uint16& index : indices)
+			{
+				ret &= _serializer_.value(index);
+			}
+			_serializer_.endArray();
+		}
+
+		ret &= serializeBlob(_serializer_, blob, "Blob", CompressionFlags_None);
+		ret &= serializeBlob(_serializer_, compressedBlob, "CompressedBlob", CompressionFlags_Speed);
+
+		return ret;
+	}
+
+	static bool serializeBlob(Serializer& _serializer_, eastl::vector<char>& _blob_, const char* _name, CompressionFlags _flags)
+	{
+		void* data = _serializer_.getMode() == Serializer::Mode_Write ? _blob_.data() : nullptr;
+		uint sizeBytes = (uint)_blob_.size();
+		if (!_serializer_.binary(data, sizeBytes, _name, _flags))
+		{
+			return false;
+		}
+		if (_serializer_.getMode() == Serializer::Mode_Read)
+		{
+			_blob_.assign((char*)data, (char*)data + sizeBytes);
+			FRM_FREE(data);
+		}
+		return true;
+	}
+
+	bool operator==(const TestData& _rhs) const
+	{
+		if (nodes.size() != _rhs.nodes.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			const Node& a = nodes[i];
+			const Node& b = _rhs.nodes[i];
+			if (a.name != b.name || a.meshIndex != b.meshIndex || a.children != b.children || memcmp(&a.world, &b.world, sizeof(mat4)) != 0)
+			{
+				return false;
+			}
+		}
+		return flag == _rhs.flag
+			&& s8 == _rhs.s8 && u8 == _rhs.u8
+			&& s16 == _rhs.s16 && u16 == _rhs.u16
+			&& s32 == _rhs.s32 && u32 == _rhs.u32
+			&& s64 == _rhs.s64 && u64 == _rhs.u64
+			&& f32 == _rhs.f32 && f64 == _rhs.f64
+			&& position == _rhs.position
+			&& str == _rhs.str && emptyStr == _rhs.emptyStr
+			&& indices == _rhs.indices
+			&& blob == _rhs.blob && compressedBlob == _rhs.compressedBlob
+			;
+	}
+};
+
+} // namespace
+
+TEST_CASE("RoundTrip", "[SerializerBinary]")
+{
+	TestData src;
+	src.init();
+
+	for (CompressionFlags flags : { CompressionFlags_None, CompressionFlags_Speed, CompressionFlags_Size })
+	{
+		File file;
+		{	SerializerBinary serializer(SerializerBinary::Mode_Write);
+			REQUIRE(src.serialize(serializer));
+			REQUIRE(SerializerBinary::Write(serializer, file, flags));
+		}
+		REQUIRE(SerializerBinary::IsBinary(file));
+
+		SerializerBinary serializer(SerializerBinary::Mode_Read);
+		REQUIRE(SerializerBinary::Read(serializer, file));
+		TestData dst;
+		REQUIRE(dst.serialize(serializer));
+		REQUIRE(serializer.getError() == nullptr);
+		REQUIRE(dst == src);
+	}
+}
+
+TEST_CASE("MatchesJson", "[SerializerBinary]")
+{
+	TestData src;
+	src.init();
+
+	Json json;
+	{	SerializerJson serializer(json, SerializerJson::Mode_Write);
+		REQUIRE(src.serialize(serializer));
+	}
+	TestData fromJson;
+	{	SerializerJson serializer(json, SerializerJson::Mode_Read);
+		REQUIRE(fromJson.serialize(serializer));
+	}
+
+	SerializerBinary serializer(SerializerBinary::Mode_Write);
+	REQUIRE(fromJson.serialize(serializer));
+	serializer.setMode(SerializerBinary::Mode_Read); // read back the in-memory stream
+	TestData fromBinary;
+	REQUIRE(fromBinary.serialize(serializer));
+	REQUIRE(fromBinary == fromJson);
+
+	File jsonFile;
+	Json::Write(json, jsonFile);
+	REQUIRE(!SerializerBinary::IsBinary(jsonFile));
+}
+
+TEST_CASE("OutOfOrderAndMissing", "[SerializerBinary]")
+{
+	SerializerBinary serializer(SerializerBinary::Mode_Write);
+	sint32 a = 1, b = 2, c = 3;
+	String<16> s = "abc";
+	serializer.beginObject("Object");
+		serializer.value(a, "A");
+		serializer.value(b, "B");
+		serializer.value(s, "S");
+		serializer.value(c, "C");
+	serializer.endObject();
+	serializer.setMode(SerializerBinary::Mode_Read);
+
+	REQUIRE(serializer.beginObject("Object"));
+		sint32 v = 0;
+		REQUIRE(serializer.value(v, "C"));
+		REQUIRE(v == 3);
+		REQUIRE(serializer.value(v, "A"));
+		REQUIRE(v == 1);
+		REQUIRE(!serializer.value(v, "Missing"));
+		REQUIRE(!serializer.beginObject("A"));          // not an object
+		float64 f = 0.0;
+		REQUIRE(serializer.value(f, "B"));              // numeric conversion
+		REQUIRE(f == 2.0);
+		REQUIRE(!serializer.value(v, "S"));             // not a number
+		REQUIRE(serializer.getError() != nullptr);
+		REQUIRE(!serializer.value(v, "Object"));        // name exists in the stream but not in this object
+	serializer.endObject();
+	REQUIRE(!serializer.beginObject("Missing"));
+}
+
+TEST_CASE("BinaryToBuffer", "[SerializerBinary]")
+{
+	eastl::vector<char> src(100000);
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		src[i] = (char)(i / 100);
+	}
+
+	SerializerBinary serializer(SerializerBinary::Mode_Write);
+	void* data = src.data();
+	uint sizeBytes = (uint)src.size();
+	serializer.binary(data, sizeBytes, "Compressed", CompressionFlags_Speed);
+	serializer.binary(data, sizeBytes, "Uncompressed");
+	serializer.setMode(SerializerBinary::Mode_Read);
+
+	// Read into an existing buffer (compressed data is decompressed directly to the buffer).
+	eastl::vector<char> dst(src.size());
+	for (const char* name : { "Compressed", "Uncompressed" })
+	{
+		eastl::fill(dst.begin(), dst.end(), 0);
+		data = dst.data();
+		sizeBytes = (uint)dst.size();
+		REQUIRE(serializer.binary(data, sizeBytes, name));
+		REQUIRE(dst == src);
+	}
+
+	// Size mismatch.
+	data = dst.data();
+	sizeBytes = (uint)dst.size() - 1;
+	REQUIRE(!serializer.binary(data, sizeBytes, "Compressed"));
+	REQUIRE(serializer.getError() != nullptr);
+}
@@ -0,0 +1,147 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/File.h>
+#include <frm/core/FileSystem.h>
+#include <frm/core/ShaderCache.h>
+#include <frm/core/Time.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace frm;
+
+namespace {
+
+// Unique temporary directory, set as the default root such that all relative paths (including the cache in '_cache/shaders/') resolve
+// to it. Deleted with its contents on destruction.
+struct TempRoot
+{
+	PathStr path;
+	int     prevDefaultRoot;
+
+	TempRoot(const char* _name)
+	{
+		FileSystem::AddRoot(""); // no-op if already added
+		prevDefaultRoot = FileSystem::GetDefaultRoot();
+
+		const char* tmp = getenv("TMPDIR");
+		tmp = tmp ? tmp : getenv("TEMP");
+		tmp = tmp ? tmp : "/tmp";
+		path.setf("%s/%s_%llu", tmp, _name, (unsigned long long)Time::GetTimestamp().getRaw());
+		FileSystem::Sanitize(path);
+		REQUIRE(FileSystem::CreateDir(PathStr("%s/", path.c_str()).c_str()));
+		FileSystem::SetDefaultRoot(FileSystem::AddRoot(path.c_str()));
+	}
+
+	~TempRoot()
+	{
+		FileSystem::SetDefaultRoot(prevDefaultRoot);
+		FileSystem::DeleteDir(path.c_str(), true);
+	}
+};
+
+void WriteTextFile(const char* _path, const char* _text)
+{
+	File file;
+	file.setData(_text, strlen(_text));
+	REQUIRE(FileSystem::Write(file, _path));
+}
+
+ShaderCache::SourceEntry CreateSourceEntry()
+{
+	WriteTextFile("ShaderCache_tests/common.glsl", "float Common() { return 1.0; }\n");
+	WriteTextFile("ShaderCache_tests/shader.glsl", "#include \"common.glsl\"\nvoid main() {}\n");
+
+	ShaderCache::SourceEntry ret;
+	ret.source  = "float Common() { return 1.0; }\nvoid main() {}\n";
+	ret.version = "450 core";
+	ret.extensions.push_back(eastl::make_pair(ShaderCache::Str("GL_ARB_bindless_texture"), ShaderCache::Str("require")));
+	ret.dependencies.push_back().path = FileSystem::MakePath("ShaderCache_tests/shader.glsl");
+	ret.dependencies.push_back().path = FileSystem::MakePath("ShaderCache_tests/common.glsl");
+	return ret;
+}
+
+void RequireEqual(const ShaderCache::SourceEntry& _a, const ShaderCache::SourceEntry& _b)
+{
+	REQUIRE(_a.source == _b.source);
+	REQUIRE(_a.version == _b.version);
+	REQUIRE(_a.extensions.size() == _b.extensions.size());
+	for (uint i = 0; i < _a.extensions.size(); ++i)
+	{
+		REQUIRE(_a.extensions[i].first == _b.extensions[i].first);
+		REQUIRE(_a.extensions[i].second == _b.extensions[i].second);
+	}
+	REQUIRE(_a.dependencies.size() == _b.dependencies.size());
+	for (uint i = 0; i < _a.dependencies.size(); ++i)
+	{
+		REQUIRE(_a.dependencies[i].path == _b.dependencies[i].path);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Source", "[ShaderCache]")
+{
+	TempRoot root("ShaderCache_tests");
+
+	const uint64 key = 0x5eed0001ull;
+	const ShaderCache::SourceEntry src = CreateSourceEntry();
+	ShaderCache::SourceEntry dst;
+	REQUIRE(!ShaderCache::FindSource(key + 1, dst));
+	REQUIRE(ShaderCache::AddSource(key, src));
+
+	// Memory.
+	REQUIRE(ShaderCache::FindSource(key, dst));
+	RequireEqual(src, dst);
+	REQUIRE(dst.dependencies[1].hash == FileSystem::GetHash("ShaderCache_tests/common.glsl"));
+
+	// Disk.
+	ShaderCache::Clear();
+	dst = ShaderCache::SourceEntry();
+	REQUIRE(ShaderCache::FindSource(key, dst));
+	RequireEqual(src, dst);
+
+	// Removing a dependency invalidates the entry, both in memory and on disk.
+	REQUIRE(FileSystem::Delete(FileSystem::MakePath("ShaderCache_tests/common.glsl").c_str()));
+	REQUIRE(!ShaderCache::FindSource(key, dst));
+	ShaderCache::Clear();
+	REQUIRE(!ShaderCache::FindSource(key, dst));
+
+	// Valid again once the dependency is restored.
+	CreateSourceEntry();
+	REQUIRE(ShaderCache::FindSource(key, dst));
+	RequireEqual(src, dst);
+}
+
+TEST_CASE("Program", "[ShaderCache]")
+{
+	TempRoot root("ShaderCache_tests");
+
+	const uint64 key = 0x5eed0002ull;
+	ShaderCache::ProgramEntry src;
+	src.binaryFormat = 0x1234;
+	for (int i = 0; i < 1000; ++i)
+	{
+		src.binary.push_back((char)(i * 7)); // includes zeros, the last byte is 0
+	}
+	src.binary.push_back(0);
+	REQUIRE(ShaderCache::AddProgram(key, src));
+
+	// Program entries with no dependencies (e.g. source set directly) are always valid.
+	ShaderCache::Clear();
+	ShaderCache::ProgramEntry dst;
+	REQUIRE(ShaderCache::FindProgram(key, dst));
+	REQUIRE(dst.binaryFormat == 0x1234);
+	REQUIRE(dst.binary.size() == src.binary.size());
+	REQUIRE(memcmp(dst.binary.data(), src.binary.data(), src.binary.size()) == 0);
+
+	// Source and program entries with the same key are distinct.
+	ShaderCache::SourceEntry source;
+	REQUIRE(!ShaderCache::FindSource(key, source));
+
+	// Invalid data on disk is ignored.
+	WriteTextFile("_cache/shaders/000000005eed0002.bin", "not a shader cache entry");
+	ShaderCache::Clear();
+	REQUIRE(!ShaderCache::FindProgram(key, dst));
+}
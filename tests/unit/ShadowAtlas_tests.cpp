@@ -0,0 +1,223 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/Log.h>
+#include <frm/core/rand.h>
+#include <frm/core/ShadowAtlas.h>
+#include <frm/core/Time.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+typedef ShadowAtlas::Allocator  Allocator;
+typedef Allocator::Allocation Allocation;
+typedef Allocator::Quadtree   BitmapQuadtree;
+
+struct AllocationRef
+{
+	Allocation allocation;
+	int        level;
+};
+
+// Rasterize allocations into a finest level grid per layer. Return false if any allocations overlap, or if the state of any node
+// is inconsistent with the allocations (a node is free iff no allocation overlaps it).
+bool IsValid(const Allocator& _allocator, const eastl::vector<AllocationRef>& _allocations)
+{
+	const int levelCount = _allocator.getLevelCount();
+	const int width = (int)BitmapQuadtree::GetWidth(levelCount - 1);
+	eastl::vector<int> grid(width * width * _allocator.getArrayCount(), 0);
+	for (const AllocationRef& ref : _allocations)
+	{
+		const int n = (int)BitmapQuadtree::GetWidth(levelCount - 1 - ref.level);
+		const uvec2 origin = BitmapQuadtree::ToCartesian(ref.allocation.nodeIndex, ref.level) * (uint32)n;
+		int* layer = grid.data() + ref.allocation.arrayIndex * width * width;
+		for (int y = (int)origin.y; y < (int)origin.y + n; ++y)
+		{
+			for (int x = (int)origin.x; x < (int)origin.x + n; ++x)
+			{
+				if (++layer[y * width + x] > 1)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	for (int arrayIndex = 0; arrayIndex < _allocator.getArrayCount(); ++arrayIndex)
+	{
+		const int* layer = grid.data() + arrayIndex * width * width;
+		for (int level = 0; level < levelCount; ++level)
+		{
+			const int n = (int)BitmapQuadtree::GetWidth(levelCount - 1 - level);
+			for (BitmapQuadtree::Index nodeIndex = BitmapQuadtree::GetLevelStartIndex(level); nodeIndex < BitmapQuadtree::GetLevelStartIndex(level + 1); ++nodeIndex)
+			{
+				const uvec2 origin = BitmapQuadtree::ToCartesian(nodeIndex, level) * (uint32)n;
+				bool isFree = true;
+				for (int y = (int)origin.y; y < (int)origin.y + n; ++y)
+				{
+					for (int x = (int)origin.x; x < (int)origin.x + n; ++x)
+					{
+						isFree &= layer[y * width + x] == 0;
+					}
+				}
+				if (isFree != _allocator.isFree(arrayIndex, nodeIndex))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("AllocFree", "[ShadowAtlas]")
+{
+	const int kLevelCount = 6;
+	Allocator allocator(kLevelCount, 2);
+	Rand<> rand;
+
+	eastl::vector<AllocationRef> allocations;
+	for (int i = 0; i < 1000; ++i)
+	{
+		if (!allocations.empty() && (rand.raw() % 3) == 0)
+		{
+			const size_t j = (size_t)rand.get<sint32>(0, (sint32)allocations.size() - 1);
+			allocator.free(allocations[j].allocation);
+			allocations.erase_unsorted(allocations.begin() + j);
+		}
+		else
+		{
+			AllocationRef ref;
+			ref.level = rand.get<sint32>(1, kLevelCount - 1);
+			if (allocator.alloc(ref.level, ref.allocation))
+			{
+				allocations.push_back(ref);
+			}
+		}
+
+		if ((i % 50) == 0)
+		{
+			REQUIRE(IsValid(allocator, allocations));
+		}
+	}
+	REQUIRE(IsValid(allocator, allocations));
+	REQUIRE(allocator.getAllocationCount() == allocations.size());
+
+	// A level 0 allocation fills a whole layer.
+	while (!allocations.empty())
+	{
+		allocator.free(allocations.back().allocation);
+		allocations.pop_back();
+	}
+	REQUIRE(allocator.getUsedArea() == 0);
+	REQUIRE(allocator.findLargestFreeLevel() == 0);
+	AllocationRef ref;
+	ref.level = 0;
+	REQUIRE(allocator.alloc(0, ref.allocation));
+	allocations.push_back(ref);
+	REQUIRE(allocator.alloc(0, ref.allocation));
+	allocations.push_back(ref);
+	REQUIRE(IsValid(allocator, allocations));
+	REQUIRE(!allocator.alloc(kLevelCount - 1, ref.allocation));
+	REQUIRE(allocator.findLargestFreeLevel() == -1);
+	REQUIRE(allocator.getUsedArea() == allocator.getTotalArea());
+
+	allocator.reset();
+	REQUIRE(allocator.getAllocationCount() == 0);
+	REQUIRE(IsValid(allocator, eastl::vector<AllocationRef>()));
+}
+
+TEST_CASE("BatchAlloc", "[ShadowAtlas]")
+{
+	// Largest first packing fills the atlas exactly if the total area matches, regardless of the input order.
+	const int kLevelCount = 5;
+	const int kArrayCount = 3;
+	Allocator allocator(kLevelCount, kArrayCount);
+	Rand<> rand;
+
+	eastl::vector<int> levels;
+	uint64 area = 0;
+	const uint64 totalArea = allocator.getTotalArea();
+	while (area < totalArea)
+	{
+		const int level = rand.get<sint32>(1, kLevelCount - 1);
+		const uint64 levelArea = BitmapQuadtree::GetNodeCount(kLevelCount - 1 - level);
+		if (area + levelArea <= totalArea)
+		{
+			levels.push_back(level);
+			area += levelArea;
+		}
+	}
+	levels.push_back(-1); // skipped
+
+	eastl::vector<Allocation> allocations(levels.size());
+	const int count = allocator.alloc(levels.data(), (int)levels.size(), allocations.data());
+	REQUIRE(count == (int)levels.size() - 1);
+	REQUIRE(allocations.back().nodeIndex == BitmapQuadtree::Index_Invalid);
+	REQUIRE(allocator.getUsedArea() == totalArea);
+
+	eastl::vector<AllocationRef> refs;
+	for (size_t i = 0; i + 1 < levels.size(); ++i)
+	{
+		REQUIRE(BitmapQuadtree::FindLevel(allocations[i].nodeIndex) == levels[i]);
+		refs.push_back({ allocations[i], levels[i] });
+	}
+	REQUIRE(IsValid(allocator, refs));
+
+	// Atlas is full, all subsequent allocations fail.
+	const int count2 = allocator.alloc(levels.data(), (int)levels.size(), allocations.data());
+	REQUIRE(count2 == 0);
+}
+
+TEST_CASE("Performance", "[ShadowAtlas]")
+{
+	// Per frame realloc of a few hundred shadow maps (as in BasicRenderer), single vs batch alloc. Total requested area is ~half the
+	// atlas area.
+	const int kLevelCount = 7;
+	const int kArrayCount = 4;
+	const int kLightCount = 400;
+	const int kFrameCount = 200;
+	Allocator allocator(kLevelCount, kArrayCount);
+	Rand<> rand;
+
+	eastl::vector<int> levels(kLightCount);
+	for (int& level : levels)
+	{
+		level = rand.get<sint32>(3, kLevelCount - 1);
+	}
+	eastl::vector<Allocation> allocations(kLightCount);
+
+	int singleCount = 0;
+	{	FRM_AUTOTIMER("Single alloc (%d lights x %d frames)", kLightCount, kFrameCount);
+		for (int frame = 0; frame < kFrameCount; ++frame)
+		{
+			allocator.reset();
+			singleCount = 0;
+			for (int i = 0; i < kLightCount; ++i)
+			{
+				singleCount += allocator.alloc(levels[i], allocations[i]) ? 1 : 0;
+			}
+		}
+	}
+	const float singleUtilization = (float)allocator.getUsedArea() / (float)allocator.getTotalArea();
+
+	int batchCount = 0;
+	{	FRM_AUTOTIMER("Batch alloc (%d lights x %d frames)", kLightCount, kFrameCount);
+		for (int frame = 0; frame < kFrameCount; ++frame)
+		{
+			allocator.reset();
+			batchCount = allocator.alloc(levels.data(), kLightCount, allocations.data());
+		}
+	}
+	const float batchUtilization = (float)allocator.getUsedArea() / (float)allocator.getTotalArea();
+
+	FRM_LOG("Single: %d/%d allocated, utilization %.3f", singleCount, kLightCount, singleUtilization);
+	FRM_LOG("Batch:  %d/%d allocated, utilization %.3f", batchCount, kLightCount, batchUtilization);
+	REQUIRE(batchCount == kLightCount);
+}
@@ -0,0 +1,403 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/interpolation.h>
+#include <frm/core/Log.h>
+#include <frm/core/math.h>
+#include <frm/core/rand.h>
+#include <frm/core/SkeletonAnimation.h>
+#include <frm/core/Time.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+// Procedural animation, SkeletonAnimation::Create() requires a path.
+class TestAnimation: public SkeletonAnimation
+{
+public:
+	TestAnimation(): SkeletonAnimation(GetUniqueId(), "TestAnimation") {}
+};
+
+// Binary tree hierarchy, parents precede children.
+Skeleton CreateSkeleton(int _boneCount, Rand<>& _rand)
+{
+	Skeleton ret;
+	for (int i = 0; i < _boneCount; ++i)
+	{
+		ret.addBone("bone", i == 0 ? -1 : (i - 1) / 2);
+		Skeleton::Bone& bone = ret.getBone(i);
+		bone.translation = vec3(_rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f));
+		bone.rotation    = normalize(quat(_rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f)));
+	}
+	return ret;
+}
+
+quat RandomRotation(Rand<>& _rand, const quat& _prev, float _maxAngle)
+{
+	const vec3 axis = normalize(vec3(_rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f)));
+	return normalize(linalg::qmul(RotationQuaternion(axis, _rand.get<float>(-_maxAngle, _maxAngle)), _prev));
+}
+
+// Translation tracks share key times, rotation and scale tracks (every 3rd bone) have their own. All tracks start at 0 and end
+// at 1. Rotation keys are 'close' so that slerp ~= nlerp.
+void CreateAnimation(SkeletonAnimation& anim_, const Skeleton& _skeleton, int _keyCount, Rand<>& _rand)
+{
+	eastl::vector<float> times;
+	eastl::vector<float> data;
+	for (int boneIndex = 0; boneIndex < _skeleton.getBoneCount(); ++boneIndex)
+	{
+		times.clear();
+		data.clear();
+		for (int i = 0; i < _keyCount; ++i)
+		{
+			times.push_back((float)i / (float)(_keyCount - 1));
+			data.push_back(_rand.get<float>(-1.0f, 1.0f));
+			data.push_back(_rand.get<float>(-1.0f, 1.0f));
+			data.push_back(_rand.get<float>(-1.0f, 1.0f));
+		}
+		anim_.addTranslationTrack(boneIndex, _keyCount, times.data(), data.data());
+
+		const int keyCount = _rand.get<sint32>(2, _keyCount);
+		times.clear();
+		data.clear();
+		quat q = _skeleton.getBone(boneIndex).rotation;
+		for (int i = 0; i < keyCount; ++i)
+		{
+			times.push_back(i == 0 ? 0.0f : (i == keyCount - 1 ? 1.0f : ((float)i + _rand.get<float>(-0.4f, 0.4f)) / (float)(keyCount - 1)));
+			q = RandomRotation(_rand, q, 0.3f);
+			if (_rand.get<sint32>(0, 1))
+			{
+				q = -q; // keys may be in either hemisphere
+			}
+			data.insert(data.end(), &q.x, &q.x + 4);
+		}
+		anim_.addRotationTrack(boneIndex, keyCount, times.data(), data.data());
+
+		if ((boneIndex % 3) == 0)
+		{
+			times.clear();
+			data.clear();
+			times.push_back(0.0f);
+			times.push_back(0.7f);
+			times.push_back(1.0f);
+			for (int i = 0; i < 3; ++i)
+			{
+				data.push_back(_rand.get<float>(0.5f, 2.0f));
+				data.push_back(_rand.get<float>(0.5f, 2.0f));
+				data.push_back(_rand.get<float>(0.5f, 2.0f));
+			}
+			anim_.addScaleTrack(boneIndex, 3, times.data(), data.data());
+		}
+	}
+}
+
+SkeletonPose RandomPose(int _boneCount, Rand<>& _rand)
+{
+	SkeletonPose ret(_boneCount);
+	for (int i = 0; i < _boneCount; ++i)
+	{
+		ret.setTranslation(i, vec3(_rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f), _rand.get<float>(-1.0f, 1.0f)));
+		ret.setRotation(i, RandomRotation(_rand, quat(0.0f, 0.0f, 0.0f, 1.0f), 3.0f));
+		ret.setScale(i, vec3(_rand.get<float>(0.5f, 2.0f), _rand.get<float>(0.5f, 2.0f), _rand.get<float>(0.5f, 2.0f)));
+	}
+	return ret;
+}
+
+bool Equal(const vec3& _a, const vec3& _b, float _epsilon)
+{
+	return length(_a - _b) < _epsilon;
+}
+
+// q and -q are the same rotation.
+bool Equal(const quat& _a, const quat& _b, float _epsilon)
+{
+	return 1.0f - Abs(dot(_a, _b)) < _epsilon;
+}
+
+bool Equal(const SkeletonPose& _a, const SkeletonPose& _b, float _epsilon)
+{
+	bool ret = _a.getBoneCount() == _b.getBoneCount();
+	for (int i = 0; ret && i < _a.getBoneCount(); ++i)
+	{
+		ret &= Equal(_a.getTranslation(i), _b.getTranslation(i), _epsilon);
+		ret &= Equal(_a.getRotation(i), _b.getRotation(i), _epsilon);
+		ret &= Equal(_a.getScale(i), _b.getScale(i), _epsilon);
+	}
+	return ret;
+}
+
+// Reference for Skeleton::resolve().
+void ResolveReference(const Skeleton& _skeleton, eastl::vector<mat4>& pose_)
+{
+	pose_.resize(_skeleton.getBoneCount());
+	for (int i = 0; i < _skeleton.getBoneCount(); ++i)
+	{
+		const Skeleton::Bone& bone = _skeleton.getBone(i);
+		pose_[i] = TransformationMatrix(bone.translation, bone.rotation, bone.scale);
+		if (bone.parentIndex >= 0)
+		{
+			pose_[i] = pose_[bone.parentIndex] * pose_[i];
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("Sample", "[SkeletonAnimation]")
+{
+	Rand<> rand;
+	const Skeleton skeleton = CreateSkeleton(37, rand);
+	TestAnimation anim;
+	CreateAnimation(anim, skeleton, 12, rand);
+
+	// SoA sampling matches per track sampling (slerp vs nlerp for rotations).
+	SkeletonPose pose(skeleton.getBoneCount());
+	SkeletonPose poseNoCursor(skeleton.getBoneCount());
+	int cursor = 0;
+	bool match = true;
+	bool matchCursor = true;
+	for (float t = 0.0f; t < 0.999f; t += 0.0037f)
+	{
+		Skeleton reference = skeleton;
+		anim.sample(t, reference);
+
+		pose.set(skeleton);
+		anim.sample(t, pose, &cursor);
+		poseNoCursor.set(skeleton);
+		anim.sample(t, poseNoCursor);
+
+		for (int i = 0; i < skeleton.getBoneCount(); ++i)
+		{
+			const Skeleton::Bone& bone = reference.getBone(i);
+			match &= Equal(pose.getTranslation(i), bone.translation, 1e-4f);
+			match &= Equal(pose.getRotation(i), bone.rotation, 1e-4f);
+			match &= Equal(pose.getScale(i), bone.scale, 1e-4f);
+			matchCursor &= pose.getTranslation(i) == poseNoCursor.getTranslation(i);
+			matchCursor &= all(equal(pose.getRotation(i), poseNoCursor.getRotation(i)));
+		}
+	}
+	REQUIRE(match);
+	REQUIRE(matchCursor);
+
+	// _t is clamped, the cursor recovers when _t wraps.
+	pose.set(skeleton);
+	anim.sample(1.5f, pose, &cursor);
+	poseNoCursor.set(skeleton);
+	anim.sample(1.0f, poseNoCursor);
+	REQUIRE(Equal(pose, poseNoCursor, 1e-6f));
+	anim.sample(0.1f, pose, &cursor);
+	anim.sample(0.1f, poseNoCursor);
+	REQUIRE(Equal(pose, poseNoCursor, 1e-6f));
+
+	// Pose <-> Skeleton round trip.
+	Skeleton skeleton2 = skeleton;
+	pose.get(skeleton2);
+	poseNoCursor.set(skeleton2);
+	REQUIRE(Equal(pose, poseNoCursor, 1e-6f));
+}
+
+TEST_CASE("Blend", "[SkeletonAnimation]")
+{
+	Rand<> rand;
+	const int kBoneCount = 23;
+	const SkeletonPose a = RandomPose(kBoneCount, rand);
+	const SkeletonPose b = RandomPose(kBoneCount, rand);
+	SkeletonPose out;
+
+	SkeletonPose::Blend(a, b, 0.0f, out);
+	REQUIRE(Equal(out, a, 1e-5f));
+	SkeletonPose::Blend(a, b, 1.0f, out);
+	REQUIRE(Equal(out, b, 1e-5f));
+
+	SkeletonPose::Blend(a, b, 0.3f, out);
+	bool match = true;
+	for (int i = 0; i < kBoneCount; ++i)
+	{
+		match &= Equal(out.getTranslation(i), lerp(a.getTranslation(i), b.getTranslation(i), 0.3f), 1e-5f);
+		match &= Equal(out.getRotation(i), nlerp(a.getRotation(i), dot(a.getRotation(i), b.getRotation(i)) < 0.0f ? -b.getRotation(i) : b.getRotation(i), 0.3f), 1e-5f);
+		match &= Equal(out.getScale(i), lerp(a.getScale(i), b.getScale(i), 0.3f), 1e-5f);
+	}
+	REQUIRE(match);
+
+	// Masked, out_ aliases _a.
+	eastl::vector<float> mask((kBoneCount + 3) & ~3, 0.0f);
+	for (int i = 0; i < kBoneCount; i += 2)
+	{
+		mask[i] = 1.0f;
+	}
+	out = a;
+	SkeletonPose::Blend(out, b, 1.0f, out, mask.data());
+	for (int i = 0; i < kBoneCount; ++i)
+	{
+		const SkeletonPose& expected = (i % 2) == 0 ? b : a;
+		match &= Equal(out.getTranslation(i), expected.getTranslation(i), 1e-5f);
+		match &= Equal(out.getRotation(i), expected.getRotation(i), 1e-5f);
+	}
+	REQUIRE(match);
+
+	// Additive.
+	SkeletonPose additive;
+	SkeletonPose::MakeAdditive(b, a, additive);
+	SkeletonPose::Add(a, additive, 1.0f, out);
+	REQUIRE(Equal(out, b, 1e-5f));
+	SkeletonPose::Add(a, additive, 0.0f, out);
+	REQUIRE(Equal(out, a, 1e-5f));
+	SkeletonPose::Add(a, SkeletonPose(kBoneCount), 1.0f, out); // identity
+	REQUIRE(Equal(out, a, 1e-5f));
+}
+
+TEST_CASE("Resolve", "[SkeletonAnimation]")
+{
+	Rand<> rand;
+	Skeleton skeleton = CreateSkeleton(41, rand);
+	for (int i = 0; i < skeleton.getBoneCount(); i += 2)
+	{
+		skeleton.getBone(i).scale = vec3(rand.get<float>(0.5f, 2.0f), rand.get<float>(0.5f, 2.0f), rand.get<float>(0.5f, 2.0f));
+	}
+	eastl::vector<mat4> reference;
+	ResolveReference(skeleton, reference);
+	const mat4* pose = skeleton.resolve();
+
+	bool match = true;
+	for (int i = 0; i < skeleton.getBoneCount(); ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			match &= length(pose[i][j] - reference[i][j]) < 1e-3f * Max(1.0f, length(reference[i][j]));
+		}
+	}
+	REQUIRE(match);
+}
+
+TEST_CASE("BlendTree", "[SkeletonAnimation]")
+{
+	Rand<> rand;
+	const Skeleton skeleton = CreateSkeleton(19, rand);
+	TestAnimation anim0, anim1;
+	CreateAnimation(anim0, skeleton, 8, rand);
+	CreateAnimation(anim1, skeleton, 5, rand);
+
+	SkeletonBlendTree tree(skeleton);
+	const int baseLayer = tree.addLayer();
+	Skeleton result = skeleton;
+	SkeletonPose resultPose;
+	SkeletonPose expected0(skeleton.getBoneCount()), expected1(skeleton.getBoneCount()), expected(skeleton.getBoneCount());
+
+	// No clip = base pose.
+	tree.evaluate(result);
+	resultPose.set(result);
+	expected.set(skeleton);
+	REQUIRE(Equal(resultPose, expected, 1e-6f));
+
+	tree.play(baseLayer, &anim0, 0.0f, 0.5f);
+	tree.update(0.2f);
+	tree.evaluate(result);
+	resultPose.set(result);
+	expected0.set(skeleton);
+	anim0.sample(0.1f, expected0);
+	REQUIRE(Equal(resultPose, expected0, 1e-5f));
+
+	// Crossfade, halfway through the fade the result is an even blend.
+	tree.play(baseLayer, &anim1, 1.0f, 0.25f);
+	tree.update(0.5f);
+	tree.evaluate(result);
+	resultPose.set(result);
+	expected0.set(skeleton);
+	anim0.sample(0.35f, expected0);
+	expected1.set(skeleton);
+	anim1.sample(0.125f, expected1);
+	SkeletonPose::Blend(expected0, expected1, 0.5f, expected);
+	REQUIRE(Equal(resultPose, expected, 1e-5f));
+	tree.update(0.5f);
+	tree.evaluate(result);
+	resultPose.set(result);
+	expected1.set(skeleton);
+	anim1.sample(0.25f, expected1);
+	REQUIRE(Equal(resultPose, expected1, 1e-5f));
+
+	// Additive layer at the reference frame has no effect, masked bones are unaffected.
+	const int additiveLayer = tree.addLayer(SkeletonBlendTree::BlendMode_Additive);
+	tree.play(additiveLayer, &anim0);
+	tree.evaluate(result);
+	resultPose.set(result);
+	REQUIRE(Equal(resultPose, expected1, 1e-5f));
+
+	eastl::vector<float> mask(skeleton.getBoneCount(), 0.0f);
+	mask[3] = 1.0f;
+	tree.setLayerMask(additiveLayer, mask.data());
+	tree.setLayerTime(additiveLayer, 0.5f);
+	tree.evaluate(result);
+	resultPose.set(result);
+	bool match = true;
+	for (int i = 0; i < skeleton.getBoneCount(); ++i)
+	{
+		if (i != 3)
+		{
+			match &= Equal(resultPose.getTranslation(i), expected1.getTranslation(i), 1e-5f);
+			match &= Equal(resultPose.getRotation(i), expected1.getRotation(i), 1e-5f);
+		}
+	}
+	REQUIRE(match);
+	REQUIRE(!Equal(resultPose.getTranslation(3), expected1.getTranslation(3), 1e-3f));
+}
+
+TEST_CASE("Performance", "[SkeletonAnimation]")
+{
+	// A crowd of characters sharing a clip, each sampled at a different time.
+	const int kBoneCount = 64;
+	const int kKeyCount = 60;
+	const int kCharacterCount = 500;
+	Rand<> rand;
+	const Skeleton skeleton = CreateSkeleton(kBoneCount, rand);
+	TestAnimation anim0, anim1;
+	CreateAnimation(anim0, skeleton, kKeyCount, rand);
+	CreateAnimation(anim1, skeleton, kKeyCount, rand);
+	anim0.bake();
+	anim1.bake();
+
+	eastl::vector<Skeleton> characters(kCharacterCount, skeleton);
+	eastl::vector<float> times(kCharacterCount);
+	for (float& t : times)
+	{
+		t = rand.get<float>(0.0f, 0.99f);
+	}
+
+	eastl::vector<mat4> reference;
+	{	FRM_AUTOTIMER("Per track sample + scalar resolve (%d characters, %d bones)", kCharacterCount, kBoneCount);
+		for (int i = 0; i < kCharacterCount; ++i)
+		{
+			anim0.sample(times[i], characters[i]);
+			ResolveReference(characters[i], reference);
+		}
+	}
+
+	SkeletonPose pose(kBoneCount);
+	{	FRM_AUTOTIMER("SoA sample + resolve (%d characters, %d bones)", kCharacterCount, kBoneCount);
+		for (int i = 0; i < kCharacterCount; ++i)
+		{
+			pose.set(skeleton);
+			anim0.sample(times[i], pose);
+			pose.get(characters[i]);
+			characters[i].resolve();
+		}
+	}
+
+	eastl::vector<SkeletonBlendTree> trees(kCharacterCount, SkeletonBlendTree(skeleton));
+	for (int i = 0; i < kCharacterCount; ++i)
+	{
+		trees[i].addLayer();
+		trees[i].play(0, &anim0, 0.0f, 1.0f, times[i]);
+		trees[i].play(0, &anim1, 1.0f, 1.0f, times[i]);
+		trees[i].update(0.5f);
+	}
+	{	FRM_AUTOTIMER("Blend tree crossfade + resolve (%d characters, %d bones)", kCharacterCount, kBoneCount);
+		for (int i = 0; i < kCharacterCount; ++i)
+		{
+			trees[i].evaluate(characters[i]);
+			characters[i].resolve();
+		}
+	}
+}
@@ -0,0 +1,171 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/math.h>
+#include <frm/core/StreamingQuadtree.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+typedef StreamingQuadtree::NodeIndex NodeIndex;
+typedef Quadtree<NodeIndex, bool>    Quadtree_Bool;
+
+// Service the load/release queues until the quadtree is stable, return the number of iterations.
+int Stream(StreamingQuadtree& _quadtree, int _maxLoadPerUpdate = 8)
+{
+	int ret = 0;
+	for (; ret < 1000; ++ret)
+	{
+		_quadtree.update();
+		if (_quadtree.getLoadQueueCount() == 0 && _quadtree.getReleaseQueueCount() == 0)
+		{
+			break;
+		}
+		for (NodeIndex nodeIndex = _quadtree.popReleaseQueue(); nodeIndex != StreamingQuadtree::NodeIndex_Invalid; nodeIndex = _quadtree.popReleaseQueue())
+		{
+			_quadtree.setNodeData(nodeIndex, nullptr);
+		}
+		for (int i = 0; i < _maxLoadPerUpdate; ++i)
+		{
+			NodeIndex nodeIndex = _quadtree.popLoadQueue();
+			if (nodeIndex == StreamingQuadtree::NodeIndex_Invalid)
+			{
+				break;
+			}
+			_quadtree.setNodeData(nodeIndex, (void*)1);
+		}
+	}
+	return ret;
+}
+
+// Each leaf-level cell must be covered by exactly 1 loaded node in the draw list.
+bool DrawListCoversQuadtree(const StreamingQuadtree& _quadtree, int _levelCount)
+{
+	const int width = 1 << (_levelCount - 1);
+	eastl::vector<int> coverage(width * width, 0);
+	for (int i = 0; i < (int)_quadtree.getDrawListCount(); ++i)
+	{
+		NodeIndex nodeIndex = _quadtree.getDrawList(i);
+		if (_quadtree.getNodeState(nodeIndex) != StreamingQuadtree::NodeState_Loaded)
+		{
+			return false;
+		}
+		StreamingQuadtree::Node node = _quadtree.getNode(nodeIndex);
+		const int x0 = (int)((node.m_originQ.x - node.m_widthQ / 2.0f + 1.0f) / 2.0f * (float)width + 0.5f);
+		const int y0 = (int)((node.m_originQ.y - node.m_widthQ / 2.0f + 1.0f) / 2.0f * (float)width + 0.5f);
+		const int n  = (int)(node.m_widthQ / 2.0f * (float)width + 0.5f);
+		for (int y = y0; y < y0 + n; ++y)
+		{
+			for (int x = x0; x < x0 + n; ++x)
+			{
+				++coverage[y * width + x];
+			}
+		}
+	}
+	for (int count : coverage)
+	{
+		if (count != 1)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("Streaming", "[StreamingQuadtree]")
+{
+	const int kLevelCount = 6;
+	StreamingQuadtree quadtree(kLevelCount);
+	REQUIRE(quadtree.getLoadQueueCount() == 1);
+	REQUIRE(quadtree.getNodeCount() == 1);
+
+	quadtree.setPivot(vec3(-0.9f, -0.9f, 0.0f));
+	Stream(quadtree);
+	REQUIRE(DrawListCoversQuadtree(quadtree, kLevelCount));
+
+	// Nodes at the pivot are fully subdivided, distant nodes aren't.
+	const NodeIndex leafIndex = Quadtree_Bool::ToIndex(1, 1, kLevelCount - 1);
+	REQUIRE(quadtree.getNodeState(leafIndex) == StreamingQuadtree::NodeState_Loaded);
+	REQUIRE(quadtree.getNode(leafIndex).m_level == kLevelCount - 1);
+	const NodeIndex farIndex = Quadtree_Bool::ToIndex(30, 30, kLevelCount - 1);
+	REQUIRE(quadtree.getNodeState(farIndex) == StreamingQuadtree::NodeState_Invalid);
+	const size_t nodeCount = quadtree.getNodeCount();
+
+	// Move the pivot, previously subdivided nodes are released.
+	quadtree.setPivot(vec3(0.9f, 0.9f, 0.0f));
+	Stream(quadtree);
+	REQUIRE(DrawListCoversQuadtree(quadtree, kLevelCount));
+	REQUIRE(quadtree.getNodeState(leafIndex) == StreamingQuadtree::NodeState_Invalid);
+	REQUIRE(quadtree.getNodeState(farIndex) == StreamingQuadtree::NodeState_Loaded);
+	REQUIRE(quadtree.getNodeCount() == nodeCount); // symmetrical
+
+	// Moving the pivot back and forth before the queues are serviced cancels pending loads/releases.
+	quadtree.setPivot(vec3(-0.9f, -0.9f, 0.0f));
+	quadtree.update();
+	quadtree.setPivot(vec3(0.9f, 0.9f, 0.0f));
+	quadtree.update();
+	REQUIRE(quadtree.getReleaseQueueCount() == 0);
+	REQUIRE(DrawListCoversQuadtree(quadtree, kLevelCount));
+
+	// Reducing the max level merges nodes.
+	quadtree.setMaxLevel(2);
+	Stream(quadtree);
+	REQUIRE(DrawListCoversQuadtree(quadtree, kLevelCount));
+	REQUIRE(quadtree.getNodeCount() <= 1 + 4 + 16);
+	quadtree.setMaxLevel(-1);
+	Stream(quadtree);
+	REQUIRE(quadtree.getNodeCount() == nodeCount);
+
+	quadtree.releaseAll();
+	Stream(quadtree);
+	REQUIRE(quadtree.getNodeCount() == 0);
+	REQUIRE(quadtree.getDrawListCount() == 0);
+}
+
+TEST_CASE("LoadQueuePriority", "[StreamingQuadtree]")
+{
+	const int kLevelCount = 5;
+	StreamingQuadtree quadtree(kLevelCount);
+	quadtree.setLodScale(16.0f); // subdivide everything
+	const vec3 directionQ = vec3(1.0f, 0.0f, 0.0f);
+	quadtree.setPivot(vec3(0.0f, 0.1f, 0.0f), directionQ);
+
+	// Load level by level, the load queue for each level is popped in priority order (furthest along the view direction first).
+	for (int level = 0; level < kLevelCount; ++level)
+	{
+		quadtree.update();
+		REQUIRE(quadtree.getLoadQueueCount() == Quadtree_Bool::GetNodeCount(level));
+
+		if (level == 2)
+		{
+		 // reverse the direction, the queue is reprioritized during update()
+			quadtree.setPivot(vec3(0.0f, 0.1f, 0.0f), -directionQ);
+			quadtree.update();
+		}
+		const float sign = level >= 2 ? -1.0f : 1.0f;
+
+		const float kBucketWidth = 8.0f / 64.0f;
+		float prevPriority = FLT_MAX;
+		eastl::vector<NodeIndex> loaded;
+		for (NodeIndex nodeIndex = quadtree.popLoadQueue(); nodeIndex != StreamingQuadtree::NodeIndex_Invalid; nodeIndex = quadtree.popLoadQueue())
+		{
+			const float priority = quadtree.getNode(nodeIndex).m_originQ.x * sign;
+			REQUIRE(priority <= prevPriority + kBucketWidth);
+			prevPriority = priority;
+			loaded.push_back(nodeIndex);
+		}
+		REQUIRE(quadtree.getLoadQueueCount() == 0);
+		for (NodeIndex nodeIndex : loaded)
+		{
+			quadtree.setNodeData(nodeIndex, (void*)1);
+		}
+	}
+	quadtree.update();
+	REQUIRE(quadtree.getDrawListCount() == Quadtree_Bool::GetNodeCount(kLevelCount - 1));
+	REQUIRE(DrawListCoversQuadtree(quadtree, kLevelCount));
+}
@@ -1,37 +1,40 @@
 #include <catch.hpp>
 
-#include <apt/apt.h>
-#include <apt/compress.h>
-#include <apt/log.h>
-#include <apt/memory.h>
-#include <apt/File.h>
-#include <apt/Time.h>
+#include <frm/core/frm.h>
+#include <frm/core/compress.h>
+#include <frm/core/Log.h>
+#include <frm/core/math.h>
+#include <frm/core/memory.h>
+#include <frm/core/File.h>
+#include <frm/core/Time.h>
 
-using namespace apt;
+#include <EASTL/vector.h>
+
+using namespace frm;
 
 static void CompressionTest(const char* _filePath, CompressionFlags _flags)
 {
-	APT_LOG("\nCompression Test '%s' (%s) *********", _filePath, (_flags == CompressionFlags_Size) ? "size" : "speed");
+	FRM_LOG("\nCompression Test '%s' (%s) *********", _filePath, (_flags == CompressionFlags_Size) ? "size" : "speed");
 	
 	File f;
-	{	APT_AUTOTIMER("\tRead '%s'", _filePath);
+	{	FRM_AUTOTIMER("\tRead '%s'", _filePath);
 		File::Read(f, _filePath);
 	}
 
 	void* c = nullptr;
 	uint csz;
-	{	APT_AUTOTIMER("\tCompress");
+	{	FRM_AUTOTIMER("\tCompress");
 		Compress(f.getData(), f.getDataSize(), c, csz, CompressionFlags_Speed);
 	}
 	void* d = nullptr;
 	uint dsz;
-	{	APT_AUTOTIMER("\tDecompress");
+	{	FRM_AUTOTIMER("\tDecompress");
 		Decompress(c, csz, d, dsz);
 	}
-	APT_ASSERT(dsz == f.getDataSize());
-	APT_ASSERT(memcmp(d, f.getData(), f.getDataSize()) == 0);
-	APT_LOG("\n\tRaw size:        %.2fkb", (float)f.getDataSize() / 1024.0f);
-	APT_LOG(  "\tCompressed size: %.2fkb (%f%%)", (float)csz / 1024.0f, (float)csz / (float)dsz * 100.0f);
+	FRM_ASSERT(dsz == f.getDataSize());
+	FRM_ASSERT(memcmp(d, f.getData(), f.getDataSize()) == 0);
+	FRM_LOG("\n\tRaw size:        %.2fkb", (float)f.getDataSize() / 1024.0f);
+	FRM_LOG(  "\tCompressed size: %.2fkb (%f%%)", (float)csz / 1024.0f, (float)csz / (float)dsz * 100.0f);
 	free(c);
 	c = nullptr;
 	free(d);
@@ -49,4 +52,139 @@ TEST_CASE("performance", "[Compression]")
 {
 	CompressionTest("bob_lamp_update.md5anim");
 }
-#endif
\ No newline at end of file
+#endif
+
+namespace {
+
+// Compressible test data: runs of repeated bytes mixed with noise.
+eastl::vector<char> MakeTestData(uint _sizeBytes)
+{
+	eastl::vector<char> ret(_sizeBytes);
+	uint32 state = 12345;
+	for (uint i = 0; i < _sizeBytes; ++i)
+	{
+		state = state * 1664525u + 1013904223u;
+		ret[i] = (i / 64) % 3 == 0 ? (char)(state >> 24) : (char)(i / 256);
+	}
+	return ret;
+}
+
+bool AppendOutput(const void* _data, uint _sizeBytes, void* _vector)
+{
+	eastl::vector<char>& vector = *(eastl::vector<char>*)_vector;
+	vector.insert(vector.end(), (const char*)_data, (const char*)_data + _sizeBytes);
+	return true;
+}
+
+} // namespace
+
+TEST_CASE("Streaming", "[Compression]")
+{
+	const eastl::vector<char> src = MakeTestData(300 * 1024);
+
+	// Compress in odd-sized slices, the result must be compatible with Decompress().
+	eastl::vector<char> compressed;
+	{	Compressor compressor(&AppendOutput, &compressed, CompressionFlags_Speed);
+		for (uint offset = 0; offset < src.size(); offset += 1000)
+		{
+			REQUIRE(compressor.compress(src.data() + offset, Min((uint)1000, (uint)src.size() - offset)));
+		}
+		REQUIRE(compressor.finish());
+	}
+	REQUIRE(compressed.size() < src.size());
+
+	void* whole = nullptr;
+	uint wholeSizeBytes = 0;
+	Decompress(compressed.data(), compressed.size(), whole, wholeSizeBytes);
+	REQUIRE(wholeSizeBytes == src.size());
+	REQUIRE(memcmp(whole, src.data(), src.size()) == 0);
+	free(whole);
+
+	// Decompress in odd-sized slices, including a stream produced by Compress().
+	void* single = nullptr;
+	uint singleSizeBytes = 0;
+	Compress(src.data(), src.size(), single, singleSizeBytes, CompressionFlags_Size);
+	for (const eastl::vector<char>& stream : { compressed, eastl::vector<char>((char*)single, (char*)single + singleSizeBytes) })
+	{
+		eastl::vector<char> decompressed;
+		Decompressor decompressor(&AppendOutput, &decompressed);
+		for (uint offset = 0; offset < stream.size(); offset += 777)
+		{
+			REQUIRE(!decompressor.isComplete());
+			REQUIRE(decompressor.decompress(stream.data() + offset, Min((uint)777, (uint)stream.size() - offset)));
+		}
+		REQUIRE(decompressor.isComplete());
+		REQUIRE(decompressed == src);
+	}
+	free(single);
+
+	// Corrupt stream.
+	eastl::vector<char> corrupt = compressed;
+	corrupt[0] = 0;
+	eastl::vector<char> decompressed;
+	Decompressor decompressor(&AppendOutput, &decompressed);
+	REQUIRE(!decompressor.decompress(corrupt.data(), corrupt.size()));
+}
+
+TEST_CASE("Blocks", "[Compression]")
+{
+	const uint32 kBlockSizeBytes = 64 * 1024;
+	eastl::vector<char> src = MakeTestData(kBlockSizeBytes * 5 + 123);
+	for (uint i = kBlockSizeBytes; i < kBlockSizeBytes * 2; ++i)
+	{
+		src[i] = (char)(i * 2654435761u >> 24); // incompressible block, stored as-is
+	}
+
+	void* container = nullptr;
+	uint containerSizeBytes = 0;
+	CompressedBlocks::Compress(src.data(), src.size(), container, containerSizeBytes, CompressionFlags_Speed, kBlockSizeBytes);
+	REQUIRE(containerSizeBytes < src.size());
+
+	const uint headerSizeBytes = CompressedBlocks::GetHeaderSizeBytes(container, containerSizeBytes);
+	REQUIRE(headerSizeBytes > 0);
+	REQUIRE(CompressedBlocks::GetHeaderSizeBytes(src.data(), src.size()) == 0);
+
+	CompressedBlocks blocks(container, containerSizeBytes);
+	REQUIRE(blocks.isValid());
+	REQUIRE(blocks.getBlockCount() == 6);
+	REQUIRE(blocks.getDecompressedSizeBytes() == src.size());
+	REQUIRE(blocks.getBlockDecompressedSizeBytes(5) == 123);
+	REQUIRE(blocks.getAvailableBlockCount(headerSizeBytes) == 0);
+	REQUIRE(blocks.getAvailableBlockCount(containerSizeBytes) == 6);
+
+	// All blocks.
+	eastl::vector<char> dst(src.size());
+	REQUIRE(blocks.decompress(dst.data()));
+	REQUIRE(dst == src);
+
+	// Random access.
+	for (uint32 i : { 3u, 1u, 5u, 0u })
+	{
+		eastl::vector<char> block(blocks.getBlockDecompressedSizeBytes(i));
+		REQUIRE(blocks.decompressBlock(i, block.data()));
+		REQUIRE(memcmp(block.data(), src.data() + i * kBlockSizeBytes, block.size()) == 0);
+	}
+
+	// Streaming, decompress blocks as they become resident.
+	eastl::fill(dst.begin(), dst.end(), 0);
+	uint32 blocksDone = 0;
+	for (uint resident = headerSizeBytes; blocksDone < blocks.getBlockCount(); resident = Min(resident + 10000, containerSizeBytes))
+	{
+		const uint32 available = blocks.getAvailableBlockCount(resident);
+		REQUIRE(blocks.decompress(dst.data() + blocksDone * kBlockSizeBytes, blocksDone, available - blocksDone));
+		blocksDone = available;
+	}
+	REQUIRE(dst == src);
+
+	// Corrupt headers are rejected.
+	eastl::vector<char> corrupt((const char*)container, (const char*)container + containerSizeBytes);
+	const uint64 emptyLastBlockSizeBytes = (uint64)kBlockSizeBytes * 5; // last block would decompress to 0 bytes
+	memcpy(corrupt.data() + 16, &emptyLastBlockSizeBytes, sizeof(uint64));
+	REQUIRE(!CompressedBlocks(corrupt.data(), corrupt.size()).isValid());
+	const uint32 hugeBlockCount = 0x20000000; // header size overflows 32 bits
+	memcpy(corrupt.data() + 8, &hugeBlockCount, sizeof(uint32));
+	REQUIRE(CompressedBlocks::GetHeaderSizeBytes(corrupt.data(), corrupt.size()) == 0);
+	REQUIRE(!CompressedBlocks(corrupt.data(), corrupt.size()).isValid());
+
+	free(container);
+}
@@ -0,0 +1,218 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/geom.h>
+#include <frm/core/math.h>
+#include <frm/core/rand.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+TEST_CASE("Frustum batch tests", "[geom]")
+{
+	Frustum frustum(0.6f, -0.6f, 1.0f, -1.0f, 0.1f, 100.0f, false);
+	frustum.transform(LookAt(vec3(1.0f, 2.0f, 3.0f), vec3(0.0f, 0.0f, -20.0f)));
+
+	Rand<> rnd;
+	for (uint32 count : { 0u, 1u, 3u, 4u, 15u, 16u, 17u, 31u, 32u, 33u, 1000u, 10000u })
+	{
+		eastl::vector<float> x(count), y(count), z(count), r(count), maxX(count), maxY(count), maxZ(count);
+		for (uint32 i = 0; i < count; ++i)
+		{
+			x[i]    = rnd.get<float>(-120.0f, 120.0f);
+			y[i]    = rnd.get<float>(-120.0f, 120.0f);
+			z[i]    = rnd.get<float>(-120.0f, 120.0f);
+			r[i]    = rnd.get<float>(0.0f, 5.0f);
+			maxX[i] = x[i] + rnd.get<float>(0.0f, 10.0f);
+			maxY[i] = y[i] + rnd.get<float>(0.0f, 10.0f);
+			maxZ[i] = z[i] + rnd.get<float>(0.0f, 10.0f);
+		}
+		const SphereSoA spheres = { x.data(), y.data(), z.data(), r.data() };
+		const AlignedBoxSoA boxes = { x.data(), y.data(), z.data(), maxX.data(), maxY.data(), maxZ.data() };
+
+		eastl::vector<uint32> visible((count + 31) / 32 + 1, 0xffffffffu);
+		for (int mode = 0; mode < 4; ++mode)
+		{
+			uint32 visibleCount = 0;
+			switch (mode)
+			{
+				case 0: visibleCount = frustum.inside(spheres, count, visible.data()); break;
+				case 1: visibleCount = frustum.insideIgnoreNear(spheres, count, visible.data()); break;
+				case 2: visibleCount = frustum.inside(boxes, count, visible.data()); break;
+				case 3: visibleCount = frustum.insideIgnoreNear(boxes, count, visible.data()); break;
+			};
+
+			uint32 referenceCount = 0;
+			for (uint32 i = 0; i < count; ++i)
+			{
+				const Sphere sphere(vec3(x[i], y[i], z[i]), r[i]);
+				const AlignedBox box(vec3(x[i], y[i], z[i]), vec3(maxX[i], maxY[i], maxZ[i]));
+				bool reference = false;
+				switch (mode)
+				{
+					case 0: reference = frustum.inside(sphere); break;
+					case 1: reference = frustum.insideIgnoreNear(sphere); break;
+					case 2: reference = frustum.inside(box); break;
+					case 3: reference = frustum.insideIgnoreNear(box); break;
+				};
+				referenceCount += reference ? 1 : 0;
+				REQUIRE(reference == ((visible[i / 32] & (1u << (i % 32))) != 0));
+			}
+			REQUIRE(visibleCount == referenceCount);
+		}
+	}
+}
+
+TEST_CASE("Ray-triangle", "[geom]")
+{
+	Rand<> rnd;
+	auto RandVec3 = [&rnd](float _min, float _max) { return vec3(rnd.get<float>(_min, _max), rnd.get<float>(_min, _max), rnd.get<float>(_min, _max)); };
+
+	// Moller-Trumbore and watertight results agree.
+	for (int cullBackFace = 0; cullBackFace < 2; ++cullBackFace)
+	{
+		for (int i = 0; i < 10000; ++i)
+		{
+			const Triangle triangle(RandVec3(-10.0f, 10.0f), RandVec3(-10.0f, 10.0f), RandVec3(-10.0f, 10.0f));
+			const vec3 origin = RandVec3(-50.0f, 50.0f);
+			const Ray ray(origin, Normalize(RandVec3(-5.0f, 5.0f) - origin));
+
+			float t0 = 0.0f, t0Watertight = 0.0f;
+			vec2 barycentrics, barycentricsWatertight;
+			const bool hit = Intersect(ray, triangle, t0, barycentrics, cullBackFace != 0);
+			const bool hitWatertight = IntersectWatertight(ray, triangle, t0Watertight, barycentricsWatertight, cullBackFace != 0);
+			REQUIRE(hit == hitWatertight);
+			if (hit)
+			{
+				REQUIRE(abs(t0 - t0Watertight) < 1e-3f);
+				REQUIRE(abs(barycentrics.x - barycentricsWatertight.x) < 1e-3f);
+				REQUIRE(abs(barycentrics.y - barycentricsWatertight.y) < 1e-3f);
+				REQUIRE(Length(ray.m_origin + ray.m_direction * t0 - (triangle.m_vertices[0] * (1.0f - barycentrics.x - barycentrics.y) + triangle.m_vertices[1] * barycentrics.x + triangle.m_vertices[2] * barycentrics.y)) < 1e-3f);
+				REQUIRE(Intersects(ray, triangle, cullBackFace != 0));
+			}
+		}
+	}
+
+	// Front faces are counter-clockwise.
+	{
+		const Triangle triangle(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)); // normal is +z
+		REQUIRE( Intersects(Ray(vec3(0.25f, 0.25f,  1.0f), vec3(0.0f, 0.0f, -1.0f)), triangle, true));
+		REQUIRE(!Intersects(Ray(vec3(0.25f, 0.25f, -1.0f), vec3(0.0f, 0.0f,  1.0f)), triangle, true));
+		REQUIRE( Intersects(Ray(vec3(0.25f, 0.25f, -1.0f), vec3(0.0f, 0.0f,  1.0f)), triangle, false));
+		float t0;
+		vec2 barycentrics;
+		REQUIRE( IntersectWatertight(Ray(vec3(0.25f, 0.25f,  1.0f), vec3(0.0f, 0.0f, -1.0f)), triangle, t0, barycentrics, true));
+		REQUIRE(!IntersectWatertight(Ray(vec3(0.25f, 0.25f, -1.0f), vec3(0.0f, 0.0f,  1.0f)), triangle, t0, barycentrics, true));
+	}
+
+	// Watertight: rays through the shared edge of a quad (parallelogram) must hit at least 1 triangle.
+	for (int i = 0; i < 10000; ++i)
+	{
+		const vec3 v0 = RandVec3(-10.0f, 10.0f), v1 = RandVec3(-10.0f, 10.0f), v2 = RandVec3(-10.0f, 10.0f);
+		const vec3 v3 = v0 + v2 - v1;
+		const Triangle triangle0(v0, v1, v2);
+		const Triangle triangle1(v0, v2, v3);
+		const vec3 target = v0 + (v2 - v0) * rnd.get<float>(0.01f, 0.99f);
+		const vec3 origin = RandVec3(-50.0f, 50.0f);
+		const Ray ray(origin, Normalize(target - origin));
+
+		float t0;
+		vec2 barycentrics;
+		const bool hit0 = IntersectWatertight(ray, triangle0, t0, barycentrics);
+		const bool hit1 = IntersectWatertight(ray, triangle1, t0, barycentrics);
+		REQUIRE((hit0 || hit1));
+	}
+
+	// IntersectClosest() keeps the closest hit regardless of the test order.
+	{
+		const Triangle nearTriangle(vec3(0.0f, 0.0f, 1.0f), vec3(1.0f, 0.0f, 1.0f), vec3(0.0f, 1.0f, 1.0f));
+		const Triangle farTriangle (vec3(0.0f, 0.0f, 2.0f), vec3(0.0f, 1.0f, 2.0f), vec3(1.0f, 0.0f, 2.0f)); // swapped vertices = swapped barycentrics
+		const Ray ray(vec3(0.2f, 0.1f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+		for (int nearFirst = 0; nearFirst < 2; ++nearFirst)
+		{
+			float tMax = FLT_MAX;
+			vec2 barycentrics = vec2(-1.0f);
+			REQUIRE(IntersectClosest(ray, nearFirst ? nearTriangle : farTriangle, tMax, barycentrics));
+			REQUIRE(IntersectClosest(ray, nearFirst ? farTriangle : nearTriangle, tMax, barycentrics) == (nearFirst == 0));
+			REQUIRE(abs(tMax - 1.0f) < 1e-5f);
+			REQUIRE(abs(barycentrics.x - 0.2f) < 1e-5f);
+			REQUIRE(abs(barycentrics.y - 0.1f) < 1e-5f);
+		}
+	}
+}
+
+TEST_CASE("Ray batch tests", "[geom]")
+{
+	Rand<> rnd;
+	auto RandVec3 = [&rnd](float _min, float _max) { return vec3(rnd.get<float>(_min, _max), rnd.get<float>(_min, _max), rnd.get<float>(_min, _max)); };
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		// Ray origins are outside the boxes.
+		const vec3 origin = Normalize(RandVec3(-1.0f, 1.0f)) * 50.0f;
+		const Ray ray(origin, Normalize(RandVec3(-10.0f, 10.0f) - origin));
+		const float tMax = rnd.get<float>(40.0f, 70.0f);
+
+		float boxData[6][8];
+		float triangleData[9][8];
+		for (int j = 0; j < 8; ++j)
+		{
+			const vec3 boxMin = RandVec3(-10.0f, 10.0f);
+			const vec3 boxMax = boxMin + RandVec3(0.1f, 5.0f);
+			for (int k = 0; k < 3; ++k)
+			{
+				boxData[k][j]     = boxMin[k];
+				boxData[k + 3][j] = boxMax[k];
+			}
+			for (int k = 0; k < 9; ++k)
+			{
+				triangleData[k][j] = rnd.get<float>(-10.0f, 10.0f);
+			}
+		}
+		const AlignedBoxSoA boxes = { boxData[0], boxData[1], boxData[2], boxData[3], boxData[4], boxData[5] };
+		const TriangleSoA triangles = { triangleData[0], triangleData[1], triangleData[2], triangleData[3], triangleData[4], triangleData[5], triangleData[6], triangleData[7], triangleData[8] };
+
+		float boxT0[8];
+		const uint32 boxMask4 = Intersect4(ray, boxes, tMax, boxT0);
+		const uint32 boxMask8 = Intersect8(ray, boxes, tMax, boxT0);
+		REQUIRE(boxMask4 == (boxMask8 & 0xf));
+		for (int j = 0; j < 8; ++j)
+		{
+			const AlignedBox box(vec3(boxData[0][j], boxData[1][j], boxData[2][j]), vec3(boxData[3][j], boxData[4][j], boxData[5][j]));
+			float t0, t1;
+			const bool hit = Intersect(ray, box, t0, t1) && t0 <= tMax;
+			REQUIRE(hit == ((boxMask8 & (1u << j)) != 0));
+			if (hit)
+			{
+				REQUIRE(abs(t0 - boxT0[j]) < 1e-3f);
+			}
+		}
+
+		for (int cullBackFace = 0; cullBackFace < 2; ++cullBackFace)
+		{
+			float t0[8], u[8], v[8];
+			const uint32 triangleMask4 = Intersect4(ray, triangles, tMax, t0, u, v, cullBackFace != 0);
+			const uint32 triangleMask8 = Intersect8(ray, triangles, tMax, t0, u, v, cullBackFace != 0);
+			REQUIRE(triangleMask4 == (triangleMask8 & 0xf));
+			for (int j = 0; j < 8; ++j)
+			{
+				const Triangle triangle(
+					vec3(triangleData[0][j], triangleData[1][j], triangleData[2][j]),
+					vec3(triangleData[3][j], triangleData[4][j], triangleData[5][j]),
+					vec3(triangleData[6][j], triangleData[7][j], triangleData[8][j])
+					);
+				float t0Reference;
+				vec2 barycentricsReference;
+				const bool hit = Intersect(ray, triangle, t0Reference, barycentricsReference, cullBackFace != 0) && t0Reference < tMax;
+				REQUIRE(hit == ((triangleMask8 & (1u << j)) != 0));
+				if (hit)
+				{
+					REQUIRE(t0[j] == t0Reference);
+					REQUIRE(u[j] == barycentricsReference.x);
+					REQUIRE(v[j] == barycentricsReference.y);
+				}
+			}
+		}
+	}
+}
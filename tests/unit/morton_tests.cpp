@@ -0,0 +1,259 @@
+#include <catch.hpp>
+
+#include <frm/core/frm.h>
+#include <frm/core/morton.h>
+#include <frm/core/rand.h>
+#include <frm/core/Octree.h>
+#include <frm/core/Quadtree.h>
+
+#include <EASTL/vector.h>
+
+using namespace frm;
+
+namespace {
+
+uint64 Rand64(Rand<>& _rnd)
+{
+	return (uint64)_rnd.raw() << 32 | (uint64)_rnd.raw();
+}
+
+// Reference bit loop implementations (previously Quadtree/Octree::ToIndex/ToCartesian).
+template <typename tIndex, int kDimensions>
+tIndex RefEncode(const tIndex* _coords)
+{
+	uint64 ret = 0;
+	for (int i = 0; i < (int)(sizeof(tIndex) * CHAR_BIT) / kDimensions; ++i)
+	{
+		for (int j = 0; j < kDimensions; ++j)
+		{
+			ret |= (uint64)((_coords[j] >> i) & 1) << (i * kDimensions + j);
+		}
+	}
+	return (tIndex)ret;
+}
+
+template <typename tIndex, int kDimensions>
+void RefDecode(tIndex _code, tIndex* coords_)
+{
+	for (int j = 0; j < kDimensions; ++j)
+	{
+		coords_[j] = 0;
+	}
+	for (int i = 0; i < (int)(sizeof(tIndex) * CHAR_BIT) / kDimensions; ++i)
+	{
+		for (int j = 0; j < kDimensions; ++j)
+		{
+			coords_[j] |= (tIndex)(((uint64)_code >> (i * kDimensions + j)) & 1) << i;
+		}
+	}
+}
+
+// Exhaustively test Quadtree<tIndex>::ToIndex/ToCartesian for levels <= _maxExhaustiveLevel, randomly sample higher levels.
+template <typename tIndex>
+void TestQuadtree(int _maxExhaustiveLevel)
+{
+	typedef Quadtree<tIndex, int> QuadtreeType;
+	Rand<> rnd;
+
+	for (int level = 0; level < QuadtreeType::GetAbsoluteMaxLevelCount(); ++level)
+	{
+		const tIndex levelStart = QuadtreeType::GetLevelStartIndex(level);
+		const tIndex width      = QuadtreeType::GetWidth(level);
+
+		eastl::vector<tIndex> xs, ys, indices;
+		if (level <= _maxExhaustiveLevel)
+		{
+			for (tIndex y = 0; y < width; ++y)
+			{
+				for (tIndex x = 0; x < width; ++x)
+				{
+					xs.push_back(x);
+					ys.push_back(y);
+				}
+			}
+		}
+		else
+		{
+			for (int i = 0; i < 4096; ++i)
+			{
+				xs.push_back((tIndex)(Rand64(rnd) & (width - 1)));
+				ys.push_back((tIndex)(Rand64(rnd) & (width - 1)));
+			}
+		}
+
+		const uint32 count = (uint32)xs.size();
+		indices.resize(count);
+		QuadtreeType::ToIndex(xs.data(), ys.data(), level, count, indices.data());
+		eastl::vector<uvec2> batchCoords(count);
+		QuadtreeType::ToCartesian(indices.data(), level, count, batchCoords.data());
+
+		bool match = true;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			const tIndex coords[2] = { ys[i], xs[i] };
+			const tIndex reference = RefEncode<tIndex, 2>(coords) + levelStart;
+			const uvec2  cartesian = QuadtreeType::ToCartesian(reference, level);
+			match &= QuadtreeType::ToIndex(xs[i], ys[i], level) == reference;
+			match &= indices[i] == reference;
+			match &= cartesian.x == (uint32)xs[i] && cartesian.y == (uint32)ys[i];
+			match &= batchCoords[i].x == cartesian.x && batchCoords[i].y == cartesian.y;
+		}
+		REQUIRE(match);
+
+		// Out of bounds coordinates are invalid.
+		const tIndex invalidX[2] = { width, 0 };
+		const tIndex invalidY[2] = { 0, width };
+		tIndex invalidIndices[2];
+		QuadtreeType::ToIndex(invalidX, invalidY, level, 2, invalidIndices);
+		REQUIRE(QuadtreeType::ToIndex(width, 0, level) == QuadtreeType::Index_Invalid);
+		REQUIRE(invalidIndices[0] == QuadtreeType::Index_Invalid);
+		REQUIRE(invalidIndices[1] == QuadtreeType::Index_Invalid);
+	}
+}
+
+// As TestQuadtree().
+template <typename tIndex>
+void TestOctree(int _maxExhaustiveLevel)
+{
+	typedef Octree<tIndex, int> OctreeType;
+	Rand<> rnd;
+
+	for (int level = 0; level < OctreeType::GetAbsoluteMaxLevelCount(); ++level)
+	{
+		const tIndex levelStart = OctreeType::GetLevelStartIndex(level);
+		const tIndex width      = OctreeType::GetWidth(level);
+
+		eastl::vector<tIndex> xs, ys, zs, indices;
+		if (level <= _maxExhaustiveLevel)
+		{
+			for (tIndex z = 0; z < width; ++z)
+			{
+				for (tIndex y = 0; y < width; ++y)
+				{
+					for (tIndex x = 0; x < width; ++x)
+					{
+						xs.push_back(x);
+						ys.push_back(y);
+						zs.push_back(z);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (int i = 0; i < 4096; ++i)
+			{
+				xs.push_back((tIndex)(Rand64(rnd) & (width - 1)));
+				ys.push_back((tIndex)(Rand64(rnd) & (width - 1)));
+				zs.push_back((tIndex)(Rand64(rnd) & (width - 1)));
+			}
+		}
+
+		const uint32 count = (uint32)xs.size();
+		indices.resize(count);
+		OctreeType::ToIndex(xs.data(), ys.data(), zs.data(), level, count, indices.data());
+		eastl::vector<uvec3> batchCoords(count);
+		OctreeType::ToCartesian(indices.data(), level, count, batchCoords.data());
+
+		bool match = true;
+		for (uint32 i = 0; i < count; ++i)
+		{
+			const tIndex coords[3] = { ys[i], xs[i], zs[i] };
+			const tIndex reference = RefEncode<tIndex, 3>(coords) + levelStart;
+			const uvec3  cartesian = OctreeType::ToCartesian(reference, level);
+			match &= OctreeType::ToIndex(xs[i], ys[i], zs[i], level) == reference;
+			match &= indices[i] == reference;
+			match &= cartesian.x == (uint32)xs[i] && cartesian.y == (uint32)ys[i] && cartesian.z == (uint32)zs[i];
+			match &= batchCoords[i].x == cartesian.x && batchCoords[i].y == cartesian.y && batchCoords[i].z == cartesian.z;
+		}
+		REQUIRE(match);
+
+		REQUIRE(OctreeType::ToIndex(0, 0, width, level) == OctreeType::Index_Invalid);
+	}
+}
+
+} // namespace
+
+TEST_CASE("Morton encode/decode", "[morton]")
+{
+	Rand<> rnd;
+	bool match = true;
+
+	// 2D, exhaustive over 16 bit codes + random 32/64 bit codes.
+	for (uint32 code = 0; code < 0x10000; ++code)
+	{
+		uint32 a, b;
+		MortonDecode2(code, a, b);
+		uint16 ref[2];
+		RefDecode<uint16, 2>((uint16)code, ref);
+		match &= a == ref[0] && b == ref[1];
+		match &= MortonEncode2(a, b) == code;
+	}
+	for (int i = 0; i < 100000; ++i)
+	{
+		const uint32 code32 = rnd.raw();
+		uint32 a32, b32;
+		MortonDecode2(code32, a32, b32);
+		uint32 ref32[2];
+		RefDecode<uint32, 2>(code32, ref32);
+		match &= a32 == ref32[0] && b32 == ref32[1];
+		match &= MortonEncode2(a32, b32) == code32;
+
+		const uint64 code64 = Rand64(rnd);
+		uint64 a64, b64;
+		MortonDecode2(code64, a64, b64);
+		uint64 ref64[2];
+		RefDecode<uint64, 2>(code64, ref64);
+		match &= a64 == ref64[0] && b64 == ref64[1];
+		match &= MortonEncode2(a64, b64) == code64;
+	}
+	REQUIRE(match);
+
+	// 3D, exhaustive over 30 bit codes would be slow, test all 15 bit codes + random 30/63 bit codes.
+	for (uint32 code = 0; code < 0x8000; ++code)
+	{
+		uint32 a, b, c;
+		MortonDecode3(code, a, b, c);
+		match &= MortonEncode3(a, b, c) == code;
+	}
+	for (int i = 0; i < 100000; ++i)
+	{
+		const uint32 code32 = rnd.raw() & 0x3fffffffu;
+		uint32 a32, b32, c32;
+		MortonDecode3(code32, a32, b32, c32);
+		uint32 ref32[3];
+		RefDecode<uint32, 3>(code32, ref32);
+		match &= a32 == ref32[0] && b32 == ref32[1] && c32 == ref32[2];
+		match &= MortonEncode3(a32, b32, c32) == code32;
+
+		const uint64 code64 = Rand64(rnd) & 0x7fffffffffffffffull;
+		uint64 a64, b64, c64;
+		MortonDecode3(code64, a64, b64, c64);
+		uint64 ref64[3];
+		RefDecode<uint64, 3>(code64, ref64);
+		match &= a64 == ref64[0] && b64 == ref64[1] && c64 == ref64[2];
+		match &= MortonEncode3(a64, b64, c64) == code64;
+	}
+	REQUIRE(match);
+
+	// Input bits which don't fit in the code are discarded.
+	REQUIRE(MortonEncode2(0xffffffffu, 0u) == 0x55555555u);
+	REQUIRE(MortonEncode3(0xffffffffu, 0u, 0u) == 0x09249249u);
+	REQUIRE(MortonEncode3((uint64)0xffffffffffffffffull, (uint64)0, (uint64)0) == (uint64)0x1249249249249249ull);
+}
+
+TEST_CASE("Quadtree ToIndex/ToCartesian", "[morton]")
+{
+	TestQuadtree<uint8>(32);
+	TestQuadtree<uint16>(32);
+	TestQuadtree<uint32>(10);
+	TestQuadtree<uint64>(10);
+}
+
+TEST_CASE("Octree ToIndex/ToCartesian", "[morton]")
+{
+	TestOctree<uint8>(32);
+	TestOctree<uint16>(32);
+	TestOctree<uint32>(7);
+	TestOctree<uint64>(6);
+}